@@ -0,0 +1,25 @@
+
+// This pounds on function-like macro expansion with nested arguments that
+// need to be pre-expanded and with expansions longer than the inline token
+// buffers, the way preprocessor metaprogramming libraries do.
+
+#define CAT(A, B) CAT_I(A, B)
+#define CAT_I(A, B) A ## B
+#define ID(X) X
+
+// Each level pre-expands its argument and substitutes it several times.
+#define R0(X) ID(X), ID(X), CAT(X, _0), CAT(X, _1)
+#define R1(X) R0(ID(X)) R0(ID(X)) R0(ID(X)) R0(ID(X))
+#define R2(X) R1(ID(X)) R1(ID(X)) R1(ID(X)) R1(ID(X))
+#define R3(X) R2(ID(X)) R2(ID(X)) R2(ID(X)) R2(ID(X))
+#define R4(X) R3(ID(X)) R3(ID(X)) R3(ID(X)) R3(ID(X))
+#define R5(X) R4(ID(X)) R4(ID(X)) R4(ID(X)) R4(ID(X))
+#define R6(X) R5(ID(X)) R5(ID(X)) R5(ID(X)) R5(ID(X))
+
+// Arguments that expand to more than 128 tokens.
+#define L0 a b c d e f g h i j k l m n o p q r s t u v w x y z
+#define L1 L0 L0 L0 L0 L0 L0
+#define W(X) ID(X) ID(X)
+
+R6(x)
+W(L1) W(L1) W(L1) W(L1) W(L1) W(L1) W(L1) W(L1)
@@ -1540,9 +1540,23 @@ class Cursor(Structure):
         Yields cursors.
         """
         yield self
-        for child in self.get_children():
-            for descendant in child.walk_preorder():
-                yield descendant
+
+        # Flatten the whole subtree in one call, instead of crossing into
+        # libclang through a callback for every child of every cursor.
+        flat = conf.lib.clang_flattenCursorChildren(self,
+            _CXFlattenCursor_IncludeSpellings)
+        if not flat:
+            return
+        try:
+            cursors = flat.contents
+            for i in xrange(cursors.NumCursors):
+                cursor = Cursor.from_buffer_copy(cursors.Cursors[i])
+                cursor._tu = self._tu
+                cursor._spelling = string_at(cursors.Spellings +
+                                             cursors.SpellingOffsets[i])
+                yield cursor
+        finally:
+            conf.lib.clang_disposeFlattenedCursors(flat)
 
     def get_tokens(self):
         """Obtain Token instances formulating that compose this Cursor.
@@ -1609,6 +1623,25 @@ class Cursor(Structure):
         res._tu = args[0]._tu
         return res
 
+# Flags for clang_flattenCursorChildren.
+_CXFlattenCursor_IncludeSpellings = 0x02
+
+class _CXFlattenedCursors(Structure):
+    """
+    The descendants of a cursor, as returned by clang_flattenCursorChildren.
+    """
+    _fields_ = [("NumCursors", c_uint),
+                ("Cursors", POINTER(Cursor)),
+                ("Kinds", POINTER(c_int)),
+                ("Parents", POINTER(c_int)),
+                ("Files", POINTER(c_object_p)),
+                ("BeginOffsets", POINTER(c_uint)),
+                ("EndOffsets", POINTER(c_uint)),
+                ("USROffsets", POINTER(c_int)),
+                ("USRs", c_void_p),
+                ("SpellingOffsets", POINTER(c_int)),
+                ("Spellings", c_void_p)]
+
 class StorageClass(object):
     """
     Describes the storage class of a declaration
@@ -3025,6 +3058,9 @@ functionList = [
   ("clang_disposeDiagnostic",
    [Diagnostic]),
 
+  ("clang_disposeFlattenedCursors",
+   [POINTER(_CXFlattenedCursors)]),
+
   ("clang_disposeIndex",
    [Index]),
 
@@ -3053,6 +3089,10 @@ functionList = [
    [Type, Type],
    bool),
 
+  ("clang_flattenCursorChildren",
+   [Cursor, c_uint],
+   POINTER(_CXFlattenedCursors)),
+
   ("clang_getArgType",
    [Type, c_uint],
    Type,
@@ -68,6 +68,29 @@ def test_get_children():
     assert tu_nodes[2].displayname == 'f0(int, int)'
     assert tu_nodes[2].is_definition() == True
 
+def test_walk_preorder():
+    tu = get_tu(kInput)
+
+    def walk_children(cursor):
+        yield cursor
+        for child in cursor.get_children():
+            for descendant in walk_children(child):
+                yield descendant
+
+    walked = list(tu.cursor.walk_preorder())
+    expected = list(walk_children(tu.cursor))
+    assert len(walked) == len(expected)
+    for cursor, other in zip(walked, expected):
+        assert cursor == other
+        assert cursor.kind == other.kind
+        assert cursor.spelling == other.spelling
+        assert cursor.extent == other.extent
+        assert cursor.translation_unit is not None
+
+    f0 = [c for c in walked if c.spelling == 'f0']
+    assert len(f0) == 1
+    assert f0[0].kind == CursorKind.FUNCTION_DECL
+
 def test_references():
     """Ensure that references to TranslationUnit are kept."""
     tu = get_tu('int x;')
@@ -22,6 +22,7 @@
 #include "clang-c/CXErrorCode.h"
 #include "clang-c/CXString.h"
 #include "clang-c/BuildSystem.h"
+#include "clang-c/CXCompilationDatabase.h"
 
 /**
  * \brief The version constants for the libclang API.
@@ -32,7 +33,7 @@
  * compatible, thus CINDEX_VERSION_MAJOR is expected to remain stable.
  */
 #define CINDEX_VERSION_MAJOR 0
-#define CINDEX_VERSION_MINOR 35
+#define CINDEX_VERSION_MINOR 43
 
 #define CINDEX_VERSION_ENCODE(major, minor) ( \
       ((major) * 10000)                       \
@@ -1219,7 +1220,28 @@ enum CXTranslationUnit_Flags {
    * purposes of an IDE, this is undesirable behavior and as much information
    * as possible should be reported. Use this flag to enable this behavior.
    */
-  CXTranslationUnit_KeepGoing = 0x200
+  CXTranslationUnit_KeepGoing = 0x200,
+
+  /**
+   * \brief Used to indicate that the precompiled preamble should be kept in
+   * memory rather than written to a temporary file.
+   *
+   * This avoids filesystem I/O when the preamble is built and on every reparse
+   * that reuses it, at the cost of holding the preamble in memory. It has no
+   * effect unless CXTranslationUnit_PrecompiledPreamble is also set.
+   */
+  CXTranslationUnit_StorePreamblesInMemory = 0x400,
+
+  /**
+   * \brief Used to indicate that function bodies should only be parsed in the
+   * main file.
+   *
+   * This is a cheaper alternative to CXTranslationUnit_SkipFunctionBodies
+   * for editors, which usually need the bodies of the file being edited but
+   * not those of the headers it includes. The bodies parsed can be narrowed
+   * further with \c clang_setFunctionBodyFocus().
+   */
+  CXTranslationUnit_SkipFunctionBodiesOutsideMainFile = 0x800
 };
 
 /**
@@ -1478,6 +1500,67 @@ CINDEX_LINKAGE int clang_reparseTranslationUnit(CXTranslationUnit TU,
                                           struct CXUnsavedFile *unsaved_files,
                                                 unsigned options);
 
+/**
+ * \brief Reparse the source files of a translation unit into a new
+ * translation unit, leaving the original one untouched.
+ *
+ * This is the counterpart of \c clang_reparseTranslationUnit() for clients
+ * that need to keep answering queries while a reparse is in progress.
+ * Because \p TU is only read, other threads may keep using it (e.g., to
+ * look up cursors or tokens) while the new translation unit is being built;
+ * it must not be reparsed or disposed concurrently, though. Once the call
+ * returns, the client can switch its readers over to the new translation
+ * unit and dispose of \p TU when the last of them is done with it.
+ *
+ * The new translation unit is created with the same options as \p TU and
+ * reuses its precompiled preamble, if any, when it is still valid.
+ *
+ * \param TU The translation unit whose contents will be re-parsed.
+ *
+ * \param num_unsaved_files The number of unsaved file entries in \p
+ * unsaved_files.
+ *
+ * \param unsaved_files The files that have not yet been saved to disk
+ * but may be required for parsing, including the contents of
+ * those files.
+ *
+ * \param options A bitset of options composed of the flags in CXReparse_Flags.
+ *
+ * \param[out] out_TU A non-NULL pointer to store the created
+ * \c CXTranslationUnit.
+ *
+ * \returns Zero on success, otherwise returns an error code.
+ */
+CINDEX_LINKAGE enum CXErrorCode
+clang_reparseTranslationUnitSnapshot(CXTranslationUnit TU,
+                                     unsigned num_unsaved_files,
+                                     struct CXUnsavedFile *unsaved_files,
+                                     unsigned options,
+                                     CXTranslationUnit *out_TU);
+
+/**
+ * \brief Restrict the function bodies parsed by subsequent reparses of a
+ * translation unit to those of the main file that overlap the given lines.
+ *
+ * The translation unit must have been created with
+ * CXTranslationUnit_SkipFunctionBodiesOutsideMainFile; otherwise this has no
+ * effect. Clients typically pass the lines around the cursor, and move the
+ * focus and reparse when the cursor lands in a function whose body was
+ * skipped.
+ *
+ * \param TU The translation unit.
+ *
+ * \param start_line The first line (1-based) of the main file whose
+ * function bodies are parsed.
+ *
+ * \param end_line The last line of the main file whose function bodies are
+ * parsed, or 0 for the end of the file. Passing 0 for both lines parses all
+ * function bodies of the main file again.
+ */
+CINDEX_LINKAGE void clang_setFunctionBodyFocus(CXTranslationUnit TU,
+                                               unsigned start_line,
+                                               unsigned end_line);
+
 /**
   * \brief Categorizes how memory is being used by a translation unit.
   */
@@ -3820,6 +3903,118 @@ CINDEX_LINKAGE unsigned clang_visitChildrenWithBlock(CXCursor parent,
 #  endif
 #endif
 
+/**
+ * \brief Options for clang_flattenCursorChildren().
+ */
+enum CXFlattenCursor_Flags {
+  /**
+   * \brief Used to indicate that no special options are requested.
+   */
+  CXFlattenCursor_None = 0x0,
+
+  /**
+   * \brief Fill in the USR of each cursor.
+   *
+   * Generating USRs is comparatively expensive, so they are only computed on
+   * request.
+   */
+  CXFlattenCursor_IncludeUSRs = 0x01,
+
+  /**
+   * \brief Fill in the spelling of each cursor, as returned by
+   * clang_getCursorSpelling().
+   */
+  CXFlattenCursor_IncludeSpellings = 0x02
+};
+
+/**
+ * \brief The descendants of a cursor, flattened into parallel arrays.
+ *
+ * Entry \c i of each array describes the \c i-th descendant in the order in
+ * which clang_visitChildren() would visit them when recursing into every
+ * child, so a parent always precedes its children.
+ */
+typedef struct {
+  /**
+   * \brief The number of descendants, which is the length of each array.
+   */
+  unsigned NumCursors;
+
+  /**
+   * \brief The descendants themselves.
+   */
+  CXCursor *Cursors;
+
+  /**
+   * \brief The kind of each descendant.
+   */
+  enum CXCursorKind *Kinds;
+
+  /**
+   * \brief The index of the parent of each descendant, or -1 if its parent is
+   * the cursor that was flattened.
+   */
+  int *Parents;
+
+  /**
+   * \brief The file containing the start of each descendant's extent, or
+   * NULL if it has none.
+   */
+  CXFile *Files;
+
+  /**
+   * \brief The offsets of the start and end of each descendant's extent.
+   */
+  unsigned *BeginOffsets;
+  unsigned *EndOffsets;
+
+  /**
+   * \brief The offset into \c USRs of each descendant's USR, or -1 if it has
+   * none or USRs were not requested.
+   */
+  int *USROffsets;
+
+  /**
+   * \brief The USRs of the descendants, each terminated by a null character.
+   */
+  const char *USRs;
+
+  /**
+   * \brief The offset into \c Spellings of each descendant's spelling, or -1
+   * if spellings were not requested.
+   */
+  int *SpellingOffsets;
+
+  /**
+   * \brief The spellings of the descendants, each terminated by a null
+   * character.
+   */
+  const char *Spellings;
+} CXFlattenedCursors;
+
+/**
+ * \brief Flatten all descendants of a cursor into arrays.
+ *
+ * This visits the same cursors as clang_visitChildren() does when the visitor
+ * always returns \c CXChildVisit_Recurse, but in a single call. Bindings can
+ * then walk large ASTs without crossing the language boundary per cursor.
+ *
+ * \param parent The cursor whose descendants will be flattened.
+ *
+ * \param options A bitmask of options, a bitwise OR of the
+ * \c CXFlattenCursor_XXX flags.
+ *
+ * \returns The flattened descendants, which must be freed with
+ * clang_disposeFlattenedCursors(), or NULL if \p parent is invalid.
+ */
+CINDEX_LINKAGE CXFlattenedCursors *
+clang_flattenCursorChildren(CXCursor parent, unsigned options);
+
+/**
+ * \brief Free the result of clang_flattenCursorChildren().
+ */
+CINDEX_LINKAGE void clang_disposeFlattenedCursors(CXFlattenedCursors *cursors);
+
 /**
  * @}
  */
@@ -3846,6 +4041,38 @@ CINDEX_LINKAGE unsigned clang_visitChildrenWithBlock(CXCursor parent,
  */
 CINDEX_LINKAGE CXString clang_getCursorUSR(CXCursor);
 
+/**
+ * \brief Retrieve the USRs for a set of cursors at once.
+ *
+ * This is equivalent to calling \c clang_getCursorUSR() on each cursor, but
+ * avoids the per-call overhead when an indexer needs the USRs of many
+ * cursors, e.g., of every reference in a file.
+ *
+ * \param cursors the cursors whose USRs will be retrieved.
+ *
+ * \param num_cursors the number of cursors in \p cursors.
+ *
+ * \param usrs an array of \p num_cursors strings that will be filled with
+ * the USR of the corresponding cursor, or an empty string if it has none.
+ * Each string must be freed with \c clang_disposeString().
+ */
+CINDEX_LINKAGE void clang_getCursorUSRs(const CXCursor *cursors,
+                                        unsigned num_cursors,
+                                        CXString *usrs);
+
+/**
+ * \brief Retrieve a 64-bit hash of the USR of the entity referenced by the
+ * given cursor.
+ *
+ * Two cursors with the same USR have the same hash, which makes the hash a
+ * cheap way to test for equality before comparing the USRs themselves. The
+ * hash is only meaningful within the current process; it must not be
+ * persisted or compared with hashes computed by another process.
+ *
+ * \returns the hash of the cursor's USR, or 0 if the cursor has no USR.
+ */
+CINDEX_LINKAGE unsigned long long clang_getCursorUSRHash(CXCursor);
+
 /**
  * \brief Construct a USR for a specified Objective-C class.
  */
@@ -4507,6 +4734,72 @@ CINDEX_LINKAGE void clang_annotateTokens(CXTranslationUnit TU,
 CINDEX_LINKAGE void clang_disposeTokens(CXTranslationUnit TU,
                                         CXToken *Tokens, unsigned NumTokens);
 
+/**
+ * \brief Describes what an identifier token refers to, for the purpose of
+ * semantic highlighting.
+ */
+enum CXSemanticTokenClass {
+  /** \brief The token is not an identifier, or refers to nothing known. */
+  CXSemanticToken_None = 0,
+  CXSemanticToken_Namespace,
+  /** \brief A class, struct, union, enum, typedef, or Objective-C class. */
+  CXSemanticToken_Type,
+  CXSemanticToken_EnumConstant,
+  /** \brief A field, Objective-C instance variable or property. */
+  CXSemanticToken_Field,
+  CXSemanticToken_Function,
+  /** \brief A C++ member function or Objective-C method. */
+  CXSemanticToken_Method,
+  CXSemanticToken_Parameter,
+  CXSemanticToken_Variable,
+  CXSemanticToken_TemplateParameter,
+  CXSemanticToken_Macro,
+  CXSemanticToken_Label
+};
+
+/**
+ * \brief A token of a file along with its semantic class.
+ */
+typedef struct {
+  /** \brief The offset of the token within its file. */
+  unsigned Offset;
+  /** \brief The length of the token's spelling. */
+  unsigned Length;
+  enum CXTokenKind Kind;
+  enum CXSemanticTokenClass Class;
+} CXSemanticToken;
+
+/**
+ * \brief Retrieve the tokens of a file range along with their semantic
+ * classes, for semantic highlighting.
+ *
+ * This is equivalent to tokenizing the range, annotating the tokens and
+ * classifying the cursor each token refers to, but the whole file is
+ * processed in one pass on the first request and the result is cached by
+ * the translation unit until it is reparsed. Subsequent requests for any
+ * range of the file are answered from the cache.
+ *
+ * \param TU The translation unit.
+ *
+ * \param file The file whose tokens are requested.
+ *
+ * \param begin_offset The offset of the beginning of the range.
+ *
+ * \param end_offset The offset of the end of the range; tokens that start
+ * before it are returned.
+ *
+ * \param[out] tokens Set to the first token of the range. The array is owned
+ * by the translation unit and remains valid until it is reparsed or
+ * disposed.
+ *
+ * \returns The number of tokens in \c *tokens.
+ */
+CINDEX_LINKAGE unsigned clang_getSemanticTokens(CXTranslationUnit TU,
+                                                CXFile file,
+                                                unsigned begin_offset,
+                                                unsigned end_offset,
+                                                const CXSemanticToken **tokens);
+
 /**
  * @}
  */
@@ -5159,6 +5452,34 @@ CXCodeCompleteResults *clang_codeCompleteAt(CXTranslationUnit TU,
                                             unsigned num_unsaved_files,
                                             unsigned options);
 
+/**
+ * \brief Perform code completion at a given location, keeping only the
+ * results that match the text typed so far.
+ *
+ * This behaves like \c clang_codeCompleteAt(), except that the filtering
+ * that clients would otherwise perform on the results is done up front.
+ * Completion strings are only built for the results that are returned,
+ * which makes this considerably faster in contexts with many candidates,
+ * e.g., at global scope in C++.
+ *
+ * \param prefix If non-NULL, only results whose typed text starts with
+ * \p prefix, ignoring case, are returned.
+ *
+ * \param max_results If non-zero, at most \p max_results results are
+ * returned; the ones with the best priority are kept.
+ *
+ * The remaining parameters and the return value are as for
+ * \c clang_codeCompleteAt().
+ */
+CINDEX_LINKAGE
+CXCodeCompleteResults *
+clang_codeCompleteAtWithFilter(CXTranslationUnit TU,
+                               const char *complete_filename,
+                               unsigned complete_line, unsigned complete_column,
+                               struct CXUnsavedFile *unsaved_files,
+                               unsigned num_unsaved_files, unsigned options,
+                               const char *prefix, unsigned max_results);
+
 /**
  * \brief Sort the code-completion results in case-insensitive alphabetical 
  * order.
@@ -6022,6 +6343,36 @@ CINDEX_LINKAGE int clang_indexSourceFileFullArgv(
     int num_command_line_args, struct CXUnsavedFile *unsaved_files,
     unsigned num_unsaved_files, CXTranslationUnit *out_TU, unsigned TU_options);
 
+/**
+ * \brief Index the translation units of a set of compile commands in
+ * parallel.
+ *
+ * Each command is indexed as if by #clang_indexSourceFileFullArgv, relative
+ * to the command's directory. The commands are spread over a pool of
+ * \p num_threads threads, so the index callbacks are invoked concurrently and
+ * must be thread-safe; #IndexerCallbacks::enteredMainFile tells which
+ * translation unit the callbacks that follow it belong to.
+ *
+ * With \c CXIndexOpt_SkipParsedBodiesInSession, function bodies in headers
+ * that any thread has already indexed are skipped.
+ *
+ * \param num_threads The number of threads to index on, or 0 to use one per
+ * hardware thread.
+ *
+ * \param[out] results If non-null, an array with one entry per command that
+ * receives the \c CXErrorCode of indexing that command.
+ *
+ * \returns 0 if every command was indexed, or if there were only errors from
+ * which the compiler could recover. Otherwise returns a non-zero
+ * \c CXErrorCode.
+ *
+ * The rest of the parameters are the same as #clang_indexSourceFile.
+ */
+CINDEX_LINKAGE int clang_indexCompileCommands(
+    CXIndexAction, CXClientData client_data, IndexerCallbacks *index_callbacks,
+    unsigned index_callbacks_size, unsigned index_options,
+    CXCompileCommands commands, unsigned num_threads, int *results);
+
 /**
  * \brief Index the given translation unit via callbacks implemented through
  * #IndexerCallbacks.
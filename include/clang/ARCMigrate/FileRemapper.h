@@ -56,6 +56,9 @@ public:
 
   void applyMappings(PreprocessorOptions &PPOpts) const;
 
+  /// \brief Whether no file is remapped.
+  bool empty() const { return FromToMappings.empty(); }
+
   void clear(StringRef outputDir = StringRef());
 
 private:
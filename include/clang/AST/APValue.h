@@ -84,10 +84,25 @@ private:
     ~Vec() { delete[] Elts; }
   };
   struct Arr {
-    APValue *Elts;
+    /// The elements of an array, followed by its filler if it has one, are
+    /// allocated directly after this header. They are shared by copies of the
+    /// array until one of the copies is modified.
+    struct LLVM_ALIGNAS(8) Shared {
+      unsigned RefCount;
+      APValue *getElts() { return reinterpret_cast<APValue *>(this + 1); }
+      const APValue *getElts() const {
+        return reinterpret_cast<const APValue *>(this + 1);
+      }
+    };
+    Shared *Elts;
     unsigned NumElts, ArrSize;
     Arr(unsigned NumElts, unsigned ArrSize);
+    Arr(const Arr &RHS);
     ~Arr();
+    unsigned getNumAllocated() const {
+      return NumElts + (NumElts != ArrSize ? 1 : 0);
+    }
+    static Shared *allocate(unsigned N);
   };
   struct StructData {
     APValue *Elts;
@@ -268,13 +283,19 @@ public:
     return ((const Vec*)(const void *)Data.buffer)->NumElts;
   }
 
+  /// \brief Get an element of an array, for modification.
+  ///
+  /// This gives the array its own copy of its elements if they were shared
+  /// with a copy of it, so use the const overload when only reading.
   APValue &getArrayInitializedElt(unsigned I) {
     assert(isArray() && "Invalid accessor");
     assert(I < getArrayInitializedElts() && "Index out of range");
-    return ((Arr*)(char*)Data.buffer)->Elts[I];
+    return getUnsharedArrayElts()[I];
   }
   const APValue &getArrayInitializedElt(unsigned I) const {
-    return const_cast<APValue*>(this)->getArrayInitializedElt(I);
+    assert(isArray() && "Invalid accessor");
+    assert(I < getArrayInitializedElts() && "Index out of range");
+    return ((const Arr*)(const void *)Data.buffer)->Elts->getElts()[I];
   }
   bool hasArrayFiller() const {
     return getArrayInitializedElts() != getArraySize();
@@ -282,10 +303,13 @@ public:
   APValue &getArrayFiller() {
     assert(isArray() && "Invalid accessor");
     assert(hasArrayFiller() && "No array filler");
-    return ((Arr*)(char*)Data.buffer)->Elts[getArrayInitializedElts()];
+    return getUnsharedArrayElts()[getArrayInitializedElts()];
   }
   const APValue &getArrayFiller() const {
-    return const_cast<APValue*>(this)->getArrayFiller();
+    assert(isArray() && "Invalid accessor");
+    assert(hasArrayFiller() && "No array filler");
+    return ((const Arr*)(const void *)Data.buffer)
+        ->Elts->getElts()[getArrayInitializedElts()];
   }
   unsigned getArrayInitializedElts() const {
     assert(isArray() && "Invalid accessor");
@@ -445,6 +469,16 @@ private:
     new ((void*)(char*)Data.buffer) AddrLabelDiffData();
     Kind = AddrLabelDiff;
   }
+
+  /// Get the elements of an array, first copying them if they are shared
+  /// with another array.
+  APValue *getUnsharedArrayElts() {
+    Arr *A = (Arr*)(char*)Data.buffer;
+    if (A->Elts->RefCount != 1)
+      unshareArray();
+    return A->Elts->getElts();
+  }
+  void unshareArray();
 };
 
 } // end namespace clang.
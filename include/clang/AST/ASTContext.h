@@ -53,6 +53,8 @@ namespace clang {
   class ASTRecordLayout;
   class BlockExpr;
   class CharUnits;
+  class CXXDerivation;
+  class CXXFinalOverriderMap;
   class DiagnosticsEngine;
   class Expr;
   class ASTMutationListener;
@@ -61,6 +63,8 @@ namespace clang {
   class SelectorTable;
   class TargetInfo;
   class CXXABI;
+  class ConstexprBytecodeCache;
+  class ConstexprCallCache;
   class MangleNumberingContext;
   // Decls
   class MangleContext;
@@ -397,6 +401,19 @@ private:
   llvm::DenseMap<const DeclContext *, MangleNumberingContext *>
       MangleNumberingContexts;
 
+  /// \brief The final overriders of each complete C++ class, as computed by
+  /// CXXRecordDecl::getFinalOverriders.
+  mutable llvm::DenseMap<const CXXRecordDecl *, CXXFinalOverriderMap *>
+      FinalOverriderMaps;
+
+  /// \brief The derivations of complete C++ classes from their bases, keyed
+  /// by the canonical declarations of the derived and the base class, as
+  /// computed by getDerivation. A null derivation means the class is not
+  /// derived from the base.
+  mutable llvm::DenseMap<
+      std::pair<const CXXRecordDecl *, const CXXRecordDecl *>,
+      const CXXDerivation *> Derivations;
+
   /// \brief Side-table of mangling numbers for declarations which rarely
   /// need them (like static local vars).
   llvm::MapVector<const NamedDecl *, unsigned> MangleNumbers;
@@ -432,6 +449,20 @@ private:
   /// AST objects will be released when the ASTContext itself is destroyed.
   mutable llvm::BumpPtrAllocator BumpAlloc;
 
+  /// \brief Whether the statements of function bodies that may be discarded
+  /// once code has been generated for them are allocated in regions of their
+  /// own.
+  bool AllocateBodiesInRegions = false;
+
+  /// \brief The regions holding the statements of function bodies, by
+  /// function.
+  llvm::DenseMap<const FunctionDecl *, std::unique_ptr<llvm::BumpPtrAllocator>>
+      BodyRegions;
+
+  /// \brief The region in which statements are allocated, while the body
+  /// it belongs to is parsed.
+  llvm::BumpPtrAllocator *CurrentBodyRegion = nullptr;
+
   /// \brief Allocator for partial diagnostics.
   PartialDiagnostic::StorageAllocator DiagAllocator;
 
@@ -439,6 +470,14 @@ private:
   std::unique_ptr<CXXABI> ABI;
   CXXABI *createCXXABI(const TargetInfo &T);
 
+  /// \brief The bytecode compiled by the experimental constexpr interpreter,
+  /// if it has been used.
+  ConstexprBytecodeCache *ConstexprBytecode;
+
+  /// \brief The results of side-effect-free constexpr function calls, if any
+  /// have been memoized.
+  ConstexprCallCache *ConstexprCalls;
+
   /// \brief The logical -> physical address space map.
   const LangAS::Map *AddrSpaceMap;
 
@@ -454,6 +493,10 @@ private:
   const TargetInfo *Target;
   const TargetInfo *AuxTarget;
   clang::PrintingPolicy PrintingPolicy;
+
+  /// \brief The strings produced by getTypeAsString, keyed by the type and
+  /// the printing policy it was printed with.
+  mutable llvm::DenseMap<std::pair<void *, uint64_t>, StringRef> PrintedTypes;
   
 public:
   IdentifierTable &Idents;
@@ -557,6 +600,18 @@ public:
   void setPrintingPolicy(const clang::PrintingPolicy &Policy) {
     PrintingPolicy = Policy;
   }
+
+  /// \brief Print \p T according to \p Policy, reusing the result of an
+  /// earlier call with the same type and policy.
+  ///
+  /// Diagnostics and tools print the same, often very long, template types
+  /// over and over.  The returned string lives as long as the context.
+  StringRef getTypeAsString(QualType T,
+                            const clang::PrintingPolicy &Policy) const;
+
+  /// \brief Forget the strings returned by getTypeAsString, because the
+  /// way a type is printed changed.
+  void clearPrintedTypes() const { PrintedTypes.clear(); }
   
   SourceManager& getSourceManager() { return SourceMgr; }
   const SourceManager& getSourceManager() const { return SourceMgr; }
@@ -572,11 +627,46 @@ public:
     return static_cast<T *>(Allocate(Num * sizeof(T), llvm::alignOf<T>()));
   }
   void Deallocate(void *Ptr) const { }
-  
+
+  /// \brief Allocate memory for a statement, in the region of the function
+  /// body being parsed if it has one.
+  void *AllocateStmt(size_t Size, unsigned Align) const {
+    if (CurrentBodyRegion)
+      return CurrentBodyRegion->Allocate(Size, Align);
+    return BumpAlloc.Allocate(Size, Align);
+  }
+
+  /// \brief Set whether the statements of function bodies that may be
+  /// discarded are allocated in regions of their own.
+  void setAllocateBodiesInRegions(bool Allocate) {
+    AllocateBodiesInRegions = Allocate;
+  }
+  bool shouldAllocateBodiesInRegions() const {
+    return AllocateBodiesInRegions;
+  }
+
+  /// \brief Allocate the statements created from now on in a region of their
+  /// own, which holds the body of \p FD.
+  void startBodyRegion(const FunctionDecl *FD);
+
+  /// \brief Allocate the statements created from now on as usual.
+  void finishBodyRegion() { CurrentBodyRegion = nullptr; }
+
+  /// \brief Release the memory of the body of \p FD, which nothing will look
+  /// at again, if it was allocated in a region and nothing outside of the
+  /// body can refer into it. The body is replaced with an empty compound
+  /// statement, so that \p FD remains a definition.
+  ///
+  /// \returns true if the body was discarded.
+  bool discardFunctionBody(FunctionDecl *FD);
+
   /// Return the total amount of physical memory allocated for representing
   /// AST nodes and type information.
   size_t getASTAllocatedMemory() const {
-    return BumpAlloc.getTotalMemory();
+    size_t Total = BumpAlloc.getTotalMemory();
+    for (const auto &Region : BodyRegions)
+      Total += Region.second->getTotalMemory();
+    return Total;
   }
   /// Return the total memory used for various side tables.
   size_t getSideTableAllocatedMemory() const;
@@ -957,9 +1047,50 @@ public:
   /// with this AST context, if any.
   ASTMutationListener *getASTMutationListener() const { return Listener; }
 
+  /// \brief Retrieve the bytecode compiled by the experimental constexpr
+  /// interpreter, or null if it hasn't compiled anything yet.
+  ConstexprBytecodeCache *getConstexprBytecodeCache() const {
+    return ConstexprBytecode;
+  }
+
+  /// \brief Set the bytecode cache of the experimental constexpr
+  /// interpreter. Its creator is responsible for registering a deallocation
+  /// for it.
+  void setConstexprBytecodeCache(ConstexprBytecodeCache *Cache) {
+    ConstexprBytecode = Cache;
+  }
+
+  /// \brief Retrieve the memoized results of constexpr function calls, or
+  /// null if none have been memoized yet.
+  ConstexprCallCache *getConstexprCallCache() const { return ConstexprCalls; }
+
+  /// \brief Set the memoized results of constexpr function calls. Its creator
+  /// is responsible for registering a deallocation for it.
+  void setConstexprCallCache(ConstexprCallCache *Cache) {
+    ConstexprCalls = Cache;
+  }
+
   void PrintStats() const;
+
+  /// \brief Write the memory used by this context, by kind of type and by
+  /// uniquing table, as a JSON object.
+  void PrintStatsJSON(raw_ostream &OS) const;
+
   const SmallVectorImpl<Type *>& getTypes() const { return Types; }
 
+private:
+  /// \brief The number of nodes in, and the bytes of bucket storage used by,
+  /// one of the FoldingSets that unique types and names.
+  struct FoldingSetSize {
+    const char *Name;
+    unsigned NumNodes;
+    size_t BucketBytes;
+  };
+
+  void getFoldingSetSizes(SmallVectorImpl<FoldingSetSize> &Sizes) const;
+
+public:
+
   BuiltinTemplateDecl *buildBuiltinTemplateDecl(BuiltinTemplateKind BTK,
                                                 const IdentifierInfo *II) const;
 
@@ -1887,6 +2018,21 @@ public:
   /// position information.
   const ASTRecordLayout &getASTRecordLayout(const RecordDecl *D) const;
 
+  /// \brief Get or compute the final overriders of each virtual member
+  /// function in the class hierarchy of the complete class \p RD.
+  ///
+  /// The result is computed once per class and shared by everything that
+  /// needs it, such as the checks for abstract classes and the vtable
+  /// builders.
+  const CXXFinalOverriderMap &getFinalOverriders(const CXXRecordDecl *RD) const;
+
+  /// \brief Get or compute how the complete class \p Derived is derived from
+  /// the class \p Base, see CXXDerivation::isMemoizable.
+  ///
+  /// \returns null if \p Derived is not derived from \p Base.
+  const CXXDerivation *getDerivation(const CXXRecordDecl *Derived,
+                                     const CXXRecordDecl *Base) const;
+
   /// \brief Get or compute information about the layout of the specified
   /// Objective-C interface.
   const ASTRecordLayout &getASTObjCInterfaceLayout(const ObjCInterfaceDecl *D)
@@ -2483,6 +2629,21 @@ public:
   /// \brief The number of implicitly-declared destructors for which 
   /// declarations were built.
   static unsigned NumImplicitDestructorsDeclared;
+
+  /// \brief The number of constexpr function calls whose result could have
+  /// been memoized.
+  static unsigned NumMemoizableConstexprCalls;
+
+  /// \brief The number of constexpr function calls whose result was reused
+  /// from an earlier call with the same arguments.
+  static unsigned NumMemoizedConstexprCallsReused;
+
+  /// \brief The number of record layouts computed.
+  static unsigned NumRecordLayouts;
+
+  /// \brief The number of C++ record layouts computed without tracking the
+  /// offsets of empty subobjects, because the record can't contain any.
+  static unsigned NumRecordLayoutsWithoutEmptySubobjects;
   
 private:
   ASTContext(const ASTContext &) = delete;
@@ -85,6 +85,49 @@ public:
   }
 };
 
+/// \brief The memoized relationship between a complete class and one of its
+/// (direct or indirect) base classes, as computed by
+/// ASTContext::getDerivation.
+///
+/// The path is allocated in the ASTContext, so that the many derived-to-base
+/// conversions between the same pair of classes neither search the class
+/// hierarchy again nor build a CXXBasePaths.
+class CXXDerivation {
+  ArrayRef<CXXBasePathElement> Path;
+  AccessSpecifier Access;
+  bool Ambiguous;
+
+public:
+  CXXDerivation(ArrayRef<CXXBasePathElement> Path, AccessSpecifier Access,
+                bool Ambiguous)
+      : Path(Path), Access(Access), Ambiguous(Ambiguous) {}
+
+  /// \brief Determine whether the derivation of \p Derived from its bases
+  /// can be memoized, i.e. whether its bases can no longer change.
+  static bool isMemoizable(const CXXRecordDecl *Derived) {
+    const CXXRecordDecl *Def = Derived->getDefinition();
+    return Def && Def->isCompleteDefinition() && !Def->isDependentContext();
+  }
+
+  /// \brief Determine whether the derived class has more than one subobject
+  /// of the base class.
+  bool isAmbiguous() const { return Ambiguous; }
+
+  /// \brief Retrieve the first path from the derived class to the base
+  /// class, i.e. the front of the CXXBasePaths that
+  /// CXXRecordDecl::isDerivedFrom would record.
+  ArrayRef<CXXBasePathElement> getPath() const { return Path; }
+
+  /// \brief Retrieve the access along the first path.
+  AccessSpecifier getAccess() const { return Access; }
+
+  /// \brief Copy the first path into \p Result.
+  void getPath(CXXBasePath &Result) const {
+    Result.assign(Path.begin(), Path.end());
+    Result.Access = Access;
+  }
+};
+
 /// BasePaths - Represents the set of paths from a derived class to
 /// one of its (direct or indirect) bases. For example, given the
 /// following class hierarchy:
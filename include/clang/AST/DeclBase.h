@@ -882,6 +882,7 @@ public:
   static void add(Kind k);
   static void EnableStatistics();
   static void PrintStats();
+  static void PrintStatsJSON(raw_ostream &OS);
 
   /// isTemplateParameter - Determines whether this declaration is a
   /// template parameter.
@@ -1812,7 +1813,8 @@ private:
   friend class DependentDiagnostic;
   StoredDeclsMap *CreateStoredDeclsMap(ASTContext &C) const;
 
-  void buildLookupImpl(DeclContext *DCtx, bool Internal);
+  void buildLookupImpl(DeclContext *DCtx, decl_iterator Begin,
+                       decl_iterator End, bool Internal);
   void makeDeclVisibleInContextWithFlags(NamedDecl *D, bool Internal,
                                          bool Rediscoverable);
   void makeDeclVisibleInContextImpl(NamedDecl *D, bool Internal);
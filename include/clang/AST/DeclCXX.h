@@ -495,6 +495,10 @@ class CXXRecordDecl : public RecordDecl {
     /// This is actually currently stored in reverse order.
     LazyDeclPtr FirstFriend;
 
+    /// \brief The hash computed by computeODRHash for this definition when
+    /// it was written to an AST file, or zero if there is none.
+    unsigned ODRHash;
+
     /// \brief Retrieve the set of direct base classes.
     CXXBaseSpecifier *getBases() const {
       if (!Bases.isOffset())
@@ -1603,6 +1607,14 @@ public:
   /// most-derived class in the class hierarchy.
   void getFinalOverriders(CXXFinalOverriderMap &FinaOverriders) const;
 
+  /// \brief Compute a hash of the bases and explicitly declared members of
+  /// this class definition.
+  ///
+  /// The hash only depends on the names, kinds and types of the members, so
+  /// that definitions of the same class in different modules get the same
+  /// hash if they declare the same members.  It is never zero.
+  unsigned computeODRHash() const;
+
   /// \brief Get the indirect primary bases for this class.
   void getIndirectPrimaryBases(CXXIndirectPrimaryBaseSet& Bases) const;
 
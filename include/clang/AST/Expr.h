@@ -4259,6 +4259,95 @@ public:
   }
 };
 
+/// \brief Represents the semantic form of an initializer list for an array
+/// of integers that is made up only of integer and character literals.
+///
+/// Data tables in generated sources can have many thousands of elements.
+/// Rather than building an InitListExpr with an implicit conversion for
+/// every element, Sema packs the converted values into a single
+/// DataArrayExpr. Each element is stored in \c getElementSize() bytes,
+/// least significant byte first; elements of the array beyond
+/// \c getNumInits() are zero-initialized.
+///
+/// The list as written is retained as the syntactic form.
+class DataArrayExpr final
+    : public Expr,
+      private llvm::TrailingObjects<DataArrayExpr, char> {
+  InitListExpr *SyntacticForm;
+  unsigned NumInits;
+  unsigned ElementSize;
+
+  DataArrayExpr(QualType T, InitListExpr *SyntacticForm, unsigned NumInits,
+                unsigned ElementSize)
+    : Expr(DataArrayExprClass, T, VK_RValue, OK_Ordinary, false, false,
+           false, false),
+      SyntacticForm(SyntacticForm), NumInits(NumInits),
+      ElementSize(ElementSize) { }
+
+  DataArrayExpr(EmptyShell Empty, unsigned NumInits, unsigned ElementSize)
+    : Expr(DataArrayExprClass, Empty), SyntacticForm(nullptr),
+      NumInits(NumInits), ElementSize(ElementSize) { }
+
+public:
+  /// \brief Create a data array of type \p T holding \p Values, each of
+  /// which is truncated to \p ElementSize bytes.
+  static DataArrayExpr *Create(const ASTContext &C, QualType T,
+                               InitListExpr *SyntacticForm,
+                               ArrayRef<uint64_t> Values,
+                               unsigned ElementSize);
+
+  static DataArrayExpr *CreateEmpty(const ASTContext &C, unsigned NumInits,
+                                    unsigned ElementSize);
+
+  /// \brief The number of elements given explicitly by the initializer.
+  unsigned getNumInits() const { return NumInits; }
+
+  /// \brief The size of each element, in bytes.
+  unsigned getElementSize() const { return ElementSize; }
+
+  /// \brief The bits of the given element, zero-extended to 64 bits.
+  uint64_t getElementValue(unsigned I) const {
+    assert(I < NumInits && "Element index out of range");
+    const unsigned char *Data =
+        reinterpret_cast<const unsigned char *>(getTrailingObjects<char>()) +
+        I * ElementSize;
+    uint64_t V = 0;
+    for (unsigned B = ElementSize; B != 0; --B)
+      V = (V << 8) | Data[B - 1];
+    return V;
+  }
+
+  void setElementValue(unsigned I, uint64_t V) {
+    assert(I < NumInits && "Element index out of range");
+    char *Data = getTrailingObjects<char>() + I * ElementSize;
+    for (unsigned B = 0; B != ElementSize; ++B, V >>= 8)
+      Data[B] = static_cast<char>(V & 0xFF);
+  }
+
+  /// \brief The packed element data, \c getNumInits() * \c getElementSize()
+  /// bytes in length.
+  StringRef getBytes() const {
+    return StringRef(getTrailingObjects<char>(), NumInits * ElementSize);
+  }
+
+  InitListExpr *getSyntacticForm() const { return SyntacticForm; }
+  void setSyntacticForm(InitListExpr *E) { SyntacticForm = E; }
+
+  SourceLocation getLocStart() const LLVM_READONLY;
+  SourceLocation getLocEnd() const LLVM_READONLY;
+
+  static bool classof(const Stmt *T) {
+    return T->getStmtClass() == DataArrayExprClass;
+  }
+
+  // Iterators
+  child_range children() {
+    return child_range(child_iterator(), child_iterator());
+  }
+
+  friend TrailingObjects;
+};
+
 // In cases like:
 //   struct Q { int a, b, c; };
 //   Q *getQ();
@@ -2151,6 +2151,12 @@ DEF_TRAVERSE_STMT(InitListExpr, {
   ShouldVisitChildren = false;
 })
 
+// DataArrayExpr has no children of its own; traverse the initializer list
+// it was built from.
+DEF_TRAVERSE_STMT(DataArrayExpr, {
+  TRY_TO_TRAVERSE_OR_ENQUEUE_STMT(S->getSyntacticForm());
+})
+
 // GenericSelectionExpr is a special case because the types and expressions
 // are interleaved.  We also need to watch out for null types (default
 // generic associations).
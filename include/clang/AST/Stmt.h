@@ -362,6 +362,7 @@ public:
   static void addStmtClass(const StmtClass s);
   static void EnableStatistics();
   static void PrintStats();
+  static void PrintStatsJSON(raw_ostream &OS);
 
   /// \brief Dumps the specified AST fragment and all subtrees to
   /// \c llvm::errs().
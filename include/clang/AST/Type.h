@@ -2669,6 +2669,9 @@ class DependentSizedArrayType : public ArrayType {
   /// The range spanned by the left and right array brackets.
   SourceRange Brackets;
 
+  /// The hash of the profile, set when the type is uniqued.
+  unsigned ProfileHash = 0;
+
   DependentSizedArrayType(const ASTContext &Context, QualType et, QualType can,
                           Expr *e, ArraySizeModifier sm, unsigned tq,
                           SourceRange brackets);
@@ -2699,6 +2702,7 @@ public:
     Profile(ID, Context, getElementType(),
             getSizeModifier(), getIndexTypeCVRQualifiers(), getSizeExpr());
   }
+  unsigned getProfileHash() const { return ProfileHash; }
 
   static void Profile(llvm::FoldingSetNodeID &ID, const ASTContext &Context,
                       QualType ET, ArraySizeModifier SizeMod,
@@ -2722,6 +2726,9 @@ class DependentSizedExtVectorType : public Type, public llvm::FoldingSetNode {
   QualType ElementType;
   SourceLocation loc;
 
+  /// The hash of the profile, set when the type is uniqued.
+  unsigned ProfileHash = 0;
+
   DependentSizedExtVectorType(const ASTContext &Context, QualType ElementType,
                               QualType can, Expr *SizeExpr, SourceLocation loc);
 
@@ -2742,6 +2749,7 @@ public:
   void Profile(llvm::FoldingSetNodeID &ID) {
     Profile(ID, Context, getElementType(), getSizeExpr());
   }
+  unsigned getProfileHash() const { return ProfileHash; }
 
   static void Profile(llvm::FoldingSetNodeID &ID, const ASTContext &Context,
                       QualType ElementType, Expr *SizeExpr);
@@ -3550,6 +3558,11 @@ class DependentTypeOfExprType
   : public TypeOfExprType, public llvm::FoldingSetNode {
   const ASTContext &Context;
 
+  /// The hash of the profile, set when the type is uniqued.
+  unsigned ProfileHash = 0;
+
+  friend class ASTContext;
+
 public:
   DependentTypeOfExprType(const ASTContext &Context, Expr *E)
     : TypeOfExprType(E), Context(Context) { }
@@ -3557,6 +3570,7 @@ public:
   void Profile(llvm::FoldingSetNodeID &ID) {
     Profile(ID, Context, getUnderlyingExpr());
   }
+  unsigned getProfileHash() const { return ProfileHash; }
 
   static void Profile(llvm::FoldingSetNodeID &ID, const ASTContext &Context,
                       Expr *E);
@@ -3616,12 +3630,18 @@ public:
 class DependentDecltypeType : public DecltypeType, public llvm::FoldingSetNode {
   const ASTContext &Context;
 
+  /// The hash of the profile, set when the type is uniqued.
+  unsigned ProfileHash = 0;
+
+  friend class ASTContext;
+
 public:
   DependentDecltypeType(const ASTContext &Context, Expr *E);
 
   void Profile(llvm::FoldingSetNodeID &ID) {
     Profile(ID, Context, getUnderlyingExpr());
   }
+  unsigned getProfileHash() const { return ProfileHash; }
 
   static void Profile(llvm::FoldingSetNodeID &ID, const ASTContext &Context,
                       Expr *E);
@@ -5861,6 +5881,42 @@ inline const ArrayType *Type::castAsArrayTypeUnsafe() const {
   return cast<ArrayType>(getUnqualifiedDesugaredType());
 }
 
+/// \brief Folding set traits for the uniqued dependent types whose profile
+/// includes an expression.
+///
+/// Profiling an expression walks its whole tree, so ASTContext stores the
+/// hash of the profile in these types when it uniques them. The folding set
+/// compares it before profiling a type in the same bucket, and uses it when
+/// it grows, instead of profiling every type again.
+template <typename T>
+struct ProfileHashFoldingSetTrait : llvm::DefaultFoldingSetTrait<T> {
+  static bool Equals(T &X, const llvm::FoldingSetNodeID &ID, unsigned IDHash,
+                     llvm::FoldingSetNodeID &TempID) {
+    if (X.getProfileHash() != IDHash)
+      return false;
+    X.Profile(TempID);
+    return TempID == ID;
+  }
+  static unsigned ComputeHash(T &X, llvm::FoldingSetNodeID &TempID) {
+    return X.getProfileHash();
+  }
+};
+
 }  // end namespace clang
 
+namespace llvm {
+template <>
+struct FoldingSetTrait<clang::DependentSizedArrayType>
+    : clang::ProfileHashFoldingSetTrait<clang::DependentSizedArrayType> {};
+template <>
+struct FoldingSetTrait<clang::DependentSizedExtVectorType>
+    : clang::ProfileHashFoldingSetTrait<clang::DependentSizedExtVectorType> {};
+template <>
+struct FoldingSetTrait<clang::DependentTypeOfExprType>
+    : clang::ProfileHashFoldingSetTrait<clang::DependentTypeOfExprType> {};
+template <>
+struct FoldingSetTrait<clang::DependentDecltypeType>
+    : clang::ProfileHashFoldingSetTrait<clang::DependentDecltypeType> {};
+} // end namespace llvm
+
 #endif
@@ -121,6 +121,8 @@ public:
   };
 
   struct MatchFinderOptions {
+    MatchFinderOptions() : NumThreads(1) {}
+
     struct Profiling {
       Profiling(llvm::StringMap<llvm::TimeRecord> &Records)
           : Records(Records) {}
@@ -133,6 +135,20 @@ public:
     ///
     /// It prints a report after match.
     llvm::Optional<Profiling> CheckProfiling;
+
+    /// \brief The number of threads \c matchAST() matches on.
+    ///
+    /// With more than one thread, the top level declarations of the
+    /// translation unit are split between the threads, each with its own
+    /// memoization state. The matches are buffered, and the callbacks are
+    /// then called on the calling thread in the same order as when matching
+    /// on a single thread.
+    ///
+    /// The matchers themselves run concurrently, so they must only read the
+    /// AST: matchers which make the \c ASTContext or the \c SourceManager
+    /// compute and cache something, such as a record layout or the file of a
+    /// location, are not safe to use with more than one thread.
+    unsigned NumThreads;
   };
 
   MatchFinder(MatchFinderOptions Options = MatchFinderOptions());
@@ -188,6 +204,8 @@ public:
   /// @}
 
   /// \brief Finds all matches in the given AST.
+  ///
+  /// See \c MatchFinderOptions::NumThreads for matching on several threads.
   void matchAST(ASTContext &Context);
 
   /// \brief Registers a callback to notify the end of parsing.
@@ -47,6 +47,7 @@
 #include "clang/AST/StmtObjC.h"
 #include "clang/AST/Type.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/ManagedStatic.h"
@@ -152,6 +153,9 @@ public:
   bool operator<(const BoundNodesMap &Other) const {
     return NodeMap < Other.NodeMap;
   }
+  bool operator==(const BoundNodesMap &Other) const {
+    return NodeMap == Other.NodeMap;
+  }
 
   /// \brief A map from IDs to the bound nodes.
   ///
@@ -223,6 +227,20 @@ public:
   bool operator<(const BoundNodesTreeBuilder &Other) const {
     return Bindings < Other.Bindings;
   }
+  bool operator==(const BoundNodesTreeBuilder &Other) const {
+    return Bindings == Other.Bindings;
+  }
+
+  /// \brief Returns a hash of the bound nodes, for a comparable
+  /// \c BoundNodesTreeBuilder.
+  unsigned getHashValue() const {
+    llvm::hash_code Hash = llvm::hash_value(Bindings.size());
+    for (const BoundNodesMap &NodesMap : Bindings)
+      for (const auto &IDAndNode : NodesMap.getMap())
+        Hash = llvm::hash_combine(Hash, IDAndNode.first,
+                                  IDAndNode.second.getMemoizationData());
+    return Hash;
+  }
 
   /// \brief Returns \c true if this \c BoundNodesTreeBuilder can be compared,
   /// i.e. all stored node maps have memoization data.
@@ -398,6 +416,14 @@ public:
     return SupportedKind;
   }
 
+  /// \brief Returns the kind of the nodes this matcher can match.
+  ///
+  /// This is \c getSupportedKind() or a type derived from it, which the
+  /// matcher was restricted to by \c dynCastTo().
+  ast_type_traits::ASTNodeKind getRestrictKind() const {
+    return RestrictKind;
+  }
+
   /// \brief Returns \c true if the passed \c DynTypedMatcher can be converted
   ///   to a \c Matcher<T>.
   ///
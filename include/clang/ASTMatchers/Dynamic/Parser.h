@@ -41,6 +41,10 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringRef.h"
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
 
 namespace clang {
 namespace ast_matchers {
@@ -141,6 +145,47 @@ public:
     getMatcherCompletions(llvm::ArrayRef<ArgKind> AcceptedTypes) override;
   };
 
+  /// \brief Registry Sema that shares the matchers of identical matcher
+  ///   expressions.
+  ///
+  /// A matcher expression that has the same constructor, bind ID and
+  /// arguments as one processed before evaluates to the same matcher objects,
+  /// whether it appears in the same or in a later expression parsed with this
+  /// Sema. Besides saving the construction of the matchers, this lets a
+  /// \c MatchFinder running several expressions memoize the results of their
+  /// common inner matchers (e.g. \c hasAncestor arguments) once for all of
+  /// them.
+  class CachingRegistrySema : public RegistrySema {
+  public:
+    ~CachingRegistrySema() override;
+
+    VariantMatcher actOnMatcherExpression(MatcherCtor Ctor,
+                                          SourceRange NameRange,
+                                          StringRef BindID,
+                                          ArrayRef<ParserValue> Args,
+                                          Diagnostics *Error) override;
+
+    /// \brief Forgets all the matchers constructed so far.
+    void clear() { Cache.clear(); }
+
+  private:
+    /// \brief An argument of a cached matcher expression.
+    ///
+    /// Matcher arguments are compared by identity; they are kept alive by
+    /// the key so that their identity can't be reused.
+    struct ArgKey {
+      enum { AK_Unsigned, AK_String, AK_Matcher } Kind;
+      unsigned Unsigned;
+      std::string String;
+      VariantMatcher Matcher;
+
+      bool operator<(const ArgKey &Other) const;
+    };
+
+    typedef std::tuple<MatcherCtor, std::string, std::vector<ArgKey>> CacheKey;
+    std::map<CacheKey, VariantMatcher> Cache;
+  };
+
   typedef llvm::StringMap<VariantValue> NamedValueMap;
 
   /// \brief Parse a matcher expression.
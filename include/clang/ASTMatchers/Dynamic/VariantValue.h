@@ -208,6 +208,12 @@ public:
   /// the types.
   std::string getTypeAsString() const;
 
+  /// \brief Returns an opaque pointer identifying the underlying matchers.
+  ///
+  /// Copies of a \c VariantMatcher share the same matchers, and so the same
+  /// pointer.
+  const void *getOpaqueID() const { return Value.get(); }
+
 private:
   explicit VariantMatcher(Payload *Value) : Value(Value) {}
 
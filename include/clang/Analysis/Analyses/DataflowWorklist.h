@@ -0,0 +1,104 @@
+//===- DataflowWorklist.h - Worklists for dataflow analyses -------*- C++ --*-//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the worklists shared by the dataflow analyses over source
+// CFGs. A forward analysis visits the blocks in reverse post order, and a
+// backward analysis in post order, whatever order they were enqueued in.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_ANALYSIS_ANALYSES_DATAFLOWWORKLIST_H
+#define LLVM_CLANG_ANALYSIS_ANALYSES_DATAFLOWWORKLIST_H
+
+#include "clang/Analysis/Analyses/PostOrderCFGView.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/PriorityQueue.h"
+#include "llvm/ADT/SmallVector.h"
+
+namespace clang {
+
+/// A worklist of CFG blocks which holds each block at most once, and hands
+/// them out in the order given by \p Comp, the highest first. Enqueuing and
+/// dequeuing a block take a time logarithmic in the size of the worklist.
+template <typename Comp> class DataflowWorklistBase {
+  llvm::BitVector EnqueuedBlocks;
+  llvm::PriorityQueue<const CFGBlock *, SmallVector<const CFGBlock *, 20>,
+                      Comp> WorkList;
+
+public:
+  DataflowWorklistBase(const CFG &Cfg, Comp C)
+      : EnqueuedBlocks(Cfg.getNumBlockIDs()), WorkList(C) {}
+
+  void enqueueBlock(const CFGBlock *Block) {
+    if (Block && !EnqueuedBlocks[Block->getBlockID()]) {
+      EnqueuedBlocks[Block->getBlockID()] = true;
+      WorkList.push(Block);
+    }
+  }
+
+  const CFGBlock *dequeue() {
+    if (WorkList.empty())
+      return nullptr;
+    const CFGBlock *Block = WorkList.top();
+    WorkList.pop();
+    EnqueuedBlocks[Block->getBlockID()] = false;
+    return Block;
+  }
+};
+
+/// Orders the blocks in reverse post order, for a forward analysis.
+struct ReversePostOrderCompare {
+  PostOrderCFGView::BlockOrderCompare Cmp;
+  ReversePostOrderCompare(PostOrderCFGView::BlockOrderCompare Cmp)
+      : Cmp(Cmp) {}
+  bool operator()(const CFGBlock *LHS, const CFGBlock *RHS) const {
+    return Cmp(RHS, LHS);
+  }
+};
+
+/// A worklist for a forward analysis, which visits the blocks in reverse post
+/// order, so that a block is analyzed after its predecessors but for the
+/// ones on back edges.
+class ForwardDataflowWorklist
+    : public DataflowWorklistBase<ReversePostOrderCompare> {
+public:
+  ForwardDataflowWorklist(const CFG &Cfg, AnalysisDeclContext &Ctx)
+      : DataflowWorklistBase(
+            Cfg, ReversePostOrderCompare(
+                     Ctx.getAnalysis<PostOrderCFGView>()->getComparator())) {}
+
+  void enqueueSuccessors(const CFGBlock *Block) {
+    for (CFGBlock::const_succ_iterator I = Block->succ_begin(),
+                                       E = Block->succ_end();
+         I != E; ++I)
+      enqueueBlock(*I);
+  }
+};
+
+/// A worklist for a backward analysis, which visits the blocks in post order,
+/// so that a block is analyzed after its successors but for the ones on back
+/// edges.
+class BackwardDataflowWorklist
+    : public DataflowWorklistBase<PostOrderCFGView::BlockOrderCompare> {
+public:
+  BackwardDataflowWorklist(const CFG &Cfg, AnalysisDeclContext &Ctx)
+      : DataflowWorklistBase(
+            Cfg, Ctx.getAnalysis<PostOrderCFGView>()->getComparator()) {}
+
+  void enqueuePredecessors(const CFGBlock *Block) {
+    for (CFGBlock::const_pred_iterator I = Block->pred_begin(),
+                                       E = Block->pred_end();
+         I != E; ++I)
+      enqueueBlock(*I);
+  }
+};
+
+} // end namespace clang
+
+#endif
@@ -20,6 +20,8 @@
 #define LLVM_CLANG_ANALYSIS_ANALYSES_FORMATSTRING_H
 
 #include "clang/AST/CanonicalType.h"
+#include <string>
+#include <vector>
 
 namespace clang {
 
@@ -672,6 +674,70 @@ bool ParseScanfString(FormatStringHandler &H,
                       const char *beg, const char *end, const LangOptions &LO,
                       const TargetInfo &Target);
 
+/// \brief A format string that was parsed once, and whose handler callbacks
+/// can be replayed to any number of handlers.
+///
+/// Calls that share a format string, e.g. because they come from the same
+/// logging macro, only need to parse it once. The locations passed to the
+/// handlers point into the copy of the format string held by this object,
+/// see \c getString().
+class ParsedFormatString {
+public:
+  enum FormatKind { Printf, FreeBSDKPrintf, Scanf };
+
+  ParsedFormatString(StringRef Str, FormatKind Kind, const LangOptions &LO,
+                     const TargetInfo &Target);
+  ParsedFormatString(const ParsedFormatString &) = delete;
+  void operator=(const ParsedFormatString &) = delete;
+
+  /// \brief Retrieve the copy of the format string that the locations passed
+  /// to the handlers point into.
+  StringRef getString() const { return Str; }
+
+  /// \brief Pass the callbacks recorded while parsing to \p H, in order.
+  ///
+  /// \returns the value ParsePrintfString or ParseScanfString would have
+  /// returned for \p H.
+  bool replay(FormatStringHandler &H) const;
+
+private:
+  class Recorder;
+
+  enum EventKind {
+    EK_NullChar,
+    EK_Position,
+    EK_InvalidPosition,
+    EK_ZeroPosition,
+    EK_IncompleteSpecifier,
+    EK_EmptyObjCModifierFlag,
+    EK_InvalidObjCModifierFlag,
+    EK_ObjCFlagsWithNonObjCConversion,
+    EK_InvalidPrintfConversionSpecifier,
+    EK_PrintfSpecifier,
+    EK_InvalidScanfConversionSpecifier,
+    EK_ScanfSpecifier,
+    EK_IncompleteScanList
+  };
+
+  struct Event {
+    EventKind Kind;
+    const char *Start;
+    const char *End;
+    const char *Conversion;
+    unsigned Len;
+    PositionContext Context;
+    /// \brief The index of the specifier of a specifier event.
+    unsigned Index;
+  };
+
+  std::string Str;
+  std::vector<Event> Events;
+  std::vector<analyze_printf::PrintfSpecifier> PrintfSpecifiers;
+  std::vector<analyze_scanf::ScanfSpecifier> ScanfSpecifiers;
+  /// \brief Whether parsing stopped on an error regardless of the handler.
+  bool Stopped;
+};
+
 } // end analyze_format_string namespace
 } // end clang namespace
 #endif
@@ -23,6 +23,10 @@
 #include "llvm/Support/Allocator.h"
 #include <memory>
 
+namespace llvm {
+class Timer;
+}
+
 namespace clang {
 
 class Stmt;
@@ -87,6 +91,10 @@ class AnalysisDeclContext {
 
   void *ManagedAnalyses;
 
+  /// Build a CFG with the current build options, timing it and counting it
+  /// in the statistics.
+  std::unique_ptr<CFG> buildCFG();
+
 public:
   AnalysisDeclContext(AnalysisDeclContextManager *Mgr,
                   const Decl *D);
@@ -420,6 +428,9 @@ class AnalysisDeclContextManager {
   /// for well-known functions.
   bool SynthesizeBodies;
 
+  /// The timer for building the CFGs of the contexts, or null.
+  llvm::Timer *CFGBuildTimer;
+
 public:
   AnalysisDeclContextManager(bool useUnoptimizedCFG = false,
                              bool addImplicitDtors = false,
@@ -446,6 +457,10 @@ public:
   /// functions.
   bool synthesizeBodies() const { return SynthesizeBodies; }
 
+  /// Time the construction of the CFGs of the contexts with the given timer.
+  void setCFGBuildTimer(llvm::Timer *T) { CFGBuildTimer = T; }
+  llvm::Timer *getCFGBuildTimer() const { return CFGBuildTimer; }
+
   const StackFrameContext *getStackFrame(AnalysisDeclContext *Ctx,
                                          LocationContext const *Parent,
                                          const Stmt *S,
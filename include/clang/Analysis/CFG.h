@@ -949,7 +949,11 @@ public:
 
   CFG()
     : Entry(nullptr), Exit(nullptr), IndirectGotoBlock(nullptr), NumBlockIDs(0),
-      Blocks(BlkBVC, 10) {}
+      Blocks(BlkBVC, 10) {
+    // The element and edge vectors of the blocks grow one push_back at a
+    // time while the CFG is built; reuse what they leave behind.
+    BlkBVC.enableRecycling();
+  }
 
   llvm::BumpPtrAllocator& getAllocator() {
     return BlkBVC.getAllocator();
@@ -19,9 +19,11 @@
 
 #include "clang/AST/DeclBase.h"
 #include "clang/AST/RecursiveASTVisitor.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/GraphTraits.h"
 #include "llvm/ADT/SetVector.h"
+#include <vector>
 
 namespace clang {
 class CallGraphNode;
@@ -42,6 +44,10 @@ class CallGraph : public RecursiveASTVisitor<CallGraph> {
   /// This is a virtual root node that has edges to all the functions.
   CallGraphNode *Root;
 
+  /// While non-null, the functions found by the visitation are queued here
+  /// instead of being added to the graph right away.
+  SmallVectorImpl<Decl *> *PendingDecls;
+
 public:
   CallGraph();
   ~CallGraph();
@@ -54,6 +60,14 @@ public:
     TraverseDecl(D);
   }
 
+  /// \brief Populate the call graph with the functions in the given
+  /// declarations, walking up to \p NumThreads function bodies at once.
+  ///
+  /// The resulting graph is the same as the one built by calling
+  /// addToCallGraph() on each declaration in turn: only the search for call
+  /// sites runs in parallel, the nodes and edges are added in the same order.
+  void addToCallGraph(ArrayRef<Decl *> Decls, unsigned NumThreads);
+
   /// \brief Determine if a declaration should be included in the graph.
   static bool includeInGraph(const Decl *D);
 
@@ -166,6 +180,55 @@ public:
   void dump() const;
 };
 
+/// \brief Hands out the functions of a call graph in batches, callees first.
+///
+/// Functions which call each other are grouped into a strongly connected
+/// component (SCC), which is scheduled as a whole. A component becomes ready
+/// once all the components it calls into have been completed, so the
+/// components that are ready at the same time never call each other and can
+/// be processed in parallel, e.g. to compute function summaries bottom-up.
+class CallGraphSCCScheduler {
+  /// The components in post order, i.e. callees before their callers.
+  std::vector<std::vector<const CallGraphNode *>> SCCs;
+
+  /// For each component, the components calling into it.
+  std::vector<SmallVector<unsigned, 4>> Callers;
+
+  /// For each component, the number of callee components not yet completed.
+  std::vector<unsigned> NumPendingCallees;
+
+  /// The components that became ready and have not been handed out yet.
+  SmallVector<unsigned, 16> Ready;
+
+  unsigned NumCompleted;
+
+public:
+  explicit CallGraphSCCScheduler(const CallGraph &CG);
+
+  /// \brief Get the number of components in the graph.
+  unsigned getNumSCCs() const { return SCCs.size(); }
+
+  /// \brief Get the functions of the component with the given index.
+  ArrayRef<const CallGraphNode *> getSCC(unsigned Index) const {
+    return SCCs[Index];
+  }
+
+  /// \brief Move the indices of the components that are ready to be
+  /// processed into \p Batch.
+  ///
+  /// Each component is handed out once. The batch is empty if no component is
+  /// ready, either because all of them have been handed out or because those
+  /// that would be are waiting for components still being processed.
+  void takeReadyBatch(SmallVectorImpl<unsigned> &Batch);
+
+  /// \brief Mark a component that was handed out as processed, which may make
+  /// its callers ready.
+  void markCompleted(unsigned Index);
+
+  /// \brief Determine whether all the components have been completed.
+  bool isFinished() const { return NumCompleted == SCCs.size(); }
+};
+
 } // end clang namespace
 
 // Graph traits for iteration, viewing.
@@ -19,7 +19,9 @@
 #ifndef LLVM_CLANG_ANALYSIS_SUPPORT_BUMPVECTOR_H
 #define LLVM_CLANG_ANALYSIS_SUPPORT_BUMPVECTOR_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/PointerIntPair.h"
+#include "llvm/Support/AlignOf.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/type_traits.h"
 #include <algorithm>
@@ -31,20 +33,32 @@ namespace clang {
   
 class BumpVectorContext {
   llvm::PointerIntPair<llvm::BumpPtrAllocator*, 1> Alloc;
+
+  /// Whether the buffers that BumpVectors give up when they grow are reused.
+  bool Recycle;
+
+  /// The buffers given up, by size and alignment. Each one starts with a
+  /// pointer to the next one of the same size and alignment.
+  llvm::DenseMap<std::pair<size_t, size_t>, void *> FreeBuffers;
+
 public:
   /// Construct a new BumpVectorContext that creates a new BumpPtrAllocator
   /// and destroys it when the BumpVectorContext object is destroyed.
-  BumpVectorContext() : Alloc(new llvm::BumpPtrAllocator(), 1) {}
+  BumpVectorContext()
+      : Alloc(new llvm::BumpPtrAllocator(), 1), Recycle(false) {}
 
-  BumpVectorContext(BumpVectorContext &&Other) : Alloc(Other.Alloc) {
+  BumpVectorContext(BumpVectorContext &&Other)
+      : Alloc(Other.Alloc), Recycle(Other.Recycle),
+        FreeBuffers(std::move(Other.FreeBuffers)) {
     Other.Alloc.setInt(false);
     Other.Alloc.setPointer(nullptr);
+    Other.FreeBuffers.clear();
   }
 
   /// Construct a new BumpVectorContext that reuses an existing
   /// BumpPtrAllocator.  This BumpPtrAllocator is not destroyed when the
   /// BumpVectorContext object is destroyed.
-  BumpVectorContext(llvm::BumpPtrAllocator &A) : Alloc(&A, 0) {}
+  BumpVectorContext(llvm::BumpPtrAllocator &A) : Alloc(&A, 0), Recycle(false) {}
   
   ~BumpVectorContext() {
     if (Alloc.getInt())
@@ -52,6 +66,37 @@ public:
   }
   
   llvm::BumpPtrAllocator &getAllocator() { return *Alloc.getPointer(); }
+
+  /// Reuse the buffers that the BumpVectors of this context give up when they
+  /// grow, instead of leaking them until the allocator is destroyed. This is
+  /// only safe if nothing keeps pointers into a vector across a push_back or
+  /// an insert.
+  void enableRecycling() { Recycle = true; }
+
+  /// Allocate a buffer for \p N objects of type T.
+  template <typename T> T *allocate(size_t N) {
+    if (Recycle) {
+      llvm::DenseMap<std::pair<size_t, size_t>, void *>::iterator I =
+          FreeBuffers.find(std::make_pair(N * sizeof(T), llvm::alignOf<T>()));
+      if (I != FreeBuffers.end() && I->second) {
+        void *Buffer = I->second;
+        I->second = *static_cast<void **>(Buffer);
+        return static_cast<T *>(Buffer);
+      }
+    }
+    return getAllocator().template Allocate<T>(N);
+  }
+
+  /// Give back a buffer for \p N objects of type T, which holds none.
+  template <typename T> void deallocate(T *Buffer, size_t N) {
+    if (!Recycle || N * sizeof(T) < sizeof(void *) ||
+        llvm::alignOf<T>() < llvm::alignOf<void *>())
+      return;
+    void *&Head =
+        FreeBuffers[std::make_pair(N * sizeof(T), llvm::alignOf<T>())];
+    *reinterpret_cast<void **>(Buffer) = Head;
+    Head = Buffer;
+  }
 };
   
 template<typename T>
@@ -225,7 +270,7 @@ void BumpVector<T>::grow(BumpVectorContext &C, size_t MinSize) {
     NewCapacity = MinSize;
 
   // Allocate the memory from the BumpPtrAllocator.
-  T *NewElts = C.getAllocator().template Allocate<T>(NewCapacity);
+  T *NewElts = C.allocate<T>(NewCapacity);
   
   // Copy the elements over.
   if (Begin != End) {
@@ -239,8 +284,9 @@ void BumpVector<T>::grow(BumpVectorContext &C, size_t MinSize) {
     }
   }
 
-  // For now, leak 'Begin'.  We can add it back to a freelist in
-  // BumpVectorContext.
+  // Give 'Begin' back, for the context to reuse if it recycles buffers.
+  if (Begin)
+    C.deallocate(Begin, CurCapacity);
   Begin = NewElts;
   End = NewElts+CurSize;
   Capacity = Begin+NewCapacity;
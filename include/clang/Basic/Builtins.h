@@ -16,7 +16,9 @@
 #ifndef LLVM_CLANG_BASIC_BUILTINS_H
 #define LLVM_CLANG_BASIC_BUILTINS_H
 
+#include "clang/Basic/LLVM.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
 #include <cstring>
 
 // VC++ defines 'alloca' as an object-like macro, which interferes with our
@@ -66,6 +68,16 @@ class Context {
   llvm::ArrayRef<Info> TSRecords;
   llvm::ArrayRef<Info> AuxTSRecords;
 
+  /// \brief Maps the names of the target-independent, target-specific and
+  /// auxiliary target builtins to their index in the respective table.
+  ///
+  /// These are shared by every Context in the process and set up by
+  /// initializeBuiltins().
+  class NameMap;
+  const NameMap *Names = nullptr;
+  const NameMap *TSNames = nullptr;
+  const NameMap *AuxTSNames = nullptr;
+
 public:
   Context() {}
 
@@ -76,8 +88,24 @@ public:
   /// \brief Mark the identifiers for all the builtins with their
   /// appropriate builtin ID # and mark any non-portable builtin identifiers as
   /// such.
+  ///
+  /// Only the identifiers \p Table already contains are marked right away;
+  /// the others are marked when \p Table creates them, so that a translation
+  /// unit doesn't pay for the thousands of target builtins it never names.
   void initializeBuiltins(IdentifierTable &Table, const LangOptions& LangOpts);
 
+  /// \brief Mark the identifiers \p Table creates from now on with their
+  /// builtin ID, leaving the ones it already contains alone.
+  ///
+  /// This is what an AST file that recorded the builtin IDs of its
+  /// identifiers needs.
+  void initializeLazyBuiltins(IdentifierTable &Table,
+                              const LangOptions &LangOpts);
+
+  /// \brief Return the ID initializeBuiltins() assigns to the identifier
+  /// \p Name, or 0 if it doesn't name a builtin supported by \p LangOpts.
+  unsigned lookupBuiltinID(StringRef Name, const LangOptions &LangOpts) const;
+
   /// \brief Return the identifier name for the specified builtin,
   /// e.g. "__builtin_abs".
   const char *getName(unsigned ID) const {
@@ -205,9 +233,13 @@ public:
 private:
   const Info &getRecord(unsigned ID) const;
 
+  /// \brief Return the name map of \p Records, building it if this is the
+  /// first time it is asked for.
+  static const NameMap *getNameMap(ArrayRef<Info> Records);
+
   /// \brief Is this builtin supported according to the given language options?
   bool builtinIsSupported(const Builtin::Info &BuiltinInfo,
-                          const LangOptions &LangOpts);
+                          const LangOptions &LangOpts) const;
 
   /// \brief Helper function for isPrintfLike and isScanfLike.
   bool isLike(unsigned ID, unsigned &FormatIdx, bool &HasVAListArg,
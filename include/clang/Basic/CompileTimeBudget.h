@@ -0,0 +1,146 @@
+//===--- CompileTimeBudget.h - Watchdog for slow compilations ---*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the CompileTimeBudget class, which reports what the
+/// compiler is doing once a compilation takes longer than expected.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_BASIC_COMPILETIMEBUDGET_H
+#define LLVM_CLANG_BASIC_COMPILETIMEBUDGET_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Config/llvm-config.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#ifdef LLVM_ON_UNIX
+#include <pthread.h>
+#endif
+
+namespace clang {
+
+/// \brief A watchdog that reports on a compilation that exceeds its time
+/// budget.
+///
+/// A watchdog thread waits for the budget to run out. It then writes the
+/// current phase of the compilation to the report and raises a flag that the
+/// compiling thread polls at its checkpoints: when instantiating a template,
+/// evaluating a constant expression step, and emitting code for a function.
+/// The first checkpoint reached afterwards appends what it is working on,
+/// e.g. the stack of template instantiations, to the report.
+///
+/// If requested, the compilation is aborted after the report is complete, so
+/// that the crash handler also prints the pretty stack trace of the compiling
+/// thread. A compilation stuck outside of any checkpoint, e.g. in an LLVM
+/// pass, is aborted by the watchdog after a short grace period.
+///
+/// At most one budget is active at a time; instrumented code checks
+/// \c CompileTimeBudget::isExceeded(), which costs a single relaxed load.
+class CompileTimeBudget {
+  typedef std::chrono::steady_clock ClockType;
+
+  const std::chrono::seconds Budget;
+  const std::string ReportPath;
+  const bool AbortWhenExceeded;
+  const ClockType::time_point StartTime;
+
+  std::mutex Mutex;
+  std::condition_variable Changed;
+  /// \brief Whether the compilation finished; guarded by Mutex.
+  bool Finished = false;
+  /// \brief Whether a checkpoint reported its activity.
+  std::atomic<bool> ActivityReported;
+  /// \brief The report written so far; guarded by Mutex.
+  std::string Report;
+
+  std::thread Watchdog;
+#ifdef LLVM_ON_UNIX
+  pthread_t CompilingThread;
+#endif
+
+  static std::atomic<bool> Exceeded;
+  static std::atomic<const char *> CurrentPhase;
+
+  CompileTimeBudget(const CompileTimeBudget &) = delete;
+  void operator=(const CompileTimeBudget &) = delete;
+
+  void runWatchdog();
+
+  /// \brief Write Report to the report file, or to stderr if there is none.
+  /// Mutex must be held.
+  void writeReport();
+
+public:
+  /// \brief Start the watchdog.
+  ///
+  /// \param Seconds The time the compilation may take.
+  /// \param ReportPath The file to write the report to, or empty to write it
+  /// to stderr.
+  /// \param AbortWhenExceeded Whether to abort the compilation once the budget
+  /// is exceeded.
+  CompileTimeBudget(unsigned Seconds, StringRef ReportPath,
+                    bool AbortWhenExceeded);
+
+  /// \brief Stop the watchdog.
+  ~CompileTimeBudget();
+
+  /// \brief Retrieve the active budget, or null if there is none.
+  static CompileTimeBudget *getActive();
+
+  /// \brief Make \p Budget the active budget. Pass null to disable it.
+  static void setActive(CompileTimeBudget *Budget);
+
+  /// \brief Determine whether the active budget, if any, has been exceeded.
+  static bool isExceeded() { return Exceeded.load(std::memory_order_relaxed); }
+
+  /// \brief Retrieve the name of the current phase of the compilation.
+  static const char *getPhase() {
+    return CurrentPhase.load(std::memory_order_relaxed);
+  }
+
+  /// \brief Set the name of the current phase of the compilation.
+  static void setPhase(const char *Phase) {
+    CurrentPhase.store(Phase, std::memory_order_relaxed);
+  }
+
+  /// \brief Called by a checkpoint on the compiling thread once the budget
+  /// is exceeded: appends \p Activity and the output of \p Describe to the
+  /// report, and aborts the compilation if requested. Only the first call
+  /// has an effect.
+  void reportActivity(StringRef Activity,
+                      llvm::function_ref<void(raw_ostream &)> Describe);
+};
+
+/// \brief RAII object that sets the phase of the compilation reported when
+/// the compile-time budget is exceeded for the duration of a scope.
+class CompileTimePhaseScope {
+  const char *SavedPhase;
+
+  CompileTimePhaseScope(const CompileTimePhaseScope &) = delete;
+  void operator=(const CompileTimePhaseScope &) = delete;
+
+public:
+  explicit CompileTimePhaseScope(const char *Phase)
+      : SavedPhase(CompileTimeBudget::getPhase()) {
+    CompileTimeBudget::setPhase(Phase);
+  }
+
+  ~CompileTimePhaseScope() { CompileTimeBudget::setPhase(SavedPhase); }
+};
+
+} // end namespace clang
+
+#endif
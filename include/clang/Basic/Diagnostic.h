@@ -20,6 +20,7 @@
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/Specifiers.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/iterator_range.h"
@@ -278,6 +279,24 @@ private:
   /// the given source location.
   DiagStatePointsTy::iterator GetDiagStatePointForLoc(SourceLocation Loc) const;
 
+  /// \brief For each builtin diagnostic, whether it is ignored in every
+  /// DiagState, if \c IgnoredEverywhereKnown says that was computed.
+  ///
+  /// Checking whether a diagnostic is ignored at a location needs to find
+  /// the DiagState of the location first, which compares source locations;
+  /// most ignored warnings are ignored regardless of the location, which
+  /// this caches.
+  mutable llvm::BitVector IgnoredEverywhere;
+  mutable llvm::BitVector IgnoredEverywhereKnown;
+
+  /// \brief Forget which diagnostics are ignored everywhere.  Must be called
+  /// whenever a mapping or a flag that affects it changes.
+  void invalidateIgnoredEverywhere() { IgnoredEverywhereKnown.reset(); }
+
+  /// \brief Whether \p DiagID is known to be ignored in every DiagState,
+  /// regardless of the location it is reported at.
+  bool isIgnoredEverywhere(unsigned DiagID) const;
+
   /// \brief Sticky flag set to \c true when an error is emitted.
   bool ErrorOccurred;
 
@@ -438,14 +457,20 @@ public:
   /// \brief When set to true, any unmapped warnings are ignored.
   ///
   /// If this and WarningsAsErrors are both set, then this one wins.
-  void setIgnoreAllWarnings(bool Val) { IgnoreAllWarnings = Val; }
+  void setIgnoreAllWarnings(bool Val) {
+    IgnoreAllWarnings = Val;
+    invalidateIgnoredEverywhere();
+  }
   bool getIgnoreAllWarnings() const { return IgnoreAllWarnings; }
 
   /// \brief When set to true, any unmapped ignored warnings are no longer
   /// ignored.
   ///
   /// If this and IgnoreAllWarnings are both set, then that one wins.
-  void setEnableAllWarnings(bool Val) { EnableAllWarnings = Val; }
+  void setEnableAllWarnings(bool Val) {
+    EnableAllWarnings = Val;
+    invalidateIgnoredEverywhere();
+  }
   bool getEnableAllWarnings() const { return EnableAllWarnings; }
 
   /// \brief When set to true, any warnings reported are issued as errors.
@@ -519,7 +544,10 @@ public:
   /// mapped onto ignore/warning/error. 
   ///
   /// This corresponds to the GCC -pedantic and -pedantic-errors option.
-  void setExtensionHandlingBehavior(diag::Severity H) { ExtBehavior = H; }
+  void setExtensionHandlingBehavior(diag::Severity H) {
+    ExtBehavior = H;
+    invalidateIgnoredEverywhere();
+  }
   diag::Severity getExtensionHandlingBehavior() const { return ExtBehavior; }
 
   /// \brief Counter bumped when an __extension__  block is/ encountered.
@@ -265,6 +265,16 @@ private:
   getDiagnosticSeverity(unsigned DiagID, SourceLocation Loc,
                         const DiagnosticsEngine &Diag) const LLVM_READONLY;
 
+  /// \brief Returns the severity the mapping \p Mapping gives \p DiagID,
+  /// taking -Weverything, -pedantic and -w into account.
+  ///
+  /// This is the part of the classification that does not depend on the
+  /// location of the diagnostic; if it is \c Ignored, the diagnostic is
+  /// ignored wherever \p Mapping applies.
+  diag::Severity getMappedSeverity(unsigned DiagID,
+                                   const DiagnosticMapping &Mapping,
+                                   const DiagnosticsEngine &Diag) const;
+
   /// \brief Used to report a diagnostic that is finally fully formed.
   ///
   /// \returns \c true if the diagnostic was emitted, \c false if it was
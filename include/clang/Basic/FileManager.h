@@ -234,6 +234,10 @@ public:
   const FileEntry *getVirtualFile(StringRef Filename, off_t Size,
                                   time_t ModificationTime);
 
+  /// \brief Whether any "virtual" file has been created with
+  /// \c getVirtualFile().
+  bool hasVirtualFiles() const { return !VirtualFileEntries.empty(); }
+
   /// \brief Open the specified file as a MemoryBuffer, returning a new
   /// MemoryBuffer if successful, otherwise returning null.
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
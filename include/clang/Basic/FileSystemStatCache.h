@@ -16,8 +16,13 @@
 #define LLVM_CLANG_BASIC_FILESYSTEMSTATCACHE_H
 
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/RWMutex.h"
 #include <memory>
 
 namespace clang {
@@ -126,6 +131,112 @@ public:
                        vfs::FileSystem &FS) override;
 };
 
+/// \brief The 'stat' results, and optionally file contents, shared by any
+/// number of \c SharedStatCache objects, possibly on different threads.
+///
+/// This allows many FileManager instances in one process, for example the
+/// ones used by a tool running over a whole compilation database, to only hit
+/// the file system once per path.
+///
+/// Only absolute paths are recorded, since relative paths depend on the
+/// working directory of the file system the lookup is performed on. Entries
+/// are never updated or removed, so the cached contents must not change while
+/// the storage is alive.
+class SharedStatCacheStorage
+    : public llvm::ThreadSafeRefCountedBase<SharedStatCacheStorage> {
+public:
+  /// \brief The cached state of an existing file or directory.
+  struct Entry {
+    FileData Data;
+    /// \brief The real path of the file, if it was opened.
+    std::string RealPath;
+    /// \brief The contents of the file, if content caching is enabled and the
+    /// file was opened.
+    std::unique_ptr<llvm::MemoryBuffer> Contents;
+  };
+
+  /// \param CacheMissingFiles Whether failed lookups are recorded as well.
+  /// This avoids most of the stats performed by header search, but breaks
+  /// clients that create files while the storage is alive.
+  /// \param CacheContents Whether the contents of files opened through the
+  /// cache are kept in memory and shared.
+  explicit SharedStatCacheStorage(bool CacheMissingFiles = false,
+                                  bool CacheContents = false)
+      : CacheMissingFiles(CacheMissingFiles), CacheContents(CacheContents) {}
+
+  bool cachesMissingFiles() const { return CacheMissingFiles; }
+  bool cachesContents() const { return CacheContents; }
+
+  /// \brief Looks up the cached entry for \p Path.
+  ///
+  /// \returns the entry if \p Path is known to exist, null otherwise. If
+  /// \p Path is known not to exist as a file (or directory, depending on
+  /// \p isFile), \p KnownMissing is set to true.
+  const Entry *lookup(StringRef Path, bool isFile, bool &KnownMissing) const;
+
+  /// \brief Records that \p Path exists.
+  ///
+  /// If another thread recorded \p Path first, \p E is dropped and the
+  /// existing entry is returned.
+  const Entry &insert(StringRef Path, Entry E);
+
+  /// \brief Records that \p Path does not exist as a file, if \p isFile is
+  /// true, or as a directory otherwise.
+  void insertMissing(StringRef Path, bool isFile);
+
+  /// \brief Returns the number of existing paths recorded.
+  unsigned size() const;
+
+private:
+  const bool CacheMissingFiles;
+  const bool CacheContents;
+
+  mutable llvm::sys::SmartRWMutex<true> Mutex;
+  llvm::StringMap<Entry> Entries;
+  llvm::StringSet<> MissingFiles;
+  llvm::StringSet<> MissingDirectories;
+};
+
+/// \brief A thread-safe stat cache backed by a \c SharedStatCacheStorage.
+///
+/// Each FileManager needs its own \c SharedStatCache object, as it takes
+/// ownership of it, but all of them can refer to the same storage.
+class SharedStatCache : public FileSystemStatCache {
+  IntrusiveRefCntPtr<SharedStatCacheStorage> Storage;
+
+public:
+  explicit SharedStatCache(IntrusiveRefCntPtr<SharedStatCacheStorage> Storage)
+      : Storage(std::move(Storage)) {}
+
+  LookupResult getStat(const char *Path, FileData &Data, bool isFile,
+                       std::unique_ptr<vfs::File> *F,
+                       vfs::FileSystem &FS) override;
+};
+
+/// \brief A stat cache filled in ahead of time by stat'ing a known list of
+/// paths concurrently.
+///
+/// This is meant for clients that are about to look up many files at once,
+/// such as the validation of the input files of an AST file, on a file
+/// system where the latency of each call dominates. Paths that were not
+/// prefetched, and lookups that need to open the file, go down the chain as
+/// usual.
+class PrefetchedStatCache : public FileSystemStatCache {
+  llvm::StringMap<FileData, llvm::BumpPtrAllocator> StatCalls;
+  llvm::StringSet<llvm::BumpPtrAllocator> Missing;
+
+public:
+  /// \brief Stats each of \p Paths on up to \p NumThreads threads.
+  ///
+  /// \p FS must support concurrent calls to \c status.
+  PrefetchedStatCache(ArrayRef<std::string> Paths, vfs::FileSystem &FS,
+                      unsigned NumThreads);
+
+  LookupResult getStat(const char *Path, FileData &Data, bool isFile,
+                       std::unique_ptr<vfs::File> *F,
+                       vfs::FileSystem &FS) override;
+};
+
 } // end namespace clang
 
 #endif
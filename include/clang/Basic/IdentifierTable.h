@@ -21,6 +21,8 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include <cassert>
+#include <cstring>
+#include <memory>
 #include <string>
 
 namespace llvm {
@@ -34,6 +36,7 @@ namespace clang {
   class SourceLocation;
   class MultiKeywordSelector; // private class used by Selector
   class DeclarationName;      // AST class that stores declaration names
+  namespace Builtin { class Context; }
 
   /// \brief A simple pair of identifier info and location.
   typedef std::pair<IdentifierInfo*, SourceLocation> IdentifierLocPair;
@@ -451,6 +454,66 @@ class IdentifierTable {
 
   IdentifierInfoLookup* ExternalLookup;
 
+  /// \brief The builtins whose ID new identifiers are marked with, and the
+  /// language options that decide which of them are supported.
+  const Builtin::Context *Builtins = nullptr;
+  const LangOptions *BuiltinLangOpts = nullptr;
+
+  /// \brief Mark the new identifier \p II with its builtin ID, if any.
+  void initializeBuiltinID(IdentifierInfo &II);
+
+public:
+  /// \brief An open-addressing hash table of every spelling TokenKinds.def
+  /// registers as a keyword, built once per process.
+  ///
+  /// Keywords make up a large share of the identifiers that are looked up.
+  /// Finding them through this table only looks at a few characters of the
+  /// name instead of hashing all of it and probing the StringMap.
+  class KeywordIndex {
+  public:
+    enum { NumSlots = 1024 };
+
+    /// \brief Returns the slot of \p Name, or -1 if it isn't a keyword.
+    int find(StringRef Name) const {
+      if (Name.empty())
+        return -1;
+      for (unsigned Slot = hash(Name);; Slot = (Slot + 1) % NumSlots) {
+        const char *Keyword = Names[Slot];
+        if (!Keyword)
+          return -1;
+        if (Lengths[Slot] == Name.size() &&
+            !memcmp(Keyword, Name.data(), Name.size()))
+          return Slot;
+      }
+    }
+
+    StringRef getName(unsigned Slot) const {
+      return StringRef(Names[Slot], Lengths[Slot]);
+    }
+
+    static const KeywordIndex &get();
+
+  private:
+    KeywordIndex();
+    void add(StringRef Name);
+
+    static unsigned hash(StringRef Name) {
+      return (Name.size() * 97 + (unsigned char)Name[0] * 31 +
+              (unsigned char)Name[Name.size() / 2] * 7 +
+              (unsigned char)Name.back()) % NumSlots;
+    }
+
+    const char *Names[NumSlots];
+    unsigned char Lengths[NumSlots];
+  };
+
+private:
+  const KeywordIndex &Keywords;
+
+  /// \brief The identifier of each keyword in \c Keywords that is one in the
+  /// current language, by slot.
+  std::unique_ptr<IdentifierInfo *[]> KeywordInfos;
+
 public:
   /// \brief Create the identifier table, populating it with info about the
   /// language keywords for the language specified by \p LangOpts.
@@ -466,6 +529,14 @@ public:
   IdentifierInfoLookup *getExternalIdentifierLookup() const {
     return ExternalLookup;
   }
+
+  /// \brief Mark the identifiers created from now on with their ID in
+  /// \p Builtins.  Set up by Builtin::Context::initializeBuiltins().
+  void setBuiltinInfo(const Builtin::Context *Builtins,
+                      const LangOptions *LangOpts) {
+    this->Builtins = Builtins;
+    BuiltinLangOpts = LangOpts;
+  }
   
   llvm::BumpPtrAllocator& getAllocator() {
     return HashTable.getAllocator();
@@ -474,6 +545,10 @@ public:
   /// \brief Return the identifier token info for the specified named
   /// identifier.
   IdentifierInfo &get(StringRef Name) {
+    int Slot = Keywords.find(Name);
+    if (Slot >= 0 && KeywordInfos[Slot])
+      return *KeywordInfos[Slot];
+
     auto &Entry = *HashTable.insert(std::make_pair(Name, nullptr)).first;
 
     IdentifierInfo *&II = Entry.second;
@@ -494,6 +569,9 @@ public:
     // contents.
     II->Entry = &Entry;
 
+    if (Builtins)
+      initializeBuiltinID(*II);
+
     return *II;
   }
 
@@ -525,6 +603,9 @@ public:
     // contents.
     II->Entry = &Entry;
 
+    if (Builtins)
+      initializeBuiltinID(*II);
+
     // If this is the 'import' contextual keyword, mark it as such.
     if (Name.equals("import"))
       II->setModulesImport(true);
@@ -17,6 +17,7 @@
 #include "clang/Basic/LLVM.h"
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/SourceManager.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/SpecialCaseList.h"
 #include <memory>
@@ -27,6 +28,14 @@ class SanitizerBlacklist {
   std::unique_ptr<llvm::SpecialCaseList> SCL;
   SourceManager &SM;
 
+  /// \brief The results of the queries for source files and types, which are
+  /// repeated for every declaration in a file and every check on a type, keyed
+  /// by section, category and name.
+  mutable llvm::StringMap<bool> CachedResults;
+
+  bool inCachedSection(StringRef Section, StringRef Name,
+                       StringRef Category) const;
+
 public:
   SanitizerBlacklist(const std::vector<std::string> &BlacklistPaths,
                      SourceManager &SM);
@@ -641,6 +641,16 @@ class SourceManager : public RefCountedBase<SourceManager> {
   /// is very common to look up many tokens from the same file.
   mutable FileID LastFileIDLookup;
 
+  enum { NumRecentFileIDLookups = 4 };
+
+  /// \brief The files that were in LastFileIDLookup before it, most recent
+  /// first.
+  ///
+  /// Clients such as diagnostics and the preprocessing record tend to bounce
+  /// between a handful of files, which defeats the one-entry cache. This is
+  /// checked before falling back to searching the SLocEntry tables.
+  mutable FileID RecentFileIDLookups[NumRecentFileIDLookups];
+
   /// \brief Holds information for \#line directives.
   ///
   /// This is referenced by indices from SLocEntryTable.
@@ -660,7 +670,7 @@ class SourceManager : public RefCountedBase<SourceManager> {
   FileID PreambleFileID;
 
   // Statistics for -print-stats.
-  mutable unsigned NumLinearScans, NumBinaryProbes;
+  mutable unsigned NumLinearScans, NumBinaryProbes, NumRecentFileIDHits;
 
   /// \brief Associates a FileID with its "included/expanded in" decomposed
   /// location.
@@ -1120,6 +1130,15 @@ public:
     return std::make_pair(FID, Loc.getOffset()-E.getOffset());
   }
 
+  /// \brief Decompose each of the specified locations into a raw FileID +
+  /// Offset pair, as getDecomposedLoc does.
+  ///
+  /// This is faster than calling getDecomposedLoc on each location when runs
+  /// of them fall in the same FileID, as they do when \p Locs is sorted.
+  void getDecomposedLocs(
+      ArrayRef<SourceLocation> Locs,
+      SmallVectorImpl<std::pair<FileID, unsigned>> &Result) const;
+
   /// \brief Decompose the specified location into a raw FileID + Offset pair.
   ///
   /// If the location is an expansion record, walk through it until we find
@@ -1662,6 +1681,7 @@ private:
 
   FileID getFileIDSlow(unsigned SLocOffset) const;
   FileID getFileIDLocal(unsigned SLocOffset) const;
+  void cacheFileIDLookup(FileID FID) const;
   FileID getFileIDLoaded(unsigned SLocOffset) const;
 
   SourceLocation getExpansionLocSlowCase(SourceLocation Loc) const;
@@ -0,0 +1,133 @@
+//===--- TimeTrace.h - Hierarchical compilation time trace ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the TimeTrace class, which records nested regions of
+/// compiler work and writes them out in the Chrome trace event format.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_BASIC_TIMETRACE_H
+#define LLVM_CLANG_BASIC_TIMETRACE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace clang {
+
+/// \brief Records a tree of timed regions ("events") for one compilation.
+///
+/// Events are begun and ended in strict LIFO order. Each completed event
+/// keeps its wall time, the number of events nested inside it, and any
+/// numeric arguments attached to it while it was open. The result can be
+/// loaded into chrome://tracing or any other viewer of the Chrome trace event
+/// format. In addition to the individual events, the trace reports the total
+/// time and count of each kind of event, so that a whole compilation can be
+/// summarized at a glance.
+///
+/// At most one trace is active at a time; instrumented code looks it up with
+/// \c TimeTrace::getActive() and does nothing when there is none, so the
+/// cost of disabled tracing is a single load and branch.
+class TimeTrace {
+  typedef std::chrono::steady_clock ClockType;
+
+  struct Event {
+    std::string Name;
+    std::string Detail;
+    ClockType::time_point Start;
+    ClockType::duration Duration;
+    unsigned NumNested;
+    SmallVector<std::pair<std::string, uint64_t>, 2> Args;
+  };
+
+  /// \brief The events that are currently open, innermost last.
+  std::vector<Event> Stack;
+
+  /// \brief The events that have completed, in the order they ended.
+  std::vector<Event> Completed;
+
+  /// \brief The number of events and the total time spent in them, for each
+  /// event name. Recursive events only count their outermost occurrence.
+  llvm::StringMap<std::pair<unsigned, ClockType::duration>> Totals;
+
+  /// \brief When this trace was created; event times are relative to it.
+  ClockType::time_point StartTime;
+
+  TimeTrace(const TimeTrace &) = delete;
+  void operator=(const TimeTrace &) = delete;
+
+public:
+  TimeTrace();
+
+  /// \brief Retrieve the active trace, or null if tracing is disabled.
+  static TimeTrace *getActive();
+
+  /// \brief Make \p Trace the active trace. Pass null to disable tracing.
+  static void setActive(TimeTrace *Trace);
+
+  /// \brief Begin a new event nested inside all currently open events.
+  ///
+  /// \param Name The kind of work, e.g. "InstantiateClass".
+  /// \param Detail What the work is applied to, e.g. a declaration name.
+  void begin(StringRef Name, StringRef Detail);
+
+  /// \brief Attach a numeric argument to the innermost open event.
+  void addArg(StringRef Name, uint64_t Value);
+
+  /// \brief End the innermost open event.
+  void end();
+
+  /// \brief Retrieve the number of events that are currently open.
+  unsigned getNumOpenEvents() const { return Stack.size(); }
+
+  /// \brief End open events until only \p Depth of them remain.
+  void endNested(unsigned Depth) {
+    while (Stack.size() > Depth)
+      end();
+  }
+
+  /// \brief Write all completed events as a Chrome trace JSON object.
+  void write(raw_ostream &OS) const;
+};
+
+/// \brief RAII object that records an event on the active trace, if any,
+/// for the duration of a scope.
+class TimeTraceScope {
+  TimeTrace *Trace;
+  unsigned Depth;
+
+  TimeTraceScope(const TimeTraceScope &) = delete;
+  void operator=(const TimeTraceScope &) = delete;
+
+public:
+  TimeTraceScope(StringRef Name, StringRef Detail = StringRef())
+      : Trace(TimeTrace::getActive()), Depth(0) {
+    if (Trace) {
+      Depth = Trace->getNumOpenEvents();
+      Trace->begin(Name, Detail);
+    }
+  }
+
+  ~TimeTraceScope() {
+    // Also close any event nested in this scope that was left open, e.g. a
+    // source file the preprocessor abandoned after a fatal error.
+    if (Trace)
+      Trace->endNested(Depth);
+  }
+};
+
+} // end namespace clang
+
+#endif
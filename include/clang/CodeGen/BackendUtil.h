@@ -11,10 +11,12 @@
 #define LLVM_CLANG_CODEGEN_BACKENDUTIL_H
 
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/IR/ModuleSummaryIndex.h"
 #include <memory>
 
 namespace llvm {
+  class Function;
   class Module;
   class MemoryBufferRef;
 }
@@ -34,11 +36,38 @@ namespace clang {
     Backend_EmitObj        ///< Emit native object files
   };
 
+  /// Runs the per-function optimization passes over each function as soon as
+  /// its body has been generated, rather than once the whole module has been.
+  class EarlyFunctionPasses {
+  public:
+    virtual ~EarlyFunctionPasses();
+
+    /// Optimize \p F, whose body must be complete. Functions that have
+    /// already been optimized are left alone.
+    virtual void run(llvm::Function &F) = 0;
+  };
+
+  /// Create the early per-function passes for \p M, or return null if its
+  /// passes must wait until the module is complete.
+  std::unique_ptr<EarlyFunctionPasses>
+  createEarlyFunctionPasses(DiagnosticsEngine &Diags,
+                            const CodeGenOptions &CGOpts,
+                            const TargetOptions &TOpts,
+                            const LangOptions &LOpts, llvm::Module *M);
+
+  /// \param Early If non-null, the early passes created for \p M. Functions
+  /// they have optimized are not run through the per-function passes again.
+  /// \param PartitionOS If non-empty, the module is split into one more
+  /// partition than there are streams here, and code is generated for each
+  /// partition in parallel. The first partition is emitted to \p OS, and each
+  /// of the others to the corresponding stream here.
   void EmitBackendOutput(DiagnosticsEngine &Diags, const CodeGenOptions &CGOpts,
                          const TargetOptions &TOpts, const LangOptions &LOpts,
                          const llvm::DataLayout &TDesc, llvm::Module *M,
                          BackendAction Action,
-                         std::unique_ptr<raw_pwrite_stream> OS);
+                         std::unique_ptr<raw_pwrite_stream> OS,
+                         EarlyFunctionPasses *Early = nullptr,
+                         ArrayRef<raw_pwrite_stream *> PartitionOS = None);
 
   void EmbedBitcode(llvm::Module *M, const CodeGenOptions &CGOpts,
                     llvm::MemoryBufferRef Buf);
@@ -32,6 +32,9 @@
 /* Define if we have libxml2 */
 #cmakedefine CLANG_HAVE_LIBXML ${CLANG_HAVE_LIBXML}
 
+/* Define if the static analyzer can refute bug reports with Z3 */
+#cmakedefine CLANG_ANALYZER_WITH_Z3
+
 /* The LLVM product name and version */
 #define BACKEND_PACKAGE_STRING "${BACKEND_PACKAGE_STRING}"
 
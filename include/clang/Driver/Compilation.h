@@ -89,6 +89,27 @@ class Compilation {
   /// Whether we're compiling for diagnostic purposes.
   bool ForDiagnostics;
 
+  /// The maximum number of jobs to execute concurrently (-fparallel-jobs=).
+  unsigned NumParallelJobs;
+
+  /// LogCommand - Print \p C if requested by -v or CC_PRINT_OPTIONS.
+  ///
+  /// \return Whether the command could be logged.
+  bool LogCommand(const Command &C) const;
+
+  /// ReportCommandResult - Diagnose the result of executing \p C.
+  ///
+  /// \return The result code to report for the command.
+  int ReportCommandResult(const Command &C, int Res, const std::string &Error,
+                          bool ExecutionFailed,
+                          const Command *&FailingCommand) const;
+
+  /// ExecuteJobsInParallel - Execute up to NumParallelJobs jobs at a time,
+  /// buffering their output and printing it in job order.
+  void ExecuteJobsInParallel(
+      const JobList &Jobs,
+      SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const;
+
 public:
   Compilation(const Driver &D, const ToolChain &DefaultToolChain,
               llvm::opt::InputArgList *Args,
@@ -248,6 +269,13 @@ public:
   /// Return true if we're compiling for diagnostics.
   bool isForDiagnostics() const { return ForDiagnostics; }
 
+  /// Get the maximum number of jobs ExecuteJobs runs concurrently.
+  unsigned getNumParallelJobs() const { return NumParallelJobs; }
+
+  /// Set the maximum number of jobs ExecuteJobs runs concurrently. Jobs are
+  /// only run concurrently if they do not depend on each other's output.
+  void setNumParallelJobs(unsigned N) { NumParallelJobs = N; }
+
   /// Redirect - Redirect output of this compilation. Can only be done once.
   ///
   /// \param Redirects - array of pointers to paths. The array
@@ -182,6 +182,15 @@ public:
   /// Whether the driver is generating diagnostics for debugging purposes.
   unsigned CCGenDiagnostics : 1;
 
+  /// Function that runs a -cc1 tool with the given arguments, the first of
+  /// which is the executable and the second "-cc1" or "-cc1as", and returns
+  /// its exit code.
+  typedef int (*CC1ToolFunc)(ArrayRef<const char *> Argv);
+
+  /// The -cc1 tool to run in-process with -fintegrated-cc1, if the driver
+  /// executable provides one.
+  CC1ToolFunc CC1Main = nullptr;
+
 private:
   /// Name to use when invoking gcc/g++.
   std::string CCCGenericGCCName;
@@ -152,6 +152,18 @@ public:
               bool *ExecutionFailed) const override;
 };
 
+/// Like Command, but runs the -cc1 tool in the driver's process where
+/// possible, to save the cost of creating one.
+class CC1Command : public Command {
+public:
+  CC1Command(const Action &Source_, const Tool &Creator_,
+             const char *Executable_, const ArgStringList &Arguments_,
+             ArrayRef<InputInfo> Inputs);
+
+  int Execute(const StringRef **Redirects, std::string *ErrMsg,
+              bool *ExecutionFailed) const override;
+};
+
 /// JobList - A sequence of jobs to perform.
 class JobList {
 public:
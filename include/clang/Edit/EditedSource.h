@@ -34,8 +34,11 @@ class EditedSource {
   struct FileEdit {
     StringRef Text;
     unsigned RemoveLen;
+    /// The size of the buffer that \c Text points to, which is owned by this
+    /// edit, so that insertions can be appended to it in place.
+    unsigned TextCapacity;
 
-    FileEdit() : RemoveLen(0) {}
+    FileEdit() : RemoveLen(0), TextCapacity(0) {}
   };
 
   typedef std::map<FileOffset, FileEdit> FileEditsTy;
@@ -78,6 +81,7 @@ private:
                              FileOffset InsertFromRangeOffs, unsigned Len,
                              bool beforePreviousInsertions);
   void commitRemove(SourceLocation OrigLoc, FileOffset BeginOffs, unsigned Len);
+  void appendText(FileEdit &FA, StringRef text);
 
   StringRef getSourceText(FileOffset BeginOffs, FileOffset EndOffs,
                           bool &Invalid);
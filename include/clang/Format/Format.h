@@ -18,7 +18,9 @@
 #include "clang/Basic/LangOptions.h"
 #include "clang/Tooling/Core/Replacement.h"
 #include "llvm/ADT/ArrayRef.h"
+#include <string>
 #include <system_error>
+#include <vector>
 
 namespace clang {
 
@@ -484,6 +486,14 @@ struct FormatStyle {
   /// \brief The maximum number of consecutive empty lines to keep.
   unsigned MaxEmptyLinesToKeep;
 
+  /// \brief The maximum number of states to explore when searching for the
+  /// best line breaks of a single line; ``0`` means no limit.
+  ///
+  /// Once the limit is reached, the rest of the line is formatted greedily.
+  /// This bounds the time and memory spent on pathological lines, such as
+  /// very long initializer lists, at the cost of possibly worse formatting.
+  unsigned MaxLineFormattingStates;
+
   /// \brief Different ways to indent namespace contents.
   enum NamespaceIndentationKind {
     /// Don't indent in namespaces.
@@ -685,6 +695,7 @@ struct FormatStyle {
            MacroBlockBegin == R.MacroBlockBegin &&
            MacroBlockEnd == R.MacroBlockEnd &&
            MaxEmptyLinesToKeep == R.MaxEmptyLinesToKeep &&
+           MaxLineFormattingStates == R.MaxLineFormattingStates &&
            NamespaceIndentation == R.NamespaceIndentation &&
            ObjCBlockIndentWidth == R.ObjCBlockIndentWidth &&
            ObjCSpaceAfterProperty == R.ObjCSpaceAfterProperty &&
@@ -810,6 +821,86 @@ tooling::Replacements reformat(const FormatStyle &Style, StringRef Code,
                                StringRef FileName = "<stdin>",
                                bool *IncompleteFormat = nullptr);
 
+/// \brief Keeps a file that is being edited together with what is needed to
+/// reformat small parts of it without re-parsing the whole file, e.g. for
+/// formatting while typing in an editor.
+///
+/// The session remembers the top-level lines at which the code can be split
+/// into pieces that are formatted independently of each other. \c reformat()
+/// only lexes, parses and formats the piece around the requested ranges and
+/// the code edited since the last call; the split points of the rest of the
+/// file are carried over, shifted by edits. If the piece turns out to be
+/// unbalanced, e.g. because an edit opened a block comment, the whole file is
+/// parsed again.
+/// Styles derived from the code (e.g. ``DerivePointerAlignment``) are derived
+/// once, from the whole file, when the session is created.
+class FormattingSession {
+public:
+  FormattingSession(const FormatStyle &Style, StringRef Code,
+                    StringRef FileName = "<stdin>");
+
+  /// \brief Returns the current code of the session.
+  StringRef getCode() const { return Code; }
+
+  /// \brief Replaces \p Length bytes at \p Offset of the current code with
+  /// \p Text.
+  void applyEdit(unsigned Offset, unsigned Length, StringRef Text);
+
+  /// \brief Reformats the given \p Ranges of the current code.
+  ///
+  /// Returns the ``Replacements`` necessary to make all \p Ranges comply with
+  /// the session's style, relative to the code before the call. They are
+  /// applied to the session's code as well, so \c getCode() returns the
+  /// formatted code afterwards.
+  ///
+  /// Otherwise identical to the reformat() function.
+  tooling::Replacements reformat(ArrayRef<tooling::Range> Ranges,
+                                 bool *IncompleteFormat = nullptr);
+
+  /// \brief A top-level line at which the code can be split.
+  struct SplitPoint {
+    /// \brief The offset of the first token of the line.
+    unsigned Offset;
+    /// \brief Identifies the block the line is in; the code between two
+    /// split points of the same scope is balanced.
+    unsigned Scope;
+  };
+
+private:
+  tooling::Replacements reformatPiece(unsigned Start, unsigned End,
+                                      unsigned Scope,
+                                      ArrayRef<tooling::Range> Ranges,
+                                      bool *IncompleteFormat);
+
+  FormatStyle Style;
+  std::string FileName;
+  std::string Code;
+  std::vector<SplitPoint> SplitPoints;
+  bool BinPackInconclusiveFunctions;
+  unsigned NextScope;
+  // The range of code edited since the last reformat() call, if any.
+  bool HasDamage;
+  unsigned DamageBegin;
+  unsigned DamageEnd;
+};
+
+/// \brief Formats all of \p Code and writes the result to \p OS.
+///
+/// Unlike reformat(), the code is not lexed and parsed as a whole: it is
+/// processed in chunks of about \p ChunkSize bytes, each of which is cut at
+/// the last top-level split point in it (see \c FormattingSession) and
+/// written to \p OS before the next chunk is read. This bounds the memory
+/// needed for huge files, e.g. generated tables. A chunk without a split
+/// point is grown until it has one or reaches the end of the code.
+///
+/// Includes are sorted if the style says so. Styles derived from the code are
+/// derived from the first chunk. Otherwise identical to reformat() with a
+/// range covering all of \p Code.
+void reformatInChunks(const FormatStyle &Style, StringRef Code,
+                      raw_ostream &OS, StringRef FileName = "<stdin>",
+                      bool *IncompleteFormat = nullptr,
+                      unsigned ChunkSize = 1 << 20);
+
 /// \brief Clean up any erroneous/redundant code in the given \p Ranges in the
 /// file \p ID.
 ///
@@ -826,6 +917,61 @@ tooling::Replacements cleanup(const FormatStyle &Style, StringRef Code,
                               ArrayRef<tooling::Range> Ranges,
                               StringRef FileName = "<stdin>");
 
+/// \brief Statistics about the work done by reformat(), e.g. to find out why
+/// some code is slow to format or to compare styles.
+struct FormatStatistics {
+  /// \brief The time spent in a function and how often it was called.
+  struct Timing {
+    unsigned Calls = 0;
+    uint64_t Nanoseconds = 0;
+  };
+
+  /// \brief A search for the best line breaks of a line.
+  struct LineSearch {
+    /// \brief The 1-based line number of the first token of the line.
+    unsigned Line;
+    /// \brief The number of tokens of the line.
+    unsigned Tokens;
+    /// \brief The number of states the search created.
+    unsigned States;
+    /// \brief True if the search exceeded ``MaxLineFormattingStates`` and
+    /// continued greedily.
+    bool Greedy;
+    /// \brief True if the search was only done to compute a penalty, e.g. for
+    /// a nested block.
+    bool DryRun;
+    uint64_t Nanoseconds;
+  };
+
+  std::vector<LineSearch> LineSearches;
+  /// \brief Lookups of the penalties of nested blocks.
+  unsigned PenaltyCacheHits = 0;
+  unsigned PenaltyCacheMisses = 0;
+  /// \brief Lookups of the line breaks of lines of the same shape.
+  unsigned SolutionCacheHits = 0;
+  unsigned SolutionCacheMisses = 0;
+  /// \brief Placing a token in the line search; includes
+  /// ``BreakProtrudingToken``.
+  Timing AddTokenToState;
+  /// \brief Breaking and reflowing tokens that exceed the column limit, e.g.
+  /// comments and string literals.
+  Timing BreakProtrudingToken;
+  /// \brief The alignment passes over the whitespace of a file.
+  Timing Alignment;
+};
+
+/// \brief Makes reformat() and the functions calling it add statistics about
+/// the work they do on the current thread to \p Stats, until this is called
+/// again. Passing ``nullptr`` stops collecting statistics.
+void setFormatStatistics(FormatStatistics *Stats);
+
+/// \brief Returns the statistics set with setFormatStatistics() for the
+/// current thread, if any.
+FormatStatistics *getFormatStatistics();
+
+/// \brief Writes \p Stats to \p OS as a single-line JSON object.
+void printFormatStatistics(const FormatStatistics &Stats, raw_ostream &OS);
+
 /// \brief Returns the ``LangOpts`` that the formatter expects you to set.
 ///
 /// \param Style determines specific settings for lexing mode.
@@ -40,6 +40,10 @@ std::unique_ptr<ASTConsumer> CreateASTDumper(StringRef FilterString,
                                              bool DumpDecls,
                                              bool DumpLookups);
 
+// AST JSON dumper: streams the AST to stdout as JSON, one object per line for
+// each node, without building the whole dump in memory.
+std::unique_ptr<ASTConsumer> CreateASTJSONDumper(StringRef FilterString);
+
 // AST Decl node lister: prints qualified names of all filterable AST Decl
 // nodes.
 std::unique_ptr<ASTConsumer> CreateASTDeclNodeLister();
@@ -303,6 +303,16 @@ private:
   /// \brief True if non-system source files should be treated as volatile
   /// (likely to change while trying to use them).
   bool UserFilesAreVolatile : 1;
+
+  /// \brief Whether function bodies are only parsed in the main file, and
+  /// within it only in the function-body focus, if any.
+  bool SkipFunctionBodiesOutsideMainFile : 1;
+
+  /// \brief The first and last line (1-based) of the main file whose function
+  /// bodies are parsed when \c SkipFunctionBodiesOutsideMainFile is set, or
+  /// 0 to parse all bodies of the main file.
+  unsigned FunctionBodyFocusStartLine;
+  unsigned FunctionBodyFocusEndLine;
  
   /// \brief The language options used when we load an AST file.
   LangOptions ASTFileLangOpts;
@@ -496,6 +506,22 @@ public:
   bool isUnsafeToFree() const { return UnsafeToFree; }
   void setUnsafeToFree(bool Value) { UnsafeToFree = Value; }
 
+  /// \brief Restrict the function bodies parsed by subsequent reparses to
+  /// the functions of the main file that overlap lines \p StartLine through
+  /// \p EndLine (1-based, inclusive).
+  ///
+  /// Only has an effect if the unit was created with
+  /// \c SkipFunctionBodiesOutsideMainFile. Passing 0 for both lines parses
+  /// every function body of the main file again.
+  void setFunctionBodyFocus(unsigned StartLine, unsigned EndLine) {
+    FunctionBodyFocusStartLine = StartLine;
+    FunctionBodyFocusEndLine = EndLine;
+  }
+
+  /// \brief Determine whether the parser may skip the body of \p D, whose
+  /// definition it is about to parse.
+  bool shouldSkipFunctionBody(Decl *D);
+
   const DiagnosticsEngine &getDiagnostics() const { return *Diagnostics; }
   DiagnosticsEngine &getDiagnostics()             { return *Diagnostics; }
   
@@ -832,6 +858,14 @@ public:
   ///
   /// \param ModuleFormat - If provided, uses the specific module format.
   ///
+  /// \param StorePreamblesInMemory - If true, precompiled preambles are kept
+  /// in memory and served to the AST reader from there instead of going
+  /// through temporary files.
+  ///
+  /// \param SkipFunctionBodiesOutsideMainFile - If true, function bodies are
+  /// skipped unless they are in the main file; see \c setFunctionBodyFocus()
+  /// to restrict them further.
+  ///
   /// \param ErrAST - If non-null and parsing failed without any AST to return
   /// (e.g. because the PCH could not be loaded), this accepts the ASTUnit
   /// mainly to allow the caller to see the diagnostics.
@@ -852,6 +886,8 @@ public:
       bool AllowPCHWithCompilerErrors = false, bool SkipFunctionBodies = false,
       bool UserFilesAreVolatile = false, bool ForSerialization = false,
       llvm::Optional<StringRef> ModuleFormat = llvm::None,
+      bool StorePreamblesInMemory = false,
+      bool SkipFunctionBodiesOutsideMainFile = false,
       std::unique_ptr<ASTUnit> *ErrAST = nullptr);
 
   /// \brief Reparse the source files using the same command-line options that
@@ -862,6 +898,23 @@ public:
   bool Reparse(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
                ArrayRef<RemappedFile> RemappedFiles = None);
 
+  /// \brief Parse the source files again into a new ASTUnit, using the same
+  /// options as this one, and leave this unit untouched.
+  ///
+  /// Unlike \c Reparse(), this does not modify this unit, so other threads
+  /// may keep querying it while the new unit is being built. It must not be
+  /// reparsed or destroyed concurrently, though. The new unit reuses this
+  /// unit's precompiled preamble when it is still valid.
+  ///
+  /// \param RemappedFiles The files to remap in the new unit, which takes
+  /// ownership of their buffers.
+  ///
+  /// \returns The new unit, or null if a failure occurred that prevented it
+  /// from containing any translation-unit information.
+  std::unique_ptr<ASTUnit>
+  ReparseAsNewUnit(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+                   ArrayRef<RemappedFile> RemappedFiles = None);
+
   /// \brief Perform code completion at the given file, line, and
   /// column within this translation unit.
   ///
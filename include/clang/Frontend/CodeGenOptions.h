@@ -116,6 +116,10 @@ public:
 
   std::map<std::string, std::string> DebugPrefixMap;
 
+  /// The directory in which translation units claim the C++ types whose full
+  /// debug info they emit, if non-empty. Other units only refer to them.
+  std::string DebugTypeCacheDir;
+
   /// The ABI to use for passing floating point arguments.
   std::string FloatABI;
 
@@ -163,6 +167,10 @@ public:
   /// Name of the profile file to use as input for -fprofile-instr-use
   std::string ProfileInstrumentUsePath;
 
+  /// Name of the file to write the symbol ordering derived from the
+  /// -fprofile-instr-use profile to.
+  std::string ProfileFunctionOrderFile;
+
   /// Name of the function summary index file to use for ThinLTO function
   /// importing.
   std::string ThinLTOIndexFile;
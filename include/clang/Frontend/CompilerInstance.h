@@ -151,13 +151,18 @@ class CompilerInstance : public ModuleLoader {
   ///
   /// If TempFilename is not empty we must rename it to Filename at the end.
   /// TempFilename may be empty and Filename non-empty if creating the temporary
-  /// failed.
+  /// failed. If PreserveIfUnchanged is set and Filename already has the same
+  /// contents as TempFilename, the temporary is discarded instead so that the
+  /// existing file keeps its modification time.
   struct OutputFile {
     std::string Filename;
     std::string TempFilename;
+    bool PreserveIfUnchanged;
 
-    OutputFile(std::string filename, std::string tempFilename)
-        : Filename(std::move(filename)), TempFilename(std::move(tempFilename)) {
+    OutputFile(std::string filename, std::string tempFilename,
+               bool preserveIfUnchanged = false)
+        : Filename(std::move(filename)), TempFilename(std::move(tempFilename)),
+          PreserveIfUnchanged(preserveIfUnchanged) {
     }
   };
 
@@ -687,11 +692,15 @@ public:
   /// Create a new output file and add it to the list of tracked output files,
   /// optionally deriving the output path name.
   ///
+  /// If \p PreserveIfUnchanged is true and \p UseTemporary is true, an
+  /// existing output file with identical contents is left untouched.
+  ///
   /// \return - Null on error.
   std::unique_ptr<raw_pwrite_stream>
   createOutputFile(StringRef OutputPath, bool Binary, bool RemoveFileOnSignal,
                    StringRef BaseInput, StringRef Extension, bool UseTemporary,
-                   bool CreateMissingDirectories = false);
+                   bool CreateMissingDirectories = false,
+                   bool PreserveIfUnchanged = false);
 
   /// Create a new output file, optionally deriving the output path name.
   ///
@@ -754,6 +763,10 @@ public:
   // Create module manager.
   void createModuleManager();
 
+  /// \brief Append the module files loaded from the module cache to its
+  /// access log, if the size of the module cache is limited.
+  void logModuleCacheAccesses();
+
   bool loadModuleFile(StringRef FileName);
 
   ModuleLoadResult loadModule(SourceLocation ImportLoc, ModuleIdPath Path,
@@ -56,6 +56,10 @@ public:
   /// \brief The file to write GraphViz-formatted header dependencies to.
   std::string DOTOutputFile;
 
+  /// \brief The file to write the time and AST memory spent in each header
+  /// to, as JSON.
+  std::string HeaderCostOutputFile;
+
   /// \brief The directory to copy module dependencies to when collecting them.
   std::string ModuleDependencyOutputDir;
 
@@ -230,6 +230,20 @@ protected:
   void ExecuteAction() override;
 };
 
+/// \brief Scan the preprocessor directives of the input for dependencies.
+///
+/// Prints every \#include (with the file it resolved to) and every \@import
+/// (with the module map defining the module, if it can be found) of the main
+/// file and the headers it includes. Macros are only expanded in directives
+/// and modules are never loaded or built, so this is much cheaper than a
+/// compile that produces a dependency file as a side effect. Includes are
+/// always followed textually.
+class ScanDependenciesAction : public PreprocessorFrontendAction {
+protected:
+  bool BeginInvocation(CompilerInstance &CI) override;
+  void ExecuteAction() override;
+};
+
 class PrintPreprocessedAction : public PreprocessorFrontendAction {
 protected:
   void ExecuteAction() override;
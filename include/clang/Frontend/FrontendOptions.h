@@ -56,7 +56,9 @@ namespace frontend {
     RewriteTest,            ///< Rewriter playground
     RunAnalysis,            ///< Run one or more source code analyses.
     MigrateSource,          ///< Run migrator.
-    RunPreprocessorOnly     ///< Just lex, no output.
+    RunPreprocessorOnly,    ///< Just lex, no output.
+    ScanDependencies        ///< Print the dependencies found by the
+                            ///< preprocessor directives.
   };
 }
 
@@ -150,12 +152,17 @@ public:
                                            ///< dumps in AST dumps.
   unsigned ASTDumpLookups : 1;             ///< Whether we include lookup table
                                            ///< dumps in AST dumps.
+  unsigned ASTDumpJSON : 1;                ///< Whether AST dumps are written
+                                           ///< as JSON.
   unsigned BuildingImplicitModule : 1;     ///< Whether we are performing an
                                            ///< implicit module build.
   unsigned ModulesEmbedAllFiles : 1;       ///< Whether we should embed all used
                                            ///< files into the PCM file.
   unsigned IncludeTimestamps : 1;          ///< Whether timestamps should be
                                            ///< written to the produced PCH file.
+  unsigned PreserveUnchangedPCH : 1;       ///< Whether an existing PCH file
+                                           ///< with identical contents should
+                                           ///< be left untouched.
 
   CodeCompleteOptions CodeCompleteOpts;
 
@@ -267,6 +274,34 @@ public:
   /// \brief Auxiliary triple for CUDA compilation.
   std::string AuxTriple;
 
+  /// \brief If non-empty, the file to which a Chrome trace of the time spent
+  /// in the frontend is written.
+  std::string TimeTracePath;
+
+  /// \brief If non-zero, the number of seconds after which to report what
+  /// the compiler is working on.
+  unsigned CompileTimeBudget;
+
+  /// \brief If non-empty, the file to which the compile-time budget report
+  /// is written instead of stderr.
+  std::string CompileTimeBudgetReportPath;
+
+  /// \brief Whether to abort the compilation once its compile-time budget
+  /// is exceeded.
+  unsigned CompileTimeBudgetAbort : 1;
+
+  /// \brief If non-empty, the file to which the memory used by the AST and
+  /// the source manager is written as JSON.
+  std::string StatsJSONPath;
+
+  /// \brief If non-empty, write a header map of the quoted and angled search
+  /// directories to this file instead of running an action.
+  std::string GenerateHeaderMapPath;
+
+  /// \brief If non-empty, the directory of the index store the symbol
+  /// occurrences of the translation unit are written to.
+  std::string IndexStorePath;
+
   /// \brief If non-empty, search the pch input file as it was a header
   // included by this file.
   std::string FindPchSource;
@@ -279,9 +314,11 @@ public:
     FixToTemporaries(false), ARCMTMigrateEmitARCErrors(false),
     SkipFunctionBodies(false), UseGlobalModuleIndex(true),
     GenerateGlobalModuleIndex(true), ASTDumpDecls(false), ASTDumpLookups(false),
-    BuildingImplicitModule(false), ModulesEmbedAllFiles(false),
-    IncludeTimestamps(true), ARCMTAction(ARCMT_None),
-    ObjCMTAction(ObjCMT_None), ProgramAction(frontend::ParseSyntaxOnly)
+    ASTDumpJSON(false), BuildingImplicitModule(false), ModulesEmbedAllFiles(false),
+    IncludeTimestamps(true), PreserveUnchangedPCH(false),
+    ARCMTAction(ARCMT_None),
+    ObjCMTAction(ObjCMT_None), ProgramAction(frontend::ParseSyntaxOnly),
+    CompileTimeBudget(0), CompileTimeBudgetAbort(false)
   {}
 
   /// getInputKindForExtension - Return the appropriate input kind for a file
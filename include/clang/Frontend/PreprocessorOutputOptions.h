@@ -23,6 +23,8 @@ public:
   unsigned ShowMacroComments : 1;  ///< Show comments, even in macros.
   unsigned ShowMacros : 1;         ///< Print macro definitions.
   unsigned RewriteIncludes : 1;    ///< Preprocess include directives only.
+  unsigned MinimizeRewrittenIncludes : 1; ///< Strip comments and skipped
+                                          ///< blocks when rewriting includes.
 
 public:
   PreprocessorOutputOptions() {
@@ -33,6 +35,7 @@ public:
     ShowMacroComments = 0;
     ShowMacros = 0;
     RewriteIncludes = 0;
+    MinimizeRewrittenIncludes = 0;
   }
 };
 
@@ -13,6 +13,8 @@
 #include "clang/Basic/LLVM.h"
 #include "clang/Frontend/SerializedDiagnostics.h"
 #include "llvm/Bitcode/BitstreamWriter.h"
+#include <string>
+#include <system_error>
 
 namespace llvm {
 class raw_ostream;
@@ -37,6 +39,17 @@ std::unique_ptr<DiagnosticConsumer> create(StringRef OutputFile,
                                            DiagnosticOptions *Diags,
                                            bool MergeChildRecords = false);
 
+/// \brief Merge the serialized diagnostics files \p InputFiles into the
+/// single file \p OutputFile.
+///
+/// The inputs are streamed through SerializedDiagnosticReader, so no
+/// diagnostic is materialized, and the names of files, categories and flags
+/// that appear in several inputs are only written once.
+///
+/// \returns an error if an input can't be read or the output can't be
+/// written.
+std::error_code merge(ArrayRef<std::string> InputFiles, StringRef OutputFile);
+
 } // end serialized_diags namespace
 } // end clang namespace
 
@@ -17,6 +17,7 @@
 #define LLVM_CLANG_FRONTEND_TEXTDIAGNOSTIC_H
 
 #include "clang/Frontend/DiagnosticRenderer.h"
+#include <memory>
 
 namespace clang {
 
@@ -35,6 +36,12 @@ namespace clang {
 class TextDiagnostic : public DiagnosticRenderer {
   raw_ostream &OS;
 
+  struct SnippetLine;
+
+  /// \brief The line shown by the last snippet, reused while the following
+  /// diagnostics point into the same line.
+  std::unique_ptr<SnippetLine> LastSnippet;
+
 public:
   TextDiagnostic(raw_ostream &OS,
                  const LangOptions &LangOpts,
@@ -37,6 +37,10 @@ class TextDiagnosticPrinter : public DiagnosticConsumer {
 
   unsigned OwnsOutputStream : 1;
 
+  /// \brief Whether the notes following a duplicate header diagnostic are
+  /// being dropped along with it.
+  unsigned SuppressNotes : 1;
+
 public:
   TextDiagnosticPrinter(raw_ostream &os, DiagnosticOptions *diags,
                         bool OwnsOutputStream = false);
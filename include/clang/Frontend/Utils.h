@@ -20,6 +20,7 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Option/OptSpecifier.h"
+#include <functional>
 #include <utility>
 
 namespace llvm {
@@ -152,6 +153,13 @@ public:
 void AttachDependencyGraphGen(Preprocessor &PP, StringRef OutputFile,
                               StringRef SysRoot);
 
+/// AttachHeaderCostGen - Create a generator that records the time and AST
+/// memory spent in each header, and attach it to the given preprocessor.
+///
+/// \param GetASTMemory - Returns the memory allocated by the AST so far.
+void AttachHeaderCostGen(Preprocessor &PP, StringRef OutputFile,
+                         std::function<size_t()> GetASTMemory);
+
 /// AttachHeaderIncludeGen - Create a header include list generator, and attach
 /// it to the given preprocessor.
 ///
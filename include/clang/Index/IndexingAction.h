@@ -38,6 +38,16 @@ createIndexingAction(std::shared_ptr<IndexDataConsumer> DataConsumer,
                      IndexingOptions Opts,
                      std::unique_ptr<FrontendAction> WrappedAction);
 
+/// \brief Wrap \p WrappedAction so that the symbol occurrences of the
+/// translation unit it compiles are written to the index store in
+/// \p StorePath.
+///
+/// \param OutputFile the output file of \p WrappedAction, which identifies
+/// the translation unit in the store together with its main file.
+std::unique_ptr<FrontendAction>
+createIndexDataRecordingAction(StringRef StorePath, StringRef OutputFile,
+                               std::unique_ptr<FrontendAction> WrappedAction);
+
 void indexASTUnit(ASTUnit &Unit,
                   std::shared_ptr<IndexDataConsumer> DataConsumer,
                   IndexingOptions Opts);
@@ -0,0 +1,79 @@
+//===--- DirectoryListingCache.h - Directory contents cache -----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the DirectoryListingCache interface.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_DIRECTORYLISTINGCACHE_H
+#define LLVM_CLANG_LEX_DIRECTORYLISTINGCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Mutex.h"
+#include <memory>
+#include <string>
+
+namespace clang {
+
+/// \brief Remembers the contents of header search directories.
+///
+/// Most lookups of an \#include in a long search path fail, and each failure
+/// costs a stat of a file that does not exist.  This cache reads a directory
+/// once and answers whether a name may exist in it from memory, so that
+/// lookups in directories that cannot contain the header skip the stat.
+///
+/// A listing is keyed by the absolute path of the directory and revalidated
+/// against the directory's unique ID and modification time whenever it is
+/// handed out.  Adding or removing an entry updates the modification time of
+/// the directory, so stale listings are detected.  Directories modified in
+/// the last few seconds are not cached, because a second change within the
+/// timestamp granularity would go unnoticed.
+///
+/// Names are compared case-insensitively, which can only make the cache
+/// answer "may exist" more often and keeps it correct on case-insensitive
+/// file systems.
+class DirectoryListingCache {
+public:
+  /// \brief The lowercased names of the entries of a directory.
+  typedef llvm::StringSet<> Listing;
+
+private:
+  struct Entry {
+    llvm::sys::fs::UniqueID UniqueID;
+    uint64_t ModTime;
+    std::shared_ptr<const Listing> Names;
+  };
+
+  llvm::StringMap<Entry> Entries;
+  llvm::sys::Mutex Lock;
+
+public:
+  /// \brief Return the cache shared by all compilations in this process.
+  static DirectoryListingCache &getShared();
+
+  /// \brief Return the up-to-date listing of the directory \p Dir, reading
+  /// it if needed, or null if the directory cannot be listed reliably.
+  std::shared_ptr<const Listing> get(StringRef Dir);
+
+  /// \brief Set \p Name to the listed name that \p Filename, relative to a
+  /// directory, must appear under in the listing of that directory.
+  ///
+  /// \returns false if a listing cannot tell whether \p Filename exists.
+  static bool getListedName(StringRef Filename, std::string &Name);
+
+  unsigned size();
+};
+
+} // end namespace clang
+
+#endif
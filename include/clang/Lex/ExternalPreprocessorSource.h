@@ -34,6 +34,10 @@ public:
   /// \brief Update an out-of-date identifier.
   virtual void updateOutOfDateIdentifier(IdentifierInfo &II) = 0;
 
+  /// \brief Load the macro history of an identifier that was deferred with
+  /// Preprocessor::setLazyMacroHistory.
+  virtual void loadMacroHistory(IdentifierInfo *II) {}
+
   /// \brief Return the identifier associated with the given ID number.
   ///
   /// The ID 0 is associated with the NULL identifier.
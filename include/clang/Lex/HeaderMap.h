@@ -16,9 +16,14 @@
 
 #include "clang/Basic/LLVM.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include <memory>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
 
 namespace clang {
 
@@ -85,6 +90,30 @@ public:
   using HeaderMapImpl::dump;
 };
 
+/// Builds the contents of a header map file.  Keys are matched
+/// case-insensitively; the first mapping of a key wins.
+class HeaderMapWriter {
+  std::vector<std::pair<std::string, std::string>> Entries;
+  llvm::StringSet<> LowercaseKeys;
+
+public:
+  /// Map \p Key to \p Path unless \p Key is already mapped.
+  ///
+  /// \returns true if the mapping was added.
+  bool insert(StringRef Key, StringRef Path);
+
+  /// Map the path of every file below \p Dir, relative to \p Dir and with
+  /// '/' separators, to the path of the file as found through \p Dir.  Keys
+  /// that are already mapped are left alone, so adding the directories of a
+  /// search path in order gives the header map that searching them would.
+  std::error_code addDirectory(StringRef Dir);
+
+  /// Write the header map to \p OS.
+  void write(raw_ostream &OS) const;
+
+  unsigned size() const { return Entries.size(); }
+};
+
 } // end namespace clang.
 
 #endif
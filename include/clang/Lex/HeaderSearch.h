@@ -17,6 +17,7 @@
 #include "clang/Lex/DirectoryLookup.h"
 #include "clang/Lex/ModuleMap.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSet.h"
@@ -32,6 +33,8 @@ class FileEntry;
 class FileManager;
 class HeaderSearchOptions;
 class IdentifierInfo;
+class IncludeGuardCache;
+class ModuleMapCache;
 class Preprocessor;
 
 /// \brief The preprocessor keeps track of this information for each
@@ -235,10 +238,35 @@ class HeaderSearch {
 
   /// \brief Entity used to look up stored header file information.
   ExternalHeaderFileInfoSource *ExternalSource;
+
+  /// \brief Controlling macros remembered from earlier compilations, if
+  /// HeaderSearchOptions::IncludeGuardCachePath is set.
+  std::unique_ptr<IncludeGuardCache> GuardCache;
+
+  /// \brief Modules declared by module maps parsed in earlier compilations, if
+  /// HeaderSearchOptions::ModuleMapCachePath is set.
+  std::unique_ptr<ModuleMapCache> MapCache;
+
+  /// \brief The listings of all normal search directories collapsed into one
+  /// map, if HeaderSearchOptions::UseDirectoryListingCache is set: for each
+  /// lowercased name, the indices of the search directories listing it.
+  ///
+  /// Built on the first lookup after the search path changes, so a single
+  /// probe tells which directories can contain a header.
+  llvm::StringMap<SmallVector<unsigned, 2>> SearchDirListings;
+
+  /// \brief The search directories whose listing is in SearchDirListings.
+  llvm::BitVector ListedSearchDirs;
+
+  /// \brief Whether SearchDirListings reflects the current search path.
+  bool SearchDirListingsValid;
   
   // Various statistics we track for performance analysis.
   unsigned NumIncluded;
   unsigned NumMultiIncludeFileOptzn;
+  unsigned NumIncludeGuardCacheOptzn;
+  unsigned NumDirListingCacheOptzn;
+  unsigned NumModuleMapCacheOptzn;
   unsigned NumFrameworkLookups, NumSubFrameworkLookups;
 
   // HeaderSearch doesn't support default or copy construction.
@@ -269,6 +297,7 @@ public:
     AngledDirIdx = angledDirIdx;
     SystemDirIdx = systemDirIdx;
     NoCurDirSearch = noCurDirSearch;
+    SearchDirListingsValid = false;
     //LookupFileCache.clear();
   }
 
@@ -279,6 +308,7 @@ public:
     if (!isAngled)
       AngledDirIdx++;
     SystemDirIdx++;
+    SearchDirListingsValid = false;
   }
 
   /// \brief Set the list of system header prefixes.
@@ -444,9 +474,13 @@ public:
   /// This is used by the multiple-include optimization to eliminate
   /// no-op \#includes.
   void SetFileControllingMacro(const FileEntry *File,
-                               const IdentifierInfo *ControllingMacro) {
-    getFileInfo(File).ControllingMacro = ControllingMacro;
-  }
+                               const IdentifierInfo *ControllingMacro);
+
+  /// \brief Write out the include guard cache, if there is one.
+  void saveIncludeGuardCache();
+
+  /// \brief Write out the module map cache, if there is one.
+  void saveModuleMapCache();
 
   /// \brief Return true if this is the first time encountering this header.
   bool FirstTimeLexingFile(const FileEntry *File) {
@@ -556,7 +590,17 @@ private:
 
   /// \brief Load all of the module maps within the immediate subdirectories
   /// of the given search directory.
-  void loadSubdirectoryModuleMaps(DirectoryLookup &SearchDir);
+  ///
+  /// \param ModuleName If non-empty, the module being looked up.  Module maps
+  /// that the module map cache knows not to declare it are left unparsed.
+  void loadSubdirectoryModuleMaps(DirectoryLookup &SearchDir,
+                                  StringRef ModuleName = StringRef());
+
+  /// \brief Return false if the module map cache knows that the module map
+  /// in \p Dir, which has not been loaded yet, does not declare the top-level
+  /// module \p ModuleName.
+  bool mayDeclareModule(const DirectoryEntry *Dir, bool IsFramework,
+                        StringRef ModuleName);
 
   /// \brief Find and suggest a usable module for the given file.
   ///
@@ -585,6 +629,18 @@ private:
                           Module *RequestingModule,
                           ModuleMap::KnownHeader *SuggestedModule);
 
+  /// \brief Set \p Dirs to the indices of the search directories whose
+  /// listing may contain \p Filename, or to null if none does.
+  ///
+  /// \returns false if the listings cannot be used for this lookup.  Search
+  /// directories not in ListedSearchDirs must be searched regardless.
+  bool lookupSearchDirListings(StringRef Filename,
+                               const SmallVectorImpl<unsigned> *&Dirs);
+
+  /// \brief Collapse the listings of the search directories into
+  /// SearchDirListings.
+  void buildSearchDirListings();
+
 public:
   /// \brief Retrieve the module map.
   ModuleMap &getModuleMap() { return ModMap; }
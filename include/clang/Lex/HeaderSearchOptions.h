@@ -96,6 +96,18 @@ public:
   /// The module/pch container format.
   std::string ModuleFormat;
 
+  /// \brief The file in which controlling macros of headers are remembered
+  /// across compilations, or empty to not use one.
+  std::string IncludeGuardCachePath;
+
+  /// \brief The file in which the modules declared by module map files are
+  /// remembered across compilations, or empty to not use one.
+  std::string ModuleMapCachePath;
+
+  /// \brief Whether to list header search directories once and skip lookups
+  /// of headers that are not in them.
+  unsigned UseDirectoryListingCache : 1;
+
   /// \brief Whether we should disable the use of the hash string within the
   /// module cache.
   ///
@@ -133,6 +145,15 @@ public:
   /// regenerated often.
   unsigned ModuleCachePruneAfter;
 
+  /// \brief The size (in bytes) beyond which the module cache is pruned of
+  /// its least recently used module files, or 0 for no limit.
+  ///
+  /// When this is set, the module files each compilation loads are appended
+  /// to an access log in the module cache, which records the order in which
+  /// they were last used. The limit is enforced when the module cache is
+  /// pruned.
+  uint64_t ModuleCacheMaxSize;
+
   /// \brief The time in seconds when the build session started.
   ///
   /// This time is used by other optimizations in header search and module
@@ -169,19 +190,26 @@ public:
   /// \brief Whether to validate system input files when a module is loaded.
   unsigned ModulesValidateSystemHeaders : 1;
 
+  /// \brief Whether AST files record a hash of the contents of their input
+  /// files, and whether an input file whose modification time changed is
+  /// still considered up to date if its contents match that hash.
+  unsigned ValidateASTInputFilesContent : 1;
+
   /// Whether the module includes debug information (-gmodules).
   unsigned UseDebugInfo : 1;
 
   HeaderSearchOptions(StringRef _Sysroot = "/")
-      : Sysroot(_Sysroot), ModuleFormat("raw"), DisableModuleHash(0),
+      : Sysroot(_Sysroot), ModuleFormat("raw"), UseDirectoryListingCache(0),
+        DisableModuleHash(0),
         ImplicitModuleMaps(0), ModuleMapFileHomeIsCwd(0),
         ModuleCachePruneInterval(7 * 24 * 60 * 60),
-        ModuleCachePruneAfter(31 * 24 * 60 * 60), BuildSessionTimestamp(0),
+        ModuleCachePruneAfter(31 * 24 * 60 * 60), ModuleCacheMaxSize(0),
+        BuildSessionTimestamp(0),
         UseBuiltinIncludes(true), UseStandardSystemIncludes(true),
         UseStandardCXXIncludes(true), UseLibcxx(false), Verbose(false),
         ModulesValidateOncePerBuildSession(false),
         ModulesValidateSystemHeaders(false),
-        UseDebugInfo(false) {}
+        ValidateASTInputFilesContent(false), UseDebugInfo(false) {}
 
   /// AddPath - Add the \p Path path to the specified \p Group list.
   void AddPath(StringRef Path, frontend::IncludeDirGroup Group,
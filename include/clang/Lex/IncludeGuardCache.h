@@ -0,0 +1,76 @@
+//===--- IncludeGuardCache.h - Persistent include guard cache ---*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the IncludeGuardCache interface.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_INCLUDEGUARDCACHE_H
+#define LLVM_CLANG_LEX_INCLUDEGUARDCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
+#include <map>
+#include <string>
+
+namespace clang {
+
+class FileEntry;
+
+/// \brief Remembers the controlling macro of headers across compilations.
+///
+/// The multiple-include optimization only knows that a header is guarded once
+/// it has been lexed in the current translation unit.  This cache records the
+/// guard macro of every header seen by earlier compilations, keyed by the
+/// file's unique ID, size and modification time, so that an \#include of a
+/// header whose guard is already defined can be skipped without reading it.
+///
+/// The cache is stored as a text file.  Saving merges the entries on disk
+/// with the new ones and atomically replaces the file, so concurrent
+/// compilations sharing a cache only risk losing each other's additions.
+class IncludeGuardCache {
+  struct Entry {
+    off_t Size;
+    time_t ModTime;
+    std::string Macro;
+  };
+
+  std::map<llvm::sys::fs::UniqueID, Entry> Entries;
+
+  /// \brief Whether entries were added since the cache was loaded.
+  bool Dirty = false;
+
+  /// \brief Read the entries in \p Path into this cache, keeping any
+  /// existing entry for the same file.  Malformed files are ignored.
+  void read(StringRef Path);
+
+public:
+  /// \brief Load the cache stored in \p Path.  A missing or unreadable file
+  /// results in an empty cache.
+  explicit IncludeGuardCache(StringRef Path) { read(Path); }
+
+  /// \brief Return the guard macro recorded for \p File, or an empty string
+  /// if we have none or the file changed since it was recorded.
+  StringRef lookup(const FileEntry *File) const;
+
+  /// \brief Record that \p File is guarded by \p Macro.
+  void insert(const FileEntry *File, StringRef Macro);
+
+  /// \brief Write the cache back to \p Path if it changed.
+  ///
+  /// \returns true on failure.
+  bool save(StringRef Path);
+
+  unsigned size() const { return Entries.size(); }
+};
+
+} // end namespace clang
+
+#endif
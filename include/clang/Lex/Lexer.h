@@ -611,6 +611,8 @@ private:
 
   void SkipBytes(unsigned Bytes, bool StartOfLine);
 
+  void SkipToPossibleDirective();
+
   void PropagateLineStartLeadingSpaceInfo(Token &Result);
 
   const char *LexUDSuffix(Token &Result, const char *CurPtr,
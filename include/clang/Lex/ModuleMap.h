@@ -25,6 +25,7 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include <string>
+#include <vector>
 
 namespace clang {
   
@@ -215,6 +216,10 @@ private:
   /// map.
   llvm::DenseMap<const FileEntry *, bool> ParsedModuleMap;
 
+  /// \brief The names of the top-level modules declared by each parsed module
+  /// map file.
+  llvm::DenseMap<const FileEntry *, std::vector<std::string>> DeclaredModules;
+
   friend class ModuleMapParser;
   
   /// \brief Resolve the given export declaration into an actual export
@@ -520,6 +525,11 @@ public:
   bool parseModuleMapFile(const FileEntry *File, bool IsSystem,
                           const DirectoryEntry *HomeDir,
                           SourceLocation ExternModuleLoc = SourceLocation());
+
+  /// \brief Retrieve the names of the top-level modules that the parsed
+  /// module map file \p File declares, defines submodules of, or refers to
+  /// with "extern module".  A top-level "framework module *" is named "*".
+  ArrayRef<std::string> getDeclaredModules(const FileEntry *File) const;
     
   /// \brief Dump the contents of the module map, for debugging purposes.
   void dump();
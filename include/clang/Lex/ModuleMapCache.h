@@ -0,0 +1,81 @@
+//===--- ModuleMapCache.h - Persistent module map cache ---------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the ModuleMapCache interface.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_MODULEMAPCACHE_H
+#define LLVM_CLANG_LEX_MODULEMAPCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace clang {
+
+class FileEntry;
+
+/// \brief Remembers which top-level modules module map files declare across
+/// compilations.
+///
+/// Looking up a module that is not in an obviously named place parses every
+/// module map in the subdirectories of each search directory.  With an SDK
+/// that means hundreds of module maps, and each of them stats every header
+/// it names.  This cache records the top-level module names declared by
+/// every module map parsed by earlier compilations, keyed by the file's
+/// unique ID, size and modification time, so that such a lookup only parses
+/// the module maps that can declare the module it is looking for.
+///
+/// The cache is stored as a text file, written the same way as the
+/// IncludeGuardCache.
+class ModuleMapCache {
+  struct Entry {
+    off_t Size;
+    time_t ModTime;
+    std::vector<std::string> Modules;
+  };
+
+  std::map<llvm::sys::fs::UniqueID, Entry> Entries;
+
+  /// \brief Whether entries were added since the cache was loaded.
+  bool Dirty = false;
+
+  /// \brief Read the entries in \p Path into this cache, keeping any
+  /// existing entry for the same file.  Malformed files are ignored.
+  void read(StringRef Path);
+
+public:
+  /// \brief Load the cache stored in \p Path.  A missing or unreadable file
+  /// results in an empty cache.
+  explicit ModuleMapCache(StringRef Path) { read(Path); }
+
+  /// \brief Return whether the module map \p File may declare the top-level
+  /// module \p Name.  This is true unless we know the modules \p File
+  /// declares and \p Name is not among them.
+  bool mayDeclare(const FileEntry *File, StringRef Name) const;
+
+  /// \brief Record that the module map \p File declares \p Modules.
+  void insert(const FileEntry *File, ArrayRef<std::string> Modules);
+
+  /// \brief Write the cache back to \p Path if it changed.
+  ///
+  /// \returns true on failure.
+  bool save(StringRef Path);
+
+  unsigned size() const { return Entries.size(); }
+};
+
+} // end namespace clang
+
+#endif
@@ -19,6 +19,7 @@
 #include "clang/Lex/PPCallbacks.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/PointerUnion.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/iterator.h"
 #include "llvm/Support/Allocator.h"
@@ -293,9 +294,22 @@ namespace clang {
     /// \brief Allocator used to store preprocessing objects.
     llvm::BumpPtrAllocator BumpAlloc;
 
+    /// \brief A local preprocessed entity.
+    ///
+    /// Expansions of macros with a recorded definition, which make up most of
+    /// the entities of a macro-heavy translation unit, are stored as just the
+    /// definition of the expanded macro; the MacroExpansion object is created
+    /// when the entity is first retrieved.
+    typedef llvm::PointerUnion<PreprocessedEntity *, MacroDefinitionRecord *>
+        LocalEntity;
+
     /// \brief The set of preprocessed entities in this record, in order they
     /// were seen.
-    std::vector<PreprocessedEntity *> PreprocessedEntities;
+    std::vector<LocalEntity> PreprocessedEntities;
+
+    /// \brief The source ranges of the entities in PreprocessedEntities, in the
+    /// same order, so that range queries don't have to visit the entities.
+    std::vector<SourceRange> PreprocessedEntityRanges;
     
     /// \brief The set of preprocessed entities in this record that have been
     /// loaded from external sources.
@@ -353,6 +367,10 @@ namespace clang {
     unsigned findBeginLocalPreprocessedEntity(SourceLocation Loc) const;
     unsigned findEndLocalPreprocessedEntity(SourceLocation Loc) const;
 
+    /// \brief Add a new local entity covering \p Range, keeping the local
+    /// entities sorted by their begin locations.
+    PPEntityID addLocalEntity(LocalEntity Entity, SourceRange Range);
+
     /// \brief Allocate space for a new set of loaded preprocessed entities.
     ///
     /// \returns The index into the set of loaded preprocessed entities, which
@@ -27,6 +27,7 @@
 #include "clang/Lex/TokenLexer.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
@@ -172,6 +173,10 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   /// \brief Whether we have already loaded macros from the external source.
   mutable bool ReadMacrosFromExternalSource : 1;
 
+  /// \brief Identifiers whose macro history is available from the external
+  /// source but has not been loaded yet.
+  mutable llvm::DenseSet<const IdentifierInfo *> LazyMacroHistories;
+
   /// \brief True if pragmas are enabled.
   bool PragmasEnabled : 1;
 
@@ -596,13 +601,13 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   std::unique_ptr<TokenLexer> TokenLexerCache[TokenLexerCacheSize];
   /// \}
 
-  /// \brief Keeps macro expanded tokens for TokenLexers.
-  //
-  /// Works like a stack; a TokenLexer adds the macro expanded tokens that is
-  /// going to lex in the cache and when it finishes the tokens are removed
-  /// from the end of the cache.
-  SmallVector<Token, 16> MacroExpandedTokens;
-  std::vector<std::pair<TokenLexer *, size_t> > MacroExpandingLexersStack;
+  /// \brief Buffers for the argument-substituted expansions of function-like
+  /// macros that are not currently in use by a TokenLexer.
+  ///
+  /// A TokenLexer takes a buffer when it expands its arguments and lexes the
+  /// expansion directly out of it, then gives it back when it is done, so
+  /// the buffers (and their capacity) are reused by later expansions.
+  std::vector<std::unique_ptr<TokenLexer::TokenBuffer>> MacroExpansionBuffers;
 
   /// \brief A record of the macro definitions and expansions that
   /// occurred during preprocessing.
@@ -817,6 +822,7 @@ public:
   MacroDefinition getMacroDefinition(const IdentifierInfo *II) {
     if (!II->hasMacroDefinition())
       return MacroDefinition();
+    loadLazyMacroHistory(II);
 
     MacroState &S = CurSubmoduleState->Macros[II];
     auto *MD = S.getLatest();
@@ -831,6 +837,7 @@ public:
                                           SourceLocation Loc) {
     if (!II->hadMacroDefinition())
       return MacroDefinition();
+    loadLazyMacroHistory(II);
 
     MacroState &S = CurSubmoduleState->Macros[II];
     MacroDirective::DefInfo DI;
@@ -889,6 +896,13 @@ public:
   /// \brief Set a MacroDirective that was loaded from a PCH file.
   void setLoadedMacroDirective(IdentifierInfo *II, MacroDirective *MD);
 
+  /// \brief Note that the macro history of \p II in a PCH file will be
+  /// provided by the external source once it is needed.
+  ///
+  /// \param IsDefined Whether the latest directive in that history defines
+  /// the macro, which is all \#ifdef needs to know.
+  void setLazyMacroHistory(IdentifierInfo *II, bool IsDefined);
+
   /// \brief Register an exported macro for a module and identifier.
   ModuleMacro *addModuleMacro(Module *Mod, IdentifierInfo *II, MacroInfo *Macro,
                               ArrayRef<ModuleMacro *> Overrides, bool &IsNew);
@@ -1687,6 +1701,13 @@ public:
 
 private:
 
+  /// \brief If the macro history of \p II was deferred by the external
+  /// source, load it now.
+  void loadLazyMacroHistory(const IdentifierInfo *II) const {
+    if (!LazyMacroHistories.empty() && LazyMacroHistories.erase(II))
+      ExternalSource->loadMacroHistory(const_cast<IdentifierInfo *>(II));
+  }
+
   void PushIncludeMacroStack() {
     assert(CurLexerKind != CLK_CachingLexer && "cannot push a caching lexer");
     IncludeMacroStack.emplace_back(
@@ -1780,15 +1801,17 @@ private:
   /// otherwise the caller should lex again.
   bool HandleMacroExpandedIdentifier(Token &Tok, const MacroDefinition &MD);
 
-  /// \brief Cache macro expanded tokens for TokenLexers.
-  //
-  /// Works like a stack; a TokenLexer adds the macro expanded tokens that is
-  /// going to lex in the cache and when it finishes the tokens are removed
-  /// from the end of the cache.
-  Token *cacheMacroExpandedTokens(TokenLexer *tokLexer,
-                                  ArrayRef<Token> tokens);
-  void removeCachedMacroExpandedTokensOfLastLexer();
-  friend void TokenLexer::ExpandFunctionArguments();
+  /// \brief Get an empty buffer to expand a function-like macro into.
+  std::unique_ptr<TokenLexer::TokenBuffer> takeMacroExpansionBuffer();
+
+  /// \brief Return a buffer obtained from takeMacroExpansionBuffer() to the
+  /// pool once its tokens are no longer lexed.
+  void
+  releaseMacroExpansionBuffer(std::unique_ptr<TokenLexer::TokenBuffer> Buffer);
+
+  /// \brief Memory held by the pooled macro expansion buffers.
+  size_t getMacroExpansionBuffersMemory() const;
+  friend class TokenLexer;
 
   /// Determine whether the next preprocessor token to be
   /// lexed is a '('.  If so, consume the token and return true, if not, this
@@ -68,6 +68,15 @@ public:
   /// \brief When true, a PCH with compiler errors will not be rejected.
   bool AllowPCHWithCompilerErrors;
 
+  /// \brief When true, the macro history of an identifier loaded from a
+  /// precompiled header is only deserialized once the preprocessor needs it.
+  bool LazyPCHMacros;
+
+  /// \brief When true, consecutive tokens of a macro argument share one
+  /// macro argument expansion entry even if they were produced by different
+  /// macros, at the cost of macro backtraces that are less precise.
+  bool CompactMacroArgLocations;
+
   /// \brief Dump declarations that are deserialized from PCH, for testing.
   bool DumpDeserializedPCHDecls;
 
@@ -143,6 +152,8 @@ public:
   PreprocessorOptions() : UsePredefines(true), DetailedRecord(false),
                           DisablePCHValidation(false),
                           AllowPCHWithCompilerErrors(false),
+                          LazyPCHMacros(false),
+                          CompactMacroArgLocations(false),
                           DumpDeserializedPCHDecls(false),
                           PrecompiledPreambleBytes(0, true),
                           RemappedFilesKeepOriginalName(true),
@@ -15,11 +15,13 @@
 #define LLVM_CLANG_LEX_TOKENLEXER_H
 
 #include "clang/Basic/SourceLocation.h"
+#include "clang/Lex/Token.h"
+#include "llvm/ADT/SmallVector.h"
+#include <memory>
 
 namespace clang {
   class MacroInfo;
   class Preprocessor;
-  class Token;
   class MacroArgs;
 
 /// TokenLexer - This implements a lexer that returns tokens from a macro body
@@ -27,6 +29,12 @@ namespace clang {
 /// macro expansion and _Pragma handling, for example.
 ///
 class TokenLexer {
+public:
+  /// TokenBuffer - A buffer holding the expansion of a function-like macro.
+  /// Buffers are pooled by the preprocessor.
+  typedef SmallVector<Token, 128> TokenBuffer;
+
+private:
   /// Macro - The macro we are expanding from.  This is null if expanding a
   /// token stream.
   ///
@@ -43,14 +51,16 @@ class TokenLexer {
   /// Tokens - This is the pointer to an array of tokens that the macro is
   /// defined to, with arguments expanded for function-like macros.  If this is
   /// a token stream, these are the tokens we are returning.  This points into
-  /// the macro definition we are lexing from, a cache buffer that is owned by
-  /// the preprocessor, or some other buffer that we may or may not own
-  /// (depending on OwnsTokens).
-  /// Note that if it points into Preprocessor's cache buffer, the Preprocessor
-  /// may update the pointer as needed.
+  /// the macro definition we are lexing from, ExpansionBuffer, or some other
+  /// buffer that we may or may not own (depending on OwnsTokens).
   const Token *Tokens;
   friend class Preprocessor;
 
+  /// ExpansionBuffer - The buffer Tokens points into if this is a
+  /// function-like macro whose arguments changed its tokens.  It is taken
+  /// from the preprocessor's pool and given back when we are done with it.
+  std::unique_ptr<TokenBuffer> ExpansionBuffer;
+
   /// NumTokens - This is the length of the Tokens array.
   ///
   unsigned NumTokens;
@@ -153,6 +163,10 @@ public:
 private:
   void destroy();
 
+  /// releaseExpansionBuffer - Give the ExpansionBuffer, if any, back to the
+  /// preprocessor's pool.  Tokens must not be lexed afterwards.
+  void releaseExpansionBuffer();
+
   /// isAtEnd - Return true if the next lex call will pop this macro off the
   /// include stack.
   bool isAtEnd() const {
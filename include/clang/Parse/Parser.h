@@ -2012,6 +2012,37 @@ private:
     True, False, Ambiguous, Error
   };
 
+  /// \brief The kinds of disambiguation whose tentative parses are cached in
+  /// TentativeParseResults.
+  enum TentativeParseKind {
+    TPK_SimpleDeclaration,
+    TPK_ForRangeDeclaration,
+    TPK_TypeIdInParens,
+    TPK_TypeIdUnambiguous,
+    TPK_TypeIdAsTemplateArgument
+  };
+
+  /// \brief The results of the tentative parses done to disambiguate the
+  /// constructs starting at a token, keyed by the raw encoding of the token's
+  /// location and the kind of disambiguation.
+  ///
+  /// When an ambiguous construct is nested in another one, each tentative
+  /// parse of the outer construct is reverted and followed by another parse
+  /// of it, each of which would otherwise tentatively parse the inner
+  /// construct again.  This is cleared for each top-level declaration.
+  llvm::DenseMap<std::pair<unsigned, unsigned>, TPResult>
+      TentativeParseResults;
+
+  /// \brief Look up the cached result of disambiguating the construct starting
+  /// at the current token as \p Kind.
+  ///
+  /// \returns true if a result was found and stored in \p Result.
+  bool getCachedTentativeParse(TentativeParseKind Kind, TPResult &Result);
+
+  /// \brief Cache \p Result as the result of disambiguating the construct
+  /// starting at the current token as \p Kind.
+  void cacheTentativeParse(TentativeParseKind Kind, TPResult Result);
+
   /// \brief Based only on the given token kind, determine whether we know that
   /// we're at the start of an expression or a type-specifier-seq (which may
   /// be an expression, in C++).
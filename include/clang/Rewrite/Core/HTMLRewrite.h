@@ -17,6 +17,7 @@
 
 #include "clang/Basic/SourceLocation.h"
 #include <string>
+#include <vector>
 
 namespace clang {
 
@@ -53,6 +54,11 @@ namespace html {
   void EscapeText(Rewriter& R, FileID FID,
                   bool EscapeSpaces = false, bool ReplaceTabs = false);
 
+  /// EscapeText - This is the same as the above method, but rewrites the
+  /// buffer \p RB of the file whose contents are \p Buffer.
+  void EscapeText(RewriteBuffer &RB, StringRef Buffer,
+                  bool EscapeSpaces = false, bool ReplaceTabs = false);
+
   /// EscapeText - HTMLized the provided string so that special characters
   ///  in 's' are not interpreted as HTML tags.  Unlike the version of
   ///  EscapeText that rewrites a file, this version by default replaces tabs
@@ -61,9 +67,12 @@ namespace html {
                          bool EscapeSpaces = false, bool ReplaceTabs = false);
 
   void AddLineNumbers(Rewriter& R, FileID FID);
+  void AddLineNumbers(RewriteBuffer &RB, StringRef Buffer);
 
   void AddHeaderFooterInternalBuiltinCSS(Rewriter& R, FileID FID,
                                          const char *title = nullptr);
+  void AddHeaderFooterInternalBuiltinCSS(RewriteBuffer &RB, StringRef Buffer,
+                                         const char *title = nullptr);
 
   /// SyntaxHighlight - Relex the specified FileID and annotate the HTML with
   /// information about keywords, comments, etc.
@@ -75,6 +84,28 @@ namespace html {
   /// reasonably close.
   void HighlightMacros(Rewriter &R, FileID FID, const Preprocessor &PP);
 
+  /// \brief The ranges of a file that SyntaxHighlight and HighlightMacros
+  /// highlight, computed once so that they can be applied to the rewrite
+  /// buffers of many reports on the same file without relexing and
+  /// repreprocessing it each time.
+  class HighlightedRanges {
+    struct Range {
+      unsigned B, E;
+      std::string StartTag, EndTag;
+    };
+    std::vector<Range> Ranges;
+
+  public:
+    /// \brief Compute the ranges that SyntaxHighlight and HighlightMacros
+    /// would highlight in \p FID.
+    HighlightedRanges(FileID FID, const Preprocessor &PP);
+
+    /// \brief Highlight the ranges that lie within the offsets [\p Begin,
+    /// \p End) in the buffer \p RB of the file whose contents are \p Buffer.
+    void apply(RewriteBuffer &RB, StringRef Buffer, unsigned Begin = 0,
+               unsigned End = ~0U) const;
+  };
+
 } // end html namespace
 } // end clang namespace
 
@@ -13,6 +13,7 @@
 #include "clang/Basic/LLVM.h"
 #include "clang/Rewrite/Core/DeltaTree.h"
 #include "clang/Rewrite/Core/RewriteRope.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 
 namespace clang {
@@ -87,6 +88,23 @@ public:
   void ReplaceText(unsigned OrigOffset, unsigned OrigLength,
                    StringRef NewStr);
 
+  /// \brief A replacement of \c OrigLength characters at \c OrigOffset of
+  /// the original buffer by \c NewStr, as done by ReplaceText().
+  struct Edit {
+    unsigned OrigOffset;
+    unsigned OrigLength;
+    StringRef NewStr;
+  };
+
+  /// ReplaceTextBatch - Apply \p Edits as if by calling ReplaceText() for
+  /// each of them in order.
+  ///
+  /// The edits must be sorted by offset and must not overlap, except that
+  /// insertions may follow another edit at the same offset.  Instead of
+  /// splitting the rope for every edit, the new contents are built in a
+  /// single pass, which is much faster for large numbers of edits.
+  void ReplaceTextBatch(ArrayRef<Edit> Edits);
+
 private:  // Methods only usable by Rewriter.
 
   /// getMappedOffset - Given an offset into the original SourceBuffer that this
@@ -85,6 +85,13 @@ private:
   /// a single function.
   unsigned MaxUninitAnalysisBlockVisitsPerFunction;
 
+  /// \brief Number of functions for which the thread safety analysis ran.
+  unsigned NumThreadSafetyAnalysisFunctions;
+
+  /// \brief Number of functions the thread safety analysis skipped because
+  /// they use no capabilities.
+  unsigned NumThreadSafetySkippedFunctions;
+
   /// @}
 
 public:
@@ -28,6 +28,7 @@ namespace clang {
 
 class CXXConstructorDecl;
 class CXXDeleteExpr;
+class CXXMethodDecl;
 class CXXRecordDecl;
 class DeclaratorDecl;
 class LookupResult;
@@ -46,6 +47,18 @@ struct ExternalVTableUse {
   SourceLocation Location;
   bool DefinitionRequired;
 };
+
+/// \brief A simple structure that captures the result of a special member
+/// lookup for the purposes of the \c ExternalSemaSource.
+struct ExternalSpecialMemberResult {
+  CXXRecordDecl *Record;
+  /// \brief The special member and qualifiers, as encoded by
+  /// Sema::getSpecialMemberLookup().
+  unsigned Lookup;
+  CXXMethodDecl *Method;
+  /// \brief A Sema::SpecialMemberOverloadResult::Kind.
+  unsigned Kind;
+};
   
 /// \brief An abstract interface that should be implemented by
 /// external AST sources that also provide information for semantic
@@ -172,6 +185,15 @@ public:
   /// source should take care not to introduce the same vtables repeatedly.
   virtual void ReadUsedVTables(SmallVectorImpl<ExternalVTableUse> &VTables) {}
 
+  /// \brief Read the results of special member lookups known to the external
+  /// Sema source.
+  ///
+  /// The external source should append its own results to the given vector.
+  /// Note that this routine may be invoked multiple times; the external
+  /// source should take care not to introduce the same results repeatedly.
+  virtual void ReadSpecialMemberResults(
+      SmallVectorImpl<ExternalSpecialMemberResult> &Results) {}
+
   /// \brief Read the set of pending instantiations known to the external
   /// Sema source.
   ///
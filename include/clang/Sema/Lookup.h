@@ -182,7 +182,8 @@ public:
       HideTags(Other.HideTags),
       Diagnose(false),
       AllowHidden(Other.AllowHidden),
-      Shadowed(false)
+      Shadowed(false),
+      DeclaredBefore(Other.DeclaredBefore)
   {}
 
   // FIXME: Remove these deleted methods once the default build includes
@@ -202,7 +203,8 @@ public:
         Redecl(std::move(Other.Redecl)), HideTags(std::move(Other.HideTags)),
         Diagnose(std::move(Other.Diagnose)),
         AllowHidden(std::move(Other.AllowHidden)),
-        Shadowed(std::move(Other.Shadowed)) {
+        Shadowed(std::move(Other.Shadowed)),
+        DeclaredBefore(std::move(Other.DeclaredBefore)) {
     Other.Paths = nullptr;
     Other.Diagnose = false;
   }
@@ -223,6 +225,7 @@ public:
     Diagnose = std::move(Other.Diagnose);
     AllowHidden = std::move(Other.AllowHidden);
     Shadowed = std::move(Other.Shadowed);
+    DeclaredBefore = std::move(Other.DeclaredBefore);
     Other.Paths = nullptr;
     Other.Diagnose = false;
     return *this;
@@ -269,6 +272,12 @@ public:
     AllowHidden = AH;
   }
 
+  /// \brief Specify that namespace-scope declarations first declared after
+  /// \p Loc are not visible.
+  void setDeclaredBefore(SourceLocation Loc) {
+    DeclaredBefore = Loc;
+  }
+
   /// \brief Determine whether this lookup is permitted to see hidden
   /// declarations, such as those in modules that have not yet been imported.
   bool isHiddenDeclarationVisible(NamedDecl *ND) const {
@@ -346,6 +355,9 @@ public:
     if (!D->isInIdentifierNamespace(IDNS))
       return nullptr;
 
+    if (DeclaredBefore.isValid() && isDeclaredTooLate(D))
+      return nullptr;
+
     if (isVisible(getSema(), D) || isHiddenDeclarationVisible(D))
       return D;
 
@@ -355,6 +367,7 @@ public:
 private:
   static bool isVisibleSlow(Sema &SemaRef, NamedDecl *D);
   NamedDecl *getAcceptableDeclSlow(NamedDecl *D) const;
+  bool isDeclaredTooLate(NamedDecl *D) const;
 
 public:
   /// \brief Returns the identifier namespace mask for this lookup.
@@ -731,6 +744,10 @@ private:
   /// declaration that we skipped. This only happens when \c LookupKind
   /// is \c LookupRedeclarationWithLinkage.
   bool Shadowed;
+
+  /// \brief If valid, namespace-scope declarations first declared after this
+  /// location are not visible.
+  SourceLocation DeclaredBefore;
 };
 
 /// \brief Consumes visible declarations found when searching for
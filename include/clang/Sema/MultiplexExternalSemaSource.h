@@ -305,6 +305,11 @@ public:
   /// source should take care not to introduce the same vtables repeatedly.
   void ReadUsedVTables(SmallVectorImpl<ExternalVTableUse> &VTables) override;
 
+  /// \brief Read the results of special member lookups known to the external
+  /// Sema source.
+  void ReadSpecialMemberResults(
+      SmallVectorImpl<ExternalSpecialMemberResult> &Results) override;
+
   /// \brief Read the set of pending instantiations known to the external
   /// Sema source.
   ///
@@ -50,6 +50,7 @@
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include <deque>
 #include <memory>
@@ -77,6 +78,7 @@ namespace clang {
   class CapturedDecl;
   class CXXBasePath;
   class CXXBasePaths;
+  struct CXXBasePathElement;
   class CXXBindTemporaryExpr;
   typedef SmallVector<CXXBaseSpecifier*, 4> CXXCastPath;
   class CXXConstructorDecl;
@@ -205,6 +207,10 @@ namespace sema {
   class TemplateDeductionInfo;
 }
 
+namespace analyze_format_string {
+  class ParsedFormatString;
+}
+
 namespace threadSafety {
   class BeforeSet;
   void threadSafetyCleanup(BeforeSet* Cache);
@@ -553,6 +559,14 @@ public:
       LateParsedTemplateMapT;
   LateParsedTemplateMapT LateParsedTemplateMap;
 
+  /// \brief The functions whose bodies were stored in LateParsedTemplateMap
+  /// although they are not templates, and which were odr-used since their
+  /// bodies were last parsed at the end of the translation unit.
+  SmallVector<FunctionDecl *, 8> PendingLazyFunctionBodies;
+
+  /// \brief Parse the bodies of the functions in PendingLazyFunctionBodies.
+  void ParsePendingLazyFunctionBodies();
+
   /// \brief Callback to the parser to parse templated functions when needed.
   typedef void LateTemplateParserCB(void *P, LateParsedTemplate &LPT);
   typedef void LateTemplateParserCleanupCB(void *P);
@@ -560,6 +574,19 @@ public:
   LateTemplateParserCleanupCB *LateTemplateParserCleanup;
   void *OpaqueParser;
 
+  /// \brief While the body of a late-parsed template is parsed outside of
+  /// Microsoft mode, the end of its definition.
+  ///
+  /// Unqualified lookup in the body doesn't find the namespace-scope
+  /// declarations that follow it, so that non-dependent names bind as if the
+  /// body had been parsed where it was written.
+  SourceLocation LateParsedTemplateEnd;
+
+  /// \brief The number of active template instantiations when the late-parsed
+  /// template body started, so that the instantiations it triggers are not
+  /// affected by LateParsedTemplateEnd.
+  unsigned LateParsedTemplateDepth;
+
   void SetLateTemplateParser(LateTemplateParserCB *LTP,
                              LateTemplateParserCleanupCB *LTPCleanup,
                              void *P) {
@@ -924,12 +951,22 @@ public:
 
   private:
     llvm::PointerIntPair<CXXMethodDecl*, 2> Pair;
+    CXXRecordDecl *Record;
+    unsigned Lookup;
 
   public:
-    SpecialMemberOverloadResult(const llvm::FoldingSetNodeID &ID)
-      : FastFoldingSetNode(ID)
+    SpecialMemberOverloadResult(const llvm::FoldingSetNodeID &ID,
+                                CXXRecordDecl *Record, unsigned Lookup)
+      : FastFoldingSetNode(ID), Record(Record), Lookup(Lookup)
     {}
 
+    /// \brief The class whose special member was looked up.
+    CXXRecordDecl *getRecord() const { return Record; }
+
+    /// \brief The special member and qualifiers that were looked up, as
+    /// encoded by getSpecialMemberLookup().
+    unsigned getLookup() const { return Lookup; }
+
     CXXMethodDecl *getMethod() const { return Pair.getPointer(); }
     void setMethod(CXXMethodDecl *MD) { Pair.setPointer(MD); }
 
@@ -939,8 +976,22 @@ public:
 
   /// \brief A cache of special member function overload resolution results
   /// for C++ records.
+  ///
+  /// The results are written to AST files, and those of the AST files that
+  /// are loaded are added to the cache on the first cache miss after they
+  /// are loaded.
   llvm::FoldingSet<SpecialMemberOverloadResult> SpecialMemberCache;
 
+  /// \brief The results in SpecialMemberCache that were computed in this
+  /// translation unit, in the order they were computed.
+  SmallVector<SpecialMemberOverloadResult *, 16> LocalSpecialMemberResults;
+
+  /// \brief Add the special member results of the external source to
+  /// SpecialMemberCache.
+  ///
+  /// \returns true if any result was added.
+  bool ReadSpecialMemberResults();
+
   /// \brief A cache of the flags available in enumerations with the flag_bits
   /// attribute.
   mutable llvm::DenseMap<const EnumDecl*, llvm::APInt> FlagBitsCache;
@@ -959,6 +1010,29 @@ public:
   /// \brief The number of SFINAE diagnostics that have been trapped.
   unsigned NumSFINAEErrors;
 
+  /// \brief The number of class template specializations and member classes
+  /// whose definitions were instantiated.
+  unsigned NumClassInstantiations;
+
+  /// \brief The number of function definitions that were instantiated.
+  unsigned NumFunctionInstantiations;
+
+  /// \brief The number of function definitions that were not instantiated
+  /// because of an explicit instantiation declaration.
+  unsigned NumSuppressedFunctionInstantiations;
+
+  /// \brief The number of expressions visited by tree transformations, e.g.
+  /// during template instantiation.
+  unsigned NumTransformedExprs;
+
+  /// \brief The number of expressions visited by tree transformations that
+  /// were replaced by a new expression.
+  unsigned NumRebuiltExprs;
+
+  /// \brief The number of expressions visited by tree transformations that
+  /// were returned without walking them, as they could not change.
+  unsigned NumSkippedExprs;
+
   typedef llvm::DenseMap<ParmVarDecl *, llvm::TinyPtrVector<ParmVarDecl *>>
     UnparsedDefaultArgInstantiationsMap;
 
@@ -1014,6 +1088,15 @@ public:
     CXXInvalid
   };
 
+  /// \brief Encode the special member and the qualifiers of a special member
+  /// lookup into a single value.
+  static unsigned getSpecialMemberLookup(CXXSpecialMember SM, bool ConstArg,
+                                         bool VolatileArg, bool RValueThis,
+                                         bool ConstThis, bool VolatileThis) {
+    return SM | ConstArg << 3 | VolatileArg << 4 | RValueThis << 5 |
+           ConstThis << 6 | VolatileThis << 7;
+  }
+
   typedef std::pair<CXXRecordDecl*, CXXSpecialMember> SpecialMemberDecl;
 
   /// The C++ special members which we are currently in the process of
@@ -1816,6 +1899,11 @@ public:
   /// \c constexpr in C++11 or has an 'auto' return type in C++14).
   bool canSkipFunctionBody(Decl *D);
 
+  /// \brief Determine whether the body of the inline function \p D, which is
+  /// not a template, can be parsed at the end of the translation unit and
+  /// only if the function is odr-used (-flazy-inline-method-parsing).
+  bool canParseFunctionBodyOnUse(Decl *D);
+
   void computeNRVO(Stmt *Body, sema::FunctionScopeInfo *Scope);
   Decl *ActOnFinishFunctionBody(Decl *Decl, Stmt *Body);
   Decl *ActOnFinishFunctionBody(Decl *Decl, Stmt *Body, bool IsInstantiation);
@@ -2818,6 +2906,24 @@ private:
   /// source.
   bool LoadedExternalKnownNamespaces;
 
+  /// \brief The identifiers provided by the external identifier source,
+  /// indexed by length, so that each typo correction neither walks the
+  /// on-disk identifier tables again nor looks at names whose length alone
+  /// rules them out.
+  std::vector<std::vector<StringRef>> ExternalTypoCorrectionNames;
+
+  /// \brief The generation of the external AST source when
+  /// \c ExternalTypoCorrectionNames was built.
+  uint32_t ExternalTypoCorrectionNamesGeneration;
+
+  /// \brief Whether \c ExternalTypoCorrectionNames has been built.
+  bool LoadedExternalTypoCorrectionNames;
+
+  /// \brief Helper for makeTypoCorrectionConsumer that feeds the names known
+  /// to the external identifier source to \p Consumer.
+  void addExternalTypoCorrectionNames(TypoCorrectionConsumer &Consumer,
+                                      StringRef Typo);
+
   /// \brief Helper for CorrectTypo and CorrectTypoDelayed used to create and
   /// populate a new TypoCorrectionConsumer. Returns nullptr if typo correction
   /// should be skipped entirely.
@@ -5505,6 +5611,8 @@ public:
 
   // FIXME: I don't like this name.
   void BuildBasePathArray(const CXXBasePaths &Paths, CXXCastPath &BasePath);
+  void BuildBasePathArray(ArrayRef<CXXBasePathElement> Path,
+                          CXXCastPath &BasePath);
 
   bool CheckDerivedToBaseConversion(QualType Derived, QualType Base,
                                     SourceLocation Loc, SourceRange Range,
@@ -6913,8 +7021,18 @@ public:
     Sema &SemaRef;
     bool Invalid;
     bool SavedInNonInstantiationSFINAEContext;
+
+    /// \brief Whether this instantiation opened an event on the active
+    /// time trace.
+    bool Traced;
+
+    /// \brief The amount of memory the ASTContext had allocated when this
+    /// instantiation began, if it is traced.
+    size_t TracedASTMemory;
+
     bool CheckInstantiationDepth(SourceLocation PointOfInstantiation,
                                  SourceRange InstantiationRange);
+    void beginTimeTrace(const ActiveTemplateInstantiation &Inst);
 
     InstantiatingTemplate(
         Sema &SemaRef, ActiveTemplateInstantiation::InstantiationKind Kind,
@@ -9424,7 +9542,12 @@ public:
   static FormatStringType GetFormatStringType(const FormatAttr *Format);
 
   bool FormatStringHasSArg(const StringLiteral *FExpr);
-  
+
+  /// \brief The format strings checked so far, keyed by their kind and
+  /// contents, so that each distinct format string is parsed only once.
+  llvm::StringMap<std::unique_ptr<analyze_format_string::ParsedFormatString>>
+      ParsedFormatStrings;
+
   static bool GetFormatNSStringIdx(const FormatAttr *Format, unsigned &Idx);
 
 private:
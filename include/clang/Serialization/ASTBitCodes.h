@@ -46,7 +46,7 @@ namespace clang {
     /// for the previous version could still support reading the new
     /// version by ignoring new kinds of subblocks), this number
     /// should be increased.
-    const unsigned VERSION_MINOR = 0;
+    const unsigned VERSION_MINOR = 2;
 
     /// \brief An ID number that refers to an identifier in an AST file.
     /// 
@@ -580,7 +580,16 @@ namespace clang {
       MSSTRUCT_PRAGMA_OPTIONS = 55,
 
       /// \brief Record code for \#pragma ms_struct options.
-      POINTERS_TO_MEMBERS_PRAGMA_OPTIONS = 56
+      POINTERS_TO_MEMBERS_PRAGMA_OPTIONS = 56,
+
+      /// \brief Record code for the spellings of the selectors that have an
+      /// entry in the method pool of a module file.
+      ///
+      /// This record is only consumed by the global module index.
+      METHOD_POOL_SELECTORS = 57,
+
+      /// \brief Record code for the results of special member lookups.
+      SPECIAL_MEMBER_RESULTS = 58
     };
 
     /// \brief Record types used within a source manager block.
@@ -1281,6 +1290,8 @@ namespace clang {
       EXPR_IMPLICIT_VALUE_INIT,
       /// \brief An NoInitExpr record.
       EXPR_NO_INIT,
+      /// \brief A DataArrayExpr record.
+      EXPR_DATA_ARRAY,
       /// \brief A VAArgExpr record.
       EXPR_VA_ARG,
       /// \brief An AddrLabelExpr record.
@@ -678,6 +678,11 @@ private:
   /// IDs have not yet been deserialized to the global IDs of those macros.
   PendingMacroIDsMap PendingMacroIDs;
 
+  /// \brief Macro histories from PCH files that the preprocessor has not
+  /// asked for yet, when PreprocessorOptions::LazyPCHMacros is set.
+  llvm::DenseMap<IdentifierInfo *, SmallVector<PendingMacroInfo, 2> >
+    LazyMacroIDs;
+
   typedef ContinuousRangeMap<unsigned, ModuleFile *, 4>
     GlobalPreprocessedEntityMapType;
 
@@ -720,6 +725,12 @@ private:
   /// is the instantiation location.
   SmallVector<uint64_t, 64> PendingInstantiations;
 
+  /// \brief The results of special member lookups in the chain.
+  ///
+  /// Each result consists of the ID of the class, the encoded lookup, the ID
+  /// of the selected member (or 0) and the kind of the result.
+  SmallVector<uint64_t, 64> SpecialMemberResults;
+
   //@}
 
   /// \name DiagnosticsEngine-relevant special data
@@ -876,6 +887,26 @@ private:
   /// \brief The total number of macros stored in the chain.
   unsigned TotalNumMacros;
 
+  /// \brief The number of macro histories whose deserialization was deferred
+  /// until the preprocessor needed them.
+  unsigned NumLazyMacroHistories;
+
+  /// \brief The number of deferred macro histories that were eventually
+  /// deserialized.
+  unsigned NumLazyMacroHistoriesLoaded;
+
+  /// \brief The number of function and method bodies that were attached
+  /// lazily to their declarations.
+  unsigned NumLazyBodies;
+
+  /// \brief The number of lazily-attached bodies that were deserialized.
+  unsigned NumLazyBodiesRead;
+
+  /// \brief The number of AST files whose input files were not validated,
+  /// because another reader in this process already validated them in the
+  /// current build session.
+  unsigned NumInputValidationsShared;
+
   /// \brief The number of lookups into identifier tables.
   unsigned NumIdentifierLookups;
 
@@ -1013,6 +1044,11 @@ private:
   /// when merging implicit instantiations of class templates across modules.
   llvm::DenseMap<DeclContext *, DeclContext *> MergedDeclContexts;
 
+  /// \brief The merged class definitions whose ODR hash matched the hash of
+  /// the definition they were merged into.  Their members are known to be
+  /// declared by that definition too, so they don't need to be checked.
+  llvm::SmallPtrSet<DeclContext *, 16> OdrHashMatchedDefinitions;
+
   /// \brief A mapping from canonical declarations of enums to their canonical
   /// definitions. Only populated when using modules in C++.
   llvm::DenseMap<EnumDecl *, EnumDecl *> EnumDefinitions;
@@ -1081,6 +1117,8 @@ private:
     time_t StoredTime;
     bool Overridden;
     bool Transient;
+    /// \brief The hash of the file's contents, or zero if it wasn't recorded.
+    uint64_t ContentHash;
   };
 
   /// \brief Reads the stored information about an input file.
@@ -1849,6 +1887,9 @@ public:
 
   void ReadUsedVTables(SmallVectorImpl<ExternalVTableUse> &VTables) override;
 
+  void ReadSpecialMemberResults(
+      SmallVectorImpl<ExternalSpecialMemberResult> &Results) override;
+
   void ReadPendingInstantiations(
                  SmallVectorImpl<std::pair<ValueDecl *,
                                            SourceLocation> > &Pending) override;
@@ -1892,6 +1933,12 @@ public:
 
   void resolvePendingMacro(IdentifierInfo *II, const PendingMacroInfo &PMInfo);
 
+  /// \brief Determine whether the latest directive in a macro history defines
+  /// the macro, without deserializing any macro definitions.
+  ///
+  /// \returns true on failure, i.e. if the history can't be deferred.
+  bool peekMacroHistory(const PendingMacroInfo &PMInfo, bool &IsDefined);
+
   /// \brief Retrieve the macro with the given ID.
   MacroInfo *getMacro(serialization::MacroID ID);
 
@@ -2108,6 +2155,9 @@ public:
   /// \brief Update an out-of-date identifier.
   void updateOutOfDateIdentifier(IdentifierInfo &II) override;
 
+  /// \brief Load a macro history that was deferred by -lazy-pch-macros.
+  void loadMacroHistory(IdentifierInfo *II) override;
+
   /// \brief Note that this identifier is up-to-date.
   void markIdentifierUpToDate(IdentifierInfo *II);
 
@@ -70,6 +70,13 @@ class GlobalModuleIndex {
   /// GlobalModuleIndex.
   void *IdentifierIndex;
 
+  /// \brief The selector hash table, mapping the spelling of each selector
+  /// to the module files whose method pool contains an entry for it.
+  ///
+  /// This pointer actually points to an IdentifierIndexTable object; it is
+  /// null if any module file in the index predates the selector index.
+  void *SelectorIndex;
+
   /// \brief Information about a given module file.
   struct ModuleInfo {
     ModuleInfo() : File(), Size(), ModTime() { }
@@ -115,6 +122,13 @@ class GlobalModuleIndex {
   /// \brief The number of identifier lookup hits, where we recognize the
   /// identifier.
   unsigned NumIdentifierLookupHits;
+
+  /// \brief The number of selector lookups we performed.
+  unsigned NumSelectorLookups;
+
+  /// \brief The number of selector lookup hits, where we recognize the
+  /// selector.
+  unsigned NumSelectorLookupHits;
   
   /// \brief Internal constructor. Use \c readIndex() to read an index.
   explicit GlobalModuleIndex(std::unique_ptr<llvm::MemoryBuffer> Buffer,
@@ -179,6 +193,18 @@ public:
   /// \returns true if the identifier is known to the index, false otherwise.
   bool lookupIdentifier(StringRef Name, HitSet &Hits);
 
+  /// \brief Look for all of the module files whose method pool has an entry
+  /// for the given selector.
+  ///
+  /// \param Name The spelling of the selector, as produced by
+  /// \c Selector::getAsString().
+  ///
+  /// \param Hits Will be populated with the set of module files that have
+  /// methods for this selector.
+  ///
+  /// \returns true if the index has selector information, false otherwise.
+  bool lookupSelector(StringRef Name, HitSet &Hits);
+
   /// \brief Note that the given module file has been loaded.
   ///
   /// \returns false if the global module index has information about this
@@ -193,6 +219,10 @@ public:
 
   /// \brief Write a global index into the given
   ///
+  /// If the directory already has an index and none of the module files it
+  /// describes has changed, only the module files added since are loaded,
+  /// and merged into that index.
+  ///
   /// \param FileMgr The file manager to use to load module files.
   /// \param PCHContainerRdr - The PCHContainerOperations to use for loading and
   /// creating modules.
@@ -0,0 +1,99 @@
+//===--- ModuleBufferCache.h - Process-wide AST file cache ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines the ModuleBufferCache class, which shares the contents
+//  of module and PCH files between all of the AST readers of a process.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_SERIALIZATION_MODULEBUFFERCACHE_H
+#define LLVM_CLANG_SERIALIZATION_MODULEBUFFERCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <memory>
+#include <mutex>
+
+namespace clang {
+
+class FileEntry;
+
+namespace serialization {
+
+/// \brief The contents of the module and PCH files read by any AST reader in
+/// this process, and how far their input files were validated.
+///
+/// Every CompilerInstance creates its own ModuleManager, so a process that
+/// builds modules for its imports, or runs many compilations like a tool
+/// over a compilation database, otherwise maps and validates the same
+/// module files over and over.
+///
+/// Entries are keyed by the name of the file and are only used while its
+/// unique ID, size and modification time are unchanged; a module file that
+/// is rebuilt replaces the entry of its previous version.  Each buffer stays
+/// alive for as long as either the cache or a reader refers to it.
+class ModuleBufferCache {
+  struct Entry {
+    llvm::sys::fs::UniqueID UniqueID;
+    off_t Size;
+    time_t ModTime;
+    std::shared_ptr<llvm::MemoryBuffer> Buffer;
+
+    /// \brief The build session in which the input files were validated.
+    uint64_t ValidatedSession = 0;
+
+    /// \brief The number of input files that were validated, or zero.
+    unsigned NumValidatedInputs = 0;
+  };
+
+  mutable std::mutex Mutex;
+  llvm::StringMap<Entry> Entries;
+
+  /// \brief Returns the entry of \p File if it is still current.
+  const Entry *lookupLocked(const FileEntry *File) const;
+
+public:
+  /// \brief Returns the cache shared by all readers in this process.
+  static ModuleBufferCache &getProcessCache();
+
+  /// \brief Returns a buffer with the cached contents of \p File, or null if
+  /// they are not cached.
+  std::unique_ptr<llvm::MemoryBuffer> lookup(const FileEntry *File) const;
+
+  /// \brief Records \p Buffer as the contents of \p File.
+  ///
+  /// \returns a buffer that refers to the recorded contents.
+  std::unique_ptr<llvm::MemoryBuffer>
+  insert(const FileEntry *File, std::unique_ptr<llvm::MemoryBuffer> Buffer);
+
+  /// \brief Whether the first \p NumInputs input files of \p File were
+  /// validated in build session \p Session, by a reader using the cached
+  /// contents \p Buffer.
+  bool wereInputsValidated(const FileEntry *File,
+                           const llvm::MemoryBuffer &Buffer, uint64_t Session,
+                           unsigned NumInputs) const;
+
+  /// \brief Records that the first \p NumInputs input files of \p File were
+  /// validated in build session \p Session, if \p Buffer holds the cached
+  /// contents of \p File.
+  void markInputsValidated(const FileEntry *File,
+                           const llvm::MemoryBuffer &Buffer, uint64_t Session,
+                           unsigned NumInputs);
+
+  /// \brief Drops all entries.  Buffers still in use stay alive.
+  void clear();
+
+  unsigned size() const;
+};
+
+} // end namespace serialization
+} // end namespace clang
+
+#endif
@@ -57,6 +57,10 @@ class ModuleManager {
   llvm::DenseMap<const FileEntry *, std::unique_ptr<llvm::MemoryBuffer>>
       InMemoryBuffers;
 
+  /// \brief The number of AST files whose contents were already read by
+  /// another reader in this process.
+  unsigned NumSharedBuffers = 0;
+
   /// \brief The visitation order.
   SmallVector<ModuleFile *, 4> VisitOrder;
       
@@ -163,6 +167,10 @@ public:
   /// \brief Number of modules loaded
   unsigned size() const { return Chain.size(); }
 
+  /// \brief Number of loaded AST files whose contents were shared with other
+  /// readers through the process-wide \c ModuleBufferCache.
+  unsigned getNumSharedBuffers() const { return NumSharedBuffers; }
+
   /// \brief The result of attempting to add a new module.
   enum AddModuleResult {
     /// \brief The module file had already been loaded.
@@ -121,6 +121,26 @@ enum IPAKind {
   IPAK_DynamicDispatchBifurcate = 5
 };
 
+/// \brief Describes the order in which the paths are explored.
+enum ExplorationStrategyKind {
+  ESK_NotSet = 0,
+
+  /// Finish the most recently reached path first.
+  ESK_DFS = 1,
+
+  /// Advance every path by one step before advancing any by two.
+  ESK_BFS = 2,
+
+  /// Explore blocks in BFS order, but the statements within a block in DFS
+  /// order.
+  ESK_BFSBlockDFSContents = 3,
+
+  /// Continue first with the paths that enter a block the fewest times
+  /// entered in its stack frame, so that the blocks that haven't been
+  /// explored yet are reached before the node budget runs out.
+  ESK_UnexploredFirst = 4
+};
+
 class AnalyzerOptions : public RefCountedBase<AnalyzerOptions> {
 public:
   typedef llvm::StringMap<std::string> ConfigTable;
@@ -259,12 +279,36 @@ private:
   /// \sa getMaxNodesPerTopLevelFunction
   Optional<unsigned> MaxNodesPerTopLevelFunction;
 
+  /// \sa getMaxFunctionMemory
+  Optional<unsigned> MaxFunctionMemory;
+
   /// \sa shouldInlineLambdas
   Optional<bool> InlineLambdas;
 
   /// \sa shouldWidenLoops
   Optional<bool> WidenLoops;
 
+  /// \sa shouldSummarizeLoops
+  Optional<bool> SummarizeLoops;
+
+  /// \sa getShardCount
+  Optional<unsigned> ShardCount;
+
+  /// \sa getShardIndex
+  Optional<unsigned> ShardIndex;
+
+  /// \sa getHTMLReportThreads
+  Optional<unsigned> HTMLReportThreads;
+
+  /// \sa getHTMLHighlightMaxLines
+  Optional<unsigned> HTMLHighlightMaxLines;
+
+  /// \sa shouldCacheSymbolicSimplifications
+  Optional<bool> CacheSymbolicSimplifications;
+
+  /// \sa getExplorationStrategy
+  ExplorationStrategyKind ExplorationStrategy;
+
   /// A helper function that retrieves option for a given full-qualified
   /// checker name.
   /// Options for checkers can be specified via 'analyzer-config' command-line
@@ -525,6 +569,14 @@ public:
   /// This is controlled by the 'max-nodes' config option.
   unsigned getMaxNodesPerTopLevelFunction();
 
+  /// Returns the soft limit, in megabytes, on the memory the analyzer can
+  /// allocate for the exploded graph and the program states of a top level
+  /// function. When the limit is reached, the exploration stops just like
+  /// when the node limit is reached. 0 is the default and means no limit.
+  ///
+  /// This is controlled by the 'max-function-memory-mb' config option.
+  unsigned getMaxFunctionMemory();
+
   /// Returns true if lambdas should be inlined. Otherwise a sink node will be
   /// generated each time a LambdaExpr is visited.
   bool shouldInlineLambdas();
@@ -533,6 +585,54 @@ public:
   /// This is controlled by the 'widen-loops' config option.
   bool shouldWidenLoops();
 
+  /// Returns true if the remaining iterations of counted loops should be
+  /// replaced by a summary once the first iteration has been analyzed. Bugs
+  /// that only show in later iterations are then missed.
+  /// This is controlled by the 'summarize-loops' config option.
+  bool shouldSummarizeLoops();
+
+  /// Returns the number of shards the entry points of the path-sensitive
+  /// analysis are divided into, so that several analyzer invocations can
+  /// analyze one translation unit in parallel, each taking one shard.
+  ///
+  /// This is controlled by the 'shard-count' config option.
+  unsigned getShardCount();
+
+  /// Returns the shard of entry points that this invocation analyzes, from 0
+  /// to one less than the shard count. The shard with index 0 also runs the
+  /// checks that aren't path-sensitive.
+  ///
+  /// This is controlled by the 'shard-index' config option.
+  unsigned getShardIndex();
+
+  /// Returns the number of threads that render and write HTML reports. 1 is
+  /// the default; 0 means one thread per hardware thread.
+  ///
+  /// This is controlled by the 'html-report-threads' config option.
+  unsigned getHTMLReportThreads();
+
+  /// Returns the number of lines above which a file is syntax highlighted in
+  /// HTML reports only around the path of each report, rather than as a
+  /// whole. 0 means files are always highlighted as a whole.
+  ///
+  /// This is controlled by the 'html-highlight-max-lines' config option.
+  unsigned getHTMLHighlightMaxLines();
+
+  /// Returns true if the results of simplifying symbolic expressions should
+  /// be reused by the states that have the same constraints.
+  ///
+  /// This is controlled by the 'cache-symbolic-simplifications' config
+  /// option, which accepts the values "true" and "false". Default = true
+  bool shouldCacheSymbolicSimplifications();
+
+  /// Returns the order in which the paths of a top level function are
+  /// explored.
+  ///
+  /// This is controlled by the 'exploration_strategy' config option, which
+  /// accepts the values "dfs" (the default), "bfs", "bfs_block_dfs_contents"
+  /// and "unexplored_first".
+  ExplorationStrategyKind getExplorationStrategy();
+
 public:
   AnalyzerOptions() :
     AnalysisStoreOpt(RegionStoreModel),
@@ -556,7 +656,8 @@ public:
     InliningMode(NoRedundancy),
     UserMode(UMK_NotSet),
     IPAMode(IPAK_NotSet),
-    CXXMemberInliningMode() {}
+    CXXMemberInliningMode(),
+    ExplorationStrategy(ESK_NotSet) {}
 
 };
   
@@ -28,6 +28,10 @@
 #include "llvm/ADT/ilist.h"
 #include "llvm/ADT/ilist_node.h"
 
+namespace llvm {
+class Timer;
+}
+
 namespace clang {
 
 class ASTContext;
@@ -380,6 +384,14 @@ public:
   virtual ASTContext &getASTContext() = 0;
   virtual SourceManager& getSourceManager() = 0;
   virtual AnalyzerOptions& getAnalyzerOptions() = 0;
+
+  /// Returns true if the report with the given issue hash is already known,
+  /// so that generating its path can be skipped.
+  virtual bool isInReportBaseline(StringRef IssueHash) { return false; }
+
+  /// Returns the timer for the generation of the path diagnostics, if they
+  /// are timed.
+  virtual llvm::Timer *getReportTimer() { return nullptr; }
 };
 
 /// BugReporter is a utility class for generating PathDiagnostics for analysis.
@@ -107,7 +107,8 @@ class CheckerManager {
 
 public:
   CheckerManager(const LangOptions &langOpts, AnalyzerOptionsRef AOptions)
-      : LangOpts(langOpts), AOptions(std::move(AOptions)) {}
+      : LangOpts(langOpts), AOptions(std::move(AOptions)), Profiling(false),
+        CurrentProfileScope(nullptr) {}
 
   ~CheckerManager();
 
@@ -123,6 +124,49 @@ public:
 
   typedef CheckerBase *CheckerRef;
   typedef const void *CheckerTag;
+
+//===----------------------------------------------------------------------===//
+// Profiling
+//===----------------------------------------------------------------------===//
+
+  /// \brief The number of times the callbacks of a checker ran, and the
+  /// processor time they took. The time doesn't include the callbacks of
+  /// other checkers that they caused to run, which is counted for those.
+  struct CheckerProfile {
+    unsigned NumCalls;
+    double Seconds;
+    CheckerProfile() : NumCalls(0), Seconds(0) {}
+  };
+  typedef llvm::DenseMap<const CheckerBase *, CheckerProfile>
+      CheckerProfileMap;
+
+  /// \brief Start recording the CheckerProfile of every checker.
+  void enableProfiling() { Profiling = true; }
+
+  const CheckerProfileMap &getCheckerProfiles() const { return Profiles; }
+
+  /// \brief Times a checker callback, if profiling is enabled.
+  class ProfileScope {
+    CheckerManager *Mgr;
+    const CheckerBase *Checker;
+    ProfileScope *Parent;
+    double Start;
+    double ChildSeconds;
+
+    void start();
+    void stop();
+
+  public:
+    ProfileScope(CheckerManager &mgr, const CheckerBase *checker)
+        : Mgr(mgr.Profiling ? &mgr : nullptr), Checker(checker) {
+      if (Mgr)
+        start();
+    }
+    ~ProfileScope() {
+      if (Mgr)
+        stop();
+    }
+  };
   typedef CheckerFn<void ()> CheckerDtor;
 
 //===----------------------------------------------------------------------===//
@@ -558,6 +602,10 @@ private:
 
   std::vector<CheckerDtor> CheckerDtors;
 
+  bool Profiling;
+  CheckerProfileMap Profiles;
+  ProfileScope *CurrentProfileScope;
+
   struct DeclCheckerInfo {
     CheckDeclFunc CheckFn;
     HandlesDeclFunc IsForDeclFn;
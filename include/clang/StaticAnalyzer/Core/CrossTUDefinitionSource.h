@@ -0,0 +1,40 @@
+//===--- CrossTUDefinitionSource.h - Definitions from other TUs -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the clang::ento::CrossTUDefinitionSource interface, through
+/// which the analyzer finds the definitions of functions that are defined in
+/// other translation units, so that it can inline calls to them.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_STATICANALYZER_CORE_CROSSTUDEFINITIONSOURCE_H
+#define LLVM_CLANG_STATICANALYZER_CORE_CROSSTUDEFINITIONSOURCE_H
+
+namespace clang {
+
+class FunctionDecl;
+
+namespace ento {
+
+/// \brief Provides the definitions of functions that have no body in the
+/// translation unit being analyzed.
+class CrossTUDefinitionSource {
+public:
+  virtual ~CrossTUDefinitionSource();
+
+  /// \brief Returns a definition of \p FD, imported into the ASTContext being
+  /// analyzed, or null if no other translation unit defines it.
+  virtual const FunctionDecl *getDefinition(const FunctionDecl *FD) = 0;
+};
+
+} // end namespace ento
+} // end namespace clang
+
+#endif
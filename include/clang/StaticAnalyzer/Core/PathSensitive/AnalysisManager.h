@@ -20,6 +20,8 @@
 #include "clang/StaticAnalyzer/Core/BugReporter/BugReporter.h"
 #include "clang/StaticAnalyzer/Core/BugReporter/PathDiagnostic.h"
 #include "clang/StaticAnalyzer/Core/PathDiagnosticConsumers.h"
+#include "llvm/ADT/StringSet.h"
+#include <memory>
 
 namespace clang {
 
@@ -27,6 +29,7 @@ class CodeInjector;
 
 namespace ento {
   class CheckerManager;
+  class CrossTUDefinitionSource;
 
 class AnalysisManager : public BugReporterData {
   virtual void anchor();
@@ -43,6 +46,19 @@ class AnalysisManager : public BugReporterData {
 
   CheckerManager *CheckerMgr;
 
+  /// Where to find the definitions of functions defined in other translation
+  /// units, if cross translation unit analysis is enabled.
+  CrossTUDefinitionSource *CrossTU;
+
+  /// The issue hashes of the reports in the report-baseline file.
+  llvm::StringSet<> ReportBaseline;
+
+  /// Times the generation of the path diagnostics, with -analyzer-stats.
+  std::unique_ptr<llvm::Timer> ReportTimer;
+
+  /// Times the construction of the CFGs, with -analyzer-stats.
+  std::unique_ptr<llvm::Timer> CFGTimer;
+
 public:
   AnalyzerOptions &options;
   
@@ -53,7 +69,8 @@ public:
                   ConstraintManagerCreator constraintmgr, 
                   CheckerManager *checkerMgr,
                   AnalyzerOptions &Options,
-                  CodeInjector* injector = nullptr);
+                  CodeInjector* injector = nullptr,
+                  CrossTUDefinitionSource *CrossTU = nullptr);
 
   ~AnalysisManager() override;
 
@@ -73,12 +90,24 @@ public:
     return options;
   }
 
+  bool isInReportBaseline(StringRef IssueHash) override {
+    return ReportBaseline.count(IssueHash);
+  }
+
+  llvm::Timer *getReportTimer() override {
+    return ReportTimer.get();
+  }
+
   ConstraintManagerCreator getConstraintManagerCreator() {
     return CreateConstraintMgr;
   }
 
   CheckerManager *getCheckerManager() const { return CheckerMgr; }
 
+  CrossTUDefinitionSource *getCrossTUDefinitionSource() const {
+    return CrossTU;
+  }
+
   ASTContext &getASTContext() override {
     return Ctx;
   }
@@ -74,6 +74,19 @@ class BasicValueFactory {
   llvm::FoldingSet<CompoundValData>  CompoundValDataSet;
   llvm::FoldingSet<LazyCompoundValData> LazyCompoundValDataSet;
 
+  /// The range of small values, such as 0, 1 and -1, that are looked up in a
+  /// table rather than profiled and looked up in APSIntSet.
+  enum { SmallValueMin = -128, NumSmallValues = 384 };
+
+  /// The interned small values of each bit width up to 64 and signedness,
+  /// indexed by (BitWidth - 1) * 2 + IsUnsigned and then by the value minus
+  /// SmallValueMin. The tables are allocated on first use.
+  const llvm::APSInt **SmallValues[128];
+
+  /// Returns the slot of the small value table that holds X, or null if X
+  /// is not a small value.
+  const llvm::APSInt **getSmallValueSlot(const llvm::APSInt &X);
+
   // This is private because external clients should use the factory
   // method that takes a QualType.
   const llvm::APSInt& getValue(uint64_t X, unsigned BitWidth, bool isUnsigned);
@@ -81,7 +94,7 @@ class BasicValueFactory {
 public:
   BasicValueFactory(ASTContext &ctx, llvm::BumpPtrAllocator &Alloc)
     : Ctx(ctx), BPAlloc(Alloc), PersistentSVals(nullptr),
-      PersistentSValPairs(nullptr), SValListFactory(Alloc) {}
+      PersistentSValPairs(nullptr), SValListFactory(Alloc), SmallValues() {}
 
   ~BasicValueFactory();
 
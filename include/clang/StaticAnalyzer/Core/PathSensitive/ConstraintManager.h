@@ -25,6 +25,7 @@ class APSInt;
 namespace clang {
 namespace ento {
 
+class ExplodedNode;
 class SubEngine;
 
 class ConditionTruthVal {
@@ -138,6 +139,24 @@ public:
     return nullptr;
   }
 
+  /// \brief Retrieve an opaque value that is the same for two states if and
+  /// only if they hold the same constraints, or null if the constraint
+  /// manager cannot provide one.
+  ///
+  /// The results of getSymVal() depend on nothing else in the state, which
+  /// lets SValBuilder reuse the simplifications it made in another state.
+  virtual const void *getConstraintFingerprint(ProgramStateRef State) const {
+    return nullptr;
+  }
+
+  /// \brief Check with a solver more precise than this constraint manager
+  /// whether the path that ends in \p N can actually be taken.
+  ///
+  /// This is called once per bug report rather than at every branch, so it
+  /// may be expensive. \returns false only if the constraints collected
+  /// along the path are proven unsatisfiable.
+  virtual bool isFeasiblePath(const ExplodedNode *N) { return true; }
+
   virtual ProgramStateRef removeDeadBindings(ProgramStateRef state,
                                                  SymbolReaper& SymReaper) = 0;
 
@@ -181,6 +200,10 @@ std::unique_ptr<ConstraintManager>
 CreateRangeConstraintManager(ProgramStateManager &statemgr,
                              SubEngine *subengine);
 
+std::unique_ptr<ConstraintManager>
+CreateZ3ConstraintManager(ProgramStateManager &statemgr,
+                          SubEngine *subengine);
+
 } // end GR namespace
 
 } // end clang namespace
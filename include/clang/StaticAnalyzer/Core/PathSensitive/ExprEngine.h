@@ -96,6 +96,14 @@ private:
   /// The flag, which specifies the mode of inlining for the engine.
   InliningModes HowToInline;
 
+  /// The number of times a path was cut short because it visited a block too
+  /// many times.
+  unsigned NumBlockCountExceeded;
+
+  /// The number of calls that weren't inlined because the callee had already
+  /// been inlined too many times.
+  unsigned NumInlineCountExceeded;
+
 public:
   ExprEngine(AnalysisManager &mgr, bool gcEnabled,
              SetOfConstDecls *VisitedCalleesIn,
@@ -324,6 +332,9 @@ public:
   bool hasEmptyWorkList() const { return !Engine.getWorkList()->hasWork(); }
   bool hasWorkRemaining() const { return Engine.hasWorkRemaining(); }
 
+  unsigned getNumBlockCountExceeded() const { return NumBlockCountExceeded; }
+  unsigned getNumInlineCountExceeded() const { return NumInlineCountExceeded; }
+
   const CoreEngine &getCoreEngine() const { return Engine; }
 
 public:
@@ -0,0 +1,44 @@
+//===--- LoopSummary.h - Summarize counted loops ----------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This header contains the declarations of functions which are used to
+/// summarize the remaining iterations of counted loops.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_STATICANALYZER_CORE_PATHSENSITIVE_LOOPSUMMARY_H
+#define LLVM_CLANG_STATICANALYZER_CORE_PATHSENSITIVE_LOOPSUMMARY_H
+
+#include "clang/Analysis/ProgramPoint.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/ProgramState.h"
+
+namespace clang {
+namespace ento {
+
+/// \brief Get the state in which a counted loop has run all of its remaining
+/// iterations, or null if the loop is not summarized.
+///
+/// \p Edge must lead to the condition block of a loop. Only the back edge of
+/// a 'for' loop whose counter steps by one towards a bound that the body does
+/// not change, and whose body makes no calls and does not leave the loop, is
+/// summarized. The counter is set to its value on exit, and every variable the
+/// body writes is invalidated; the condition then fails on its own.
+///
+/// \param [out] SkippedIterations The number of iterations the summary stands
+/// for, or 0 if it is not known.
+ProgramStateRef getSummarizedLoopState(ProgramStateRef State,
+                                       const LocationContext *LCtx,
+                                       unsigned BlockCount,
+                                       const BlockEdge &Edge,
+                                       uint64_t &SkippedIterations);
+
+} // end namespace ento
+} // end namespace clang
+
+#endif
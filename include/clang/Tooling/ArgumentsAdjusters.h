@@ -57,6 +57,11 @@ ArgumentsAdjuster getInsertArgumentAdjuster(
     const char *Extra,
     ArgumentInsertPosition Pos = ArgumentInsertPosition::END);
 
+/// \brief Gets an argument adjuster which replaces the first \c -include of
+/// \p Header with \c -include-pch \p PCHFile, a precompiled header built from
+/// it.
+ArgumentsAdjuster getIncludePCHAdjuster(StringRef Header, StringRef PCHFile);
+
 /// \brief Gets an argument adjuster which adjusts the arguments in sequence
 /// with the \p First adjuster and then with the \p Second one.
 ArgumentsAdjuster combineAdjusters(ArgumentsAdjuster First,
@@ -102,11 +102,16 @@ public:
     return SourcePathList;
   }
 
+  /// Returns the number of compile commands to process concurrently, as
+  /// requested with -j. Suitable for passing to ClangTool::runParallel.
+  unsigned getJobs() const { return Jobs; }
+
   static const char *const HelpMessage;
 
 private:
   std::unique_ptr<CompilationDatabase> Compilations;
   std::vector<std::string> SourcePathList;
+  unsigned Jobs;
   std::vector<std::string> ExtraArgsBefore;
   std::vector<std::string> ExtraArgsAfter;
 };
@@ -0,0 +1,109 @@
+//===--- FingerprintDatabase.h - Skip unchanged compile commands -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the FingerprintDatabase class, which lets ClangTool skip
+// the compile commands that were processed successfully by an earlier run and
+// whose inputs did not change since.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLING_FINGERPRINTDATABASE_H
+#define LLVM_CLANG_TOOLING_FINGERPRINTDATABASE_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Basic/VirtualFileSystem.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace tooling {
+
+/// \brief Remembers the compile commands a tool processed successfully, so
+/// that later runs of the same tool can skip those whose inputs are unchanged.
+///
+/// The fingerprint of a compile command is a hash of the tool name, the
+/// working directory, the command line, and the contents of every file the
+/// compiler read while processing it. A compile command is up to date if its
+/// last successful run recorded the same fingerprint that the files it read
+/// back then have now.
+///
+/// Only files that were read are tracked; a header that is added to the
+/// include path in front of the one that was found is not noticed.
+class FingerprintDatabase {
+public:
+  /// \param ToolName Identifies the action and the options the tool runs it
+  /// with. Runs with a different name never match each other's entries.
+  explicit FingerprintDatabase(StringRef ToolName) : ToolName(ToolName) {}
+
+  /// \brief Load the database from \p Path. A missing file is an empty
+  /// database.
+  ///
+  /// \returns false, with \p ErrorMessage set, if the file could not be read.
+  bool load(StringRef Path, std::string &ErrorMessage);
+
+  /// \brief Save the database to \p Path.
+  ///
+  /// \returns false, with \p ErrorMessage set, if the file could not be
+  /// written.
+  bool save(StringRef Path, std::string &ErrorMessage) const;
+
+  /// \brief Determine whether \p CommandLine, run in \p Directory, was
+  /// processed successfully and none of the files it read changed since.
+  ///
+  /// \param FS The file system to read the files from.
+  bool isUpToDate(StringRef Directory, ArrayRef<std::string> CommandLine,
+                  vfs::FileSystem &FS);
+
+  /// \brief Record that \p CommandLine, run in \p Directory, was processed
+  /// successfully after reading \p Files, which must be absolute paths.
+  void recordSuccess(StringRef Directory, ArrayRef<std::string> CommandLine,
+                     ArrayRef<std::string> Files, vfs::FileSystem &FS);
+
+  /// \brief Record that processing \p CommandLine, run in \p Directory,
+  /// failed, so that the next run processes it again.
+  void recordFailure(StringRef Directory, ArrayRef<std::string> CommandLine);
+
+private:
+  struct Entry {
+    std::string Fingerprint;
+    std::vector<std::string> Files;
+  };
+
+  /// \brief The hash of a file's contents, along with the status it was
+  /// computed for.
+  struct FileHash {
+    llvm::sys::fs::UniqueID UniqueID;
+    llvm::sys::TimeValue ModificationTime;
+    uint64_t Size;
+    std::string Hash;
+  };
+
+  std::string getKey(StringRef Directory,
+                     ArrayRef<std::string> CommandLine) const;
+  std::string getFingerprint(StringRef Key, ArrayRef<std::string> Files,
+                             vfs::FileSystem &FS);
+  StringRef getFileHash(StringRef File, vfs::FileSystem &FS);
+
+  std::string ToolName;
+
+  /// \brief The entries, keyed by the hash of the tool name, the directory
+  /// and the command line.
+  llvm::StringMap<Entry> Entries;
+
+  /// \brief The hashes of the files read so far, which are shared by the
+  /// many compile commands that include the same headers.
+  llvm::StringMap<FileHash> FileHashes;
+};
+
+} // end namespace tooling
+} // end namespace clang
+
+#endif
@@ -59,6 +59,13 @@ class JSONCompilationDatabase : public CompilationDatabase {
 public:
   /// \brief Loads a JSON compilation database from the specified file.
   ///
+  /// The file paths and byte ranges of the compile commands are cached in an
+  /// index next to the database, named after it with an ".index" suffix.
+  /// While the index matches the modification time and size of the database,
+  /// loading only reads the index, and the compile commands are parsed when
+  /// they are requested. Otherwise the database is parsed and the index is
+  /// rewritten, if its directory is writable.
+  ///
   /// Returns NULL and sets ErrorMessage if the database could not be
   /// loaded from the given file.
   static std::unique_ptr<JSONCompilationDatabase>
@@ -90,7 +97,8 @@ public:
 private:
   /// \brief Constructs a JSON compilation database on a memory buffer.
   JSONCompilationDatabase(std::unique_ptr<llvm::MemoryBuffer> Database)
-      : Database(std::move(Database)),
+      : LoadedFromIndex(false), MatchTrieBuilt(false),
+        Database(std::move(Database)),
         YAMLStream(this->Database->getBuffer(), SM) {}
 
   /// \brief Parses the database file and creates the index.
@@ -99,6 +107,21 @@ private:
   /// failed.
   bool parse(std::string &ErrorMessage);
 
+  /// \brief Creates the index from the contents of an index file written by
+  /// writeIndex().
+  ///
+  /// Returns false if the index file is malformed or was written for another
+  /// version of the database.
+  bool readIndex(StringRef IndexContents, uint64_t ModificationTime,
+                 uint64_t Size);
+
+  /// \brief Writes the index to \p IndexPath, for a database with the given
+  /// modification time and size.
+  ///
+  /// Returns whether the index could be written.
+  bool writeIndex(StringRef IndexPath, uint64_t ModificationTime,
+                  uint64_t Size) const;
+
   // Tuple (directory, filename, commandline) where 'commandline' points to the
   // corresponding scalar nodes in the YAML stream.
   // If the command line contains a single argument, it is a shell-escaped
@@ -109,18 +132,41 @@ private:
                      llvm::yaml::ScalarNode *,
                     std::vector<llvm::yaml::ScalarNode *>> CompileCommandRef;
 
-  /// \brief Converts the given array of CompileCommandRefs to CompileCommands.
-  void getCommands(ArrayRef<CompileCommandRef> CommandsRef,
+  /// \brief Reads the compile command of a JSON object.
+  ///
+  /// Returns whether the object is a valid compile command. Sets ErrorMessage
+  /// if it is not. If \p FirstKeyStart is not null, sets it to the start of
+  /// the first key of the object in the buffer.
+  static bool parseCompileCommand(llvm::yaml::MappingNode *Object,
+                                  CompileCommandRef &Command,
+                                  std::string &ErrorMessage,
+                                  const char **FirstKeyStart = nullptr);
+
+  /// \brief Converts the compile commands with the given indices to
+  /// CompileCommands.
+  void getCommands(ArrayRef<unsigned> CommandIndices,
                    std::vector<CompileCommand> &Commands) const;
 
-  // Maps file paths to the compile command lines for that file.
-  llvm::StringMap<std::vector<CompileCommandRef>> IndexByFile;
+  /// \brief Builds the trie used to match file paths, on first use.
+  const FileMatchTrie &getMatchTrie() const;
+
+  // Maps file paths to the indices of the compile commands for that file.
+  llvm::StringMap<std::vector<unsigned>> IndexByFile;
 
   /// All the compile commands in the order that they were provided in the
-  /// JSON stream.
+  /// JSON stream. Empty if the database was loaded from an index.
   std::vector<CompileCommandRef> AllCommands;
 
-  FileMatchTrie MatchTrie;
+  /// The offsets and lengths in the database of the JSON objects of all the
+  /// compile commands, in the order that they were provided. Empty if the
+  /// objects could not be delimited.
+  std::vector<std::pair<uint64_t, uint64_t>> CommandRanges;
+
+  /// Whether the compile commands are parsed from CommandRanges on demand.
+  bool LoadedFromIndex;
+
+  mutable FileMatchTrie MatchTrie;
+  mutable bool MatchTrieBuilt;
 
   std::unique_ptr<llvm::MemoryBuffer> Database;
   llvm::SourceMgr SM;
@@ -59,6 +59,8 @@ class FrontendAction;
 
 namespace tooling {
 
+class FingerprintDatabase;
+
 /// \brief Interface to process a clang::CompilerInvocation.
 ///
 /// If your tool is based on FrontendAction, you should be deriving from
@@ -244,6 +246,26 @@ public:
     this->DiagConsumer = DiagConsumer;
   }
 
+  /// \brief Set a \c FingerprintDatabase that lets run() skip the compile
+  /// commands that were processed successfully before and whose inputs did
+  /// not change since. Pass null to process all compile commands.
+  ///
+  /// run() updates \p Fingerprints with the outcome of every compile command
+  /// it processes; saving it for the next run is up to the caller.
+  void setFingerprintDatabase(FingerprintDatabase *Fingerprints) {
+    this->Fingerprints = Fingerprints;
+  }
+
+  /// \brief Let run() share precompiled headers between compile commands.
+  ///
+  /// If several compile commands only differ in their main file and pull in
+  /// the same header first with \c -include, the header is precompiled once
+  /// by this tool and the compile commands use it with \c -include-pch
+  /// instead. The precompiled headers are deleted at the end of the run.
+  void setUseSharedPCH(bool UseSharedPCH) {
+    this->UseSharedPCH = UseSharedPCH;
+  }
+
   /// \brief Map a virtual file to be used while running the tool.
   ///
   /// \param FilePath The path at which the content will be mapped.
@@ -274,6 +296,66 @@ public:
   DiagnosticConsumer *DiagConsumer;
 };
 
+/// \brief A list of ASTs saved to AST files, of which at most a fixed number
+/// are loaded at the same time.
+///
+/// getAST() loads an AST from its file when it is not resident, and unloads
+/// the least recently used AST when there are more than the maximum number of
+/// resident ASTs. The AST files are removed when the list is destroyed.
+///
+/// The AST files reference the source files they were built from, which must
+/// still exist on disk when the ASTs are loaded.
+class SpilledASTs {
+public:
+  /// \param MaxResidentASTs The maximum number of ASTs kept in memory; at
+  ///        least one AST always is.
+  /// \param PCHContainerOps The PCHContainerOperations for loading the AST
+  ///        files.
+  explicit SpilledASTs(unsigned MaxResidentASTs,
+                       std::shared_ptr<PCHContainerOperations> PCHContainerOps =
+                           std::make_shared<PCHContainerOperations>());
+
+  ~SpilledASTs();
+
+  SpilledASTs(const SpilledASTs &) = delete;
+  SpilledASTs &operator=(const SpilledASTs &) = delete;
+
+  /// \brief Adds an AST file, which is removed when the list is destroyed.
+  ///
+  /// \param MainFileName The main source file of the AST.
+  /// \param ASTFileName The file the AST was saved to with ASTUnit::Save().
+  void addASTFile(StringRef MainFileName, StringRef ASTFileName);
+
+  /// \brief Returns the number of ASTs in the list.
+  size_t size() const { return Entries.size(); }
+
+  /// \brief Returns the main source file of the AST at \p Index.
+  StringRef getMainFileName(size_t Index) const {
+    return Entries[Index].MainFileName;
+  }
+
+  /// \brief Returns the AST at \p Index, loading it if it is not resident.
+  ///
+  /// The AST stays valid while the returned pointer is held, even once the
+  /// list unloads it.
+  ///
+  /// \returns The AST, or null if its AST file failed to load.
+  std::shared_ptr<ASTUnit> getAST(size_t Index);
+
+private:
+  struct Entry {
+    std::string MainFileName;
+    std::string ASTFileName;
+    std::shared_ptr<ASTUnit> AST;
+  };
+
+  std::vector<Entry> Entries;
+  /// \brief The indices of the resident ASTs, most recently used first.
+  std::vector<size_t> ResidentEntries;
+  unsigned MaxResidentASTs;
+  std::shared_ptr<PCHContainerOperations> PCHContainerOps;
+};
+
 /// \brief Utility to run a FrontendAction over a set of files.
 ///
 /// This class is written to be usable for command line utilities.
@@ -323,13 +405,49 @@ class ClangTool {
   /// \param Action Tool action.
   int run(ToolAction *Action);
 
+  /// \brief Runs an action over all files specified in the command line,
+  /// processing up to \p Jobs compile commands concurrently.
+  ///
+  /// Every worker thread owns its own FileManager and virtual file system
+  /// overlay, and resolves relative paths against the directory of the compile
+  /// command instead of changing the process' working directory. Diagnostics
+  /// are buffered per compile command and printed in the order in which
+  /// run() would have produced them once all files have been processed.
+  ///
+  /// \p Action is invoked from several threads at once; any state it shares
+  /// between translation units, such as RefactoringTool's replacements, must
+  /// be protected by the caller.
+  ///
+  /// Falls back to run() if \p Jobs is less than 2 or a diagnostic consumer
+  /// has been set, as DiagnosticConsumer implementations are not thread-safe,
+  /// or if a fingerprint database or shared precompiled headers are used.
+  ///
+  /// \param Action Tool action.
+  /// \param Jobs The maximum number of compile commands to run concurrently.
+  int runParallel(ToolAction *Action, unsigned Jobs);
+
   /// \brief Create an AST for each file specified in the command line and
   /// append them to ASTs.
   int buildASTs(std::vector<std::unique_ptr<ASTUnit>> &ASTs);
 
+  /// \brief Create an AST for each file specified in the command line, save
+  /// each of them to a temporary AST file and add those to \p ASTs.
+  ///
+  /// Only one AST per worker thread is in memory at any time while building,
+  /// so this allows tools to process more translation units than fit in
+  /// memory at once; \p ASTs reloads them on demand. The ASTs are added in
+  /// the order of their main file names.
+  ///
+  /// \param ASTs The set to add the saved ASTs to.
+  /// \param Jobs The maximum number of ASTs to build concurrently; see
+  ///        runParallel().
+  int buildSpilledASTs(SpilledASTs &ASTs, unsigned Jobs = 1);
+
   /// \brief Returns the file manager used in the tool.
   ///
-  /// The file manager is shared between all translation units.
+  /// The file manager is shared between all translation units processed by
+  /// run(), unless a fingerprint database has been set; runParallel() uses a
+  /// separate file manager per worker thread.
   FileManager &getFiles() { return *Files; }
 
  private:
@@ -347,6 +465,8 @@ class ClangTool {
   ArgumentsAdjuster ArgsAdjuster;
 
   DiagnosticConsumer *DiagConsumer;
+  FingerprintDatabase *Fingerprints;
+  bool UseSharedPCH;
 };
 
 template <typename T>
@@ -235,11 +235,17 @@ static void emitPremigrationErrors(const CapturedDiagList &arcDiags,
 // checkForManualIssues.
 //===----------------------------------------------------------------------===//
 
-bool arcmt::checkForManualIssues(
+/// \brief Check for the issues that need to be fixed by hand.
+///
+/// If the check passes and \p ParsedUnit is non-null, the parsed translation
+/// unit is handed out together with the ARC diagnostics captured while parsing
+/// it, so that the first transformation does not need to parse it again.
+static bool checkForManualIssuesImpl(
     CompilerInvocation &origCI, const FrontendInputFile &Input,
     std::shared_ptr<PCHContainerOperations> PCHContainerOps,
     DiagnosticConsumer *DiagClient, bool emitPremigrationARCErrors,
-    StringRef plistOut) {
+    StringRef plistOut, std::unique_ptr<ASTUnit> *ParsedUnit,
+    CapturedDiagList *ParsedDiags) {
   if (!origCI.getLangOpts()->ObjC1)
     return false;
 
@@ -321,6 +327,11 @@ bool arcmt::checkForManualIssues(
     Diags->setSeverity(diag::warn_arcmt_nsalloc_realloc, diag::Severity::Error,
                        SourceLocation());
 
+  // The transformations clear the diagnostics they take care of; keep the
+  // ones from parsing for the transformation that reuses the unit.
+  if (ParsedDiags)
+    *ParsedDiags = capturedDiags;
+
   for (unsigned i=0, e = transforms.size(); i != e; ++i)
     transforms[i](pass);
 
@@ -329,13 +340,52 @@ bool arcmt::checkForManualIssues(
   DiagClient->EndSourceFile();
   errRec.FinishCapture();
 
-  return capturedDiags.hasErrors() || testAct.hasReportedErrors();
+  if (capturedDiags.hasErrors() || testAct.hasReportedErrors())
+    return true;
+
+  if (ParsedUnit) {
+    // Report the diagnostics of the transformation only, as if the unit had
+    // been parsed for it.
+    Diags->setSeverity(diag::warn_arcmt_nsalloc_realloc,
+                       diag::Severity::Warning, SourceLocation());
+    Diags->setIgnoreAllWarnings(true);
+    *ParsedUnit = std::move(Unit);
+  }
+  return false;
+}
+
+bool arcmt::checkForManualIssues(
+    CompilerInvocation &origCI, const FrontendInputFile &Input,
+    std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+    DiagnosticConsumer *DiagClient, bool emitPremigrationARCErrors,
+    StringRef plistOut) {
+  return checkForManualIssuesImpl(origCI, Input, std::move(PCHContainerOps),
+                                  DiagClient, emitPremigrationARCErrors,
+                                  plistOut, /*ParsedUnit=*/nullptr,
+                                  /*ParsedDiags=*/nullptr);
 }
 
 //===----------------------------------------------------------------------===//
 // applyTransformations.
 //===----------------------------------------------------------------------===//
 
+/// \brief Run a transformation on a parsed translation unit and remap the
+/// files it rewrote.
+///
+/// \param errRec If non-null, the capture of the diagnostics from parsing,
+/// which is finished once the transformation has run.
+/// \param ARCMTMacroLocs The locations where expressions removed by earlier
+/// transformations used to be, or null if there were none.
+static bool
+applyTransformToUnit(TransformFn trans, ASTUnit &Unit,
+                     CapturedDiagList &capturedDiags,
+                     LangOptions::GCMode OrigGCMode,
+                     DiagnosticConsumer *DiagClient,
+                     MigrationProcess::RewriteListener *listener,
+                     FileRemapper &Remapper,
+                     CaptureDiagnosticConsumer *errRec = nullptr,
+                     std::vector<SourceLocation> *ARCMTMacroLocs = nullptr);
+
 static bool
 applyTransforms(CompilerInvocation &origCI, const FrontendInputFile &Input,
                 std::shared_ptr<PCHContainerOperations> PCHContainerOps,
@@ -348,9 +398,11 @@ applyTransforms(CompilerInvocation &origCI, const FrontendInputFile &Input,
 
   // Make sure checking is successful first.
   CompilerInvocation CInvokForCheck(origCI);
-  if (arcmt::checkForManualIssues(CInvokForCheck, Input, PCHContainerOps,
-                                  DiagClient, emitPremigrationARCErrors,
-                                  plistOut))
+  std::unique_ptr<ASTUnit> CheckedUnit;
+  CapturedDiagList CheckedDiags;
+  if (checkForManualIssuesImpl(CInvokForCheck, Input, PCHContainerOps,
+                               DiagClient, emitPremigrationARCErrors, plistOut,
+                               &CheckedUnit, &CheckedDiags))
     return true;
 
   CompilerInvocation CInvok(origCI);
@@ -364,7 +416,21 @@ applyTransforms(CompilerInvocation &origCI, const FrontendInputFile &Input,
                                                                      NoFinalizeRemoval);
   assert(!transforms.empty());
 
-  for (unsigned i=0, e = transforms.size(); i != e; ++i) {
+  unsigned FirstToParse = 0;
+  // Unless files were remapped by an earlier migration, the first
+  // transformation sees the same sources as the check, so run it on the
+  // unit the check parsed.
+  if (CheckedUnit && migration.getRemapper().empty()) {
+    migration.HadARCErrors = CheckedDiags.hasErrors();
+    if (applyTransformToUnit(transforms[0], *CheckedUnit, CheckedDiags,
+                             OrigGCMode, DiagClient, /*listener=*/nullptr,
+                             migration.getRemapper()))
+      return true;
+    FirstToParse = 1;
+  }
+  CheckedUnit.reset();
+
+  for (unsigned i = FirstToParse, e = transforms.size(); i != e; ++i) {
     bool err = migration.applyTransform(transforms[i]);
     if (err) return true;
   }
@@ -505,6 +571,67 @@ public:
 /// \brief Anchor for VTable.
 MigrationProcess::RewriteListener::~RewriteListener() { }
 
+static bool
+applyTransformToUnit(TransformFn trans, ASTUnit &Unit,
+                     CapturedDiagList &capturedDiags,
+                     LangOptions::GCMode OrigGCMode,
+                     DiagnosticConsumer *DiagClient,
+                     MigrationProcess::RewriteListener *listener,
+                     FileRemapper &Remapper,
+                     CaptureDiagnosticConsumer *errRec,
+                     std::vector<SourceLocation> *ARCMTMacroLocs) {
+  ASTContext &Ctx = Unit.getASTContext();
+
+  // After parsing of source files ended, we want to reuse the
+  // diagnostics objects to emit further diagnostics.
+  // We call BeginSourceFile because DiagnosticConsumer requires that 
+  // diagnostics with source range information are emitted only in between
+  // BeginSourceFile() and EndSourceFile().
+  DiagClient->BeginSourceFile(Ctx.getLangOpts(), &Unit.getPreprocessor());
+
+  std::vector<SourceLocation> NoMacroLocs;
+  Rewriter rewriter(Ctx.getSourceManager(), Ctx.getLangOpts());
+  TransformActions TA(Unit.getDiagnostics(), capturedDiags, Ctx,
+                      Unit.getPreprocessor());
+  MigrationPass pass(Ctx, OrigGCMode, Unit.getSema(), TA, capturedDiags,
+                     ARCMTMacroLocs ? *ARCMTMacroLocs : NoMacroLocs);
+
+  trans(pass);
+
+  {
+    RewritesApplicator applicator(rewriter, Ctx, listener);
+    TA.applyRewrites(applicator);
+  }
+
+  DiagClient->EndSourceFile();
+  if (errRec)
+    errRec->FinishCapture();
+
+  if (DiagClient->getNumErrors())
+    return true;
+
+  for (Rewriter::buffer_iterator
+        I = rewriter.buffer_begin(), E = rewriter.buffer_end(); I != E; ++I) {
+    FileID FID = I->first;
+    RewriteBuffer &buf = I->second;
+    const FileEntry *file = Ctx.getSourceManager().getFileEntryForID(FID);
+    assert(file);
+    std::string newFname = file->getName();
+    newFname += "-trans";
+    SmallString<512> newText;
+    llvm::raw_svector_ostream vecOS(newText);
+    buf.write(vecOS);
+    std::unique_ptr<llvm::MemoryBuffer> memBuf(
+        llvm::MemoryBuffer::getMemBufferCopy(
+            StringRef(newText.data(), newText.size()), newFname));
+    SmallString<64> filePath(file->getName());
+    Unit.getFileManager().FixupRelativePath(filePath);
+    Remapper.remap(filePath.str(), std::move(memBuf));
+  }
+
+  return false;
+}
+
 MigrationProcess::MigrationProcess(
     const CompilerInvocation &CI,
     std::shared_ptr<PCHContainerOperations> PCHContainerOps,
@@ -569,49 +696,7 @@ bool MigrationProcess::applyTransform(TransformFn trans,
     return true;
   }
 
-  // After parsing of source files ended, we want to reuse the
-  // diagnostics objects to emit further diagnostics.
-  // We call BeginSourceFile because DiagnosticConsumer requires that 
-  // diagnostics with source range information are emitted only in between
-  // BeginSourceFile() and EndSourceFile().
-  DiagClient->BeginSourceFile(Ctx.getLangOpts(), &Unit->getPreprocessor());
-
-  Rewriter rewriter(Ctx.getSourceManager(), Ctx.getLangOpts());
-  TransformActions TA(*Diags, capturedDiags, Ctx, Unit->getPreprocessor());
-  MigrationPass pass(Ctx, OrigCI.getLangOpts()->getGC(),
-                     Unit->getSema(), TA, capturedDiags, ARCMTMacroLocs);
-
-  trans(pass);
-
-  {
-    RewritesApplicator applicator(rewriter, Ctx, listener);
-    TA.applyRewrites(applicator);
-  }
-
-  DiagClient->EndSourceFile();
-  errRec.FinishCapture();
-
-  if (DiagClient->getNumErrors())
-    return true;
-
-  for (Rewriter::buffer_iterator
-        I = rewriter.buffer_begin(), E = rewriter.buffer_end(); I != E; ++I) {
-    FileID FID = I->first;
-    RewriteBuffer &buf = I->second;
-    const FileEntry *file = Ctx.getSourceManager().getFileEntryForID(FID);
-    assert(file);
-    std::string newFname = file->getName();
-    newFname += "-trans";
-    SmallString<512> newText;
-    llvm::raw_svector_ostream vecOS(newText);
-    buf.write(vecOS);
-    std::unique_ptr<llvm::MemoryBuffer> memBuf(
-        llvm::MemoryBuffer::getMemBufferCopy(
-            StringRef(newText.data(), newText.size()), newFname));
-    SmallString<64> filePath(file->getName());
-    Unit->getFileManager().FixupRelativePath(filePath);
-    Remapper.remap(filePath.str(), std::move(memBuf));
-  }
-
-  return false;
+  return applyTransformToUnit(trans, *Unit, capturedDiags,
+                              OrigCI.getLangOpts()->getGC(), DiagClient,
+                              listener, Remapper, &errRec, &ARCMTMacroLocs);
 }
@@ -105,10 +105,33 @@ struct APValue::MemberPointerData : MemberPointerBase {
 
 // FIXME: Reduce the malloc traffic here.
 
+APValue::Arr::Shared *APValue::Arr::allocate(unsigned N) {
+  static_assert(llvm::AlignOf<APValue>::Alignment <=
+                    llvm::AlignOf<Shared>::Alignment,
+                "array elements would be misaligned");
+  Shared *S = new (::operator new(sizeof(Shared) + N * sizeof(APValue)))
+      Shared;
+  S->RefCount = 1;
+  APValue *Elts = S->getElts();
+  for (unsigned I = 0; I != N; ++I)
+    new (Elts + I) APValue();
+  return S;
+}
 APValue::Arr::Arr(unsigned NumElts, unsigned Size) :
-  Elts(new APValue[NumElts + (NumElts != Size ? 1 : 0)]),
+  Elts(allocate(NumElts + (NumElts != Size ? 1 : 0))),
   NumElts(NumElts), ArrSize(Size) {}
-APValue::Arr::~Arr() { delete [] Elts; }
+APValue::Arr::Arr(const Arr &RHS) :
+  Elts(RHS.Elts), NumElts(RHS.NumElts), ArrSize(RHS.ArrSize) {
+  ++Elts->RefCount;
+}
+APValue::Arr::~Arr() {
+  if (--Elts->RefCount)
+    return;
+  APValue *E = Elts->getElts();
+  for (unsigned I = 0, N = getNumAllocated(); I != N; ++I)
+    E[I].~APValue();
+  ::operator delete(Elts);
+}
 
 APValue::StructData::StructData(unsigned NumBases, unsigned NumFields) :
   Elts(new APValue[NumBases+NumFields]),
@@ -157,11 +180,10 @@ APValue::APValue(const APValue &RHS) : Kind(Uninitialized) {
                 RHS.getLValueCallIndex());
     break;
   case Array:
-    MakeArray(RHS.getArrayInitializedElts(), RHS.getArraySize());
-    for (unsigned I = 0, N = RHS.getArrayInitializedElts(); I != N; ++I)
-      getArrayInitializedElt(I) = RHS.getArrayInitializedElt(I);
-    if (RHS.hasArrayFiller())
-      getArrayFiller() = RHS.getArrayFiller();
+    // Share the elements until one of the arrays is modified.
+    new ((void*)(char*)Data.buffer)
+        Arr(*(const Arr*)(const char*)RHS.Data.buffer);
+    Kind = Array;
     break;
   case Struct:
     MakeStruct(RHS.getStructNumBases(), RHS.getStructNumFields());
@@ -639,6 +661,19 @@ void APValue::MakeArray(unsigned InitElts, unsigned Size) {
   Kind = Array;
 }
 
+void APValue::unshareArray() {
+  Arr *A = (Arr*)(char*)Data.buffer;
+  assert(A->Elts->RefCount > 1 && "array elements are not shared");
+  unsigned N = A->getNumAllocated();
+  Arr::Shared *Copy = Arr::allocate(N);
+  const APValue *From = A->Elts->getElts();
+  APValue *To = Copy->getElts();
+  for (unsigned I = 0; I != N; ++I)
+    To[I] = From[I];
+  --A->Elts->RefCount;
+  A->Elts = Copy;
+}
+
 void APValue::MakeMemberPointer(const ValueDecl *Member, bool IsDerivedMember,
                                 ArrayRef<const CXXRecordDecl*> Path) {
   assert(isUninit() && "Bad state change");
@@ -15,6 +15,7 @@
 #include "CXXABI.h"
 #include "clang/AST/ASTMutationListener.h"
 #include "clang/AST/Attr.h"
+#include "clang/AST/CXXInheritance.h"
 #include "clang/AST/CharUnits.h"
 #include "clang/AST/Comment.h"
 #include "clang/AST/CommentCommandTraits.h"
@@ -56,6 +57,10 @@ unsigned ASTContext::NumImplicitMoveAssignmentOperators;
 unsigned ASTContext::NumImplicitMoveAssignmentOperatorsDeclared;
 unsigned ASTContext::NumImplicitDestructors;
 unsigned ASTContext::NumImplicitDestructorsDeclared;
+unsigned ASTContext::NumMemoizableConstexprCalls;
+unsigned ASTContext::NumMemoizedConstexprCallsReused;
+unsigned ASTContext::NumRecordLayouts;
+unsigned ASTContext::NumRecordLayoutsWithoutEmptySubobjects;
 
 enum FloatingRank {
   HalfRank, FloatRank, DoubleRank, LongDoubleRank, Float128Rank
@@ -744,6 +749,7 @@ ASTContext::ASTContext(LangOptions &LOpts, SourceManager &SM,
       ExternCContext(nullptr), MakeIntegerSeqDecl(nullptr),
       TypePackElementDecl(nullptr), SourceMgr(SM), LangOpts(LOpts),
       SanitizerBL(new SanitizerBlacklist(LangOpts.SanitizerBlacklistFiles, SM)),
+      ConstexprBytecode(nullptr), ConstexprCalls(nullptr),
       AddrSpaceMap(nullptr), Target(nullptr), AuxTarget(nullptr),
       PrintingPolicy(LOpts), Idents(idents), Selectors(sels),
       BuiltinInfo(builtins), DeclarationNames(*this), ExternalSource(nullptr),
@@ -789,6 +795,7 @@ ASTContext::~ASTContext() {
     MTVPair.second->~APValue();
 
   llvm::DeleteContainerSeconds(MangleNumberingContexts);
+  llvm::DeleteContainerSeconds(FinalOverriderMaps);
 }
 
 void ASTContext::ReleaseParentMapEntries() {
@@ -813,6 +820,66 @@ void ASTContext::AddDeallocation(void (*Callback)(void*), void *Data) {
   Deallocations.push_back({Callback, Data});
 }
 
+void ASTContext::startBodyRegion(const FunctionDecl *FD) {
+  std::unique_ptr<llvm::BumpPtrAllocator> &Region = BodyRegions[FD];
+  if (!Region)
+    Region.reset(new llvm::BumpPtrAllocator);
+  CurrentBodyRegion = Region.get();
+}
+
+/// \brief Collect the variables declared in \p S, and determine whether
+/// anything outside of the function body \p S belongs to may refer to its
+/// statements once their variables are gone.
+static bool collectBodyLocalVars(Stmt *S, SmallVectorImpl<VarDecl *> &Vars) {
+  if (!S)
+    return true;
+
+  // Labels are declarations that point back at their statement.
+  if (isa<LabelStmt>(S) || isa<AddrLabelExpr>(S))
+    return false;
+
+  // Variably modified types refer to their size expressions.
+  if (const auto *E = dyn_cast<Expr>(S))
+    if (E->getType()->isVariablyModifiedType())
+      return false;
+
+  if (auto *DS = dyn_cast<DeclStmt>(S)) {
+    for (Decl *D : DS->decls()) {
+      // Static variables, functions and types outlive the body in the
+      // declaration context of the function.
+      auto *VD = dyn_cast<VarDecl>(D);
+      if (!VD || !VD->hasLocalStorage() ||
+          VD->getType()->isVariablyModifiedType())
+        return false;
+      Vars.push_back(VD);
+    }
+  }
+
+  for (Stmt *Child : S->children())
+    if (!collectBodyLocalVars(Child, Vars))
+      return false;
+  return true;
+}
+
+bool ASTContext::discardFunctionBody(FunctionDecl *FD) {
+  auto Known = BodyRegions.find(FD);
+  if (Known == BodyRegions.end() || Known->second.get() == CurrentBodyRegion)
+    return false;
+
+  auto *Body = dyn_cast_or_null<CompoundStmt>(FD->getBody());
+  SmallVector<VarDecl *, 16> Vars;
+  if (!Body || !collectBodyLocalVars(Body, Vars))
+    return false;
+
+  // The variables stay in the declaration context of the function.
+  for (VarDecl *VD : Vars)
+    VD->setInit(nullptr);
+  FD->setBody(new (*this) CompoundStmt(*this, None, Body->getLBracLoc(),
+                                       Body->getRBracLoc()));
+  BodyRegions.erase(Known);
+  return true;
+}
+
 void
 ASTContext::setExternalSource(IntrusiveRefCntPtr<ExternalASTSource> Source) {
   ExternalSource = std::move(Source);
@@ -839,7 +906,8 @@ void ASTContext::PrintStats() const {
 #define TYPE(Name, Parent)                                              \
   if (counts[Idx])                                                      \
     llvm::errs() << "    " << counts[Idx] << " " << #Name               \
-                 << " types\n";                                         \
+                 << " types, " << sizeof(Name##Type) << " each ("       \
+                 << counts[Idx] * sizeof(Name##Type) << " bytes)\n";    \
   TotalBytes += counts[Idx] * sizeof(Name##Type);                       \
   ++Idx;
 #define ABSTRACT_TYPE(Name, Parent)
@@ -847,6 +915,19 @@ void ASTContext::PrintStats() const {
 
   llvm::errs() << "Total bytes = " << TotalBytes << "\n";
 
+  // The uniquing tables.
+  SmallVector<FoldingSetSize, 32> FoldingSetSizes;
+  getFoldingSetSizes(FoldingSetSizes);
+  size_t TotalBucketBytes = 0;
+  for (const FoldingSetSize &Size : FoldingSetSizes) {
+    if (!Size.NumNodes)
+      continue;
+    llvm::errs() << "    " << Size.NumNodes << " " << Size.Name << ", "
+                 << Size.BucketBytes << " bytes of buckets\n";
+    TotalBucketBytes += Size.BucketBytes;
+  }
+  llvm::errs() << "Total bucket bytes = " << TotalBucketBytes << "\n";
+
   // Implicit special member functions.
   llvm::errs() << NumImplicitDefaultConstructorsDeclared << "/"
                << NumImplicitDefaultConstructors
@@ -868,6 +949,15 @@ void ASTContext::PrintStats() const {
   llvm::errs() << NumImplicitDestructorsDeclared << "/"
                << NumImplicitDestructors
                << " implicit destructors created\n";
+  if (NumMemoizableConstexprCalls)
+    llvm::errs() << NumMemoizedConstexprCallsReused << "/"
+                 << NumMemoizableConstexprCalls
+                 << " memoizable constexpr calls reused\n";
+  llvm::errs() << NumRecordLayouts << " record layouts computed";
+  if (getLangOpts().CPlusPlus)
+    llvm::errs() << ", " << NumRecordLayoutsWithoutEmptySubobjects
+                 << " without an empty subobject map";
+  llvm::errs() << "\n";
 
   if (ExternalSource) {
     llvm::errs() << "\n";
@@ -877,6 +967,147 @@ void ASTContext::PrintStats() const {
   BumpAlloc.PrintStats();
 }
 
+void ASTContext::getFoldingSetSizes(
+    SmallVectorImpl<FoldingSetSize> &Sizes) const {
+  auto Add = [&](const char *Name, llvm::FoldingSetImpl &Set) {
+    // FoldingSet allows two nodes per bucket before it grows, and allocates
+    // one extra bucket as a sentinel.
+    FoldingSetSize Size = { Name, Set.size(),
+                            (Set.capacity() / 2 + 1) * sizeof(void *) };
+    Sizes.push_back(Size);
+  };
+  Add("ExtQualNodes", ExtQualNodes);
+  Add("ComplexTypes", ComplexTypes);
+  Add("PointerTypes", PointerTypes);
+  Add("AdjustedTypes", AdjustedTypes);
+  Add("BlockPointerTypes", BlockPointerTypes);
+  Add("LValueReferenceTypes", LValueReferenceTypes);
+  Add("RValueReferenceTypes", RValueReferenceTypes);
+  Add("MemberPointerTypes", MemberPointerTypes);
+  Add("ConstantArrayTypes", ConstantArrayTypes);
+  Add("IncompleteArrayTypes", IncompleteArrayTypes);
+  Add("DependentSizedArrayTypes", DependentSizedArrayTypes);
+  Add("DependentSizedExtVectorTypes", DependentSizedExtVectorTypes);
+  Add("VectorTypes", VectorTypes);
+  Add("FunctionNoProtoTypes", FunctionNoProtoTypes);
+  Add("FunctionProtoTypes", FunctionProtoTypes);
+  Add("DependentTypeOfExprTypes", DependentTypeOfExprTypes);
+  Add("DependentDecltypeTypes", DependentDecltypeTypes);
+  Add("TemplateTypeParmTypes", TemplateTypeParmTypes);
+  Add("SubstTemplateTypeParmTypes", SubstTemplateTypeParmTypes);
+  Add("SubstTemplateTypeParmPackTypes", SubstTemplateTypeParmPackTypes);
+  Add("TemplateSpecializationTypes", TemplateSpecializationTypes);
+  Add("ParenTypes", ParenTypes);
+  Add("ElaboratedTypes", ElaboratedTypes);
+  Add("DependentNameTypes", DependentNameTypes);
+  Add("DependentTemplateSpecializationTypes",
+      DependentTemplateSpecializationTypes);
+  Add("ObjCObjectTypes", ObjCObjectTypes);
+  Add("ObjCObjectPointerTypes", ObjCObjectPointerTypes);
+  Add("DependentUnaryTransformTypes", DependentUnaryTransformTypes);
+  Add("AutoTypes", AutoTypes);
+  Add("AtomicTypes", AtomicTypes);
+  Add("PipeTypes", PipeTypes);
+  Add("QualifiedTemplateNames", QualifiedTemplateNames);
+  Add("DependentTemplateNames", DependentTemplateNames);
+  Add("SubstTemplateTemplateParms", SubstTemplateTemplateParms);
+  Add("SubstTemplateTemplateParmPacks", SubstTemplateTemplateParmPacks);
+  Add("NestedNameSpecifiers", NestedNameSpecifiers);
+  Add("CanonTemplateTemplateParms", CanonTemplateTemplateParms);
+}
+
+void ASTContext::PrintStatsJSON(raw_ostream &OS) const {
+  OS << "{\"allocated-bytes\":" << getASTAllocatedMemory()
+     << ",\"side-table-bytes\":" << getSideTableAllocatedMemory();
+
+  unsigned counts[] = {
+#define TYPE(Name, Parent) 0,
+#define ABSTRACT_TYPE(Name, Parent)
+#include "clang/AST/TypeNodes.def"
+    0 // Extra
+  };
+
+  for (unsigned i = 0, e = Types.size(); i != e; ++i)
+    counts[(unsigned)Types[i]->getTypeClass()]++;
+
+  OS << ",\"types\":{";
+  const char *Sep = "";
+  unsigned Idx = 0;
+#define TYPE(Name, Parent)                                              \
+  if (counts[Idx]) {                                                    \
+    OS << Sep << "\"" #Name "\":{\"count\":" << counts[Idx]            \
+       << ",\"bytes\":" << counts[Idx] * sizeof(Name##Type) << '}';     \
+    Sep = ",";                                                          \
+  }                                                                     \
+  ++Idx;
+#define ABSTRACT_TYPE(Name, Parent)
+#include "clang/AST/TypeNodes.def"
+
+  OS << "},\"folding-sets\":{";
+  SmallVector<FoldingSetSize, 32> FoldingSetSizes;
+  getFoldingSetSizes(FoldingSetSizes);
+  Sep = "";
+  for (const FoldingSetSize &Size : FoldingSetSizes) {
+    OS << Sep << '"' << Size.Name << "\":{\"count\":" << Size.NumNodes
+       << ",\"bucket-bytes\":" << Size.BucketBytes << '}';
+    Sep = ",";
+  }
+  OS << "}}";
+}
+
+/// Pack the options of \p Policy into an integer, so that strings printed
+/// with different policies can be told apart.
+static uint64_t getPrintingPolicyKey(const PrintingPolicy &Policy) {
+  uint64_t Key = Policy.Indentation;
+  unsigned Bit = 8;
+  auto Add = [&](bool Flag) { Key |= uint64_t(Flag) << Bit++; };
+  Add(Policy.SuppressSpecifiers);
+  Add(Policy.SuppressTagKeyword);
+  Add(Policy.IncludeTagDefinition);
+  Add(Policy.SuppressScope);
+  Add(Policy.SuppressUnwrittenScope);
+  Add(Policy.SuppressInitializers);
+  Add(Policy.ConstantArraySizeAsWritten);
+  Add(Policy.AnonymousTagLocations);
+  Add(Policy.SuppressStrongLifetime);
+  Add(Policy.SuppressLifetimeQualifiers);
+  Add(Policy.SuppressTemplateArgsInCXXConstructors);
+  Add(Policy.Bool);
+  Add(Policy.Restrict);
+  Add(Policy.Alignof);
+  Add(Policy.UnderscoreAlignof);
+  Add(Policy.UseVoidForZeroParams);
+  Add(Policy.TerseOutput);
+  Add(Policy.PolishForDeclaration);
+  Add(Policy.Half);
+  Add(Policy.MSWChar);
+  Add(Policy.IncludeNewlines);
+  Add(Policy.MSVCFormatting);
+  return Key;
+}
+
+StringRef
+ASTContext::getTypeAsString(QualType T,
+                            const clang::PrintingPolicy &Policy) const {
+  // Tag definitions may still be changing, so don't remember them.
+  bool Cache = !Policy.IncludeTagDefinition;
+  std::pair<void *, uint64_t> Key(T.getAsOpaquePtr(),
+                                  getPrintingPolicyKey(Policy));
+  if (Cache) {
+    auto Known = PrintedTypes.find(Key);
+    if (Known != PrintedTypes.end())
+      return Known->second;
+  }
+
+  SmallString<128> Buf;
+  llvm::raw_svector_ostream OS(Buf);
+  T.print(OS, Policy);
+  StringRef Str = StringRef(Buf).copy(*this);
+  if (Cache)
+    PrintedTypes[Key] = Str;
+  return Str;
+}
+
 void ASTContext::mergeDefinitionIntoModule(NamedDecl *ND, Module *M,
                                            bool NotifyListeners) {
   if (NotifyListeners)
@@ -2820,6 +3051,7 @@ QualType ASTContext::getDependentSizedArrayType(QualType elementType,
       DependentSizedArrayType(*this, QualType(canonElementType.Ty, 0),
                               QualType(), numElements, ASM, elementTypeQuals,
                               brackets);
+    canonTy->ProfileHash = ID.ComputeHash();
     DependentSizedArrayTypes.InsertNode(canonTy, insertPos);
     Types.push_back(canonTy);
   }
@@ -2971,6 +3203,7 @@ ASTContext::getDependentSizedExtVectorType(QualType vecType,
         = DependentSizedExtVectorTypes.FindNodeOrInsertPos(ID, InsertPos);
       assert(!CanonCheck && "Dependent-sized ext_vector canonical type broken");
       (void)CanonCheck;
+      New->ProfileHash = ID.ComputeHash();
       DependentSizedExtVectorTypes.InsertNode(New, InsertPos);
     } else {
       QualType Canon = getDependentSizedExtVectorType(CanonVecTy, SizeExpr,
@@ -3941,6 +4174,7 @@ QualType ASTContext::getTypeOfExprType(Expr *tofExpr) const {
       // Build a new, canonical typeof(expr) type.
       Canon
         = new (*this, TypeAlignment) DependentTypeOfExprType(*this, tofExpr);
+      Canon->ProfileHash = ID.ComputeHash();
       DependentTypeOfExprTypes.InsertNode(Canon, InsertPos);
       toe = Canon;
     }
@@ -3985,6 +4219,7 @@ QualType ASTContext::getDecltypeType(Expr *e, QualType UnderlyingType) const {
     if (!Canon) {
       // Build a new, canonical typeof(expr) type.
       Canon = new (*this, TypeAlignment) DependentDecltypeType(*this, e);
+      Canon->ProfileHash = ID.ComputeHash();
       DependentDecltypeTypes.InsertNode(Canon, InsertPos);
     }
     dt = new (*this, TypeAlignment)
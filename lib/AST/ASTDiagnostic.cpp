@@ -232,8 +232,9 @@ ConvertTypeToDiagnosticString(ASTContext &Context, QualType Ty,
   // FIXME: Playing with std::string is really slow.
   bool ForceAKA = false;
   QualType CanTy = Ty.getCanonicalType();
-  std::string S = Ty.getAsString(Context.getPrintingPolicy());
-  std::string CanS = CanTy.getAsString(Context.getPrintingPolicy());
+  std::string S = Context.getTypeAsString(Ty, Context.getPrintingPolicy());
+  std::string CanS =
+      Context.getTypeAsString(CanTy, Context.getPrintingPolicy());
 
   for (unsigned I = 0, E = QualTypeVals.size(); I != E; ++I) {
     QualType CompareTy =
@@ -245,16 +246,17 @@ ConvertTypeToDiagnosticString(ASTContext &Context, QualType Ty,
     QualType CompareCanTy = CompareTy.getCanonicalType();
     if (CompareCanTy == CanTy)
       continue;  // Same canonical types
-    std::string CompareS = CompareTy.getAsString(Context.getPrintingPolicy());
+    std::string CompareS =
+        Context.getTypeAsString(CompareTy, Context.getPrintingPolicy());
     bool ShouldAKA = false;
     QualType CompareDesugar = Desugar(Context, CompareTy, ShouldAKA);
     std::string CompareDesugarStr =
-        CompareDesugar.getAsString(Context.getPrintingPolicy());
+        Context.getTypeAsString(CompareDesugar, Context.getPrintingPolicy());
     if (CompareS != S && CompareDesugarStr != S)
       continue;  // The type string is different than the comparison string
                  // and the desugared comparison string.
     std::string CompareCanS =
-        CompareCanTy.getAsString(Context.getPrintingPolicy());
+        Context.getTypeAsString(CompareCanTy, Context.getPrintingPolicy());
     
     if (CompareCanS == CanS)
       continue;  // No new info from canonical type
@@ -287,7 +289,8 @@ ConvertTypeToDiagnosticString(ASTContext &Context, QualType Ty,
       if (DesugaredTy == Ty) {
         DesugaredTy = Ty.getCanonicalType();
       }
-      std::string akaStr = DesugaredTy.getAsString(Context.getPrintingPolicy());
+      std::string akaStr =
+          Context.getTypeAsString(DesugaredTy, Context.getPrintingPolicy());
       if (akaStr != S) {
         S = "'" + S + "' (aka '" + akaStr + "')";
         return S;
@@ -1596,7 +1599,7 @@ class TemplateDiff {
            "Only one template argument may be missing.");
 
     if (Same) {
-      OS << FromType.getAsString(Policy);
+      OS << Context.getTypeAsString(FromType, Policy);
       return;
     }
 
@@ -1610,16 +1613,19 @@ class TemplateDiff {
       return;
     }
 
-    std::string FromTypeStr = FromType.isNull() ? "(no argument)"
-                                                : FromType.getAsString(Policy);
-    std::string ToTypeStr = ToType.isNull() ? "(no argument)"
-                                            : ToType.getAsString(Policy);
+    std::string FromTypeStr =
+        FromType.isNull() ? "(no argument)"
+                          : Context.getTypeAsString(FromType, Policy).str();
+    std::string ToTypeStr =
+        ToType.isNull() ? "(no argument)"
+                        : Context.getTypeAsString(ToType, Policy).str();
     // Switch to canonical typename if it is better.
     // TODO: merge this with other aka printing above.
     if (FromTypeStr == ToTypeStr) {
       std::string FromCanTypeStr =
-          FromType.getCanonicalType().getAsString(Policy);
-      std::string ToCanTypeStr = ToType.getCanonicalType().getAsString(Policy);
+          Context.getTypeAsString(FromType.getCanonicalType(), Policy);
+      std::string ToCanTypeStr =
+          Context.getTypeAsString(ToType.getCanonicalType(), Policy);
       if (FromCanTypeStr != ToCanTypeStr) {
         FromTypeStr = FromCanTypeStr;
         ToTypeStr = ToCanTypeStr;
@@ -252,6 +252,7 @@ namespace clang {
     Expr *VisitMemberExpr(MemberExpr *E);
     Expr *VisitCallExpr(CallExpr *E);
     Expr *VisitInitListExpr(InitListExpr *E);
+    Expr *VisitDataArrayExpr(DataArrayExpr *E);
     Expr *VisitCXXDefaultInitExpr(CXXDefaultInitExpr *E);
     Expr *VisitCXXNamedCastExpr(CXXNamedCastExpr *E);
 
@@ -305,6 +306,10 @@ namespace {
     /// \brief Declaration (from, to) pairs that are known not to be equivalent
     /// (which we have already complained about).
     llvm::DenseSet<std::pair<Decl *, Decl *> > &NonEquivalentDecls;
+
+    /// \brief Declaration (from, to) pairs that are known to be equivalent,
+    /// if they are to be remembered.
+    llvm::DenseSet<std::pair<Decl *, Decl *> > *EquivalentDecls;
     
     /// \brief Whether we're being strict about the spelling of types when 
     /// unifying two types.
@@ -318,9 +323,11 @@ namespace {
 
     StructuralEquivalenceContext(ASTContext &C1, ASTContext &C2,
                llvm::DenseSet<std::pair<Decl *, Decl *> > &NonEquivalentDecls,
+               llvm::DenseSet<std::pair<Decl *, Decl *> > *EquivalentDecls,
                                  bool StrictTypeSpelling = false,
                                  bool Complain = true)
       : C1(C1), C2(C2), NonEquivalentDecls(NonEquivalentDecls),
+        EquivalentDecls(StrictTypeSpelling ? nullptr : EquivalentDecls),
         StrictTypeSpelling(StrictTypeSpelling), Complain(Complain),
         LastDiagFromC2(false) {}
 
@@ -1400,6 +1407,12 @@ static bool IsStructurallyEquivalent(StructuralEquivalenceContext &Context,
   if (Context.NonEquivalentDecls.count(std::make_pair(D1->getCanonicalDecl(),
                                                       D2->getCanonicalDecl())))
     return false;
+
+  // Or that they are.
+  if (Context.EquivalentDecls &&
+      Context.EquivalentDecls->count(std::make_pair(D1->getCanonicalDecl(),
+                                                    D2->getCanonicalDecl())))
+    return true;
   
   // Determine whether we've already produced a tentative equivalence for D1.
   Decl *&EquivToD1 = Context.TentativeEquivalences[D1->getCanonicalDecl()];
@@ -1428,6 +1441,19 @@ bool StructuralEquivalenceContext::IsStructurallyEquivalent(QualType T1,
   return !Finish();
 }
 
+/// \brief Determine whether the structural equivalence of \p D with another
+/// declaration can't change anymore.
+///
+/// A tag without a definition is equivalent to any tag of the same name,
+/// which stops being true once the definition is imported.
+static bool isFinalForEquivalence(Decl *D) {
+  if (auto *Tag = dyn_cast<TagDecl>(D))
+    return Tag->getDefinition() != nullptr;
+  if (auto *ClassTemplate = dyn_cast<ClassTemplateDecl>(D))
+    return ClassTemplate->getTemplatedDecl()->getDefinition() != nullptr;
+  return true;
+}
+
 bool StructuralEquivalenceContext::Finish() {
   while (!DeclsToCheck.empty()) {
     // Check the next declaration.
@@ -1535,7 +1561,16 @@ bool StructuralEquivalenceContext::Finish() {
     }
     // FIXME: Check other declaration kinds!
   }
-  
+
+  // Every tentative equivalence has been verified now.  Remember them, unless
+  // a later import could complete one of the declarations in a way that makes
+  // them differ.
+  if (EquivalentDecls)
+    for (const auto &Equiv : TentativeEquivalences)
+      if (isFinalForEquivalence(Equiv.first) &&
+          isFinalForEquivalence(Equiv.second))
+        EquivalentDecls->insert(Equiv);
+
   return false;
 }
 
@@ -2368,6 +2403,7 @@ bool ASTNodeImporter::IsStructuralMatch(RecordDecl *FromRecord,
   StructuralEquivalenceContext Ctx(Importer.getFromContext(),
                                    ToRecord->getASTContext(),
                                    Importer.getNonEquivalentDecls(),
+                                   &Importer.getEquivalentDecls(),
                                    false, Complain);
   return Ctx.IsStructurallyEquivalent(FromRecord, ToRecord);
 }
@@ -2376,14 +2412,16 @@ bool ASTNodeImporter::IsStructuralMatch(VarDecl *FromVar, VarDecl *ToVar,
                                         bool Complain) {
   StructuralEquivalenceContext Ctx(
       Importer.getFromContext(), Importer.getToContext(),
-      Importer.getNonEquivalentDecls(), false, Complain);
+      Importer.getNonEquivalentDecls(), &Importer.getEquivalentDecls(), false,
+      Complain);
   return Ctx.IsStructurallyEquivalent(FromVar, ToVar);
 }
 
 bool ASTNodeImporter::IsStructuralMatch(EnumDecl *FromEnum, EnumDecl *ToEnum) {
   StructuralEquivalenceContext Ctx(Importer.getFromContext(),
                                    Importer.getToContext(),
-                                   Importer.getNonEquivalentDecls());
+                                   Importer.getNonEquivalentDecls(),
+                                   &Importer.getEquivalentDecls());
   return Ctx.IsStructurallyEquivalent(FromEnum, ToEnum);
 }
 
@@ -2402,7 +2440,8 @@ bool ASTNodeImporter::IsStructuralMatch(ClassTemplateDecl *From,
                                         ClassTemplateDecl *To) {
   StructuralEquivalenceContext Ctx(Importer.getFromContext(),
                                    Importer.getToContext(),
-                                   Importer.getNonEquivalentDecls());
+                                   Importer.getNonEquivalentDecls(),
+                                   &Importer.getEquivalentDecls());
   return Ctx.IsStructurallyEquivalent(From, To);  
 }
 
@@ -2410,7 +2449,8 @@ bool ASTNodeImporter::IsStructuralMatch(VarTemplateDecl *From,
                                         VarTemplateDecl *To) {
   StructuralEquivalenceContext Ctx(Importer.getFromContext(),
                                    Importer.getToContext(),
-                                   Importer.getNonEquivalentDecls());
+                                   Importer.getNonEquivalentDecls(),
+                                   &Importer.getEquivalentDecls());
   return Ctx.IsStructurallyEquivalent(From, To);
 }
 
@@ -5988,6 +6028,23 @@ Expr *ASTNodeImporter::VisitInitListExpr(InitListExpr *ILE) {
   return To;
 }
 
+Expr *ASTNodeImporter::VisitDataArrayExpr(DataArrayExpr *E) {
+  QualType T = Importer.Import(E->getType());
+  if (T.isNull())
+    return nullptr;
+
+  InitListExpr *ToSyntForm = cast_or_null<InitListExpr>(
+        Importer.Import(E->getSyntacticForm()));
+  if (!ToSyntForm)
+    return nullptr;
+
+  llvm::SmallVector<uint64_t, 64> Values;
+  for (unsigned I = 0, N = E->getNumInits(); I != N; ++I)
+    Values.push_back(E->getElementValue(I));
+  return DataArrayExpr::Create(Importer.getToContext(), T, ToSyntForm, Values,
+                               E->getElementSize());
+}
+
 Expr *ASTNodeImporter::VisitCXXDefaultInitExpr(CXXDefaultInitExpr *DIE) {
   FieldDecl *ToField = llvm::dyn_cast_or_null<FieldDecl>(
       Importer.Import(DIE->getField()));
@@ -6693,6 +6750,6 @@ bool ASTImporter::IsStructurallyEquivalent(QualType From, QualType To,
     return true;
       
   StructuralEquivalenceContext Ctx(FromContext, ToContext, NonEquivalentDecls,
-                                   false, Complain);
+                                   &EquivalentDecls, false, Complain);
   return Ctx.IsStructurallyEquivalent(From, To);
 }
@@ -74,6 +74,9 @@ void CXXBasePaths::swap(CXXBasePaths &Other) {
 }
 
 bool CXXRecordDecl::isDerivedFrom(const CXXRecordDecl *Base) const {
+  if (CXXDerivation::isMemoizable(this))
+    return getASTContext().getDerivation(this, Base) != nullptr;
+
   CXXBasePaths Paths(/*FindAmbiguities=*/false, /*RecordPaths=*/false,
                      /*DetectVirtual=*/false);
   return isDerivedFrom(Base, Paths);
@@ -658,6 +661,53 @@ CXXRecordDecl::getFinalOverriders(CXXFinalOverriderMap &FinalOverriders) const {
   }
 }
 
+const CXXFinalOverriderMap &
+ASTContext::getFinalOverriders(const CXXRecordDecl *RD) const {
+  RD = RD->getDefinition();
+  assert(RD && RD->isCompleteDefinition() && !RD->isBeingDefined() &&
+         "Final overriders of an incomplete class can still change!");
+
+  CXXFinalOverriderMap *&Entry = FinalOverriderMaps[RD];
+  if (!Entry) {
+    // Computing the overriders doesn't look at other entries, so the
+    // reference stays valid.
+    Entry = new CXXFinalOverriderMap;
+    RD->getFinalOverriders(*Entry);
+  }
+  return *Entry;
+}
+
+const CXXDerivation *
+ASTContext::getDerivation(const CXXRecordDecl *Derived,
+                          const CXXRecordDecl *Base) const {
+  assert(CXXDerivation::isMemoizable(Derived) &&
+         "Derivations of an incomplete class can still change!");
+  Derived = Derived->getCanonicalDecl();
+  Base = Base->getCanonicalDecl();
+
+  auto Known = Derivations.find(std::make_pair(Derived, Base));
+  if (Known != Derivations.end())
+    return Known->second;
+
+  // Search for the first path and for ambiguities at once; later queries for
+  // the same pair need neither the search nor the CXXBasePaths.
+  CXXBasePaths Paths(/*FindAmbiguities=*/true, /*RecordPaths=*/true,
+                     /*DetectVirtual=*/false);
+  const CXXDerivation *Result = nullptr;
+  if (Derived->getDefinition()->isDerivedFrom(Base, Paths)) {
+    const CXXBasePath &Front = Paths.front();
+    CXXBasePathElement *Path = new (*this) CXXBasePathElement[Front.size()];
+    std::copy(Front.begin(), Front.end(), Path);
+    CanQualType BaseType =
+        getCanonicalType(getRecordType(Base)).getUnqualifiedType();
+    Result = new (*this)
+        CXXDerivation(llvm::makeArrayRef(Path, Front.size()), Front.Access,
+                      Paths.isAmbiguous(BaseType));
+  }
+  Derivations[std::make_pair(Derived, Base)] = Result;
+  return Result;
+}
+
 static void 
 AddIndirectPrimaryBases(const CXXRecordDecl *RD, ASTContext &Context,
                         CXXIndirectPrimaryBaseSet& Bases) {
@@ -3534,6 +3534,8 @@ TagDecl *TagDecl::getCanonicalDecl() { return getFirstDecl(); }
 
 void TagDecl::setTypedefNameForAnonDecl(TypedefNameDecl *TDD) {
   TypedefNameDeclOrQualifier = TDD;
+  // The tag is printed with the name of the typedef from now on.
+  getASTContext().clearPrintedTypes();
   if (const Type *T = getTypeForDecl()) {
     (void)T;
     assert(T->isLinkageValid());
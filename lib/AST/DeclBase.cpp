@@ -158,6 +158,20 @@ void Decl::PrintStats() {
   llvm::errs() << "Total bytes = " << totalBytes << "\n";
 }
 
+void Decl::PrintStatsJSON(raw_ostream &OS) {
+  OS << '{';
+  const char *Sep = "";
+#define DECL(DERIVED, BASE)                                             \
+  if (n##DERIVED##s > 0) {                                              \
+    OS << Sep << "\"" #DERIVED "\":{\"count\":" << n##DERIVED##s       \
+       << ",\"bytes\":" << n##DERIVED##s * sizeof(DERIVED##Decl) << '}'; \
+    Sep = ",";                                                          \
+  }
+#define ABSTRACT_DECL(DECL)
+#include "clang/AST/DeclNodes.inc"
+  OS << '}';
+}
+
 void Decl::add(Kind k) {
   switch (k) {
 #define DECL(DERIVED, BASE) case DERIVED: ++n##DERIVED##s; break;
@@ -1351,20 +1365,37 @@ StoredDeclsMap *DeclContext::buildLookup() {
   SmallVector<DeclContext *, 2> Contexts;
   collectAllContexts(Contexts);
 
+  // The contexts whose external lexical declarations were loaded just now,
+  // along with the declaration that used to be first in each of them.
+  SmallVector<std::pair<DeclContext *, Decl *>, 2> LoadedContexts;
   if (HasLazyExternalLexicalLookups) {
     HasLazyExternalLexicalLookups = false;
     for (auto *DC : Contexts) {
-      if (DC->hasExternalLexicalStorage())
-        HasLazyLocalLexicalLookups |=
-            DC->LoadLexicalDeclsFromExternalStorage();
+      if (!DC->hasExternalLexicalStorage())
+        continue;
+      Decl *OldFirstDecl = DC->FirstDecl;
+      if (DC->LoadLexicalDeclsFromExternalStorage())
+        LoadedContexts.push_back(std::make_pair(DC, OldFirstDecl));
     }
 
-    if (!HasLazyLocalLexicalLookups)
+    if (!HasLazyLocalLexicalLookups && LoadedContexts.empty())
       return LookupPtr;
   }
 
-  for (auto *DC : Contexts)
-    buildLookupImpl(DC, hasExternalVisibleStorage());
+  if (HasLazyLocalLexicalLookups) {
+    for (auto *DC : Contexts)
+      buildLookupImpl(DC, DC->noload_decls_begin(), DC->noload_decls_end(),
+                      hasExternalVisibleStorage());
+  } else {
+    // Every local declaration is already in the table, so only the
+    // declarations we just loaded are missing. They were spliced onto the
+    // front of each context's chain, so stop at the old first declaration
+    // rather than walking the whole (potentially enormous) chain again.
+    for (auto &Loaded : LoadedContexts)
+      buildLookupImpl(Loaded.first, Loaded.first->noload_decls_begin(),
+                      decl_iterator(Loaded.second),
+                      hasExternalVisibleStorage());
+  }
 
   // We no longer have any lazy decls.
   HasLazyLocalLexicalLookups = false;
@@ -1372,11 +1403,12 @@ StoredDeclsMap *DeclContext::buildLookup() {
 }
 
 /// buildLookupImpl - Build part of the lookup data structure for the
-/// declarations contained within DCtx, which will either be this
-/// DeclContext, a DeclContext linked to it, or a transparent context
+/// declarations [Begin, End) contained within DCtx, which will either be
+/// this DeclContext, a DeclContext linked to it, or a transparent context
 /// nested within it.
-void DeclContext::buildLookupImpl(DeclContext *DCtx, bool Internal) {
-  for (Decl *D : DCtx->noload_decls()) {
+void DeclContext::buildLookupImpl(DeclContext *DCtx, decl_iterator Begin,
+                                  decl_iterator End, bool Internal) {
+  for (Decl *D : llvm::make_range(Begin, End)) {
     // Insert this declaration into the lookup structure, but only if
     // it's semantically within its decl context. Any other decls which
     // should be found in this context are added eagerly.
@@ -1397,7 +1429,8 @@ void DeclContext::buildLookupImpl(DeclContext *DCtx, bool Internal) {
     // context (recursively).
     if (DeclContext *InnerCtx = dyn_cast<DeclContext>(D))
       if (InnerCtx->isTransparentContext() || InnerCtx->isInlineNamespace())
-        buildLookupImpl(InnerCtx, Internal);
+        buildLookupImpl(InnerCtx, InnerCtx->noload_decls_begin(),
+                        InnerCtx->noload_decls_end(), Internal);
   }
 }
 
@@ -1481,7 +1514,9 @@ DeclContext::noload_lookup(DeclarationName Name) {
     SmallVector<DeclContext *, 2> Contexts;
     collectAllContexts(Contexts);
     for (unsigned I = 0, N = Contexts.size(); I != N; ++I)
-      buildLookupImpl(Contexts[I], hasExternalVisibleStorage());
+      buildLookupImpl(Contexts[I], Contexts[I]->noload_decls_begin(),
+                      Contexts[I]->noload_decls_end(),
+                      hasExternalVisibleStorage());
     HasLazyLocalLexicalLookups = false;
   }
 
@@ -72,7 +72,7 @@ CXXRecordDecl::DefinitionData::DefinitionData(CXXRecordDecl *D)
       HasDeclaredCopyConstructorWithConstParam(false),
       HasDeclaredCopyAssignmentWithConstParam(false), IsLambda(false),
       IsParsingBaseSpecifiers(false), NumBases(0), NumVBases(0), Bases(),
-      VBases(), Definition(D), FirstFriend() {}
+      VBases(), Definition(D), FirstFriend(), ODRHash(0) {}
 
 CXXBaseSpecifier *CXXRecordDecl::DefinitionData::getBasesSlowCase() const {
   return Bases.get(Definition->getASTContext().getExternalSource());
@@ -1420,18 +1420,16 @@ void CXXRecordDecl::completeDefinition(CXXFinalOverriderMap *FinalOverriders) {
   // If the class may be abstract (but hasn't been marked as such), check for
   // any pure final overriders.
   if (mayBeAbstract()) {
-    CXXFinalOverriderMap MyFinalOverriders;
-    if (!FinalOverriders) {
-      getFinalOverriders(MyFinalOverriders);
-      FinalOverriders = &MyFinalOverriders;
-    }
+    const CXXFinalOverriderMap *Overriders = FinalOverriders;
+    if (!Overriders)
+      Overriders = &getASTContext().getFinalOverriders(this);
     
     bool Done = false;
-    for (CXXFinalOverriderMap::iterator M = FinalOverriders->begin(), 
-                                     MEnd = FinalOverriders->end();
+    for (CXXFinalOverriderMap::const_iterator M = Overriders->begin(), 
+                                           MEnd = Overriders->end();
          M != MEnd && !Done; ++M) {
-      for (OverridingMethods::iterator SO = M->second.begin(), 
-                                    SOEnd = M->second.end();
+      for (OverridingMethods::const_iterator SO = M->second.begin(), 
+                                          SOEnd = M->second.end();
            SO != SOEnd && !Done; ++SO) {
         assert(SO->second.size() > 0 && 
                "All virtual functions have overridding virtual functions");
@@ -1455,6 +1453,59 @@ void CXXRecordDecl::completeDefinition(CXXFinalOverriderMap *FinalOverriders) {
     I.setAccess((*I)->getAccess());
 }
 
+/// Add the canonical type \p T to \p ID in a form that doesn't depend on
+/// where or in which compilation the type was created.
+static void AddODRHashType(llvm::FoldingSetNodeID &ID, QualType T,
+                           const PrintingPolicy &Policy) {
+  ID.AddString(T.getCanonicalType().getAsString(Policy));
+}
+
+unsigned CXXRecordDecl::computeODRHash() const {
+  PrintingPolicy Policy(getASTContext().getLangOpts());
+  Policy.AnonymousTagLocations = false;
+
+  llvm::FoldingSetNodeID ID;
+  ID.AddInteger(getNumBases());
+  for (const CXXBaseSpecifier &Base : bases()) {
+    ID.AddBoolean(Base.isVirtual());
+    ID.AddInteger(Base.getAccessSpecifierAsWritten());
+    AddODRHashType(ID, Base.getType(), Policy);
+  }
+
+  for (const Decl *D : decls()) {
+    // Implicit members are declared lazily, so different definitions of the
+    // same class can have different ones.
+    if (D->isImplicit())
+      continue;
+
+    ID.AddInteger(D->getKind());
+    ID.AddInteger(D->getAccess());
+    if (const auto *ND = dyn_cast<NamedDecl>(D))
+      ID.AddString(ND->getDeclName().getAsString());
+    if (const auto *FTD = dyn_cast<FunctionTemplateDecl>(D))
+      D = FTD->getTemplatedDecl();
+
+    if (const auto *FD = dyn_cast<FieldDecl>(D)) {
+      AddODRHashType(ID, FD->getType(), Policy);
+      ID.AddBoolean(FD->isMutable());
+      ID.AddBoolean(FD->isBitField());
+    } else if (const auto *FD = dyn_cast<FunctionDecl>(D)) {
+      AddODRHashType(ID, FD->getType(), Policy);
+      ID.AddInteger(FD->getStorageClass());
+      ID.AddBoolean(FD->isVirtualAsWritten());
+      ID.AddBoolean(FD->isPure());
+      ID.AddBoolean(FD->isDeleted());
+    } else if (const auto *VD = dyn_cast<VarDecl>(D)) {
+      AddODRHashType(ID, VD->getType(), Policy);
+    } else if (const auto *TND = dyn_cast<TypedefNameDecl>(D)) {
+      AddODRHashType(ID, TND->getUnderlyingType(), Policy);
+    }
+  }
+
+  unsigned Hash = ID.ComputeHash();
+  return Hash ? Hash : 1;
+}
+
 bool CXXRecordDecl::mayBeAbstract() const {
   if (data().Abstract || isInvalidDecl() || !data().Polymorphic ||
       isDependentContext())
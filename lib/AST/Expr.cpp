@@ -2711,6 +2711,7 @@ bool Expr::isConstantInitializer(ASTContext &Ctx, bool IsForRef,
   }
   case ImplicitValueInitExprClass:
   case NoInitExprClass:
+  case DataArrayExprClass:
     return true;
   case ParenExprClass:
     return cast<ParenExpr>(this)->getSubExpr()
@@ -2844,6 +2845,7 @@ bool Expr::HasSideEffects(const ASTContext &Ctx,
   case AddrLabelExprClass:
   case GNUNullExprClass:
   case NoInitExprClass:
+  case DataArrayExprClass:
   case CXXBoolLiteralExprClass:
   case CXXNullPtrLiteralExprClass:
   case CXXThisExprClass:
@@ -3701,6 +3703,35 @@ SourceLocation DesignatedInitUpdateExpr::getLocEnd() const {
   return getBase()->getLocEnd();
 }
 
+DataArrayExpr *DataArrayExpr::Create(const ASTContext &C, QualType T,
+                                     InitListExpr *SyntacticForm,
+                                     ArrayRef<uint64_t> Values,
+                                     unsigned ElementSize) {
+  void *Mem = C.Allocate(totalSizeToAlloc<char>(Values.size() * ElementSize),
+                         llvm::alignOf<DataArrayExpr>());
+  DataArrayExpr *E = new (Mem) DataArrayExpr(T, SyntacticForm, Values.size(),
+                                             ElementSize);
+  for (unsigned I = 0, N = Values.size(); I != N; ++I)
+    E->setElementValue(I, Values[I]);
+  return E;
+}
+
+DataArrayExpr *DataArrayExpr::CreateEmpty(const ASTContext &C,
+                                          unsigned NumInits,
+                                          unsigned ElementSize) {
+  void *Mem = C.Allocate(totalSizeToAlloc<char>(NumInits * ElementSize),
+                         llvm::alignOf<DataArrayExpr>());
+  return new (Mem) DataArrayExpr(EmptyShell(), NumInits, ElementSize);
+}
+
+SourceLocation DataArrayExpr::getLocStart() const {
+  return SyntacticForm ? SyntacticForm->getLocStart() : SourceLocation();
+}
+
+SourceLocation DataArrayExpr::getLocEnd() const {
+  return SyntacticForm ? SyntacticForm->getLocEnd() : SourceLocation();
+}
+
 ParenListExpr::ParenListExpr(const ASTContext& C, SourceLocation lparenloc,
                              ArrayRef<Expr*> exprs,
                              SourceLocation rparenloc)
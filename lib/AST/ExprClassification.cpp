@@ -187,6 +187,7 @@ static Cl::Kinds ClassifyInternal(ASTContext &Ctx, const Expr *E) {
   case Expr::AtomicExprClass:
   case Expr::CXXFoldExprClass:
   case Expr::NoInitExprClass:
+  case Expr::DataArrayExprClass:
   case Expr::DesignatedInitUpdateExprClass:
   case Expr::CoyieldExprClass:
     return Cl::CL_PRValue;
@@ -42,8 +42,10 @@
 #include "clang/AST/StmtVisitor.h"
 #include "clang/AST/TypeLoc.h"
 #include "clang/Basic/Builtins.h"
+#include "clang/Basic/CompileTimeBudget.h"
 #include "clang/Basic/TargetInfo.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstring>
 #include <functional>
@@ -480,6 +482,19 @@ namespace {
     /// \brief Whether or not we're currently speculatively evaluating.
     bool IsSpeculativelyEvaluating;
 
+    /// NumDiagnosed - The number of times evaluation has run into something
+    /// that isn't a constant expression, whether or not a diagnostic was
+    /// stored for it.
+    unsigned NumDiagnosed;
+
+    /// MaxCallStackDepth - The deepest the call stack has been since this was
+    /// last reset.
+    unsigned MaxCallStackDepth;
+
+    /// UsedEvaluatingDecl - Whether evaluation has used the in-flight value of
+    /// EvaluatingDecl since this was last reset.
+    bool UsedEvaluatingDecl;
+
     enum EvaluationMode {
       /// Evaluate as a constant expression. Stop if we find that the expression
       /// is not a constant expression.
@@ -545,7 +560,8 @@ namespace {
         EvaluatingDecl((const ValueDecl *)nullptr),
         EvaluatingDeclValue(nullptr), HasActiveDiagnostic(false),
         HasFoldFailureDiagnostic(false), IsSpeculativelyEvaluating(false),
-        EvalMode(Mode) {}
+        NumDiagnosed(0), MaxCallStackDepth(CallStackDepth),
+        UsedEvaluatingDecl(false), EvalMode(Mode) {}
 
     void setEvaluatingDecl(APValue::LValueBase Base, APValue &Value) {
       EvaluatingDecl = Base;
@@ -587,9 +603,32 @@ namespace {
         return false;
       }
       --StepsLeft;
+      if (CompileTimeBudget::isExceeded())
+        reportCompileTimeBudgetExceeded(S);
       return true;
     }
 
+    /// Report the statement being evaluated and the stack of calls being
+    /// evaluated, innermost first, once the compile-time budget is exceeded.
+    void reportCompileTimeBudgetExceeded(const Stmt *S) {
+      CompileTimeBudget::getActive()->reportActivity(
+          "constant evaluation", [&](raw_ostream &OS) {
+            const SourceManager &SM = Ctx.getSourceManager();
+            OS << "  evaluating statement at ";
+            S->getLocStart().print(OS, SM);
+            OS << '\n';
+            for (CallStackFrame *Frame = CurrentCall; Frame != &BottomFrame;
+                 Frame = Frame->Caller) {
+              OS << "  in call to ";
+              Frame->Callee->getNameForDiagnostic(OS, Ctx.getPrintingPolicy(),
+                                                  /*Qualified=*/true);
+              OS << " at ";
+              Frame->CallLoc.print(OS, SM);
+              OS << '\n';
+            }
+          });
+    }
+
   private:
     /// Add a diagnostic to the diagnostics list.
     PartialDiagnostic &addDiag(SourceLocation Loc, diag::kind DiagId) {
@@ -655,12 +694,14 @@ namespace {
     FFDiag(SourceLocation Loc,
           diag::kind DiagId = diag::note_invalid_subexpr_in_const_expr,
           unsigned ExtraNotes = 0) {
+      ++NumDiagnosed;
       return Diag(Loc, DiagId, ExtraNotes, false);
     }
     
     OptionalDiagnostic FFDiag(const Expr *E, diag::kind DiagId
                               = diag::note_invalid_subexpr_in_const_expr,
                             unsigned ExtraNotes = 0) {
+      ++NumDiagnosed;
       if (EvalStatus.Diag)
         return Diag(E->getExprLoc(), DiagId, ExtraNotes, /*IsCCEDiag*/false);
       HasActiveDiagnostic = false;
@@ -675,6 +716,7 @@ namespace {
     OptionalDiagnostic CCEDiag(SourceLocation Loc, diag::kind DiagId
                                  = diag::note_invalid_subexpr_in_const_expr,
                                unsigned ExtraNotes = 0) {
+      ++NumDiagnosed;
       // Don't override a previous diagnostic. Don't bother collecting
       // diagnostics if we're evaluating for overflow.
       if (!EvalStatus.Diag || !EvalStatus.Diag->empty()) {
@@ -965,6 +1007,8 @@ CallStackFrame::CallStackFrame(EvalInfo &Info, SourceLocation CallLoc,
       Index(Info.NextCallIndex++), This(This), Arguments(Arguments) {
   Info.CurrentCall = this;
   ++Info.CallStackDepth;
+  Info.MaxCallStackDepth = std::max(Info.MaxCallStackDepth,
+                                    Info.CallStackDepth);
 }
 
 CallStackFrame::~CallStackFrame() {
@@ -1484,8 +1528,10 @@ static bool CheckLiteralType(EvalInfo &Info, const Expr *E,
   // constexpr constructors for o and its subobjects even if those objects
   // are of non-literal class types.
   if (Info.getLangOpts().CPlusPlus14 && This &&
-      Info.EvaluatingDecl == This->getLValueBase())
+      Info.EvaluatingDecl == This->getLValueBase()) {
+    Info.UsedEvaluatingDecl = true;
     return true;
+  }
 
   // Prvalue constant expressions must be of literal types.
   if (Info.getLangOpts().CPlusPlus11)
@@ -2142,6 +2188,7 @@ static bool evaluateVarDeclInit(EvalInfo &Info, const Expr *E,
   // If we're currently evaluating the initializer of this declaration, use that
   // in-flight value.
   if (Info.EvaluatingDecl.dyn_cast<const ValueDecl*>() == VD) {
+    Info.UsedEvaluatingDecl = true;
     Result = Info.EvaluatingDeclValue;
     return true;
   }
@@ -2250,10 +2297,11 @@ static void expandArray(APValue &Array, unsigned Index) {
   APValue NewValue(APValue::UninitArray(), NewElts, Size);
   for (unsigned I = 0; I != OldElts; ++I)
     NewValue.getArrayInitializedElt(I).swap(Array.getArrayInitializedElt(I));
+  const APValue &Filler = static_cast<const APValue &>(Array).getArrayFiller();
   for (unsigned I = OldElts; I != NewElts; ++I)
-    NewValue.getArrayInitializedElt(I) = Array.getArrayFiller();
+    NewValue.getArrayInitializedElt(I) = Filler;
   if (NewValue.hasArrayFiller())
-    NewValue.getArrayFiller() = Array.getArrayFiller();
+    NewValue.getArrayFiller().swap(Array.getArrayFiller());
   Array.swap(NewValue);
 }
 
@@ -2423,13 +2471,19 @@ findSubobject(EvalInfo &Info, const Expr *E, const CompleteObject &Obj,
           return handler.foundString(*O, ObjType, Index);
       }
 
-      if (O->getArrayInitializedElts() > Index)
-        O = &O->getArrayInitializedElt(Index);
-      else if (handler.AccessKind != AK_Read) {
-        expandArray(*O, Index);
+      // A read doesn't modify the element, so it can look at storage that is
+      // shared with copies of the array instead of making its own copy.
+      const APValue *Array = O;
+      if (handler.AccessKind == AK_Read)
+        O = const_cast<APValue *>(
+            Array->getArrayInitializedElts() > Index
+                ? &Array->getArrayInitializedElt(Index)
+                : &Array->getArrayFiller());
+      else {
+        if (O->getArrayInitializedElts() <= Index)
+          expandArray(*O, Index);
         O = &O->getArrayInitializedElt(Index);
-      } else
-        O = &O->getArrayFiller();
+      }
     } else if (ObjType->isAnyComplexType()) {
       // Next subobject is a complex number.
       uint64_t Index = Sub.Entries[I].ArrayIndex;
@@ -2821,6 +2875,8 @@ static CompleteObject findCompleteObject(EvalInfo &Info, const Expr *E,
           Info.Note(MTE->getExprLoc(), diag::note_constexpr_temporary_here);
           return CompleteObject();
         }
+        if (VD && VD->getCanonicalDecl() == ED->getCanonicalDecl())
+          Info.UsedEvaluatingDecl = true;
 
         BaseVal = Info.Ctx.getMaterializedTemporaryValue(MTE, false);
         assert(BaseVal && "got reference to unevaluated temporary");
@@ -2851,6 +2907,7 @@ static CompleteObject findCompleteObject(EvalInfo &Info, const Expr *E,
   // and this doesn't do quite the right thing for const subobjects of the
   // object under construction.
   if (LVal.getLValueBase() == Info.EvaluatingDecl) {
+    Info.UsedEvaluatingDecl = true;
     BaseType = Info.Ctx.getCanonicalType(BaseType);
     BaseType.removeLocalConst();
   }
@@ -3922,19 +3979,1154 @@ static bool EvaluateArgs(ArrayRef<const Expr*> Args, ArgVector &ArgValues,
   return Success;
 }
 
-/// Evaluate a function call.
-static bool HandleFunctionCall(SourceLocation CallLoc,
-                               const FunctionDecl *Callee, const LValue *This,
-                               ArrayRef<const Expr*> Args, const Stmt *Body,
-                               EvalInfo &Info, APValue &Result,
-                               const LValue *ResultSlot) {
-  ArgVector ArgValues(Args.size());
-  if (!EvaluateArgs(Args, ArgValues, Info))
+//===----------------------------------------------------------------------===//
+// Bytecode interpreter
+//===----------------------------------------------------------------------===//
+//
+// With -fexperimental-constexpr-interpreter, calls to constexpr functions
+// whose parameters, local variables and result all have integral type are
+// compiled once into a small stack-machine bytecode, which is then run
+// without building any APValues or call frames for the intermediate steps.
+//
+// The interpreter never produces a diagnostic. When a function uses a
+// construct it can't compile, or an operation would make the AST evaluator
+// say something (overflow, division by zero, a bad shift, exceeding the step
+// or depth limits), the interpreter gives up and the call is evaluated by
+// walking the AST from scratch, so diagnostics are the same either way.
+
+namespace clang {
+/// \brief The bytecode for every constexpr function the interpreter has seen,
+/// or null for those it can't compile.
+class ConstexprBytecodeCache {
+public:
+  enum Opcode : unsigned char {
+    Op_Step,        ///< Consume one evaluation step.
+    Op_Const,       ///< Push Consts[A].
+    Op_Load,        ///< Push Slots[A].
+    Op_Store,       ///< Pop into Slots[A].
+    Op_Pop,         ///< Discard the top of the stack.
+    Op_Swap,        ///< Swap the two topmost values.
+    Op_Cast,        ///< Convert the top of the stack to integer type A.
+    Op_ToBool,      ///< Convert the top of the stack to 0 or 1 of type A.
+    Op_Neg,         ///< Negate the top of the stack.
+    Op_Not,         ///< Complement the top of the stack.
+    Op_LNot,        ///< Logical negation, with a result of type A.
+    Op_BinOp,       ///< Binary operator A, with a result of type B.
+    Op_IncDec,      ///< Increment or decrement Slots[A]; see IncDecFlags.
+    Op_Jump,        ///< Go to A.
+    Op_JumpIfFalse, ///< Pop a condition and go to A if it's false.
+    Op_JumpIfTrue,  ///< Pop a condition and go to A if it's true.
+    Op_Call,        ///< Call Callees[A] with the topmost B values.
+    Op_Return,      ///< Pop the return value and return it.
+    Op_Fail         ///< Give up.
+  };
+
+  enum IncDecFlags {
+    IDF_Decrement = 0x1,
+    IDF_CheckOverflow = 0x2
+  };
+
+  struct Instr {
+    Opcode Op;
+    unsigned A;
+    unsigned B;
+  };
+
+  struct Function {
+    /// \brief The integer type of each parameter; see encodeIntType.
+    SmallVector<unsigned, 4> ParamTypes;
+    unsigned NumSlots;
+    SmallVector<Instr, 32> Code;
+    SmallVector<APSInt, 4> Consts;
+    SmallVector<const FunctionDecl *, 2> Callees;
+  };
+
+  llvm::DenseMap<const FunctionDecl *, std::unique_ptr<Function>> Functions;
+};
+}
+
+namespace {
+typedef ConstexprBytecodeCache::Opcode BytecodeOp;
+typedef ConstexprBytecodeCache::Instr Instr;
+typedef ConstexprBytecodeCache::Function BytecodeFunction;
+}
+
+/// Integer types are encoded in instruction operands as their width followed
+/// by a bit saying whether they're unsigned.
+static unsigned encodeIntType(const ASTContext &Ctx, QualType T) {
+  return Ctx.getIntWidth(T) << 1 | T->isUnsignedIntegerOrEnumerationType();
+}
+
+static APSInt makeEncodedInt(uint64_t Value, unsigned Type) {
+  return APSInt(llvm::APInt(Type >> 1, Value), Type & 1);
+}
+
+namespace {
+/// Compiles the body of a single constexpr function to bytecode.
+class BytecodeCompiler {
+  const ASTContext &Ctx;
+  BytecodeFunction &Fn;
+
+  /// The slot holding each parameter and local variable.
+  llvm::DenseMap<const VarDecl *, unsigned> Slots;
+
+  /// The jumps to patch at the end of each enclosing loop.
+  struct LoopJumps {
+    SmallVector<unsigned, 4> Breaks, Continues;
+  };
+  SmallVector<LoopJumps, 4> Loops;
+
+  unsigned emit(BytecodeOp Op, unsigned A = 0, unsigned B = 0) {
+    Instr I = { Op, A, B };
+    Fn.Code.push_back(I);
+    return Fn.Code.size() - 1;
+  }
+  unsigned here() const { return Fn.Code.size(); }
+  void patch(unsigned Jump, unsigned Target) { Fn.Code[Jump].A = Target; }
+  void patchAll(ArrayRef<unsigned> Jumps, unsigned Target) {
+    for (unsigned J : Jumps)
+      patch(J, Target);
+  }
+
+  void emitConst(const APSInt &Value) {
+    Fn.Consts.push_back(Value);
+    emit(ConstexprBytecodeCache::Op_Const, Fn.Consts.size() - 1);
+  }
+
+  bool isIntType(QualType T) const {
+    return T->isIntegralOrEnumerationType() && !T.isVolatileQualified();
+  }
+
+  bool getSlot(const Expr *E, unsigned &Slot) const;
+  bool getMutableSlot(const Expr *E, unsigned &Slot) const;
+
+  bool compileStmt(const Stmt *S);
+  bool compileDecl(const Decl *D);
+  bool compileLoopBody(const Stmt *Body, LoopJumps &Jumps);
+  bool compileRValue(const Expr *E);
+  bool compileCast(const CastExpr *E);
+  bool compileCall(const CallExpr *E);
+  bool compileIncDec(const UnaryOperator *E);
+  bool compileDiscarded(const Expr *E);
+
+public:
+  BytecodeCompiler(const ASTContext &Ctx, BytecodeFunction &Fn)
+      : Ctx(Ctx), Fn(Fn) {}
+
+  bool compileFunction(const FunctionDecl *FD, const Stmt *Body);
+};
+}
+
+bool BytecodeCompiler::compileFunction(const FunctionDecl *FD,
+                                       const Stmt *Body) {
+  if (Ctx.getLangOpts().OpenCL || FD->isVariadic() ||
+      !isIntType(FD->getReturnType()))
     return false;
+  if (const CXXMethodDecl *MD = dyn_cast<CXXMethodDecl>(FD))
+    if (!MD->isStatic())
+      return false;
 
-  if (!Info.CheckCallLimit(CallLoc))
+  Fn.NumSlots = 0;
+  for (const ParmVarDecl *PVD : FD->parameters()) {
+    if (!isIntType(PVD->getType()))
+      return false;
+    Fn.ParamTypes.push_back(encodeIntType(Ctx, PVD->getType()));
+    Slots[PVD] = Fn.NumSlots++;
+  }
+
+  if (!compileStmt(Body))
+    return false;
+
+  // Flowing off the end of a function with a return value is an error.
+  emit(ConstexprBytecodeCache::Op_Fail);
+  return true;
+}
+
+bool BytecodeCompiler::getSlot(const Expr *E, unsigned &Slot) const {
+  const DeclRefExpr *DRE = dyn_cast<DeclRefExpr>(E->IgnoreParens());
+  if (!DRE || !isIntType(DRE->getType()))
+    return false;
+  const VarDecl *VD = dyn_cast<VarDecl>(DRE->getDecl());
+  if (!VD)
+    return false;
+  auto It = Slots.find(VD);
+  if (It == Slots.end())
+    return false;
+  Slot = It->second;
+  return true;
+}
+
+bool BytecodeCompiler::getMutableSlot(const Expr *E, unsigned &Slot) const {
+  // Modifying local state is a C++14 feature, and the AST evaluator refuses
+  // to do it in earlier modes.
+  return Ctx.getLangOpts().CPlusPlus14 && getSlot(E, Slot) &&
+         !E->getType().isConstQualified();
+}
+
+bool BytecodeCompiler::compileStmt(const Stmt *S) {
+  // The AST evaluator takes one step for each statement it evaluates.
+  emit(ConstexprBytecodeCache::Op_Step);
+
+  switch (S->getStmtClass()) {
+  default:
+    if (const Expr *E = dyn_cast<Expr>(S))
+      return compileDiscarded(E);
+    return false;
+
+  case Stmt::NullStmtClass:
+    return true;
+
+  case Stmt::CompoundStmtClass:
+    for (const Stmt *Child : cast<CompoundStmt>(S)->body())
+      if (!compileStmt(Child))
+        return false;
+    return true;
+
+  case Stmt::DeclStmtClass:
+    for (const Decl *D : cast<DeclStmt>(S)->decls())
+      if (!compileDecl(D))
+        return false;
+    return true;
+
+  case Stmt::ReturnStmtClass: {
+    const Expr *RetValue = cast<ReturnStmt>(S)->getRetValue();
+    if (!RetValue || !compileRValue(RetValue))
+      return false;
+    emit(ConstexprBytecodeCache::Op_Return);
+    return true;
+  }
+
+  case Stmt::IfStmtClass: {
+    const IfStmt *IS = cast<IfStmt>(S);
+    if (IS->getInit() || IS->getConditionVariable() ||
+        !compileRValue(IS->getCond()))
+      return false;
+    unsigned SkipThen = emit(ConstexprBytecodeCache::Op_JumpIfFalse);
+    if (!compileStmt(IS->getThen()))
+      return false;
+    if (const Stmt *Else = IS->getElse()) {
+      unsigned SkipElse = emit(ConstexprBytecodeCache::Op_Jump);
+      patch(SkipThen, here());
+      if (!compileStmt(Else))
+        return false;
+      patch(SkipElse, here());
+    } else {
+      patch(SkipThen, here());
+    }
+    return true;
+  }
+
+  case Stmt::WhileStmtClass: {
+    const WhileStmt *WS = cast<WhileStmt>(S);
+    if (WS->getConditionVariable())
+      return false;
+    unsigned Cond = here();
+    if (!compileRValue(WS->getCond()))
+      return false;
+    unsigned Exit = emit(ConstexprBytecodeCache::Op_JumpIfFalse);
+    LoopJumps Jumps;
+    if (!compileLoopBody(WS->getBody(), Jumps))
+      return false;
+    emit(ConstexprBytecodeCache::Op_Jump, Cond);
+    patch(Exit, here());
+    patchAll(Jumps.Breaks, here());
+    patchAll(Jumps.Continues, Cond);
+    return true;
+  }
+
+  case Stmt::DoStmtClass: {
+    const DoStmt *DS = cast<DoStmt>(S);
+    unsigned Top = here();
+    LoopJumps Jumps;
+    if (!compileLoopBody(DS->getBody(), Jumps))
+      return false;
+    patchAll(Jumps.Continues, here());
+    if (!compileRValue(DS->getCond()))
+      return false;
+    emit(ConstexprBytecodeCache::Op_JumpIfTrue, Top);
+    patchAll(Jumps.Breaks, here());
+    return true;
+  }
+
+  case Stmt::ForStmtClass: {
+    const ForStmt *FS = cast<ForStmt>(S);
+    if (FS->getConditionVariable())
+      return false;
+    if (FS->getInit() && !compileStmt(FS->getInit()))
+      return false;
+    unsigned Cond = here();
+    unsigned Exit = ~0U;
+    if (FS->getCond()) {
+      if (!compileRValue(FS->getCond()))
+        return false;
+      Exit = emit(ConstexprBytecodeCache::Op_JumpIfFalse);
+    }
+    LoopJumps Jumps;
+    if (!compileLoopBody(FS->getBody(), Jumps))
+      return false;
+    patchAll(Jumps.Continues, here());
+    if (FS->getInc() && !compileDiscarded(FS->getInc()))
+      return false;
+    emit(ConstexprBytecodeCache::Op_Jump, Cond);
+    if (Exit != ~0U)
+      patch(Exit, here());
+    patchAll(Jumps.Breaks, here());
+    return true;
+  }
+
+  case Stmt::BreakStmtClass:
+    if (Loops.empty())
+      return false;
+    Loops.back().Breaks.push_back(emit(ConstexprBytecodeCache::Op_Jump));
+    return true;
+
+  case Stmt::ContinueStmtClass:
+    if (Loops.empty())
+      return false;
+    Loops.back().Continues.push_back(emit(ConstexprBytecodeCache::Op_Jump));
+    return true;
+  }
+}
+
+bool BytecodeCompiler::compileLoopBody(const Stmt *Body, LoopJumps &Jumps) {
+  Loops.push_back(LoopJumps());
+  bool Success = compileStmt(Body);
+  Jumps = Loops.pop_back_val();
+  return Success;
+}
+
+bool BytecodeCompiler::compileDecl(const Decl *D) {
+  const VarDecl *VD = dyn_cast<VarDecl>(D);
+  if (!VD)
+    return true;
+
+  const Expr *Init = VD->getInit();
+  if (!VD->hasLocalStorage() || !isIntType(VD->getType()) || !Init ||
+      Init->isValueDependent() || !compileRValue(Init))
+    return false;
+  unsigned Slot = Fn.NumSlots++;
+  Slots[VD] = Slot;
+  emit(ConstexprBytecodeCache::Op_Store, Slot);
+  return true;
+}
+
+bool BytecodeCompiler::compileRValue(const Expr *E) {
+  E = E->IgnoreParens();
+  if (!E->isRValue() || !isIntType(E->getType()))
+    return false;
+  QualType T = E->getType();
+
+  switch (E->getStmtClass()) {
+  default:
+    return false;
+
+  case Stmt::IntegerLiteralClass:
+    emitConst(APSInt(cast<IntegerLiteral>(E)->getValue(),
+                     T->isUnsignedIntegerOrEnumerationType()));
+    return true;
+
+  case Stmt::CharacterLiteralClass:
+    emitConst(Ctx.MakeIntValue(cast<CharacterLiteral>(E)->getValue(), T));
+    return true;
+
+  case Stmt::CXXBoolLiteralExprClass:
+    emitConst(Ctx.MakeIntValue(cast<CXXBoolLiteralExpr>(E)->getValue(), T));
+    return true;
+
+  case Stmt::DeclRefExprClass: {
+    const EnumConstantDecl *ECD =
+        dyn_cast<EnumConstantDecl>(cast<DeclRefExpr>(E)->getDecl());
+    if (!ECD)
+      return false;
+    APSInt Value = ECD->getInitVal();
+    Value = Value.extOrTrunc(Ctx.getIntWidth(T));
+    Value.setIsUnsigned(T->isUnsignedIntegerOrEnumerationType());
+    emitConst(Value);
+    return true;
+  }
+
+  case Stmt::ImplicitCastExprClass:
+  case Stmt::CStyleCastExprClass:
+  case Stmt::CXXFunctionalCastExprClass:
+  case Stmt::CXXStaticCastExprClass:
+    return compileCast(cast<CastExpr>(E));
+
+  case Stmt::CXXDefaultArgExprClass:
+    return compileRValue(cast<CXXDefaultArgExpr>(E)->getExpr());
+
+  case Stmt::InitListExprClass: {
+    const InitListExpr *ILE = cast<InitListExpr>(E);
+    if (ILE->getNumInits() == 0) {
+      emitConst(Ctx.MakeIntValue(0, T));
+      return true;
+    }
+    return ILE->getNumInits() == 1 && compileRValue(ILE->getInit(0));
+  }
+
+  case Stmt::UnaryOperatorClass: {
+    const UnaryOperator *UO = cast<UnaryOperator>(E);
+    switch (UO->getOpcode()) {
+    case UO_Extension:
+    case UO_Plus:
+      return compileRValue(UO->getSubExpr());
+    case UO_Minus:
+      if (!compileRValue(UO->getSubExpr()))
+        return false;
+      emit(ConstexprBytecodeCache::Op_Neg);
+      return true;
+    case UO_Not:
+      if (!compileRValue(UO->getSubExpr()))
+        return false;
+      emit(ConstexprBytecodeCache::Op_Not);
+      return true;
+    case UO_LNot:
+      if (!compileRValue(UO->getSubExpr()))
+        return false;
+      emit(ConstexprBytecodeCache::Op_LNot, encodeIntType(Ctx, T));
+      return true;
+    case UO_PostInc:
+    case UO_PostDec: {
+      // Push the old value, then update the variable.
+      unsigned Slot;
+      if (!getSlot(UO->getSubExpr(), Slot))
+        return false;
+      emit(ConstexprBytecodeCache::Op_Load, Slot);
+      return compileIncDec(UO);
+    }
+    default:
+      return false;
+    }
+  }
+
+  case Stmt::BinaryOperatorClass: {
+    const BinaryOperator *BO = cast<BinaryOperator>(E);
+    BinaryOperatorKind Opc = BO->getOpcode();
+    if (Opc == BO_Comma)
+      return compileDiscarded(BO->getLHS()) && compileRValue(BO->getRHS());
+
+    if (Opc == BO_LAnd || Opc == BO_LOr) {
+      // Evaluate the RHS only if the LHS doesn't determine the result.
+      bool IsAnd = Opc == BO_LAnd;
+      BytecodeOp ShortCircuit = IsAnd ? ConstexprBytecodeCache::Op_JumpIfFalse
+                                  : ConstexprBytecodeCache::Op_JumpIfTrue;
+      if (!compileRValue(BO->getLHS()))
+        return false;
+      unsigned SkipLHS = emit(ShortCircuit);
+      if (!compileRValue(BO->getRHS()))
+        return false;
+      unsigned SkipRHS = emit(ShortCircuit);
+      emitConst(Ctx.MakeIntValue(IsAnd, T));
+      unsigned Done = emit(ConstexprBytecodeCache::Op_Jump);
+      patch(SkipLHS, here());
+      patch(SkipRHS, here());
+      emitConst(Ctx.MakeIntValue(!IsAnd, T));
+      patch(Done, here());
+      return true;
+    }
+
+    if (BO->isAssignmentOp() || BO->isPtrMemOp() ||
+        !compileRValue(BO->getLHS()) || !compileRValue(BO->getRHS()))
+      return false;
+    emit(ConstexprBytecodeCache::Op_BinOp, Opc, encodeIntType(Ctx, T));
+    return true;
+  }
+
+  case Stmt::ConditionalOperatorClass: {
+    const ConditionalOperator *CO = cast<ConditionalOperator>(E);
+    if (!compileRValue(CO->getCond()))
+      return false;
+    unsigned SkipTrue = emit(ConstexprBytecodeCache::Op_JumpIfFalse);
+    if (!compileRValue(CO->getTrueExpr()))
+      return false;
+    unsigned SkipFalse = emit(ConstexprBytecodeCache::Op_Jump);
+    patch(SkipTrue, here());
+    if (!compileRValue(CO->getFalseExpr()))
+      return false;
+    patch(SkipFalse, here());
+    return true;
+  }
+
+  case Stmt::CallExprClass:
+    return compileCall(cast<CallExpr>(E));
+  }
+}
+
+bool BytecodeCompiler::compileCast(const CastExpr *E) {
+  const Expr *SubExpr = E->getSubExpr();
+  QualType T = E->getType();
+
+  switch (E->getCastKind()) {
+  default:
+    return false;
+
+  case CK_LValueToRValue: {
+    unsigned Slot;
+    if (!getSlot(SubExpr, Slot))
+      return false;
+    emit(ConstexprBytecodeCache::Op_Load, Slot);
+    return true;
+  }
+
+  case CK_NoOp:
+    return compileRValue(SubExpr);
+
+  case CK_IntegralCast:
+    if (!compileRValue(SubExpr))
+      return false;
+    emit(ConstexprBytecodeCache::Op_Cast, encodeIntType(Ctx, T));
+    return true;
+
+  case CK_IntegralToBoolean:
+    if (!compileRValue(SubExpr))
+      return false;
+    emit(ConstexprBytecodeCache::Op_ToBool, encodeIntType(Ctx, T));
+    return true;
+  }
+}
+
+bool BytecodeCompiler::compileCall(const CallExpr *E) {
+  // Only direct calls to functions that aren't builtins; everything else
+  // takes the general path in handleCallExpr.
+  const ImplicitCastExpr *Callee =
+      dyn_cast<ImplicitCastExpr>(E->getCallee()->IgnoreParens());
+  if (!Callee || Callee->getCastKind() != CK_FunctionToPointerDecay)
+    return false;
+  const DeclRefExpr *DRE =
+      dyn_cast<DeclRefExpr>(Callee->getSubExpr()->IgnoreParens());
+  if (!DRE)
+    return false;
+  const FunctionDecl *FD = dyn_cast<FunctionDecl>(DRE->getDecl());
+  if (!FD || FD->getBuiltinID() || FD->isVariadic() ||
+      FD->getNumParams() != E->getNumArgs())
+    return false;
+  if (const CXXMethodDecl *MD = dyn_cast<CXXMethodDecl>(FD))
+    if (!MD->isStatic())
+      return false;
+
+  for (unsigned I = 0, N = E->getNumArgs(); I != N; ++I) {
+    QualType ParamType = FD->getParamDecl(I)->getType();
+    if (!Ctx.hasSameUnqualifiedType(E->getArg(I)->getType(), ParamType) ||
+        !compileRValue(E->getArg(I)))
+      return false;
+  }
+
+  Fn.Callees.push_back(FD);
+  emit(ConstexprBytecodeCache::Op_Call, Fn.Callees.size() - 1,
+       E->getNumArgs());
+  return true;
+}
+
+bool BytecodeCompiler::compileIncDec(const UnaryOperator *E) {
+  // bool increments are special; leave them to the AST evaluator.
+  QualType T = E->getSubExpr()->getType();
+  unsigned Slot;
+  if (!getMutableSlot(E->getSubExpr(), Slot) || !T->isIntegerType() ||
+      T->isBooleanType())
     return false;
 
+  unsigned Flags = 0;
+  if (E->isDecrementOp())
+    Flags |= ConstexprBytecodeCache::IDF_Decrement;
+  if (T->isSignedIntegerType() &&
+      Ctx.getIntWidth(T) >= Ctx.getIntWidth(Ctx.IntTy))
+    Flags |= ConstexprBytecodeCache::IDF_CheckOverflow;
+  emit(ConstexprBytecodeCache::Op_IncDec, Slot, Flags);
+  return true;
+}
+
+bool BytecodeCompiler::compileDiscarded(const Expr *E) {
+  E = E->IgnoreParens();
+  unsigned Slot;
+
+  if (const BinaryOperator *BO = dyn_cast<BinaryOperator>(E)) {
+    if (BO->getOpcode() == BO_Comma)
+      return compileDiscarded(BO->getLHS()) && compileDiscarded(BO->getRHS());
+
+    if (BO->getOpcode() == BO_Assign) {
+      if (!getMutableSlot(BO->getLHS(), Slot) || !compileRValue(BO->getRHS()))
+        return false;
+      emit(ConstexprBytecodeCache::Op_Store, Slot);
+      return true;
+    }
+
+    if (const CompoundAssignOperator *CAO =
+            dyn_cast<CompoundAssignOperator>(BO)) {
+      QualType LHSType = CAO->getLHS()->getType();
+      QualType ComputationType = CAO->getComputationLHSType();
+      if (!getMutableSlot(CAO->getLHS(), Slot) ||
+          !LHSType->isIntegerType() || !isIntType(ComputationType) ||
+          !isIntType(CAO->getComputationResultType()))
+        return false;
+
+      // The right-hand side is evaluated before the stored value is read, in
+      // case it modifies the same variable.
+      if (!compileRValue(CAO->getRHS()))
+        return false;
+      emit(ConstexprBytecodeCache::Op_Load, Slot);
+      emit(ConstexprBytecodeCache::Op_Cast,
+           encodeIntType(Ctx, ComputationType));
+      emit(ConstexprBytecodeCache::Op_Swap);
+      emit(ConstexprBytecodeCache::Op_BinOp,
+           BinaryOperator::getOpForCompoundAssignment(CAO->getOpcode()),
+           encodeIntType(Ctx, CAO->getComputationResultType()));
+      emit(ConstexprBytecodeCache::Op_Cast, encodeIntType(Ctx, LHSType));
+      emit(ConstexprBytecodeCache::Op_Store, Slot);
+      return true;
+    }
+  }
+
+  if (const UnaryOperator *UO = dyn_cast<UnaryOperator>(E))
+    if (UO->isIncrementDecrementOp())
+      return compileIncDec(UO);
+
+  // Naming a variable without reading it does nothing.
+  if (E->isGLValue())
+    return getSlot(E, Slot);
+
+  if (!compileRValue(E))
+    return false;
+  emit(ConstexprBytecodeCache::Op_Pop);
+  return true;
+}
+
+namespace {
+/// Runs bytecode compiled by BytecodeCompiler.
+class BytecodeInterpreter {
+  EvalInfo &Info;
+  ConstexprBytecodeCache &Cache;
+
+  /// The evaluation steps left. This is only copied back to the EvalInfo if
+  /// the whole call succeeds, so that the AST evaluator starts afresh if we
+  /// give up.
+  unsigned StepsLeft;
+
+  /// The deepest call frame that has been run, counted from the bottom of the
+  /// AST evaluator's call stack.
+  unsigned MaxDepth;
+
+  const BytecodeFunction *getFunction(const FunctionDecl *FD,
+                                      const Stmt *Body);
+  bool run(const BytecodeFunction &Fn, SmallVectorImpl<APSInt> &Slots,
+           unsigned Depth, APSInt &Result);
+
+public:
+  BytecodeInterpreter(EvalInfo &Info, ConstexprBytecodeCache &Cache)
+      : Info(Info), Cache(Cache), StepsLeft(Info.StepsLeft), MaxDepth(0) {}
+
+  bool call(const FunctionDecl *Callee, const Stmt *Body,
+            ArrayRef<APValue> Args, APValue &Result);
+};
+}
+
+const BytecodeFunction *
+BytecodeInterpreter::getFunction(const FunctionDecl *FD, const Stmt *Body) {
+  auto It = Cache.Functions.find(FD);
+  if (It != Cache.Functions.end())
+    return It->second.get();
+
+  std::unique_ptr<BytecodeFunction> Fn(new BytecodeFunction);
+  if (!BytecodeCompiler(Info.Ctx, *Fn).compileFunction(FD, Body))
+    Fn.reset();
+  return (Cache.Functions[FD] = std::move(Fn)).get();
+}
+
+/// Perform an integer operation that might overflow, in the same way as
+/// CheckedIntArithmetic. Returns false on overflow.
+template<typename Operation>
+static bool interpCheckedIntArithmetic(APSInt &LHS, const APSInt &RHS,
+                                       unsigned BitWidth, Operation Op) {
+  if (LHS.isUnsigned()) {
+    LHS = Op(LHS, RHS);
+    return true;
+  }
+
+  APSInt Value(Op(LHS.extend(BitWidth), RHS.extend(BitWidth)), false);
+  APSInt Result = Value.trunc(LHS.getBitWidth());
+  if (Result.extend(BitWidth) != Value)
+    return false;
+  LHS = Result;
+  return true;
+}
+
+/// Perform a binary integer operation in place on \p LHS, in the same way as
+/// handleIntIntBinOp. Returns false wherever handleIntIntBinOp would produce
+/// a diagnostic.
+static bool interpIntIntBinOp(BinaryOperatorKind Opc, unsigned ResultType,
+                              APSInt &LHS, const APSInt &RHS) {
+  switch (Opc) {
+  default:
+    return false;
+  case BO_Mul:
+    return interpCheckedIntArithmetic(LHS, RHS, LHS.getBitWidth() * 2,
+                                      std::multiplies<APSInt>());
+  case BO_Add:
+    return interpCheckedIntArithmetic(LHS, RHS, LHS.getBitWidth() + 1,
+                                      std::plus<APSInt>());
+  case BO_Sub:
+    return interpCheckedIntArithmetic(LHS, RHS, LHS.getBitWidth() + 1,
+                                      std::minus<APSInt>());
+  case BO_And: LHS = LHS & RHS; return true;
+  case BO_Xor: LHS = LHS ^ RHS; return true;
+  case BO_Or:  LHS = LHS | RHS; return true;
+  case BO_Div:
+  case BO_Rem:
+    if (RHS == 0 ||
+        (RHS.isNegative() && RHS.isAllOnesValue() && LHS.isSigned() &&
+         LHS.isMinSignedValue()))
+      return false;
+    LHS = (Opc == BO_Rem ? LHS % RHS : LHS / RHS);
+    return true;
+  case BO_Shl:
+  case BO_Shr: {
+    if (RHS.isSigned() && RHS.isNegative())
+      return false;
+    unsigned SA = (unsigned) RHS.getLimitedValue(LHS.getBitWidth()-1);
+    if (SA != RHS)
+      return false;
+    if (Opc == BO_Shr) {
+      LHS = LHS >> SA;
+      return true;
+    }
+    if (LHS.isSigned() && (LHS.isNegative() || LHS.countLeadingZeros() < SA))
+      return false;
+    LHS = LHS << SA;
+    return true;
+  }
+  case BO_LT: LHS = makeEncodedInt(LHS < RHS, ResultType); return true;
+  case BO_GT: LHS = makeEncodedInt(LHS > RHS, ResultType); return true;
+  case BO_LE: LHS = makeEncodedInt(LHS <= RHS, ResultType); return true;
+  case BO_GE: LHS = makeEncodedInt(LHS >= RHS, ResultType); return true;
+  case BO_EQ: LHS = makeEncodedInt(LHS == RHS, ResultType); return true;
+  case BO_NE: LHS = makeEncodedInt(LHS != RHS, ResultType); return true;
+  }
+}
+
+bool BytecodeInterpreter::run(const BytecodeFunction &Fn,
+                              SmallVectorImpl<APSInt> &Slots, unsigned Depth,
+                              APSInt &Result) {
+  MaxDepth = std::max(MaxDepth, Depth);
+  SmallVector<APSInt, 8> Stack;
+  for (unsigned PC = 0;; ) {
+    const Instr &I = Fn.Code[PC++];
+    switch (I.Op) {
+    case ConstexprBytecodeCache::Op_Step:
+      if (!StepsLeft)
+        return false;
+      --StepsLeft;
+      break;
+
+    case ConstexprBytecodeCache::Op_Const:
+      Stack.push_back(Fn.Consts[I.A]);
+      break;
+
+    case ConstexprBytecodeCache::Op_Load:
+      Stack.push_back(Slots[I.A]);
+      break;
+
+    case ConstexprBytecodeCache::Op_Store:
+      Slots[I.A] = Stack.pop_back_val();
+      break;
+
+    case ConstexprBytecodeCache::Op_Pop:
+      Stack.pop_back();
+      break;
+
+    case ConstexprBytecodeCache::Op_Swap:
+      std::swap(Stack[Stack.size() - 1], Stack[Stack.size() - 2]);
+      break;
+
+    case ConstexprBytecodeCache::Op_Cast: {
+      APSInt &Value = Stack.back();
+      Value = Value.extOrTrunc(I.A >> 1);
+      Value.setIsUnsigned(I.A & 1);
+      break;
+    }
+
+    case ConstexprBytecodeCache::Op_ToBool:
+      Stack.back() = makeEncodedInt(Stack.back().getBoolValue(), I.A);
+      break;
+
+    case ConstexprBytecodeCache::Op_Neg: {
+      APSInt &Value = Stack.back();
+      if (Value.isSigned() && Value.isMinSignedValue())
+        return false;
+      Value = -Value;
+      break;
+    }
+
+    case ConstexprBytecodeCache::Op_Not:
+      Stack.back() = ~Stack.back();
+      break;
+
+    case ConstexprBytecodeCache::Op_LNot:
+      Stack.back() = makeEncodedInt(!Stack.back().getBoolValue(), I.A);
+      break;
+
+    case ConstexprBytecodeCache::Op_BinOp: {
+      APSInt RHS = Stack.pop_back_val();
+      if (!interpIntIntBinOp(static_cast<BinaryOperatorKind>(I.A), I.B,
+                             Stack.back(), RHS))
+        return false;
+      break;
+    }
+
+    case ConstexprBytecodeCache::Op_IncDec: {
+      // As in IncDecSubobjectHandler, overflow is only an error for types
+      // that aren't promoted.
+      APSInt &Value = Slots[I.A];
+      bool WasNegative = Value.isNegative();
+      bool CheckOverflow = I.B & ConstexprBytecodeCache::IDF_CheckOverflow;
+      if (I.B & ConstexprBytecodeCache::IDF_Decrement) {
+        --Value;
+        if (CheckOverflow && WasNegative && !Value.isNegative())
+          return false;
+      } else {
+        ++Value;
+        if (CheckOverflow && !WasNegative && Value.isNegative())
+          return false;
+      }
+      break;
+    }
+
+    case ConstexprBytecodeCache::Op_Jump:
+      PC = I.A;
+      break;
+
+    case ConstexprBytecodeCache::Op_JumpIfFalse:
+      if (!Stack.pop_back_val().getBoolValue())
+        PC = I.A;
+      break;
+
+    case ConstexprBytecodeCache::Op_JumpIfTrue:
+      if (Stack.pop_back_val().getBoolValue())
+        PC = I.A;
+      break;
+
+    case ConstexprBytecodeCache::Op_Call: {
+      // Mirror CheckConstexprFunction and CheckCallLimit.
+      const FunctionDecl *FD = Fn.Callees[I.A];
+      const FunctionDecl *Definition = nullptr;
+      const Stmt *Body = FD->getBody(Definition);
+      if (FD->isInvalidDecl() || !Definition || !Definition->isConstexpr() ||
+          Definition->isInvalidDecl() || !Body ||
+          Depth > Info.getLangOpts().ConstexprCallDepth)
+        return false;
+
+      const BytecodeFunction *Callee = getFunction(Definition, Body);
+      if (!Callee || Callee->ParamTypes.size() != I.B)
+        return false;
+
+      SmallVector<APSInt, 8> CalleeSlots(Callee->NumSlots);
+      std::move(Stack.end() - I.B, Stack.end(), CalleeSlots.begin());
+      Stack.erase(Stack.end() - I.B, Stack.end());
+
+      APSInt Value;
+      if (!run(*Callee, CalleeSlots, Depth + 1, Value))
+        return false;
+      Stack.push_back(std::move(Value));
+      break;
+    }
+
+    case ConstexprBytecodeCache::Op_Return:
+      Result = Stack.pop_back_val();
+      return true;
+
+    case ConstexprBytecodeCache::Op_Fail:
+      return false;
+    }
+  }
+}
+
+bool BytecodeInterpreter::call(const FunctionDecl *Callee, const Stmt *Body,
+                               ArrayRef<APValue> Args, APValue &Result) {
+  // Reading local state fails after an unmodeled side effect, and writing it
+  // fails while speculatively evaluating; leave those to the AST evaluator.
+  if (Info.checkingPotentialConstantExpression() ||
+      Info.EvalStatus.HasSideEffects || Info.IsSpeculativelyEvaluating)
+    return false;
+
+  const BytecodeFunction *Fn = getFunction(Callee, Body);
+  if (!Fn || Fn->ParamTypes.size() != Args.size())
+    return false;
+
+  SmallVector<APSInt, 8> Slots(Fn->NumSlots);
+  for (unsigned I = 0, N = Args.size(); I != N; ++I) {
+    if (!Args[I].isInt() ||
+        encodeIntType(Info.Ctx, Callee->getParamDecl(I)->getType()) !=
+            (Args[I].getInt().getBitWidth() << 1 |
+             Args[I].getInt().isUnsigned()))
+      return false;
+    Slots[I] = Args[I].getInt();
+  }
+
+  // The call frame will be one deeper than the current one.
+  APSInt Value;
+  if (!run(*Fn, Slots, Info.CallStackDepth + 1, Value))
+    return false;
+
+  Info.StepsLeft = StepsLeft;
+  Info.MaxCallStackDepth = std::max(Info.MaxCallStackDepth, MaxDepth);
+  Result = APValue(Value);
+  return true;
+}
+
+static void destroyConstexprBytecodeCache(void *Cache) {
+  delete static_cast<ConstexprBytecodeCache *>(Cache);
+}
+
+/// Try to evaluate a call to a constexpr function with the bytecode
+/// interpreter. Returns false, without producing any diagnostics, if the
+/// call should be evaluated by walking the AST instead.
+static bool interpretFunctionCall(EvalInfo &Info, const FunctionDecl *Callee,
+                                  const Stmt *Body, ArrayRef<APValue> Args,
+                                  APValue &Result) {
+  ConstexprBytecodeCache *Cache = Info.Ctx.getConstexprBytecodeCache();
+  if (!Cache) {
+    Cache = new ConstexprBytecodeCache;
+    Info.Ctx.setConstexprBytecodeCache(Cache);
+    Info.Ctx.AddDeallocation(destroyConstexprBytecodeCache, Cache);
+  }
+  return BytecodeInterpreter(Info, *Cache).call(Callee, Body, Args, Result);
+}
+
+//===----------------------------------------------------------------------===//
+// Call memoization
+//===----------------------------------------------------------------------===//
+//
+// A call to a constexpr function that doesn't depend on anything but the
+// values of its arguments will produce the same value every time it is
+// evaluated, so we remember its result in the ASTContext and reuse it for
+// later calls to the same function with the same arguments. Calls are only
+// remembered if they finished without any diagnostic, without side-effects,
+// and without looking at the in-flight value of a variable that is being
+// initialized. The steps and call depth a call used are remembered with it,
+// so reusing its result is still subject to -fconstexpr-steps and
+// -fconstexpr-depth.
+
+namespace clang {
+/// \brief The memoized results of constexpr function calls, keyed by the
+/// callee, the evaluation mode and the values of the arguments.
+class ConstexprCallCache {
+public:
+  struct Entry {
+    APValue Result;
+
+    /// The number of evaluation steps that the call took.
+    unsigned Steps;
+
+    /// The number of call frames the call stack grew by during the call,
+    /// including that of the call itself.
+    unsigned Depth;
+  };
+
+  llvm::StringMap<Entry> Entries;
+};
+}
+
+static void destroyConstexprCallCache(void *Cache) {
+  delete static_cast<ConstexprCallCache *>(Cache);
+}
+
+static void addKeyBytes(SmallVectorImpl<char> &Key, const void *Data,
+                        size_t Size) {
+  const char *Bytes = static_cast<const char *>(Data);
+  Key.append(Bytes, Bytes + Size);
+}
+
+template<typename T>
+static void addKey(SmallVectorImpl<char> &Key, const T &Value) {
+  addKeyBytes(Key, &Value, sizeof(T));
+}
+
+static void addKey(SmallVectorImpl<char> &Key, const APInt &Value) {
+  addKey(Key, Value.getBitWidth());
+  addKeyBytes(Key, Value.getRawData(), Value.getNumWords() * sizeof(uint64_t));
+}
+
+/// Add the value of an argument to a memoization key. Returns false if calls
+/// taking this argument can't be memoized.
+static bool addArgKey(EvalInfo &Info, SmallVectorImpl<char> &Key,
+                      const APValue &Arg) {
+  addKey(Key, Arg.getKind());
+  switch (Arg.getKind()) {
+  case APValue::Int:
+    addKey(Key, Arg.getInt().isUnsigned());
+    addKey(Key, static_cast<const APInt &>(Arg.getInt()));
+    return true;
+
+  case APValue::Float:
+    addKey(Key, &Arg.getFloat().getSemantics());
+    addKey(Key, Arg.getFloat().bitcastToAPInt());
+    return true;
+
+  case APValue::LValue: {
+    // Pointers are keyed by the identity of the object they point into, so
+    // they must point into an object that can't change: a string literal or
+    // a constexpr variable, other than one that is still being initialized.
+    APValue::LValueBase Base = Arg.getLValueBase();
+    if (Arg.getLValueCallIndex() || !Arg.hasLValuePath() ||
+        (Base && Base == Info.EvaluatingDecl))
+      return false;
+    QualType Type;
+    if (const ValueDecl *VD = Base.dyn_cast<const ValueDecl*>()) {
+      const VarDecl *Var = dyn_cast<VarDecl>(VD);
+      if (!Var || !Var->isConstexpr())
+        return false;
+      Type = getType(Base);
+    } else if (const Expr *E = Base.dyn_cast<const Expr*>()) {
+      if (!isa<StringLiteral>(E))
+        return false;
+      Type = getType(Base);
+    }
+    addKey(Key, Base.getOpaqueValue());
+    addKey(Key, Arg.getLValueOffset().getQuantity());
+    addKey(Key, Arg.isLValueOnePastTheEnd());
+
+    // Only array indices are supported in the designator; the other kinds of
+    // path entry can't be told apart without walking the class hierarchy.
+    ArrayRef<APValue::LValuePathEntry> Path = Arg.getLValuePath();
+    for (const APValue::LValuePathEntry &Entry : Path) {
+      const ArrayType *AT =
+          Type.isNull() ? nullptr : Info.Ctx.getAsArrayType(Type);
+      if (!AT)
+        return false;
+      addKey(Key, Entry.ArrayIndex);
+      Type = AT->getElementType();
+    }
+    return true;
+  }
+
+  default:
+    return false;
+  }
+}
+
+namespace {
+/// Reuses or records the result of a single constexpr function call.
+class MemoizedCall {
+  EvalInfo &Info;
+  SmallString<64> Key;
+  bool Memoizable;
+
+  unsigned OldNumDiagnosed;
+  unsigned OldStepsLeft;
+  unsigned OldMaxCallStackDepth;
+  bool OldUsedEvaluatingDecl;
+  bool OldHasUndefinedBehavior;
+
+public:
+  MemoizedCall(EvalInfo &Info, const FunctionDecl *Callee, const LValue *This,
+               ArrayRef<APValue> Args);
+  ~MemoizedCall();
+
+  /// Produce the result of an identical earlier call, if there was one and it
+  /// would fit within the current limits.
+  bool lookup(APValue &Result);
+
+  /// Record the result of the call, if it depended only on the arguments.
+  void store(const APValue &Result);
+};
+}
+
+MemoizedCall::MemoizedCall(EvalInfo &Info, const FunctionDecl *Callee,
+                           const LValue *This, ArrayRef<APValue> Args)
+    : Info(Info), Memoizable(false) {
+  switch (Info.EvalMode) {
+  case EvalInfo::EM_ConstantExpression:
+  case EvalInfo::EM_ConstantExpressionUnevaluated:
+  case EvalInfo::EM_ConstantFold:
+  case EvalInfo::EM_IgnoreSideEffects:
+    break;
+  case EvalInfo::EM_PotentialConstantExpression:
+  case EvalInfo::EM_PotentialConstantExpressionUnevaluated:
+  case EvalInfo::EM_EvaluateForOverflow:
+  case EvalInfo::EM_DesignatorFold:
+    return;
+  }
+
+  // Member functions and the call operators of lambdas can depend on the
+  // state of the object they are called on, including its captures.
+  const CXXMethodDecl *MD = dyn_cast<CXXMethodDecl>(Callee);
+  if (This || (MD && MD->getParent()->isLambda()) ||
+      Info.IsSpeculativelyEvaluating || Info.EvalStatus.HasSideEffects)
+    return;
+
+  addKey(Key, Callee);
+  addKey(Key, Info.EvalMode);
+  for (const APValue &Arg : Args)
+    if (!addArgKey(Info, Key, Arg))
+      return;
+
+  Memoizable = true;
+  ++ASTContext::NumMemoizableConstexprCalls;
+  OldNumDiagnosed = Info.NumDiagnosed;
+  OldStepsLeft = Info.StepsLeft;
+  OldMaxCallStackDepth = Info.MaxCallStackDepth;
+  OldUsedEvaluatingDecl = Info.UsedEvaluatingDecl;
+  OldHasUndefinedBehavior = Info.EvalStatus.HasUndefinedBehavior;
+  Info.MaxCallStackDepth = Info.CallStackDepth;
+  Info.UsedEvaluatingDecl = false;
+}
+
+MemoizedCall::~MemoizedCall() {
+  if (!Memoizable)
+    return;
+  Info.MaxCallStackDepth = std::max(Info.MaxCallStackDepth,
+                                    OldMaxCallStackDepth);
+  Info.UsedEvaluatingDecl |= OldUsedEvaluatingDecl;
+}
+
+bool MemoizedCall::lookup(APValue &Result) {
+  ConstexprCallCache *Cache = Info.Ctx.getConstexprCallCache();
+  if (!Memoizable || !Cache)
+    return false;
+  auto It = Cache->Entries.find(Key);
+  if (It == Cache->Entries.end())
+    return false;
+
+  // If the call would now hit a limit, evaluate it again to diagnose that.
+  const ConstexprCallCache::Entry &Memo = It->second;
+  if (Memo.Steps > Info.StepsLeft ||
+      Info.CallStackDepth + Memo.Depth - 1 >
+          Info.getLangOpts().ConstexprCallDepth)
+    return false;
+
+  ++ASTContext::NumMemoizedConstexprCallsReused;
+  Info.StepsLeft -= Memo.Steps;
+  Info.MaxCallStackDepth = Info.CallStackDepth + Memo.Depth;
+  Result = Memo.Result;
+  return true;
+}
+
+void MemoizedCall::store(const APValue &Result) {
+  if (!Memoizable || !(Result.isInt() || Result.isFloat()) ||
+      Info.NumDiagnosed != OldNumDiagnosed || Info.UsedEvaluatingDecl ||
+      Info.EvalStatus.HasSideEffects ||
+      Info.EvalStatus.HasUndefinedBehavior != OldHasUndefinedBehavior)
+    return;
+
+  ConstexprCallCache *Cache = Info.Ctx.getConstexprCallCache();
+  if (!Cache) {
+    Cache = new ConstexprCallCache;
+    Info.Ctx.setConstexprCallCache(Cache);
+    Info.Ctx.AddDeallocation(destroyConstexprCallCache, Cache);
+  }
+  ConstexprCallCache::Entry &Memo = Cache->Entries[Key];
+  Memo.Result = Result;
+  Memo.Steps = OldStepsLeft - Info.StepsLeft;
+  Memo.Depth = Info.MaxCallStackDepth - Info.CallStackDepth;
+}
+
+/// Evaluate the body of a function call, once its arguments are known.
+static bool evaluateCallBody(SourceLocation CallLoc,
+                             const FunctionDecl *Callee, const LValue *This,
+                             ArrayRef<const Expr*> Args, ArgVector &ArgValues,
+                             const Stmt *Body, EvalInfo &Info, APValue &Result,
+                             const LValue *ResultSlot) {
+  if (Info.getLangOpts().ConstexprInterpreter && !This &&
+      interpretFunctionCall(Info, Callee, Body, ArgValues, Result))
+    return true;
+
   CallStackFrame Frame(Info, CallLoc, Callee, This, ArgValues.data());
 
   // For a trivial copy or move assignment, perform an APValue copy. This is
@@ -3972,6 +5164,31 @@ static bool HandleFunctionCall(SourceLocation CallLoc,
   return ESR == ESR_Returned;
 }
 
+/// Evaluate a function call.
+static bool HandleFunctionCall(SourceLocation CallLoc,
+                               const FunctionDecl *Callee, const LValue *This,
+                               ArrayRef<const Expr*> Args, const Stmt *Body,
+                               EvalInfo &Info, APValue &Result,
+                               const LValue *ResultSlot) {
+  ArgVector ArgValues(Args.size());
+  if (!EvaluateArgs(Args, ArgValues, Info))
+    return false;
+
+  if (!Info.CheckCallLimit(CallLoc))
+    return false;
+
+  MemoizedCall Memo(Info, Callee, This, ArgValues);
+  if (Memo.lookup(Result))
+    return true;
+
+  if (!evaluateCallBody(CallLoc, Callee, This, Args, ArgValues, Body, Info,
+                        Result, ResultSlot))
+    return false;
+
+  Memo.store(Result);
+  return true;
+}
+
 /// Evaluate a constructor call.
 static bool HandleConstructorCall(const Expr *E, const LValue &This,
                                   APValue *ArgValues,
@@ -6030,6 +7247,7 @@ namespace {
       return handleCallExpr(E, Result, &This);
     }
     bool VisitInitListExpr(const InitListExpr *E);
+    bool VisitDataArrayExpr(const DataArrayExpr *E);
     bool VisitCXXConstructExpr(const CXXConstructExpr *E);
     bool VisitCXXConstructExpr(const CXXConstructExpr *E,
                                const LValue &Subobject,
@@ -6065,7 +7283,7 @@ bool ArrayExprEvaluator::VisitInitListExpr(const InitListExpr *E) {
          "zero-initialized array shouldn't have any initialized elts");
   APValue Filler;
   if (Result.isArray() && Result.hasArrayFiller())
-    Filler = Result.getArrayFiller();
+    Filler.swap(Result.getArrayFiller());
 
   unsigned NumEltsToInit = E->getNumInits();
   unsigned NumElts = CAT->getSize().getZExtValue();
@@ -6084,7 +7302,7 @@ bool ArrayExprEvaluator::VisitInitListExpr(const InitListExpr *E) {
     for (unsigned I = 0, E = Result.getArrayInitializedElts(); I != E; ++I)
       Result.getArrayInitializedElt(I) = Filler;
     if (Result.hasArrayFiller())
-      Result.getArrayFiller() = Filler;
+      Result.getArrayFiller().swap(Filler);
   }
 
   LValue Subobject = This;
@@ -6112,6 +7330,22 @@ bool ArrayExprEvaluator::VisitInitListExpr(const InitListExpr *E) {
                          FillerExpr) && Success;
 }
 
+bool ArrayExprEvaluator::VisitDataArrayExpr(const DataArrayExpr *E) {
+  const ConstantArrayType *CAT = Info.Ctx.getAsConstantArrayType(E->getType());
+  if (!CAT)
+    return Error(E);
+
+  QualType EltTy = CAT->getElementType();
+  Result = APValue(APValue::UninitArray(), E->getNumInits(),
+                   CAT->getSize().getZExtValue());
+  for (unsigned I = 0, N = E->getNumInits(); I != N; ++I)
+    Result.getArrayInitializedElt(I) =
+        APValue(Info.Ctx.MakeIntValue(E->getElementValue(I), EltTy));
+  if (Result.hasArrayFiller())
+    Result.getArrayFiller() = APValue(Info.Ctx.MakeIntValue(0, EltTy));
+  return true;
+}
+
 bool ArrayExprEvaluator::VisitCXXConstructExpr(const CXXConstructExpr *E) {
   return VisitCXXConstructExpr(E, This, &Result, E->getType());
 }
@@ -6126,9 +7360,9 @@ bool ArrayExprEvaluator::VisitCXXConstructExpr(const CXXConstructExpr *E,
     unsigned N = CAT->getSize().getZExtValue();
 
     // Preserve the array filler if we had prior zero-initialization.
-    APValue Filler =
-      HadZeroInit && Value->hasArrayFiller() ? Value->getArrayFiller()
-                                             : APValue();
+    APValue Filler;
+    if (HadZeroInit && Value->hasArrayFiller())
+      Filler = static_cast<const APValue *>(Value)->getArrayFiller();
 
     *Value = APValue(APValue::UninitArray(), N, N);
 
@@ -9342,6 +10576,7 @@ static ICEDiag CheckICE(const Expr* E, const ASTContext &Ctx) {
   case Expr::ExtVectorElementExprClass:
   case Expr::DesignatedInitExprClass:
   case Expr::NoInitExprClass:
+  case Expr::DataArrayExprClass:
   case Expr::DesignatedInitUpdateExprClass:
   case Expr::ImplicitValueInitExprClass:
   case Expr::ParenListExprClass:
@@ -128,6 +128,18 @@ class ItaniumMangleContextImpl : public ItaniumMangleContext {
   llvm::DenseMap<DiscriminatorKeyTy, unsigned> Discriminator;
   llvm::DenseMap<const NamedDecl*, unsigned> Uniquifier;
 
+  /// The names produced by mangleCXXName, mangleCXXCtor and mangleCXXDtor,
+  /// keyed by declaration and structor type.  The same declaration is
+  /// mangled again and again by CodeGen, debug info and the indexer, and
+  /// deeply nested template names are expensive to mangle.
+  typedef std::pair<const NamedDecl*, unsigned> MangledNameKeyTy;
+  llvm::DenseMap<MangledNameKeyTy, std::string> MangledNames;
+
+  /// Mangle \p D with the given structor type into \p Out, reusing the
+  /// result of an earlier call if there is one.
+  template <typename DeclTy, typename StructorTy>
+  void mangleCachedName(const DeclTy *D, StructorTy Type, raw_ostream &Out);
+
 public:
   explicit ItaniumMangleContextImpl(ASTContext &Context,
                                     DiagnosticsEngine &Diags)
@@ -3210,6 +3222,7 @@ recurse:
   case Expr::DesignatedInitUpdateExprClass:
   case Expr::ImplicitValueInitExprClass:
   case Expr::NoInitExprClass:
+  case Expr::DataArrayExprClass:
   case Expr::ParenListExprClass:
   case Expr::LambdaExprClass:
   case Expr::MSPropertyRefExprClass:
@@ -4465,26 +4478,54 @@ void ItaniumMangleContextImpl::mangleCXXName(const NamedDecl *D,
   assert(!isa<CXXConstructorDecl>(D) && !isa<CXXDestructorDecl>(D) &&
          "Invalid mangleName() call on 'structor decl!");
 
+  auto Known = MangledNames.find(MangledNameKeyTy(D, 0));
+  if (Known != MangledNames.end()) {
+    Out << Known->second;
+    return;
+  }
+
   PrettyStackTraceDecl CrashInfo(D, SourceLocation(),
                                  getASTContext().getSourceManager(),
                                  "Mangling declaration");
 
-  CXXNameMangler Mangler(*this, Out, D);
+  SmallString<128> Name;
+  llvm::raw_svector_ostream NameOS(Name);
+  CXXNameMangler Mangler(*this, NameOS, D);
+  Mangler.mangle(D);
+  MangledNames[MangledNameKeyTy(D, 0)] = Name.str();
+  Out << Name;
+}
+
+template <typename DeclTy, typename StructorTy>
+void ItaniumMangleContextImpl::mangleCachedName(const DeclTy *D,
+                                                StructorTy Type,
+                                                raw_ostream &Out) {
+  auto Known = MangledNames.find(MangledNameKeyTy(D, Type));
+  if (Known != MangledNames.end()) {
+    Out << Known->second;
+    return;
+  }
+
+  // Mangle into a buffer of our own: the mangler may look up other names,
+  // which would invalidate an iterator into MangledNames.
+  SmallString<128> Name;
+  llvm::raw_svector_ostream NameOS(Name);
+  CXXNameMangler Mangler(*this, NameOS, D, Type);
   Mangler.mangle(D);
+  MangledNames[MangledNameKeyTy(D, Type)] = Name.str();
+  Out << Name;
 }
 
 void ItaniumMangleContextImpl::mangleCXXCtor(const CXXConstructorDecl *D,
                                              CXXCtorType Type,
                                              raw_ostream &Out) {
-  CXXNameMangler Mangler(*this, Out, D, Type);
-  Mangler.mangle(D);
+  mangleCachedName(D, Type, Out);
 }
 
 void ItaniumMangleContextImpl::mangleCXXDtor(const CXXDestructorDecl *D,
                                              CXXDtorType Type,
                                              raw_ostream &Out) {
-  CXXNameMangler Mangler(*this, Out, D, Type);
-  Mangler.mangle(D);
+  mangleCachedName(D, Type, Out);
 }
 
 void ItaniumMangleContextImpl::mangleCXXCtorComdat(const CXXConstructorDecl *D,
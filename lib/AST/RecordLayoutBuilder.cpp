@@ -2916,6 +2916,18 @@ void MicrosoftRecordLayoutBuilder::computeVtorDispSet(
   }
 }
 
+/// Whether a subobject of \p RD other than \p RD itself can be an empty
+/// class.
+static bool mayContainEmptySubobjects(const ASTContext &Context,
+                                      const CXXRecordDecl *RD) {
+  if (RD->getNumBases() || RD->getNumVBases())
+    return true;
+  for (const FieldDecl *FD : RD->fields())
+    if (Context.getBaseElementType(FD->getType())->getAs<RecordType>())
+      return true;
+  return false;
+}
+
 /// getASTRecordLayout - Get or compute information about the layout of the
 /// specified record (struct/union/class), which indicates its size and field
 /// position information.
@@ -2941,6 +2953,7 @@ ASTContext::getASTRecordLayout(const RecordDecl *D) const {
   if (Entry) return *Entry;
 
   const ASTRecordLayout *NewEntry = nullptr;
+  ++NumRecordLayouts;
 
   if (isMsLayout(*this)) {
     MicrosoftRecordLayoutBuilder Builder(*this);
@@ -2962,8 +2975,14 @@ ASTContext::getASTRecordLayout(const RecordDecl *D) const {
     }
   } else {
     if (const auto *RD = dyn_cast<CXXRecordDecl>(D)) {
+      // Without bases or fields of class type, no two empty subobjects can
+      // end up at the same offset, so don't bother tracking them.
+      bool NeedsEmptySubobjects = mayContainEmptySubobjects(*this, RD);
+      if (!NeedsEmptySubobjects)
+        ++NumRecordLayoutsWithoutEmptySubobjects;
       EmptySubobjectMap EmptySubobjects(*this, RD);
-      ItaniumRecordLayoutBuilder Builder(*this, &EmptySubobjects);
+      ItaniumRecordLayoutBuilder Builder(
+          *this, NeedsEmptySubobjects ? &EmptySubobjects : nullptr);
       Builder.Layout(RD);
 
       // In certain situations, we are allowed to lay out objects in the
@@ -52,7 +52,7 @@ static StmtClassNameTable &getStmtInfoTableEntry(Stmt::StmtClass E) {
 
 void *Stmt::operator new(size_t bytes, const ASTContext& C,
                          unsigned alignment) {
-  return ::operator new(bytes, C, alignment);
+  return C.AllocateStmt(bytes, alignment);
 }
 
 const char *Stmt::getStmtClassName() const {
@@ -84,6 +84,23 @@ void Stmt::PrintStats() {
   llvm::errs() << "Total bytes = " << sum << "\n";
 }
 
+void Stmt::PrintStatsJSON(raw_ostream &OS) {
+  // Ensure the table is primed.
+  getStmtInfoTableEntry(Stmt::NullStmtClass);
+
+  OS << '{';
+  const char *Sep = "";
+  for (int i = 0; i != Stmt::lastStmtConstant+1; i++) {
+    if (StmtClassInfo[i].Name == nullptr) continue;
+    if (StmtClassInfo[i].Counter == 0) continue;
+    OS << Sep << '"' << StmtClassInfo[i].Name << "\":{\"count\":"
+       << StmtClassInfo[i].Counter << ",\"bytes\":"
+       << StmtClassInfo[i].Counter*StmtClassInfo[i].Size << '}';
+    Sep = ",";
+  }
+  OS << '}';
+}
+
 void Stmt::addStmtClass(StmtClass s) {
   ++getStmtInfoTableEntry(s).Counter;
 }
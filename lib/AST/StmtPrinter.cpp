@@ -1729,6 +1729,10 @@ void StmtPrinter::VisitDesignatedInitUpdateExpr(
   OS << "}";
 }
 
+void StmtPrinter::VisitDataArrayExpr(DataArrayExpr *Node) {
+  Visit(Node->getSyntacticForm());
+}
+
 void StmtPrinter::VisitNoInitExpr(NoInitExpr *Node) {
   OS << "/*no init*/";
 }
@@ -943,6 +943,10 @@ void StmtProfiler::VisitDesignatedInitExpr(const DesignatedInitExpr *S) {
   }
 }
 
+void StmtProfiler::VisitDataArrayExpr(const DataArrayExpr *S) {
+  VisitInitListExpr(S->getSyntacticForm());
+}
+
 // Seems that if VisitInitListExpr() only works on the syntactic form of an
 // InitListExpr, then a DesignatedInitUpdateExpr is not encountered.
 void StmtProfiler::VisitDesignatedInitUpdateExpr(
@@ -174,8 +174,8 @@ FinalOverriders::FinalOverriders(const CXXRecordDecl *MostDerivedClass,
                      SubobjectCounts);
 
   // Get the final overriders.
-  CXXFinalOverriderMap FinalOverriders;
-  MostDerivedClass->getFinalOverriders(FinalOverriders);
+  const CXXFinalOverriderMap &FinalOverriders =
+      Context.getFinalOverriders(MostDerivedClass);
 
   for (const auto &Overrider : FinalOverriders) {
     const CXXMethodDecl *MD = Overrider.first;
@@ -22,7 +22,11 @@
 #include "clang/AST/RecursiveASTVisitor.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/Timer.h"
+#include <algorithm>
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <set>
@@ -44,11 +48,17 @@ typedef MatchFinder::MatchCallback MatchCallback;
 // optimize this on.
 static const unsigned MaxMemoizationEntries = 10000;
 
+// How the matcher of a memoized result was matched against the node: the
+// same matcher finds different nodes among the children, the descendants,
+// the parents or the ancestors of a node.
+enum class MatchType { Child, Descendants, Parent, Ancestors };
+
 // We use memoization to avoid running the same matcher on the same
 // AST node twice.  This struct is the key for looking up match
 // result.  It consists of an ID of the MatcherInterface (for
-// identifying the matcher), a pointer to the AST node and the
-// bound nodes before the matcher was executed.
+// identifying the matcher), a pointer to the AST node, the
+// bound nodes before the matcher was executed and how the matcher
+// was matched against the node.
 //
 // We currently only memoize on nodes whose pointers identify the
 // nodes (\c Stmt and \c Decl, but not \c QualType or \c TypeLoc).
@@ -60,10 +70,26 @@ struct MatchKey {
   DynTypedMatcher::MatcherIDType MatcherID;
   ast_type_traits::DynTypedNode Node;
   BoundNodesTreeBuilder BoundNodes;
+  MatchType Type;
+  ASTMatchFinder::TraversalKind Traversal;
+  ASTMatchFinder::BindKind Bind;
+
+  bool operator==(const MatchKey &Other) const {
+    return MatcherID == Other.MatcherID && Type == Other.Type &&
+           Traversal == Other.Traversal && Bind == Other.Bind &&
+           Node == Other.Node && BoundNodes == Other.BoundNodes;
+  }
 
-  bool operator<(const MatchKey &Other) const {
-    return std::tie(MatcherID, Node, BoundNodes) <
-           std::tie(Other.MatcherID, Other.Node, Other.BoundNodes);
+  unsigned getHashValue() const {
+    // The ancestors of a node may be type locations, which have no
+    // memoization data.
+    unsigned NodeHash =
+        ast_type_traits::DynTypedNode::DenseMapInfo::getHashValue(Node);
+    return llvm::hash_combine(
+        llvm::DenseMapInfo<DynTypedMatcher::MatcherIDType>::getHashValue(
+            MatcherID),
+        NodeHash, static_cast<unsigned>(Type), static_cast<unsigned>(Traversal),
+        static_cast<unsigned>(Bind), BoundNodes.getHashValue());
   }
 };
 
@@ -73,6 +99,66 @@ struct MemoizedMatchResult {
   BoundNodesTreeBuilder Nodes;
 };
 
+// Maps (matcher, node) -> the match result for memoization.
+//
+// The entries are allocated in an arena and indexed by a hash of their
+// keys; as the arena can only be freed as a whole, the cache is emptied at
+// once when it holds too many entries.
+class MemoizationMap {
+  struct Entry {
+    Entry(const MatchKey &Key, const MemoizedMatchResult &Result)
+        : Key(Key), Result(Result) {}
+    MatchKey Key;
+    MemoizedMatchResult Result;
+  };
+
+  struct KeyInfo {
+    static const MatchKey *getEmptyKey() {
+      return llvm::DenseMapInfo<const MatchKey *>::getEmptyKey();
+    }
+    static const MatchKey *getTombstoneKey() {
+      return llvm::DenseMapInfo<const MatchKey *>::getTombstoneKey();
+    }
+    static unsigned getHashValue(const MatchKey *Key) {
+      return Key->getHashValue();
+    }
+    static unsigned getHashValue(const MatchKey &Key) {
+      return Key.getHashValue();
+    }
+    static bool isEqual(const MatchKey *LHS, const MatchKey *RHS) {
+      return LHS == RHS;
+    }
+    static bool isEqual(const MatchKey &LHS, const MatchKey *RHS) {
+      return RHS != getEmptyKey() && RHS != getTombstoneKey() && LHS == *RHS;
+    }
+  };
+
+public:
+  ~MemoizationMap() { clear(); }
+
+  // Returns the memoized result for the key, or null if there is none.
+  const MemoizedMatchResult *find(const MatchKey &Key) const {
+    auto I = Index.find_as(Key);
+    return I == Index.end() ? nullptr : I->second;
+  }
+
+  void insert(const MatchKey &Key, const MemoizedMatchResult &Result) {
+    Entry *E = new (Allocator.Allocate()) Entry(Key, Result);
+    Index.insert(std::make_pair(&E->Key, &E->Result));
+  }
+
+  unsigned size() const { return Index.size(); }
+
+  void clear() {
+    Index.clear();
+    Allocator.DestroyAll();
+  }
+
+private:
+  llvm::SpecificBumpPtrAllocator<Entry> Allocator;
+  llvm::DenseMap<const MatchKey *, const MemoizedMatchResult *, KeyInfo> Index;
+};
+
 // A RecursiveASTVisitor that traverses all children or all descendants of
 // a node.
 class MatchChildASTVisitor
@@ -288,14 +374,46 @@ private:
   bool Matches;
 };
 
+// Maps a canonical type to its TypedefDecls.
+typedef llvm::DenseMap<const Type *, std::set<const TypedefNameDecl *>>
+    TypeAliasMap;
+
+// Collects the typedefs of a whole translation unit, for the matching of
+// top level declarations independently of each other.
+class TypeAliasCollector : public RecursiveASTVisitor<TypeAliasCollector> {
+public:
+  TypeAliasCollector(ASTContext &Context, TypeAliasMap &TypeAliases)
+      : Context(Context), TypeAliases(TypeAliases) {}
+
+  bool shouldVisitTemplateInstantiations() const { return true; }
+  bool shouldVisitImplicitCode() const { return true; }
+
+  // See MatchASTVisitor::VisitTypedefNameDecl.
+  bool VisitTypedefNameDecl(TypedefNameDecl *DeclNode) {
+    const Type *TypeNode = DeclNode->getUnderlyingType().getTypePtr();
+    TypeAliases[Context.getCanonicalType(TypeNode)].insert(DeclNode);
+    return true;
+  }
+
+private:
+  ASTContext &Context;
+  TypeAliasMap &TypeAliases;
+};
+
 // Controls the outermost traversal of the AST and allows to match multiple
 // matchers.
 class MatchASTVisitor : public RecursiveASTVisitor<MatchASTVisitor>,
                         public ASTMatchFinder {
 public:
+  // The matches found by a worker thread, in the order they were found.
+  typedef std::vector<std::pair<MatchCallback *, BoundNodes>> MatchBuffer;
+
   MatchASTVisitor(const MatchFinder::MatchersByType *Matchers,
                   const MatchFinder::MatchFinderOptions &Options)
-      : Matchers(Matchers), Options(Options), ActiveASTContext(nullptr) {}
+      : Matchers(Matchers), Options(Options), ActiveASTContext(nullptr),
+        Buffer(nullptr) {
+    indexMatchersByKind();
+  }
 
   ~MatchASTVisitor() override {
     if (Options.CheckProfiling) {
@@ -327,6 +445,10 @@ public:
     ActiveASTContext = NewActiveASTContext;
   }
 
+  /// \brief Traverses the translation unit, matching its top level
+  /// declarations on \p NumThreads threads.
+  void traverseTranslationUnitInParallel(unsigned NumThreads);
+
   // The following Visit*() and Traverse*() functions "override"
   // methods in RecursiveASTVisitor.
 
@@ -387,23 +509,23 @@ public:
     Key.Node = Node;
     // Note that we key on the bindings *before* the match.
     Key.BoundNodes = *Builder;
+    Key.Type = MaxDepth == 1 ? MatchType::Child : MatchType::Descendants;
+    Key.Traversal = Traversal;
+    Key.Bind = Bind;
 
-    MemoizationMap::iterator I = ResultCache.find(Key);
-    if (I != ResultCache.end()) {
-      *Builder = I->second.Nodes;
-      return I->second.ResultOfMatch;
+    if (const MemoizedMatchResult *Cached = ResultCache.find(Key)) {
+      *Builder = Cached->Nodes;
+      return Cached->ResultOfMatch;
     }
 
     MemoizedMatchResult Result;
     Result.Nodes = *Builder;
     Result.ResultOfMatch = matchesRecursively(Node, Matcher, &Result.Nodes,
                                               MaxDepth, Traversal, Bind);
+    ResultCache.insert(Key, Result);
 
-    MemoizedMatchResult &CachedResult = ResultCache[Key];
-    CachedResult = std::move(Result);
-
-    *Builder = CachedResult.Nodes;
-    return CachedResult.ResultOfMatch;
+    *Builder = std::move(Result.Nodes);
+    return Result.ResultOfMatch;
   }
 
   // Matches children or descendants of 'Node' with 'BaseMatcher'.
@@ -526,7 +648,7 @@ private:
         Timer.setBucket(&TimeByBucket[MP.second->getID()]);
       BoundNodesTreeBuilder Builder;
       if (MP.first.matches(Node, this, &Builder)) {
-        MatchVisitor Visitor(ActiveASTContext, MP.second);
+        MatchVisitor Visitor(ActiveASTContext, MP.second, Buffer);
         Builder.visitMatches(&Visitor);
       }
     }
@@ -550,7 +672,7 @@ private:
         Timer.setBucket(&TimeByBucket[MP.second->getID()]);
       BoundNodesTreeBuilder Builder;
       if (MP.first.matchesNoKindCheck(DynNode, this, &Builder)) {
-        MatchVisitor Visitor(ActiveASTContext, MP.second);
+        MatchVisitor Visitor(ActiveASTContext, MP.second, Buffer);
         Builder.visitMatches(&Visitor);
       }
     }
@@ -559,14 +681,66 @@ private:
   const std::vector<unsigned short> &
   getFilterForKind(ast_type_traits::ASTNodeKind Kind) {
     auto &Filter = MatcherFiltersMap[Kind];
+    unsigned NumGroups = 0;
+    for (const auto &Group : MatchersByRestrictKind) {
+      if (Group.first.isBaseOf(Kind)) {
+        Filter.insert(Filter.end(), Group.second.begin(), Group.second.end());
+        ++NumGroups;
+      }
+    }
+    // The matchers run in the order they were added.
+    if (NumGroups > 1)
+      std::sort(Filter.begin(), Filter.end());
+    return Filter;
+  }
+
+  /// \brief Groups the node matchers by the kind of node they are restricted
+  /// to, so that the matchers for a kind of node are found by looking at
+  /// each group rather than at each matcher, and finds out whether any of
+  /// the registered matchers can match a node within a statement.
+  void indexMatchersByKind() {
     auto &Matchers = this->Matchers->DeclOrStmt;
     assert((Matchers.size() < USHRT_MAX) && "Too many matchers.");
+    llvm::DenseMap<ast_type_traits::ASTNodeKind, unsigned> GroupIndex;
+    SkipStatements = this->Matchers->Type.empty() &&
+                     this->Matchers->TypeLoc.empty() &&
+                     this->Matchers->NestedNameSpecifier.empty() &&
+                     this->Matchers->NestedNameSpecifierLoc.empty();
     for (unsigned I = 0, E = Matchers.size(); I != E; ++I) {
-      if (Matchers[I].first.canMatchNodesOfKind(Kind)) {
-        Filter.push_back(I);
+      ast_type_traits::ASTNodeKind Kind = Matchers[I].first.getRestrictKind();
+      auto It = GroupIndex.insert(
+          std::make_pair(Kind, MatchersByRestrictKind.size()));
+      if (It.second) {
+        MatchersByRestrictKind.emplace_back(Kind,
+                                            std::vector<unsigned short>());
+        SkipStatements = SkipStatements && isNeverWithinStatement(Kind);
       }
+      MatchersByRestrictKind[It.first->second].second.push_back(I);
     }
-    return Filter;
+  }
+
+  /// \brief Returns true if nodes of the given kind can't be found within a
+  /// statement, as they can only be declared outside of block scope.
+  static bool isNeverWithinStatement(ast_type_traits::ASTNodeKind Kind) {
+    using ast_type_traits::ASTNodeKind;
+    static const ASTNodeKind Kinds[] = {
+        ASTNodeKind::getFromNodeKind<TranslationUnitDecl>(),
+        ASTNodeKind::getFromNodeKind<NamespaceDecl>(),
+        ASTNodeKind::getFromNodeKind<LinkageSpecDecl>(),
+        ASTNodeKind::getFromNodeKind<FileScopeAsmDecl>(),
+        ASTNodeKind::getFromNodeKind<ClassTemplateDecl>(),
+        ASTNodeKind::getFromNodeKind<ClassTemplateSpecializationDecl>(),
+        ASTNodeKind::getFromNodeKind<VarTemplateDecl>(),
+        ASTNodeKind::getFromNodeKind<VarTemplateSpecializationDecl>(),
+        ASTNodeKind::getFromNodeKind<TypeAliasTemplateDecl>(),
+        ASTNodeKind::getFromNodeKind<ObjCContainerDecl>(),
+        ASTNodeKind::getFromNodeKind<ObjCMethodDecl>(),
+        ASTNodeKind::getFromNodeKind<ObjCPropertyDecl>(),
+        ASTNodeKind::getFromNodeKind<ObjCPropertyImplDecl>()};
+    for (const ASTNodeKind &Outer : Kinds)
+      if (Outer.isBaseOf(Kind))
+        return true;
+    return false;
   }
 
   /// @{
@@ -624,25 +798,27 @@ private:
     Key.MatcherID = Matcher.getID();
     Key.Node = Node;
     Key.BoundNodes = *Builder;
-
-    // Note that we cannot use insert and reuse the iterator, as recursive
-    // calls to match might invalidate the result cache iterators.
-    MemoizationMap::iterator I = ResultCache.find(Key);
-    if (I != ResultCache.end()) {
-      *Builder = I->second.Nodes;
-      return I->second.ResultOfMatch;
+    Key.Type = MatchMode == ASTMatchFinder::AMM_ParentOnly
+                   ? MatchType::Parent
+                   : MatchType::Ancestors;
+    Key.Traversal = TK_AsIs;
+    Key.Bind = BK_First;
+
+    // Note that the result can't be inserted before matching, as recursive
+    // calls to match might clear the result cache.
+    if (const MemoizedMatchResult *Cached = ResultCache.find(Key)) {
+      *Builder = Cached->Nodes;
+      return Cached->ResultOfMatch;
     }
 
     MemoizedMatchResult Result;
     Result.Nodes = *Builder;
     Result.ResultOfMatch =
         matchesAncestorOfRecursively(Node, Matcher, &Result.Nodes, MatchMode);
+    ResultCache.insert(Key, Result);
 
-    MemoizedMatchResult &CachedResult = ResultCache[Key];
-    CachedResult = std::move(Result);
-
-    *Builder = CachedResult.Nodes;
-    return CachedResult.ResultOfMatch;
+    *Builder = std::move(Result.Nodes);
+    return Result.ResultOfMatch;
   }
 
   bool matchesAncestorOfRecursively(const ast_type_traits::DynTypedNode &Node,
@@ -697,17 +873,23 @@ private:
   class MatchVisitor : public BoundNodesTreeBuilder::Visitor {
   public:
     MatchVisitor(ASTContext* Context,
-                 MatchFinder::MatchCallback* Callback)
+                 MatchFinder::MatchCallback* Callback,
+                 MatchBuffer *Buffer)
       : Context(Context),
-        Callback(Callback) {}
+        Callback(Callback),
+        Buffer(Buffer) {}
 
     void visitMatch(const BoundNodes& BoundNodesView) override {
-      Callback->run(MatchFinder::MatchResult(BoundNodesView, Context));
+      if (Buffer)
+        Buffer->push_back(std::make_pair(Callback, BoundNodesView));
+      else
+        Callback->run(MatchFinder::MatchResult(BoundNodesView, Context));
     }
 
   private:
     ASTContext* Context;
     MatchFinder::MatchCallback* Callback;
+    MatchBuffer *Buffer;
   };
 
   // Returns true if 'TypeNode' has an alias that matches the given matcher.
@@ -744,15 +926,27 @@ private:
   llvm::DenseMap<ast_type_traits::ASTNodeKind, std::vector<unsigned short>>
       MatcherFiltersMap;
 
+  /// \brief The indices of the node matchers for each kind of node they
+  /// are restricted to, in the order the kinds were first registered.
+  std::vector<std::pair<ast_type_traits::ASTNodeKind,
+                        std::vector<unsigned short>>> MatchersByRestrictKind;
+
+  /// \brief Whether statements can be left out of the traversal, because
+  /// none of the registered matchers can match anything within them.
+  bool SkipStatements;
+
   const MatchFinder::MatchFinderOptions &Options;
   ASTContext *ActiveASTContext;
 
   // Maps a canonical type to its TypedefDecls.
-  llvm::DenseMap<const Type*, std::set<const TypedefNameDecl*> > TypeAliases;
+  TypeAliasMap TypeAliases;
 
   // Maps (matcher, node) -> the match result for memoization.
-  typedef std::map<MatchKey, MemoizedMatchResult> MemoizationMap;
   MemoizationMap ResultCache;
+
+  // Where the matches are buffered instead of being reported to the
+  // callbacks, when matching on a worker thread.
+  MatchBuffer *Buffer;
 };
 
 static CXXRecordDecl *
@@ -821,7 +1015,7 @@ bool MatchASTVisitor::TraverseDecl(Decl *DeclNode) {
 }
 
 bool MatchASTVisitor::TraverseStmt(Stmt *StmtNode) {
-  if (!StmtNode) {
+  if (!StmtNode || SkipStatements) {
     return true;
   }
   match(*StmtNode);
@@ -864,6 +1058,69 @@ bool MatchASTVisitor::TraverseNestedNameSpecifierLoc(
       RecursiveASTVisitor<MatchASTVisitor>::TraverseNestedNameSpecifierLoc(NNS);
 }
 
+void MatchASTVisitor::traverseTranslationUnitInParallel(unsigned NumThreads) {
+  TranslationUnitDecl *TU = ActiveASTContext->getTranslationUnitDecl();
+  match(*TU);
+
+  // BlockDecls and CapturedDecls are traversed through the expressions and
+  // statements they belong to, just as RecursiveASTVisitor does.
+  std::vector<Decl *> Decls;
+  for (Decl *D : TU->decls())
+    if (!isa<BlockDecl>(D) && !isa<CapturedDecl>(D))
+      Decls.push_back(D);
+  if (Decls.empty())
+    return;
+
+  // The workers share the AST read-only, so build the parent map, which is
+  // otherwise built on the first use of hasParent() or hasAncestor(), and
+  // collect the typedefs of the whole translation unit up front.
+  ActiveASTContext->getParents(*TU);
+  TypeAliasCollector(*ActiveASTContext, TypeAliases).TraverseDecl(TU);
+
+  unsigned NumWorkers = std::min<size_t>(NumThreads, Decls.size());
+  std::vector<MatchBuffer> Buffers(Decls.size());
+  std::vector<llvm::StringMap<llvm::TimeRecord>> WorkerTimes(NumWorkers);
+  std::atomic<unsigned> NextDecl(0);
+  auto Worker = [&](unsigned WorkerID) {
+    MatchFinder::MatchFinderOptions WorkerOptions;
+    if (Options.CheckProfiling)
+      WorkerOptions.CheckProfiling.emplace(WorkerTimes[WorkerID]);
+    MatchASTVisitor WorkerVisitor(Matchers, WorkerOptions);
+    WorkerVisitor.set_active_ast_context(ActiveASTContext);
+    WorkerVisitor.TypeAliases = TypeAliases;
+    for (unsigned I = NextDecl++; I < Decls.size(); I = NextDecl++) {
+      WorkerVisitor.Buffer = &Buffers[I];
+      WorkerVisitor.TraverseDecl(Decls[I]);
+    }
+  };
+
+  {
+    llvm::ThreadPool Pool(NumWorkers);
+    for (unsigned I = 0; I < NumWorkers; ++I)
+      Pool.async(Worker, I);
+    Pool.wait();
+  }
+
+  // Report the matches in the order of the declarations they were found in,
+  // which is the order a single traversal would have found them in.
+  const bool EnableCheckProfiling = Options.CheckProfiling.hasValue();
+  {
+    TimeBucketRegion Timer;
+    for (const MatchBuffer &Matches : Buffers) {
+      for (const auto &Match : Matches) {
+        if (EnableCheckProfiling)
+          Timer.setBucket(&TimeByBucket[Match.first->getID()]);
+        Match.first->run(
+            MatchFinder::MatchResult(Match.second, ActiveASTContext));
+      }
+    }
+  }
+  if (EnableCheckProfiling)
+    for (const auto &Records : WorkerTimes)
+      for (const auto &Record : Records)
+        TimeByBucket[Record.getKey()] += Record.getValue();
+}
+
 class MatchASTConsumer : public ASTConsumer {
 public:
   MatchASTConsumer(MatchFinder *Finder,
@@ -973,7 +1230,10 @@ void MatchFinder::matchAST(ASTContext &Context) {
   internal::MatchASTVisitor Visitor(&Matchers, Options);
   Visitor.set_active_ast_context(&Context);
   Visitor.onStartOfTranslationUnit();
-  Visitor.TraverseDecl(Context.getTranslationUnitDecl());
+  if (Options.NumThreads > 1)
+    Visitor.traverseTranslationUnitInParallel(Options.NumThreads);
+  else
+    Visitor.TraverseDecl(Context.getTranslationUnitDecl());
   Visitor.onEndOfTranslationUnit();
 }
 
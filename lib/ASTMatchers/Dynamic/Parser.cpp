@@ -19,6 +19,7 @@
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/ManagedStatic.h"
 #include <string>
+#include <tuple>
 #include <vector>
 
 namespace clang {
@@ -554,6 +555,53 @@ std::vector<MatcherCompletion> Parser::RegistrySema::getMatcherCompletions(
   return Registry::getMatcherCompletions(AcceptedTypes);
 }
 
+Parser::CachingRegistrySema::~CachingRegistrySema() {}
+
+bool Parser::CachingRegistrySema::ArgKey::operator<(
+    const ArgKey &Other) const {
+  return std::make_tuple(Kind, Unsigned, StringRef(String),
+                         Matcher.getOpaqueID()) <
+         std::make_tuple(Other.Kind, Other.Unsigned, StringRef(Other.String),
+                         Other.Matcher.getOpaqueID());
+}
+
+VariantMatcher Parser::CachingRegistrySema::actOnMatcherExpression(
+    MatcherCtor Ctor, SourceRange NameRange, StringRef BindID,
+    ArrayRef<ParserValue> Args, Diagnostics *Error) {
+  std::vector<ArgKey> ArgKeys(Args.size());
+  for (size_t i = 0, e = Args.size(); i != e; ++i) {
+    const VariantValue &Value = Args[i].Value;
+    ArgKey &Key = ArgKeys[i];
+    Key.Unsigned = 0;
+    if (Value.isUnsigned()) {
+      Key.Kind = ArgKey::AK_Unsigned;
+      Key.Unsigned = Value.getUnsigned();
+    } else if (Value.isString()) {
+      Key.Kind = ArgKey::AK_String;
+      Key.String = Value.getString();
+    } else if (Value.isMatcher()) {
+      Key.Kind = ArgKey::AK_Matcher;
+      Key.Matcher = Value.getMatcher();
+    } else {
+      // Let the registry diagnose the argument.
+      return RegistrySema::actOnMatcherExpression(Ctor, NameRange, BindID,
+                                                  Args, Error);
+    }
+  }
+
+  CacheKey Key(Ctor, BindID.str(), std::move(ArgKeys));
+  auto I = Cache.find(Key);
+  if (I != Cache.end())
+    return I->second;
+
+  VariantMatcher Result = RegistrySema::actOnMatcherExpression(
+      Ctor, NameRange, BindID, Args, Error);
+  // Don't cache errors, so that they are diagnosed every time.
+  if (!Result.isNull())
+    Cache.insert(std::make_pair(std::move(Key), Result));
+  return Result;
+}
+
 bool Parser::parseExpression(StringRef Code, Sema *S,
                              const NamedValueMap *NamedValues,
                              VariantValue *Value, Diagnostics *Error) {
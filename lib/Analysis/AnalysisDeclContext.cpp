@@ -27,12 +27,20 @@
 #include "clang/Analysis/CFGStmtMap.h"
 #include "clang/Analysis/Support/BumpVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
 
+#define DEBUG_TYPE "AnalysisDeclContext"
+
+STATISTIC(NumCFGsBuilt, "The # of CFGs built");
+STATISTIC(NumCFGBlocks, "The # of blocks in the CFGs built");
+STATISTIC(NumCFGElements, "The # of elements in the CFGs built");
+
 typedef llvm::DenseMap<const void *, ManagedAnalysis *> ManagedAnalysisMap;
 
 AnalysisDeclContext::AnalysisDeclContext(AnalysisDeclContextManager *Mgr,
@@ -71,7 +79,8 @@ AnalysisDeclContextManager::AnalysisDeclContextManager(bool useUnoptimizedCFG,
                                                        bool addStaticInitBranch,
                                                        bool addCXXNewAllocator,
                                                        CodeInjector *injector)
-  : Injector(injector), SynthesizeBodies(synthesizeBodies)
+  : Injector(injector), SynthesizeBodies(synthesizeBodies),
+    CFGBuildTimer(nullptr)
 {
   cfgBuildOptions.PruneTriviallyFalseEdges = !useUnoptimizedCFG;
   cfgBuildOptions.AddImplicitDtors = addImplicitDtors;
@@ -211,12 +220,25 @@ static void addParentsForSyntheticStmts(const CFG *TheCFG, ParentMap &PM) {
   }
 }
 
+std::unique_ptr<CFG> AnalysisDeclContext::buildCFG() {
+  llvm::TimeRegion Timer(Manager ? Manager->getCFGBuildTimer() : nullptr);
+  std::unique_ptr<CFG> Result =
+      CFG::buildCFG(D, getBody(), &D->getASTContext(), cfgBuildOptions);
+  if (Result) {
+    ++NumCFGsBuilt;
+    NumCFGBlocks += Result->getNumBlockIDs();
+    for (const CFGBlock *B : *Result)
+      NumCFGElements += B->size();
+  }
+  return Result;
+}
+
 CFG *AnalysisDeclContext::getCFG() {
   if (!cfgBuildOptions.PruneTriviallyFalseEdges)
     return getUnoptimizedCFG();
 
   if (!builtCFG) {
-    cfg = CFG::buildCFG(D, getBody(), &D->getASTContext(), cfgBuildOptions);
+    cfg = buildCFG();
     // Even when the cfg is not successfully built, we don't
     // want to try building it again.
     builtCFG = true;
@@ -234,8 +256,7 @@ CFG *AnalysisDeclContext::getUnoptimizedCFG() {
   if (!builtCompleteCFG) {
     SaveAndRestore<bool> NotPrune(cfgBuildOptions.PruneTriviallyFalseEdges,
                                   false);
-    completeCFG =
-        CFG::buildCFG(D, getBody(), &D->getASTContext(), cfgBuildOptions);
+    completeCFG = buildCFG();
     // Even when the cfg is not successfully built, we don't
     // want to try building it again.
     builtCompleteCFG = true;
@@ -14,9 +14,13 @@
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Decl.h"
 #include "clang/AST/StmtVisitor.h"
+#include "llvm/ADT/PointerUnion.h"
 #include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SCCIterator.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/GraphWriter.h"
+#include "llvm/Support/ThreadPool.h"
+#include <atomic>
 
 using namespace clang;
 
@@ -26,15 +30,21 @@ STATISTIC(NumObjCCallEdges, "Number of Objective-C method call edges");
 STATISTIC(NumBlockCallEdges, "Number of block call edges");
 
 namespace {
+/// A call site found in a function body: either the called declaration, or an
+/// Objective-C message whose callee is looked up when the edge is added.
+typedef llvm::PointerUnion<Decl *, ObjCMessageExpr *> CallSite;
+
 /// A helper class, which walks the AST and locates all the call sites in the
 /// given function body.
+///
+/// The walk only reads the body, so that several of them can run in parallel.
+/// Anything that may change the AST, such as a method lookup, is left to
+/// addCallEdges().
 class CGBuilder : public StmtVisitor<CGBuilder> {
-  CallGraph *G;
-  CallGraphNode *CallerNode;
+  SmallVectorImpl<CallSite> &Calls;
 
 public:
-  CGBuilder(CallGraph *g, CallGraphNode *N)
-    : G(g), CallerNode(N) {}
+  CGBuilder(SmallVectorImpl<CallSite> &Calls) : Calls(Calls) {}
 
   void VisitStmt(Stmt *S) { VisitChildren(S); }
 
@@ -52,34 +62,15 @@ public:
     return nullptr;
   }
 
-  void addCalledDecl(Decl *D) {
-    if (G->includeInGraph(D)) {
-      CallGraphNode *CalleeNode = G->getOrInsertNode(D);
-      CallerNode->addCallee(CalleeNode, G);
-    }
-  }
-
   void VisitCallExpr(CallExpr *CE) {
     if (Decl *D = getDeclFromCall(CE))
-      addCalledDecl(D);
+      Calls.push_back(D);
   }
 
-  // Adds may-call edges for the ObjC message sends.
+  // Records the ObjC message sends, which add may-call edges.
   void VisitObjCMessageExpr(ObjCMessageExpr *ME) {
-    if (ObjCInterfaceDecl *IDecl = ME->getReceiverInterface()) {
-      Selector Sel = ME->getSelector();
-      
-      // Find the callee definition within the same translation unit.
-      Decl *D = nullptr;
-      if (ME->isInstanceMessage())
-        D = IDecl->lookupPrivateMethod(Sel);
-      else
-        D = IDecl->lookupPrivateClassMethod(Sel);
-      if (D) {
-        addCalledDecl(D);
-        NumObjCCallEdges++;
-      }
-    }
+    if (ME->getReceiverInterface())
+      Calls.push_back(ME);
   }
 
   void VisitChildren(Stmt *S) {
@@ -91,6 +82,39 @@ public:
 
 } // end anonymous namespace
 
+static void addCalledDecl(CallGraph *G, CallGraphNode *CallerNode, Decl *D) {
+  if (G->includeInGraph(D)) {
+    CallGraphNode *CalleeNode = G->getOrInsertNode(D);
+    CallerNode->addCallee(CalleeNode, G);
+  }
+}
+
+/// \brief Add the edges for the call sites found in the body of a function.
+static void addCallEdges(CallGraph *G, CallGraphNode *CallerNode,
+                         ArrayRef<CallSite> Calls) {
+  for (CallSite Call : Calls) {
+    if (Decl *D = Call.dyn_cast<Decl *>()) {
+      addCalledDecl(G, CallerNode, D);
+      continue;
+    }
+
+    ObjCMessageExpr *ME = Call.get<ObjCMessageExpr *>();
+    ObjCInterfaceDecl *IDecl = ME->getReceiverInterface();
+    Selector Sel = ME->getSelector();
+
+    // Find the callee definition within the same translation unit.
+    Decl *D = nullptr;
+    if (ME->isInstanceMessage())
+      D = IDecl->lookupPrivateMethod(Sel);
+    else
+      D = IDecl->lookupPrivateClassMethod(Sel);
+    if (D) {
+      addCalledDecl(G, CallerNode, D);
+      NumObjCCallEdges++;
+    }
+  }
+}
+
 void CallGraph::addNodesForBlocks(DeclContext *D) {
   if (BlockDecl *BD = dyn_cast<BlockDecl>(D))
     addNodeForDecl(BD, true);
@@ -100,7 +124,7 @@ void CallGraph::addNodesForBlocks(DeclContext *D) {
       addNodesForBlocks(DC);
 }
 
-CallGraph::CallGraph() {
+CallGraph::CallGraph() : PendingDecls(nullptr) {
   Root = getOrInsertNode(nullptr);
 }
 
@@ -127,16 +151,56 @@ bool CallGraph::includeInGraph(const Decl *D) {
   return true;
 }
 
+void CallGraph::addToCallGraph(ArrayRef<Decl *> Decls, unsigned NumThreads) {
+  SmallVector<Decl *, 32> Pending;
+  PendingDecls = &Pending;
+  for (Decl *D : Decls)
+    TraverseDecl(D);
+  PendingDecls = nullptr;
+
+  // The bodies may have to be deserialized, so get them before going
+  // parallel.
+  std::vector<Stmt *> Bodies;
+  Bodies.reserve(Pending.size());
+  for (Decl *D : Pending)
+    Bodies.push_back(D->getBody());
+
+  std::vector<SmallVector<CallSite, 8>> Calls(Pending.size());
+  {
+    unsigned NumWorkers =
+        std::max(1u, std::min<unsigned>(NumThreads, Pending.size()));
+    std::atomic<unsigned> NextDecl(0);
+    llvm::ThreadPool Pool(NumWorkers);
+    for (unsigned I = 0; I != NumWorkers; ++I)
+      Pool.async([&] {
+        for (unsigned Idx = NextDecl++; Idx < Pending.size();
+             Idx = NextDecl++)
+          if (Bodies[Idx])
+            CGBuilder(Calls[Idx]).Visit(Bodies[Idx]);
+      });
+    Pool.wait();
+  }
+
+  for (unsigned I = 0, E = Pending.size(); I != E; ++I)
+    addCallEdges(this, getOrInsertNode(Pending[I]), Calls[I]);
+}
+
 void CallGraph::addNodeForDecl(Decl* D, bool IsGlobal) {
   assert(D);
 
+  if (PendingDecls) {
+    PendingDecls->push_back(D);
+    return;
+  }
+
   // Allocate a new node, mark it as root, and process it's calls.
   CallGraphNode *Node = getOrInsertNode(D);
 
   // Process all the calls by this function as well.
-  CGBuilder builder(this, Node);
+  SmallVector<CallSite, 8> Calls;
   if (Stmt *Body = D->getBody())
-    builder.Visit(Body);
+    CGBuilder(Calls).Visit(Body);
+  addCallEdges(this, Node, Calls);
 }
 
 CallGraphNode *CallGraph::getNode(const Decl *F) const {
@@ -206,6 +270,58 @@ LLVM_DUMP_METHOD void CallGraphNode::dump() const {
   print(llvm::errs());
 }
 
+CallGraphSCCScheduler::CallGraphSCCScheduler(const CallGraph &CG)
+    : NumCompleted(0) {
+  // The SCC iterator visits the components in post order, so the callees of
+  // a component have been numbered by the time it is reached.
+  llvm::DenseMap<const CallGraphNode *, unsigned> SCCOfNode;
+  for (llvm::scc_iterator<const CallGraph *> I = llvm::scc_begin(&CG);
+       !I.isAtEnd(); ++I) {
+    const std::vector<const CallGraphNode *> &Nodes = *I;
+    // Nobody calls the root, so it is a component of its own.
+    if (Nodes.front() == CG.getRoot())
+      continue;
+
+    unsigned Index = SCCs.size();
+    for (const CallGraphNode *N : Nodes)
+      SCCOfNode[N] = Index;
+    SCCs.push_back(Nodes);
+    Callers.emplace_back();
+    NumPendingCallees.push_back(0);
+
+    for (const CallGraphNode *N : Nodes) {
+      for (const CallGraphNode *Callee : *N) {
+        unsigned CalleeIndex = SCCOfNode.lookup(Callee);
+        if (CalleeIndex == Index)
+          continue;
+        SmallVectorImpl<unsigned> &CalleeCallers = Callers[CalleeIndex];
+        if (!CalleeCallers.empty() && CalleeCallers.back() == Index)
+          continue;
+        CalleeCallers.push_back(Index);
+        ++NumPendingCallees[Index];
+      }
+    }
+
+    if (!NumPendingCallees[Index])
+      Ready.push_back(Index);
+  }
+}
+
+void CallGraphSCCScheduler::takeReadyBatch(SmallVectorImpl<unsigned> &Batch) {
+  Batch.append(Ready.begin(), Ready.end());
+  Ready.clear();
+}
+
+void CallGraphSCCScheduler::markCompleted(unsigned Index) {
+  assert(NumCompleted < SCCs.size() && "All components already completed");
+  ++NumCompleted;
+  for (unsigned Caller : Callers[Index]) {
+    assert(NumPendingCallees[Caller] && "Callee completed twice");
+    if (!--NumPendingCallees[Caller])
+      Ready.push_back(Caller);
+  }
+}
+
 namespace llvm {
 
 template <>
@@ -936,3 +936,177 @@ bool FormatSpecifier::namedTypeToLengthModifier(QualType QT,
   }
   return false;
 }
+
+//===----------------------------------------------------------------------===//
+// Methods on ParsedFormatString.
+//===----------------------------------------------------------------------===//
+
+using clang::analyze_format_string::ParsedFormatString;
+
+/// \brief A handler that records the callbacks of the parser. It always asks
+/// the parser to go on, so that the recorded callbacks are the ones any
+/// handler sees until it asks the parser to stop.
+class ParsedFormatString::Recorder : public FormatStringHandler {
+  ParsedFormatString &Parsed;
+
+  void record(EventKind Kind, const char *Start, unsigned Len,
+              const char *End = nullptr, const char *Conversion = nullptr,
+              PositionContext Context = analyze_format_string::FieldWidthPos,
+              unsigned Index = 0) {
+    Event E = {Kind, Start, End, Conversion, Len, Context, Index};
+    Parsed.Events.push_back(E);
+  }
+
+public:
+  explicit Recorder(ParsedFormatString &Parsed) : Parsed(Parsed) {}
+
+  void HandleNullChar(const char *nullCharacter) override {
+    record(EK_NullChar, nullCharacter, 0);
+  }
+
+  void HandlePosition(const char *startPos, unsigned posLen) override {
+    record(EK_Position, startPos, posLen);
+  }
+
+  void HandleInvalidPosition(const char *startPos, unsigned posLen,
+                             PositionContext p) override {
+    record(EK_InvalidPosition, startPos, posLen, nullptr, nullptr, p);
+  }
+
+  void HandleZeroPosition(const char *startPos, unsigned posLen) override {
+    record(EK_ZeroPosition, startPos, posLen);
+  }
+
+  void HandleIncompleteSpecifier(const char *startSpecifier,
+                                 unsigned specifierLen) override {
+    record(EK_IncompleteSpecifier, startSpecifier, specifierLen);
+  }
+
+  void HandleEmptyObjCModifierFlag(const char *startFlags,
+                                   unsigned flagsLen) override {
+    record(EK_EmptyObjCModifierFlag, startFlags, flagsLen);
+  }
+
+  void HandleInvalidObjCModifierFlag(const char *startFlag,
+                                     unsigned flagLen) override {
+    record(EK_InvalidObjCModifierFlag, startFlag, flagLen);
+  }
+
+  void HandleObjCFlagsWithNonObjCConversion(
+      const char *flagsStart, const char *flagsEnd,
+      const char *conversionPosition) override {
+    record(EK_ObjCFlagsWithNonObjCConversion, flagsStart, 0, flagsEnd,
+           conversionPosition);
+  }
+
+  bool HandleInvalidPrintfConversionSpecifier(
+      const analyze_printf::PrintfSpecifier &FS, const char *startSpecifier,
+      unsigned specifierLen) override {
+    record(EK_InvalidPrintfConversionSpecifier, startSpecifier, specifierLen,
+           nullptr, nullptr, analyze_format_string::FieldWidthPos,
+           Parsed.PrintfSpecifiers.size());
+    Parsed.PrintfSpecifiers.push_back(FS);
+    return true;
+  }
+
+  bool HandlePrintfSpecifier(const analyze_printf::PrintfSpecifier &FS,
+                             const char *startSpecifier,
+                             unsigned specifierLen) override {
+    record(EK_PrintfSpecifier, startSpecifier, specifierLen, nullptr, nullptr,
+           analyze_format_string::FieldWidthPos,
+           Parsed.PrintfSpecifiers.size());
+    Parsed.PrintfSpecifiers.push_back(FS);
+    return true;
+  }
+
+  bool HandleInvalidScanfConversionSpecifier(
+      const analyze_scanf::ScanfSpecifier &FS, const char *startSpecifier,
+      unsigned specifierLen) override {
+    record(EK_InvalidScanfConversionSpecifier, startSpecifier, specifierLen,
+           nullptr, nullptr, analyze_format_string::FieldWidthPos,
+           Parsed.ScanfSpecifiers.size());
+    Parsed.ScanfSpecifiers.push_back(FS);
+    return true;
+  }
+
+  bool HandleScanfSpecifier(const analyze_scanf::ScanfSpecifier &FS,
+                            const char *startSpecifier,
+                            unsigned specifierLen) override {
+    record(EK_ScanfSpecifier, startSpecifier, specifierLen, nullptr, nullptr,
+           analyze_format_string::FieldWidthPos,
+           Parsed.ScanfSpecifiers.size());
+    Parsed.ScanfSpecifiers.push_back(FS);
+    return true;
+  }
+
+  void HandleIncompleteScanList(const char *start, const char *end) override {
+    record(EK_IncompleteScanList, start, 0, end);
+  }
+};
+
+ParsedFormatString::ParsedFormatString(StringRef Str, FormatKind Kind,
+                                       const LangOptions &LO,
+                                       const TargetInfo &Target)
+    : Str(Str) {
+  Recorder R(*this);
+  const char *Beg = this->Str.data();
+  const char *End = Beg + this->Str.size();
+  if (Kind == Scanf)
+    Stopped = analyze_format_string::ParseScanfString(R, Beg, End, LO, Target);
+  else
+    Stopped = analyze_format_string::ParsePrintfString(
+        R, Beg, End, LO, Target, Kind == FreeBSDKPrintf);
+}
+
+bool ParsedFormatString::replay(FormatStringHandler &H) const {
+  for (const Event &E : Events) {
+    switch (E.Kind) {
+    case EK_NullChar:
+      H.HandleNullChar(E.Start);
+      break;
+    case EK_Position:
+      H.HandlePosition(E.Start, E.Len);
+      break;
+    case EK_InvalidPosition:
+      H.HandleInvalidPosition(E.Start, E.Len, E.Context);
+      break;
+    case EK_ZeroPosition:
+      H.HandleZeroPosition(E.Start, E.Len);
+      break;
+    case EK_IncompleteSpecifier:
+      H.HandleIncompleteSpecifier(E.Start, E.Len);
+      break;
+    case EK_EmptyObjCModifierFlag:
+      H.HandleEmptyObjCModifierFlag(E.Start, E.Len);
+      break;
+    case EK_InvalidObjCModifierFlag:
+      H.HandleInvalidObjCModifierFlag(E.Start, E.Len);
+      break;
+    case EK_ObjCFlagsWithNonObjCConversion:
+      H.HandleObjCFlagsWithNonObjCConversion(E.Start, E.End, E.Conversion);
+      break;
+    case EK_InvalidPrintfConversionSpecifier:
+      if (!H.HandleInvalidPrintfConversionSpecifier(PrintfSpecifiers[E.Index],
+                                                    E.Start, E.Len))
+        return true;
+      break;
+    case EK_PrintfSpecifier:
+      if (!H.HandlePrintfSpecifier(PrintfSpecifiers[E.Index], E.Start, E.Len))
+        return true;
+      break;
+    case EK_InvalidScanfConversionSpecifier:
+      if (!H.HandleInvalidScanfConversionSpecifier(ScanfSpecifiers[E.Index],
+                                                   E.Start, E.Len))
+        return true;
+      break;
+    case EK_ScanfSpecifier:
+      if (!H.HandleScanfSpecifier(ScanfSpecifiers[E.Index], E.Start, E.Len))
+        return true;
+      break;
+    case EK_IncompleteScanList:
+      H.HandleIncompleteScanList(E.Start, E.End);
+      break;
+    }
+  }
+  return Stopped;
+}
@@ -18,6 +18,7 @@
 #include "clang/AST/Attr.h"
 #include "clang/AST/DeclCXX.h"
 #include "clang/AST/ExprCXX.h"
+#include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/AST/StmtCXX.h"
 #include "clang/AST/StmtVisitor.h"
 #include "clang/Analysis/Analyses/PostOrderCFGView.h"
@@ -2377,18 +2378,109 @@ void ThreadSafetyAnalyzer::runAnalysis(AnalysisDeclContext &AC) {
 }
 
 
+/// \brief Returns true if the declaration carries any of the attributes the
+/// analysis acts upon.
+static bool hasThreadSafetyAttrs(const Decl *D) {
+  if (!D || !D->hasAttrs())
+    return false;
+  for (const Attr *A : D->attrs()) {
+    switch (A->getKind()) {
+    case attr::GuardedVar:
+    case attr::PtGuardedVar:
+    case attr::GuardedBy:
+    case attr::PtGuardedBy:
+    case attr::AcquiredAfter:
+    case attr::AcquiredBefore:
+    case attr::AssertCapability:
+    case attr::AssertExclusiveLock:
+    case attr::AssertSharedLock:
+    case attr::AcquireCapability:
+    case attr::TryAcquireCapability:
+    case attr::ReleaseCapability:
+    case attr::RequiresCapability:
+    case attr::ExclusiveTrylockFunction:
+    case attr::SharedTrylockFunction:
+    case attr::LockReturned:
+    case attr::LocksExcluded:
+      return true;
+    default:
+      break;
+    }
+  }
+  return false;
+}
+
+/// \brief Returns true if the type is a capability or a scoped lockable type,
+/// or a pointer or reference to one.
+static bool isCapabilityType(QualType T) {
+  for (QualType P = T->getPointeeType(); !P.isNull(); P = T->getPointeeType())
+    T = P;
+  if (const auto *TT = T->getAs<TypedefType>())
+    if (TT->getDecl()->hasAttr<CapabilityAttr>())
+      return true;
+  if (const auto *TD = T->getAsTagDecl())
+    return TD->hasAttr<CapabilityAttr>() || TD->hasAttr<ScopedLockableAttr>();
+  return false;
+}
+
+namespace {
+/// \brief Looks for a use of a capability or of a declaration with a thread
+/// safety attribute in a function body. A function without any can't produce
+/// a warning, so the analysis skips it without translating it.
+class CapabilityUseFinder
+    : public RecursiveASTVisitor<CapabilityUseFinder> {
+public:
+  bool Found = false;
+
+  bool checkDecl(const ValueDecl *D) {
+    if (hasThreadSafetyAttrs(D) || isCapabilityType(D->getType()))
+      Found = true;
+    return !Found;
+  }
+
+  bool VisitDeclRefExpr(DeclRefExpr *E) { return checkDecl(E->getDecl()); }
+  bool VisitMemberExpr(MemberExpr *E) {
+    return checkDecl(E->getMemberDecl());
+  }
+  bool VisitVarDecl(VarDecl *D) { return checkDecl(D); }
+
+  bool VisitCXXConstructExpr(CXXConstructExpr *E) {
+    const CXXConstructorDecl *Ctor = E->getConstructor();
+    if (hasThreadSafetyAttrs(Ctor) ||
+        hasThreadSafetyAttrs(Ctor->getParent()->getDestructor()) ||
+        isCapabilityType(E->getType()))
+      Found = true;
+    return !Found;
+  }
+};
+} // namespace
+
+static bool usesCapabilities(AnalysisDeclContext &AC) {
+  if (hasThreadSafetyAttrs(AC.getDecl()))
+    return true;
+  Stmt *Body = AC.getBody();
+  if (!Body)
+    return false;
+  CapabilityUseFinder Finder;
+  Finder.TraverseStmt(Body);
+  return Finder.Found;
+}
+
 /// \brief Check a function's CFG for thread-safety violations.
 ///
 /// We traverse the blocks in the CFG, compute the set of mutexes that are held
 /// at the end of each block, and issue warnings for thread safety violations.
 /// Each block in the CFG is traversed exactly once.
-void threadSafety::runThreadSafetyAnalysis(AnalysisDeclContext &AC,
+bool threadSafety::runThreadSafetyAnalysis(AnalysisDeclContext &AC,
                                            ThreadSafetyHandler &Handler,
                                            BeforeSet **BSet) {
+  if (!usesCapabilities(AC))
+    return false;
   if (!*BSet)
     *BSet = new BeforeSet;
   ThreadSafetyAnalyzer Analyzer(Handler, *BSet);
   Analyzer.runAnalysis(AC);
+  return true;
 }
 
 void threadSafety::threadSafetyCleanup(BeforeSet *Cache) { delete Cache; }
@@ -15,7 +15,10 @@
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/LangOptions.h"
 #include "clang/Basic/TargetInfo.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Mutex.h"
+#include <memory>
 using namespace clang;
 
 static const Builtin::Info BuiltinInfo[] = {
@@ -29,6 +32,34 @@ static const Builtin::Info BuiltinInfo[] = {
 #include "clang/Basic/Builtins.def"
 };
 
+class Builtin::Context::NameMap : public llvm::DenseMap<StringRef, unsigned> {
+};
+
+const Builtin::Context::NameMap *
+Builtin::Context::getNameMap(ArrayRef<Info> Records) {
+  if (Records.empty())
+    return nullptr;
+
+  // The name maps of all builtin tables seen by this process, keyed by their
+  // first record.  The tables are static, so the maps never go stale.
+  struct NameMapCache {
+    llvm::sys::Mutex Lock;
+    llvm::DenseMap<const Info *, std::unique_ptr<NameMap>> Maps;
+  };
+  static NameMapCache NameMaps;
+
+  llvm::sys::ScopedLock Guard(NameMaps.Lock);
+  std::unique_ptr<NameMap> &Map = NameMaps.Maps[Records.data()];
+  if (!Map) {
+    Map.reset(new NameMap);
+    // Should a name repeat, the later record wins, as it did when
+    // initializeBuiltins() marked the identifiers of all records in order.
+    for (unsigned i = 0, e = Records.size(); i != e; ++i)
+      (*Map)[Records[i].Name] = i;
+  }
+  return Map.get();
+}
+
 const Builtin::Info &Builtin::Context::getRecord(unsigned ID) const {
   if (ID < Builtin::FirstTSBuiltin)
     return BuiltinInfo[ID];
@@ -58,7 +89,7 @@ bool Builtin::Context::isBuiltinFunc(const char *Name) {
 }
 
 bool Builtin::Context::builtinIsSupported(const Builtin::Info &BuiltinInfo,
-                                          const LangOptions &LangOpts) {
+                                          const LangOptions &LangOpts) const {
   bool BuiltinsUnsupported =
       (LangOpts.NoBuiltin || LangOpts.isNoBuiltinFunc(BuiltinInfo.Name)) &&
       strchr(BuiltinInfo.Attributes, 'f');
@@ -80,21 +111,51 @@ bool Builtin::Context::builtinIsSupported(const Builtin::Info &BuiltinInfo,
 /// such.
 void Builtin::Context::initializeBuiltins(IdentifierTable &Table,
                                           const LangOptions& LangOpts) {
-  // Step #1: mark all target-independent builtins with their ID's.
-  for (unsigned i = Builtin::NotBuiltin+1; i != Builtin::FirstTSBuiltin; ++i)
-    if (builtinIsSupported(BuiltinInfo[i], LangOpts)) {
-      Table.get(BuiltinInfo[i].Name).setBuiltinID(i);
-    }
-
-  // Step #2: Register target-specific builtins.
-  for (unsigned i = 0, e = TSRecords.size(); i != e; ++i)
-    if (builtinIsSupported(TSRecords[i], LangOpts))
-      Table.get(TSRecords[i].Name).setBuiltinID(i + Builtin::FirstTSBuiltin);
-
-  // Step #3: Register target-specific builtins for AuxTarget.
-  for (unsigned i = 0, e = AuxTSRecords.size(); i != e; ++i)
-    Table.get(AuxTSRecords[i].Name)
-        .setBuiltinID(i + Builtin::FirstTSBuiltin + TSRecords.size());
+  initializeLazyBuiltins(Table, LangOpts);
+
+  // Identifiers created from now on are marked by the table; take care of the
+  // ones that exist already, such as the keywords.
+  for (const auto &Entry : Table)
+    if (IdentifierInfo *II = Entry.getValue())
+      if (unsigned ID = lookupBuiltinID(Entry.getKey(), LangOpts))
+        II->setBuiltinID(ID);
+}
+
+void Builtin::Context::initializeLazyBuiltins(IdentifierTable &Table,
+                                              const LangOptions &LangOpts) {
+  // Builtin records are static tables, so their name maps are only built by
+  // the first translation unit of the process that uses them.
+  Names = getNameMap(llvm::makeArrayRef(BuiltinInfo));
+  TSNames = getNameMap(TSRecords);
+  AuxTSNames = getNameMap(AuxTSRecords);
+
+  Table.setBuiltinInfo(this, &LangOpts);
+}
+
+unsigned Builtin::Context::lookupBuiltinID(StringRef Name,
+                                           const LangOptions &LangOpts) const {
+  assert(Names && "Builtins are not initialized");
+
+  // Target-specific builtins override target-independent ones of the same
+  // name, and builtins of the auxiliary target override both.
+  if (AuxTSNames) {
+    auto I = AuxTSNames->find(Name);
+    if (I != AuxTSNames->end())
+      return I->second + Builtin::FirstTSBuiltin + TSRecords.size();
+  }
+
+  if (TSNames) {
+    auto I = TSNames->find(Name);
+    if (I != TSNames->end() &&
+        builtinIsSupported(TSRecords[I->second], LangOpts))
+      return I->second + Builtin::FirstTSBuiltin;
+  }
+
+  auto I = Names->find(Name);
+  if (I != Names->end() && I->second != Builtin::NotBuiltin &&
+      builtinIsSupported(BuiltinInfo[I->second], LangOpts))
+    return I->second;
+  return 0;
 }
 
 void Builtin::Context::forgetBuiltin(unsigned ID, IdentifierTable &Table) {
@@ -0,0 +1,127 @@
+//===--- CompileTimeBudget.cpp - Watchdog for slow compilations -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the CompileTimeBudget class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/CompileTimeBudget.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstdlib>
+#ifdef LLVM_ON_UNIX
+#include <signal.h>
+#endif
+
+using namespace clang;
+
+/// \brief How long the watchdog waits for the compiling thread to reach a
+/// checkpoint before it aborts the compilation itself.
+static const std::chrono::seconds AbortGracePeriod(5);
+
+static CompileTimeBudget *ActiveBudget = nullptr;
+
+std::atomic<bool> CompileTimeBudget::Exceeded(false);
+std::atomic<const char *> CompileTimeBudget::CurrentPhase("startup");
+
+CompileTimeBudget::CompileTimeBudget(unsigned Seconds, StringRef ReportPath,
+                                     bool AbortWhenExceeded)
+    : Budget(Seconds), ReportPath(ReportPath),
+      AbortWhenExceeded(AbortWhenExceeded), StartTime(ClockType::now()),
+      ActivityReported(false) {
+#ifdef LLVM_ON_UNIX
+  CompilingThread = pthread_self();
+#endif
+  Watchdog = std::thread([this] { runWatchdog(); });
+}
+
+CompileTimeBudget::~CompileTimeBudget() {
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Finished = true;
+  }
+  Changed.notify_all();
+  Watchdog.join();
+}
+
+CompileTimeBudget *CompileTimeBudget::getActive() { return ActiveBudget; }
+
+void CompileTimeBudget::setActive(CompileTimeBudget *Budget) {
+  ActiveBudget = Budget;
+  Exceeded.store(false, std::memory_order_relaxed);
+}
+
+void CompileTimeBudget::writeReport() {
+  if (ReportPath.empty()) {
+    llvm::errs() << Report;
+    Report.clear();
+    return;
+  }
+
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(ReportPath, EC, llvm::sys::fs::F_Text);
+  if (EC) {
+    llvm::errs() << "error: unable to open compile-time budget report '"
+                 << ReportPath << "': " << EC.message() << "\n";
+    return;
+  }
+  OS << Report;
+}
+
+void CompileTimeBudget::runWatchdog() {
+  std::unique_lock<std::mutex> Lock(Mutex);
+  if (Changed.wait_for(Lock, Budget, [this] { return Finished; }))
+    return;
+
+  llvm::raw_string_ostream OS(Report);
+  OS << "compile-time budget of " << Budget.count() << " seconds exceeded\n"
+     << "phase: " << getPhase() << "\n";
+  OS.flush();
+  writeReport();
+  Exceeded.store(true, std::memory_order_relaxed);
+
+  if (!AbortWhenExceeded)
+    return;
+
+  // Give the compiling thread a chance to report what it is working on and
+  // abort itself; a thread stuck outside of any checkpoint is aborted here.
+  if (Changed.wait_for(Lock, AbortGracePeriod,
+                       [this] { return Finished || ActivityReported; }))
+    return;
+#ifdef LLVM_ON_UNIX
+  // Abort on the compiling thread, so that the crash handler prints its
+  // pretty stack trace.
+  pthread_kill(CompilingThread, SIGABRT);
+#else
+  std::abort();
+#endif
+}
+
+void CompileTimeBudget::reportActivity(
+    StringRef Activity, llvm::function_ref<void(raw_ostream &)> Describe) {
+  if (ActivityReported.exchange(true))
+    return;
+
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    llvm::raw_string_ostream OS(Report);
+    OS << "activity after "
+       << std::chrono::duration_cast<std::chrono::seconds>(ClockType::now() -
+                                                           StartTime)
+              .count()
+       << " seconds: " << Activity << "\n";
+    Describe(OS);
+    OS.flush();
+    writeReport();
+  }
+  Changed.notify_all();
+
+  if (AbortWhenExceeded)
+    std::abort();
+}
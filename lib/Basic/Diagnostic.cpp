@@ -136,6 +136,7 @@ void DiagnosticsEngine::Reset() {
   // through command-line.
   DiagStates.emplace_back();
   DiagStatePoints.push_back(DiagStatePoint(&DiagStates.back(), FullSourceLoc()));
+  invalidateIgnoredEverywhere();
 }
 
 void DiagnosticsEngine::SetDelayedDiagnostic(unsigned DiagID, StringRef Arg1,
@@ -178,6 +179,34 @@ DiagnosticsEngine::GetDiagStatePointForLoc(SourceLocation L) const {
   return Pos;
 }
 
+bool DiagnosticsEngine::isIgnoredEverywhere(unsigned DiagID) const {
+  if (DiagID >= diag::DIAG_UPPER_LIMIT)
+    return false;
+  if (IgnoredEverywhereKnown.empty()) {
+    IgnoredEverywhere.resize(diag::DIAG_UPPER_LIMIT);
+    IgnoredEverywhereKnown.resize(diag::DIAG_UPPER_LIMIT);
+  }
+  if (IgnoredEverywhereKnown.test(DiagID))
+    return IgnoredEverywhere.test(DiagID);
+
+  // Looking at states no point refers to anymore only makes this more
+  // conservative.
+  bool Ignored = true;
+  for (const DiagState &State : DiagStates) {
+    // getOrAddMapping only fills in the default mapping.
+    DiagnosticMapping &Mapping =
+        const_cast<DiagState &>(State).getOrAddMapping((diag::kind)DiagID);
+    if (Diags->getMappedSeverity(DiagID, Mapping, *this) !=
+        diag::Severity::Ignored) {
+      Ignored = false;
+      break;
+    }
+  }
+  IgnoredEverywhereKnown.set(DiagID);
+  IgnoredEverywhere[DiagID] = Ignored;
+  return Ignored;
+}
+
 void DiagnosticsEngine::setSeverity(diag::kind Diag, diag::Severity Map,
                                     SourceLocation L) {
   assert(Diag < diag::DIAG_UPPER_LIMIT &&
@@ -187,6 +216,7 @@ void DiagnosticsEngine::setSeverity(diag::kind Diag, diag::Severity Map,
          "Cannot map errors into warnings!");
   assert(!DiagStatePoints.empty());
   assert((L.isInvalid() || SourceMgr) && "No SourceMgr for valid location");
+  invalidateIgnoredEverywhere();
 
   FullSourceLoc Loc = SourceMgr? FullSourceLoc(L, *SourceMgr) : FullSourceLoc();
   FullSourceLoc LastStateChangePos = DiagStatePoints.back().Loc;
@@ -13,7 +13,11 @@
 
 #include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Basic/VirtualFileSystem.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
 
 using namespace clang;
 
@@ -124,3 +128,170 @@ MemorizeStatCalls::getStat(const char *Path, FileData &Data, bool isFile,
 
   return Result;
 }
+
+namespace {
+/// \brief A file whose contents are owned by a SharedStatCacheStorage.
+class SharedBufferFile : public vfs::File {
+  const SharedStatCacheStorage::Entry &E;
+
+public:
+  explicit SharedBufferFile(const SharedStatCacheStorage::Entry &E) : E(E) {}
+
+  llvm::ErrorOr<vfs::Status> status() override {
+    llvm::sys::TimeValue ModTime;
+    ModTime.fromEpochTime(E.Data.ModTime);
+    llvm::sys::fs::file_type Type = llvm::sys::fs::file_type::regular_file;
+    if (E.Data.IsNamedPipe)
+      Type = llvm::sys::fs::file_type::fifo_file;
+    return vfs::Status(E.Data.Name, E.Data.UniqueID, ModTime, 0, 0,
+                       E.Data.Size, Type, llvm::sys::fs::all_read);
+  }
+  llvm::ErrorOr<std::string> getName() override {
+    if (!E.RealPath.empty())
+      return E.RealPath;
+    return E.Data.Name;
+  }
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+  getBuffer(const Twine &Name, int64_t FileSize, bool RequiresNullTerminator,
+            bool IsVolatile) override {
+    return llvm::MemoryBuffer::getMemBuffer(E.Contents->getBuffer(),
+                                            Name.str(), RequiresNullTerminator);
+  }
+  std::error_code close() override { return std::error_code(); }
+};
+} // end anonymous namespace
+
+const SharedStatCacheStorage::Entry *
+SharedStatCacheStorage::lookup(StringRef Path, bool isFile,
+                               bool &KnownMissing) const {
+  llvm::sys::SmartScopedReader<true> Lock(Mutex);
+  KnownMissing = false;
+  auto I = Entries.find(Path);
+  if (I != Entries.end())
+    return &I->second;
+  KnownMissing =
+      isFile ? MissingFiles.count(Path) : MissingDirectories.count(Path);
+  return nullptr;
+}
+
+const SharedStatCacheStorage::Entry &
+SharedStatCacheStorage::insert(StringRef Path, Entry E) {
+  llvm::sys::SmartScopedWriter<true> Lock(Mutex);
+  // StringMap never moves its values, so references to entries stay valid as
+  // long as the storage is alive.
+  return Entries.insert(std::make_pair(Path, std::move(E))).first->second;
+}
+
+void SharedStatCacheStorage::insertMissing(StringRef Path, bool isFile) {
+  llvm::sys::SmartScopedWriter<true> Lock(Mutex);
+  if (isFile)
+    MissingFiles.insert(Path);
+  else
+    MissingDirectories.insert(Path);
+}
+
+unsigned SharedStatCacheStorage::size() const {
+  llvm::sys::SmartScopedReader<true> Lock(Mutex);
+  return Entries.size();
+}
+
+SharedStatCache::LookupResult
+SharedStatCache::getStat(const char *Path, FileData &Data, bool isFile,
+                         std::unique_ptr<vfs::File> *F, vfs::FileSystem &FS) {
+  // Relative paths are resolved against the working directory of FS, so their
+  // results cannot be shared.
+  if (!llvm::sys::path::is_absolute(Path))
+    return statChained(Path, Data, isFile, F, FS);
+
+  bool KnownMissing;
+  if (const SharedStatCacheStorage::Entry *E =
+          Storage->lookup(Path, isFile, KnownMissing)) {
+    Data = E->Data;
+    if (F && E->Contents)
+      *F = llvm::make_unique<SharedBufferFile>(*E);
+    return CacheExists;
+  }
+  if (KnownMissing)
+    return CacheMissing;
+
+  LookupResult Result = statChained(Path, Data, isFile, F, FS);
+  if (Result == CacheMissing) {
+    // Note that this may also mean that Path exists, but is a directory when a
+    // file was requested or vice versa, which is why failures are recorded
+    // separately for files and directories.
+    if (Storage->cachesMissingFiles())
+      Storage->insertMissing(Path, isFile);
+    return Result;
+  }
+
+  SharedStatCacheStorage::Entry NewEntry;
+  NewEntry.Data = Data;
+  if (F && *F && Storage->cachesContents() && !Data.IsDirectory) {
+    if (auto RealPathName = (*F)->getName())
+      NewEntry.RealPath = *RealPathName;
+    auto Buffer = (*F)->getBuffer(Path, Data.Size,
+                                  /*RequiresNullTerminator=*/true,
+                                  /*IsVolatile=*/false);
+    if (Buffer)
+      NewEntry.Contents = std::move(*Buffer);
+  }
+
+  const SharedStatCacheStorage::Entry &E =
+      Storage->insert(Path, std::move(NewEntry));
+  if (F && *F && E.Contents)
+    *F = llvm::make_unique<SharedBufferFile>(E);
+  return Result;
+}
+
+PrefetchedStatCache::PrefetchedStatCache(ArrayRef<std::string> Paths,
+                                         vfs::FileSystem &FS,
+                                         unsigned NumThreads) {
+  std::vector<vfs::Status> Results(Paths.size());
+  std::vector<char> Found(Paths.size());
+  {
+    unsigned NumWorkers =
+        std::max(1u, std::min<unsigned>(NumThreads, Paths.size()));
+    std::atomic<unsigned> NextPath(0);
+    llvm::ThreadPool Pool(NumWorkers);
+    for (unsigned I = 0; I != NumWorkers; ++I)
+      Pool.async([&] {
+        for (unsigned Idx = NextPath++; Idx < Paths.size(); Idx = NextPath++) {
+          llvm::ErrorOr<vfs::Status> Status = FS.status(Paths[Idx]);
+          if (!Status)
+            continue;
+          Found[Idx] = true;
+          Results[Idx] = std::move(*Status);
+        }
+      });
+    Pool.wait();
+  }
+
+  for (unsigned I = 0, E = Paths.size(); I != E; ++I) {
+    if (!Found[I]) {
+      Missing.insert(Paths[I]);
+      continue;
+    }
+    FileData Data;
+    copyStatusToFileData(Results[I], Data);
+    StatCalls[Paths[I]] = Data;
+  }
+}
+
+PrefetchedStatCache::LookupResult
+PrefetchedStatCache::getStat(const char *Path, FileData &Data, bool isFile,
+                             std::unique_ptr<vfs::File> *F,
+                             vfs::FileSystem &FS) {
+  // We only know about the status; opening the file still has to go to the
+  // file system.
+  if (F)
+    return statChained(Path, Data, isFile, F, FS);
+
+  auto I = StatCalls.find(Path);
+  if (I != StatCalls.end()) {
+    Data = I->second;
+    return CacheExists;
+  }
+  if (Missing.count(Path))
+    return CacheMissing;
+  return statChained(Path, Data, isFile, F, FS);
+}
@@ -12,6 +12,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "clang/Basic/Builtins.h"
 #include "clang/Basic/CharInfo.h"
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/LangOptions.h"
@@ -75,7 +76,8 @@ IdentifierIterator *IdentifierInfoLookup::getIdentifiers() {
 IdentifierTable::IdentifierTable(const LangOptions &LangOpts,
                                  IdentifierInfoLookup* externalLookup)
   : HashTable(8192), // Start with space for 8K identifiers.
-    ExternalLookup(externalLookup) {
+    ExternalLookup(externalLookup), Keywords(KeywordIndex::get()),
+    KeywordInfos(new IdentifierInfo *[KeywordIndex::NumSlots]()) {
 
   // Populate the identifier table with info about keywords for the current
   // language.
@@ -86,6 +88,11 @@ IdentifierTable::IdentifierTable(const LangOptions &LangOpts,
   get("import").setModulesImport(true);
 }
 
+void IdentifierTable::initializeBuiltinID(IdentifierInfo &II) {
+  if (unsigned ID = Builtins->lookupBuiltinID(II.getName(), *BuiltinLangOpts))
+    II.setBuiltinID(ID);
+}
+
 //===----------------------------------------------------------------------===//
 // Language Keyword Implementation
 //===----------------------------------------------------------------------===//
@@ -197,6 +204,33 @@ static void AddObjCKeyword(StringRef Name,
   Table.get(Name).setObjCKeywordID(ObjCID);
 }
 
+IdentifierTable::KeywordIndex::KeywordIndex() {
+  memset(Names, 0, sizeof(Names));
+  memset(Lengths, 0, sizeof(Lengths));
+#define KEYWORD(NAME, FLAGS) add(#NAME);
+#define ALIAS(NAME, TOK, FLAGS) add(NAME);
+#define CXX_KEYWORD_OPERATOR(NAME, ALIAS) add(#NAME);
+#define OBJC1_AT_KEYWORD(NAME) add(#NAME);
+#define OBJC2_AT_KEYWORD(NAME) add(#NAME);
+#define TESTING_KEYWORD(NAME, FLAGS)
+#include "clang/Basic/TokenKinds.def"
+}
+
+void IdentifierTable::KeywordIndex::add(StringRef Name) {
+  assert(Name.size() < 256 && "keyword too long for the index");
+  unsigned Slot = hash(Name);
+  for (; Names[Slot]; Slot = (Slot + 1) % NumSlots)
+    if (getName(Slot) == Name)
+      return;
+  Names[Slot] = Name.data();
+  Lengths[Slot] = Name.size();
+}
+
+const IdentifierTable::KeywordIndex &IdentifierTable::KeywordIndex::get() {
+  static const KeywordIndex Index;
+  return Index;
+}
+
 /// AddKeywords - Add all keywords to the symbol table.
 ///
 void IdentifierTable::AddKeywords(const LangOptions &LangOpts) {
@@ -225,6 +259,15 @@ void IdentifierTable::AddKeywords(const LangOptions &LangOpts) {
 
   if (LangOpts.DeclSpecKeyword)
     AddKeyword("__declspec", tok::kw___declspec, KEYALL, LangOpts, *this);
+
+  // Remember the identifiers of the keywords that were added, so that get()
+  // finds them without going through the hash table.
+  for (unsigned Slot = 0; Slot != KeywordIndex::NumSlots; ++Slot) {
+    if (Keywords.getName(Slot).empty())
+      continue;
+    auto I = HashTable.find(Keywords.getName(Slot));
+    KeywordInfos[Slot] = I == HashTable.end() ? nullptr : I->second;
+  }
 }
 
 /// \brief Checks if the specified token kind represents a keyword in the
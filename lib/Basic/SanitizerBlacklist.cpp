@@ -12,6 +12,7 @@
 //
 //===----------------------------------------------------------------------===//
 #include "clang/Basic/SanitizerBlacklist.h"
+#include "llvm/ADT/SmallString.h"
 
 using namespace clang;
 
@@ -19,6 +20,19 @@ SanitizerBlacklist::SanitizerBlacklist(
     const std::vector<std::string> &BlacklistPaths, SourceManager &SM)
     : SCL(llvm::SpecialCaseList::createOrDie(BlacklistPaths)), SM(SM) {}
 
+bool SanitizerBlacklist::inCachedSection(StringRef Section, StringRef Name,
+                                         StringRef Category) const {
+  SmallString<128> Key(Section);
+  Key += '\0';
+  Key += Category;
+  Key += '\0';
+  Key += Name;
+  auto Inserted = CachedResults.insert(std::make_pair(Key, false));
+  if (Inserted.second)
+    Inserted.first->second = SCL->inSection(Section, Name, Category);
+  return Inserted.first->second;
+}
+
 bool SanitizerBlacklist::isBlacklistedGlobal(StringRef GlobalName,
                                              StringRef Category) const {
   return SCL->inSection("global", GlobalName, Category);
@@ -26,7 +40,7 @@ bool SanitizerBlacklist::isBlacklistedGlobal(StringRef GlobalName,
 
 bool SanitizerBlacklist::isBlacklistedType(StringRef MangledTypeName,
                                            StringRef Category) const {
-  return SCL->inSection("type", MangledTypeName, Category);
+  return inCachedSection("type", MangledTypeName, Category);
 }
 
 bool SanitizerBlacklist::isBlacklistedFunction(StringRef FunctionName) const {
@@ -35,7 +49,7 @@ bool SanitizerBlacklist::isBlacklistedFunction(StringRef FunctionName) const {
 
 bool SanitizerBlacklist::isBlacklistedFile(StringRef FileName,
                                            StringRef Category) const {
-  return SCL->inSection("src", FileName, Category);
+  return inCachedSection("src", FileName, Category);
 }
 
 bool SanitizerBlacklist::isBlacklistedLocation(SourceLocation Loc,
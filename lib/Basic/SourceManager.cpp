@@ -20,6 +20,7 @@
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/Capacity.h"
 #include "llvm/Support/Compiler.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
@@ -363,7 +364,7 @@ SourceManager::SourceManager(DiagnosticsEngine &Diag, FileManager &FileMgr,
   : Diag(Diag), FileMgr(FileMgr), OverridenFilesKeepOriginalName(true),
     UserFilesAreVolatile(UserFilesAreVolatile), FilesAreTransient(false),
     ExternalSLocEntries(nullptr), LineTable(nullptr), NumLinearScans(0),
-    NumBinaryProbes(0) {
+    NumBinaryProbes(0), NumRecentFileIDHits(0) {
   clearIDTables();
   Diag.setSourceManager(this);
 }
@@ -399,6 +400,7 @@ void SourceManager::clearIDTables() {
   LastLineNoFileIDQuery = FileID();
   LastLineNoContentCache = nullptr;
   LastFileIDLookup = FileID();
+  std::fill_n(RecentFileIDLookups, NumRecentFileIDLookups, FileID());
 
   if (LineTable)
     LineTable->clear();
@@ -570,13 +572,15 @@ FileID SourceManager::createFileID(const ContentCache *File,
     SLocEntryLoaded[Index] = true;
     return FileID::get(LoadedID);
   }
+  unsigned FileSize = File->getSize();
+  if (!(NextLocalOffset + FileSize + 1 > NextLocalOffset &&
+        NextLocalOffset + FileSize + 1 <= CurrentLoadedOffset)) {
+    Diag.Report(IncludePos, diag::err_include_too_large);
+    return FileID();
+  }
   LocalSLocEntryTable.push_back(SLocEntry::get(NextLocalOffset,
                                                FileInfo::get(IncludePos, File,
                                                              FileCharacter)));
-  unsigned FileSize = File->getSize();
-  assert(NextLocalOffset + FileSize + 1 > NextLocalOffset &&
-         NextLocalOffset + FileSize + 1 <= CurrentLoadedOffset &&
-         "Ran out of source locations!");
   // We do a +1 here because we want a SourceLocation that means "the end of the
   // file", e.g. for the "no newline at the end of the file" diagnostic.
   NextLocalOffset += FileSize + 1;
@@ -584,7 +588,8 @@ FileID SourceManager::createFileID(const ContentCache *File,
   // Set LastFileIDLookup to the newly created file.  The next getFileID call is
   // almost guaranteed to be from that file.
   FileID FID = FileID::get(LocalSLocEntryTable.size()-1);
-  return LastFileIDLookup = FID;
+  cacheFileIDLookup(FID);
+  return FID;
 }
 
 SourceLocation
@@ -622,10 +627,15 @@ SourceManager::createExpansionLocImpl(const ExpansionInfo &Info,
     SLocEntryLoaded[Index] = true;
     return SourceLocation::getMacroLoc(LoadedOffset);
   }
+  if (!(NextLocalOffset + TokLength + 1 > NextLocalOffset &&
+        NextLocalOffset + TokLength + 1 <= CurrentLoadedOffset)) {
+    Diag.Report(Info.getExpansionLocStart(), diag::err_sloc_space_too_large);
+    // Every location we could hand out would alias an existing one, and the
+    // callers have no way to recover from an invalid one, so stop here rather
+    // than silently wrapping around.
+    llvm::report_fatal_error("ran out of source locations");
+  }
   LocalSLocEntryTable.push_back(SLocEntry::get(NextLocalOffset, Info));
-  assert(NextLocalOffset + TokLength + 1 > NextLocalOffset &&
-         NextLocalOffset + TokLength + 1 <= CurrentLoadedOffset &&
-         "Ran out of source locations!");
   // See createFileID for that +1.
   NextLocalOffset += TokLength + 1;
   return SourceLocation::getMacroLoc(NextLocalOffset - (TokLength + 1));
@@ -712,6 +722,17 @@ FileID SourceManager::getFileIDSlow(unsigned SLocOffset) const {
   if (!SLocOffset)
     return FileID::get(0);
 
+  // See whether one of the other recently used files covers this offset.
+  for (FileID FID : RecentFileIDLookups) {
+    if (FID.isInvalid())
+      break;
+    if (isOffsetInFileID(FID, SLocOffset)) {
+      ++NumRecentFileIDHits;
+      cacheFileIDLookup(FID);
+      return FID;
+    }
+  }
+
   // Now it is time to search for the correct file. See where the SLocOffset
   // sits in the global view and consult local or loaded buffers for it.
   if (SLocOffset < NextLocalOffset)
@@ -719,6 +740,47 @@ FileID SourceManager::getFileIDSlow(unsigned SLocOffset) const {
   return getFileIDLoaded(SLocOffset);
 }
 
+/// \brief Make \p FID the most recently looked up FileID, keeping the ones
+/// looked up before it in RecentFileIDLookups.
+void SourceManager::cacheFileIDLookup(FileID FID) const {
+  if (FID == LastFileIDLookup)
+    return;
+
+  // Shift the entries more recent than FID down by one, overwriting FID if
+  // it is there and the least recent entry otherwise.
+  unsigned I = 0;
+  while (I != NumRecentFileIDLookups - 1 && RecentFileIDLookups[I] != FID)
+    ++I;
+  for (; I != 0; --I)
+    RecentFileIDLookups[I] = RecentFileIDLookups[I - 1];
+  RecentFileIDLookups[0] = LastFileIDLookup;
+  LastFileIDLookup = FID;
+}
+
+void SourceManager::getDecomposedLocs(
+    ArrayRef<SourceLocation> Locs,
+    SmallVectorImpl<std::pair<FileID, unsigned>> &Result) const {
+  Result.reserve(Result.size() + Locs.size());
+
+  FileID FID;
+  unsigned StartOffset = 0;
+  for (SourceLocation Loc : Locs) {
+    unsigned Offset = Loc.getOffset();
+    if (FID.isInvalid() || !isOffsetInFileID(FID, Offset)) {
+      FID = getFileID(Loc);
+      bool Invalid = false;
+      const SrcMgr::SLocEntry &E = getSLocEntry(FID, &Invalid);
+      if (Invalid) {
+        FID = FileID();
+        Result.push_back(std::make_pair(FileID(), 0));
+        continue;
+      }
+      StartOffset = E.getOffset();
+    }
+    Result.push_back(std::make_pair(FID, Offset - StartOffset));
+  }
+}
+
 /// \brief Return the FileID for a SourceLocation with a low offset.
 ///
 /// This function knows that the SourceLocation is in a local buffer, not a
@@ -759,7 +821,7 @@ FileID SourceManager::getFileIDLocal(unsigned SLocOffset) const {
       // If this isn't an expansion, remember it.  We have good locality across
       // FileID lookups.
       if (!I->isExpansion())
-        LastFileIDLookup = Res;
+        cacheFileIDLookup(Res);
       NumLinearScans += NumProbes+1;
       return Res;
     }
@@ -800,7 +862,7 @@ FileID SourceManager::getFileIDLocal(unsigned SLocOffset) const {
       // If this isn't a macro expansion, remember it.  We have good locality
       // across FileID lookups.
       if (!LocalSLocEntryTable[MiddleIndex].isExpansion())
-        LastFileIDLookup = Res;
+        cacheFileIDLookup(Res);
       NumBinaryProbes += NumProbes;
       return Res;
     }
@@ -840,7 +902,7 @@ FileID SourceManager::getFileIDLoaded(unsigned SLocOffset) const {
       FileID Res = FileID::get(-int(I) - 2);
 
       if (!E.isExpansion())
-        LastFileIDLookup = Res;
+        cacheFileIDLookup(Res);
       NumLinearScans += NumProbes + 1;
       return Res;
     }
@@ -874,7 +936,7 @@ FileID SourceManager::getFileIDLoaded(unsigned SLocOffset) const {
     if (isOffsetInFileID(FileID::get(-int(MiddleIndex) - 2), SLocOffset)) {
       FileID Res = FileID::get(-int(MiddleIndex) - 2);
       if (!E.isExpansion())
-        LastFileIDLookup = Res;
+        cacheFileIDLookup(Res);
       NumBinaryProbes += NumProbes;
       return Res;
     }
@@ -1214,65 +1276,46 @@ static void ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
 
   const unsigned char *Buf = (const unsigned char *)Buffer->getBufferStart();
   const unsigned char *End = (const unsigned char *)Buffer->getBufferEnd();
-  unsigned Offs = 0;
-  while (1) {
-    // Skip over the contents of the line.
-    const unsigned char *NextBuf = (const unsigned char *)Buf;
 
-#ifdef __SSE2__
-    // Try to skip to the next newline using SSE instructions. This is very
-    // performance sensitive for programs with lots of diagnostics and in -E
-    // mode.
-    __m128i CRs = _mm_set1_epi8('\r');
-    __m128i LFs = _mm_set1_epi8('\n');
-
-    // First fix up the alignment to 16 bytes.
-    while (((uintptr_t)NextBuf & 0xF) != 0) {
-      if (*NextBuf == '\n' || *NextBuf == '\r' || *NextBuf == '\0')
-        goto FoundSpecialChar;
-      ++NextBuf;
-    }
+  // The start of the next line, which is past the newline we last saw. A
+  // newline is '\n', '\r', "\r\n" or "\n\r". Null characters are ordinary
+  // characters here; the buffer is null-terminated, so we can always look one
+  // character past a newline.
+  const unsigned char *LineStart = Buf;
+  auto FoundNewline = [&](const unsigned char *NL) {
+    LineStart = NL + 1;
+    if ((NL[1] == '\n' || NL[1] == '\r') && NL[0] != NL[1])
+      ++LineStart;
+    LineOffsets.push_back(LineStart - Buf);
+  };
 
-    // Scan 16 byte chunks for '\r' and '\n'. Ignore '\0'.
-    while (NextBuf+16 <= End) {
-      const __m128i Chunk = *(const __m128i*)NextBuf;
-      __m128i Cmp = _mm_or_si128(_mm_cmpeq_epi8(Chunk, CRs),
-                                 _mm_cmpeq_epi8(Chunk, LFs));
-      unsigned Mask = _mm_movemask_epi8(Cmp);
-
-      // If we found a newline, adjust the pointer and jump to the handling code.
-      if (Mask != 0) {
-        NextBuf += llvm::countTrailingZeros(Mask);
-        goto FoundSpecialChar;
-      }
-      NextBuf += 16;
+  const unsigned char *Scan = Buf;
+#ifdef __SSE2__
+  // Find the newlines 16 bytes at a time. This is very performance sensitive
+  // for programs with lots of diagnostics and in -E mode, so handle every
+  // newline found in a chunk from its mask rather than rescanning from each
+  // line start; source lines are often shorter than a chunk.
+  const __m128i CRs = _mm_set1_epi8('\r');
+  const __m128i LFs = _mm_set1_epi8('\n');
+  for (; Scan + 16 <= End; Scan += 16) {
+    const __m128i Chunk = _mm_loadu_si128((const __m128i *)Scan);
+    unsigned Mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(Chunk, CRs),
+                                                   _mm_cmpeq_epi8(Chunk, LFs)));
+    while (Mask) {
+      const unsigned char *NL = Scan + llvm::countTrailingZeros(Mask);
+      Mask &= Mask - 1;
+      // Skip the second half of a two-character newline.
+      if (NL >= LineStart)
+        FoundNewline(NL);
     }
+  }
 #endif
 
-    while (*NextBuf != '\n' && *NextBuf != '\r' && *NextBuf != '\0')
-      ++NextBuf;
-
-#ifdef __SSE2__
-FoundSpecialChar:
-#endif
-    Offs += NextBuf-Buf;
-    Buf = NextBuf;
-
-    if (Buf[0] == '\n' || Buf[0] == '\r') {
-      // If this is \n\r or \r\n, skip both characters.
-      if ((Buf[1] == '\n' || Buf[1] == '\r') && Buf[0] != Buf[1]) {
-        ++Offs;
-        ++Buf;
-      }
-      ++Offs;
-      ++Buf;
-      LineOffsets.push_back(Offs);
-    } else {
-      // Otherwise, this is a null.  If end of file, exit.
-      if (Buf == End) break;
-      // Otherwise, skip the null.
-      ++Offs;
-      ++Buf;
+  // Scan the rest of the buffer a character at a time.
+  for (Scan = std::max(Scan, LineStart); Scan < End; ++Scan) {
+    if (*Scan == '\n' || *Scan == '\r') {
+      FoundNewline(Scan);
+      Scan = LineStart - 1;
     }
   }
 
@@ -2136,6 +2179,21 @@ void SourceManager::PrintStats() const {
                << llvm::capacity_in_bytes(LocalSLocEntryTable)
                << " bytes of capacity), "
                << NextLocalOffset << "B of Sloc address space used.\n";
+
+  // Say how much of the local address space went to macro expansions, since
+  // that is what usually exhausts it.
+  unsigned NumExpansions = 0;
+  unsigned ExpansionBytes = 0;
+  for (unsigned I = 0, N = LocalSLocEntryTable.size(); I != N; ++I) {
+    if (!LocalSLocEntryTable[I].isExpansion())
+      continue;
+    unsigned End = I + 1 == N ? NextLocalOffset
+                              : LocalSLocEntryTable[I + 1].getOffset();
+    ++NumExpansions;
+    ExpansionBytes += End - LocalSLocEntryTable[I].getOffset();
+  }
+  llvm::errs() << NumExpansions << " local macro expansions, using "
+               << ExpansionBytes << "B of Sloc address space.\n";
   llvm::errs() << LoadedSLocEntryTable.size()
                << " loaded SLocEntries allocated, "
                << MaxLoadedOffset - CurrentLoadedOffset
@@ -2153,7 +2211,8 @@ void SourceManager::PrintStats() const {
                << NumLineNumsComputed << " files with line #'s computed, "
                << NumMacroArgsComputed << " files with macro args computed.\n";
   llvm::errs() << "FileID scans: " << NumLinearScans << " linear, "
-               << NumBinaryProbes << " binary.\n";
+               << NumBinaryProbes << " binary, " << NumRecentFileIDHits
+               << " recent file hits.\n";
 }
 
 LLVM_DUMP_METHOD void SourceManager::dump() const {
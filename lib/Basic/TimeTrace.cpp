@@ -0,0 +1,143 @@
+//===--- TimeTrace.cpp - Hierarchical compilation time trace ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the TimeTrace class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/TimeTrace.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cassert>
+
+using namespace clang;
+
+static TimeTrace *ActiveTimeTrace = nullptr;
+
+TimeTrace::TimeTrace() : StartTime(ClockType::now()) {}
+
+TimeTrace *TimeTrace::getActive() { return ActiveTimeTrace; }
+
+void TimeTrace::setActive(TimeTrace *Trace) { ActiveTimeTrace = Trace; }
+
+void TimeTrace::begin(StringRef Name, StringRef Detail) {
+  for (Event &Open : Stack)
+    ++Open.NumNested;
+
+  Event E;
+  E.Name = Name;
+  E.Detail = Detail;
+  E.Start = ClockType::now();
+  E.NumNested = 0;
+  Stack.push_back(std::move(E));
+}
+
+void TimeTrace::addArg(StringRef Name, uint64_t Value) {
+  assert(!Stack.empty() && "no open time trace event");
+  Stack.back().Args.push_back(std::make_pair(Name.str(), Value));
+}
+
+void TimeTrace::end() {
+  assert(!Stack.empty() && "unbalanced time trace events");
+  Event E = std::move(Stack.back());
+  Stack.pop_back();
+  E.Duration = ClockType::now() - E.Start;
+
+  // Only the outermost of several nested events with the same name
+  // contributes to the total, so recursion isn't counted twice.
+  bool IsOutermost = true;
+  for (const Event &Open : Stack) {
+    if (Open.Name == E.Name) {
+      IsOutermost = false;
+      break;
+    }
+  }
+  if (IsOutermost) {
+    auto &Total = Totals[E.Name];
+    ++Total.first;
+    Total.second += E.Duration;
+  }
+
+  Completed.push_back(std::move(E));
+}
+
+/// \brief Write \p Str as a JSON string literal.
+static void writeJSONString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (unsigned char C : Str) {
+    switch (C) {
+    case '"':  OS << "\\\""; break;
+    case '\\': OS << "\\\\"; break;
+    case '\n': OS << "\\n"; break;
+    case '\t': OS << "\\t"; break;
+    default:
+      if (C < 0x20)
+        OS << llvm::format("\\u%04x", C);
+      else
+        OS << C;
+      break;
+    }
+  }
+  OS << '"';
+}
+
+void TimeTrace::write(raw_ostream &OS) const {
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+
+  OS << "{\"traceEvents\":[";
+  bool First = true;
+  for (const Event &E : Completed) {
+    if (!First)
+      OS << ',';
+    First = false;
+
+    OS << "\n{\"pid\":1,\"tid\":0,\"ph\":\"X\",\"ts\":"
+       << (uint64_t)duration_cast<microseconds>(E.Start - StartTime).count()
+       << ",\"dur\":"
+       << (uint64_t)duration_cast<microseconds>(E.Duration).count()
+       << ",\"name\":";
+    writeJSONString(OS, E.Name);
+    OS << ",\"args\":{\"detail\":";
+    writeJSONString(OS, E.Detail);
+    OS << ",\"nested\":" << E.NumNested;
+    for (const auto &Arg : E.Args) {
+      OS << ',';
+      writeJSONString(OS, Arg.first);
+      OS << ':' << Arg.second;
+    }
+    OS << "}}";
+  }
+
+  // Emit the totals on their own row, longest first.
+  typedef std::pair<StringRef, std::pair<unsigned, ClockType::duration>>
+      TotalEntry;
+  std::vector<TotalEntry> SortedTotals;
+  for (const auto &Total : Totals)
+    SortedTotals.push_back(TotalEntry(Total.getKey(), Total.getValue()));
+  std::sort(SortedTotals.begin(), SortedTotals.end(),
+            [](const TotalEntry &LHS, const TotalEntry &RHS) {
+    if (LHS.second.second != RHS.second.second)
+      return LHS.second.second > RHS.second.second;
+    return LHS.first < RHS.first;
+  });
+  for (const auto &Total : SortedTotals) {
+    if (!First)
+      OS << ',';
+    First = false;
+
+    OS << "\n{\"pid\":1,\"tid\":1,\"ph\":\"X\",\"ts\":0,\"dur\":"
+       << (uint64_t)duration_cast<microseconds>(Total.second.second).count()
+       << ",\"name\":";
+    writeJSONString(OS, ("Total " + Total.first).str());
+    OS << ",\"args\":{\"count\":" << Total.second.first << "}}";
+  }
+  OS << "\n]}\n";
+}
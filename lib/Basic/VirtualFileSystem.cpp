@@ -722,6 +722,13 @@ class RedirectingDirectoryEntry : public Entry {
   std::vector<std::unique_ptr<Entry>> Contents;
   Status S;
 
+  /// \brief The first entry in \c Contents with each name, lowercased if
+  /// lookups are case-insensitive.  Only built for large directories, see
+  /// \c indexContents().
+  llvm::StringMap<Entry *> ContentsByName;
+  bool IsIndexed = false;
+  bool HasUnnamedContents = false;
+
 public:
   RedirectingDirectoryEntry(StringRef Name,
                             std::vector<std::unique_ptr<Entry>> Contents,
@@ -735,6 +742,20 @@ public:
     Contents.push_back(std::move(Content));
   }
   Entry *getLastContent() const { return Contents.back().get(); }
+
+  /// \brief Index the contents of this directory and of its subdirectories
+  /// by name so that \c lookupContent() doesn't scan them.  Must be called
+  /// again if contents are added.
+  void indexContents(bool CaseSensitive);
+
+  /// \brief Returns the first entry in the contents named \p Name, or null.
+  /// Entries with empty names are never returned.
+  Entry *lookupContent(StringRef Name, bool CaseSensitive) const;
+
+  /// \brief Whether some of the contents have empty names, as of the last
+  /// call to \c indexContents().
+  bool hasUnnamedContents() const { return HasUnnamedContents; }
+
   typedef decltype(Contents)::iterator iterator;
   iterator contents_begin() { return Contents.begin(); }
   iterator contents_end() { return Contents.end(); }
@@ -966,6 +987,10 @@ LLVM_DUMP_METHOD void dumpEntry(Entry *E, int NumSpaces = 0) const {
 class RedirectingFileSystemParser {
   yaml::Stream &Stream;
 
+  /// \brief The directories created by \c lookupOrCreateEntry(), keyed by
+  /// their parent (null for roots) and their name.
+  DenseMap<std::pair<Entry *, StringRef>, Entry *> UniquedDirs;
+
   void error(yaml::Node *N, const Twine &Msg) {
     Stream.printError(N, Msg);
   }
@@ -1041,37 +1066,30 @@ class RedirectingFileSystemParser {
 
   Entry *lookupOrCreateEntry(RedirectingFileSystem *FS, StringRef Name,
                              Entry *ParentEntry = nullptr) {
-    if (!ParentEntry) { // Look for a existent root
-      for (const std::unique_ptr<Entry> &Root : FS->Roots) {
-        if (Name.equals(Root->getName())) {
-          ParentEntry = Root.get();
-          return ParentEntry;
-        }
-      }
-    } else { // Advance to the next component
-      auto *DE = dyn_cast<RedirectingDirectoryEntry>(ParentEntry);
-      for (std::unique_ptr<Entry> &Content :
-           llvm::make_range(DE->contents_begin(), DE->contents_end())) {
-        auto *DirContent = dyn_cast<RedirectingDirectoryEntry>(Content.get());
-        if (DirContent && Name.equals(Content->getName()))
-          return DirContent;
-      }
-    }
+    // Look for an existing root or subdirectory. Only directories are
+    // created here, so only directories are found.
+    auto Known = UniquedDirs.find(std::make_pair(ParentEntry, Name));
+    if (Known != UniquedDirs.end())
+      return Known->second;
 
     // ... or create a new one
     std::unique_ptr<Entry> E = llvm::make_unique<RedirectingDirectoryEntry>(
         Name, Status("", getNextVirtualUniqueID(), sys::TimeValue::now(), 0, 0,
                      0, file_type::directory_file, sys::fs::all_all));
 
+    Entry *NewEntry;
     if (!ParentEntry) { // Add a new root to the overlay
       FS->Roots.push_back(std::move(E));
-      ParentEntry = FS->Roots.back().get();
-      return ParentEntry;
+      NewEntry = FS->Roots.back().get();
+    } else {
+      auto *DE = dyn_cast<RedirectingDirectoryEntry>(ParentEntry);
+      DE->addContent(std::move(E));
+      NewEntry = DE->getLastContent();
     }
 
-    auto *DE = dyn_cast<RedirectingDirectoryEntry>(ParentEntry);
-    DE->addContent(std::move(E));
-    return DE->getLastContent();
+    // Key on the new entry's copy of the name, which lives as long as we do.
+    UniquedDirs[std::make_pair(ParentEntry, NewEntry->getName())] = NewEntry;
+    return NewEntry;
   }
 
   void uniqueOverlayTree(RedirectingFileSystem *FS, Entry *SrcE,
@@ -1376,6 +1394,12 @@ public:
     for (std::unique_ptr<Entry> &E : RootEntries)
       uniqueOverlayTree(FS, E.get());
 
+    // Overlays can map hundreds of thousands of files, so index them by name
+    // instead of comparing every entry of a directory on each lookup.
+    for (std::unique_ptr<Entry> &Root : FS->Roots)
+      if (auto *DE = dyn_cast<RedirectingDirectoryEntry>(Root.get()))
+        DE->indexContents(FS->CaseSensitive);
+
     return true;
   }
 };
@@ -1383,6 +1407,47 @@ public:
 
 Entry::~Entry() = default;
 
+void RedirectingDirectoryEntry::indexContents(bool CaseSensitive) {
+  // Scanning a few entries is cheaper than hashing the name.
+  const unsigned MinIndexedContents = 8;
+
+  ContentsByName.clear();
+  IsIndexed = Contents.size() >= MinIndexedContents;
+  HasUnnamedContents = false;
+  for (const std::unique_ptr<Entry> &Content : Contents) {
+    if (auto *DE = dyn_cast<RedirectingDirectoryEntry>(Content.get()))
+      DE->indexContents(CaseSensitive);
+    StringRef Name = Content->getName();
+    if (Name.empty()) {
+      HasUnnamedContents = true;
+      continue;
+    }
+    if (!IsIndexed)
+      continue;
+    // Keep the first entry, which is the one a scan would find.
+    std::string Key = CaseSensitive ? Name.str() : Name.lower();
+    ContentsByName.insert(std::make_pair(StringRef(Key), Content.get()));
+  }
+}
+
+Entry *RedirectingDirectoryEntry::lookupContent(StringRef Name,
+                                                bool CaseSensitive) const {
+  if (Name.empty())
+    return nullptr;
+
+  if (IsIndexed) {
+    if (CaseSensitive)
+      return ContentsByName.lookup(Name);
+    return ContentsByName.lookup(Name.lower());
+  }
+
+  for (const std::unique_ptr<Entry> &Content : Contents)
+    if (CaseSensitive ? Name.equals(Content->getName())
+                      : Name.equals_lower(Content->getName()))
+      return Content.get();
+  return nullptr;
+}
+
 RedirectingFileSystem *
 RedirectingFileSystem::create(std::unique_ptr<MemoryBuffer> Buffer,
                               SourceMgr::DiagHandlerTy DiagHandler,
@@ -1491,6 +1556,16 @@ RedirectingFileSystem::lookupPath(sys::path::const_iterator Start,
   if (!DE)
     return make_error_code(llvm::errc::not_a_directory);
 
+  // Only the first entry with a matching name can end the search: it either
+  // matches or fails with an error other than "no such file".  Entries with
+  // empty names forward the search to their contents, and "." components are
+  // skipped by the entries themselves, so scan in those cases.
+  if (!DE->hasUnnamedContents() && !Start->equals(".")) {
+    if (Entry *Match = DE->lookupContent(*Start, CaseSensitive))
+      return lookupPath(Start, End, Match);
+    return make_error_code(llvm::errc::no_such_file_or_directory);
+  }
+
   for (const std::unique_ptr<Entry> &DirEntry :
        llvm::make_range(DE->contents_begin(), DE->contents_end())) {
     ErrorOr<Entry *> Result = lookupPath(Start, End, DirEntry.get());
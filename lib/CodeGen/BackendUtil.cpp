@@ -8,12 +8,15 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/CodeGen/BackendUtil.h"
+#include "clang/Basic/CompileTimeBudget.h"
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/LangOptions.h"
 #include "clang/Basic/TargetOptions.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Frontend/CodeGenOptions.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/Utils.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/Triple.h"
@@ -26,14 +29,18 @@
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/ModuleSummaryIndex.h"
 #include "llvm/IR/IRPrintingPasses.h"
+#include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
+#include "llvm/IR/ValueMap.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/MC/SubtargetFeature.h"
 #include "llvm/Object/ModuleSummaryIndexObjectFile.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
@@ -45,13 +52,22 @@
 #include "llvm/Transforms/ObjCARC.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Scalar/GVN.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "llvm/Transforms/Utils/SymbolRewriter.h"
+#include <atomic>
 #include <memory>
 using namespace clang;
 using namespace llvm;
 
 namespace {
 
+/// Track functions through deletion but not through RAUW, which CodeGen uses
+/// to replace a function with a different one.
+struct EarlyOptimizedConfig : ValueMapConfig<const Function *> {
+  enum { FollowRAUW = false };
+};
+
 class EmitAssemblyHelper {
   DiagnosticsEngine &Diags;
   const CodeGenOptions &CodeGenOpts;
@@ -63,6 +79,12 @@ class EmitAssemblyHelper {
 
   std::unique_ptr<raw_pwrite_stream> OS;
 
+  /// The per-function passes run by runEarlyFunctionPasses, if any.
+  std::unique_ptr<legacy::FunctionPassManager> EarlyPerFunctionPasses;
+
+  /// The functions that EarlyPerFunctionPasses have already optimized.
+  ValueMap<const Function *, bool, EarlyOptimizedConfig> EarlyOptimized;
+
 private:
   TargetIRAnalysis getTargetIRAnalysis() const {
     if (TM)
@@ -93,6 +115,11 @@ private:
   bool AddEmitPasses(legacy::PassManager &CodeGenPasses, BackendAction Action,
                      raw_pwrite_stream &OS);
 
+  /// Split the module into one partition for \p OS and one for each of
+  /// \p PartitionOS, and generate code for the partitions in parallel.
+  void EmitPartitions(BackendAction Action, raw_pwrite_stream &OS,
+                      ArrayRef<raw_pwrite_stream *> PartitionOS);
+
 public:
   EmitAssemblyHelper(DiagnosticsEngine &_Diags, const CodeGenOptions &CGOpts,
                      const clang::TargetOptions &TOpts,
@@ -107,8 +134,32 @@ public:
 
   std::unique_ptr<TargetMachine> TM;
 
+  /// Set up the per-function passes so that they can be run over functions
+  /// before the rest of the module has been generated.
+  ///
+  /// \return False if the passes for this module must wait until it is
+  /// complete.
+  bool beginEarlyFunctionPasses();
+
+  /// Run the per-function passes over \p F, if they haven't been already.
+  void runEarlyFunctionPasses(Function &F);
+
   void EmitAssembly(BackendAction Action,
-                    std::unique_ptr<raw_pwrite_stream> OS);
+                    std::unique_ptr<raw_pwrite_stream> OS,
+                    ArrayRef<raw_pwrite_stream *> PartitionOS = None);
+};
+
+class EarlyFunctionPassesImpl : public EarlyFunctionPasses {
+public:
+  EmitAssemblyHelper Helper;
+
+  EarlyFunctionPassesImpl(DiagnosticsEngine &Diags,
+                          const CodeGenOptions &CGOpts,
+                          const clang::TargetOptions &TOpts,
+                          const LangOptions &LOpts, Module *M)
+      : Helper(Diags, CGOpts, TOpts, LOpts, M) {}
+
+  void run(Function &F) override { Helper.runEarlyFunctionPasses(F); }
 };
 
 // We need this wrapper to access LangOpts and CGOpts from extension functions
@@ -420,9 +471,16 @@ void EmitAssemblyHelper::CreatePasses(legacy::PassManager &MPM,
                            addEfficiencySanitizerPass);
   }
 
-  // Set up the per-function pass manager.
-  if (CodeGenOpts.VerifyModule)
-    FPM.add(createVerifierPass());
+  // Set up the per-function pass manager. Functions optimized while the
+  // module was incomplete still refer to unfinished debug info, and are not
+  // run through the per-function passes again, so in that case verify the
+  // whole module instead.
+  if (CodeGenOpts.VerifyModule) {
+    if (EarlyPerFunctionPasses)
+      MPM.add(createVerifierPass());
+    else
+      FPM.add(createVerifierPass());
+  }
 
   // Set up the per-module pass manager.
   if (!CodeGenOpts.RewriteMapFiles.empty())
@@ -609,33 +667,46 @@ void EmitAssemblyHelper::CreateTargetMachine(bool MustCreateTM) {
                                           Options, RM, CM, OptLevel));
 }
 
-bool EmitAssemblyHelper::AddEmitPasses(legacy::PassManager &CodeGenPasses,
-                                       BackendAction Action,
-                                       raw_pwrite_stream &OS) {
+/// Add the passes that generate code for a module to \p CodeGenPasses.
+///
+/// \return True on success.
+static bool addCodeGenPasses(legacy::PassManager &CodeGenPasses,
+                             TargetMachine &TM,
+                             const CodeGenOptions &CodeGenOpts,
+                             TargetMachine::CodeGenFileType CGFT,
+                             raw_pwrite_stream &OS) {
   // Add LibraryInfo.
-  llvm::Triple TargetTriple(TheModule->getTargetTriple());
+  llvm::Triple TargetTriple(TM.getTargetTriple());
   std::unique_ptr<TargetLibraryInfoImpl> TLII(
       createTLII(TargetTriple, CodeGenOpts));
   CodeGenPasses.add(new TargetLibraryInfoWrapperPass(*TLII));
 
-  // Normal mode, emit a .s or .o file by running the code generator. Note,
-  // this also adds codegenerator level optimization passes.
-  TargetMachine::CodeGenFileType CGFT = TargetMachine::CGFT_AssemblyFile;
-  if (Action == Backend_EmitObj)
-    CGFT = TargetMachine::CGFT_ObjectFile;
-  else if (Action == Backend_EmitMCNull)
-    CGFT = TargetMachine::CGFT_Null;
-  else
-    assert(Action == Backend_EmitAssembly && "Invalid action!");
-
   // Add ObjC ARC final-cleanup optimizations. This is done as part of the
   // "codegen" passes so that it isn't run multiple times when there is
   // inlining happening.
   if (CodeGenOpts.OptimizationLevel > 0)
     CodeGenPasses.add(createObjCARCContractPass());
 
-  if (TM->addPassesToEmitFile(CodeGenPasses, OS, CGFT,
-                              /*DisableVerify=*/!CodeGenOpts.VerifyModule)) {
+  return !TM.addPassesToEmitFile(CodeGenPasses, OS, CGFT,
+                                 /*DisableVerify=*/!CodeGenOpts.VerifyModule);
+}
+
+static TargetMachine::CodeGenFileType getCodeGenFileType(BackendAction Action) {
+  if (Action == Backend_EmitObj)
+    return TargetMachine::CGFT_ObjectFile;
+  if (Action == Backend_EmitMCNull)
+    return TargetMachine::CGFT_Null;
+  assert(Action == Backend_EmitAssembly && "Invalid action!");
+  return TargetMachine::CGFT_AssemblyFile;
+}
+
+bool EmitAssemblyHelper::AddEmitPasses(legacy::PassManager &CodeGenPasses,
+                                       BackendAction Action,
+                                       raw_pwrite_stream &OS) {
+  // Normal mode, emit a .s or .o file by running the code generator. Note,
+  // this also adds codegenerator level optimization passes.
+  if (!addCodeGenPasses(CodeGenPasses, *TM, CodeGenOpts,
+                        getCodeGenFileType(Action), OS)) {
     Diags.Report(diag::err_fe_unable_to_interface_with_target);
     return false;
   }
@@ -643,16 +714,85 @@ bool EmitAssemblyHelper::AddEmitPasses(legacy::PassManager &CodeGenPasses,
   return true;
 }
 
-void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
-                                      std::unique_ptr<raw_pwrite_stream> OS) {
+void EmitAssemblyHelper::EmitPartitions(
+    BackendAction Action, raw_pwrite_stream &OS,
+    ArrayRef<raw_pwrite_stream *> PartitionOS) {
+  SmallVector<raw_pwrite_stream *, 8> OSs;
+  OSs.push_back(&OS);
+  OSs.append(PartitionOS.begin(), PartitionOS.end());
+
+  // Each partition is generated in an LLVMContext of its own, because a
+  // context can only be used by one thread at a time, so the partitions are
+  // moved into their contexts as bitcode. SplitModule changes the module it
+  // splits, which is still needed, so it splits a copy. Local symbols are kept
+  // local by keeping them in the same partition as everything that uses them.
+  std::vector<SmallString<0>> Bitcode(OSs.size());
+  unsigned NumSplit = 0;
+  SplitModule(CloneModule(TheModule), OSs.size(),
+              [&](std::unique_ptr<Module> MPart) {
+                // Module-level inline assembly is emitted only once.
+                if (NumSplit != 0)
+                  MPart->setModuleInlineAsm("");
+                raw_svector_ostream BCOS(Bitcode[NumSplit++]);
+                WriteBitcodeToFile(MPart.get(), BCOS);
+              },
+              /*PreserveLocals=*/true);
+  assert(NumSplit == OSs.size() && "Wrong number of partitions");
+
+  // Target machines aren't thread-safe either, so each partition gets its own.
+  std::vector<std::unique_ptr<TargetMachine>> PartitionTMs;
+  for (unsigned I = 0, E = OSs.size(); I != E; ++I)
+    PartitionTMs.emplace_back(TM->getTarget().createTargetMachine(
+        TM->getTargetTriple().str(), TM->getTargetCPU(),
+        TM->getTargetFeatureString(), TM->Options, TM->getRelocationModel(),
+        TM->getCodeModel(), TM->getOptLevel()));
+
+  TargetMachine::CodeGenFileType CGFT = getCodeGenFileType(Action);
+  std::atomic<bool> Failed(false);
+  {
+    ThreadPool Pool(OSs.size());
+    for (unsigned I = 0, E = OSs.size(); I != E; ++I)
+      Pool.async([&, I] {
+        LLVMContext Ctx;
+        ErrorOr<std::unique_ptr<Module>> MPartOrErr = parseBitcodeFile(
+            MemoryBufferRef(StringRef(Bitcode[I].data(), Bitcode[I].size()),
+                            "<partition>"),
+            Ctx);
+        if (!MPartOrErr)
+          report_fatal_error("failed to read partition bitcode");
+
+        TargetMachine &PartitionTM = *PartitionTMs[I];
+        legacy::PassManager CodeGenPasses;
+        CodeGenPasses.add(createTargetTransformInfoWrapperPass(
+            PartitionTM.getTargetIRAnalysis()));
+        if (!addCodeGenPasses(CodeGenPasses, PartitionTM, CodeGenOpts, CGFT,
+                              *OSs[I])) {
+          Failed = true;
+          return;
+        }
+        CodeGenPasses.run(**MPartOrErr);
+      });
+  }
+
+  if (Failed)
+    Diags.Report(diag::err_fe_unable_to_interface_with_target);
+}
+
+void EmitAssemblyHelper::EmitAssembly(
+    BackendAction Action, std::unique_ptr<raw_pwrite_stream> OS,
+    ArrayRef<raw_pwrite_stream *> PartitionOS) {
   TimeRegion Region(llvm::TimePassesIsEnabled ? &CodeGenerationTime : nullptr);
 
-  setCommandLineOpts();
+  // If the per-function passes were set up early, the options have already
+  // been parsed and can't be parsed again.
+  if (!EarlyPerFunctionPasses)
+    setCommandLineOpts();
 
   bool UsesCodeGen = (Action != Backend_EmitNothing &&
                       Action != Backend_EmitBC &&
                       Action != Backend_EmitLL);
-  CreateTargetMachine(UsesCodeGen);
+  if (!TM)
+    CreateTargetMachine(UsesCodeGen);
 
   if (UsesCodeGen && !TM)
     return;
@@ -709,6 +849,13 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
     break;
 
   default:
+    // When the module is split, the code generation passes are set up for
+    // each partition separately.
+    if (!PartitionOS.empty()) {
+      assert((Action == Backend_EmitObj || Action == Backend_EmitAssembly) &&
+             "Only code for objects and assembly can be split");
+      break;
+    }
     if (!AddEmitPasses(CodeGenPasses, Action, *OS))
       return;
   }
@@ -722,9 +869,12 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
   {
     PrettyStackTraceString CrashInfo("Per-function optimization");
 
+    if (EarlyPerFunctionPasses)
+      EarlyPerFunctionPasses->doFinalization();
+
     PerFunctionPasses.doInitialization();
     for (Function &F : *TheModule)
-      if (!F.isDeclaration())
+      if (!F.isDeclaration() && !EarlyOptimized.count(&F))
         PerFunctionPasses.run(F);
     PerFunctionPasses.doFinalization();
   }
@@ -736,19 +886,88 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
 
   {
     PrettyStackTraceString CrashInfo("Code generation");
-    CodeGenPasses.run(*TheModule);
+    if (PartitionOS.empty())
+      CodeGenPasses.run(*TheModule);
+    else
+      EmitPartitions(Action, *OS, PartitionOS);
   }
 }
 
+bool EmitAssemblyHelper::beginEarlyFunctionPasses() {
+  // Passes that look at the module as a whole when they are initialized, such
+  // as the ObjC ARC passes, can't be run until it is complete. Neither can
+  // the passes when the unoptimized IR is needed, or they aren't run at all.
+  if (CodeGenOpts.DisableLLVMPasses || CodeGenOpts.DisableLLVMOpts ||
+      CodeGenOpts.OptimizationLevel == 0 ||
+      !CodeGenOpts.ThinLTOIndexFile.empty() ||
+      CodeGenOpts.getEmbedBitcode() != CodeGenOptions::Embed_Off ||
+      LangOpts.ObjCAutoRefCount)
+    return false;
+
+  setCommandLineOpts();
+  CreateTargetMachine(/*MustCreateTM=*/false);
+
+  EarlyPerFunctionPasses.reset(new legacy::FunctionPassManager(TheModule));
+  EarlyPerFunctionPasses->add(
+      createTargetTransformInfoWrapperPass(getTargetIRAnalysis()));
+
+  // The module passes are set up again, along with the rest of the pipeline,
+  // once the module is complete.
+  legacy::PassManager UnusedModulePasses;
+  CreatePasses(UnusedModulePasses, *EarlyPerFunctionPasses,
+               /*ModuleSummary=*/nullptr);
+
+  // Fold the branches that the passes have found to be constant, so that the
+  // references from the code they never execute are gone by the time CodeGen
+  // decides whether to emit the deferred definitions they refer to.
+  if (CodeGenOpts.PruneDeferredDefinitions)
+    EarlyPerFunctionPasses->add(createCFGSimplificationPass());
+  EarlyPerFunctionPasses->doInitialization();
+  return true;
+}
+
+void EmitAssemblyHelper::runEarlyFunctionPasses(Function &F) {
+  if (F.isDeclaration() || EarlyOptimized.count(&F))
+    return;
+
+  TimeRegion Region(llvm::TimePassesIsEnabled ? &CodeGenerationTime : nullptr);
+  PrettyStackTraceString CrashInfo("Early per-function optimization");
+  EarlyPerFunctionPasses->run(F);
+  EarlyOptimized[&F] = true;
+}
+
+EarlyFunctionPasses::~EarlyFunctionPasses() {}
+
+std::unique_ptr<EarlyFunctionPasses>
+clang::createEarlyFunctionPasses(DiagnosticsEngine &Diags,
+                                 const CodeGenOptions &CGOpts,
+                                 const clang::TargetOptions &TOpts,
+                                 const LangOptions &LOpts, Module *M) {
+  std::unique_ptr<EarlyFunctionPassesImpl> Early(
+      new EarlyFunctionPassesImpl(Diags, CGOpts, TOpts, LOpts, M));
+  if (!Early->Helper.beginEarlyFunctionPasses())
+    return nullptr;
+  return std::move(Early);
+}
+
 void clang::EmitBackendOutput(DiagnosticsEngine &Diags,
                               const CodeGenOptions &CGOpts,
                               const clang::TargetOptions &TOpts,
                               const LangOptions &LOpts, const llvm::DataLayout &TDesc,
                               Module *M, BackendAction Action,
-                              std::unique_ptr<raw_pwrite_stream> OS) {
-  EmitAssemblyHelper AsmHelper(Diags, CGOpts, TOpts, LOpts, M);
-
-  AsmHelper.EmitAssembly(Action, std::move(OS));
+                              std::unique_ptr<raw_pwrite_stream> OS,
+                              EarlyFunctionPasses *Early,
+                              ArrayRef<raw_pwrite_stream *> PartitionOS) {
+  TimeTraceScope TraceScope("EmitBackendOutput");
+  CompileTimePhaseScope PhaseScope("LLVM optimization and code generation");
+
+  // Finish the pipeline that the early passes began, if there is one.
+  EmitAssemblyHelper LocalHelper(Diags, CGOpts, TOpts, LOpts, M);
+  EmitAssemblyHelper &AsmHelper =
+      Early ? static_cast<EarlyFunctionPassesImpl *>(Early)->Helper
+            : LocalHelper;
+
+  AsmHelper.EmitAssembly(Action, std::move(OS), PartitionOS);
 
   // Verify clang's TargetInfo DataLayout against the LLVM TargetMachine's
   // DataLayout.
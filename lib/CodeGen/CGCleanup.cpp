@@ -742,12 +742,14 @@ void CodeGenFunction::PopCleanupBlock(bool FallthroughIsBranchThrough) {
       // I.  Set up the fallthrough edge in.
 
       CGBuilderTy::InsertPoint savedInactiveFallthroughIP;
+      llvm::StoreInst *FallthroughDestStore = nullptr;
 
       // If there's a fallthrough, we need to store the cleanup
       // destination index.  For fall-throughs this is always zero.
       if (HasFallthrough) {
         if (!HasPrebranchedFallthrough)
-          Builder.CreateStore(Builder.getInt32(0), getNormalCleanupDestSlot());
+          FallthroughDestStore = Builder.CreateStore(
+              Builder.getInt32(0), getNormalCleanupDestSlot());
 
       // Otherwise, save and clear the IP if we don't have fallthrough
       // because the cleanup is inactive.
@@ -842,6 +844,25 @@ void CodeGenFunction::PopCleanupBlock(bool FallthroughIsBranchThrough) {
         // the fixups now.
         if (HasFixups && !HasEnclosingCleanups)
           ResolveAllBranchFixups(*this, Switch, NormalEntry);
+
+        // If every thread leaves the cleanup for the same place, e.g. when
+        // the fallthrough is the only exit, branch there directly.
+        if (!BranchThroughDest && Switch->getNumCases() == 1) {
+          llvm::BasicBlock *Dest = Switch->case_begin().getCaseSuccessor();
+          delete Switch;
+          delete Load;
+          InstsToAppend.clear();
+          InstsToAppend.push_back(llvm::BranchInst::Create(Dest));
+
+          // The fallthrough's store to the cleanup dest slot is dead now.
+          if (FallthroughDestStore) {
+            FallthroughDestStore->eraseFromParent();
+            if (NormalCleanupDest->use_empty()) {
+              NormalCleanupDest->eraseFromParent();
+              NormalCleanupDest = nullptr;
+            }
+          }
+        }
       } else {
         // We should always have a branch-through destination in this case.
         assert(BranchThroughDest);
@@ -40,6 +40,8 @@
 #include "llvm/IR/Intrinsics.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 using namespace clang;
 using namespace clang::CodeGen;
@@ -1611,6 +1613,8 @@ void CGDebugInfo::completeRequiredType(const RecordDecl *RD) {
 void CGDebugInfo::completeClassData(const RecordDecl *RD) {
   if (DebugKind <= codegenoptions::DebugLineTablesOnly)
     return;
+  if (isClaimedElsewhere(RD))
+    return;
   QualType Ty = CGM.getContext().getRecordType(RD);
   void *TyPtr = Ty.getAsOpaquePtr();
   auto I = TypeCache.find(TyPtr);
@@ -1683,11 +1687,62 @@ static bool shouldOmitDefinition(codegenoptions::DebugInfoKind DebugKind,
   return false;
 }
 
+bool CGDebugInfo::isClaimedElsewhere(const RecordDecl *RD) {
+  StringRef CacheDir = CGM.getCodeGenOpts().DebugTypeCacheDir;
+  if (CacheDir.empty() || !RD->getDefinition())
+    return false;
+  RD = RD->getDefinition();
+
+  auto I = ClaimedElsewhere.find(RD);
+  if (I != ClaimedElsewhere.end())
+    return I->second;
+
+  // Only types that have an ODR name can be shared with other units.
+  SmallString<256> FullName = getUniqueTagTypeName(
+      CGM.getContext().getRecordType(RD)->castAs<RecordType>(), CGM, TheCU);
+  if (FullName.empty())
+    return ClaimedElsewhere[RD] = false;
+
+  llvm::MD5 Hash;
+  llvm::MD5::MD5Result Result;
+  Hash.update(FullName);
+  Hash.final(Result);
+  SmallString<32> Signature;
+  llvm::MD5::stringifyResult(Result, Signature);
+  SmallString<256> Path(CacheDir);
+  llvm::sys::path::append(Path, Signature);
+
+  // The unit is identified by its main file, so that it keeps its claims when
+  // it is compiled again.
+  SmallString<256> Owner(TheCU->getDirectory());
+  llvm::sys::path::append(Owner, TheCU->getFilename());
+
+  // The unit that creates the file first owns the type.
+  int FD;
+  std::error_code EC =
+      llvm::sys::fs::openFileForWrite(Path, FD, llvm::sys::fs::F_Excl);
+  if (!EC) {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << Owner;
+    return ClaimedElsewhere[RD] = false;
+  }
+
+  // If the cache can't be used, emit the type here to be safe.
+  if (EC != std::errc::file_exists)
+    return ClaimedElsewhere[RD] = false;
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Claim =
+      llvm::MemoryBuffer::getFile(Path);
+  return ClaimedElsewhere[RD] =
+             Claim && (*Claim)->getBuffer() != StringRef(Owner);
+}
+
 llvm::DIType *CGDebugInfo::CreateType(const RecordType *Ty) {
   RecordDecl *RD = Ty->getDecl();
   llvm::DIType *T = cast_or_null<llvm::DIType>(getTypeOrNull(QualType(Ty, 0)));
-  if (T || shouldOmitDefinition(DebugKind, DebugTypeExtRefs, RD,
-                                CGM.getLangOpts())) {
+  if (T ||
+      shouldOmitDefinition(DebugKind, DebugTypeExtRefs, RD,
+                           CGM.getLangOpts()) ||
+      isClaimedElsewhere(RD)) {
     if (!T)
       T = getOrCreateRecordFwdDecl(Ty, getDeclContextDescriptor(RD));
     return T;
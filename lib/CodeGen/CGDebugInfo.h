@@ -76,6 +76,10 @@ class CGDebugInfo {
   /// Cache of previously constructed Types.
   llvm::DenseMap<const void *, llvm::TrackingMDRef> TypeCache;
 
+  /// With -fdebug-type-cache, whether the definition of each record looked up
+  /// in the cache is claimed by another translation unit.
+  llvm::DenseMap<const RecordDecl *, bool> ClaimedElsewhere;
+
   llvm::SmallDenseMap<llvm::StringRef, llvm::StringRef> DebugPrefixMap;
 
   struct ObjCInterfaceCacheEntry {
@@ -432,6 +436,11 @@ private:
   /// DebugTypeExtRefs: If \p D originated in a clang module, return it.
   llvm::DIModule *getParentModuleOrNull(const Decl *D);
 
+  /// With -fdebug-type-cache, whether another translation unit emits the full
+  /// debug info for \p RD, because it claimed the type's ODR name in the
+  /// cache first. If no unit has, this one claims it.
+  bool isClaimedElsewhere(const RecordDecl *RD);
+
   /// Get the type from the cache or create a new partial type if
   /// necessary.
   llvm::DICompositeType *getOrCreateLimitedType(const RecordType *Ty,
@@ -443,7 +443,7 @@ CodeGenModule::EmitCXXGlobalInitFunc() {
       for (; I < PrioE; ++I)
         LocalCXXGlobalInits.push_back(I->second);
 
-      CodeGenFunction(*this).GenerateCXXGlobalInitFunc(Fn, LocalCXXGlobalInits);
+      GenerateCXXGlobalInitChunks(Fn, LocalCXXGlobalInits);
       AddGlobalCtor(Fn, Priority);
     }
     PrioritizedCXXGlobalInits.clear();
@@ -470,12 +470,38 @@ CodeGenModule::EmitCXXGlobalInitFunc() {
   llvm::Function *Fn = CreateGlobalInitOrDestructFunction(
       FTy, llvm::Twine("_GLOBAL__sub_I_", FileName), FI);
 
-  CodeGenFunction(*this).GenerateCXXGlobalInitFunc(Fn, CXXGlobalInits);
+  GenerateCXXGlobalInitChunks(Fn, CXXGlobalInits);
   AddGlobalCtor(Fn);
 
   CXXGlobalInits.clear();
 }
 
+void
+CodeGenModule::GenerateCXXGlobalInitChunks(llvm::Function *Fn,
+                                           ArrayRef<llvm::Function *> Inits) {
+  unsigned ChunkSize = CodeGenOpts.CXXGlobalInitChunkSize;
+  if (!ChunkSize || Inits.size() <= ChunkSize) {
+    CodeGenFunction(*this).GenerateCXXGlobalInitFunc(Fn, Inits);
+    return;
+  }
+
+  // Call each chunk of initializers from a function of its own, and call
+  // those in order from Fn. The chunks are kept out of line; otherwise the
+  // inliner would put the whole unbounded function back together again.
+  llvm::FunctionType *FTy = llvm::FunctionType::get(VoidTy, false);
+  const CGFunctionInfo &FI = getTypes().arrangeNullaryFunction();
+  SmallVector<llvm::Function *, 16> Chunks;
+  for (size_t I = 0, E = Inits.size(); I < E; I += ChunkSize) {
+    llvm::Function *Chunk = CreateGlobalInitOrDestructFunction(
+        FTy, "__cxx_global_init_chunk", FI);
+    Chunk->addFnAttr(llvm::Attribute::NoInline);
+    CodeGenFunction(*this).GenerateCXXGlobalInitFunc(
+        Chunk, Inits.slice(I, std::min<size_t>(ChunkSize, E - I)));
+    Chunks.push_back(Chunk);
+  }
+  CodeGenFunction(*this).GenerateCXXGlobalInitFunc(Fn, Chunks);
+}
+
 void CodeGenModule::EmitCXXGlobalDtorFunc() {
   if (CXXGlobalDtors.empty())
     return;
@@ -164,6 +164,7 @@ public:
   void VisitAbstractConditionalOperator(const AbstractConditionalOperator *CO);
   void VisitChooseExpr(const ChooseExpr *CE);
   void VisitInitListExpr(InitListExpr *E);
+  void VisitDataArrayExpr(DataArrayExpr *E);
   void VisitImplicitValueInitExpr(ImplicitValueInitExpr *E);
   void VisitNoInitExpr(NoInitExpr *E) { } // Do nothing.
   void VisitCXXDefaultArgExpr(CXXDefaultArgExpr *DAE) {
@@ -1126,6 +1127,21 @@ void AggExprEmitter::EmitNullInitializationToLValue(LValue lv) {
   }
 }
 
+void AggExprEmitter::VisitDataArrayExpr(DataArrayExpr *E) {
+  // Copy the elements from a constant global rather than storing them one
+  // at a time.
+  llvm::Constant *C = CGF.CGM.EmitConstantExpr(E, E->getType(), &CGF);
+  assert(C && "data array is not a constant");
+  CharUnits Align = CGF.getContext().getTypeAlignInChars(E->getType());
+  llvm::GlobalVariable *GV =
+    new llvm::GlobalVariable(CGF.CGM.getModule(), C->getType(), true,
+                             llvm::GlobalValue::PrivateLinkage, C, "");
+  GV->setAlignment(Align.getQuantity());
+  GV->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+  EmitFinalDestCopy(E->getType(), CGF.MakeAddrLValue(Address(GV, Align),
+                                                     E->getType()));
+}
+
 void AggExprEmitter::VisitInitListExpr(InitListExpr *E) {
 #if 0
   // FIXME: Assess perf here?  Figure out what cases are worth optimizing here
@@ -1446,6 +1462,29 @@ void CodeGenFunction::EmitAggExpr(const Expr *E, AggValueSlot Slot) {
   AggExprEmitter(*this, Slot, Slot.isIgnored()).Visit(const_cast<Expr*>(E));
 }
 
+/// Determine whether a copy of the given record can be emitted as a load and
+/// a store of each of its fields: it must be a struct or class of at most four
+/// plain scalar fields, and nothing else.
+static bool isScalarCopyableRecord(const RecordType *RT) {
+  const RecordDecl *RD = RT->getDecl();
+  if (RD->isUnion() || RD->hasFlexibleArrayMember())
+    return false;
+  if (const CXXRecordDecl *CXXRD = dyn_cast<CXXRecordDecl>(RD))
+    if (CXXRD->getNumBases() || CXXRD->getNumVBases() ||
+        CXXRD->isDynamicClass())
+      return false;
+
+  unsigned NumFields = 0;
+  for (const FieldDecl *FD : RD->fields()) {
+    QualType FieldTy = FD->getType();
+    if (++NumFields > 4 || FD->isBitField() ||
+        FieldTy.isVolatileQualified() || !FieldTy->isScalarType() ||
+        FieldTy->isMemberPointerType() || FieldTy.hasNonTrivialObjCLifetime())
+      return false;
+  }
+  return NumFields != 0;
+}
+
 LValue CodeGenFunction::EmitAggExprToLValue(const Expr *E) {
   assert(hasAggregateEvaluationKind(E->getType()) && "Invalid argument!");
   Address Temp = CreateMemTemp(E->getType());
@@ -1477,6 +1516,24 @@ void CodeGenFunction::EmitAggregateCopy(Address DestPtr,
         return;
     }
   }
+
+  // Copy a small struct of scalars field by field. This emits less IR than a
+  // memcpy, both for the optimizer to clean up and to run at -O0, and gives
+  // each access the TBAA tag of its field.
+  if (CGM.getCodeGenOpts().ScalarizeAggregateCopies && !isVolatile &&
+      CGM.getLangOpts().getGC() == LangOptions::NonGC) {
+    const RecordType *RT = Ty->getAs<RecordType>();
+    if (RT && isScalarCopyableRecord(RT)) {
+      LValue DestLV = MakeAddrLValue(DestPtr, Ty);
+      LValue SrcLV = MakeAddrLValue(SrcPtr, Ty);
+      for (const FieldDecl *FD : RT->getDecl()->fields()) {
+        llvm::Value *V =
+            EmitLoadOfScalar(EmitLValueForField(SrcLV, FD), SourceLocation());
+        EmitStoreOfScalar(V, EmitLValueForField(DestLV, FD));
+      }
+      return;
+    }
+  }
   
   // Aggregate assignment turns into llvm.memcpy.  This is almost valid per
   // C99 6.5.16.1p3, which states "If the value being stored in an object is
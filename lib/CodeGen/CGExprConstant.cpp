@@ -593,6 +593,165 @@ llvm::Constant *ConstStructBuilder::BuildStruct(CodeGenModule &CGM,
   return Builder.Finalize(ValTy);
 }
 
+//===----------------------------------------------------------------------===//
+//                            Integer data arrays
+//===----------------------------------------------------------------------===//
+
+// Large arrays of integers, such as lookup tables and files embedded with
+// tools like xxd, can have millions of elements. Build those directly as a
+// ConstantDataArray rather than creating a constant for every element.
+
+/// Build a ConstantDataArray of NumElements values of type T, the first
+/// NumInits of which are given by GetValue and the rest of which are Fill.
+template <typename T, typename ValueFn>
+static llvm::Constant *buildDataArray(llvm::LLVMContext &Context,
+                                      unsigned NumInits, unsigned NumElements,
+                                      uint64_t Fill, ValueFn GetValue) {
+  SmallVector<T, 0> Data(NumElements, static_cast<T>(Fill));
+  for (unsigned I = 0; I != NumInits; ++I)
+    Data[I] = static_cast<T>(GetValue(I));
+  return llvm::ConstantDataArray::get(Context, Data);
+}
+
+/// Build a ConstantDataArray with elements of type EltTy, which must be an
+/// integer type of 8, 16, 32 or 64 bits; otherwise, return null.
+template <typename ValueFn>
+static llvm::Constant *buildIntegerDataArray(llvm::Type *EltTy,
+                                             unsigned NumInits,
+                                             unsigned NumElements,
+                                             uint64_t Fill,
+                                             ValueFn GetValue) {
+  if (!EltTy->isIntegerTy())
+    return nullptr;
+  llvm::LLVMContext &Context = EltTy->getContext();
+  switch (EltTy->getIntegerBitWidth()) {
+  case 8:
+    return buildDataArray<uint8_t>(Context, NumInits, NumElements, Fill,
+                                   GetValue);
+  case 16:
+    return buildDataArray<uint16_t>(Context, NumInits, NumElements, Fill,
+                                    GetValue);
+  case 32:
+    return buildDataArray<uint32_t>(Context, NumInits, NumElements, Fill,
+                                    GetValue);
+  case 64:
+    return buildDataArray<uint64_t>(Context, NumInits, NumElements, Fill,
+                                    GetValue);
+  default:
+    return nullptr;
+  }
+}
+
+/// Get the memory type of the elements of an array of integers that can be
+/// emitted as a ConstantDataArray, or null if it isn't one.
+static llvm::Type *getDataArrayElementType(CodeGenModule &CGM,
+                                           QualType ArrayTy) {
+  const ConstantArrayType *CAT =
+      CGM.getContext().getAsConstantArrayType(ArrayTy);
+  if (!CAT)
+    return nullptr;
+  QualType EltTy = CAT->getElementType();
+  if (!EltTy->isIntegralOrEnumerationType() || EltTy->isBooleanType())
+    return nullptr;
+  llvm::Type *MemTy = CGM.getTypes().ConvertTypeForMem(EltTy);
+  if (!MemTy->isIntegerTy() ||
+      MemTy->getIntegerBitWidth() != CGM.getContext().getTypeSize(EltTy))
+    return nullptr;
+  return MemTy;
+}
+
+/// Get the value of an array element initializer that is an integer or
+/// character literal, possibly implicitly converted to the element type.
+static bool getLiteralElementValue(ASTContext &Context, const Expr *Init,
+                                   unsigned Width, uint64_t &Value) {
+  if (const ImplicitCastExpr *ICE = dyn_cast<ImplicitCastExpr>(Init)) {
+    if (ICE->getCastKind() != CK_IntegralCast &&
+        ICE->getCastKind() != CK_NoOp)
+      return false;
+    Init = ICE->getSubExpr();
+  }
+
+  llvm::APSInt Literal;
+  if (const IntegerLiteral *IL = dyn_cast<IntegerLiteral>(Init))
+    Literal = llvm::APSInt(IL->getValue(),
+                           IL->getType()->isUnsignedIntegerType());
+  else if (const CharacterLiteral *CL = dyn_cast<CharacterLiteral>(Init))
+    Literal = llvm::APSInt(
+        llvm::APInt(Context.getTypeSize(CL->getType()), CL->getValue()),
+        CL->getType()->isUnsignedIntegerType());
+  else
+    return false;
+  Value = Literal.extOrTrunc(Width).getZExtValue();
+  return true;
+}
+
+/// Try to emit an initializer list of integer or character literals for an
+/// array of integers as a ConstantDataArray, without evaluating its elements
+/// one at a time.
+static llvm::Constant *tryEmitLiteralDataArray(CodeGenModule &CGM,
+                                               const InitListExpr *ILE) {
+  llvm::Type *EltTy = getDataArrayElementType(CGM, ILE->getType());
+  if (!EltTy || ILE->isStringLiteralInit())
+    return nullptr;
+  const Expr *Filler = ILE->getArrayFiller();
+  if (Filler && !isa<ImplicitValueInitExpr>(Filler))
+    return nullptr;
+
+  uint64_t NumElements = CGM.getContext().getAsConstantArrayType(
+      ILE->getType())->getSize().getZExtValue();
+  unsigned NumInits = std::min<uint64_t>(ILE->getNumInits(), NumElements);
+  ASTContext &Context = CGM.getContext();
+  unsigned Width = EltTy->getIntegerBitWidth();
+  uint64_t Value;
+  for (unsigned I = 0; I != NumInits; ++I)
+    if (!getLiteralElementValue(Context, ILE->getInit(I), Width, Value))
+      return nullptr;
+
+  return buildIntegerDataArray(EltTy, NumInits, NumElements, 0,
+                               [&](unsigned I) {
+    getLiteralElementValue(Context, ILE->getInit(I), Width, Value);
+    return Value;
+  });
+}
+
+/// Emit an array of integers that Sema has already packed into a
+/// DataArrayExpr.
+static llvm::Constant *emitDataArrayExpr(CodeGenModule &CGM,
+                                         const DataArrayExpr *E) {
+  llvm::Type *EltTy = getDataArrayElementType(CGM, E->getType());
+  if (!EltTy)
+    return nullptr;
+  uint64_t NumElements = CGM.getContext().getAsConstantArrayType(
+      E->getType())->getSize().getZExtValue();
+  return buildIntegerDataArray(EltTy, E->getNumInits(), NumElements, 0,
+                               [&](unsigned I) {
+    return E->getElementValue(I);
+  });
+}
+
+/// Try to emit the value of an array of integers as a ConstantDataArray.
+static llvm::Constant *tryEmitDataArray(CodeGenModule &CGM,
+                                        const APValue &Value,
+                                        QualType DestType) {
+  llvm::Type *EltTy = getDataArrayElementType(CGM, DestType);
+  if (!EltTy)
+    return nullptr;
+  unsigned NumInits = Value.getArrayInitializedElts();
+  for (unsigned I = 0; I != NumInits; ++I)
+    if (!Value.getArrayInitializedElt(I).isInt())
+      return nullptr;
+  uint64_t Fill = 0;
+  if (Value.hasArrayFiller()) {
+    if (!Value.getArrayFiller().isInt())
+      return nullptr;
+    Fill = Value.getArrayFiller().getInt().getZExtValue();
+  }
+
+  return buildIntegerDataArray(EltTy, NumInits, Value.getArraySize(), Fill,
+                               [&](unsigned I) {
+    return Value.getArrayInitializedElt(I).getInt().getZExtValue();
+  });
+}
 
 //===----------------------------------------------------------------------===//
 //                             ConstExprEmitter
@@ -778,6 +937,9 @@ public:
     if (ILE->isStringLiteralInit())
       return Visit(ILE->getInit(0));
 
+    if (llvm::Constant *C = tryEmitLiteralDataArray(CGM, ILE))
+      return C;
+
     llvm::ArrayType *AType =
         cast<llvm::ArrayType>(ConvertType(ILE->getType()));
     llvm::Type *ElemTy = AType->getElementType();
@@ -841,6 +1003,10 @@ public:
     return CGM.EmitNullConstant(E->getType());
   }
 
+  llvm::Constant *VisitDataArrayExpr(DataArrayExpr *E) {
+    return emitDataArrayExpr(CGM, E);
+  }
+
   llvm::Constant *VisitInitListExpr(InitListExpr *ILE) {
     if (ILE->getType()->isArrayType())
       return EmitArrayInitialization(ILE);
@@ -1211,6 +1377,14 @@ llvm::Constant *CodeGenModule::EmitConstantInit(const VarDecl &D,
       }
   }
   
+  // Emit data tables directly, without evaluating them element by element.
+  if (const InitListExpr *ILE = dyn_cast_or_null<InitListExpr>(D.getInit()))
+    if (llvm::Constant *C = tryEmitLiteralDataArray(*this, ILE))
+      return C;
+  if (const DataArrayExpr *DAE = dyn_cast_or_null<DataArrayExpr>(D.getInit()))
+    if (llvm::Constant *C = emitDataArrayExpr(*this, DAE))
+      return C;
+
   if (const APValue *Value = D.evaluateValue())
     return EmitConstantValueForMemory(*Value, D.getType(), CGF);
 
@@ -1237,6 +1411,10 @@ llvm::Constant *CodeGenModule::EmitConstantInit(const VarDecl &D,
 llvm::Constant *CodeGenModule::EmitConstantExpr(const Expr *E,
                                                 QualType DestType,
                                                 CodeGenFunction *CGF) {
+  if (const DataArrayExpr *DAE = dyn_cast<DataArrayExpr>(E))
+    if (llvm::Constant *C = emitDataArrayExpr(*this, DAE))
+      return C;
+
   Expr::EvalResult Result;
 
   bool Success = false;
@@ -1411,6 +1589,9 @@ llvm::Constant *CodeGenModule::EmitConstantValue(const APValue &Value,
   case APValue::Union:
     return ConstStructBuilder::BuildStruct(*this, CGF, Value, DestType);
   case APValue::Array: {
+    if (llvm::Constant *C = tryEmitDataArray(*this, Value, DestType))
+      return C;
+
     const ArrayType *CAT = Context.getAsArrayType(DestType);
     unsigned NumElements = Value.getArraySize();
     unsigned NumInitElts = Value.getArrayInitializedElts();
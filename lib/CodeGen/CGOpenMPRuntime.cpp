@@ -665,6 +665,10 @@ enum OpenMPRTLFunction {
   // Call to void __tgt_target_data_update(int32_t device_id, int32_t arg_num,
   // void** args_base, void **args, size_t *arg_sizes, int32_t *arg_types);
   OMPRTL__tgt_target_data_update,
+  // Call to int omp_get_thread_num();
+  OMPRTL_omp_get_thread_num,
+  // Call to int omp_get_num_threads();
+  OMPRTL_omp_get_num_threads,
 };
 
 /// A basic class for pre|post-action for advanced codegen sequence for OpenMP
@@ -1628,6 +1632,20 @@ CGOpenMPRuntime::createRuntimeFunction(unsigned Function) {
     RTLFn = CGM.CreateRuntimeFunction(FnTy, "__tgt_target_data_update");
     break;
   }
+  case OMPRTL_omp_get_thread_num: {
+    // Build int omp_get_thread_num();
+    llvm::FunctionType *FnTy =
+        llvm::FunctionType::get(CGM.IntTy, /*isVarArg*/ false);
+    RTLFn = CGM.CreateRuntimeFunction(FnTy, "omp_get_thread_num");
+    break;
+  }
+  case OMPRTL_omp_get_num_threads: {
+    // Build int omp_get_num_threads();
+    llvm::FunctionType *FnTy =
+        llvm::FunctionType::get(CGM.IntTy, /*isVarArg*/ false);
+    RTLFn = CGM.CreateRuntimeFunction(FnTy, "omp_get_num_threads");
+    break;
+  }
   }
   assert(RTLFn && "Unable to find OpenMP runtime function");
   return RTLFn;
@@ -1931,7 +1949,7 @@ static void emitOMPIfClause(CodeGenFunction &CGF, const Expr *Cond,
 void CGOpenMPRuntime::emitParallelCall(CodeGenFunction &CGF, SourceLocation Loc,
                                        llvm::Value *OutlinedFn,
                                        ArrayRef<llvm::Value *> CapturedVars,
-                                       const Expr *IfCond) {
+                                       const Expr *IfCond, bool Serialized) {
   if (!CGF.HaveInsertPoint())
     return;
   auto *RTLoc = emitUpdateLocation(CGF, Loc);
@@ -1978,7 +1996,12 @@ void CGOpenMPRuntime::emitParallelCall(CodeGenFunction &CGF, SourceLocation Loc,
         RT.createRuntimeFunction(OMPRTL__kmpc_end_serialized_parallel),
         EndArgs);
   };
-  if (IfCond)
+  if (Serialized) {
+    if (IfCond)
+      CGF.EmitIgnoredExpr(IfCond);
+    RegionCodeGenTy ElseRCG(ElseGen);
+    ElseRCG(CGF);
+  } else if (IfCond)
     emitOMPIfClause(CGF, IfCond, ThenGen, ElseGen);
   else {
     RegionCodeGenTy ThenRCG(ThenGen);
@@ -2543,6 +2566,50 @@ void CGOpenMPRuntime::emitForStaticInit(CodeGenFunction &CGF,
                         Ordered, IL, LB, UB, ST, Chunk);
 }
 
+void CGOpenMPRuntime::emitForStaticNonchunkedInlineInit(
+    CodeGenFunction &CGF, SourceLocation Loc, unsigned IVSize, Address IL,
+    Address LB, Address UB) {
+  if (!CGF.HaveInsertPoint())
+    return;
+  auto &Builder = CGF.Builder;
+  llvm::Type *IVTy = Builder.getIntNTy(IVSize);
+  llvm::Value *ThreadNum =
+      CGF.EmitRuntimeCall(createRuntimeFunction(OMPRTL_omp_get_thread_num));
+  llvm::Value *NumThreads =
+      CGF.EmitRuntimeCall(createRuntimeFunction(OMPRTL_omp_get_num_threads));
+  ThreadNum = Builder.CreateIntCast(ThreadNum, IVTy, /*isSigned*/ false);
+  NumThreads = Builder.CreateIntCast(NumThreads, IVTy, /*isSigned*/ false);
+
+  // The bounds are normalized and the loop runs at least once, so the number
+  // of iterations is UB - LB + 1 whatever the sign of the iteration variable.
+  llvm::Value *Lower = Builder.CreateLoad(LB);
+  llvm::Value *Upper = Builder.CreateLoad(UB);
+  llvm::Value *TripCount = Builder.CreateAdd(
+      Builder.CreateSub(Upper, Lower), llvm::ConstantInt::get(IVTy, 1));
+
+  // Give each thread TripCount / NumThreads iterations, and one more to the
+  // first TripCount % NumThreads threads.
+  llvm::Value *Chunk = Builder.CreateUDiv(TripCount, NumThreads);
+  llvm::Value *Extras = Builder.CreateURem(TripCount, NumThreads);
+  llvm::Value *HasExtra = Builder.CreateICmpULT(ThreadNum, Extras);
+  llvm::Value *Begin = Builder.CreateAdd(
+      Builder.CreateAdd(Lower, Builder.CreateMul(ThreadNum, Chunk)),
+      Builder.CreateSelect(HasExtra, ThreadNum, Extras));
+  llvm::Value *Size =
+      Builder.CreateAdd(Chunk, Builder.CreateZExt(HasExtra, IVTy));
+  llvm::Value *End = Builder.CreateSub(Builder.CreateAdd(Begin, Size),
+                                       llvm::ConstantInt::get(IVTy, 1));
+  Builder.CreateStore(Begin, LB);
+  Builder.CreateStore(End, UB);
+
+  // The last iteration runs on the thread whose non-empty chunk ends at UB.
+  llvm::Value *IsLast =
+      Builder.CreateAnd(Builder.CreateICmpEQ(End, Upper),
+                        Builder.CreateICmpNE(Size,
+                                             llvm::ConstantInt::get(IVTy, 0)));
+  Builder.CreateStore(Builder.CreateZExt(IsLast, IL.getElementType()), IL);
+}
+
 void CGOpenMPRuntime::emitDistributeStaticInit(
     CodeGenFunction &CGF, SourceLocation Loc,
     OpenMPDistScheduleClauseKind SchedKind, unsigned IVSize, bool IVSigned,
@@ -549,11 +549,14 @@ public:
   /// variables used in \a OutlinedFn function.
   /// \param IfCond Condition in the associated 'if' clause, if it was
   /// specified, nullptr otherwise.
+  /// \param Serialized true if the region is known to run on a single thread,
+  /// in which case \a OutlinedFn is always called serially and \a IfCond is
+  /// only evaluated for its side effects.
   ///
   virtual void emitParallelCall(CodeGenFunction &CGF, SourceLocation Loc,
                                 llvm::Value *OutlinedFn,
                                 ArrayRef<llvm::Value *> CapturedVars,
-                                const Expr *IfCond);
+                                const Expr *IfCond, bool Serialized);
 
   /// \brief Emits a critical region.
   /// \param CriticalName Name of the critical region.
@@ -671,6 +674,24 @@ public:
                                  Address IL, Address LB, Address UB, Address ST,
                                  llvm::Value *Chunk = nullptr);
 
+  /// \brief Compute the bounds of the chunk of the calling thread for a static
+  /// non-chunked, unordered worksharing loop inline, from the thread number
+  /// and the number of threads of the team, instead of calling the runtime.
+  /// Pair it with no call to emitForStaticFinish.
+  ///
+  /// \param IVSize Size of the iteration variable in bits.
+  /// \param IL Address of the output variable in which the flag of the
+  /// last iteration is returned.
+  /// \param LB Address of the lower iteration number, which is replaced with
+  /// the lower iteration number of the chunk.
+  /// \param UB Address of the upper iteration number, which is replaced with
+  /// the upper iteration number of the chunk.
+  ///
+  virtual void emitForStaticNonchunkedInlineInit(CodeGenFunction &CGF,
+                                                 SourceLocation Loc,
+                                                 unsigned IVSize, Address IL,
+                                                 Address LB, Address UB);
+
   ///
   /// \param CGF Reference to current CodeGenFunction.
   /// \param Loc Clang source location.
@@ -1195,14 +1195,25 @@ static void emitCommonOMPParallelDirective(CodeGenFunction &CGF,
   auto OutlinedFn = CGF.CGM.getOpenMPRuntime().
       emitParallelOrTeamsOutlinedFunction(S,
           *CS->getCapturedDecl()->param_begin(), InnermostKind, CodeGen);
-  if (const auto *NumThreadsClause = S.getSingleClause<OMPNumThreadsClause>()) {
+  // A team of a single thread runs the region just like a serialized
+  // parallel region does, without the cost of forking it.
+  bool Serialized = false;
+  const auto *NumThreadsClause = S.getSingleClause<OMPNumThreadsClause>();
+  if (NumThreadsClause && CGF.getLangOpts().OpenMPSerializeSingleThread) {
+    llvm::APSInt NumThreads;
+    Serialized = NumThreadsClause->getNumThreads()->EvaluateAsInt(
+                     NumThreads, CGF.getContext()) &&
+                 NumThreads == 1;
+  }
+  if (NumThreadsClause && !Serialized) {
     CodeGenFunction::RunCleanupsScope NumThreadsScope(CGF);
     auto NumThreads = CGF.EmitScalarExpr(NumThreadsClause->getNumThreads(),
                                          /*IgnoreResultAssign*/ true);
     CGF.CGM.getOpenMPRuntime().emitNumThreadsClause(
         CGF, NumThreads, NumThreadsClause->getLocStart());
   }
-  if (const auto *ProcBindClause = S.getSingleClause<OMPProcBindClause>()) {
+  const auto *ProcBindClause = S.getSingleClause<OMPProcBindClause>();
+  if (ProcBindClause && !Serialized) {
     CodeGenFunction::RunCleanupsScope ProcBindScope(CGF);
     CGF.CGM.getOpenMPRuntime().emitProcBindClause(
         CGF, ProcBindClause->getProcBindKind(), ProcBindClause->getLocStart());
@@ -1220,7 +1231,8 @@ static void emitCommonOMPParallelDirective(CodeGenFunction &CGF,
   llvm::SmallVector<llvm::Value *, 16> CapturedVars;
   CGF.GenerateOpenMPCapturedVars(*CS, CapturedVars);
   CGF.CGM.getOpenMPRuntime().emitParallelCall(CGF, S.getLocStart(), OutlinedFn,
-                                              CapturedVars, IfCond);
+                                              CapturedVars, IfCond,
+                                              Serialized);
 }
 
 void CodeGenFunction::EmitOMPParallelDirective(const OMPParallelDirective &S) {
@@ -2040,10 +2052,18 @@ bool CodeGenFunction::EmitOMPWorksharingLoop(const OMPLoopDirective &S) {
         // chunks that are approximately equal in size, and at most one chunk is
         // distributed to each thread. Note that the size of the chunks is
         // unspecified in this case.
-        RT.emitForStaticInit(*this, S.getLocStart(), ScheduleKind,
-                             IVSize, IVSigned, Ordered,
-                             IL.getAddress(), LB.getAddress(),
-                             UB.getAddress(), ST.getAddress());
+        bool InlineInit = getLangOpts().OpenMPInlineStaticSchedule &&
+                          !getLangOpts().OpenMPIsDevice && !Ordered;
+        if (InlineInit)
+          RT.emitForStaticNonchunkedInlineInit(*this, S.getLocStart(), IVSize,
+                                               IL.getAddress(),
+                                               LB.getAddress(),
+                                               UB.getAddress());
+        else
+          RT.emitForStaticInit(*this, S.getLocStart(), ScheduleKind,
+                               IVSize, IVSigned, Ordered,
+                               IL.getAddress(), LB.getAddress(),
+                               UB.getAddress(), ST.getAddress());
         auto LoopExit =
             getJumpDestInCurrentScope(createBasicBlock("omp.loop.exit"));
         // UB = min(UB, GlobalUB);
@@ -2060,7 +2080,8 @@ bool CodeGenFunction::EmitOMPWorksharingLoop(const OMPLoopDirective &S) {
                          [](CodeGenFunction &) {});
         EmitBlock(LoopExit.getBlock());
         // Tell the runtime we are done.
-        RT.emitForStaticFinish(*this, S.getLocStart());
+        if (!InlineInit)
+          RT.emitForStaticFinish(*this, S.getLocStart());
       } else {
         const bool IsMonotonic =
             Ordered || ScheduleKind.Schedule == OMPC_SCHEDULE_static ||
@@ -2715,7 +2736,8 @@ void CodeGenFunction::EmitOMPDistributeLoop(const OMPDistributeDirective &S) {
                          [](CodeGenFunction &) {});
         EmitBlock(LoopExit.getBlock());
         // Tell the runtime we are done.
-        RT.emitForStaticFinish(*this, S.getLocStart());
+        if (!InlineInit)
+          RT.emitForStaticFinish(*this, S.getLocStart());
       } else {
         // Emit the outer loop, which requests its work chunk [LB..UB] from
         // runtime and runs the inner loop to process it.
@@ -895,8 +895,10 @@ void CodeGenModule::EmitDeferredVTables() {
 #endif
 
   for (const CXXRecordDecl *RD : DeferredVTables)
-    if (shouldEmitVTableAtEndOfTranslationUnit(*this, RD))
+    if (shouldEmitVTableAtEndOfTranslationUnit(*this, RD)) {
       VTables.GenerateClassData(RD);
+      ++NumDeferredVTables;
+    }
 
   assert(savedSize == DeferredVTables.size() &&
          "deferred extra vtables during vtable emission?");
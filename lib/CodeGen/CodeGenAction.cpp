@@ -7,6 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "CodeGenModule.h"
 #include "CoverageMappingGen.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
@@ -32,6 +33,7 @@
 #include "llvm/Linker/Linker.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/Timer.h"
 #include <memory>
@@ -53,6 +55,17 @@ namespace clang {
 
     std::unique_ptr<CodeGenerator> Gen;
 
+    /// With -fearly-function-passes, the passes that are run over functions
+    /// as they are generated.
+    std::unique_ptr<EarlyFunctionPasses> EarlyPasses;
+
+    /// With -fparallel-codegen, the outputs for the partitions of the module
+    /// after the first, which goes to AsmOutStream.
+    std::vector<std::unique_ptr<raw_pwrite_stream>> PartitionOutStreams;
+
+    /// Whether to collect the statistics reported by -print-stats.
+    bool CollectStats = false;
+
     SmallVector<std::pair<unsigned, std::unique_ptr<llvm::Module>>, 4>
         LinkModules;
 
@@ -85,6 +98,10 @@ namespace clang {
     std::unique_ptr<llvm::Module> takeModule() {
       return std::unique_ptr<llvm::Module>(Gen->ReleaseModule());
     }
+    void setCollectStats() { CollectStats = true; }
+    void addPartitionOutStream(std::unique_ptr<raw_pwrite_stream> OS) {
+      PartitionOutStreams.push_back(std::move(OS));
+    }
     void releaseLinkModules() {
       for (auto &I : LinkModules)
         I.second.release();
@@ -106,6 +123,20 @@ namespace clang {
 
       if (llvm::TimePassesIsEnabled)
         LLVMIRGeneration.stopTimer();
+
+      if (CodeGenOpts.EarlyFunctionPasses) {
+        EarlyPasses = createEarlyFunctionPasses(Diags, CodeGenOpts, TargetOpts,
+                                                LangOpts, getModule());
+        Gen->CGM().setEarlyFunctionPasses(EarlyPasses.get());
+      }
+      if (CollectStats)
+        Gen->CGM().setCollectDeferredStats();
+
+      // Coverage mappings of unused functions are built from their bodies at
+      // the end of the translation unit.
+      if (CodeGenOpts.DiscardASTBodiesAfterCodeGen &&
+          !CodeGenOpts.CoverageMapping)
+        Ctx.setAllocateBodiesInRegions(true);
     }
 
     bool HandleTopLevelDecl(DeclGroupRef D) override {
@@ -121,9 +152,30 @@ namespace clang {
       if (llvm::TimePassesIsEnabled)
         LLVMIRGeneration.stopTimer();
 
+      // Optimize the functions completed by this declaration while the rest
+      // of the translation unit is still to be parsed.
+      Gen->CGM().runEarlyFunctionPasses();
+
+      if (Context->shouldAllocateBodiesInRegions())
+        discardEmittedBodies(D);
       return true;
     }
 
+    /// Release the bodies of the functions in \p D that have been emitted
+    /// and that nothing will emit again. Inline functions and functions whose
+    /// emission was deferred are emitted, or re-emitted, when they are used.
+    void discardEmittedBodies(DeclGroupRef D) {
+      for (Decl *TopLevel : D) {
+        auto *FD = dyn_cast<FunctionDecl>(TopLevel);
+        if (!FD || !FD->doesThisDeclarationHaveABody() || FD->isInlined())
+          continue;
+        llvm::GlobalValue *GV =
+            Gen->CGM().GetGlobalValue(Gen->CGM().getMangledName(FD));
+        if (GV && !GV->isDeclaration())
+          Context->discardFunctionBody(FD);
+      }
+    }
+
     void HandleInlineFunctionDefinition(FunctionDecl *D) override {
       PrettyStackTraceDecl CrashInfo(D, SourceLocation(),
                                      Context->getSourceManager(),
@@ -176,15 +228,25 @@ namespace clang {
 
       EmbedBitcode(getModule(), CodeGenOpts, llvm::MemoryBufferRef());
 
+      SmallVector<raw_pwrite_stream *, 8> PartitionOS;
+      for (auto &OS : PartitionOutStreams)
+        PartitionOS.push_back(OS.get());
+
       EmitBackendOutput(Diags, CodeGenOpts, TargetOpts, LangOpts,
                         C.getTargetInfo().getDataLayout(),
-                        getModule(), Action, std::move(AsmOutStream));
+                        getModule(), Action, std::move(AsmOutStream),
+                        EarlyPasses.get(), PartitionOS);
+
+      // Close the partitions' outputs, like the main one.
+      PartitionOutStreams.clear();
 
       Ctx.setInlineAsmDiagnosticHandler(OldHandler, OldContext);
 
       Ctx.setDiagnosticHandler(OldDiagnosticHandler, OldDiagnosticContext);
     }
 
+    void PrintStats() override { Gen->CGM().PrintStats(); }
+
     void HandleTagDeclDefinition(TagDecl *D) override {
       PrettyStackTraceDecl CrashInfo(D, SourceLocation(),
                                      Context->getSourceManager(),
@@ -712,6 +774,40 @@ GetOutputStream(CompilerInstance &CI, StringRef InFile, BackendAction Action) {
   llvm_unreachable("Invalid action!");
 }
 
+/// With -fparallel-codegen=N, create the outputs for partitions 1 to N-1 of
+/// the module. They are named after the main output, which gets partition 0:
+/// partition I of "foo.o" goes to "foo.I.o".
+///
+/// \return False on error.
+static bool GetPartitionOutputStreams(
+    CompilerInstance &CI, BackendAction Action,
+    SmallVectorImpl<std::unique_ptr<raw_pwrite_stream>> &Streams) {
+  unsigned NumPartitions = CI.getCodeGenOpts().ParallelCodeGenPartitions;
+  if (NumPartitions <= 1 ||
+      (Action != Backend_EmitObj && Action != Backend_EmitAssembly))
+    return true;
+
+  StringRef OutputFile = CI.getFrontendOpts().OutputFile;
+  if (OutputFile.empty() || OutputFile == "-") {
+    CI.getDiagnostics().Report(
+        diag::err_fe_parallel_codegen_requires_output_file);
+    return false;
+  }
+
+  StringRef Extension = llvm::sys::path::extension(OutputFile);
+  StringRef Stem = OutputFile.drop_back(Extension.size());
+  for (unsigned I = 1; I != NumPartitions; ++I) {
+    std::unique_ptr<raw_pwrite_stream> OS = CI.createOutputFile(
+        (Stem + "." + Twine(I) + Extension).str(),
+        /*Binary=*/Action == Backend_EmitObj, /*RemoveFileOnSignal=*/true,
+        /*BaseInput=*/"", /*Extension=*/"", /*UseTemporary=*/true);
+    if (!OS)
+      return false;
+    Streams.push_back(std::move(OS));
+  }
+  return true;
+}
+
 std::unique_ptr<ASTConsumer>
 CodeGenAction::CreateASTConsumer(CompilerInstance &CI, StringRef InFile) {
   BackendAction BA = static_cast<BackendAction>(Act);
@@ -719,6 +815,10 @@ CodeGenAction::CreateASTConsumer(CompilerInstance &CI, StringRef InFile) {
   if (BA != Backend_EmitNothing && !OS)
     return nullptr;
 
+  SmallVector<std::unique_ptr<raw_pwrite_stream>, 4> PartitionOS;
+  if (!GetPartitionOutputStreams(CI, BA, PartitionOS))
+    return nullptr;
+
   // Load bitcode modules to link with, if we need to.
   if (LinkModules.empty())
     for (auto &I : CI.getCodeGenOpts().LinkBitcodeFiles) {
@@ -756,6 +856,10 @@ CodeGenAction::CreateASTConsumer(CompilerInstance &CI, StringRef InFile) {
       CI.getPreprocessorOpts(), CI.getCodeGenOpts(), CI.getTargetOpts(),
       CI.getLangOpts(), CI.getFrontendOpts().ShowTimers, InFile, LinkModules,
       std::move(OS), *VMContext, CoverageInfo));
+  for (auto &PartOS : PartitionOS)
+    Result->addPartitionOutStream(std::move(PartOS));
+  if (CI.getFrontendOpts().ShowStats)
+    Result->setCollectStats();
   BEConsumer = Result.get();
   return std::move(Result);
 }
@@ -26,6 +26,7 @@
 #include "clang/AST/DeclCXX.h"
 #include "clang/AST/StmtCXX.h"
 #include "clang/Basic/Builtins.h"
+#include "clang/Basic/CompileTimeBudget.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/CodeGen/CGFunctionInfo.h"
 #include "clang/Frontend/CodeGenOptions.h"
@@ -999,6 +1000,17 @@ void CodeGenFunction::GenerateCode(GlobalDecl GD, llvm::Function *Fn,
   const FunctionDecl *FD = cast<FunctionDecl>(GD.getDecl());
   CurGD = GD;
 
+  if (CompileTimeBudget::isExceeded())
+    CompileTimeBudget::getActive()->reportActivity(
+        "code generation", [&](raw_ostream &OS) {
+          OS << "  emitting ";
+          FD->getNameForDiagnostic(OS, getContext().getPrintingPolicy(),
+                                   /*Qualified=*/true);
+          OS << " at ";
+          FD->getLocation().print(OS, getContext().getSourceManager());
+          OS << '\n';
+        });
+
   FunctionArgList Args;
   QualType ResTy = BuildFunctionArgList(GD, Args);
 
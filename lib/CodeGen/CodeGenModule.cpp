@@ -36,12 +36,16 @@
 #include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/Basic/Builtins.h"
 #include "clang/Basic/CharInfo.h"
+#include "clang/Basic/CompileTimeBudget.h"
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/Module.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Basic/Version.h"
+#include "clang/CodeGen/BackendUtil.h"
 #include "clang/Frontend/CodeGenOptions.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Sema/SemaDiagnostic.h"
 #include "llvm/ADT/APSInt.h"
 #include "llvm/ADT/Triple.h"
@@ -51,10 +55,13 @@
 #include "llvm/IR/Intrinsics.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
 #include "llvm/ProfileData/InstrProfReader.h"
 #include "llvm/Support/ConvertUTF.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MD5.h"
+#include "llvm/Support/Timer.h"
 
 using namespace clang;
 using namespace CodeGen;
@@ -371,7 +378,11 @@ void InstrProfStats::reportDiagnostics(DiagnosticsEngine &Diags,
 }
 
 void CodeGenModule::Release() {
+  TimeTraceScope TraceScope("CodeGenModule::Release");
+  CompileTimePhaseScope PhaseScope("code generation");
+
   EmitDeferred();
+  EmitPrunedDeferredDecls();
   applyGlobalValReplacements();
   applyReplacements();
   checkAliases();
@@ -396,6 +407,8 @@ void CodeGenModule::Release() {
     getModule().setProfileSummary(PGOReader->getSummary().getMD(VMContext));
     if (PGOStats.hasDiagnostics())
       PGOStats.reportDiagnostics(getDiags(), getCodeGenOpts().MainFileName);
+    if (!CodeGenOpts.ProfileFunctionOrderFile.empty())
+      EmitProfileFunctionOrder();
   }
   EmitCtorList(GlobalCtors, "llvm.global_ctors");
   EmitCtorList(GlobalDtors, "llvm.global_dtors");
@@ -513,18 +526,24 @@ void CodeGenModule::RefreshTypeCacheForClass(const CXXRecordDecl *RD) {
 llvm::MDNode *CodeGenModule::getTBAAInfo(QualType QTy) {
   if (!TBAA)
     return nullptr;
+  llvm::TimeRegion Region(llvm::TimePassesIsEnabled ? &TBAA->getTimer()
+                                                    : nullptr);
   return TBAA->getTBAAInfo(QTy);
 }
 
 llvm::MDNode *CodeGenModule::getTBAAInfoForVTablePtr() {
   if (!TBAA)
     return nullptr;
+  llvm::TimeRegion Region(llvm::TimePassesIsEnabled ? &TBAA->getTimer()
+                                                    : nullptr);
   return TBAA->getTBAAInfoForVTablePtr();
 }
 
 llvm::MDNode *CodeGenModule::getTBAAStructInfo(QualType QTy) {
   if (!TBAA)
     return nullptr;
+  llvm::TimeRegion Region(llvm::TimePassesIsEnabled ? &TBAA->getTimer()
+                                                    : nullptr);
   return TBAA->getTBAAStructInfo(QTy);
 }
 
@@ -533,6 +552,8 @@ llvm::MDNode *CodeGenModule::getTBAAStructTagInfo(QualType BaseTy,
                                                   uint64_t O) {
   if (!TBAA)
     return nullptr;
+  llvm::TimeRegion Region(llvm::TimePassesIsEnabled ? &TBAA->getTimer()
+                                                    : nullptr);
   return TBAA->getTBAAStructTagInfo(BaseTy, AccessN, O);
 }
 
@@ -720,6 +741,29 @@ void CodeGenModule::AddGlobalDtor(llvm::Function *Dtor, int Priority) {
   GlobalDtors.push_back(Structor(Priority, Dtor, nullptr));
 }
 
+void CodeGenModule::EmitProfileFunctionOrder() {
+  // Hottest first; functions with the same count are ordered by name, so that
+  // the file doesn't depend on the order the functions were emitted in.
+  std::sort(ProfiledFunctionCounts.begin(), ProfiledFunctionCounts.end(),
+            [](const std::pair<uint64_t, std::string> &LHS,
+               const std::pair<uint64_t, std::string> &RHS) {
+    if (LHS.first != RHS.first)
+      return LHS.first > RHS.first;
+    return LHS.second < RHS.second;
+  });
+
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(CodeGenOpts.ProfileFunctionOrderFile, EC,
+                          llvm::sys::fs::F_Text);
+  if (EC) {
+    getDiags().Report(diag::err_fe_unable_to_open_output)
+        << CodeGenOpts.ProfileFunctionOrderFile << EC.message();
+    return;
+  }
+  for (const auto &Entry : ProfiledFunctionCounts)
+    OS << Entry.second << '\n';
+}
+
 void CodeGenModule::EmitCtorList(const CtorList &Fns, const char *GlobalName) {
   // Ctor function type is void()*.
   llvm::FunctionType* CtorFTy = llvm::FunctionType::get(VoidTy, false);
@@ -1302,8 +1346,26 @@ void CodeGenModule::EmitDeferred() {
     if (!GV->isDeclaration())
       continue;
 
+    if (shouldPruneDeferredDecl(D, GV)) {
+      PrunedDeferredDecls.emplace_back(GV, D);
+      continue;
+    }
+
     // Otherwise, emit the definition and move on to the next one.
     EmitGlobalDefinition(D, GV);
+    ++NumDeferredDefinitions;
+
+    if (CollectDeferredStats) {
+      const auto *VD = dyn_cast<ValueDecl>(D.getDecl());
+      auto *Fn = dyn_cast_or_null<llvm::Function>(
+          GetGlobalValue(getMangledName(D)));
+      if (VD && Fn && !Fn->isDeclaration() && !MustBeEmitted(VD)) {
+        unsigned NumInsts = 0;
+        for (const llvm::BasicBlock &BB : *Fn)
+          NumInsts += BB.size();
+        DiscardableFunctions.emplace_back(Fn, NumInsts);
+      }
+    }
 
     // If we found out that we need to emit more decls, do that recursively.
     // This has the advantage that the decls are emitted in a DFS and related
@@ -1315,6 +1377,83 @@ void CodeGenModule::EmitDeferred() {
   }
 }
 
+bool CodeGenModule::shouldPruneDeferredDecl(GlobalDecl GD,
+                                            llvm::GlobalValue *GV) {
+  if (!CodeGenOpts.PruneDeferredDefinitions || !EarlyPasses)
+    return false;
+
+  // Constructors and destructors can be referred to through replacements that
+  // are only applied once all of the deferred definitions have been emitted.
+  const auto *FD = dyn_cast<FunctionDecl>(GD.getDecl());
+  if (!FD || isa<CXXConstructorDecl>(FD) || isa<CXXDestructorDecl>(FD) ||
+      MustBeEmitted(FD))
+    return false;
+
+  // Optimizing the functions that referred to it may have removed their
+  // references, for instance from a branch that is never taken.
+  runEarlyFunctionPasses();
+  GV->removeDeadConstantUsers();
+  return GV->use_empty();
+}
+
+void CodeGenModule::EmitPrunedDeferredDecls() {
+  // Emitting some of them may make others referenced again, so keep going
+  // until none of the ones that are left is referenced.
+  bool Requeued = true;
+  while (Requeued) {
+    Requeued = false;
+    std::vector<DeferredGlobal> Pruned;
+    Pruned.swap(PrunedDeferredDecls);
+    for (DeferredGlobal &G : Pruned) {
+      if (!G.GV->isDeclaration())
+        continue;
+      G.GV->removeDeadConstantUsers();
+      if (G.GV->use_empty()) {
+        PrunedDeferredDecls.push_back(G);
+        continue;
+      }
+      addDeferredDeclToEmit(G.GV, G.GD);
+      Requeued = true;
+    }
+    if (Requeued)
+      EmitDeferred();
+  }
+
+  // Drop the rest, as the optimizer would have dropped their definitions. A
+  // definition may have been deferred, and pruned, more than once.
+  llvm::SmallSetVector<llvm::GlobalValue *, 8> Unused;
+  for (DeferredGlobal &G : PrunedDeferredDecls)
+    Unused.insert(G.GV);
+  PrunedDeferredDecls.clear();
+  for (llvm::GlobalValue *GV : Unused)
+    GV->eraseFromParent();
+  NumPrunedDefinitions += Unused.size();
+}
+
+void CodeGenModule::PrintStats() const {
+  llvm::errs() << "\n*** CodeGen Stats:\n";
+  llvm::errs() << "  " << NumDeferredDefinitions
+               << " deferred definitions emitted.\n";
+  llvm::errs() << "  " << NumDeferredVTables << " deferred vtables emitted.\n";
+  llvm::errs() << "  " << NumPrunedDefinitions
+               << " deferred definitions pruned.\n";
+  if (!CollectDeferredStats)
+    return;
+
+  // The functions the optimizer deleted have been removed from the module.
+  unsigned NumDeleted = 0, NumInsts = 0, NumDeletedInsts = 0;
+  for (const auto &I : DiscardableFunctions) {
+    NumInsts += I.second;
+    if (!I.first) {
+      ++NumDeleted;
+      NumDeletedInsts += I.second;
+    }
+  }
+  llvm::errs() << "  " << NumDeleted << "/" << DiscardableFunctions.size()
+               << " discardable deferred functions deleted by the optimizer ("
+               << NumDeletedInsts << "/" << NumInsts << " instructions).\n";
+}
+
 void CodeGenModule::EmitGlobalAnnotations() {
   if (Annotations.empty())
     return;
@@ -2908,6 +3047,21 @@ void CodeGenModule::EmitGlobalFunctionDefinition(GlobalDecl GD,
     AddGlobalDtor(Fn, DA->getPriority());
   if (D->hasAttr<AnnotateAttr>())
     AddGlobalAnnotations(D, Fn);
+
+  addCompletedFunction(Fn);
+}
+
+void CodeGenModule::runEarlyFunctionPasses() {
+  if (!EarlyPasses || getDiags().hasErrorOccurred())
+    return;
+
+  // A function may have been replaced or deleted since it was emitted.
+  std::vector<llvm::WeakVH> Fns;
+  Fns.swap(CompletedFunctions);
+  for (llvm::Value *V : Fns)
+    if (auto *Fn = dyn_cast_or_null<llvm::Function>(V))
+      if (!Fn->isDeclaration())
+        EarlyPasses->run(*Fn);
 }
 
 void CodeGenModule::EmitAliasDefinition(GlobalDecl GD) {
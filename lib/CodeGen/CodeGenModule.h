@@ -77,6 +77,7 @@ class AnnotateAttr;
 class CXXDestructorDecl;
 class Module;
 class CoverageSourceInfo;
+class EarlyFunctionPasses;
 
 namespace CodeGen {
 
@@ -296,6 +297,10 @@ private:
   InstrProfStats PGOStats;
   std::unique_ptr<llvm::SanitizerStatReport> SanStats;
 
+  /// The entry counts of the profiled functions that ran, by symbol name, for
+  /// -fprofile-function-order.
+  std::vector<std::pair<uint64_t, std::string>> ProfiledFunctionCounts;
+
   // A set of references that have only been seen via a weakref so far. This is
   // used to remove the weak of the reference if we ever see a direct reference
   // or a definition.
@@ -346,6 +351,31 @@ private:
   std::vector<llvm::WeakVH> LLVMUsed;
   std::vector<llvm::WeakVH> LLVMCompilerUsed;
 
+  /// With -fearly-function-passes, the passes to run over function
+  /// definitions as soon as they are complete.
+  EarlyFunctionPasses *EarlyPasses = nullptr;
+
+  /// Function definitions whose bodies have been emitted since the early
+  /// passes were last run. Only kept if there are early passes.
+  std::vector<llvm::WeakVH> CompletedFunctions;
+
+  /// Deferred definitions that EmitDeferred didn't emit, because nothing
+  /// referred to them any more once the functions emitted before them had
+  /// been optimized. They are emitted after all if something else refers to
+  /// them by the time the deferred definitions have all been emitted.
+  std::vector<DeferredGlobal> PrunedDeferredDecls;
+
+  /// Statistics about the emission of deferred definitions, for -print-stats.
+  unsigned NumDeferredDefinitions = 0;
+  unsigned NumDeferredVTables = 0;
+  unsigned NumPrunedDefinitions = 0;
+
+  /// If set, the discardable functions in NumDeferredDefinitions, along with
+  /// the number of instructions each had when it was emitted, so that the
+  /// ones the optimizer deletes can be counted.
+  bool CollectDeferredStats = false;
+  std::vector<std::pair<llvm::WeakVH, unsigned>> DiscardableFunctions;
+
   /// Store the list of global constructors and their respective priorities to
   /// be emitted when the translation unit is complete.
   CtorList GlobalCtors;
@@ -539,6 +569,12 @@ public:
   InstrProfStats &getPGOStats() { return PGOStats; }
   llvm::IndexedInstrProfReader *getPGOReader() const { return PGOReader.get(); }
 
+  /// Record the entry count the profile gives for the function with the given
+  /// symbol name, for -fprofile-function-order.
+  void addProfiledFunctionCount(StringRef Name, uint64_t Count) {
+    ProfiledFunctionCounts.push_back(std::make_pair(Count, Name.str()));
+  }
+
   CoverageMappingModuleGen *getCoverageMapping() const {
     return CoverageMapping.get();
   }
@@ -1075,6 +1111,26 @@ public:
     DeferredVTables.push_back(RD);
   }
 
+  /// Run \p EP over function definitions as soon as they are complete, so
+  /// that they can be optimized before the module is.
+  void setEarlyFunctionPasses(EarlyFunctionPasses *EP) { EarlyPasses = EP; }
+
+  /// Note that the body of \p Fn has been emitted.
+  void addCompletedFunction(llvm::Function *Fn) {
+    if (EarlyPasses)
+      CompletedFunctions.push_back(Fn);
+  }
+
+  /// Run the early passes over the function definitions completed since the
+  /// last call.
+  void runEarlyFunctionPasses();
+
+  /// Keep what is needed to report, in PrintStats, how many of the
+  /// discardable definitions CodeGen emitted were deleted by the optimizer.
+  void setCollectDeferredStats() { CollectDeferredStats = true; }
+
+  void PrintStats() const;
+
   /// Emit code for a singal global function or var decl. Forward declarations
   /// are emitted lazily.
   void EmitGlobal(GlobalDecl D);
@@ -1185,6 +1241,11 @@ private:
   /// Emit the function that initializes C++ globals.
   void EmitCXXGlobalInitFunc();
 
+  /// Generate Fn to call the given initialization functions, through
+  /// -fcxx-global-init-chunk-size sized chunks if there are too many of them.
+  void GenerateCXXGlobalInitChunks(llvm::Function *Fn,
+                                   ArrayRef<llvm::Function *> Inits);
+
   /// Emit the function that destroys C++ globals.
   void EmitCXXGlobalDtorFunc();
 
@@ -1210,6 +1271,17 @@ private:
   /// Emit any needed decls for which code generation was deferred.
   void EmitDeferred();
 
+  /// Whether the deferred definition \p GD, whose declaration is \p GV, can
+  /// be left out because nothing refers to \p GV any more.
+  bool shouldPruneDeferredDecl(GlobalDecl GD, llvm::GlobalValue *GV);
+
+  /// Emit the pruned deferred definitions that have come to be referenced
+  /// again, and drop the declarations of the rest.
+  void EmitPrunedDeferredDecls();
+
+  /// Write the -fprofile-function-order symbol ordering file.
+  void EmitProfileFunctionOrder();
+
   /// Call replaceAllUsesWith on all pairs in Replacements.
   void applyReplacements();
 
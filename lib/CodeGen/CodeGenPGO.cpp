@@ -18,6 +18,7 @@
 #include "clang/AST/StmtVisitor.h"
 #include "llvm/IR/Intrinsics.h"
 #include "llvm/IR/MDBuilder.h"
+#include "llvm/IR/ProfileSummary.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MD5.h"
@@ -723,6 +724,16 @@ void CodeGenPGO::computeRegionCounts(const Decl *D) {
     Walker.VisitCapturedDecl(const_cast<CapturedDecl *>(CD));
 }
 
+/// Get the smallest count of the counters that, hottest first, make up 99% of
+/// the total count of the profile. Functions entered at least that many times
+/// are hot.
+static uint64_t getHotCountThreshold(llvm::ProfileSummary &Summary) {
+  for (const llvm::ProfileSummaryEntry &Entry : Summary.getDetailedSummary())
+    if (Entry.Cutoff >= 990000)
+      return Entry.MinCount;
+  return std::numeric_limits<uint64_t>::max();
+}
+
 void
 CodeGenPGO::applyFunctionAttributes(llvm::IndexedInstrProfReader *PGOReader,
                                     llvm::Function *Fn) {
@@ -731,6 +742,20 @@ CodeGenPGO::applyFunctionAttributes(llvm::IndexedInstrProfReader *PGOReader,
 
   uint64_t FunctionCount = getRegionCount(nullptr);
   Fn->setEntryCount(FunctionCount);
+
+  const CodeGenOptions &CodeGenOpts = CGM.getCodeGenOpts();
+  if (FunctionCount && !CodeGenOpts.ProfileFunctionOrderFile.empty())
+    CGM.addProfiledFunctionCount(Fn->getName(), FunctionCount);
+
+  // Keep the hot functions together, and the functions that never ran out of
+  // the way, so that the linker can group them. An explicit section wins.
+  if (!CodeGenOpts.ProfileHotColdSections || Fn->hasSection() ||
+      !CGM.getTriple().isOSBinFormatELF())
+    return;
+  if (FunctionCount == 0)
+    Fn->setSection((".text.unlikely." + Fn->getName()).str());
+  else if (FunctionCount >= getHotCountThreshold(PGOReader->getSummary()))
+    Fn->setSection((".text.hot." + Fn->getName()).str());
 }
 
 void CodeGenPGO::emitCounterIncrement(CGBuilderTy &Builder, const Stmt *S) {
@@ -33,7 +33,8 @@ CodeGenTBAA::CodeGenTBAA(ASTContext &Ctx, llvm::LLVMContext& VMContext,
                          const CodeGenOptions &CGO,
                          const LangOptions &Features, MangleContext &MContext)
   : Context(Ctx), CodeGenOpts(CGO), Features(Features), MContext(MContext),
-    MDHelper(VMContext), Root(nullptr), Char(nullptr) {
+    MDHelper(VMContext), Root(nullptr), Char(nullptr), VTablePtr(nullptr),
+    TBAATime("TBAA Metadata Generation Time") {
 }
 
 CodeGenTBAA::~CodeGenTBAA() {
@@ -72,6 +73,24 @@ llvm::MDNode *CodeGenTBAA::getChar() {
   return Char;
 }
 
+ArrayRef<TBAARecordField>
+CodeGenTBAA::getRecordFields(const RecordDecl *RD) {
+  ArrayRef<TBAARecordField> &Fields = RecordFields[RD];
+  if (!Fields.empty() || RD->field_empty())
+    return Fields;
+
+  const ASTRecordLayout &Layout = Context.getASTRecordLayout(RD);
+  TBAARecordField *Table =
+      RecordFieldAllocator.Allocate<TBAARecordField>(Layout.getFieldCount());
+  unsigned idx = 0;
+  for (RecordDecl::field_iterator i = RD->field_begin(),
+       e = RD->field_end(); i != e; ++i, ++idx) {
+    Table[idx].Type = i->getType();
+    Table[idx].Offset = Layout.getFieldOffset(idx) / Context.getCharWidth();
+  }
+  return Fields = llvm::makeArrayRef(Table, idx);
+}
+
 static bool TypeHasMayAlias(QualType QTy) {
   // Tagged types have declarations, and therefore may have attributes.
   if (const TagType *TTy = dyn_cast<TagType>(QTy))
@@ -167,7 +186,10 @@ CodeGenTBAA::getTBAAInfo(QualType QTy) {
 }
 
 llvm::MDNode *CodeGenTBAA::getTBAAInfoForVTablePtr() {
-  return createTBAAScalarType("vtable pointer", getRoot());
+  if (!VTablePtr)
+    VTablePtr = createTBAAScalarType("vtable pointer", getRoot());
+
+  return VTablePtr;
 }
 
 bool
@@ -188,18 +210,10 @@ CodeGenTBAA::CollectFields(uint64_t BaseOffset,
       if (Decl->bases_begin() != Decl->bases_end())
         return false;
 
-    const ASTRecordLayout &Layout = Context.getASTRecordLayout(RD);
-
-    unsigned idx = 0;
-    for (RecordDecl::field_iterator i = RD->field_begin(),
-         e = RD->field_end(); i != e; ++i, ++idx) {
-      uint64_t Offset = BaseOffset +
-                        Layout.getFieldOffset(idx) / Context.getCharWidth();
-      QualType FieldQTy = i->getType();
-      if (!CollectFields(Offset, FieldQTy, Fields,
-                         MayAlias || TypeHasMayAlias(FieldQTy)))
+    for (const TBAARecordField &Field : getRecordFields(RD))
+      if (!CollectFields(BaseOffset + Field.Offset, Field.Type, Fields,
+                         MayAlias || TypeHasMayAlias(Field.Type)))
         return false;
-    }
     return true;
   }
 
@@ -221,7 +235,7 @@ CodeGenTBAA::getTBAAStructInfo(QualType QTy) {
 
   SmallVector<llvm::MDBuilder::TBAAStructField, 4> Fields;
   if (CollectFields(0, QTy, Fields, TypeHasMayAlias(QTy)))
-    return MDHelper.createTBAAStructNode(Fields);
+    return StructMetadataCache[Ty] = MDHelper.createTBAAStructNode(Fields);
 
   // For now, handle any other kind of type conservatively.
   return StructMetadataCache[Ty] = nullptr;
@@ -252,21 +266,18 @@ CodeGenTBAA::getTBAAStructTypeInfo(QualType QTy) {
   if (const RecordType *TTy = QTy->getAs<RecordType>()) {
     const RecordDecl *RD = TTy->getDecl()->getDefinition();
 
-    const ASTRecordLayout &Layout = Context.getASTRecordLayout(RD);
+    ArrayRef<TBAARecordField> RDFields = getRecordFields(RD);
     SmallVector <std::pair<llvm::MDNode*, uint64_t>, 4> Fields;
-    unsigned idx = 0;
-    for (RecordDecl::field_iterator i = RD->field_begin(),
-         e = RD->field_end(); i != e; ++i, ++idx) {
-      QualType FieldQTy = i->getType();
+    Fields.reserve(RDFields.size());
+    for (const TBAARecordField &Field : RDFields) {
       llvm::MDNode *FieldNode;
-      if (isTBAAPathStruct(FieldQTy))
-        FieldNode = getTBAAStructTypeInfo(FieldQTy);
+      if (isTBAAPathStruct(Field.Type))
+        FieldNode = getTBAAStructTypeInfo(Field.Type);
       else
-        FieldNode = getTBAAInfo(FieldQTy);
+        FieldNode = getTBAAInfo(Field.Type);
       if (!FieldNode)
         return StructTypeMetadataCache[Ty] = nullptr;
-      Fields.push_back(std::make_pair(
-          FieldNode, Layout.getFieldOffset(idx) / Context.getCharWidth()));
+      Fields.push_back(std::make_pair(FieldNode, Field.Offset));
     }
 
     SmallString<256> OutName;
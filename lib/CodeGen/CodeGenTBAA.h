@@ -17,9 +17,12 @@
 
 #include "clang/AST/Type.h"
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Metadata.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/Timer.h"
 
 namespace clang {
   class ASTContext;
@@ -27,6 +30,7 @@ namespace clang {
   class LangOptions;
   class MangleContext;
   class QualType;
+  class RecordDecl;
   class Type;
 
 namespace CodeGen {
@@ -40,6 +44,13 @@ namespace CodeGen {
     uint64_t Offset;
   };
 
+  /// A field of a record as seen by TBAA: its type and its offset in bytes
+  /// from the start of the record.
+  struct TBAARecordField {
+    QualType Type;
+    uint64_t Offset;
+  };
+
 /// CodeGenTBAA - This class organizes the cross-module state that is used
 /// while lowering AST types to LLVM types.
 class CodeGenTBAA {
@@ -65,8 +76,18 @@ class CodeGenTBAA {
   /// them for struct assignments.
   llvm::DenseMap<const Type *, llvm::MDNode *> StructMetadataCache;
 
+  /// RecordFields - This maps record definitions to their fields, computed
+  /// once from the record layout and shared by the struct-path type nodes
+  /// and the !tbaa.struct nodes of every type declared by that record.
+  llvm::DenseMap<const RecordDecl *, ArrayRef<TBAARecordField>> RecordFields;
+  llvm::BumpPtrAllocator RecordFieldAllocator;
+
   llvm::MDNode *Root;
   llvm::MDNode *Char;
+  llvm::MDNode *VTablePtr;
+
+  /// The time spent building TBAA metadata, reported by -ftime-report.
+  llvm::Timer TBAATime;
 
   /// getRoot - This is the mdnode for the root of the metadata type graph
   /// for this translation unit.
@@ -76,6 +97,9 @@ class CodeGenTBAA {
   /// considered to be equivalent to it.
   llvm::MDNode *getChar();
 
+  /// getRecordFields - Get the fields of the given record definition.
+  ArrayRef<TBAARecordField> getRecordFields(const RecordDecl *RD);
+
   /// CollectFields - Collect information about the fields of a type for
   /// !tbaa.struct metadata formation. Return false for an unsupported type.
   bool CollectFields(uint64_t BaseOffset,
@@ -95,6 +119,10 @@ public:
               MangleContext &MContext);
   ~CodeGenTBAA();
 
+  /// getTimer - The timer that callers should run while building TBAA
+  /// metadata when -ftime-report is enabled.
+  llvm::Timer &getTimer() { return TBAATime; }
+
   /// getTBAAInfo - Get the TBAA MDNode to be used for a dereference
   /// of the given type.
   llvm::MDNode *getTBAAInfo(QualType QTy);
@@ -33,7 +33,7 @@ CodeGenTypes::CodeGenTypes(CodeGenModule &cgm)
   : CGM(cgm), Context(cgm.getContext()), TheModule(cgm.getModule()),
     Target(cgm.getTarget()), TheCXXABI(cgm.getCXXABI()),
     TheABIInfo(cgm.getTargetCodeGenInfo().getABIInfo()) {
-  SkippedLayout = false;
+  NumPlaceholders = 0;
 }
 
 CodeGenTypes::~CodeGenTypes() {
@@ -246,8 +246,10 @@ void CodeGenTypes::UpdateCompletedType(const TagDecl *TD) {
       // Okay, we formed some types based on this.  We speculated that the enum
       // would be lowered to i32, so we only need to flush the cache if this
       // didn't happen.
-      if (!ConvertType(ED->getIntegerType())->isIntegerTy(32))
+      if (!ConvertType(ED->getIntegerType())->isIntegerTy(32)) {
         TypeCache.clear();
+        TypesWithPlaceholders.clear();
+      }
     }
     // If necessary, provide the full definition of a type only used with a
     // declaration so far.
@@ -272,6 +274,12 @@ void CodeGenTypes::UpdateCompletedType(const TagDecl *TD) {
     DI->completeType(RD);
 }
 
+void CodeGenTypes::flushTypesWithPlaceholders() {
+  for (const Type *Ty : TypesWithPlaceholders)
+    TypeCache.erase(Ty);
+  TypesWithPlaceholders.clear();
+}
+
 void CodeGenTypes::RefreshTypeCacheForClass(const CXXRecordDecl *RD) {
   QualType T = Context.getRecordType(RD);
   T = Context.getCanonicalType(T);
@@ -279,6 +287,7 @@ void CodeGenTypes::RefreshTypeCacheForClass(const CXXRecordDecl *RD) {
   const Type *Ty = T.getTypePtr();
   if (RecordsWithOpaqueMemberPointers.count(Ty)) {
     TypeCache.clear();
+    TypesWithPlaceholders.clear();
     RecordsWithOpaqueMemberPointers.clear();
   }
 }
@@ -325,7 +334,7 @@ llvm::Type *CodeGenTypes::ConvertFunctionType(QualType QFT,
         if (const RecordType *RT = FPT->getParamType(i)->getAs<RecordType>())
           ConvertRecordDeclType(RT->getDecl());
 
-    SkippedLayout = true;
+    ++NumPlaceholders;
 
     // Return a placeholder type.
     return llvm::StructType::get(getLLVMContext());
@@ -335,7 +344,7 @@ llvm::Type *CodeGenTypes::ConvertFunctionType(QualType QFT,
   // to recursively convert any pointed-to structs.  Converting directly-used
   // structs is ok though.
   if (!RecordsBeingLaidOut.insert(Ty).second) {
-    SkippedLayout = true;
+    ++NumPlaceholders;
     return llvm::StructType::get(getLLVMContext());
   }
 
@@ -357,7 +366,7 @@ llvm::Type *CodeGenTypes::ConvertFunctionType(QualType QFT,
   if (FunctionsBeingProcessed.count(FI)) {
 
     ResultType = llvm::StructType::get(getLLVMContext());
-    SkippedLayout = true;
+    ++NumPlaceholders;
   } else {
 
     // Otherwise, we're good to go, go ahead and convert it.
@@ -366,8 +375,7 @@ llvm::Type *CodeGenTypes::ConvertFunctionType(QualType QFT,
 
   RecordsBeingLaidOut.erase(Ty);
 
-  if (SkippedLayout)
-    TypeCache.clear();
+  flushTypesWithPlaceholders();
 
   if (RecordsBeingLaidOut.empty())
     while (!DeferredRecords.empty())
@@ -388,10 +396,15 @@ llvm::Type *CodeGenTypes::ConvertType(QualType T) {
   // See if type is already cached.
   llvm::DenseMap<const Type *, llvm::Type *>::iterator TCI = TypeCache.find(Ty);
   // If type is found in map then use it. Otherwise, convert type T.
-  if (TCI != TypeCache.end())
+  if (TCI != TypeCache.end()) {
+    // A type built from a type that contains a placeholder contains it too.
+    if (!TypesWithPlaceholders.empty() && TypesWithPlaceholders.count(Ty))
+      ++NumPlaceholders;
     return TCI->second;
+  }
 
   // If we don't have it in the cache, convert it now.
+  unsigned OldNumPlaceholders = NumPlaceholders;
   llvm::Type *ResultType = nullptr;
   switch (Ty->getTypeClass()) {
   case Type::Record: // Handled above.
@@ -530,7 +543,7 @@ llvm::Type *CodeGenTypes::ConvertType(QualType T) {
     // unsized (e.g. an incomplete struct) just use [0 x i8].
     ResultType = ConvertTypeForMem(A->getElementType());
     if (!ResultType->isSized()) {
-      SkippedLayout = true;
+      ++NumPlaceholders;
       ResultType = llvm::Type::getInt8Ty(getLLVMContext());
     }
     ResultType = llvm::ArrayType::get(ResultType, 0);
@@ -543,7 +556,7 @@ llvm::Type *CodeGenTypes::ConvertType(QualType T) {
     // Lower arrays of undefined struct type to arrays of i8 just to have a 
     // concrete type.
     if (!EltTy->isSized()) {
-      SkippedLayout = true;
+      ++NumPlaceholders;
       EltTy = llvm::Type::getInt8Ty(getLLVMContext());
     }
 
@@ -643,6 +656,8 @@ llvm::Type *CodeGenTypes::ConvertType(QualType T) {
   assert(ResultType && "Didn't convert a type?");
   
   TypeCache[Ty] = ResultType;
+  if (NumPlaceholders != OldNumPlaceholders)
+    TypesWithPlaceholders.insert(Ty);
   return ResultType;
 }
 
@@ -705,9 +720,7 @@ llvm::StructType *CodeGenTypes::ConvertRecordDeclType(const RecordDecl *RD) {
    
   // If this struct blocked a FunctionType conversion, then recompute whatever
   // was derived from that.
-  // FIXME: This is hugely overconservative.
-  if (SkippedLayout)
-    TypeCache.clear();
+  flushTypesWithPlaceholders();
     
   // If we're done converting the outer-most record, then convert any deferred
   // structs as well.
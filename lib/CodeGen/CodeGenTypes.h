@@ -152,9 +152,15 @@ class CodeGenTypes {
   
   llvm::SmallPtrSet<const CGFunctionInfo*, 4> FunctionsBeingProcessed;
   
-  /// True if we didn't layout a function due to a being inside
-  /// a recursive struct conversion, set this to true.
-  bool SkippedLayout;
+  /// The number of placeholder types created so far, because a type could
+  /// not be converted yet; e.g. a function type that uses an incomplete
+  /// struct or that is used inside a recursive struct conversion.
+  unsigned NumPlaceholders;
+
+  /// The types in TypeCache whose conversion contains a placeholder, directly
+  /// or through another such type. When a record is laid out, only these are
+  /// removed from the cache to be converted again.
+  llvm::SmallPtrSet<const Type *, 8> TypesWithPlaceholders;
 
   SmallVector<const RecordDecl *, 8> DeferredRecords;
   
@@ -166,6 +172,9 @@ class CodeGenTypes {
 
   unsigned ClangCallConvToLLVMCallConv(CallingConv CC);
 
+  /// Remove the types that contain a placeholder from the type cache.
+  void flushTypesWithPlaceholders();
+
 public:
   CodeGenTypes(CodeGenModule &cgm);
   ~CodeGenTypes();
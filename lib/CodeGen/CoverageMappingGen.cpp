@@ -991,7 +991,7 @@ void CoverageMappingModuleGen::addFunctionMappingRecord(
   if (!IsUsed)
     FunctionNames.push_back(
         llvm::ConstantExpr::getBitCast(NamePtr, llvm::Type::getInt8PtrTy(Ctx)));
-  CoverageMappings.push_back(CoverageMapping);
+  CoverageMappings += CoverageMapping;
 
   if (CGM.getCodeGenOpts().DumpCoverageMapping) {
     // Dump the coverage mapping data for this function by decoding the
@@ -1002,10 +1002,8 @@ void CoverageMappingModuleGen::addFunctionMappingRecord(
     std::vector<StringRef> Filenames;
     std::vector<CounterExpression> Expressions;
     std::vector<CounterMappingRegion> Regions;
-    llvm::SmallVector<StringRef, 16> FilenameRefs;
-    FilenameRefs.resize(FileEntries.size());
-    for (const auto &Entry : FileEntries)
-      FilenameRefs[Entry.second] = Entry.first->getName();
+    std::vector<StringRef> FilenameRefs(this->Filenames.begin(),
+                                        this->Filenames.end());
     RawCoverageMappingReader Reader(CoverageMapping, FilenameRefs, Filenames,
                                     Expressions, Regions);
     if (Reader.read())
@@ -1021,36 +1019,33 @@ void CoverageMappingModuleGen::emit() {
   auto *Int32Ty = llvm::Type::getInt32Ty(Ctx);
 
   // Create the filenames and merge them with coverage mappings
-  llvm::SmallVector<std::string, 16> FilenameStrs;
-  llvm::SmallVector<StringRef, 16> FilenameRefs;
-  FilenameStrs.resize(FileEntries.size());
-  FilenameRefs.resize(FileEntries.size());
-  for (const auto &Entry : FileEntries) {
-    llvm::SmallString<256> Path(Entry.first->getName());
-    llvm::sys::fs::make_absolute(Path);
-
-    auto I = Entry.second;
-    FilenameStrs[I] = std::string(Path.begin(), Path.end());
-    FilenameRefs[I] = FilenameStrs[I];
-  }
+  std::vector<StringRef> FilenameRefs(Filenames.begin(), Filenames.end());
+  std::string FilenamesSection;
+  llvm::raw_string_ostream FilenamesOS(FilenamesSection);
+  CoverageFilenamesSectionWriter(FilenameRefs).write(FilenamesOS);
+  FilenamesOS.flush();
+  size_t FilenamesSize = FilenamesSection.size();
+  size_t CoverageMappingSize = CoverageMappings.size();
 
-  std::string FilenamesAndCoverageMappings;
-  llvm::raw_string_ostream OS(FilenamesAndCoverageMappings);
-  CoverageFilenamesSectionWriter(FilenameRefs).write(OS);
-  std::string RawCoverageMappings =
-      llvm::join(CoverageMappings.begin(), CoverageMappings.end(), "");
-  OS << RawCoverageMappings;
-  size_t CoverageMappingSize = RawCoverageMappings.size();
-  size_t FilenamesSize = OS.str().size() - CoverageMappingSize;
   // Append extra zeroes if necessary to ensure that the size of the filenames
   // and coverage mappings is a multiple of 8.
-  if (size_t Rem = OS.str().size() % 8) {
-    CoverageMappingSize += 8 - Rem;
-    for (size_t I = 0, S = 8 - Rem; I < S; ++I)
-      OS << '\0';
-  }
-  auto *FilenamesAndMappingsVal =
-      llvm::ConstantDataArray::getString(Ctx, OS.str(), false);
+  size_t Padding = 0;
+  if (size_t Rem = (FilenamesSize + CoverageMappingSize) % 8)
+    Padding = 8 - Rem;
+  CoverageMappingSize += Padding;
+
+  // The mappings can be large, so they are copied only once, and released as
+  // soon as they have been.
+  std::string FilenamesAndCoverageMappings;
+  FilenamesAndCoverageMappings.reserve(FilenamesSize + CoverageMappingSize);
+  FilenamesAndCoverageMappings += FilenamesSection;
+  FilenamesAndCoverageMappings += CoverageMappings;
+  FilenamesAndCoverageMappings.append(Padding, '\0');
+  std::string().swap(CoverageMappings);
+
+  auto *FilenamesAndMappingsVal = llvm::ConstantDataArray::getString(
+      Ctx, FilenamesAndCoverageMappings, false);
+  std::string().swap(FilenamesAndCoverageMappings);
 
   // Create the deferred function records array
   auto RecordsTy =
@@ -1104,7 +1099,14 @@ unsigned CoverageMappingModuleGen::getFileID(const FileEntry *File) {
   auto It = FileEntries.find(File);
   if (It != FileEntries.end())
     return It->second;
-  unsigned FileID = FileEntries.size();
+
+  llvm::SmallString<256> Path(File->getName());
+  llvm::sys::fs::make_absolute(Path);
+  auto Inserted = FilenameIDs.insert(
+      std::make_pair(Path.str(), unsigned(Filenames.size())));
+  if (Inserted.second)
+    Filenames.push_back(Path.str());
+  unsigned FileID = Inserted.first->second;
   FileEntries.insert(std::make_pair(File, FileID));
   return FileID;
 }
@@ -53,10 +53,15 @@ class CoverageMappingModuleGen {
   CodeGenModule &CGM;
   CoverageSourceInfo &SourceInfo;
   llvm::SmallDenseMap<const FileEntry *, unsigned, 8> FileEntries;
+  /// The absolute paths of the files, indexed by file id. Files that have the
+  /// same path share an id.
+  std::vector<std::string> Filenames;
+  llvm::StringMap<unsigned> FilenameIDs;
   std::vector<llvm::Constant *> FunctionRecords;
   std::vector<llvm::Constant *> FunctionNames;
   llvm::StructType *FunctionRecordTy;
-  std::vector<std::string> CoverageMappings;
+  /// The encoded mappings of the functions added so far, back to back.
+  std::string CoverageMappings;
 
 public:
   CoverageMappingModuleGen(CodeGenModule &CGM, CoverageSourceInfo &SourceInfo)
@@ -1885,6 +1885,18 @@ class X86_64ABIInfo : public SwiftABIInfo {
   void classify(QualType T, uint64_t OffsetBase, Class &Lo, Class &Hi,
                 bool isNamedArg) const;
 
+  /// classifyRecord - Implement classify for the record type \arg RT.
+  void classifyRecord(const RecordType *RT, uint64_t OffsetBase, Class &Lo,
+                      Class &Hi, bool isNamedArg) const;
+
+  /// The classifications computed by classifyRecord, keyed by the record
+  /// type and the bit offset and named-ness it was classified with.  The
+  /// same records show up in many signatures and as fields of each other,
+  /// so each is only classified once.
+  typedef std::pair<const RecordType *, uint64_t> RecordClassKey;
+  mutable llvm::DenseMap<RecordClassKey, std::pair<Class, Class>>
+      RecordClasses;
+
   llvm::Type *GetByteVectorType(QualType Ty) const;
   llvm::Type *GetSSETypeAtOffset(llvm::Type *IRType,
                                  unsigned IROffset, QualType SourceTy,
@@ -2504,122 +2516,141 @@ void X86_64ABIInfo::classify(QualType Ty, uint64_t OffsetBase,
   }
 
   if (const RecordType *RT = Ty->getAs<RecordType>()) {
-    uint64_t Size = getContext().getTypeSize(Ty);
-
-    // AMD64-ABI 3.2.3p2: Rule 1. If the size of an object is larger
-    // than four eightbytes, ..., it has class MEMORY.
-    if (Size > 256)
+    RecordClassKey Key(RT, (OffsetBase << 1) | isNamedArg);
+    auto Known = RecordClasses.find(Key);
+    if (Known != RecordClasses.end()) {
+      Lo = Known->second.first;
+      Hi = Known->second.second;
       return;
+    }
+    classifyRecord(RT, OffsetBase, Lo, Hi, isNamedArg);
+    RecordClasses[Key] = std::make_pair(Lo, Hi);
+  }
+}
 
-    // AMD64-ABI 3.2.3p2: Rule 2. If a C++ object has either a non-trivial
-    // copy constructor or a non-trivial destructor, it is passed by invisible
-    // reference.
-    if (getRecordArgABI(RT, getCXXABI()))
-      return;
+void X86_64ABIInfo::classifyRecord(const RecordType *RT, uint64_t OffsetBase,
+                                   Class &Lo, Class &Hi,
+                                   bool isNamedArg) const {
+  Lo = Hi = NoClass;
 
-    const RecordDecl *RD = RT->getDecl();
+  Class &Current = OffsetBase < 64 ? Lo : Hi;
+  Current = Memory;
 
-    // Assume variable sized types are passed in memory.
-    if (RD->hasFlexibleArrayMember())
-      return;
+  uint64_t Size = getContext().getTypeSize(QualType(RT, 0));
 
-    const ASTRecordLayout &Layout = getContext().getASTRecordLayout(RD);
+  // AMD64-ABI 3.2.3p2: Rule 1. If the size of an object is larger
+  // than four eightbytes, ..., it has class MEMORY.
+  if (Size > 256)
+    return;
 
-    // Reset Lo class, this will be recomputed.
-    Current = NoClass;
+  // AMD64-ABI 3.2.3p2: Rule 2. If a C++ object has either a non-trivial
+  // copy constructor or a non-trivial destructor, it is passed by invisible
+  // reference.
+  if (getRecordArgABI(RT, getCXXABI()))
+    return;
 
-    // If this is a C++ record, classify the bases first.
-    if (const CXXRecordDecl *CXXRD = dyn_cast<CXXRecordDecl>(RD)) {
-      for (const auto &I : CXXRD->bases()) {
-        assert(!I.isVirtual() && !I.getType()->isDependentType() &&
-               "Unexpected base class!");
-        const CXXRecordDecl *Base =
-          cast<CXXRecordDecl>(I.getType()->getAs<RecordType>()->getDecl());
+  const RecordDecl *RD = RT->getDecl();
 
-        // Classify this field.
-        //
-        // AMD64-ABI 3.2.3p2: Rule 3. If the size of the aggregate exceeds a
-        // single eightbyte, each is classified separately. Each eightbyte gets
-        // initialized to class NO_CLASS.
-        Class FieldLo, FieldHi;
-        uint64_t Offset =
-          OffsetBase + getContext().toBits(Layout.getBaseClassOffset(Base));
-        classify(I.getType(), Offset, FieldLo, FieldHi, isNamedArg);
-        Lo = merge(Lo, FieldLo);
-        Hi = merge(Hi, FieldHi);
-        if (Lo == Memory || Hi == Memory) {
-          postMerge(Size, Lo, Hi);
-          return;
-        }
-      }
-    }
+  // Assume variable sized types are passed in memory.
+  if (RD->hasFlexibleArrayMember())
+    return;
 
-    // Classify the fields one at a time, merging the results.
-    unsigned idx = 0;
-    for (RecordDecl::field_iterator i = RD->field_begin(), e = RD->field_end();
-           i != e; ++i, ++idx) {
-      uint64_t Offset = OffsetBase + Layout.getFieldOffset(idx);
-      bool BitField = i->isBitField();
+  const ASTRecordLayout &Layout = getContext().getASTRecordLayout(RD);
 
-      // AMD64-ABI 3.2.3p2: Rule 1. If the size of an object is larger than
-      // four eightbytes, or it contains unaligned fields, it has class MEMORY.
-      //
-      // The only case a 256-bit wide vector could be used is when the struct
-      // contains a single 256-bit element. Since Lo and Hi logic isn't extended
-      // to work for sizes wider than 128, early check and fallback to memory.
+  // Reset Lo class, this will be recomputed.
+  Current = NoClass;
+
+  // If this is a C++ record, classify the bases first.
+  if (const CXXRecordDecl *CXXRD = dyn_cast<CXXRecordDecl>(RD)) {
+    for (const auto &I : CXXRD->bases()) {
+      assert(!I.isVirtual() && !I.getType()->isDependentType() &&
+             "Unexpected base class!");
+      const CXXRecordDecl *Base =
+        cast<CXXRecordDecl>(I.getType()->getAs<RecordType>()->getDecl());
+
+      // Classify this field.
       //
-      if (Size > 128 && getContext().getTypeSize(i->getType()) != 256) {
-        Lo = Memory;
-        postMerge(Size, Lo, Hi);
-        return;
-      }
-      // Note, skip this test for bit-fields, see below.
-      if (!BitField && Offset % getContext().getTypeAlign(i->getType())) {
-        Lo = Memory;
+      // AMD64-ABI 3.2.3p2: Rule 3. If the size of the aggregate exceeds a
+      // single eightbyte, each is classified separately. Each eightbyte gets
+      // initialized to class NO_CLASS.
+      Class FieldLo, FieldHi;
+      uint64_t Offset =
+        OffsetBase + getContext().toBits(Layout.getBaseClassOffset(Base));
+      classify(I.getType(), Offset, FieldLo, FieldHi, isNamedArg);
+      Lo = merge(Lo, FieldLo);
+      Hi = merge(Hi, FieldHi);
+      if (Lo == Memory || Hi == Memory) {
         postMerge(Size, Lo, Hi);
         return;
       }
+    }
+  }
 
-      // Classify this field.
-      //
-      // AMD64-ABI 3.2.3p2: Rule 3. If the size of the aggregate
-      // exceeds a single eightbyte, each is classified
-      // separately. Each eightbyte gets initialized to class
-      // NO_CLASS.
-      Class FieldLo, FieldHi;
+  // Classify the fields one at a time, merging the results.
+  unsigned idx = 0;
+  for (RecordDecl::field_iterator i = RD->field_begin(), e = RD->field_end();
+         i != e; ++i, ++idx) {
+    uint64_t Offset = OffsetBase + Layout.getFieldOffset(idx);
+    bool BitField = i->isBitField();
 
-      // Bit-fields require special handling, they do not force the
-      // structure to be passed in memory even if unaligned, and
-      // therefore they can straddle an eightbyte.
-      if (BitField) {
-        // Ignore padding bit-fields.
-        if (i->isUnnamedBitfield())
-          continue;
+    // AMD64-ABI 3.2.3p2: Rule 1. If the size of an object is larger than
+    // four eightbytes, or it contains unaligned fields, it has class MEMORY.
+    //
+    // The only case a 256-bit wide vector could be used is when the struct
+    // contains a single 256-bit element. Since Lo and Hi logic isn't extended
+    // to work for sizes wider than 128, early check and fallback to memory.
+    //
+    if (Size > 128 && getContext().getTypeSize(i->getType()) != 256) {
+      Lo = Memory;
+      postMerge(Size, Lo, Hi);
+      return;
+    }
+    // Note, skip this test for bit-fields, see below.
+    if (!BitField && Offset % getContext().getTypeAlign(i->getType())) {
+      Lo = Memory;
+      postMerge(Size, Lo, Hi);
+      return;
+    }
 
-        uint64_t Offset = OffsetBase + Layout.getFieldOffset(idx);
-        uint64_t Size = i->getBitWidthValue(getContext());
+    // Classify this field.
+    //
+    // AMD64-ABI 3.2.3p2: Rule 3. If the size of the aggregate
+    // exceeds a single eightbyte, each is classified
+    // separately. Each eightbyte gets initialized to class
+    // NO_CLASS.
+    Class FieldLo, FieldHi;
+
+    // Bit-fields require special handling, they do not force the
+    // structure to be passed in memory even if unaligned, and
+    // therefore they can straddle an eightbyte.
+    if (BitField) {
+      // Ignore padding bit-fields.
+      if (i->isUnnamedBitfield())
+        continue;
 
-        uint64_t EB_Lo = Offset / 64;
-        uint64_t EB_Hi = (Offset + Size - 1) / 64;
+      uint64_t Offset = OffsetBase + Layout.getFieldOffset(idx);
+      uint64_t Size = i->getBitWidthValue(getContext());
 
-        if (EB_Lo) {
-          assert(EB_Hi == EB_Lo && "Invalid classification, type > 16 bytes.");
-          FieldLo = NoClass;
-          FieldHi = Integer;
-        } else {
-          FieldLo = Integer;
-          FieldHi = EB_Hi ? Integer : NoClass;
-        }
-      } else
-        classify(i->getType(), Offset, FieldLo, FieldHi, isNamedArg);
-      Lo = merge(Lo, FieldLo);
-      Hi = merge(Hi, FieldHi);
-      if (Lo == Memory || Hi == Memory)
-        break;
-    }
+      uint64_t EB_Lo = Offset / 64;
+      uint64_t EB_Hi = (Offset + Size - 1) / 64;
 
-    postMerge(Size, Lo, Hi);
+      if (EB_Lo) {
+        assert(EB_Hi == EB_Lo && "Invalid classification, type > 16 bytes.");
+        FieldLo = NoClass;
+        FieldHi = Integer;
+      } else {
+        FieldLo = Integer;
+        FieldHi = EB_Hi ? Integer : NoClass;
+      }
+    } else
+      classify(i->getType(), Offset, FieldLo, FieldHi, isNamedArg);
+    Lo = merge(Lo, FieldLo);
+    Hi = merge(Hi, FieldHi);
+    if (Lo == Memory || Hi == Memory)
+      break;
   }
+
+  postMerge(Size, Lo, Hi);
 }
 
 ABIArgInfo X86_64ABIInfo::getIndirectReturnResult(QualType Ty) const {
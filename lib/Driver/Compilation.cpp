@@ -13,10 +13,17 @@
 #include "clang/Driver/DriverDiagnostic.h"
 #include "clang/Driver/Options.h"
 #include "clang/Driver/ToolChain.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
 
 using namespace clang::driver;
 using namespace clang;
@@ -26,7 +33,7 @@ Compilation::Compilation(const Driver &D, const ToolChain &_DefaultToolChain,
                          InputArgList *_Args, DerivedArgList *_TranslatedArgs)
     : TheDriver(D), DefaultToolChain(_DefaultToolChain), ActiveOffloadMask(0u),
       Args(_Args), TranslatedArgs(_TranslatedArgs), Redirects(nullptr),
-      ForDiagnostics(false) {
+      ForDiagnostics(false), NumParallelJobs(1) {
   // The offloading host toolchain is the default tool chain.
   OrderedOffloadingToolchains.insert(
       std::make_pair(Action::OFK_Host, &DefaultToolChain));
@@ -122,8 +129,7 @@ bool Compilation::CleanupFileMap(const ArgStringMap &Files,
   return Success;
 }
 
-int Compilation::ExecuteCommand(const Command &C,
-                                const Command *&FailingCommand) const {
+bool Compilation::LogCommand(const Command &C) const {
   if ((getDriver().CCPrintOptions ||
        getArgs().hasArg(options::OPT_v)) && !getDriver().CCGenDiagnostics) {
     raw_ostream *OS = &llvm::errs();
@@ -138,9 +144,8 @@ int Compilation::ExecuteCommand(const Command &C,
       if (EC) {
         getDriver().Diag(clang::diag::err_drv_cc_print_options_failure)
             << EC.message();
-        FailingCommand = &C;
         delete OS;
-        return 1;
+        return false;
       }
     }
 
@@ -152,10 +157,13 @@ int Compilation::ExecuteCommand(const Command &C,
     if (OS != &llvm::errs())
       delete OS;
   }
+  return true;
+}
 
-  std::string Error;
-  bool ExecutionFailed;
-  int Res = C.Execute(Redirects, &Error, &ExecutionFailed);
+int Compilation::ReportCommandResult(const Command &C, int Res,
+                                     const std::string &Error,
+                                     bool ExecutionFailed,
+                                     const Command *&FailingCommand) const {
   if (!Error.empty()) {
     assert(Res && "Error string set with 0 result code!");
     getDriver().Diag(clang::diag::err_drv_command_failure) << Error;
@@ -167,9 +175,27 @@ int Compilation::ExecuteCommand(const Command &C,
   return ExecutionFailed ? 1 : Res;
 }
 
+int Compilation::ExecuteCommand(const Command &C,
+                                const Command *&FailingCommand) const {
+  if (!LogCommand(C)) {
+    FailingCommand = &C;
+    return 1;
+  }
+
+  std::string Error;
+  bool ExecutionFailed;
+  int Res = C.Execute(Redirects, &Error, &ExecutionFailed);
+  return ReportCommandResult(C, Res, Error, ExecutionFailed, FailingCommand);
+}
+
 void Compilation::ExecuteJobs(
     const JobList &Jobs,
     SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const {
+  // Output redirected by the client, e.g. when generating crash diagnostics,
+  // is shared between all jobs, so keep those sequential.
+  if (NumParallelJobs > 1 && Jobs.size() > 1 && !Redirects)
+    return ExecuteJobsInParallel(Jobs, FailingCommands);
+
   for (const auto &Job : Jobs) {
     const Command *FailingCommand = nullptr;
     if (int Res = ExecuteCommand(Job, FailingCommand)) {
@@ -181,6 +207,162 @@ void Compilation::ExecuteJobs(
   }
 }
 
+namespace {
+/// The state of a job run by Compilation::ExecuteJobsInParallel.
+struct ParallelJob {
+  const Command *Cmd = nullptr;
+  /// The indices of the jobs this job has to wait for.
+  SmallVector<unsigned, 4> Dependencies;
+  /// Temporary files buffering the job's stdout and stderr.
+  SmallString<128> OutPath, ErrPath;
+  StringRef OutPathRef, ErrPathRef;
+  const StringRef *Redirects[3] = {nullptr, nullptr, nullptr};
+
+  bool Scheduled = false;
+  bool Done = false;
+  int Res = 0;
+  std::string Error;
+  bool ExecutionFailed = false;
+};
+} // end anonymous namespace
+
+/// Collect the jobs created for inputs of \p A, looking through the actions
+/// that were combined into the job \p Self.
+static void
+collectJobDependencies(const Action *A, unsigned Self,
+                       const llvm::DenseMap<const Action *, unsigned> &Sources,
+                       llvm::SmallPtrSetImpl<const Action *> &Visited,
+                       SmallVectorImpl<unsigned> &Dependencies) {
+  for (const Action *Input : A->inputs()) {
+    if (!Visited.insert(Input).second)
+      continue;
+    auto It = Sources.find(Input);
+    if (It != Sources.end() && It->second != Self) {
+      Dependencies.push_back(It->second);
+      continue;
+    }
+    collectJobDependencies(Input, Self, Sources, Visited, Dependencies);
+  }
+}
+
+/// Print the contents of \p Path to \p OS and remove the file.
+static void flushJobOutput(StringRef Path, raw_ostream &OS) {
+  if (Path.empty())
+    return;
+  if (auto Buffer = llvm::MemoryBuffer::getFile(Path))
+    OS << (*Buffer)->getBuffer();
+  llvm::sys::fs::remove(Path);
+}
+
+void Compilation::ExecuteJobsInParallel(
+    const JobList &Jobs,
+    SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const {
+  std::vector<ParallelJob> States(Jobs.size());
+  llvm::DenseMap<const Action *, unsigned> Sources;
+  unsigned Index = 0;
+  for (const auto &Job : Jobs) {
+    ParallelJob &State = States[Index];
+    State.Cmd = &Job;
+    // Commands created for the same action have to run in their original
+    // order.
+    auto Inserted = Sources.insert(std::make_pair(&Job.getSource(), Index));
+    if (!Inserted.second) {
+      State.Dependencies.push_back(Inserted.first->second);
+      Inserted.first->second = Index;
+    }
+    ++Index;
+  }
+  for (unsigned I = 0, E = States.size(); I != E; ++I) {
+    llvm::SmallPtrSet<const Action *, 16> Visited;
+    collectJobDependencies(&States[I].Cmd->getSource(), I, Sources, Visited,
+                           States[I].Dependencies);
+  }
+
+  std::mutex Mutex;
+  std::condition_variable JobFinished;
+  unsigned NumRunning = 0;
+  unsigned NextToFlush = 0;
+  bool Failed = false;
+
+  auto FinishJob = [&](ParallelJob &State) {
+    flushJobOutput(State.OutPath, llvm::outs());
+    flushJobOutput(State.ErrPath, llvm::errs());
+    const Command *FailingCommand = nullptr;
+    if (int Res = ReportCommandResult(*State.Cmd, State.Res, State.Error,
+                                      State.ExecutionFailed, FailingCommand))
+      FailingCommands.push_back(std::make_pair(Res, FailingCommand));
+  };
+
+  llvm::ThreadPool Pool(NumParallelJobs);
+  std::unique_lock<std::mutex> Lock(Mutex);
+  while (true) {
+    // Print the output of finished jobs in job order, so that the diagnostics
+    // of different jobs are never interleaved.
+    while (NextToFlush != States.size() && States[NextToFlush].Done) {
+      FinishJob(States[NextToFlush++]);
+    }
+
+    // As in the sequential case, do not start new jobs after a failure.
+    for (unsigned I = NextToFlush, E = States.size();
+         I != E && !Failed && NumRunning < NumParallelJobs; ++I) {
+      ParallelJob &State = States[I];
+      if (State.Scheduled ||
+          std::any_of(State.Dependencies.begin(), State.Dependencies.end(),
+                      [&](unsigned D) { return !States[D].Done; }))
+        continue;
+
+      State.Scheduled = true;
+      if (!LogCommand(*State.Cmd)) {
+        State.Done = true;
+        State.Res = 1;
+        Failed = true;
+        break;
+      }
+      // If the temporary files could not be created, let the job write to
+      // our stdout and stderr directly.
+      if (!llvm::sys::fs::createTemporaryFile("clang-job", "out",
+                                              State.OutPath) &&
+          !llvm::sys::fs::createTemporaryFile("clang-job", "err",
+                                              State.ErrPath)) {
+        State.OutPathRef = State.OutPath;
+        State.ErrPathRef = State.ErrPath;
+        State.Redirects[1] = &State.OutPathRef;
+        State.Redirects[2] = &State.ErrPathRef;
+      }
+
+      ++NumRunning;
+      Pool.async([&State, &Mutex, &JobFinished, &NumRunning, &Failed] {
+        std::string Error;
+        bool ExecutionFailed;
+        int Res =
+            State.Cmd->Execute(State.Redirects[1] ? State.Redirects : nullptr,
+                               &Error, &ExecutionFailed);
+        std::lock_guard<std::mutex> Guard(Mutex);
+        State.Res = Res;
+        State.Error = std::move(Error);
+        State.ExecutionFailed = ExecutionFailed;
+        State.Done = true;
+        if (Res)
+          Failed = true;
+        --NumRunning;
+        JobFinished.notify_one();
+      });
+    }
+
+    if (NumRunning == 0)
+      break;
+    JobFinished.wait(Lock);
+  }
+  Lock.unlock();
+  Pool.wait();
+
+  // Jobs depending on a failed job were never started, but jobs after them may
+  // have finished.
+  for (unsigned I = NextToFlush, E = States.size(); I != E; ++I)
+    if (States[I].Done)
+      FinishJob(States[I]);
+}
+
 void Compilation::initCompilationForDiagnostics() {
   ForDiagnostics = true;
 
@@ -42,6 +42,7 @@
 #include "llvm/Support/raw_ostream.h"
 #include <map>
 #include <memory>
+#include <thread>
 #include <utility>
 
 using namespace clang::driver;
@@ -570,6 +571,16 @@ Compilation *Driver::BuildCompilation(ArrayRef<const char *> ArgList) {
   // The compilation takes ownership of Args.
   Compilation *C = new Compilation(*this, TC, UArgs.release(), TranslatedArgs);
 
+  if (const Arg *A = C->getArgs().getLastArg(options::OPT_fparallel_jobs_EQ)) {
+    StringRef Value = A->getValue();
+    unsigned NumJobs;
+    if (Value.getAsInteger(10, NumJobs) || NumJobs == 0)
+      Diag(diag::err_drv_invalid_int_value) << A->getAsString(C->getArgs())
+                                            << Value;
+    else
+      C->setNumParallelJobs(NumJobs);
+  }
+
   if (!HandleImmediateArgs(*C))
     return C;
 
@@ -1436,6 +1447,17 @@ static Action *buildCudaActions(Compilation &C, DerivedArgList &Args,
   if (GpuArchList.empty())
     GpuArchList.push_back(CudaArch::SM_20);
 
+  // Each GPU architecture sees a different __CUDA_ARCH__, so the device side
+  // is parsed once per architecture.  Unless told otherwise, at least run
+  // these independent compilations, and the host one, concurrently.
+  if (GpuArchList.size() > 1 && !Args.hasArg(options::OPT_fparallel_jobs_EQ) &&
+      C.getNumParallelJobs() == 1) {
+    unsigned NumJobs = std::min<unsigned>(GpuArchList.size() + 1,
+                                          std::thread::hardware_concurrency());
+    if (NumJobs > 1)
+      C.setNumParallelJobs(NumJobs);
+  }
+
   // Replicate inputs for each GPU architecture.
   Driver::InputList CudaDeviceInputs;
   for (unsigned I = 0, E = GpuArchList.size(); I != E; ++I)
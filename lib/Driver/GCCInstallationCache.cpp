@@ -0,0 +1,147 @@
+//===--- GCCInstallationCache.cpp - GCC detection cache -------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "GCCInstallationCache.h"
+#include "clang/Basic/VirtualFileSystem.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+using namespace clang::driver;
+
+/// The first line of every cache file.  Bump the version when the format
+/// changes; files with a different signature are ignored.
+static const char Signature[] = "clang-gcc-install-cache 1";
+
+void GCCInstallationCache::read(StringRef Path) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return;
+
+  StringRef Contents = (*Buffer)->getBuffer();
+  StringRef Line;
+  std::tie(Line, Contents) = Contents.split('\n');
+  if (Line != Signature)
+    return;
+
+  // Each entry starts with a "key" line, which is followed by an "install"
+  // line and any number of "candidate" and "dir" lines.  Fields are separated
+  // by tabs; the key itself may contain more of them.
+  std::string Key;
+  Installation I;
+  bool HaveInstall = false;
+  auto Flush = [&] {
+    if (!Key.empty() && HaveInstall)
+      Entries.insert(std::make_pair(std::move(Key), std::move(I)));
+    Key.clear();
+    I = Installation();
+    HaveInstall = false;
+  };
+
+  while (!Contents.empty()) {
+    std::tie(Line, Contents) = Contents.split('\n');
+    StringRef Kind, Rest;
+    std::tie(Kind, Rest) = Line.split('\t');
+    if (Kind == "key") {
+      Flush();
+      Key = Rest;
+    } else if (Kind == "install") {
+      SmallVector<StringRef, 5> Fields;
+      Rest.split(Fields, '\t');
+      if (Fields.size() != 5)
+        continue;
+      I.Triple = Fields[0];
+      I.Version = Fields[1];
+      I.InstallPath = Fields[2];
+      I.ParentLibPath = Fields[3];
+      I.NeedsBiarchSuffix = Fields[4] == "1";
+      HaveInstall = true;
+    } else if (Kind == "candidate") {
+      I.CandidatePaths.push_back(Rest);
+    } else if (Kind == "dir") {
+      StringRef ModTime, Dir;
+      std::tie(ModTime, Dir) = Rest.split('\t');
+      uint64_t Value;
+      if (ModTime.getAsInteger(10, Value) || Dir.empty()) {
+        // Without all of its directories the entry can't be validated.
+        HaveInstall = false;
+        Key.clear();
+        continue;
+      }
+      I.Dirs.push_back(std::make_pair(Dir.str(), Value));
+    }
+  }
+  Flush();
+}
+
+const GCCInstallationCache::Installation *
+GCCInstallationCache::lookup(StringRef Key, vfs::FileSystem &FS) const {
+  auto I = Entries.find(Key);
+  if (I == Entries.end())
+    return nullptr;
+
+  for (const auto &Dir : I->second.Dirs) {
+    llvm::ErrorOr<vfs::Status> S = FS.status(Dir.first);
+    if (!S || !S->isDirectory() ||
+        S->getLastModificationTime().toEpochTime() != Dir.second)
+      return nullptr;
+  }
+  return &I->second;
+}
+
+void GCCInstallationCache::insert(StringRef Key, Installation I) {
+  Entries[Key] = std::move(I);
+  Dirty = true;
+}
+
+bool GCCInstallationCache::save(StringRef Path) {
+  if (!Dirty)
+    return false;
+
+  // Pick up whatever other driver invocations wrote since we loaded the cache.
+  read(Path);
+
+  SmallString<128> TempPath(Path);
+  TempPath += "-%%%%%%%%";
+  int FD;
+  if (llvm::sys::fs::createUniqueFile(TempPath, FD, TempPath))
+    return true;
+
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << Signature << '\n';
+    for (const auto &E : Entries) {
+      const Installation &I = E.second;
+      OS << "key\t" << E.first << '\n';
+      OS << "install\t" << I.Triple << '\t' << I.Version << '\t'
+         << I.InstallPath << '\t' << I.ParentLibPath << '\t'
+         << (I.NeedsBiarchSuffix ? '1' : '0') << '\n';
+      for (const std::string &Candidate : I.CandidatePaths)
+        OS << "candidate\t" << Candidate << '\n';
+      for (const auto &Dir : I.Dirs)
+        OS << "dir\t" << Dir.second << '\t' << Dir.first << '\n';
+    }
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return true;
+    }
+  }
+
+  if (llvm::sys::fs::rename(TempPath, Path)) {
+    llvm::sys::fs::remove(TempPath);
+    return true;
+  }
+  Dirty = false;
+  return false;
+}
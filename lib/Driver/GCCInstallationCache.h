@@ -0,0 +1,91 @@
+//===--- GCCInstallationCache.h - GCC detection cache -----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LIB_DRIVER_GCCINSTALLATIONCACHE_H
+#define LLVM_CLANG_LIB_DRIVER_GCCINSTALLATIONCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringRef.h"
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace clang {
+namespace vfs {
+class FileSystem;
+}
+
+namespace driver {
+
+/// \brief Remembers the GCC installations detected by earlier driver
+/// invocations.
+///
+/// Detecting the GCC installation iterates over dozens of candidate
+/// directories for every combination of prefix, library directory and
+/// triple alias.  This cache records the result of a detection together
+/// with the modification times of the directories whose contents it
+/// depended on, keyed by everything else the detection depends on.  As long
+/// as none of those directories changed, the result can be reused and only
+/// the multilibs of the selected installation need to be detected again.
+///
+/// The cache is stored as a text file, written the same way as the
+/// IncludeGuardCache.
+class GCCInstallationCache {
+public:
+  /// \brief The outcome of a detection.
+  struct Installation {
+    /// \brief The triple and version of the selected installation.  Both are
+    /// empty if no installation was found.
+    std::string Triple, Version;
+    std::string InstallPath, ParentLibPath;
+    bool NeedsBiarchSuffix = false;
+
+    /// \brief The candidate installations that were considered.
+    std::vector<std::string> CandidatePaths;
+
+    /// \brief The directories the detection looked at, with their
+    /// modification times.
+    std::vector<std::pair<std::string, uint64_t>> Dirs;
+  };
+
+private:
+  std::map<std::string, Installation> Entries;
+
+  /// \brief Whether entries were added since the cache was loaded.
+  bool Dirty = false;
+
+  /// \brief Read the entries in \p Path into this cache, keeping any
+  /// existing entry with the same key.  Malformed files are ignored.
+  void read(StringRef Path);
+
+public:
+  /// \brief Load the cache stored in \p Path.  A missing or unreadable file
+  /// results in an empty cache.
+  explicit GCCInstallationCache(StringRef Path) { read(Path); }
+
+  /// \brief Return the installation detected for \p Key, or null if there is
+  /// none or one of the directories it depends on changed in \p FS.
+  const Installation *lookup(StringRef Key, vfs::FileSystem &FS) const;
+
+  /// \brief Record the installation detected for \p Key.
+  void insert(StringRef Key, Installation I);
+
+  /// \brief Write the cache back to \p Path if it changed.
+  ///
+  /// \returns true on failure.
+  bool save(StringRef Path);
+
+  unsigned size() const { return Entries.size(); }
+};
+
+} // end namespace driver
+} // end namespace clang
+
+#endif
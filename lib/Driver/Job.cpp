@@ -18,9 +18,12 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Program.h"
+#include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
+#include <atomic>
 #include <cassert>
 using namespace clang::driver;
 using llvm::raw_ostream;
@@ -333,6 +336,44 @@ int ForceSuccessCommand::Execute(const StringRef **Redirects,
   return 0;
 }
 
+CC1Command::CC1Command(const Action &Source_, const Tool &Creator_,
+                       const char *Executable_,
+                       const ArgStringList &Arguments_,
+                       ArrayRef<InputInfo> Inputs)
+    : Command(Source_, Creator_, Executable_, Arguments_, Inputs) {}
+
+int CC1Command::Execute(const StringRef **Redirects, std::string *ErrMsg,
+                        bool *ExecutionFailed) const {
+  const Driver &D = getCreator().getToolChain().getDriver();
+
+  // The options of the LLVM libraries are global and can only be parsed once
+  // per process, so only the first -cc1 job runs in-process.  Redirected
+  // output, as for parallel jobs and crash diagnostics, needs a process too.
+  static std::atomic<bool> RanInProcess(false);
+  if (!D.CC1Main || Redirects || RanInProcess.exchange(true))
+    return Command::Execute(Redirects, ErrMsg, ExecutionFailed);
+
+  if (ExecutionFailed)
+    *ExecutionFailed = false;
+
+  // Arguments are passed directly, so a response file is never needed.
+  SmallVector<const char *, 128> Argv;
+  Argv.push_back(getExecutable());
+  Argv.append(getArguments().begin(), getArguments().end());
+
+  // Recover from crashes so that the driver can still generate the crash
+  // diagnostics, by running the job again in a process of its own.
+  llvm::CrashRecoveryContext::Enable();
+  llvm::CrashRecoveryContext CRC;
+  int Res = 0;
+  if (!CRC.RunSafely([&] { Res = D.CC1Main(Argv); })) {
+    // Remove the partial outputs the job registered for removal on signals.
+    llvm::sys::RunInterruptHandlers();
+    return -1;
+  }
+  return Res;
+}
+
 void JobList::Print(raw_ostream &OS, const char *Terminator, bool Quote,
                     CrashReportInfo *CrashInfo) const {
   for (const auto &Job : *this)
@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "ToolChains.h"
+#include "GCCInstallationCache.h"
 #include "clang/Basic/Cuda.h"
 #include "clang/Basic/ObjCRuntime.h"
 #include "clang/Basic/Version.h"
@@ -21,6 +22,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Option/Arg.h"
 #include "llvm/Option/ArgList.h"
@@ -1363,6 +1365,24 @@ static llvm::StringRef getGCCToolchainDir(const ArgList &Args) {
   return GCC_INSTALL_PREFIX;
 }
 
+/// \brief Compute the key of a GCC installation detection in the
+/// GCCInstallationCache: everything other than the file system it depends on.
+static std::string
+getGCCInstallationCacheKey(const llvm::Triple &TargetTriple,
+                           const ArgList &Args, ArrayRef<std::string> Prefixes,
+                           ArrayRef<std::string> ExtraTripleAliases) {
+  std::string Key = TargetTriple.str();
+  for (const std::string &Prefix : Prefixes)
+    Key += "\tprefix=" + Prefix;
+  for (const std::string &Alias : ExtraTripleAliases)
+    Key += "\talias=" + Alias;
+  // The machine flags select the multilibs, which decide between candidates.
+  for (const Arg *A : Args)
+    if (A->getOption().matches(options::OPT_m_Group))
+      Key += "\t" + A->getAsString(Args);
+  return Key;
+}
+
 /// \brief Initialize a GCCInstallationDetector from the driver.
 ///
 /// This performs all of the autodetection and sets up the various paths.
@@ -1420,14 +1440,32 @@ void Generic_GCC::GCCInstallationDetector::init(
     }
   }
 
+  // Reuse the installation detected by an earlier invocation if none of the
+  // directories it looked at changed since.
+  std::unique_ptr<GCCInstallationCache> Cache;
+  std::string CacheKey;
+  StringRef CachePath = Args.getLastArgValue(options::OPT_gcc_install_cache_EQ);
+  if (!CachePath.empty() && TargetTriple.getOS() != llvm::Triple::Solaris) {
+    Cache.reset(new GCCInstallationCache(CachePath));
+    CacheKey = getGCCInstallationCacheKey(TargetTriple, Args, Prefixes,
+                                          ExtraTripleAliases);
+    if (const GCCInstallationCache::Installation *I =
+            Cache->lookup(CacheKey, D.getVFS()))
+      if (initFromCache(TargetTriple, Args, *I))
+        return;
+    RecordProbes = true;
+  }
+
   // Loop over the various components which exist and select the best GCC
   // installation available. GCC installs are ranked by version number.
   Version = GCCVersion::Parse("0.0.0");
   for (const std::string &Prefix : Prefixes) {
+    recordProbe(Prefix);
     if (!D.getVFS().exists(Prefix))
       continue;
     for (StringRef Suffix : CandidateLibDirs) {
       const std::string LibDir = Prefix + Suffix.str();
+      recordProbe(LibDir);
       if (!D.getVFS().exists(LibDir))
         continue;
       for (StringRef Candidate : ExtraTripleAliases) // Try these first.
@@ -1437,6 +1475,7 @@ void Generic_GCC::GCCInstallationDetector::init(
     }
     for (StringRef Suffix : CandidateBiarchLibDirs) {
       const std::string LibDir = Prefix + Suffix.str();
+      recordProbe(LibDir);
       if (!D.getVFS().exists(LibDir))
         continue;
       for (StringRef Candidate : CandidateBiarchTripleAliases)
@@ -1444,6 +1483,12 @@ void Generic_GCC::GCCInstallationDetector::init(
                                /*NeedsBiarchSuffix=*/ true);
     }
   }
+
+  GCCInstallationCache::Installation I;
+  if (Cache && !SawRejectedCandidate && getCacheEntry(I)) {
+    Cache->insert(CacheKey, std::move(I));
+    Cache->save(CachePath);
+  }
 }
 
 void Generic_GCC::GCCInstallationDetector::print(raw_ostream &OS) const {
@@ -2546,6 +2591,27 @@ void Generic_GCC::GCCInstallationDetector::scanLibDirForGCCTripleSolaris(
   }
 }
 
+/// \brief Detect the multilibs of the GCC installation in \p Path.
+static bool findGCCMultilibs(const Driver &D, const llvm::Triple &TargetTriple,
+                             StringRef Path, const ArgList &Args,
+                             bool NeedsBiarchSuffix,
+                             DetectedMultilibs &Detected) {
+  llvm::Triple::ArchType TargetArch = TargetTriple.getArch();
+
+  // Android standalone toolchain could have multilibs for ARM and Thumb.
+  // Debian mips multilibs behave more like the rest of the biarch ones,
+  // so handle them there
+  if (isArmOrThumbArch(TargetArch) && TargetTriple.isAndroid()) {
+    // It should also work without multilibs in a simplified toolchain.
+    findAndroidArmMultilibs(D, TargetTriple, Path, Args, Detected);
+    return true;
+  }
+  if (isMipsArch(TargetArch))
+    return findMIPSMultilibs(D, TargetTriple, Path, Args, Detected);
+  return findBiarchMultilibs(D, TargetTriple, Path, Args, NeedsBiarchSuffix,
+                             Detected);
+}
+
 void Generic_GCC::GCCInstallationDetector::ScanLibDirForGCCTriple(
     const llvm::Triple &TargetTriple, const ArgList &Args,
     const std::string &LibDir, StringRef CandidateTriple,
@@ -2586,6 +2652,7 @@ void Generic_GCC::GCCInstallationDetector::ScanLibDirForGCCTriple(
                                    (TargetArch != llvm::Triple::x86));
   for (unsigned i = 0; i < NumLibSuffixes; ++i) {
     StringRef LibSuffix = LibAndInstallSuffixes[i][0];
+    recordProbe(LibDir + LibSuffix.str());
     std::error_code EC;
     for (vfs::directory_iterator
              LI = D.getVFS().dir_begin(LibDir + LibSuffix, EC),
@@ -2602,18 +2669,9 @@ void Generic_GCC::GCCInstallationDetector::ScanLibDirForGCCTriple(
         continue;
 
       DetectedMultilibs Detected;
-
-      // Android standalone toolchain could have multilibs for ARM and Thumb.
-      // Debian mips multilibs behave more like the rest of the biarch ones,
-      // so handle them there
-      if (isArmOrThumbArch(TargetArch) && TargetTriple.isAndroid()) {
-        // It should also work without multilibs in a simplified toolchain.
-        findAndroidArmMultilibs(D, TargetTriple, LI->getName(), Args, Detected);
-      } else if (isMipsArch(TargetArch)) {
-        if (!findMIPSMultilibs(D, TargetTriple, LI->getName(), Args, Detected))
-          continue;
-      } else if (!findBiarchMultilibs(D, TargetTriple, LI->getName(), Args,
-                                      NeedsBiarchSuffix, Detected)) {
+      if (!findGCCMultilibs(D, TargetTriple, LI->getName(), Args,
+                            NeedsBiarchSuffix, Detected)) {
+        SawRejectedCandidate = true;
         continue;
       }
 
@@ -2628,11 +2686,73 @@ void Generic_GCC::GCCInstallationDetector::ScanLibDirForGCCTriple(
       GCCInstallPath =
           LibDir + LibAndInstallSuffixes[i][0] + "/" + VersionText.str();
       GCCParentLibPath = GCCInstallPath + LibAndInstallSuffixes[i][1];
+      SelectedNeedsBiarchSuffix = NeedsBiarchSuffix;
       IsValid = true;
     }
   }
 }
 
+bool Generic_GCC::GCCInstallationDetector::initFromCache(
+    const llvm::Triple &TargetTriple, const ArgList &Args,
+    const GCCInstallationCache::Installation &I) {
+  if (!I.InstallPath.empty()) {
+    DetectedMultilibs Detected;
+    if (!findGCCMultilibs(D, TargetTriple, I.InstallPath, Args,
+                          I.NeedsBiarchSuffix, Detected))
+      return false;
+
+    Multilibs = Detected.Multilibs;
+    SelectedMultilib = Detected.SelectedMultilib;
+    BiarchSibling = Detected.BiarchSibling;
+    Version = GCCVersion::Parse(I.Version);
+    GCCTriple.setTriple(I.Triple);
+    GCCInstallPath = I.InstallPath;
+    GCCParentLibPath = I.ParentLibPath;
+    SelectedNeedsBiarchSuffix = I.NeedsBiarchSuffix;
+    IsValid = true;
+  }
+  CandidateGCCInstallPaths.insert(I.CandidatePaths.begin(),
+                                  I.CandidatePaths.end());
+  return true;
+}
+
+bool Generic_GCC::GCCInstallationDetector::getCacheEntry(
+    GCCInstallationCache::Installation &I) const {
+  // A directory can change again within the resolution of its modification
+  // time; don't rely on modification times that recent.
+  const uint64_t Now = llvm::sys::TimeValue::now().toEpochTime();
+
+  // Whether a probed path exists, and what a directory contains, only change
+  // along with the modification time of the directory or of one of its
+  // ancestors.
+  llvm::StringSet<> Seen;
+  for (const std::string &Probed : ProbedPaths) {
+    for (StringRef Dir = Probed; !Dir.empty();
+         Dir = llvm::sys::path::parent_path(Dir)) {
+      if (!Seen.insert(Dir).second)
+        break; // Its ancestors have been looked at, too.
+      llvm::ErrorOr<vfs::Status> S = D.getVFS().status(Dir);
+      if (!S || !S->isDirectory())
+        continue;
+      uint64_t ModTime = S->getLastModificationTime().toEpochTime();
+      if (ModTime + 2 > Now)
+        return false;
+      I.Dirs.push_back(std::make_pair(Dir.str(), ModTime));
+    }
+  }
+
+  if (IsValid) {
+    I.Triple = GCCTriple.str();
+    I.Version = Version.Text;
+    I.InstallPath = GCCInstallPath;
+    I.ParentLibPath = GCCParentLibPath;
+    I.NeedsBiarchSuffix = SelectedNeedsBiarchSuffix;
+  }
+  I.CandidatePaths.assign(CandidateGCCInstallPaths.begin(),
+                          CandidateGCCInstallPaths.end());
+  return true;
+}
+
 Generic_GCC::Generic_GCC(const Driver &D, const llvm::Triple &Triple,
                          const ArgList &Args)
     : ToolChain(D, Triple, Args), GCCInstallation(D), CudaInstallation(D) {
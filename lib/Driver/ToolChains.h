@@ -10,6 +10,7 @@
 #ifndef LLVM_CLANG_LIB_DRIVER_TOOLCHAINS_H
 #define LLVM_CLANG_LIB_DRIVER_TOOLCHAINS_H
 
+#include "GCCInstallationCache.h"
 #include "Tools.h"
 #include "clang/Basic/Cuda.h"
 #include "clang/Basic/VersionTuple.h"
@@ -101,6 +102,18 @@ public:
     /// The set of multilibs that the detected installation supports.
     MultilibSet Multilibs;
 
+    /// When the detection is to be cached, the paths it probed.
+    bool RecordProbes = false;
+    std::vector<std::string> ProbedPaths;
+
+    /// Whether the selected installation was found in a biarch library
+    /// directory.
+    bool SelectedNeedsBiarchSuffix = false;
+
+    /// Whether a candidate newer than the selected one was rejected because
+    /// it has no suitable multilibs; such detections are not cached.
+    bool SawRejectedCandidate = false;
+
   public:
     explicit GCCInstallationDetector(const Driver &D) : IsValid(false), D(D) {}
     void init(const llvm::Triple &TargetTriple, const llvm::opt::ArgList &Args,
@@ -154,6 +167,24 @@ public:
                                        const std::string &LibDir,
                                        StringRef CandidateTriple,
                                        bool NeedsBiarchSuffix = false);
+
+    void recordProbe(StringRef Path) {
+      if (RecordProbes)
+        ProbedPaths.push_back(Path);
+    }
+
+    /// \brief Initialize from an installation detected earlier, detecting
+    /// its multilibs again.
+    ///
+    /// \returns false if the installation no longer has suitable multilibs.
+    bool initFromCache(const llvm::Triple &TargetTriple,
+                       const llvm::opt::ArgList &Args,
+                       const GCCInstallationCache::Installation &I);
+
+    /// \brief Record the detected installation in \p I, unless the
+    /// directories it depended on changed too recently to be validated by
+    /// their modification times.
+    bool getCacheEntry(GCCInstallationCache::Installation &I) const;
   };
 
 protected:
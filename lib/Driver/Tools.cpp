@@ -3558,10 +3558,19 @@ static void addPGOAndCoverageFlags(Compilation &C, const Driver &D,
       ProfileUseArg->getOption().matches(options::OPT_fno_profile_instr_use))
     ProfileUseArg = nullptr;
 
+  auto *ProfileShardDirArg =
+      Args.getLastArg(options::OPT_fprofile_instr_use_shard_dir_EQ);
+
   if (PGOGenerateArg && ProfileUseArg)
     D.Diag(diag::err_drv_argument_not_allowed_with)
         << ProfileUseArg->getSpelling() << PGOGenerateArg->getSpelling();
 
+  if (ProfileShardDirArg && (PGOGenerateArg || ProfileGenerateArg))
+    D.Diag(diag::err_drv_argument_not_allowed_with)
+        << ProfileShardDirArg->getSpelling()
+        << (PGOGenerateArg ? PGOGenerateArg : ProfileGenerateArg)
+               ->getSpelling();
+
   if (ProfileGenerateArg && ProfileUseArg)
     D.Diag(diag::err_drv_argument_not_allowed_with)
         << ProfileGenerateArg->getSpelling() << ProfileUseArg->getSpelling();
@@ -3603,6 +3612,16 @@ static void addPGOAndCoverageFlags(Compilation &C, const Driver &D,
     }
   }
 
+  if (ProfileShardDirArg)
+    CmdArgs.push_back(
+        Args.MakeArgString(Twine("-fprofile-instrument-use-shard-dir=") +
+                           ProfileShardDirArg->getValue()));
+
+  if (Args.hasFlag(options::OPT_fprofile_hot_cold_sections,
+                   options::OPT_fno_profile_hot_cold_sections, false))
+    CmdArgs.push_back("-fprofile-hot-cold-sections");
+  Args.AddLastArg(CmdArgs, options::OPT_fprofile_function_order_EQ);
+
   if (Args.hasArg(options::OPT_ftest_coverage) ||
       Args.hasArg(options::OPT_coverage))
     CmdArgs.push_back("-femit-coverage-notes");
@@ -4914,6 +4933,8 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     CmdArgs.push_back(A->getValue());
   }
 
+  Args.AddLastArg(CmdArgs, options::OPT_fexperimental_constexpr_interpreter);
+
   if (Arg *A = Args.getLastArg(options::OPT_fbracket_depth_EQ)) {
     CmdArgs.push_back("-fbracket-depth");
     CmdArgs.push_back(A->getValue());
@@ -5086,6 +5107,11 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_print_source_range_info);
   Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_parseable_fixits);
   Args.AddLastArg(CmdArgs, options::OPT_ftime_report);
+  Args.AddLastArg(CmdArgs, options::OPT_ftime_trace_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_fcompile_time_budget_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_fcompile_time_budget_report_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_fcompile_time_budget_abort);
+  Args.AddLastArg(CmdArgs, options::OPT_index_store_path);
   Args.AddLastArg(CmdArgs, options::OPT_ftrapv);
 
   if (Arg *A = Args.getLastArg(options::OPT_ftrapv_handler_EQ)) {
@@ -5363,6 +5389,7 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   // -fmodule-map-file can be used to specify files containing module
   // definitions.
   Args.AddAllArgs(CmdArgs, options::OPT_fmodule_map_file);
+  Args.AddLastArg(CmdArgs, options::OPT_fmodule_map_cache_EQ);
 
   // -fmodule-file can be used to specify files containing precompiled modules.
   if (HaveModules)
@@ -5386,10 +5413,16 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   if (HaveModules)
     Args.AddLastArg(CmdArgs, options::OPT_fmodules_user_build_path);
 
+  Args.AddLastArg(CmdArgs, options::OPT_finclude_guard_cache_EQ);
+  if (Args.hasFlag(options::OPT_fheader_search_directory_cache,
+                   options::OPT_fno_header_search_directory_cache, false))
+    CmdArgs.push_back("-fheader-search-directory-cache");
+
   // Pass through all -fmodules-ignore-macro arguments.
   Args.AddAllArgs(CmdArgs, options::OPT_fmodules_ignore_macro);
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_prune_interval);
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_prune_after);
+  Args.AddLastArg(CmdArgs, options::OPT_fmodules_cache_max_size);
 
   Args.AddLastArg(CmdArgs, options::OPT_fbuild_session_timestamp);
 
@@ -5416,6 +5449,7 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   }
 
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_validate_system_headers);
+  Args.AddLastArg(CmdArgs, options::OPT_fvalidate_ast_input_files_content);
 
   // -faccess-control is default.
   if (Args.hasFlag(options::OPT_fno_access_control,
@@ -5537,6 +5571,10 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                    options::OPT_fno_delayed_template_parsing, IsWindowsMSVC))
     CmdArgs.push_back("-fdelayed-template-parsing");
 
+  if (Args.hasFlag(options::OPT_flazy_inline_method_parsing,
+                   options::OPT_fno_lazy_inline_method_parsing, false))
+    CmdArgs.push_back("-flazy-inline-method-parsing");
+
   // -fgnu-keywords default varies depending on language; only pass if
   // specified.
   if (Arg *A = Args.getLastArg(options::OPT_fgnu_keywords,
@@ -5919,8 +5957,12 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   // TODO: Once -module-dependency-dir works with -frewrite-includes it'd be
   // nice to enable this when doing a crashdump for modules as well.
   if (Args.hasFlag(options::OPT_frewrite_includes,
-                   options::OPT_fno_rewrite_includes, false) ||
-      (C.isForDiagnostics() && !HaveModules))
+                   options::OPT_fno_rewrite_includes, false)) {
+    CmdArgs.push_back("-frewrite-includes");
+    if (Args.hasFlag(options::OPT_fminimize_rewritten_includes,
+                     options::OPT_fno_minimize_rewritten_includes, false))
+      CmdArgs.push_back("-fminimize-rewritten-includes");
+  } else if (C.isForDiagnostics() && !HaveModules)
     CmdArgs.push_back("-frewrite-includes");
 
   // Only allow -traditional or -traditional-cpp outside in preprocessing modes.
@@ -6066,6 +6108,10 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     // fails, so that the main compilation's fallback to cl.exe runs.
     C.addCommand(llvm::make_unique<ForceSuccessCommand>(JA, *this, Exec,
                                                         CmdArgs, Inputs));
+  } else if (Args.hasFlag(options::OPT_fintegrated_cc1,
+                          options::OPT_fno_integrated_cc1, false)) {
+    C.addCommand(
+        llvm::make_unique<CC1Command>(JA, *this, Exec, CmdArgs, Inputs));
   } else {
     C.addCommand(llvm::make_unique<Command>(JA, *this, Exec, CmdArgs, Inputs));
   }
@@ -109,19 +109,33 @@ bool EditedSource::commitInsert(SourceLocation OrigLoc,
   }
   
   FileEdit &FA = FileEdits[Offs];
-  if (FA.Text.empty()) {
-    FA.Text = copyString(text);
+  if (beforePreviousInsertions && !FA.Text.empty()) {
+    FA.Text = copyString(Twine(text) + FA.Text);
+    FA.TextCapacity = FA.Text.size();
     return true;
   }
 
-  if (beforePreviousInsertions)
-    FA.Text = copyString(Twine(text) + FA.Text);
-  else
-    FA.Text = copyString(Twine(FA.Text) + text);
-
+  appendText(FA, text);
   return true;
 }
 
+void EditedSource::appendText(FileEdit &FA, StringRef text) {
+  size_t NewSize = FA.Text.size() + text.size();
+  if (NewSize > FA.TextCapacity) {
+    // Grow the buffer geometrically, so that many insertions at the same
+    // offset do not copy the text inserted so far over and over.
+    size_t NewCapacity = std::max(NewSize, 2 * size_t(FA.TextCapacity));
+    char *Buf = StrAlloc.Allocate<char>(NewCapacity);
+    std::copy(FA.Text.begin(), FA.Text.end(), Buf);
+    FA.Text = StringRef(Buf, FA.Text.size());
+    FA.TextCapacity = NewCapacity;
+  }
+
+  char *Buf = const_cast<char *>(FA.Text.data());
+  std::copy(text.begin(), text.end(), Buf + FA.Text.size());
+  FA.Text = StringRef(Buf, NewSize);
+}
+
 bool EditedSource::commitInsertFromRange(SourceLocation OrigLoc,
                                    FileOffset Offs,
                                    FileOffset InsertFromRangeOffs, unsigned Len,
@@ -228,8 +242,10 @@ void EditedSource::commitRemove(SourceLocation OrigLoc,
     unsigned diff = EndOffs.getOffset() - TopEnd.getOffset();
     TopEnd = EndOffs;
     TopFA->RemoveLen += diff;
-    if (B == BeginOffs)
+    if (B == BeginOffs) {
       TopFA->Text = StringRef();
+      TopFA->TextCapacity = 0;
+    }
     ++I;
   }
 
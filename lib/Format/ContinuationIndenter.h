@@ -19,6 +19,7 @@
 #include "Encoding.h"
 #include "FormatToken.h"
 #include "clang/Format/Format.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/Support/Regex.h"
 
 namespace clang {
@@ -71,6 +72,15 @@ public:
   /// limit, potentially reduced for preprocessor definitions.
   unsigned getColumnLimit(const LineState &State) const;
 
+  const SourceManager &getSourceManager() const { return SourceMgr; }
+
+  /// \brief Returns whether, since the last \c resetReadTokenText(), the
+  /// text of a comment or string literal or the original source columns of a
+  /// token have influenced the result, rather than just the annotations of the
+  /// tokens.
+  bool hasReadTokenText() const { return ReadTokenText; }
+  void resetReadTokenText() { ReadTokenText = false; }
+
 private:
   /// \brief Mark the next token as consumed in \p State and modify its stacks
   /// accordingly.
@@ -143,6 +153,7 @@ private:
   encoding::Encoding Encoding;
   bool BinPackInconclusiveFunctions;
   llvm::Regex CommentPragmasRegex;
+  bool ReadTokenText;
 };
 
 struct ParenState {
@@ -304,6 +315,19 @@ struct ParenState {
   }
 };
 
+/// \brief Hash the members of \p State compared by \c ParenState::operator<.
+inline llvm::hash_code hash_value(const ParenState &State) {
+  return llvm::hash_combine(
+      llvm::hash_combine(State.Indent, State.LastSpace, State.NestedBlockIndent,
+                         State.FirstLessLess, State.BreakBeforeClosingBrace,
+                         State.QuestionColumn, State.AvoidBinPacking,
+                         State.BreakBeforeParameter, State.NoLineBreak,
+                         State.LastOperatorWrapped),
+      State.ColonPos, State.StartOfFunctionCall, State.StartOfArraySubscripts,
+      State.CallContinuation, State.VariablePos, State.ContainsLineBreak,
+      State.ContainsUnwrappedBuilder, State.NestedBlockInlined);
+}
+
 /// \brief The current state when indenting a unwrapped line.
 ///
 /// As the indenting tries different combinations this is copied by value.
@@ -375,6 +399,21 @@ struct LineState {
   }
 };
 
+/// \brief Hash the members of \p State compared by \c LineState::operator<.
+///
+/// States that are equivalent according to \c operator< and agree on
+/// \c IgnoreStackForComparison hash to the same value.
+inline llvm::hash_code hash_value(const LineState &State) {
+  llvm::hash_code Hash = llvm::hash_combine(
+      State.NextToken, State.Column, State.LineContainsContinuedForLoopSection,
+      State.StartOfLineLevel, State.LowestLevelOnLine,
+      State.StartOfStringLiteral);
+  if (State.IgnoreStackForComparison)
+    return Hash;
+  return llvm::hash_combine(
+      Hash, llvm::hash_combine_range(State.Stack.begin(), State.Stack.end()));
+}
+
 } // end namespace format
 } // end namespace clang
 
@@ -23,17 +23,21 @@
 #include "UnwrappedLineFormatter.h"
 #include "UnwrappedLineParser.h"
 #include "WhitespaceManager.h"
+#include "clang/Basic/CharInfo.h"
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/DiagnosticOptions.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/VirtualFileSystem.h"
 #include "clang/Lex/Lexer.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Regex.h"
 #include "llvm/Support/YAMLTraits.h"
+#include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <memory>
 #include <queue>
@@ -321,6 +325,7 @@ template <> struct MappingTraits<FormatStyle> {
     IO.mapOptional("MacroBlockBegin", Style.MacroBlockBegin);
     IO.mapOptional("MacroBlockEnd", Style.MacroBlockEnd);
     IO.mapOptional("MaxEmptyLinesToKeep", Style.MaxEmptyLinesToKeep);
+    IO.mapOptional("MaxLineFormattingStates", Style.MaxLineFormattingStates);
     IO.mapOptional("NamespaceIndentation", Style.NamespaceIndentation);
     IO.mapOptional("ObjCBlockIndentWidth", Style.ObjCBlockIndentWidth);
     IO.mapOptional("ObjCSpaceAfterProperty", Style.ObjCSpaceAfterProperty);
@@ -536,6 +541,7 @@ FormatStyle getLLVMStyle() {
   LLVMStyle.JavaScriptWrapImports = true;
   LLVMStyle.TabWidth = 8;
   LLVMStyle.MaxEmptyLinesToKeep = 1;
+  LLVMStyle.MaxLineFormattingStates = 200000;
   LLVMStyle.KeepEmptyLinesAtTheStartOfBlocks = true;
   LLVMStyle.NamespaceIndentation = FormatStyle::NI_None;
   LLVMStyle.ObjCBlockIndentWidth = 2;
@@ -791,17 +797,57 @@ std::string configurationAsText(const FormatStyle &Style) {
 
 namespace {
 
+// The state a FormattingSession passes into and gets out of a Formatter.
+struct SessionState {
+  SessionState(unsigned Scope, unsigned *NextScope)
+      : Scope(Scope), NextScope(NextScope), StyleDerived(false),
+        BinPackInconclusiveFunctions(false), Collected(false),
+        Balanced(true) {}
+
+  // The scope of the top-level lines of the formatted code.
+  unsigned Scope;
+  // The next scope that has not been handed out yet.
+  unsigned *NextScope;
+  // If true, the local style has already been derived and the formatter uses
+  // its style and BinPackInconclusiveFunctions as is; otherwise they are set
+  // to what was derived from the code.
+  bool StyleDerived;
+  FormatStyle DerivedStyle;
+  bool BinPackInconclusiveFunctions;
+
+  // The split points of the formatted code, collected from the first run.
+  std::vector<FormattingSession::SplitPoint> SplitPoints;
+  bool Collected;
+  // False if the braces, preprocessor conditionals or comments of the
+  // formatted code are unbalanced, so that it may affect the code after it.
+  bool Balanced;
+};
+
 class Formatter : public TokenAnalyzer {
 public:
   Formatter(const Environment &Env, const FormatStyle &Style,
-            bool *IncompleteFormat)
-      : TokenAnalyzer(Env, Style), IncompleteFormat(IncompleteFormat) {}
+            bool *IncompleteFormat, SessionState *Session = nullptr)
+      : TokenAnalyzer(Env, Style), IncompleteFormat(IncompleteFormat),
+        Session(Session) {}
 
   tooling::Replacements
   analyze(TokenAnnotator &Annotator,
           SmallVectorImpl<AnnotatedLine *> &AnnotatedLines,
           FormatTokenLexer &Tokens, tooling::Replacements &Result) override {
-    deriveLocalStyle(AnnotatedLines);
+    if (Session && Session->StyleDerived) {
+      BinPackInconclusiveFunctions = Session->BinPackInconclusiveFunctions;
+    } else {
+      deriveLocalStyle(AnnotatedLines);
+      if (Session) {
+        Session->StyleDerived = true;
+        Session->DerivedStyle = Style;
+        Session->BinPackInconclusiveFunctions = BinPackInconclusiveFunctions;
+      }
+    }
+    if (Session && !Session->Collected) {
+      collectSplitPoints(AnnotatedLines);
+      Session->Collected = true;
+    }
     AffectedRangeMgr.computeAffectedLines(AnnotatedLines.begin(),
                                           AnnotatedLines.end());
 
@@ -828,6 +874,62 @@ public:
   }
 
 private:
+  // Records the top-level lines that start a piece of code which can be
+  // formatted independently of what precedes it: lines at nesting level 0
+  // that start in column 0 after an empty line (which also ends alignment
+  // sequences), outside of preprocessor directives and conditionals.
+  void collectSplitPoints(const SmallVectorImpl<AnnotatedLine *> &Lines) {
+    const SourceManager &SM = Env.getSourceManager();
+    SmallVector<unsigned, 8> Scopes;
+    int PPConditionalDepth = 0;
+    for (const AnnotatedLine *Line : Lines) {
+      const FormatToken *First = Line->First;
+      if (First->is(tok::eof))
+        break;
+      const FormatToken *Last = Line->Last;
+      if (Last->is(tok::comment) && Last->TokenText.startswith("/*") &&
+          (Last->TokenText.size() < 4 || !Last->TokenText.endswith("*/")))
+        Session->Balanced = false;
+      if (Line->InPPDirective) {
+        const FormatToken *Directive = First->Next;
+        if (First->is(tok::hash) && Directive &&
+            Directive->Tok.getIdentifierInfo()) {
+          switch (Directive->Tok.getIdentifierInfo()->getPPKeywordID()) {
+          case tok::pp_if:
+          case tok::pp_ifdef:
+          case tok::pp_ifndef:
+            ++PPConditionalDepth;
+            break;
+          case tok::pp_endif:
+            --PPConditionalDepth;
+            break;
+          default:
+            break;
+          }
+        }
+        continue;
+      }
+      if (Line->Level != 0)
+        continue;
+      if (First->is(tok::r_brace)) {
+        if (Scopes.empty())
+          Session->Balanced = false;
+        else
+          Scopes.pop_back();
+      } else if (PPConditionalDepth == 0 && First->OriginalColumn == 0 &&
+                 (First->IsFirst || First->NewlinesBefore > 1)) {
+        FormattingSession::SplitPoint Point;
+        Point.Offset = SM.getFileOffset(First->Tok.getLocation());
+        Point.Scope = Scopes.empty() ? Session->Scope : Scopes.back();
+        Session->SplitPoints.push_back(Point);
+      }
+      if (Last->is(tok::l_brace))
+        Scopes.push_back((*Session->NextScope)++);
+    }
+    if (!Scopes.empty() || PPConditionalDepth != 0)
+      Session->Balanced = false;
+  }
+
   // If the last token is a double/single-quoted string literal, generates a
   // replacement with a single/double quoted string literal, re-escaping the
   // contents in the process.
@@ -977,6 +1079,7 @@ private:
 
   bool BinPackInconclusiveFunctions;
   bool *IncompleteFormat;
+  SessionState *Session;
 };
 
 // This class clean up the erroneous/redundant code around the given ranges in
@@ -1270,8 +1373,10 @@ public:
   IncludeCategoryManager(const FormatStyle &Style, StringRef FileName)
       : Style(Style), FileName(FileName) {
     FileStem = llvm::sys::path::stem(FileName);
-    for (const auto &Category : Style.IncludeCategories)
+    for (const auto &Category : Style.IncludeCategories) {
       CategoryRegexs.emplace_back(Category.Regex);
+      CategoryPrefixes.push_back(getLiteralPrefix(Category.Regex));
+    }
     IsMainFile = FileName.endswith(".c") || FileName.endswith(".cc") ||
                  FileName.endswith(".cpp") || FileName.endswith(".c++") ||
                  FileName.endswith(".cxx") || FileName.endswith(".m") ||
@@ -1282,18 +1387,57 @@ public:
   // If \p CheckMainHeader is true and \p IncludeName is a main header, returns
   // 0. Otherwise, returns the priority of the matching category or INT_MAX.
   int getIncludePriority(StringRef IncludeName, bool CheckMainHeader) {
-    int Ret = INT_MAX;
-    for (unsigned i = 0, e = CategoryRegexs.size(); i != e; ++i)
-      if (CategoryRegexs[i].match(IncludeName)) {
-        Ret = Style.IncludeCategories[i].Priority;
-        break;
-      }
+    auto Cached = Priorities.insert(std::make_pair(IncludeName, INT_MAX));
+    int &Ret = Cached.first->second;
+    if (Cached.second) {
+      for (unsigned i = 0, e = CategoryRegexs.size(); i != e; ++i)
+        if (IncludeName.startswith(CategoryPrefixes[i]) &&
+            CategoryRegexs[i].match(IncludeName)) {
+          Ret = Style.IncludeCategories[i].Priority;
+          break;
+        }
+    }
     if (CheckMainHeader && IsMainFile && Ret > 0 && isMainHeader(IncludeName))
-      Ret = 0;
+      return 0;
     return Ret;
   }
 
 private:
+  // Returns the literal text every string matched by the POSIX regular
+  // expression \p Regex starts with, so that most names can be rejected
+  // without running the regular expression.
+  static std::string getLiteralPrefix(StringRef Regex) {
+    if (!Regex.startswith("^"))
+      return "";
+    // A top-level alternative might not be anchored.
+    int Depth = 0;
+    for (unsigned i = 0, e = Regex.size(); i < e; ++i) {
+      if (Regex[i] == '\\')
+        ++i;
+      else if (Regex[i] == '[')
+        i = std::min(Regex.find(']', i + 2), Regex.size() - 1);
+      else if (Regex[i] == '(')
+        ++Depth;
+      else if (Regex[i] == ')')
+        --Depth;
+      else if (Regex[i] == '|' && Depth == 0)
+        return "";
+    }
+    std::string Prefix;
+    for (unsigned i = 1, e = Regex.size(); i < e; ++i) {
+      char C = Regex[i];
+      if (C == '\\' && i + 1 < e && !isAlphanumeric(Regex[i + 1]))
+        C = Regex[++i];
+      else if (StringRef(".[]()*+?{}|^$\\").count(C))
+        break;
+      // A quantifier may make the last character optional.
+      if (i + 1 < e && StringRef("*?{").count(Regex[i + 1]))
+        break;
+      Prefix += C;
+    }
+    return Prefix;
+  }
+
   bool isMainHeader(StringRef IncludeName) const {
     if (!IncludeName.startswith("\""))
       return false;
@@ -1313,11 +1457,20 @@ private:
   StringRef FileName;
   StringRef FileStem;
   SmallVector<llvm::Regex, 4> CategoryRegexs;
+  SmallVector<std::string, 4> CategoryPrefixes;
+  // The category priorities of the include names seen so far.
+  llvm::StringMap<int> Priorities;
 };
 
 const char IncludeRegexPattern[] =
     R"(^[\t\ ]*#[\t\ ]*(import|include)[^"<]*(["<][^">]*[">]))";
 
+// Returns whether \p Line can match IncludeRegexPattern, which is much cheaper
+// to check than the regular expression itself.
+bool mayBeIncludeLine(StringRef Line) {
+  return Line.ltrim(" \t").startswith("#");
+}
+
 } // anonymous namespace
 
 tooling::Replacements sortCppIncludes(const FormatStyle &Style, StringRef Code,
@@ -1355,7 +1508,7 @@ tooling::Replacements sortCppIncludes(const FormatStyle &Style, StringRef Code,
       FormattingOff = false;
 
     if (!FormattingOff && !Line.endswith("\\")) {
-      if (IncludeRegex.match(Line, &Matches)) {
+      if (mayBeIncludeLine(Line) && IncludeRegex.match(Line, &Matches)) {
         StringRef IncludeName = Matches[2];
         int Category = Categories.getIncludePriority(
             IncludeName,
@@ -1539,7 +1692,7 @@ fixCppIncludeInsertions(StringRef Code, const tooling::Replacements &Replaces,
   std::set<StringRef> ExistingIncludes;
   for (auto Line : Lines) {
     NextLineOffset = std::min(Code.size(), Offset + Line.size() + 1);
-    if (IncludeRegex.match(Line, &Matches)) {
+    if (mayBeIncludeLine(Line) && IncludeRegex.match(Line, &Matches)) {
       StringRef IncludeName = Matches[2];
       ExistingIncludes.insert(IncludeName);
       int Category = Categories.getIncludePriority(
@@ -1636,6 +1789,341 @@ tooling::Replacements reformat(const FormatStyle &Style, StringRef Code,
   return Format.process();
 }
 
+// Returns the start of the whitespace preceding \p Offset in \p Code.
+static unsigned skipWhitespaceBackwards(StringRef Code, unsigned Offset) {
+  while (Offset > 0 && isWhitespace(Code[Offset - 1]))
+    --Offset;
+  return Offset;
+}
+
+// Returns whether a line starting at \p Offset in \p Code can still start a
+// piece of code, i.e. starts in column 0 after an empty line.
+static bool isSplitPoint(StringRef Code, unsigned Offset) {
+  if (Offset == 0)
+    return true;
+  if (Offset >= Code.size() || isWhitespace(Code[Offset]) ||
+      Code[Offset - 1] != '\n')
+    return false;
+  StringRef Whitespace =
+      Code.slice(skipWhitespaceBackwards(Code, Offset), Offset);
+  return Whitespace.count('\n') > 1;
+}
+
+FormattingSession::FormattingSession(const FormatStyle &Style, StringRef Code,
+                                     StringRef FileName)
+    : Style(expandPresets(Style)), FileName(FileName), Code(Code),
+      BinPackInconclusiveFunctions(false), NextScope(1), HasDamage(false),
+      DamageBegin(0), DamageEnd(0) {
+  if (this->Style.DisableFormat)
+    return;
+
+  // Parse the whole file once to derive the local style and find the split
+  // points; no ranges are given, so nothing is formatted.
+  std::unique_ptr<Environment> Env = Environment::CreateVirtualEnvironment(
+      Code, FileName, ArrayRef<tooling::Range>());
+  SessionState State(/*Scope=*/0, &NextScope);
+  Formatter(*Env, this->Style, /*IncompleteFormat=*/nullptr, &State).process();
+  if (State.StyleDerived) {
+    this->Style = State.DerivedStyle;
+    this->Style.DerivePointerAlignment = false;
+    BinPackInconclusiveFunctions = State.BinPackInconclusiveFunctions;
+  }
+  SplitPoints = std::move(State.SplitPoints);
+}
+
+void FormattingSession::applyEdit(unsigned Offset, unsigned Length,
+                                  StringRef Text) {
+  assert(Offset + Length <= Code.size() && "Edit out of range");
+  Code.replace(Offset, Length, Text);
+  unsigned EditEnd = Offset + Text.size();
+  auto Shift = [&](unsigned Position) -> unsigned {
+    if (Position >= Offset + Length)
+      return Position + Text.size() - Length;
+    return std::min(Position, Offset);
+  };
+
+  if (HasDamage) {
+    DamageBegin = std::min(Shift(DamageBegin), Offset);
+    DamageEnd = std::max(Shift(DamageEnd), EditEnd);
+  } else {
+    HasDamage = true;
+    DamageBegin = Offset;
+    DamageEnd = EditEnd;
+  }
+
+  // Split points in the replaced code are gone, and the ones right after it
+  // may have lost their empty line.
+  std::vector<SplitPoint> Points;
+  for (SplitPoint Point : SplitPoints) {
+    if (Point.Offset >= Offset && Point.Offset < Offset + Length)
+      continue;
+    Point.Offset = Shift(Point.Offset);
+    if (Point.Offset >= Offset && !isSplitPoint(Code, Point.Offset))
+      continue;
+    Points.push_back(Point);
+  }
+  SplitPoints = std::move(Points);
+}
+
+tooling::Replacements
+FormattingSession::reformat(ArrayRef<tooling::Range> Ranges,
+                            bool *IncompleteFormat) {
+  if (Style.DisableFormat)
+    return tooling::Replacements();
+
+  unsigned Begin = HasDamage ? DamageBegin : Code.size();
+  unsigned End = HasDamage ? DamageEnd : 0;
+  for (const tooling::Range &Range : Ranges) {
+    Begin = std::min(Begin, Range.getOffset());
+    End = std::max(End, Range.getOffset() + Range.getLength());
+  }
+  HasDamage = false;
+  if (Ranges.empty() && Begin > End)
+    return tooling::Replacements();
+
+  // The piece starts at the last split point before the code of interest and
+  // ends before the whitespace preceding the first split point of the same
+  // scope after it. Starting or ending at the whitespace would let the
+  // formatter treat it as the start or end of the file.
+  auto Next = std::lower_bound(
+      SplitPoints.begin(), SplitPoints.end(), Begin,
+      [](const SplitPoint &Point, unsigned Offset) {
+        return Point.Offset < Offset;
+      });
+  unsigned Start = 0;
+  unsigned Scope = 0;
+  if (Next != SplitPoints.begin()) {
+    Start = std::prev(Next)->Offset;
+    Scope = std::prev(Next)->Scope;
+  }
+  unsigned PieceEnd = Code.size();
+  bool FoundEnd = false;
+  for (auto I = Next, E = SplitPoints.end(); I != E; ++I) {
+    unsigned WhitespaceStart = skipWhitespaceBackwards(Code, I->Offset);
+    if (I->Scope == Scope && WhitespaceStart > End) {
+      PieceEnd = WhitespaceStart;
+      FoundEnd = true;
+      break;
+    }
+  }
+  if (!FoundEnd && Scope != 0) {
+    Start = 0;
+    Scope = 0;
+  }
+  return reformatPiece(Start, PieceEnd, Scope, Ranges, IncompleteFormat);
+}
+
+tooling::Replacements
+FormattingSession::reformatPiece(unsigned Start, unsigned End, unsigned Scope,
+                                 ArrayRef<tooling::Range> Ranges,
+                                 bool *IncompleteFormat) {
+  StringRef Piece = StringRef(Code).slice(Start, End);
+  std::vector<tooling::Range> PieceRanges;
+  for (const tooling::Range &Range : Ranges) {
+    unsigned RangeStart = std::max(Range.getOffset(), Start);
+    unsigned RangeEnd = std::min(Range.getOffset() + Range.getLength(), End);
+    if (RangeStart <= RangeEnd)
+      PieceRanges.push_back(
+          tooling::Range(RangeStart - Start, RangeEnd - RangeStart));
+  }
+
+  std::unique_ptr<Environment> Env =
+      Environment::CreateVirtualEnvironment(Piece, FileName, PieceRanges);
+  SessionState State(Scope, &NextScope);
+  State.StyleDerived = true;
+  State.BinPackInconclusiveFunctions = BinPackInconclusiveFunctions;
+  tooling::Replacements PieceReplaces =
+      Formatter(*Env, Style, IncompleteFormat, &State).process();
+  bool IsWholeFile = Start == 0 && End == Code.size();
+  if (!State.Balanced && !IsWholeFile)
+    return reformatPiece(0, Code.size(), /*Scope=*/0, Ranges,
+                         IncompleteFormat);
+
+  llvm::Expected<std::string> Formatted =
+      tooling::applyAllReplacements(Piece, PieceReplaces);
+  if (!Formatted) {
+    llvm::consumeError(Formatted.takeError());
+    return tooling::Replacements();
+  }
+
+  tooling::Replacements Result;
+  for (const tooling::Replacement &Replace : PieceReplaces)
+    Result.insert(tooling::Replacement(FileName, Start + Replace.getOffset(),
+                                       Replace.getLength(),
+                                       Replace.getReplacementText()));
+
+  // Replace the split points of the piece with the ones just collected.
+  std::vector<SplitPoint> Points;
+  for (const SplitPoint &Point : SplitPoints) {
+    if (Point.Offset >= Start)
+      break;
+    Points.push_back(Point);
+  }
+  for (SplitPoint Point : State.SplitPoints) {
+    Point.Offset =
+        Start + tooling::shiftedCodePosition(PieceReplaces, Point.Offset);
+    Points.push_back(Point);
+  }
+  unsigned Delta = Formatted->size() - Piece.size();
+  for (SplitPoint Point : SplitPoints) {
+    if (Point.Offset < End)
+      continue;
+    Point.Offset += Delta;
+    Points.push_back(Point);
+  }
+  Code.replace(Start, End - Start, *Formatted);
+  // Formatting may have removed empty lines.
+  Points.erase(std::remove_if(Points.begin(), Points.end(),
+                              [&](const SplitPoint &Point) {
+                                return !isSplitPoint(Code, Point.Offset);
+                              }),
+               Points.end());
+  SplitPoints = std::move(Points);
+  return Result;
+}
+
+// Maps \p Position in the code after applying \p Replaces back to the code
+// before. \p Position must not be inside replaced text.
+static unsigned unshiftedCodePosition(const tooling::Replacements &Replaces,
+                                      unsigned Position) {
+  int Delta = 0;
+  for (const tooling::Replacement &Replace : Replaces) {
+    if (Replace.getOffset() + Delta >= Position)
+      break;
+    Delta += Replace.getReplacementText().size() - Replace.getLength();
+  }
+  return Position - Delta;
+}
+
+void reformatInChunks(const FormatStyle &Style, StringRef Code,
+                      raw_ostream &OS, StringRef FileName,
+                      bool *IncompleteFormat, unsigned ChunkSize) {
+  FormatStyle Expanded = expandPresets(Style);
+  if (Expanded.DisableFormat) {
+    OS << Code;
+    return;
+  }
+
+  bool StyleDerived = false;
+  bool BinPackInconclusiveFunctions = false;
+  unsigned NextScope = 1;
+  size_t Start = 0;
+  size_t Size = std::max(ChunkSize, 1u);
+  while (Start < Code.size()) {
+    StringRef Chunk = Code.substr(Start, Size);
+    bool IsLast = Start + Chunk.size() == Code.size();
+
+    // Includes are sorted first, as clang-format does for whole files.
+    // Include blocks never contain a split point, so the code after the
+    // chunk's piece is unaffected.
+    tooling::Replacements Includes = sortIncludes(
+        Expanded, Chunk, tooling::Range(0, Chunk.size()), FileName);
+    std::string Sorted = Chunk;
+    if (!Includes.empty()) {
+      llvm::Expected<std::string> Result =
+          tooling::applyAllReplacements(Chunk, Includes);
+      if (Result) {
+        Sorted = std::move(*Result);
+      } else {
+        llvm::consumeError(Result.takeError());
+        Includes.clear();
+      }
+    }
+
+    std::unique_ptr<Environment> Env = Environment::CreateVirtualEnvironment(
+        Sorted, FileName, tooling::Range(0, Sorted.size()));
+    SessionState State(/*Scope=*/0, &NextScope);
+    State.StyleDerived = StyleDerived;
+    State.BinPackInconclusiveFunctions = BinPackInconclusiveFunctions;
+    tooling::Replacements Replaces =
+        Formatter(*Env, Expanded, IncompleteFormat, &State).process();
+    if (!StyleDerived && State.StyleDerived) {
+      Expanded = State.DerivedStyle;
+      Expanded.DerivePointerAlignment = false;
+      BinPackInconclusiveFunctions = State.BinPackInconclusiveFunctions;
+      StyleDerived = true;
+    }
+
+    // Unless this is the last chunk, only the code before the last top-level
+    // split point is written; the line at the split point may have been cut
+    // off by the end of the chunk, so it must be followed by a newline.
+    unsigned PieceEnd = Sorted.size();
+    unsigned SplitOffset = 0;
+    if (!IsLast) {
+      for (const FormattingSession::SplitPoint &Point : State.SplitPoints)
+        if (Point.Scope == 0 && Point.Offset > 0 &&
+            StringRef(Sorted).find('\n', Point.Offset) != StringRef::npos)
+          SplitOffset = Point.Offset;
+      if (SplitOffset == 0) {
+        Size *= 2;
+        continue;
+      }
+      PieceEnd = skipWhitespaceBackwards(Sorted, SplitOffset);
+    }
+
+    tooling::Replacements PieceReplaces;
+    for (const tooling::Replacement &Replace : Replaces) {
+      if (Replace.getOffset() >= PieceEnd)
+        break;
+      PieceReplaces.insert(Replace);
+    }
+    StringRef Piece = StringRef(Sorted).substr(0, PieceEnd);
+    llvm::Expected<std::string> Formatted =
+        tooling::applyAllReplacements(Piece, PieceReplaces);
+    if (Formatted) {
+      OS << *Formatted;
+    } else {
+      llvm::consumeError(Formatted.takeError());
+      OS << Piece;
+    }
+    if (IsLast)
+      break;
+
+    // The whitespace before the split point is formatted like that before the
+    // first token of a top-level line.
+    StringRef Whitespace = StringRef(Sorted).slice(PieceEnd, SplitOffset);
+    unsigned Newlines = std::min<unsigned>(Whitespace.count('\n'),
+                                           Expanded.MaxEmptyLinesToKeep + 1);
+    for (unsigned i = 0; i < Newlines; ++i)
+      OS << (Whitespace.count('\r') ? "\r\n" : "\n");
+
+    Start += unshiftedCodePosition(Includes, SplitOffset);
+    Size = std::max(ChunkSize, 1u);
+  }
+}
+
+static LLVM_THREAD_LOCAL FormatStatistics *CurrentStatistics = nullptr;
+
+void setFormatStatistics(FormatStatistics *Stats) { CurrentStatistics = Stats; }
+
+FormatStatistics *getFormatStatistics() { return CurrentStatistics; }
+
+void printFormatStatistics(const FormatStatistics &Stats, raw_ostream &OS) {
+  auto PrintTiming = [&](StringRef Name, const FormatStatistics::Timing &T) {
+    OS << ", \"" << Name << "\": {\"calls\": " << T.Calls
+       << ", \"ns\": " << T.Nanoseconds << "}";
+  };
+  OS << "{\"line_searches\": [";
+  for (unsigned i = 0, e = Stats.LineSearches.size(); i != e; ++i) {
+    const FormatStatistics::LineSearch &Search = Stats.LineSearches[i];
+    if (i != 0)
+      OS << ", ";
+    OS << "{\"line\": " << Search.Line << ", \"tokens\": " << Search.Tokens
+       << ", \"states\": " << Search.States
+       << ", \"greedy\": " << (Search.Greedy ? "true" : "false")
+       << ", \"dry_run\": " << (Search.DryRun ? "true" : "false")
+       << ", \"ns\": " << Search.Nanoseconds << "}";
+  }
+  OS << "], \"penalty_cache\": {\"hits\": " << Stats.PenaltyCacheHits
+     << ", \"misses\": " << Stats.PenaltyCacheMisses << "}"
+     << ", \"solution_cache\": {\"hits\": " << Stats.SolutionCacheHits
+     << ", \"misses\": " << Stats.SolutionCacheMisses << "}";
+  PrintTiming("add_token_to_state", Stats.AddTokenToState);
+  PrintTiming("break_protruding_token", Stats.BreakProtrudingToken);
+  PrintTiming("alignment", Stats.Alignment);
+  OS << "}";
+}
+
 tooling::Replacements cleanup(const FormatStyle &Style, SourceManager &SM,
                               FileID ID, ArrayRef<CharSourceRange> Ranges) {
   Environment Env(SM, ID, Ranges);
@@ -87,7 +87,7 @@ namespace format {
   TYPE(UnaryOperator) \
   TYPE(Unknown)
 
-enum TokenType {
+enum TokenType : unsigned char {
 #define TYPE(X) TT_##X,
 LIST_TOKEN_TYPES
 #undef TYPE
@@ -98,12 +98,16 @@ LIST_TOKEN_TYPES
 const char *getTokenTypeName(TokenType Type);
 
 // Represents what type of block a set of braces open.
-enum BraceBlockKind { BK_Unknown, BK_Block, BK_BracedInit };
+enum BraceBlockKind : unsigned char { BK_Unknown, BK_Block, BK_BracedInit };
 
 // The packing kind of a function's parameters.
-enum ParameterPackingKind { PPK_BinPacked, PPK_OnePerLine, PPK_Inconclusive };
+enum ParameterPackingKind : unsigned char {
+  PPK_BinPacked,
+  PPK_OnePerLine,
+  PPK_Inconclusive
+};
 
-enum FormatDecision { FD_Unformatted, FD_Continue, FD_Break };
+enum FormatDecision : unsigned char { FD_Unformatted, FD_Continue, FD_Break };
 
 class TokenRole;
 class AnnotatedLine;
@@ -113,34 +117,39 @@ class AnnotatedLine;
 struct FormatToken {
   FormatToken() {}
 
+  // The members are grouped by size to avoid padding, with the ones used most
+  // while formatting a line first.
+
+  /// \brief The previous token in the unwrapped line.
+  FormatToken *Previous = nullptr;
+
+  /// \brief The next token in the unwrapped line.
+  FormatToken *Next = nullptr;
+
+  /// \brief If this is a bracket, this points to the matching one.
+  FormatToken *MatchingParen = nullptr;
+
   /// \brief The \c Token.
   Token Tok;
 
-  /// \brief The number of newlines immediately before the \c Token.
-  ///
-  /// This can be used to determine what the user wrote in the original code
-  /// and thereby e.g. leave an empty line between two function definitions.
-  unsigned NewlinesBefore = 0;
+  TokenType Type = TT_Unknown;
 
-  /// \brief Whether there is at least one unescaped newline before the \c
-  /// Token.
-  bool HasUnescapedNewline = false;
+  /// \brief Contains the kind of block if this token is a brace.
+  BraceBlockKind BlockKind = BK_Unknown;
 
-  /// \brief The range of the whitespace immediately preceding the \c Token.
-  SourceRange WhitespaceRange;
+  /// \brief If this is an opening parenthesis, how are the parameters packed?
+  ParameterPackingKind PackingKind = PPK_Inconclusive;
 
-  /// \brief The offset just past the last '\n' in this token's leading
-  /// whitespace (relative to \c WhiteSpaceStart). 0 if there is no '\n'.
-  unsigned LastNewlineOffset = 0;
+  /// \brief Stores the formatting decision for the token once it was made.
+  FormatDecision Decision = FD_Unformatted;
 
-  /// \brief The width of the non-whitespace parts of the token (or its first
-  /// line for multi-line tokens) in columns.
-  /// We need this to correctly measure number of columns a token spans.
-  unsigned ColumnWidth = 0;
+  /// \brief If this is a bracket ("<", "(", "[" or "{"), contains the kind of
+  /// the surrounding bracket.
+  tok::TokenKind ParentBracket = tok::unknown;
 
-  /// \brief Contains the width in columns of the last line of a multi-line
-  /// token.
-  unsigned LastLineColumnWidth = 0;
+  /// \brief Whether there is at least one unescaped newline before the \c
+  /// Token.
+  bool HasUnescapedNewline = false;
 
   /// \brief Whether the token text contains newlines (escaped or not).
   bool IsMultiline = false;
@@ -154,74 +163,91 @@ struct FormatToken {
   /// before the token.
   bool MustBreakBefore = false;
 
-  /// \brief The raw text of the token.
-  ///
-  /// Contains the raw token text without leading whitespace and without leading
-  /// escaped newlines.
-  StringRef TokenText;
-
   /// \brief Set to \c true if this token is an unterminated literal.
   bool IsUnterminatedLiteral = 0;
 
-  /// \brief Contains the kind of block if this token is a brace.
-  BraceBlockKind BlockKind = BK_Unknown;
-
-  TokenType Type = TT_Unknown;
-
-  /// \brief The number of spaces that should be inserted before this token.
-  unsigned SpacesRequiredBefore = 0;
-
   /// \brief \c true if it is allowed to break before this token.
   bool CanBreakBefore = false;
 
   /// \brief \c true if this is the ">" of "template<..>".
   bool ClosesTemplateDeclaration = false;
 
-  /// \brief Number of parameters, if this is "(", "[" or "<".
-  ///
-  /// This is initialized to 1 as we don't need to distinguish functions with
-  /// 0 parameters from functions with 1 parameter. Thus, we can simply count
-  /// the number of commas.
-  unsigned ParameterCount = 0;
-
-  /// \brief Number of parameters that are nested blocks,
-  /// if this is "(", "[" or "<".
-  unsigned BlockParameterCount = 0;
+  /// \brief \c true if this token starts a binary expression, i.e. has at least
+  /// one fake l_paren with a precedence greater than prec::Unknown.
+  bool StartsBinaryExpression = false;
+  /// \brief \c true if this token ends a binary expression.
+  bool EndsBinaryExpression = false;
 
-  /// \brief If this is a bracket ("<", "(", "[" or "{"), contains the kind of
-  /// the surrounding bracket.
-  tok::TokenKind ParentBracket = tok::unknown;
+  /// \brief Is this token part of a \c DeclStmt defining multiple variables?
+  ///
+  /// Only set if \c Type == \c TT_StartOfName.
+  bool PartOfMultiVariableDeclStmt = false;
 
-  /// \brief A token can have a special role that can carry extra information
-  /// about the token's formatting.
-  std::unique_ptr<TokenRole> Role;
+  /// \brief If \c true, this token has been fully formatted (indented and
+  /// potentially re-formatted inside), and we do not allow further formatting
+  /// changes.
+  bool Finalized = false;
 
-  /// \brief If this is an opening parenthesis, how are the parameters packed?
-  ParameterPackingKind PackingKind = PPK_Inconclusive;
+  /// \brief The width of the non-whitespace parts of the token (or its first
+  /// line for multi-line tokens) in columns.
+  /// We need this to correctly measure number of columns a token spans.
+  unsigned ColumnWidth = 0;
 
   /// \brief The total length of the unwrapped line up to and including this
   /// token.
   unsigned TotalLength = 0;
 
-  /// \brief The original 0-based column of this token, including expanded tabs.
-  /// The configured TabWidth is used as tab width.
-  unsigned OriginalColumn = 0;
+  /// \brief The number of spaces that should be inserted before this token.
+  unsigned SpacesRequiredBefore = 0;
 
-  /// \brief The length of following tokens until the next natural split point,
-  /// or the next token that can be broken.
-  unsigned UnbreakableTailLength = 0;
+  /// \brief Penalty for inserting a line break before this token.
+  unsigned SplitPenalty = 0;
+
+  /// \brief The nesting level of this token, i.e. the number of surrounding (),
+  /// [], {} or <>.
+  unsigned NestingLevel = 0;
 
   // FIXME: Come up with a 'cleaner' concept.
   /// \brief The binding strength of a token. This is a combined value of
   /// operator precedence, parenthesis nesting, etc.
   unsigned BindingStrength = 0;
 
-  /// \brief The nesting level of this token, i.e. the number of surrounding (),
-  /// [], {} or <>.
-  unsigned NestingLevel = 0;
+  /// \brief The length of following tokens until the next natural split point,
+  /// or the next token that can be broken.
+  unsigned UnbreakableTailLength = 0;
 
-  /// \brief Penalty for inserting a line break before this token.
-  unsigned SplitPenalty = 0;
+  /// \brief The number of newlines immediately before the \c Token.
+  ///
+  /// This can be used to determine what the user wrote in the original code
+  /// and thereby e.g. leave an empty line between two function definitions.
+  unsigned NewlinesBefore = 0;
+
+  /// \brief The original 0-based column of this token, including expanded tabs.
+  /// The configured TabWidth is used as tab width.
+  unsigned OriginalColumn = 0;
+
+  /// \brief Contains the width in columns of the last line of a multi-line
+  /// token.
+  unsigned LastLineColumnWidth = 0;
+
+  /// \brief The offset just past the last '\n' in this token's leading
+  /// whitespace (relative to \c WhiteSpaceStart). 0 if there is no '\n'.
+  unsigned LastNewlineOffset = 0;
+
+  /// \brief Number of parameters, if this is "(", "[" or "<".
+  ///
+  /// This is initialized to 1 as we don't need to distinguish functions with
+  /// 0 parameters from functions with 1 parameter. Thus, we can simply count
+  /// the number of commas.
+  unsigned ParameterCount = 0;
+
+  /// \brief Number of parameters that are nested blocks,
+  /// if this is "(", "[" or "<".
+  unsigned BlockParameterCount = 0;
+
+  /// \brief Is this is an operator (or "."/"->") in a sequence of operators
+  /// with the same precedence, contains the 0-based operator index.
+  unsigned OperatorIndex = 0;
 
   /// \brief If this is the first ObjC selector name in an ObjC method
   /// definition or call, this contains the length of the longest name.
@@ -230,55 +256,36 @@ struct FormatToken {
   /// e.g. because several of them are block-type.
   unsigned LongestObjCSelectorName = 0;
 
-  /// \brief Stores the number of required fake parentheses and the
-  /// corresponding operator precedence.
+  /// \brief The raw text of the token.
   ///
-  /// If multiple fake parentheses start at a token, this vector stores them in
-  /// reverse order, i.e. inner fake parenthesis first.
-  SmallVector<prec::Level, 4> FakeLParens;
-  /// \brief Insert this many fake ) after this token for correct indentation.
-  unsigned FakeRParens = 0;
-
-  /// \brief \c true if this token starts a binary expression, i.e. has at least
-  /// one fake l_paren with a precedence greater than prec::Unknown.
-  bool StartsBinaryExpression = false;
-  /// \brief \c true if this token ends a binary expression.
-  bool EndsBinaryExpression = false;
+  /// Contains the raw token text without leading whitespace and without leading
+  /// escaped newlines.
+  StringRef TokenText;
 
-  /// \brief Is this is an operator (or "."/"->") in a sequence of operators
-  /// with the same precedence, contains the 0-based operator index.
-  unsigned OperatorIndex = 0;
+  /// \brief The range of the whitespace immediately preceding the \c Token.
+  SourceRange WhitespaceRange;
 
   /// \brief If this is an operator (or "."/"->") in a sequence of operators
   /// with the same precedence, points to the next operator.
   FormatToken *NextOperator = nullptr;
 
-  /// \brief Is this token part of a \c DeclStmt defining multiple variables?
-  ///
-  /// Only set if \c Type == \c TT_StartOfName.
-  bool PartOfMultiVariableDeclStmt = false;
-
-  /// \brief If this is a bracket, this points to the matching one.
-  FormatToken *MatchingParen = nullptr;
-
-  /// \brief The previous token in the unwrapped line.
-  FormatToken *Previous = nullptr;
+  /// \brief A token can have a special role that can carry extra information
+  /// about the token's formatting.
+  std::unique_ptr<TokenRole> Role;
 
-  /// \brief The next token in the unwrapped line.
-  FormatToken *Next = nullptr;
+  /// \brief Stores the number of required fake parentheses and the
+  /// corresponding operator precedence.
+  ///
+  /// If multiple fake parentheses start at a token, this vector stores them in
+  /// reverse order, i.e. inner fake parenthesis first.
+  SmallVector<prec::Level, 4> FakeLParens;
+  /// \brief Insert this many fake ) after this token for correct indentation.
+  unsigned FakeRParens = 0;
 
   /// \brief If this token starts a block, this contains all the unwrapped lines
   /// in it.
   SmallVector<AnnotatedLine *, 1> Children;
 
-  /// \brief Stores the formatting decision for the token once it was made.
-  FormatDecision Decision = FD_Unformatted;
-
-  /// \brief If \c true, this token has been fully formatted (indented and
-  /// potentially re-formatted inside), and we do not allow further formatting
-  /// changes.
-  bool Finalized = false;
-
   bool is(tok::TokenKind Kind) const { return Tok.is(Kind); }
   bool is(TokenType TT) const { return Type == TT; }
   bool is(const IdentifierInfo *II) const {
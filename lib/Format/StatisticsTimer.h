@@ -0,0 +1,68 @@
+//===--- StatisticsTimer.h - Format C++ code --------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief StatisticsTimer class adds the time spent in a scope to the
+/// \c FormatStatistics collected on the current thread.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LIB_FORMAT_STATISTICSTIMER_H
+#define LLVM_CLANG_LIB_FORMAT_STATISTICSTIMER_H
+
+#include "clang/Format/Format.h"
+#include <chrono>
+
+namespace clang {
+namespace format {
+
+/// \brief Measures the time from its construction to its destruction if
+/// statistics are collected, and does nothing otherwise.
+class StatisticsTimer {
+public:
+  StatisticsTimer() : Stats(getFormatStatistics()) {
+    if (Stats)
+      Start = std::chrono::steady_clock::now();
+  }
+
+  /// \brief Counts a call taking the time since construction in the given
+  /// \c Timing of the collected statistics.
+  StatisticsTimer(FormatStatistics::Timing FormatStatistics::*Timing)
+      : StatisticsTimer() {
+    this->Timing = Timing;
+  }
+
+  ~StatisticsTimer() {
+    if (Stats && Timing) {
+      ++(Stats->*Timing).Calls;
+      (Stats->*Timing).Nanoseconds += elapsedNanoseconds();
+    }
+  }
+
+  /// \brief Returns the statistics collected on the current thread, if any.
+  FormatStatistics *getStatistics() const { return Stats; }
+
+  uint64_t elapsedNanoseconds() const {
+    if (!Stats)
+      return 0;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - Start)
+        .count();
+  }
+
+private:
+  FormatStatistics *Stats;
+  FormatStatistics::Timing FormatStatistics::*Timing = nullptr;
+  std::chrono::steady_clock::time_point Start;
+};
+
+} // namespace format
+} // namespace clang
+
+#endif // LLVM_CLANG_LIB_FORMAT_STATISTICSTIMER_H
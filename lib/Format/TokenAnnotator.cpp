@@ -1770,16 +1770,15 @@ void TokenAnnotator::calculateFormattingInformation(AnnotatedLine &Line) {
     Current = Current->Next;
   }
 
-  calculateUnbreakableTailLengths(Line);
-  for (Current = Line.First; Current != nullptr; Current = Current->Next) {
-    if (Current->Role)
-      Current->Role->precomputeFormattingInfos(Current);
-  }
+  calculateUnbreakableTailLengthsAndRoles(Line);
 
   DEBUG({ printDebugInfo(Line); });
 }
 
-void TokenAnnotator::calculateUnbreakableTailLengths(AnnotatedLine &Line) {
+void TokenAnnotator::calculateUnbreakableTailLengthsAndRoles(
+    AnnotatedLine &Line) {
+  // Roles only look at their token and the ones after it, which are complete
+  // by the time this backwards walk reaches the token.
   unsigned UnbreakableTailLength = 0;
   FormatToken *Current = Line.Last;
   while (Current) {
@@ -1791,6 +1790,8 @@ void TokenAnnotator::calculateUnbreakableTailLengths(AnnotatedLine &Line) {
       UnbreakableTailLength +=
           Current->ColumnWidth + Current->SpacesRequiredBefore;
     }
+    if (Current->Role)
+      Current->Role->precomputeFormattingInfos(Current);
     Current = Current->Previous;
   }
 }
@@ -2518,7 +2519,8 @@ void TokenAnnotator::printDebugInfo(const AnnotatedLine &Line) {
                  << " S=" << Tok->SpacesRequiredBefore
                  << " B=" << Tok->BlockParameterCount
                  << " P=" << Tok->SplitPenalty << " Name=" << Tok->Tok.getName()
-                 << " L=" << Tok->TotalLength << " PPK=" << Tok->PackingKind
+                 << " L=" << Tok->TotalLength
+                 << " PPK=" << static_cast<unsigned>(Tok->PackingKind)
                  << " FakeLParens=";
     for (unsigned i = 0, e = Tok->FakeLParens.size(); i != e; ++i)
       llvm::errs() << Tok->FakeLParens[i] << "/";
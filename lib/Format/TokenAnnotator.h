@@ -165,7 +165,7 @@ private:
 
   void printDebugInfo(const AnnotatedLine &Line);
 
-  void calculateUnbreakableTailLengths(AnnotatedLine &Line);
+  void calculateUnbreakableTailLengthsAndRoles(AnnotatedLine &Line);
 
   const FormatStyle &Style;
 
@@ -8,8 +8,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "UnwrappedLineFormatter.h"
+#include "StatisticsTimer.h"
 #include "WhitespaceManager.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/Debug.h"
+#include <unordered_map>
 
 #define DEBUG_TYPE "format-formatter"
 
@@ -617,6 +620,79 @@ public:
   }
 };
 
+/// \brief Computes the shape of \p Line when formatted starting at
+/// \p FirstIndent: all of its annotations that the search for the best line
+/// breaks depends on, but not the text of comments and literals.
+///
+/// Returns \c false if the line's formatting depends on more than that, e.g.
+/// because it contains nested blocks.
+static bool getLineShape(const AnnotatedLine &Line, unsigned FirstIndent,
+                         std::vector<uintptr_t> &Shape) {
+  llvm::SmallDenseMap<const FormatToken *, unsigned, 32> Indices;
+  unsigned Index = 0;
+  for (const FormatToken *Tok = Line.First; Tok; Tok = Tok->Next) {
+    if (!Tok->Children.empty() || Tok->is(TT_ImplicitStringLiteral))
+      return false;
+    Indices[Tok] = Index++;
+  }
+  auto IndexOf = [&](const FormatToken *Tok) -> uintptr_t {
+    return Tok ? Indices.lookup(Tok) : ~uintptr_t(0);
+  };
+
+  Shape.clear();
+  Shape.push_back(FirstIndent);
+  Shape.push_back(Index);
+  Shape.push_back(Line.Type);
+  Shape.push_back(Line.Level);
+  Shape.push_back(Line.InPPDirective | Line.MustBeDeclaration << 1 |
+                  Line.MightBeFunctionDecl << 2 |
+                  Line.IsMultiVariableDeclStmt << 3);
+  for (const FormatToken *Tok = Line.First; Tok; Tok = Tok->Next) {
+    Shape.push_back(Tok->Tok.getKind());
+    Shape.push_back(reinterpret_cast<uintptr_t>(Tok->Tok.getIdentifierInfo()));
+    Shape.push_back(Tok->Type | Tok->BlockKind << 8 | Tok->PackingKind << 16 |
+                    Tok->Decision << 24);
+    Shape.push_back(Tok->ParentBracket);
+    Shape.push_back(
+        Tok->HasUnescapedNewline | Tok->IsMultiline << 1 | Tok->IsFirst << 2 |
+        Tok->MustBreakBefore << 3 | Tok->IsUnterminatedLiteral << 4 |
+        Tok->CanBreakBefore << 5 | Tok->ClosesTemplateDeclaration << 6 |
+        Tok->StartsBinaryExpression << 7 | Tok->EndsBinaryExpression << 8 |
+        Tok->PartOfMultiVariableDeclStmt << 9 | Tok->Finalized << 10 |
+        (Tok->Role != nullptr) << 11);
+    if (Tok->Tok.isLiteral() || Tok->is(tok::comment)) {
+      // The only properties of the text that matter as long as the token fits
+      // into the line; see ContinuationIndenter::hasReadTokenText().
+      StringRef Text = Tok->TokenText;
+      Shape.push_back((Text.find('\t') != StringRef::npos) |
+                      Text.startswith("R\"") << 1 |
+                      (Text.endswith("\\n\"") || Text == "\'\\n\'") << 2);
+    }
+    Shape.push_back(Tok->NewlinesBefore);
+    Shape.push_back(Tok->LastNewlineOffset);
+    Shape.push_back(Tok->ColumnWidth);
+    Shape.push_back(Tok->LastLineColumnWidth);
+    Shape.push_back(Tok->SpacesRequiredBefore);
+    Shape.push_back(Tok->ParameterCount);
+    Shape.push_back(Tok->BlockParameterCount);
+    Shape.push_back(Tok->TotalLength);
+    Shape.push_back(Tok->OriginalColumn);
+    Shape.push_back(Tok->UnbreakableTailLength);
+    Shape.push_back(Tok->BindingStrength);
+    Shape.push_back(Tok->NestingLevel);
+    Shape.push_back(Tok->SplitPenalty);
+    Shape.push_back(Tok->LongestObjCSelectorName);
+    Shape.push_back(Tok->OperatorIndex);
+    Shape.push_back(Tok->FakeRParens);
+    Shape.push_back(Tok->FakeLParens.size());
+    Shape.insert(Shape.end(), Tok->FakeLParens.begin(),
+                 Tok->FakeLParens.end());
+    Shape.push_back(IndexOf(Tok->MatchingParen));
+    Shape.push_back(IndexOf(Tok->NextOperator));
+  }
+  return true;
+}
+
 /// \brief Finds the best way to break lines.
 class OptimizingLineFormatter : public LineFormatter {
 public:
@@ -630,6 +706,7 @@ public:
   /// below the column limit.
   unsigned formatLine(const AnnotatedLine &Line, unsigned FirstIndent,
                       bool DryRun) override {
+    Indenter->resetReadTokenText();
     LineState State = Indenter->getInitialState(FirstIndent, &Line, DryRun);
 
     // If the ObjC method declaration does not fit on a line, we should format
@@ -637,8 +714,30 @@ public:
     if (State.Line->Type == LT_ObjCMethodDecl)
       State.Stack.back().BreakBeforeParameter = true;
 
+    // Reuse the solution for a line of the same shape if there is one.
+    std::vector<uintptr_t> Shape;
+    bool HasShape = getLineShape(Line, FirstIndent, Shape) &&
+                    !Indenter->hasReadTokenText();
+    if (HasShape) {
+      const UnwrappedLineFormatter::LineSolution *Solution =
+          BlockFormatter->getSolution(Shape);
+      if (FormatStatistics *Stats = getFormatStatistics())
+        ++(Solution ? Stats->SolutionCacheHits : Stats->SolutionCacheMisses);
+      if (Solution) {
+        if (!DryRun)
+          applySolution(State, Solution->NewLines);
+        return Solution->Penalty;
+      }
+    }
+
     // Find best solution in solution space.
-    return analyzeSolutionSpace(State, DryRun);
+    UnwrappedLineFormatter::LineSolution Solution;
+    Solution.Penalty = analyzeSolutionSpace(
+        State, DryRun, HasShape ? &Solution.NewLines : nullptr);
+    if (HasShape && !Indenter->hasReadTokenText() &&
+        !Solution.NewLines.empty())
+      BlockFormatter->addSolution(std::move(Shape), std::move(Solution));
+    return Solution.Penalty;
   }
 
 private:
@@ -658,8 +757,8 @@ private:
   /// \brief An edge in the solution space from \c Previous->State to \c State,
   /// inserting a newline dependent on the \c NewLine.
   struct StateNode {
-    StateNode(const LineState &State, bool NewLine, StateNode *Previous)
-        : State(State), NewLine(NewLine), Previous(Previous) {}
+    StateNode(LineState State, bool NewLine, StateNode *Previous)
+        : State(std::move(State)), NewLine(NewLine), Previous(Previous) {}
     LineState State;
     bool NewLine;
     StateNode *Previous;
@@ -673,6 +772,15 @@ private:
   typedef std::priority_queue<QueueItem, std::vector<QueueItem>,
                               std::greater<QueueItem>> QueueType;
 
+  /// \brief The states queued so far with the penalty they were queued with,
+  /// bucketed by hash.
+  ///
+  /// Used to drop a state as soon as it is generated if an equivalent state
+  /// has already been queued with a lower or equal penalty: Dijkstra's
+  /// algorithm would discard it when dequeued anyway.
+  typedef std::unordered_map<size_t, SmallVector<QueueItem, 1>>
+      QueuedStatesMap;
+
   /// \brief Analyze the entire solution space starting from \p InitialState.
   ///
   /// This implements a variant of Dijkstra's algorithm on the graph that spans
@@ -680,9 +788,13 @@ private:
   /// find the shortest path (the one with lowest penalty) from \p InitialState
   /// to a state where all tokens are placed. Returns the penalty.
   ///
-  /// If \p DryRun is \c false, directly applies the changes.
-  unsigned analyzeSolutionSpace(LineState &InitialState, bool DryRun) {
+  /// If \p DryRun is \c false, directly applies the changes. If \p NewLines is
+  /// not null, stores the line breaks of the solution in it.
+  unsigned analyzeSolutionSpace(LineState &InitialState, bool DryRun,
+                                std::vector<bool> *NewLines = nullptr) {
+    StatisticsTimer Timer;
     std::set<LineState *, CompareLineStatePointers> Seen;
+    QueuedStatesMap Queued;
 
     // Increasing count of \c StateNode items we have created. This is used to
     // create a deterministic order independent of the container.
@@ -697,6 +809,10 @@ private:
 
     unsigned Penalty = 0;
 
+    // Once the search budget is exhausted, only the most promising partial
+    // solution is followed, one token at a time.
+    bool Greedy = false;
+
     // While not empty, take first element and follow edges.
     while (!Queue.empty()) {
       Penalty = Queue.top().first.first;
@@ -712,15 +828,47 @@ private:
       if (Count > 50000)
         Node->State.IgnoreStackForComparison = true;
 
-      if (!Seen.insert(&Node->State).second)
+      if (!Greedy && Style.MaxLineFormattingStates &&
+          Count > Style.MaxLineFormattingStates) {
+        DEBUG(llvm::dbgs() << "Search budget exhausted, continuing greedily.\n");
+        Greedy = true;
+        Queue = QueueType();
+        Queued.clear();
+      }
+
+      if (!Seen.insert(&Node->State).second && !Greedy)
         // State already examined with lower penalty.
         continue;
 
       FormatDecision LastFormat = Node->State.NextToken->Decision;
       if (LastFormat == FD_Unformatted || LastFormat == FD_Continue)
-        addNextStateToQueue(Penalty, Node, /*NewLine=*/false, &Count, &Queue);
+        addNextStateToQueue(Penalty, Node, /*NewLine=*/false, &Count, &Queue,
+                            Queued);
       if (LastFormat == FD_Unformatted || LastFormat == FD_Break)
-        addNextStateToQueue(Penalty, Node, /*NewLine=*/true, &Count, &Queue);
+        addNextStateToQueue(Penalty, Node, /*NewLine=*/true, &Count, &Queue,
+                            Queued);
+
+      if (Greedy && !Queue.empty()) {
+        QueueItem Best = Queue.top();
+        Queue = QueueType();
+        Queue.push(Best);
+        Queued.clear();
+      }
+    }
+
+    if (FormatStatistics *Stats = Timer.getStatistics()) {
+      FormatStatistics::LineSearch Search;
+      const FormatToken *First = InitialState.Line->First;
+      Search.Line = Indenter->getSourceManager().getSpellingLineNumber(
+          First->Tok.getLocation());
+      Search.Tokens = 0;
+      for (const FormatToken *Tok = First; Tok; Tok = Tok->Next)
+        ++Search.Tokens;
+      Search.States = Count;
+      Search.Greedy = Greedy;
+      Search.DryRun = DryRun;
+      Search.Nanoseconds = Timer.elapsedNanoseconds();
+      Stats->LineSearches.push_back(Search);
     }
 
     if (Queue.empty()) {
@@ -731,6 +879,12 @@ private:
     }
 
     // Reconstruct the solution.
+    if (NewLines) {
+      for (StateNode *Node = Queue.top().second; Node->Previous;
+           Node = Node->Previous)
+        NewLines->push_back(Node->NewLine);
+      std::reverse(NewLines->begin(), NewLines->end());
+    }
     if (!DryRun)
       reconstructPath(InitialState, Queue.top().second);
 
@@ -744,24 +898,56 @@ private:
   ///
   /// Assume the current state is \p PreviousNode and has been reached with a
   /// penalty of \p Penalty. Insert a line break if \p NewLine is \c true.
+  ///
+  /// The state is not queued if an equivalent one already is, with a lower
+  /// or equal penalty.
   void addNextStateToQueue(unsigned Penalty, StateNode *PreviousNode,
-                           bool NewLine, unsigned *Count, QueueType *Queue) {
+                           bool NewLine, unsigned *Count, QueueType *Queue,
+                           QueuedStatesMap &Queued) {
     if (NewLine && !Indenter->canBreak(PreviousNode->State))
       return;
     if (!NewLine && Indenter->mustBreak(PreviousNode->State))
       return;
 
-    StateNode *Node = new (Allocator.Allocate())
-        StateNode(PreviousNode->State, NewLine, PreviousNode);
-    if (!formatChildren(Node->State, NewLine, /*DryRun=*/true, Penalty))
+    LineState State = PreviousNode->State;
+    if (!formatChildren(State, NewLine, /*DryRun=*/true, Penalty))
       return;
 
-    Penalty += Indenter->addTokenToState(Node->State, NewLine, true);
+    Penalty += Indenter->addTokenToState(State, NewLine, true);
 
-    Queue->push(QueueItem(OrderedPenalty(Penalty, *Count), Node));
+    SmallVectorImpl<QueueItem> &Bucket = Queued[hash_value(State)];
+    QueueItem *Equivalent = nullptr;
+    for (QueueItem &Item : Bucket) {
+      const LineState &Other = Item.second->State;
+      if (!(State < Other) && !(Other < State)) {
+        Equivalent = &Item;
+        break;
+      }
+    }
+    if (Equivalent && Equivalent->first.first <= Penalty)
+      return;
+
+    StateNode *Node = new (Allocator.Allocate())
+        StateNode(std::move(State), NewLine, PreviousNode);
+    QueueItem Item(OrderedPenalty(Penalty, *Count), Node);
+    Queue->push(Item);
+    if (Equivalent)
+      *Equivalent = Item;
+    else
+      Bucket.push_back(Item);
     ++(*Count);
   }
 
+  /// \brief Applies the line breaks \p NewLines found for a line of the same
+  /// shape.
+  void applySolution(LineState &State, const std::vector<bool> &NewLines) {
+    for (bool NewLine : NewLines) {
+      unsigned Penalty = 0;
+      formatChildren(State, NewLine, /*DryRun=*/false, Penalty);
+      Indenter->addTokenToState(State, NewLine, false);
+    }
+  }
+
   /// \brief Applies the best formatting by reconstructing the path in the
   /// solution space that leads to \c Best.
   void reconstructPath(LineState &State, StateNode *Best) {
@@ -803,6 +989,10 @@ UnwrappedLineFormatter::format(const SmallVectorImpl<AnnotatedLine *> &Lines,
   std::pair<const SmallVectorImpl<AnnotatedLine *> *, unsigned> CacheKey(
       &Lines, AdditionalIndent);
   auto CacheIt = PenaltyCache.find(CacheKey);
+  if (DryRun)
+    if (FormatStatistics *Stats = getFormatStatistics())
+      ++(CacheIt != PenaltyCache.end() ? Stats->PenaltyCacheHits
+                                       : Stats->PenaltyCacheMisses);
   if (DryRun && CacheIt != PenaltyCache.end())
     return CacheIt->second;
 
@@ -21,6 +21,7 @@
 #include <map>
 #include <queue>
 #include <string>
+#include <vector>
 
 namespace clang {
 namespace format {
@@ -43,6 +44,24 @@ public:
                   bool DryRun = false, int AdditionalIndent = 0,
                   bool FixBadIndentation = false);
 
+  /// \brief The line breaks found for a line by searching the solution space.
+  struct LineSolution {
+    unsigned Penalty;
+    /// \brief For each token after the first, whether to break before it.
+    std::vector<bool> NewLines;
+  };
+
+  /// \brief Returns the solution found for a line of shape \p Shape, or null.
+  const LineSolution *getSolution(const std::vector<uintptr_t> &Shape) const {
+    auto I = SolutionCache.find(Shape);
+    return I == SolutionCache.end() ? nullptr : &I->second;
+  }
+
+  /// \brief Remembers \p Solution for lines of shape \p Shape.
+  void addSolution(std::vector<uintptr_t> Shape, LineSolution Solution) {
+    SolutionCache.insert(std::make_pair(std::move(Shape), std::move(Solution)));
+  }
+
 private:
   /// \brief Add a new line and the required indent before the first Token
   /// of the \c UnwrappedLine if there was no structural parsing error.
@@ -61,6 +80,11 @@ private:
   std::map<std::pair<const SmallVectorImpl<AnnotatedLine *> *, unsigned>,
            unsigned> PenaltyCache;
 
+  // Cache of the best line breaks for lines that do not fit into the column
+  // limit, keyed by everything the search depends on except the token texts.
+  // Lets lines of the same shape, e.g. in generated tables, skip the search.
+  std::map<std::vector<uintptr_t>, LineSolution> SolutionCache;
+
   ContinuationIndenter *Indenter;
   WhitespaceManager *Whitespaces;
   const FormatStyle &Style;
@@ -13,6 +13,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "WhitespaceManager.h"
+#include "StatisticsTimer.h"
 #include "llvm/ADT/STLExtras.h"
 
 namespace clang {
@@ -96,10 +97,13 @@ const tooling::Replacements &WhitespaceManager::generateReplacements() {
 
   std::sort(Changes.begin(), Changes.end(), Change::IsBeforeInFile(SourceMgr));
   calculateLineBreakInformation();
-  alignConsecutiveDeclarations();
-  alignConsecutiveAssignments();
-  alignTrailingComments();
-  alignEscapedNewlines();
+  {
+    StatisticsTimer Timer(&FormatStatistics::Alignment);
+    alignConsecutiveDeclarations();
+    alignConsecutiveAssignments();
+    alignTrailingComments();
+    alignEscapedNewlines();
+  }
   generateChanges();
 
   return Replaces;
@@ -223,6 +227,18 @@ static void AlignTokens(const FormatStyle &Style, F &&Matches,
   // Whether a matching token has been found on the current line.
   bool FoundMatchOnLine = false;
 
+  // The length of the rest of the line from each change on, including its
+  // whitespace. Aligning only changes the whitespace of lines before the
+  // current one, so this can be computed once up front instead of walking the
+  // rest of the line for each match.
+  SmallVector<int, 16> LengthToEndOfLine(Changes.size());
+  for (unsigned i = Changes.size(); i != 0; --i) {
+    LengthToEndOfLine[i - 1] =
+        Changes[i - 1].Spaces + Changes[i - 1].TokenLength;
+    if (i != Changes.size() && Changes[i].NewlinesBefore == 0)
+      LengthToEndOfLine[i - 1] += LengthToEndOfLine[i];
+  }
+
   // Aligns a sequence of matching tokens, on the MinColumn column.
   //
   // Sequences start from the first matching token to align, and end at the
@@ -286,8 +302,8 @@ static void AlignTokens(const FormatStyle &Style, F &&Matches,
 
     unsigned ChangeMinColumn = Changes[i].StartOfTokenColumn;
     int LineLengthAfter = -Changes[i].Spaces;
-    for (unsigned j = i; j != e && Changes[j].NewlinesBefore == 0; ++j)
-      LineLengthAfter += Changes[j].Spaces + Changes[j].TokenLength;
+    if (Changes[i].NewlinesBefore == 0)
+      LineLengthAfter += LengthToEndOfLine[i];
     unsigned ChangeMaxColumn = Style.ColumnLimit - LineLengthAfter;
 
     // If we are restricted by the maximum column width, end the sequence.
@@ -340,6 +356,17 @@ void WhitespaceManager::alignConsecutiveDeclarations() {
 }
 
 void WhitespaceManager::alignTrailingComments() {
+  // The index of the next change after each change that is neither a comment
+  // nor the continuation of a multiline comment, so that long runs of comments
+  // are not walked once per comment.
+  SmallVector<unsigned, 16> NextNonComment(Changes.size());
+  for (unsigned i = Changes.size(), Next = Changes.size(); i != 0; --i) {
+    NextNonComment[i - 1] = Next;
+    if (Changes[i - 1].Kind != tok::comment &&
+        Changes[i - 1].Kind != tok::unknown)
+      Next = i - 1;
+  }
+
   unsigned MinColumn = 0;
   unsigned MaxColumn = UINT_MAX;
   unsigned StartOfSequence = 0;
@@ -371,13 +398,10 @@ void WhitespaceManager::alignTrailingComments() {
     if (Changes[i].NewlinesBefore == 1) { // A comment on its own line.
       unsigned CommentColumn = SourceMgr.getSpellingColumnNumber(
           Changes[i].OriginalWhitespaceRange.getEnd());
-      for (unsigned j = i + 1; j != e; ++j) {
-        if (Changes[j].Kind == tok::comment ||
-            Changes[j].Kind == tok::unknown)
-          // Skip over comments and unknown tokens. "unknown tokens are used for
-          // the continuation of multiline comments.
-          continue;
-
+      // Skip over comments and unknown tokens. "unknown tokens are used for
+      // the continuation of multiline comments.
+      unsigned j = NextNonComment[i];
+      if (j != e) {
         unsigned NextColumn = SourceMgr.getSpellingColumnNumber(
             Changes[j].OriginalWhitespaceRange.getEnd());
         // The start of the next token was previously aligned with the
@@ -385,7 +409,6 @@ void WhitespaceManager::alignTrailingComments() {
         WasAlignedWithStartOfNextLine =
             CommentColumn == NextColumn ||
             CommentColumn == NextColumn + Style.IndentWidth;
-        break;
       }
     }
     if (!Style.AlignTrailingComments || FollowsRBraceInColumn0) {
@@ -21,6 +21,8 @@
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
@@ -121,6 +123,177 @@ namespace {
   private:
     raw_ostream &Out;
   };
+
+  /// Streams the AST as JSON, writing one object per node on a line of its
+  /// own, in preorder. Nodes are numbered in the order they are written and
+  /// refer to their parent by number; the file of a location is only written
+  /// when it differs from the one of the previous node. Nothing but the path
+  /// to the current node is kept in memory.
+  class ASTJSONDumper : public ASTConsumer,
+                        public RecursiveASTVisitor<ASTJSONDumper> {
+    typedef RecursiveASTVisitor<ASTJSONDumper> base;
+
+  public:
+    ASTJSONDumper(StringRef FilterString)
+        : Out(llvm::outs()), FilterString(FilterString), Context(nullptr),
+          NextID(0), Dumping(false), LastFilename("") {}
+
+    void HandleTranslationUnit(ASTContext &Ctx) override {
+      Context = &Ctx;
+      Dumping = FilterString.empty();
+      TraverseDecl(Ctx.getTranslationUnitDecl());
+      Out.flush();
+    }
+
+    bool shouldVisitTemplateInstantiations() const { return true; }
+    bool shouldVisitImplicitCode() const { return true; }
+    bool shouldWalkTypesOfTypeLocs() const { return false; }
+
+    bool TraverseDecl(Decl *D) {
+      if (!D)
+        return true;
+      // With a filter, only the subtrees of the matching declarations are
+      // dumped.
+      bool StartsDump = !Dumping && filterMatches(D);
+      if (!Dumping && !StartsDump)
+        return base::TraverseDecl(D);
+
+      Dumping = true;
+      writeDecl(D);
+      bool Result = base::TraverseDecl(D);
+      Parents.pop_back();
+      if (StartsDump)
+        Dumping = false;
+      return Result;
+    }
+
+    bool dataTraverseStmtPre(Stmt *S) {
+      if (Dumping)
+        writeStmt(S);
+      return true;
+    }
+
+    bool dataTraverseStmtPost(Stmt *S) {
+      if (Dumping)
+        Parents.pop_back();
+      return true;
+    }
+
+  private:
+    bool filterMatches(Decl *D) {
+      const NamedDecl *ND = dyn_cast<NamedDecl>(D);
+      return ND && ND->getQualifiedNameAsString().find(FilterString) !=
+                       std::string::npos;
+    }
+
+    /// Start the object of a new node, which becomes the parent of the nodes
+    /// written until the matching pop.
+    void beginNode(StringRef Kind, StringRef KindSuffix = "") {
+      uint64_t ID = NextID++;
+      Out << "{\"id\":" << ID;
+      if (!Parents.empty())
+        Out << ",\"parent\":" << Parents.back();
+      Out << ",\"kind\":\"" << Kind << KindSuffix << '"';
+      Parents.push_back(ID);
+    }
+
+    void endNode(SourceLocation Loc) {
+      writeLocation(Loc);
+      Out << "}\n";
+    }
+
+    void writeDecl(Decl *D) {
+      beginNode(D->getDeclKindName(), "Decl");
+      if (NamedDecl *ND = dyn_cast<NamedDecl>(D)) {
+        if (ND->getDeclName()) {
+          Buffer.clear();
+          llvm::raw_svector_ostream OS(Buffer);
+          ND->printName(OS);
+          writeField("name", OS.str());
+        }
+      }
+      if (ValueDecl *VD = dyn_cast<ValueDecl>(D))
+        writeType(VD->getType());
+      else if (TypedefNameDecl *TD = dyn_cast<TypedefNameDecl>(D))
+        writeType(TD->getUnderlyingType());
+      if (D->isImplicit())
+        Out << ",\"implicit\":true";
+      endNode(D->getLocation());
+    }
+
+    void writeStmt(Stmt *S) {
+      beginNode(S->getStmtClassName());
+      if (Expr *E = dyn_cast<Expr>(S))
+        writeType(E->getType());
+      if (DeclRefExpr *DRE = dyn_cast<DeclRefExpr>(S)) {
+        Buffer.clear();
+        llvm::raw_svector_ostream OS(Buffer);
+        DRE->getDecl()->printName(OS);
+        writeField("name", OS.str());
+      } else if (IntegerLiteral *IL = dyn_cast<IntegerLiteral>(S)) {
+        Buffer.clear();
+        llvm::raw_svector_ostream OS(Buffer);
+        IL->getValue().print(OS, IL->getType()->isSignedIntegerType());
+        writeField("value", OS.str());
+      } else if (BinaryOperator *BO = dyn_cast<BinaryOperator>(S)) {
+        writeField("opcode", BO->getOpcodeStr());
+      } else if (UnaryOperator *UO = dyn_cast<UnaryOperator>(S)) {
+        writeField("opcode", UnaryOperator::getOpcodeStr(UO->getOpcode()));
+      }
+      endNode(S->getLocStart());
+    }
+
+    void writeType(QualType T) {
+      if (T.isNull())
+        return;
+      Buffer.clear();
+      llvm::raw_svector_ostream OS(Buffer);
+      T.print(OS, Context->getPrintingPolicy());
+      writeField("type", OS.str());
+    }
+
+    void writeLocation(SourceLocation Loc) {
+      if (Loc.isInvalid())
+        return;
+      const SourceManager &SM = Context->getSourceManager();
+      PresumedLoc PLoc = SM.getPresumedLoc(SM.getSpellingLoc(Loc));
+      if (PLoc.isInvalid())
+        return;
+      if (strcmp(PLoc.getFilename(), LastFilename) != 0) {
+        writeField("file", PLoc.getFilename());
+        LastFilename = PLoc.getFilename();
+      }
+      Out << ",\"line\":" << PLoc.getLine() << ",\"col\":"
+          << PLoc.getColumn();
+    }
+
+    void writeField(StringRef Name, StringRef Value) {
+      Out << ",\"" << Name << "\":\"";
+      for (unsigned char C : Value) {
+        if (C == '"' || C == '\\')
+          Out << '\\' << C;
+        else if (C < 0x20)
+          Out << "\\u00" << llvm::hexdigit(C >> 4) << llvm::hexdigit(C & 0xF);
+        else
+          Out << C;
+      }
+      Out << '"';
+    }
+
+    raw_ostream &Out;
+    std::string FilterString;
+    ASTContext *Context;
+    /// The number of the next node to be written.
+    uint64_t NextID;
+    /// Whether the nodes being traversed are written.
+    bool Dumping;
+    /// The numbers of the nodes on the path to the current one.
+    SmallVector<uint64_t, 32> Parents;
+    /// The file of the last location written.
+    const char *LastFilename;
+    /// Scratch space for the names and types of the nodes.
+    SmallString<128> Buffer;
+  };
 } // end anonymous namespace
 
 std::unique_ptr<ASTConsumer>
@@ -138,6 +311,11 @@ std::unique_ptr<ASTConsumer> clang::CreateASTDumper(StringRef FilterString,
                                        DumpLookups);
 }
 
+std::unique_ptr<ASTConsumer>
+clang::CreateASTJSONDumper(StringRef FilterString) {
+  return llvm::make_unique<ASTJSONDumper>(FilterString);
+}
+
 std::unique_ptr<ASTConsumer> clang::CreateASTDeclNodeLister() {
   return llvm::make_unique<ASTDeclNodeLister>(nullptr);
 }
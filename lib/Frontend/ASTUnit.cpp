@@ -34,6 +34,7 @@
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/ASTWriter.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Support/CrashRecoveryContext.h"
@@ -80,10 +81,167 @@ namespace {
     }
   };
   
+  /// \brief A precompiled preamble that can be adopted by any ASTUnit whose
+  /// main file, preamble and invocation match the ones it was built from.
+  struct SharedPreamble {
+    /// \brief The file in which the precompiled preamble is stored.
+    std::string PCHPath;
+
+    /// \brief The files the preamble depends on, with their state when the
+    /// preamble was built.
+    llvm::StringMap<ASTUnit::PreambleFileHash> FilesInPreamble;
+
+    /// \brief The top-level declarations in the preamble.
+    std::vector<serialization::DeclID> TopLevelDecls;
+
+    /// \brief The diagnostics produced while building the preamble.
+    SmallVector<ASTUnit::StandaloneDiagnostic, 4> Diagnostics;
+
+    /// \brief The number of warnings produced while building the preamble.
+    unsigned NumWarnings;
+
+    /// \brief The hash of the top-level entities in the preamble.
+    unsigned TopLevelHashValue;
+
+    /// \brief The precompiled preamble itself, when it is kept in memory
+    /// rather than in the file \c PCHPath.
+    std::unique_ptr<llvm::MemoryBuffer> PCHBuffer;
+
+    /// \brief The unique ID under which an in-memory preamble is served.
+    llvm::sys::fs::UniqueID PCHUniqueID;
+
+    /// \brief The precompiled preamble this one was chained to, if it was
+    /// built incrementally on top of a shorter preamble.
+    std::shared_ptr<SharedPreamble> Base;
+
+    /// \brief The number of preambles in the chain below this one.
+    unsigned ChainLength = 0;
+
+    /// \brief Whether \p Path is the file of this preamble or of one it is
+    /// chained to.
+    bool isInChain(StringRef Path) const {
+      for (const SharedPreamble *P = this; P; P = P->Base.get())
+        if (P->PCHPath == Path)
+          return true;
+      return false;
+    }
+
+    ~SharedPreamble() {
+      if (!PCHBuffer)
+        llvm::sys::fs::remove(PCHPath);
+    }
+  };
+
+  /// \brief A view of an in-memory preamble that keeps it alive for as long
+  /// as the AST reader holds on to it.
+  class SharedPreambleBuffer : public llvm::MemoryBuffer {
+    std::shared_ptr<SharedPreamble> Preamble;
+
+  public:
+    SharedPreambleBuffer(std::shared_ptr<SharedPreamble> Preamble,
+                         bool RequiresNullTerminator)
+        : Preamble(std::move(Preamble)) {
+      const llvm::MemoryBuffer &PCH = *this->Preamble->PCHBuffer;
+      init(PCH.getBufferStart(), PCH.getBufferEnd(), RequiresNullTerminator);
+    }
+
+    BufferKind getBufferKind() const override { return MemoryBuffer_Malloc; }
+  };
+
+  /// \brief A file system that serves an ASTUnit's in-memory precompiled
+  /// preamble and forwards every other request to the underlying file system.
+  class InMemoryPreambleFileSystem : public vfs::FileSystem {
+    IntrusiveRefCntPtr<vfs::FileSystem> Underlying;
+    std::shared_ptr<SharedPreamble> Preamble;
+
+    class PreambleFile : public vfs::File {
+      std::shared_ptr<SharedPreamble> Preamble;
+
+    public:
+      explicit PreambleFile(std::shared_ptr<SharedPreamble> Preamble)
+          : Preamble(std::move(Preamble)) {}
+
+      llvm::ErrorOr<vfs::Status> status() override {
+        return getStatus(*Preamble);
+      }
+
+      llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+      getBuffer(const Twine &Name, int64_t FileSize,
+                bool RequiresNullTerminator, bool IsVolatile) override {
+        return std::unique_ptr<llvm::MemoryBuffer>(
+            new SharedPreambleBuffer(Preamble, RequiresNullTerminator));
+      }
+
+      std::error_code close() override { return std::error_code(); }
+    };
+
+    static vfs::Status getStatus(const SharedPreamble &P) {
+      return vfs::Status(P.PCHPath, P.PCHUniqueID, llvm::sys::TimeValue(),
+                         0, 0, P.PCHBuffer->getBufferSize(),
+                         llvm::sys::fs::file_type::regular_file,
+                         llvm::sys::fs::all_read);
+    }
+
+    /// \brief Find the in-memory preamble served at \p Path, looking through
+    /// the preambles the current one is chained to.
+    std::shared_ptr<SharedPreamble> lookup(const Twine &Path) const {
+      SmallString<128> Storage;
+      StringRef P = Path.toStringRef(Storage);
+      for (std::shared_ptr<SharedPreamble> Cur = Preamble; Cur; Cur = Cur->Base)
+        if (Cur->PCHBuffer && Cur->PCHPath == P)
+          return Cur;
+      return nullptr;
+    }
+
+  public:
+    explicit InMemoryPreambleFileSystem(
+        IntrusiveRefCntPtr<vfs::FileSystem> Underlying)
+        : Underlying(std::move(Underlying)) {}
+
+    /// \brief Serve \p P and the preambles it is chained to, if they are
+    /// kept in memory, in place of whatever was served before.
+    void setPreamble(std::shared_ptr<SharedPreamble> P) {
+      Preamble = std::move(P);
+    }
+
+    llvm::ErrorOr<vfs::Status> status(const Twine &Path) override {
+      if (std::shared_ptr<SharedPreamble> P = lookup(Path))
+        return getStatus(*P);
+      return Underlying->status(Path);
+    }
+
+    llvm::ErrorOr<std::unique_ptr<vfs::File>>
+    openFileForRead(const Twine &Path) override {
+      if (std::shared_ptr<SharedPreamble> P = lookup(Path))
+        return std::unique_ptr<vfs::File>(new PreambleFile(std::move(P)));
+      return Underlying->openFileForRead(Path);
+    }
+
+    vfs::directory_iterator dir_begin(const Twine &Dir,
+                                      std::error_code &EC) override {
+      return Underlying->dir_begin(Dir, EC);
+    }
+
+    std::error_code setCurrentWorkingDirectory(const Twine &Path) override {
+      return Underlying->setCurrentWorkingDirectory(Path);
+    }
+
+    llvm::ErrorOr<std::string> getCurrentWorkingDirectory() const override {
+      return Underlying->getCurrentWorkingDirectory();
+    }
+  };
+
   struct OnDiskData {
     /// \brief The file in which the precompiled preamble is stored.
     std::string PreambleFile;
 
+    /// \brief The shared preamble that owns \c PreambleFile, if any.
+    std::shared_ptr<SharedPreamble> Shared;
+
+    /// \brief The file system serving in-memory preambles, if the ASTUnit
+    /// keeps its preambles in memory.
+    IntrusiveRefCntPtr<InMemoryPreambleFileSystem> PreambleFS;
+
     /// \brief Temporary files that should be removed when the ASTUnit is
     /// destroyed.
     SmallVector<std::string, 4> TemporaryFiles;
@@ -159,6 +317,23 @@ static void setPreambleFile(const ASTUnit *AU, StringRef preambleFile) {
   getOnDiskData(AU).PreambleFile = preambleFile;
 }
 
+static void setSharedPreamble(const ASTUnit *AU,
+                              std::shared_ptr<SharedPreamble> Shared) {
+  OnDiskData &D = getOnDiskData(AU);
+  D.PreambleFile = Shared->PCHPath;
+  if (D.PreambleFS)
+    D.PreambleFS->setPreamble(Shared);
+  D.Shared = std::move(Shared);
+}
+
+static std::shared_ptr<SharedPreamble> getSharedPreamble(const ASTUnit *AU) {
+  return getOnDiskData(AU).Shared;
+}
+
+static InMemoryPreambleFileSystem *getInMemoryPreambleFS(const ASTUnit *AU) {
+  return getOnDiskData(AU).PreambleFS.get();
+}
+
 static const std::string &getPreambleFile(const ASTUnit *AU) {
   return getOnDiskData(AU).PreambleFile;  
 }
@@ -170,12 +345,110 @@ void OnDiskData::CleanTemporaryFiles() {
 }
 
 void OnDiskData::CleanPreambleFile() {
-  if (!PreambleFile.empty()) {
+  if (Shared) {
+    // The file is removed once the last ASTUnit using it lets go.
+    Shared.reset();
+    PreambleFile.clear();
+    if (PreambleFS)
+      PreambleFS->setPreamble(nullptr);
+  } else if (!PreambleFile.empty()) {
     llvm::sys::fs::remove(PreambleFile);
     PreambleFile.clear();
   }
 }
 
+/// \brief The process-wide store of precompiled preambles, keyed by
+/// \c getSharedPreambleKey().
+///
+/// Entries are weak so that a preamble goes away together with the last
+/// ASTUnit using it.
+typedef llvm::StringMap<std::weak_ptr<SharedPreamble>> SharedPreambleMap;
+
+static llvm::sys::SmartMutex<false> &getSharedPreambleMutex() {
+  static llvm::sys::SmartMutex<false> M;
+  return M;
+}
+
+static SharedPreambleMap &getSharedPreambleMap() {
+  static SharedPreambleMap M;
+  return M;
+}
+
+/// \brief Compute the key under which a preamble built by \p Invocation for
+/// the preamble \p PreambleBytes is stored.
+///
+/// Only the main file itself can reuse a preamble: the precompiled preamble
+/// records its main file, and quoted includes are resolved relative to it.
+static std::string getSharedPreambleKey(const CompilerInvocation &Invocation,
+                                        StringRef PreambleBytes,
+                                        bool PreambleEndsAtStartOfLine) {
+  std::string Key;
+  llvm::raw_string_ostream OS(Key);
+  auto Field = [&OS](StringRef S) { OS << S << '\0'; };
+
+  Field(Invocation.getFrontendOpts().Inputs[0].getFile());
+  Field(Invocation.getModuleHash());
+
+  const PreprocessorOptions &PPOpts = Invocation.getPreprocessorOpts();
+  for (const auto &Macro : PPOpts.Macros) {
+    Field(Macro.second ? "U" : "D");
+    Field(Macro.first);
+  }
+  for (const std::string &Include : PPOpts.Includes)
+    Field(Include);
+  for (const std::string &Include : PPOpts.MacroIncludes)
+    Field(Include);
+
+  const HeaderSearchOptions &HSOpts = Invocation.getHeaderSearchOpts();
+  for (const HeaderSearchOptions::Entry &E : HSOpts.UserEntries) {
+    Field(E.Path);
+    OS << unsigned(E.Group) << E.IsFramework << E.IgnoreSysRoot << '\0';
+  }
+  for (const HeaderSearchOptions::SystemHeaderPrefix &P :
+       HSOpts.SystemHeaderPrefixes) {
+    Field(P.Prefix);
+    OS << P.IsSystemHeader << '\0';
+  }
+
+  const DiagnosticOptions &DiagOpts = Invocation.getDiagnosticOpts();
+  for (const std::string &Warning : DiagOpts.Warnings)
+    Field(Warning);
+  for (const std::string &Remark : DiagOpts.Remarks)
+    Field(Remark);
+
+  OS << PreambleEndsAtStartOfLine << '\0';
+  OS << PreambleBytes;
+  return OS.str();
+}
+
+/// \brief Look up a live shared preamble for \p Key.
+static std::shared_ptr<SharedPreamble>
+lookupSharedPreamble(StringRef Key) {
+  llvm::MutexGuard Guard(getSharedPreambleMutex());
+  SharedPreambleMap &M = getSharedPreambleMap();
+  auto I = M.find(Key);
+  if (I == M.end())
+    return nullptr;
+  std::shared_ptr<SharedPreamble> Shared = I->second.lock();
+  if (!Shared)
+    M.erase(I);
+  return Shared;
+}
+
+/// \brief Publish \p Shared under \p Key, replacing any stale entry.
+static void publishSharedPreamble(StringRef Key,
+                                  const std::shared_ptr<SharedPreamble> &Shared) {
+  llvm::MutexGuard Guard(getSharedPreambleMutex());
+  SharedPreambleMap &M = getSharedPreambleMap();
+  // Drop entries whose preambles are gone so the map doesn't keep growing.
+  for (auto I = M.begin(), E = M.end(); I != E;) {
+    auto Cur = I++;
+    if (Cur->second.expired())
+      M.erase(Cur);
+  }
+  M[Key] = Shared;
+}
+
 void OnDiskData::Cleanup() {
   CleanTemporaryFiles();
   CleanPreambleFile();
@@ -207,6 +480,10 @@ void ASTUnit::addTemporaryFile(StringRef TempFile) {
 /// preamble.
 const unsigned DefaultPreambleRebuildInterval = 5;
 
+/// \brief The maximum number of precompiled preambles that an incrementally
+/// built preamble may be chained to before we rebuild it from scratch.
+const unsigned MaxPreambleChainLength = 4;
+
 /// \brief Tracks the number of ASTUnit objects that are currently active.
 ///
 /// Used for debugging purposes only.
@@ -223,6 +500,8 @@ ASTUnit::ASTUnit(bool _MainFileIsAST)
     NumWarningsInPreamble(0),
     ShouldCacheCodeCompletionResults(false),
     IncludeBriefCommentsInCodeCompletion(false), UserFilesAreVolatile(false),
+    SkipFunctionBodiesOutsideMainFile(false), FunctionBodyFocusStartLine(0),
+    FunctionBodyFocusEndLine(0),
     CompletionCacheTopLevelHashValue(0),
     PreambleTopLevelHashValue(0),
     CurrentTopLevelHashValue(0),
@@ -860,6 +1139,10 @@ public:
   // We're not interested in "interesting" decls.
   void HandleInterestingDecl(DeclGroupRef) override {}
 
+  bool shouldSkipFunctionBody(Decl *D) override {
+    return Unit.shouldSkipFunctionBody(D);
+  }
+
   void HandleTopLevelDeclInObjCContainer(DeclGroupRef D) override {
     for (Decl *TopLevelDecl : D)
       handleTopLevelDecl(TopLevelDecl);
@@ -899,10 +1182,14 @@ public:
 class PrecompilePreambleAction : public ASTFrontendAction {
   ASTUnit &Unit;
   bool HasEmittedPreamblePCH;
+  /// \brief If non-null, the preamble is written here rather than to the
+  /// output file.
+  std::string *InMemoryPCH;
 
 public:
-  explicit PrecompilePreambleAction(ASTUnit &Unit)
-      : Unit(Unit), HasEmittedPreamblePCH(false) {}
+  explicit PrecompilePreambleAction(ASTUnit &Unit,
+                                    std::string *InMemoryPCH = nullptr)
+      : Unit(Unit), HasEmittedPreamblePCH(false), InMemoryPCH(InMemoryPCH) {}
 
   std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
                                                  StringRef InFile) override;
@@ -981,10 +1268,15 @@ std::unique_ptr<ASTConsumer>
 PrecompilePreambleAction::CreateASTConsumer(CompilerInstance &CI,
                                             StringRef InFile) {
   std::string Sysroot;
-  std::string OutputFile;
-  std::unique_ptr<raw_ostream> OS =
-      GeneratePCHAction::ComputeASTConsumerArguments(CI, InFile, Sysroot,
-                                                     OutputFile);
+  std::unique_ptr<raw_ostream> OS;
+  if (InMemoryPCH) {
+    Sysroot = CI.getHeaderSearchOpts().Sysroot;
+    OS = llvm::make_unique<llvm::raw_string_ostream>(*InMemoryPCH);
+  } else {
+    std::string OutputFile;
+    OS = GeneratePCHAction::ComputeASTConsumerArguments(CI, InFile, Sysroot,
+                                                        OutputFile);
+  }
   if (!OS)
     return nullptr;
 
@@ -1080,6 +1372,9 @@ bool ASTUnit::Parse(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
   LangOpts = Clang->getInvocation().LangOpts;
   FileSystemOpts = Clang->getFileSystemOpts();
   if (!FileMgr) {
+    // Keep serving in-memory preambles through the new file manager.
+    if (InMemoryPreambleFileSystem *PreambleFS = getInMemoryPreambleFS(this))
+      Clang->setVirtualFileSystem(PreambleFS);
     Clang->createFileManager();
     FileMgr = &Clang->getFileManager();
   }
@@ -1182,6 +1477,17 @@ static std::string GetPreamblePCHPath() {
   return Path.str();
 }
 
+/// \brief Get a path under which an in-memory preamble can be served. Nothing
+/// is created on disk.
+static std::string GetInMemoryPreamblePCHPath() {
+  static std::atomic<unsigned> Counter;
+  SmallString<128> Path;
+  llvm::sys::path::system_temp_directory(/*ErasedOnReboot=*/true, Path);
+  llvm::sys::path::append(Path, "preamble-in-memory-" + Twine(++Counter) +
+                                    ".pch");
+  return Path.str();
+}
+
 /// \brief Compute the preamble for the main file, providing the source buffer
 /// that corresponds to the main file along with a pair (bytes, start-of-line)
 /// that describes the preamble.
@@ -1317,6 +1623,64 @@ makeStandaloneDiagnostic(const LangOptions &LangOpts,
   return OutDiag;
 }
 
+/// \brief Determine whether any of the files a precompiled preamble was built
+/// from differ from their state recorded in \p FilesInPreamble, taking the
+/// remappings in \p PPOpts into account.
+static bool havePreambleFilesChanged(
+    FileManager &FileMgr, const PreprocessorOptions &PPOpts,
+    const llvm::StringMap<ASTUnit::PreambleFileHash> &FilesInPreamble) {
+  // First, make a record of those files that have been overridden via
+  // remapping or unsaved_files.
+  std::map<llvm::sys::fs::UniqueID, ASTUnit::PreambleFileHash> OverriddenFiles;
+  for (const auto &R : PPOpts.RemappedFiles) {
+    vfs::Status Status;
+    if (FileMgr.getNoncachedStatValue(R.second, Status)) {
+      // If we can't stat the file we're remapping to, assume that something
+      // horrible happened.
+      return true;
+    }
+
+    OverriddenFiles[Status.getUniqueID()] =
+        ASTUnit::PreambleFileHash::createForFile(
+            Status.getSize(), Status.getLastModificationTime().toEpochTime());
+  }
+
+  for (const auto &RB : PPOpts.RemappedFileBuffers) {
+    vfs::Status Status;
+    if (FileMgr.getNoncachedStatValue(RB.first, Status))
+      return true;
+
+    OverriddenFiles[Status.getUniqueID()] =
+        ASTUnit::PreambleFileHash::createForMemoryBuffer(RB.second);
+  }
+
+  // Check whether anything has changed.
+  for (const auto &F : FilesInPreamble) {
+    vfs::Status Status;
+    if (FileMgr.getNoncachedStatValue(F.first(), Status)) {
+      // If we can't stat the file, assume that something horrible happened.
+      return true;
+    }
+
+    auto Overridden = OverriddenFiles.find(Status.getUniqueID());
+    if (Overridden != OverriddenFiles.end()) {
+      // This file was remapped; check whether the newly-mapped file
+      // matches up with the previous mapping.
+      if (Overridden->second != F.second)
+        return true;
+      continue;
+    }
+
+    // The file was not remapped; check whether it has changed on disk.
+    if (Status.getSize() != uint64_t(F.second.Size) ||
+        Status.getLastModificationTime().toEpochTime() !=
+            uint64_t(F.second.ModTime))
+      return true;
+  }
+
+  return false;
+}
+
 /// \brief Attempt to build or re-use a precompiled preamble when (re-)parsing
 /// the source file.
 ///
@@ -1351,6 +1715,11 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
 
   ComputedPreamble NewPreamble = ComputePreamble(*PreambleInvocation, MaxLines);
 
+  // The precompiled preamble to chain a new one to, if the new preamble only
+  // adds directives to the end of the old one.
+  std::shared_ptr<SharedPreamble> Base;
+  unsigned BasePreambleSize = 0;
+
   if (!NewPreamble.Size) {
     // We couldn't find a preamble in the main source. Clear out the current
     // preamble, if we have one. It's obviously no good any more.
@@ -1375,71 +1744,8 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
       // preamble.
 
       // Check that none of the files used by the preamble have changed.
-      bool AnyFileChanged = false;
-          
-      // First, make a record of those files that have been overridden via
-      // remapping or unsaved_files.
-      std::map<llvm::sys::fs::UniqueID, PreambleFileHash> OverriddenFiles;
-      for (const auto &R : PreprocessorOpts.RemappedFiles) {
-        if (AnyFileChanged)
-          break;
-
-        vfs::Status Status;
-        if (FileMgr->getNoncachedStatValue(R.second, Status)) {
-          // If we can't stat the file we're remapping to, assume that something
-          // horrible happened.
-          AnyFileChanged = true;
-          break;
-        }
-
-        OverriddenFiles[Status.getUniqueID()] = PreambleFileHash::createForFile(
-            Status.getSize(), Status.getLastModificationTime().toEpochTime());
-      }
-
-      for (const auto &RB : PreprocessorOpts.RemappedFileBuffers) {
-        if (AnyFileChanged)
-          break;
-
-        vfs::Status Status;
-        if (FileMgr->getNoncachedStatValue(RB.first, Status)) {
-          AnyFileChanged = true;
-          break;
-        }
-
-        OverriddenFiles[Status.getUniqueID()] =
-            PreambleFileHash::createForMemoryBuffer(RB.second);
-      }
-       
-      // Check whether anything has changed.
-      for (llvm::StringMap<PreambleFileHash>::iterator
-             F = FilesInPreamble.begin(), FEnd = FilesInPreamble.end();
-           !AnyFileChanged && F != FEnd; 
-           ++F) {
-        vfs::Status Status;
-        if (FileMgr->getNoncachedStatValue(F->first(), Status)) {
-          // If we can't stat the file, assume that something horrible happened.
-          AnyFileChanged = true;
-          break;
-        }
-
-        std::map<llvm::sys::fs::UniqueID, PreambleFileHash>::iterator Overridden
-          = OverriddenFiles.find(Status.getUniqueID());
-        if (Overridden != OverriddenFiles.end()) {
-          // This file was remapped; check whether the newly-mapped file 
-          // matches up with the previous mapping.
-          if (Overridden->second != F->second)
-            AnyFileChanged = true;
-          continue;
-        }
-        
-        // The file was not remapped; check whether it has changed on disk.
-        if (Status.getSize() != uint64_t(F->second.Size) ||
-            Status.getLastModificationTime().toEpochTime() !=
-                uint64_t(F->second.ModTime))
-          AnyFileChanged = true;
-      }
-          
-      if (!AnyFileChanged) {
+      if (!havePreambleFilesChanged(*FileMgr, PreprocessorOpts,
+                                    FilesInPreamble)) {
         // Okay! We can re-use the precompiled preamble.
 
         // Set the state of the diagnostic object to mimic its state
@@ -1459,6 +1765,24 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
     if (!AllowRebuild)
       return nullptr;
 
+    // If the old preamble is a prefix of the new one and its headers haven't
+    // changed, only the added directives need parsing; chain the old
+    // precompiled preamble in for everything else.
+    std::shared_ptr<SharedPreamble> Old = getSharedPreamble(this);
+    if (Old && Old->ChainLength < MaxPreambleChainLength &&
+        PreambleEndsAtStartOfLine && Preamble.size() < NewPreamble.Size &&
+        memcmp(Preamble.getBufferStart(), NewPreamble.Buffer->getBufferStart(),
+               Preamble.size()) == 0 &&
+        std::none_of(PreambleDiagnostics.begin(), PreambleDiagnostics.end(),
+                     [](const StandaloneDiagnostic &D) {
+                       return D.Level >= DiagnosticsEngine::Error;
+                     }) &&
+        !havePreambleFilesChanged(*FileMgr, PreprocessorOpts,
+                                  FilesInPreamble)) {
+      Base = std::move(Old);
+      BasePreambleSize = Preamble.size();
+    }
+
     // We can't reuse the previously-computed preamble. Build a new one.
     Preamble.clear();
     PreambleDiagnostics.clear();
@@ -1470,6 +1794,54 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
     return nullptr;
   }
 
+  // Another ASTUnit may already have precompiled this preamble. We can only
+  // read it from memory if we serve our preambles from memory too.
+  InMemoryPreambleFileSystem *PreambleFS = getInMemoryPreambleFS(this);
+  StringRef MainFilename = FrontendOpts.Inputs[0].getFile();
+  std::string SharedKey = getSharedPreambleKey(
+      *PreambleInvocation,
+      NewPreamble.Buffer->getBuffer().slice(0, NewPreamble.Size),
+      NewPreamble.PreambleEndsAtStartOfLine);
+  if (std::shared_ptr<SharedPreamble> Shared =
+          lookupSharedPreamble(SharedKey)) {
+    if ((!Shared->PCHBuffer || PreambleFS) &&
+        !havePreambleFilesChanged(*FileMgr, PreprocessorOpts,
+                                  Shared->FilesInPreamble)) {
+      Preamble.assign(FileMgr->getFile(MainFilename),
+                      NewPreamble.Buffer->getBufferStart(),
+                      NewPreamble.Buffer->getBufferStart() + NewPreamble.Size);
+      PreambleEndsAtStartOfLine = NewPreamble.PreambleEndsAtStartOfLine;
+      OriginalSourceFile = MainFilename;
+
+      // Set the state of the diagnostic object to mimic its state after
+      // parsing the preamble.
+      getDiagnostics().Reset();
+      ProcessWarningOptions(getDiagnostics(),
+                            PreambleInvocation->getDiagnosticOpts());
+      getDiagnostics().setNumWarnings(Shared->NumWarnings);
+      checkAndRemoveNonDriverDiags(StoredDiagnostics);
+
+      TopLevelDecls.clear();
+      TopLevelDeclsInPreamble = Shared->TopLevelDecls;
+      PreambleDiagnostics = Shared->Diagnostics;
+      NumWarningsInPreamble = Shared->NumWarnings;
+      FilesInPreamble.clear();
+      for (const auto &F : Shared->FilesInPreamble)
+        FilesInPreamble[F.first()] = F.second;
+      CurrentTopLevelHashValue = Shared->TopLevelHashValue;
+      setSharedPreamble(this, std::move(Shared));
+      PreambleRebuildCounter = 1;
+
+      if (CurrentTopLevelHashValue != PreambleTopLevelHashValue) {
+        CompletionCacheTopLevelHashValue = 0;
+        PreambleTopLevelHashValue = CurrentTopLevelHashValue;
+      }
+
+      return llvm::MemoryBuffer::getMemBufferCopy(
+          NewPreamble.Buffer->getBuffer(), MainFilename);
+    }
+  }
+
   // If the preamble rebuild counter > 1, it's because we previously
   // failed to build a preamble and we're not yet ready to try
   // again. Decrement the counter and return a failure.
@@ -1480,7 +1852,8 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
 
   // Create a temporary file for the precompiled preamble. In rare 
   // circumstances, this can fail.
-  std::string PreamblePCHPath = GetPreamblePCHPath();
+  std::string PreamblePCHPath =
+      PreambleFS ? GetInMemoryPreamblePCHPath() : GetPreamblePCHPath();
   if (PreamblePCHPath.empty()) {
     // Try again next time.
     PreambleRebuildCounter = 1;
@@ -1493,7 +1866,6 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
 
   // Save the preamble text for later; we'll need to compare against it for
   // subsequent reparses.
-  StringRef MainFilename = FrontendOpts.Inputs[0].getFile();
   Preamble.assign(FileMgr->getFile(MainFilename),
                   NewPreamble.Buffer->getBufferStart(),
                   NewPreamble.Buffer->getBufferStart() + NewPreamble.Size);
@@ -1508,10 +1880,18 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
 
   // Tell the compiler invocation to generate a temporary precompiled header.
   FrontendOpts.ProgramAction = frontend::GeneratePCH;
-  // FIXME: Generate the precompiled header into memory?
   FrontendOpts.OutputFile = PreamblePCHPath;
-  PreprocessorOpts.PrecompiledPreambleBytes.first = 0;
-  PreprocessorOpts.PrecompiledPreambleBytes.second = false;
+  if (Base) {
+    // Skip the part of the preamble that the base preamble already covers
+    // and load it from there instead; the new preamble chains to it.
+    PreprocessorOpts.PrecompiledPreambleBytes.first = BasePreambleSize;
+    PreprocessorOpts.PrecompiledPreambleBytes.second = true;
+    PreprocessorOpts.ImplicitPCHInclude = Base->PCHPath;
+    PreprocessorOpts.DisablePCHValidation = true;
+  } else {
+    PreprocessorOpts.PrecompiledPreambleBytes.first = 0;
+    PreprocessorOpts.PrecompiledPreambleBytes.second = false;
+  }
   
   // Create the compiler instance to use for building the precompiled preamble.
   std::unique_ptr<CompilerInstance> Clang(
@@ -1559,8 +1939,22 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
   TopLevelDeclsInPreamble.clear();
   PreambleDiagnostics.clear();
 
-  IntrusiveRefCntPtr<vfs::FileSystem> VFS =
-      createVFSFromCompilerInvocation(Clang->getInvocation(), getDiagnostics());
+  // Start from the state the base preamble left behind.
+  if (Base) {
+    getDiagnostics().setNumWarnings(Base->NumWarnings);
+    TopLevelDeclsInPreamble = Base->TopLevelDecls;
+    PreambleDiagnostics = Base->Diagnostics;
+  }
+
+  IntrusiveRefCntPtr<vfs::FileSystem> VFS;
+  if (Base && Base->PCHBuffer) {
+    // The base preamble is only reachable through our in-memory file system.
+    PreambleFS->setPreamble(Base);
+    VFS = PreambleFS;
+  } else {
+    VFS = createVFSFromCompilerInvocation(Clang->getInvocation(),
+                                          getDiagnostics());
+  }
   if (!VFS)
     return nullptr;
 
@@ -1574,12 +1968,15 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
   auto PreambleDepCollector = std::make_shared<DependencyCollector>();
   Clang->addDependencyCollector(PreambleDepCollector);
 
+  std::string InMemoryPCH;
   std::unique_ptr<PrecompilePreambleAction> Act;
-  Act.reset(new PrecompilePreambleAction(*this));
+  Act.reset(new PrecompilePreambleAction(*this,
+                                         PreambleFS ? &InMemoryPCH : nullptr));
   if (!Act->BeginSourceFile(*Clang.get(), Clang->getFrontendOpts().Inputs[0])) {
     llvm::sys::fs::remove(FrontendOpts.OutputFile);
     Preamble.clear();
-    PreambleRebuildCounter = DefaultPreambleRebuildInterval;
+    // If chaining failed, try again from scratch next time.
+    PreambleRebuildCounter = Base ? 1 : DefaultPreambleRebuildInterval;
     PreprocessorOpts.RemappedFileBuffers.pop_back();
     return nullptr;
   }
@@ -1605,13 +2002,11 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
     llvm::sys::fs::remove(FrontendOpts.OutputFile);
     Preamble.clear();
     TopLevelDeclsInPreamble.clear();
-    PreambleRebuildCounter = DefaultPreambleRebuildInterval;
+    PreambleRebuildCounter = Base ? 1 : DefaultPreambleRebuildInterval;
     PreprocessorOpts.RemappedFileBuffers.pop_back();
     return nullptr;
   }
   
-  // Keep track of the preamble we precompiled.
-  setPreambleFile(this, FrontendOpts.OutputFile);
   NumWarningsInPreamble = getDiagnostics().getNumWarnings();
   
   // Keep track of all of the files that the source manager knows about,
@@ -1622,6 +2017,8 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
     const FileEntry *File = Clang->getFileManager().getFile(Filename);
     if (!File || File == SourceMgr.getFileEntryForID(SourceMgr.getMainFileID()))
       continue;
+    if (Base && Base->isInChain(File->getName()))
+      continue;
     if (time_t ModTime = File->getModificationTime()) {
       FilesInPreamble[File->getName()] = PreambleFileHash::createForFile(
           File->getSize(), ModTime);
@@ -1631,6 +2028,34 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
           PreambleFileHash::createForMemoryBuffer(Buffer);
     }
   }
+  if (Base) {
+    for (const auto &F : Base->FilesInPreamble)
+      FilesInPreamble.insert(std::make_pair(F.first(), F.second));
+    CurrentTopLevelHashValue =
+        llvm::hash_combine(Base->TopLevelHashValue, CurrentTopLevelHashValue);
+  }
+
+  // Keep track of the preamble we precompiled, and offer it to other ASTUnits
+  // for the same file.
+  auto Shared = std::make_shared<SharedPreamble>();
+  Shared->PCHPath = FrontendOpts.OutputFile;
+  for (const auto &F : FilesInPreamble)
+    Shared->FilesInPreamble[F.first()] = F.second;
+  Shared->TopLevelDecls = TopLevelDeclsInPreamble;
+  Shared->Diagnostics = PreambleDiagnostics;
+  Shared->NumWarnings = NumWarningsInPreamble;
+  Shared->TopLevelHashValue = CurrentTopLevelHashValue;
+  if (PreambleFS) {
+    Shared->PCHBuffer = llvm::MemoryBuffer::getMemBufferCopy(
+        InMemoryPCH, FrontendOpts.OutputFile);
+    Shared->PCHUniqueID = vfs::getNextVirtualUniqueID();
+  }
+  if (Base) {
+    Shared->ChainLength = Base->ChainLength + 1;
+    Shared->Base = std::move(Base);
+  }
+  publishSharedPreamble(SharedKey, Shared);
+  setSharedPreamble(this, std::move(Shared));
 
   PreambleRebuildCounter = 1;
   PreprocessorOpts.RemappedFileBuffers.pop_back();
@@ -1946,7 +2371,8 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
     bool CacheCodeCompletionResults, bool IncludeBriefCommentsInCodeCompletion,
     bool AllowPCHWithCompilerErrors, bool SkipFunctionBodies,
     bool UserFilesAreVolatile, bool ForSerialization,
-    llvm::Optional<StringRef> ModuleFormat, std::unique_ptr<ASTUnit> *ErrAST) {
+    llvm::Optional<StringRef> ModuleFormat, bool StorePreamblesInMemory,
+    bool SkipFunctionBodiesOutsideMainFile, std::unique_ptr<ASTUnit> *ErrAST) {
   assert(Diags.get() && "no DiagnosticsEngine was provided");
 
   SmallVector<StoredDiagnostic, 4> StoredDiagnostics;
@@ -1977,7 +2403,8 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
   // Override the resources path.
   CI->getHeaderSearchOpts().ResourceDir = ResourceFilesPath;
 
-  CI->getFrontendOpts().SkipFunctionBodies = SkipFunctionBodies;
+  CI->getFrontendOpts().SkipFunctionBodies =
+      SkipFunctionBodies || SkipFunctionBodiesOutsideMainFile;
 
   if (ModuleFormat)
     CI->getHeaderSearchOpts().ModuleFormat = ModuleFormat.getValue();
@@ -1992,6 +2419,12 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
       createVFSFromCompilerInvocation(*CI, *Diags);
   if (!VFS)
     return nullptr;
+  if (StorePreamblesInMemory) {
+    IntrusiveRefCntPtr<InMemoryPreambleFileSystem> PreambleFS =
+        new InMemoryPreambleFileSystem(VFS);
+    getOnDiskData(AST.get()).PreambleFS = PreambleFS;
+    VFS = PreambleFS;
+  }
   AST->FileMgr = new FileManager(AST->FileSystemOpts, VFS);
   AST->OnlyLocalDecls = OnlyLocalDecls;
   AST->CaptureDiagnostics = CaptureDiagnostics;
@@ -2000,6 +2433,8 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
   AST->IncludeBriefCommentsInCodeCompletion
     = IncludeBriefCommentsInCodeCompletion;
   AST->UserFilesAreVolatile = UserFilesAreVolatile;
+  AST->SkipFunctionBodiesOutsideMainFile =
+      SkipFunctionBodiesOutsideMainFile && !SkipFunctionBodies;
   AST->NumStoredDiagnosticsFromDriver = StoredDiagnostics.size();
   AST->StoredDiagnostics.swap(StoredDiagnostics);
   AST->Invocation = CI;
@@ -2079,6 +2514,72 @@ bool ASTUnit::Reparse(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
   return Result;
 }
 
+std::unique_ptr<ASTUnit> ASTUnit::ReparseAsNewUnit(
+    std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+    ArrayRef<RemappedFile> RemappedFiles) {
+  if (!Invocation)
+    return nullptr;
+
+  // The remapped buffers of the invocation belong to this unit; the new unit
+  // gets its own.
+  IntrusiveRefCntPtr<CompilerInvocation> CI(
+      new CompilerInvocation(*Invocation));
+  CI->getPreprocessorOpts().clearRemappedFiles();
+  for (const auto &RemappedFile : RemappedFiles)
+    CI->getPreprocessorOpts().addRemappedFile(RemappedFile.first,
+                                              RemappedFile.second);
+
+  // Nothing that this unit's readers may be using is shared with the new
+  // unit: it gets its own diagnostics engine and file manager.
+  IntrusiveRefCntPtr<DiagnosticsEngine> Diags =
+      CompilerInstance::createDiagnostics(new DiagnosticOptions);
+  IntrusiveRefCntPtr<vfs::FileSystem> VFS =
+      createVFSFromCompilerInvocation(*CI, *Diags);
+  if (!VFS)
+    return nullptr;
+
+  std::unique_ptr<ASTUnit> AST(new ASTUnit(false));
+  ConfigureDiags(Diags, *AST, CaptureDiagnostics);
+  AST->Diagnostics = Diags;
+  AST->FileSystemOpts = CI->getFileSystemOpts();
+  if (getInMemoryPreambleFS(this)) {
+    IntrusiveRefCntPtr<InMemoryPreambleFileSystem> PreambleFS =
+        new InMemoryPreambleFileSystem(VFS);
+    getOnDiskData(AST.get()).PreambleFS = PreambleFS;
+    VFS = PreambleFS;
+  }
+  AST->FileMgr = new FileManager(AST->FileSystemOpts, VFS);
+  AST->OnlyLocalDecls = OnlyLocalDecls;
+  AST->CaptureDiagnostics = CaptureDiagnostics;
+  AST->TUKind = TUKind;
+  AST->ShouldCacheCodeCompletionResults = ShouldCacheCodeCompletionResults;
+  AST->IncludeBriefCommentsInCodeCompletion =
+      IncludeBriefCommentsInCodeCompletion;
+  AST->UserFilesAreVolatile = UserFilesAreVolatile;
+  AST->SkipFunctionBodiesOutsideMainFile = SkipFunctionBodiesOutsideMainFile;
+  AST->FunctionBodyFocusStartLine = FunctionBodyFocusStartLine;
+  AST->FunctionBodyFocusEndLine = FunctionBodyFocusEndLine;
+  AST->Invocation = CI;
+  if (WriterData)
+    AST->WriterData.reset(new ASTWriterData());
+  CI = nullptr;
+  Diags = nullptr;
+
+  // Recover resources if we crash before exiting this method.
+  llvm::CrashRecoveryContextCleanupRegistrar<ASTUnit>
+    ASTUnitCleanup(AST.get());
+
+  // If this unit has a preamble, or is about to get one, make the new unit
+  // build one right away; it adopts this unit's preamble if it still
+  // applies.
+  bool WantsPreamble =
+      !getPreambleFile(this).empty() || PreambleRebuildCounter > 0;
+  if (AST->LoadFromCompilerInvocation(std::move(PCHContainerOps),
+                                      WantsPreamble ? 1 : 0))
+    return nullptr;
+  return AST;
+}
+
 //----------------------------------------------------------------------------//
 // Code completion
 //----------------------------------------------------------------------------//
@@ -2576,6 +3077,64 @@ void ASTUnit::TranslateStoredDiagnostics(
   Result.swap(Out);
 }
 
+/// \brief Find the line on which the body of a function ends, by raw-lexing
+/// from the end of its declarator to the brace that closes the first brace
+/// found.
+///
+/// This is a heuristic: braces inside constructor initializers are taken for
+/// the body.
+///
+/// \returns the line of the closing brace, or 0 if it was not found.
+static unsigned getFunctionBodyEndLine(SourceManager &SM,
+                                       const LangOptions &LangOpts,
+                                       SourceLocation DeclaratorEnd) {
+  FileID FID;
+  unsigned Offset;
+  std::tie(FID, Offset) = SM.getDecomposedLoc(DeclaratorEnd);
+  bool Invalid = false;
+  StringRef Buffer = SM.getBufferData(FID, &Invalid);
+  if (Invalid)
+    return 0;
+
+  Lexer RawLex(SM.getLocForStartOfFile(FID), LangOpts, Buffer.begin(),
+               Buffer.begin() + Offset, Buffer.end());
+  unsigned Depth = 0;
+  Token Tok;
+  do {
+    RawLex.LexFromRawLexer(Tok);
+    if (Tok.is(tok::l_brace))
+      ++Depth;
+    else if (Tok.is(tok::r_brace) && Depth && --Depth == 0)
+      return SM.getSpellingLineNumber(Tok.getLocation());
+  } while (Tok.isNot(tok::eof));
+  return 0;
+}
+
+bool ASTUnit::shouldSkipFunctionBody(Decl *D) {
+  if (!SkipFunctionBodiesOutsideMainFile)
+    return true;
+
+  SourceManager &SM = *SourceMgr;
+  SourceLocation Begin = D->getLocStart();
+  SourceLocation End = D->getLocEnd();
+  if (!SM.isInMainFile(SM.getExpansionLoc(Begin)))
+    return true;
+  if (!FunctionBodyFocusStartLine && !FunctionBodyFocusEndLine)
+    return false;
+
+  // Don't bother finding out where functions produced by macro expansions
+  // end; just parse them.
+  if (Begin.isMacroID() || End.isMacroID())
+    return false;
+
+  if (FunctionBodyFocusEndLine &&
+      SM.getSpellingLineNumber(Begin) > FunctionBodyFocusEndLine)
+    return true;
+  unsigned BodyEndLine =
+      getFunctionBodyEndLine(SM, D->getASTContext().getLangOpts(), End);
+  return BodyEndLine && BodyEndLine < FunctionBodyFocusStartLine;
+}
+
 void ASTUnit::addFileLevelDecl(Decl *D) {
   assert(D);
   
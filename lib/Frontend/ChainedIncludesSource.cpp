@@ -167,8 +167,8 @@ IntrusiveRefCntPtr<ExternalSemaSource> clang::createChainedIncludesSource(
     Clang->setASTConsumer(std::move(consumer));
     Clang->createSema(TU_Prefix, nullptr);
 
+    Preprocessor &PP = Clang->getPreprocessor();
     if (firstInclude) {
-      Preprocessor &PP = Clang->getPreprocessor();
       PP.getBuiltinInfo().initializeBuiltins(PP.getIdentifierTable(),
                                              PP.getLangOpts());
     } else {
@@ -191,6 +191,8 @@ IntrusiveRefCntPtr<ExternalSemaSource> clang::createChainedIncludesSource(
         return nullptr;
       Clang->setModuleManager(Reader);
       Clang->getASTContext().setExternalSource(Reader);
+      PP.getBuiltinInfo().initializeLazyBuiltins(PP.getIdentifierTable(),
+                                                 PP.getLangOpts());
     }
     
     if (!Clang->InitializeSourceManager(InputFile))
@@ -15,6 +15,7 @@
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Basic/Version.h"
 #include "clang/Config/config.h"
 #include "clang/Frontend/ChainedDiagnosticConsumer.h"
@@ -34,6 +35,7 @@
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/FileSystem.h"
@@ -45,9 +47,11 @@
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <sys/stat.h>
 #include <system_error>
 #include <time.h>
+#include <tuple>
 #include <utility>
 
 using namespace clang;
@@ -350,6 +354,10 @@ void CompilerInstance::createPreprocessor(TranslationUnitKind TUKind) {
   if (!DepOpts.DOTOutputFile.empty())
     AttachDependencyGraphGen(*PP, DepOpts.DOTOutputFile,
                              getHeaderSearchOpts().Sysroot);
+  if (!DepOpts.HeaderCostOutputFile.empty())
+    AttachHeaderCostGen(*PP, DepOpts.HeaderCostOutputFile, [this]() -> size_t {
+      return hasASTContext() ? getASTContext().getASTAllocatedMemory() : 0;
+    });
 
   // If we don't have a collector, but we are collecting module dependencies,
   // then we're the top level compiler instance and need to create one.
@@ -545,6 +553,19 @@ void CompilerInstance::addOutputFile(OutputFile &&OutFile) {
   OutputFiles.push_back(std::move(OutFile));
 }
 
+/// \brief Determine whether the two given files have identical contents.
+static bool haveSameContents(StringRef LHS, StringRef RHS) {
+  uint64_t LHSSize, RHSSize;
+  if (llvm::sys::fs::file_size(LHS, LHSSize) ||
+      llvm::sys::fs::file_size(RHS, RHSSize) || LHSSize != RHSSize)
+    return false;
+
+  auto LHSBuf = llvm::MemoryBuffer::getFile(LHS, -1, false);
+  auto RHSBuf = llvm::MemoryBuffer::getFile(RHS, -1, false);
+  return LHSBuf && RHSBuf &&
+         (*LHSBuf)->getBuffer() == (*RHSBuf)->getBuffer();
+}
+
 void CompilerInstance::clearOutputFiles(bool EraseFiles) {
   for (OutputFile &OF : OutputFiles) {
     if (!OF.TempFilename.empty()) {
@@ -556,6 +577,15 @@ void CompilerInstance::clearOutputFiles(bool EraseFiles) {
         // If '-working-directory' was passed, the output filename should be
         // relative to that.
         FileMgr->FixupRelativePath(NewOutFile);
+
+        // Leave an identical output alone, so that its modification time
+        // (and anything keyed on it) doesn't change.
+        if (OF.PreserveIfUnchanged &&
+            haveSameContents(OF.TempFilename, NewOutFile)) {
+          llvm::sys::fs::remove(OF.TempFilename);
+          continue;
+        }
+
         if (std::error_code ec =
                 llvm::sys::fs::rename(OF.TempFilename, NewOutFile)) {
           getDiagnostics().Report(diag::err_unable_to_rename_temp)
@@ -587,7 +617,8 @@ std::unique_ptr<raw_pwrite_stream>
 CompilerInstance::createOutputFile(StringRef OutputPath, bool Binary,
                                    bool RemoveFileOnSignal, StringRef InFile,
                                    StringRef Extension, bool UseTemporary,
-                                   bool CreateMissingDirectories) {
+                                   bool CreateMissingDirectories,
+                                   bool PreserveIfUnchanged) {
   std::string OutputPathName, TempPathName;
   std::error_code EC;
   std::unique_ptr<raw_pwrite_stream> OS = createOutputFile(
@@ -602,7 +633,8 @@ CompilerInstance::createOutputFile(StringRef OutputPath, bool Binary,
   // Add the output file -- but don't try to remove "-", since this means we are
   // using stdin.
   addOutputFile(
-      OutputFile((OutputPathName != "-") ? OutputPathName : "", TempPathName));
+      OutputFile((OutputPathName != "-") ? OutputPathName : "", TempPathName,
+                 PreserveIfUnchanged));
 
   return OS;
 }
@@ -1031,6 +1063,11 @@ static bool compileModuleImpl(CompilerInstance &ImportingInstance,
 
   // Execute the action to actually build the module in-place. Use a separate
   // thread so that we get a stack large enough.
+  // FIXME: The importing instance blocks until the module is built, so
+  // independent modules are only built concurrently by separate processes.
+  // Running several of these threads at once would require giving each module
+  // build its own FileManager and diagnostic client, as neither is
+  // thread-safe.
   const unsigned ThreadStackSize = 8 << 20;
   llvm::CrashRecoveryContext CRC;
   CRC.RunSafelyOnThread([&]() { Instance.ExecuteAction(CreateModuleAction); },
@@ -1195,8 +1232,113 @@ static void writeTimestampFile(StringRef TimestampFile) {
   llvm::raw_fd_ostream Out(TimestampFile.str(), EC, llvm::sys::fs::F_None);
 }
 
+/// \brief Get the path of the access log of the given module cache.
+static SmallString<128> getModuleCacheAccessLog(StringRef ModuleCachePath) {
+  SmallString<128> AccessLog(ModuleCachePath);
+  llvm::sys::path::append(AccessLog, "modules.access");
+  return AccessLog;
+}
+
+/// \brief Get the name by which the access log refers to a module file: its
+/// path relative to the module cache, which is always one directory deep.
+static std::string getModuleCacheEntryName(StringRef Path) {
+  return (llvm::sys::path::filename(llvm::sys::path::parent_path(Path)) +
+          "/" + llvm::sys::path::filename(Path)).str();
+}
+
+void CompilerInstance::logModuleCacheAccesses() {
+  const HeaderSearchOptions &HSOpts = getHeaderSearchOpts();
+  if (!HSOpts.ModuleCacheMaxSize || HSOpts.ModuleCachePath.empty() ||
+      !ModuleManager)
+    return;
+
+  std::string Entries;
+  for (ModuleFile *MF : ModuleManager->getModuleManager())
+    if (MF->Kind == serialization::MK_ImplicitModule)
+      Entries += getModuleCacheEntryName(MF->FileName) + "\n";
+  if (Entries.empty())
+    return;
+
+  // Append all of the entries at once, so that the entries of concurrent
+  // compilations do not interleave.
+  std::error_code EC;
+  llvm::raw_fd_ostream Out(getModuleCacheAccessLog(HSOpts.ModuleCachePath),
+                           EC, llvm::sys::fs::F_Append | llvm::sys::fs::F_Text);
+  if (!EC)
+    Out << Entries;
+}
+
+namespace {
+/// \brief A module file that survived the pruning of unused module files.
+struct CachedModuleFile {
+  std::string Path;
+  uint64_t Size;
+  time_t ModTime;
+
+  /// \brief The position of the last entry for this file in the access log,
+  /// starting at 1, or 0 if it has none.
+  unsigned LastAccess;
+};
+} // end anonymous namespace
+
+/// \brief Remove the least recently used module files until the module cache
+/// fits in its size limit, then rewrite the access log to list only the
+/// remaining ones.
+///
+/// \param TotalSize The size of all of the module files in \p Files.
+static void pruneModuleCacheToSize(const HeaderSearchOptions &HSOpts,
+                                   std::vector<CachedModuleFile> &Files,
+                                   uint64_t TotalSize) {
+  SmallString<128> AccessLog = getModuleCacheAccessLog(HSOpts.ModuleCachePath);
+
+  // Order the module files by their last use. Those that were never logged
+  // come first, oldest first.
+  llvm::StringMap<unsigned> LastAccess;
+  if (llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+          llvm::MemoryBuffer::getFile(AccessLog)) {
+    SmallVector<StringRef, 64> Lines;
+    (*Buffer)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                                 /*KeepEmpty=*/false);
+    for (unsigned I = 0, N = Lines.size(); I != N; ++I)
+      LastAccess[Lines[I]] = I + 1;
+  }
+  for (CachedModuleFile &File : Files)
+    File.LastAccess = LastAccess.lookup(getModuleCacheEntryName(File.Path));
+  std::sort(Files.begin(), Files.end(),
+            [](const CachedModuleFile &LHS, const CachedModuleFile &RHS) {
+              return std::tie(LHS.LastAccess, LHS.ModTime) <
+                     std::tie(RHS.LastAccess, RHS.ModTime);
+            });
+
+  unsigned NumRemoved = 0;
+  for (unsigned N = Files.size();
+       NumRemoved != N && TotalSize > HSOpts.ModuleCacheMaxSize;
+       ++NumRemoved) {
+    llvm::sys::fs::remove(Files[NumRemoved].Path);
+    llvm::sys::fs::remove(Files[NumRemoved].Path + ".timestamp");
+    TotalSize -= Files[NumRemoved].Size;
+  }
+
+  // Rewrite the access log so that it does not grow without bound. Entries
+  // appended in the meantime are lost, which only makes those module files
+  // look older than they are.
+  SmallString<128> AccessLogTmp;
+  int TmpFD;
+  if (llvm::sys::fs::createUniqueFile(AccessLog + "-%%%%%%%%", TmpFD,
+                                      AccessLogTmp))
+    return;
+  {
+    llvm::raw_fd_ostream Out(TmpFD, /*shouldClose=*/true);
+    for (unsigned I = NumRemoved, N = Files.size(); I != N; ++I)
+      if (Files[I].LastAccess)
+        Out << getModuleCacheEntryName(Files[I].Path) << '\n';
+  }
+  if (llvm::sys::fs::rename(AccessLogTmp, AccessLog))
+    llvm::sys::fs::remove(AccessLogTmp);
+}
+
 /// \brief Prune the module cache of modules that haven't been accessed in
-/// a long time.
+/// a long time, and of the least recently used ones if it is too large.
 static void pruneModuleCache(const HeaderSearchOptions &HSOpts) {
   struct stat StatBuf;
   llvm::SmallString<128> TimestampFile;
@@ -1227,6 +1369,8 @@ static void pruneModuleCache(const HeaderSearchOptions &HSOpts) {
 
   // Walk the entire module cache, looking for unused module files and module
   // indices.
+  std::vector<CachedModuleFile> RemainingFiles;
+  uint64_t RemainingSize = 0;
   std::error_code EC;
   SmallString<128> ModuleCachePathNative;
   llvm::sys::path::native(HSOpts.ModuleCachePath, ModuleCachePathNative);
@@ -1254,6 +1398,11 @@ static void pruneModuleCache(const HeaderSearchOptions &HSOpts) {
       time_t FileAccessTime = StatBuf.st_atime;
       if (CurrentTime - FileAccessTime <=
               time_t(HSOpts.ModuleCachePruneAfter)) {
+        if (Extension == ".pcm") {
+          RemainingFiles.push_back({File->path(), uint64_t(StatBuf.st_size),
+                                    StatBuf.st_mtime, 0});
+          RemainingSize += StatBuf.st_size;
+        }
         continue;
       }
 
@@ -1271,6 +1420,9 @@ static void pruneModuleCache(const HeaderSearchOptions &HSOpts) {
             llvm::sys::fs::directory_iterator() && !EC)
       llvm::sys::fs::remove(Dir->path());
   }
+
+  if (HSOpts.ModuleCacheMaxSize)
+    pruneModuleCacheToSize(HSOpts, RemainingFiles, RemainingSize);
 }
 
 void CompilerInstance::createModuleManager() {
@@ -1405,6 +1557,7 @@ CompilerInstance::loadModule(SourceLocation ImportLoc,
   // Determine what file we're searching from.
   StringRef ModuleName = Path[0].first->getName();
   SourceLocation ModuleNameLoc = Path[0].second;
+  TimeTraceScope TraceScope("LoadModule", ModuleName);
 
   // If we've already handled this import, just return the cached result.
   // This one-element cache is important to eliminate redundant diagnostics
@@ -38,6 +38,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Target/TargetOptions.h"
@@ -400,6 +401,22 @@ static void setPGOInstrumentor(CodeGenOptions &Opts, ArgList &Args,
 }
 
 // Set the profile kind using fprofile-instrument-use-path.
+/// The profile shard in \p ShardDir for the translation unit whose main file
+/// is \p MainFile: an indexed profile named after the MD5 of the main file's
+/// path, as it is given on the command line.
+static std::string getProfileShardPath(StringRef ShardDir, StringRef MainFile) {
+  llvm::MD5 Hash;
+  llvm::MD5::MD5Result Result;
+  Hash.update(MainFile);
+  Hash.final(Result);
+  SmallString<32> Name;
+  llvm::MD5::stringifyResult(Result, Name);
+
+  SmallString<256> Path(ShardDir);
+  llvm::sys::path::append(Path, Twine(Name) + ".profdata");
+  return Path.str();
+}
+
 static void setPGOUseInstrumentor(CodeGenOptions &Opts,
                                   const Twine &ProfileName) {
   auto ReaderOrErr = llvm::IndexedInstrProfReader::create(ProfileName);
@@ -496,6 +513,7 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
   Opts.LTOVisibilityPublicStd = Args.hasArg(OPT_flto_visibility_public_std);
   Opts.SplitDwarfFile = Args.getLastArgValue(OPT_split_dwarf_file);
   Opts.DebugTypeExtRefs = Args.hasArg(OPT_dwarf_ext_refs);
+  Opts.DebugTypeCacheDir = Args.getLastArgValue(OPT_fdebug_type_cache_EQ);
   Opts.DebugExplicitImport = Triple.isPS4CPU();
 
   for (const auto &Arg : Args.getAllArgValues(OPT_fdebug_prefix_map_EQ))
@@ -507,6 +525,11 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
 
   Opts.DisableLLVMOpts = Args.hasArg(OPT_disable_llvm_optzns);
   Opts.DisableLLVMPasses = Args.hasArg(OPT_disable_llvm_passes);
+  Opts.EarlyFunctionPasses = Args.hasArg(OPT_fearly_function_passes);
+  Opts.PruneDeferredDefinitions = Args.hasArg(OPT_fprune_deferred_definitions);
+  Opts.DiscardASTBodiesAfterCodeGen =
+      Args.hasArg(OPT_fdiscard_ast_bodies_after_codegen);
+  Opts.ScalarizeAggregateCopies = Args.hasArg(OPT_fscalarize_aggregate_copies);
   Opts.DisableRedZone = Args.hasArg(OPT_disable_red_zone);
   Opts.ForbidGuardVariables = Args.hasArg(OPT_fforbid_guard_variables);
   Opts.UseRegisterSizedBitfieldAccess = Args.hasArg(
@@ -536,8 +559,22 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
       Args.getLastArgValue(OPT_fprofile_instrument_path_EQ);
   Opts.ProfileInstrumentUsePath =
       Args.getLastArgValue(OPT_fprofile_instrument_use_path_EQ);
+  // With a shard directory, only the records for this translation unit's
+  // functions are loaded, from its own shard. If it has none, it has no
+  // profile data, unless there is a whole profile to fall back on.
+  if (Arg *A = Args.getLastArg(OPT_fprofile_instrument_use_shard_dir_EQ)) {
+    std::vector<std::string> Inputs = Args.getAllArgValues(OPT_INPUT);
+    if (!Inputs.empty()) {
+      std::string Shard = getProfileShardPath(A->getValue(), Inputs.front());
+      if (llvm::sys::fs::exists(Shard))
+        Opts.ProfileInstrumentUsePath = Shard;
+    }
+  }
   if (!Opts.ProfileInstrumentUsePath.empty())
     setPGOUseInstrumentor(Opts, Opts.ProfileInstrumentUsePath);
+  Opts.ProfileHotColdSections = Args.hasArg(OPT_fprofile_hot_cold_sections);
+  Opts.ProfileFunctionOrderFile =
+      Args.getLastArgValue(OPT_fprofile_function_order_EQ);
 
   Opts.CoverageMapping =
       Args.hasFlag(OPT_fcoverage_mapping, OPT_fno_coverage_mapping, false);
@@ -570,6 +607,10 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
   Opts.NoZeroInitializedInBSS = Args.hasArg(OPT_mno_zero_initialized_in_bss);
   Opts.BackendOptions = Args.getAllArgValues(OPT_backend_option);
   Opts.NumRegisterParameters = getLastArgIntValue(Args, OPT_mregparm, 0, Diags);
+  Opts.ParallelCodeGenPartitions =
+      getLastArgIntValue(Args, OPT_fparallel_codegen_EQ, 1, Diags);
+  Opts.CXXGlobalInitChunkSize =
+      getLastArgIntValue(Args, OPT_fcxx_global_init_chunk_size_EQ, 0, Diags);
   Opts.NoExecStack = Args.hasArg(OPT_mno_exec_stack);
   Opts.FatalWarnings = Args.hasArg(OPT_massembler_fatal_warnings);
   Opts.EnableSegmentedStacks = Args.hasArg(OPT_split_stacks);
@@ -860,6 +901,7 @@ static void ParseDependencyOutputArgs(DependencyOutputOptions &Opts,
   Opts.AddMissingHeaderDeps = Args.hasArg(OPT_MG);
   Opts.PrintShowIncludes = Args.hasArg(OPT_show_includes);
   Opts.DOTOutputFile = Args.getLastArgValue(OPT_dependency_dot);
+  Opts.HeaderCostOutputFile = Args.getLastArgValue(OPT_header_cost_file);
   Opts.ModuleDependencyOutputDir =
       Args.getLastArgValue(OPT_module_dependency_dir);
   if (Args.hasArg(OPT_MV))
@@ -1009,6 +1051,8 @@ bool clang::ParseDiagnosticArgs(DiagnosticOptions &Opts, ArgList &Args,
   Opts.setVerifyIgnoreUnexpected(DiagMask);
   Opts.ElideType = !Args.hasArg(OPT_fno_elide_type);
   Opts.ShowTemplateTree = Args.hasArg(OPT_fdiagnostics_show_template_tree);
+  Opts.DeduplicateHeaderDiagnostics =
+      Args.hasArg(OPT_fdiagnostics_dedup_headers);
   Opts.ErrorLimit = getLastArgIntValue(Args, OPT_ferror_limit, 0, Diags);
   Opts.MacroBacktraceLimit =
       getLastArgIntValue(Args, OPT_fmacro_backtrace_limit,
@@ -1077,6 +1121,7 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       Opts.ProgramAction = frontend::ASTDeclList; break;
     case OPT_ast_dump:
     case OPT_ast_dump_lookups:
+    case OPT_ast_dump_json:
       Opts.ProgramAction = frontend::ASTDump; break;
     case OPT_ast_print:
       Opts.ProgramAction = frontend::ASTPrint; break;
@@ -1137,6 +1182,8 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       Opts.ProgramAction = frontend::MigrateSource; break;
     case OPT_Eonly:
       Opts.ProgramAction = frontend::RunPreprocessorOnly; break;
+    case OPT_scan_dependencies:
+      Opts.ProgramAction = frontend::ScanDependencies; break;
     }
   }
 
@@ -1184,6 +1231,15 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.ShowHelp = Args.hasArg(OPT_help);
   Opts.ShowStats = Args.hasArg(OPT_print_stats);
   Opts.ShowTimers = Args.hasArg(OPT_ftime_report);
+  Opts.TimeTracePath = Args.getLastArgValue(OPT_ftime_trace_EQ);
+  Opts.CompileTimeBudget =
+      getLastArgIntValue(Args, OPT_fcompile_time_budget_EQ, 0, Diags);
+  Opts.CompileTimeBudgetReportPath =
+      Args.getLastArgValue(OPT_fcompile_time_budget_report_EQ);
+  Opts.CompileTimeBudgetAbort = Args.hasArg(OPT_fcompile_time_budget_abort);
+  Opts.StatsJSONPath = Args.getLastArgValue(OPT_print_stats_json_EQ);
+  Opts.GenerateHeaderMapPath = Args.getLastArgValue(OPT_gen_header_map);
+  Opts.IndexStorePath = Args.getLastArgValue(OPT_index_store_path);
   Opts.ShowVersion = Args.hasArg(OPT_version);
   Opts.ASTMergeFiles = Args.getAllArgValues(OPT_ast_merge);
   Opts.LLVMArgs = Args.getAllArgValues(OPT_mllvm);
@@ -1194,6 +1250,7 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.ASTDumpDecls = Args.hasArg(OPT_ast_dump);
   Opts.ASTDumpFilter = Args.getLastArgValue(OPT_ast_dump_filter);
   Opts.ASTDumpLookups = Args.hasArg(OPT_ast_dump_lookups);
+  Opts.ASTDumpJSON = Args.hasArg(OPT_ast_dump_json);
   Opts.UseGlobalModuleIndex = !Args.hasArg(OPT_fno_modules_global_index);
   Opts.GenerateGlobalModuleIndex = Opts.UseGlobalModuleIndex;
   Opts.ModuleMapFiles = Args.getAllArgValues(OPT_fmodule_map_file);
@@ -1201,6 +1258,7 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.ModulesEmbedFiles = Args.getAllArgValues(OPT_fmodules_embed_file_EQ);
   Opts.ModulesEmbedAllFiles = Args.hasArg(OPT_fmodules_embed_all_files);
   Opts.IncludeTimestamps = !Args.hasArg(OPT_fno_pch_timestamp);
+  Opts.PreserveUnchangedPCH = Args.hasArg(OPT_fpch_preserve_unchanged);
 
   Opts.CodeCompleteOpts.IncludeMacros
     = Args.hasArg(OPT_code_completion_macros);
@@ -1360,6 +1418,11 @@ static void ParseHeaderSearchArgs(HeaderSearchOptions &Opts, ArgList &Args) {
   Opts.ResourceDir = Args.getLastArgValue(OPT_resource_dir);
   Opts.ModuleCachePath = Args.getLastArgValue(OPT_fmodules_cache_path);
   Opts.ModuleUserBuildPath = Args.getLastArgValue(OPT_fmodules_user_build_path);
+  Opts.IncludeGuardCachePath =
+      Args.getLastArgValue(OPT_finclude_guard_cache_EQ);
+  Opts.ModuleMapCachePath = Args.getLastArgValue(OPT_fmodule_map_cache_EQ);
+  Opts.UseDirectoryListingCache =
+      Args.hasArg(OPT_fheader_search_directory_cache);
   Opts.DisableModuleHash = Args.hasArg(OPT_fdisable_module_hash);
   Opts.ImplicitModuleMaps = Args.hasArg(OPT_fimplicit_module_maps);
   Opts.ModuleMapFileHomeIsCwd = Args.hasArg(OPT_fmodule_map_file_home_is_cwd);
@@ -1367,12 +1430,16 @@ static void ParseHeaderSearchArgs(HeaderSearchOptions &Opts, ArgList &Args) {
       getLastArgIntValue(Args, OPT_fmodules_prune_interval, 7 * 24 * 60 * 60);
   Opts.ModuleCachePruneAfter =
       getLastArgIntValue(Args, OPT_fmodules_prune_after, 31 * 24 * 60 * 60);
+  Opts.ModuleCacheMaxSize =
+      getLastArgUInt64Value(Args, OPT_fmodules_cache_max_size, 0);
   Opts.ModulesValidateOncePerBuildSession =
       Args.hasArg(OPT_fmodules_validate_once_per_build_session);
   Opts.BuildSessionTimestamp =
       getLastArgUInt64Value(Args, OPT_fbuild_session_timestamp, 0);
   Opts.ModulesValidateSystemHeaders =
       Args.hasArg(OPT_fmodules_validate_system_headers);
+  Opts.ValidateASTInputFilesContent =
+      Args.hasArg(OPT_fvalidate_ast_input_files_content);
   if (const Arg *A = Args.getLastArg(OPT_fmodule_format_EQ))
     Opts.ModuleFormat = A->getValue();
 
@@ -1678,6 +1745,7 @@ static void ParseLangArgs(LangOptions &Opts, ArgList &Args, InputKind IK,
   }
 
   Opts.IncludeDefaultHeader = Args.hasArg(OPT_finclude_default_header);
+  Opts.DeclareOpenCLBuiltins = Args.hasArg(OPT_fdeclare_opencl_builtins);
 
   llvm::Triple T(TargetOpts.Triple);
   CompilerInvocation::setLangDefaults(Opts, IK, T, PPOpts, LangStd);
@@ -1906,8 +1974,11 @@ static void ParseLangArgs(LangOptions &Opts, ArgList &Args, InputKind IK,
       getLastArgIntValue(Args, OPT_fconstexpr_depth, 512, Diags);
   Opts.ConstexprStepLimit =
       getLastArgIntValue(Args, OPT_fconstexpr_steps, 1048576, Diags);
+  Opts.ConstexprInterpreter =
+      Args.hasArg(OPT_fexperimental_constexpr_interpreter);
   Opts.BracketDepth = getLastArgIntValue(Args, OPT_fbracket_depth, 256, Diags);
   Opts.DelayedTemplateParsing = Args.hasArg(OPT_fdelayed_template_parsing);
+  Opts.LazyInlineMethodParsing = Args.hasArg(OPT_flazy_inline_method_parsing);
   Opts.NumLargeByValueCopy =
       getLastArgIntValue(Args, OPT_Wlarge_by_value_copy_EQ, 0, Diags);
   Opts.MSBitfields = Args.hasArg(OPT_mms_bitfields);
@@ -2057,6 +2128,10 @@ static void ParseLangArgs(LangOptions &Opts, ArgList &Args, InputKind IK,
       Opts.OpenMP && !Args.hasArg(options::OPT_fnoopenmp_use_tls);
   Opts.OpenMPIsDevice =
       Opts.OpenMP && Args.hasArg(options::OPT_fopenmp_is_device);
+  Opts.OpenMPSerializeSingleThread =
+      Opts.OpenMP && Args.hasArg(options::OPT_fopenmp_serialize_single_thread);
+  Opts.OpenMPInlineStaticSchedule =
+      Opts.OpenMP && Args.hasArg(options::OPT_fopenmp_inline_static_schedule);
 
   if (Opts.OpenMP) {
     int Version =
@@ -2163,6 +2238,8 @@ static void ParsePreprocessorArgs(PreprocessorOptions &Opts, ArgList &Args,
   Opts.UsePredefines = !Args.hasArg(OPT_undef);
   Opts.DetailedRecord = Args.hasArg(OPT_detailed_preprocessing_record);
   Opts.DisablePCHValidation = Args.hasArg(OPT_fno_validate_pch);
+  Opts.LazyPCHMacros = Args.hasArg(OPT_lazy_pch_macros);
+  Opts.CompactMacroArgLocations = Args.hasArg(OPT_compact_macro_arg_locations);
 
   Opts.DumpDeserializedPCHDecls = Args.hasArg(OPT_dump_deserialized_pch_decls);
   for (const Arg *A : Args.filtered(OPT_error_on_deserialized_pch_decl))
@@ -2266,6 +2343,7 @@ static void ParsePreprocessorOutputArgs(PreprocessorOutputOptions &Opts,
   case frontend::PrintPreprocessedInput:
   case frontend::RewriteMacros:
   case frontend::RunPreprocessorOnly:
+  case frontend::ScanDependencies:
     Opts.ShowCPP = !Args.hasArg(OPT_dM);
     break;
   }
@@ -2275,6 +2353,8 @@ static void ParsePreprocessorOutputArgs(PreprocessorOutputOptions &Opts,
   Opts.ShowMacroComments = Args.hasArg(OPT_CC);
   Opts.ShowMacros = Args.hasArg(OPT_dM) || Args.hasArg(OPT_dD);
   Opts.RewriteIncludes = Args.hasArg(OPT_frewrite_includes);
+  Opts.MinimizeRewrittenIncludes =
+      Args.hasArg(OPT_fminimize_rewritten_includes);
   Opts.UseLineDirectives = Args.hasArg(OPT_fuse_line_directives);
 }
 
@@ -10,7 +10,9 @@
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclBase.h"
 #include "clang/AST/DeclGroup.h"
+#include "clang/AST/Stmt.h"
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
@@ -401,6 +403,12 @@ bool FrontendAction::BeginSourceFile(CompilerInstance &CI,
     assert((!CI.getLangOpts().Modules || CI.getModuleManager()) &&
            "modules enabled but created an external source that "
            "doesn't support modules");
+
+    // The external source provides the builtin IDs of the identifiers it
+    // knows about; identifiers it doesn't know about still need theirs.
+    Preprocessor &PP = CI.getPreprocessor();
+    PP.getBuiltinInfo().initializeLazyBuiltins(PP.getIdentifierTable(),
+                                               PP.getLangOpts());
   }
 
   // If we were asked to load any module map files, do so now.
@@ -467,9 +475,38 @@ bool FrontendAction::Execute() {
                                     CI.getPCHContainerReader(), Cache);
   }
 
+  CI.logModuleCacheAccesses();
+
   return true;
 }
 
+/// \brief Write the memory used by the AST and the source manager of \p CI
+/// as a JSON object to \p Path.
+static void writeStatsJSON(CompilerInstance &CI, StringRef Path) {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::F_Text);
+  if (EC) {
+    CI.getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+        << Path << EC.message();
+    return;
+  }
+
+  OS << "{\"ast\":";
+  CI.getASTContext().PrintStatsJSON(OS);
+  OS << ",\"decls\":";
+  Decl::PrintStatsJSON(OS);
+  OS << ",\"stmts\":";
+  Stmt::PrintStatsJSON(OS);
+
+  SourceManager &SM = CI.getSourceManager();
+  SourceManager::MemoryBufferSizes Buffers = SM.getMemoryBufferSizes();
+  OS << ",\"source-manager\":{\"content-cache-bytes\":"
+     << SM.getContentCacheSize()
+     << ",\"data-structure-bytes\":" << SM.getDataStructureSizes()
+     << ",\"malloc-buffer-bytes\":" << Buffers.malloc_bytes
+     << ",\"mmap-buffer-bytes\":" << Buffers.mmap_bytes << "}}\n";
+}
+
 void FrontendAction::EndSourceFile() {
   CompilerInstance &CI = getCompilerInstance();
 
@@ -483,6 +520,9 @@ void FrontendAction::EndSourceFile() {
   // Finalize the action.
   EndSourceFileAction();
 
+  if (!CI.getFrontendOpts().StatsJSONPath.empty() && CI.hasASTContext())
+    writeStatsJSON(CI, CI.getFrontendOpts().StatsJSONPath);
+
   // Sema references the ast consumer, so reset sema first.
   //
   // FIXME: There is more per-file stuff we could just drop here?
@@ -553,6 +593,12 @@ void ASTFrontendAction::ExecuteAction() {
   if (!CI.hasSema())
     CI.createSema(getTranslationUnitKind(), CompletionConsumer);
 
+  // The per-kind Decl and Stmt counts are only collected on request.
+  if (!CI.getFrontendOpts().StatsJSONPath.empty()) {
+    Decl::EnableStatistics();
+    Stmt::EnableStatistics();
+  }
+
   ParseAST(CI.getSema(), CI.getFrontendOpts().ShowStats,
            CI.getFrontendOpts().SkipFunctionBodies);
 }
@@ -56,6 +56,8 @@ ASTPrintAction::CreateASTConsumer(CompilerInstance &CI, StringRef InFile) {
 
 std::unique_ptr<ASTConsumer>
 ASTDumpAction::CreateASTConsumer(CompilerInstance &CI, StringRef InFile) {
+  if (CI.getFrontendOpts().ASTDumpJSON)
+    return CreateASTJSONDumper(CI.getFrontendOpts().ASTDumpFilter);
   return CreateASTDumper(CI.getFrontendOpts().ASTDumpFilter,
                          CI.getFrontendOpts().ASTDumpDecls,
                          CI.getFrontendOpts().ASTDumpLookups);
@@ -120,7 +122,9 @@ GeneratePCHAction::ComputeASTConsumerArguments(CompilerInstance &CI,
   std::unique_ptr<raw_pwrite_stream> OS =
       CI.createOutputFile(CI.getFrontendOpts().OutputFile, /*Binary=*/true,
                           /*RemoveFileOnSignal=*/false, InFile,
-                          /*Extension=*/"", /*useTemporary=*/true);
+                          /*Extension=*/"", /*useTemporary=*/true,
+                          /*CreateMissingDirectories=*/false,
+                          CI.getFrontendOpts().PreserveUnchangedPCH);
   if (!OS)
     return nullptr;
 
@@ -674,6 +678,111 @@ void PreprocessOnlyAction::ExecuteAction() {
   } while (Tok.isNot(tok::eof));
 }
 
+namespace {
+/// \brief Prints the dependencies found by ScanDependenciesAction.
+class DependencyScanCallbacks : public PPCallbacks {
+  Preprocessor &PP;
+  raw_ostream &OS;
+
+public:
+  DependencyScanCallbacks(Preprocessor &PP, raw_ostream &OS)
+      : PP(PP), OS(OS) {}
+
+  void InclusionDirective(SourceLocation HashLoc, const Token &IncludeTok,
+                          StringRef FileName, bool IsAngled,
+                          CharSourceRange FilenameRange, const FileEntry *File,
+                          StringRef SearchPath, StringRef RelativePath,
+                          const Module *Imported) override {
+    OS << (File ? "include " : "missing ");
+    printIncluder(HashLoc);
+    OS << " \"";
+    OS.write_escaped(File ? StringRef(File->getName()) : FileName);
+    OS << "\"\n";
+  }
+
+  /// \brief Print an \@import of the module named \p Path.
+  void moduleImport(SourceLocation ImportLoc, StringRef Path) {
+    OS << "import ";
+    printIncluder(ImportLoc);
+    OS << ' ' << Path;
+    // Module maps are searched as usual, but the module itself is not loaded.
+    ModuleMap &ModMap = PP.getHeaderSearchInfo().getModuleMap();
+    if (Module *M = PP.getHeaderSearchInfo().lookupModule(
+            Path.split('.').first)) {
+      if (const FileEntry *ModuleMapFile =
+              ModMap.getContainingModuleMapFile(M)) {
+        OS << " \"";
+        OS.write_escaped(ModuleMapFile->getName());
+        OS << '"';
+      }
+    }
+    OS << '\n';
+  }
+
+private:
+  void printIncluder(SourceLocation Loc) {
+    SourceManager &SM = PP.getSourceManager();
+    const FileEntry *Includer =
+        SM.getFileEntryForID(SM.getFileID(SM.getExpansionLoc(Loc)));
+    OS << '"';
+    OS.write_escaped(Includer ? StringRef(Includer->getName()) : "<built-in>");
+    OS << '"';
+  }
+};
+} // end anonymous namespace
+
+bool ScanDependenciesAction::BeginInvocation(CompilerInstance &CI) {
+  // Treat all includes textually and recognize @import ourselves, so that
+  // scanning never loads or builds a module.
+  CI.getLangOpts().Modules = false;
+  return true;
+}
+
+void ScanDependenciesAction::ExecuteAction() {
+  CompilerInstance &CI = getCompilerInstance();
+  raw_ostream *OS = CI.createDefaultOutputFile(false, getCurrentFile());
+  if (!OS)
+    return;
+
+  Preprocessor &PP = CI.getPreprocessor();
+  PP.IgnorePragmas();
+  // Only directives can introduce dependencies, so don't spend any time
+  // expanding macros in the rest of the file.
+  PP.SetMacroExpansionOnlyInDirectives();
+  auto Callbacks = llvm::make_unique<DependencyScanCallbacks>(PP, *OS);
+  DependencyScanCallbacks *Scanner = Callbacks.get();
+  PP.addPPCallbacks(std::move(Callbacks));
+
+  Token Tok;
+  PP.EnterMainSourceFile();
+  PP.Lex(Tok);
+  while (Tok.isNot(tok::eof)) {
+    if (Tok.isNot(tok::at)) {
+      PP.Lex(Tok);
+      continue;
+    }
+
+    // Recognize '@import' followed by a module path.
+    SourceLocation AtLoc = Tok.getLocation();
+    PP.Lex(Tok);
+    if (Tok.isNot(tok::identifier) ||
+        !Tok.getIdentifierInfo()->isModulesImport())
+      continue;
+    SmallString<64> Path;
+    PP.Lex(Tok);
+    while (Tok.is(tok::identifier)) {
+      Path += Tok.getIdentifierInfo()->getName();
+      PP.Lex(Tok);
+      if (Tok.isNot(tok::period))
+        break;
+      Path += '.';
+      PP.Lex(Tok);
+    }
+    if (!Path.empty() && Path.back() != '.')
+      Scanner->moduleImport(AtLoc, Path);
+  }
+}
+
 void PrintPreprocessedAction::ExecuteAction() {
   CompilerInstance &CI = getCompilerInstance();
   // Output file may need to be set to 'Binary', to avoid converting Unix style
@@ -0,0 +1,233 @@
+//===--- HeaderCostGen.cpp - Attribute compile time to headers ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This code records how much time and AST memory the compiler spends while
+// each header is the innermost file being processed, and writes the result
+// to a JSON file so that the costs of many translation units can be summed
+// up into a build-wide report (see utils/header-cost-report.py).
+//
+// The preprocessor, the parser and Sema all work in lockstep on the tokens of
+// the current file, so the time spent lexing, parsing and analyzing the
+// declarations of a header, including the templates instantiated on the way,
+// is charged to that header. Work done after the end of the main file, such
+// as the instantiations deferred to the end of the translation unit, is not
+// attributed to any header.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/Utils.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Lex/PPCallbacks.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+using namespace clang;
+
+namespace {
+typedef std::chrono::steady_clock ClockType;
+
+/// The cost of one file, summed over all the times it was entered.
+struct FileCost {
+  unsigned Entries = 0;
+  uint64_t Size = 0;
+  /// Time and AST memory spent while this file was the innermost file.
+  ClockType::duration SelfTime = ClockType::duration::zero();
+  size_t SelfASTMemory = 0;
+  /// Time and AST memory spent while this file was on the include stack.
+  /// Only the outermost entry of a file that includes itself is counted.
+  ClockType::duration TotalTime = ClockType::duration::zero();
+  size_t TotalASTMemory = 0;
+};
+
+class HeaderCostCallback : public PPCallbacks {
+  struct ActiveFile {
+    FileCost *Cost;
+    ClockType::time_point Start;
+    size_t StartASTMemory;
+  };
+
+  const Preprocessor *PP;
+  std::string OutputFile;
+  std::function<size_t()> GetASTMemory;
+
+  /// The costs of all files entered so far, keyed by name.
+  llvm::StringMap<FileCost> Costs;
+
+  /// The files currently being processed, innermost last.
+  SmallVector<ActiveFile, 16> Stack;
+
+  /// When the time and AST memory were last charged to the innermost file.
+  ClockType::time_point LastTime;
+  size_t LastASTMemory = 0;
+
+  bool Finished = false;
+
+  /// Charge the time and AST memory spent since the last event to the
+  /// innermost file.
+  void chargeInnermost(ClockType::time_point Now, size_t ASTMemory);
+  void popFile(ClockType::time_point Now, size_t ASTMemory);
+  void OutputCostFile();
+
+public:
+  HeaderCostCallback(const Preprocessor *PP, StringRef OutputFile,
+                     std::function<size_t()> GetASTMemory)
+      : PP(PP), OutputFile(OutputFile), GetASTMemory(std::move(GetASTMemory)) {
+  }
+
+  void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                   SrcMgr::CharacteristicKind FileType,
+                   FileID PrevFID) override;
+
+  void EndOfMainFile() override;
+};
+} // end anonymous namespace
+
+void clang::AttachHeaderCostGen(Preprocessor &PP, StringRef OutputFile,
+                                std::function<size_t()> GetASTMemory) {
+  PP.addPPCallbacks(llvm::make_unique<HeaderCostCallback>(
+      &PP, OutputFile, std::move(GetASTMemory)));
+}
+
+void HeaderCostCallback::chargeInnermost(ClockType::time_point Now,
+                                         size_t ASTMemory) {
+  if (!Stack.empty()) {
+    Stack.back().Cost->SelfTime += Now - LastTime;
+    Stack.back().Cost->SelfASTMemory += ASTMemory - LastASTMemory;
+  }
+  LastTime = Now;
+  LastASTMemory = ASTMemory;
+}
+
+void HeaderCostCallback::popFile(ClockType::time_point Now,
+                                 size_t ASTMemory) {
+  ActiveFile File = Stack.pop_back_val();
+  bool Reentered =
+      std::any_of(Stack.begin(), Stack.end(), [&](const ActiveFile &Outer) {
+        return Outer.Cost == File.Cost;
+      });
+  if (!Reentered) {
+    File.Cost->TotalTime += Now - File.Start;
+    File.Cost->TotalASTMemory += ASTMemory - File.StartASTMemory;
+  }
+}
+
+void HeaderCostCallback::FileChanged(SourceLocation Loc,
+                                     FileChangeReason Reason,
+                                     SrcMgr::CharacteristicKind FileType,
+                                     FileID PrevFID) {
+  if (Finished || (Reason != EnterFile && Reason != ExitFile))
+    return;
+
+  ClockType::time_point Now = ClockType::now();
+  size_t ASTMemory = GetASTMemory();
+  chargeInnermost(Now, ASTMemory);
+
+  if (Reason == ExitFile) {
+    if (!Stack.empty())
+      popFile(Now, ASTMemory);
+    return;
+  }
+
+  const SourceManager &SM = PP->getSourceManager();
+  FileID FID = SM.getFileID(SM.getExpansionLoc(Loc));
+  const FileEntry *Entry = SM.getFileEntryForID(FID);
+  std::string Name =
+      Entry ? Entry->getName() : SM.getBufferName(SM.getLocForStartOfFile(FID));
+
+  FileCost &Cost = Costs[Name];
+  ++Cost.Entries;
+  if (Entry)
+    Cost.Size = Entry->getSize();
+  Stack.push_back({&Cost, Now, ASTMemory});
+}
+
+void HeaderCostCallback::EndOfMainFile() {
+  ClockType::time_point Now = ClockType::now();
+  size_t ASTMemory = GetASTMemory();
+  chargeInnermost(Now, ASTMemory);
+  while (!Stack.empty())
+    popFile(Now, ASTMemory);
+  Finished = true;
+
+  OutputCostFile();
+}
+
+/// \brief Write \p Str as a JSON string literal.
+static void writeJSONString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (unsigned char C : Str) {
+    switch (C) {
+    case '"':  OS << "\\\""; break;
+    case '\\': OS << "\\\\"; break;
+    case '\n': OS << "\\n"; break;
+    case '\t': OS << "\\t"; break;
+    default:
+      if (C < 0x20)
+        OS << llvm::format("\\u%04x", C);
+      else
+        OS << C;
+      break;
+    }
+  }
+  OS << '"';
+}
+
+void HeaderCostCallback::OutputCostFile() {
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(OutputFile, EC, llvm::sys::fs::F_Text);
+  if (EC) {
+    PP->getDiagnostics().Report(diag::err_fe_error_opening) << OutputFile
+                                                            << EC.message();
+    return;
+  }
+
+  const SourceManager &SM = PP->getSourceManager();
+  const FileEntry *MainFile = SM.getFileEntryForID(SM.getMainFileID());
+
+  // List the most expensive files first.
+  std::vector<std::pair<StringRef, const FileCost *>> Sorted;
+  for (const auto &Entry : Costs)
+    Sorted.push_back(std::make_pair(Entry.getKey(), &Entry.getValue()));
+  std::sort(Sorted.begin(), Sorted.end(),
+            [](const std::pair<StringRef, const FileCost *> &LHS,
+               const std::pair<StringRef, const FileCost *> &RHS) {
+              if (LHS.second->TotalTime != RHS.second->TotalTime)
+                return LHS.second->TotalTime > RHS.second->TotalTime;
+              return LHS.first < RHS.first;
+            });
+
+  OS << "{\n  \"main-file\": ";
+  writeJSONString(OS, MainFile ? MainFile->getName() : "");
+  OS << ",\n  \"files\": [";
+  bool First = true;
+  for (const auto &File : Sorted) {
+    const FileCost &Cost = *File.second;
+    OS << (First ? "\n" : ",\n") << "    {\"name\": ";
+    writeJSONString(OS, File.first);
+    OS << ", \"entries\": " << Cost.Entries << ", \"size\": " << Cost.Size
+       << ", \"self-time-us\": "
+       << duration_cast<microseconds>(Cost.SelfTime).count()
+       << ", \"total-time-us\": "
+       << duration_cast<microseconds>(Cost.TotalTime).count()
+       << ", \"self-ast-bytes\": " << Cost.SelfASTMemory
+       << ", \"total-ast-bytes\": " << Cost.TotalASTMemory << "}";
+    First = false;
+  }
+  OS << "\n  ]\n}\n";
+}
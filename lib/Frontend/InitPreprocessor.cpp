@@ -25,9 +25,12 @@
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Serialization/ASTReader.h"
 #include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include <mutex>
 using namespace clang;
 
 static bool MacroBodyEndsInBackslash(StringRef MacroBody) {
@@ -971,15 +974,13 @@ static void InitializePredefinedMacros(const TargetInfo &TI,
 /// InitializePreprocessor - Initialize the preprocessor getting it and the
 /// environment ready to process a single file. This returns true on error.
 ///
-void clang::InitializePreprocessor(
-    Preprocessor &PP, const PreprocessorOptions &InitOpts,
-    const PCHContainerReader &PCHContainerRdr,
-    const FrontendOptions &FEOpts) {
+/// \brief Write the builtin part of the predefines buffer, which only depends
+/// on the target and the language, to \p Builder.
+static void InitializeBuiltinPredefines(Preprocessor &PP,
+                                        const PreprocessorOptions &InitOpts,
+                                        const FrontendOptions &FEOpts,
+                                        MacroBuilder &Builder) {
   const LangOptions &LangOpts = PP.getLangOpts();
-  std::string PredefineBuffer;
-  PredefineBuffer.reserve(4080);
-  llvm::raw_string_ostream Predefines(PredefineBuffer);
-  MacroBuilder Builder(Predefines);
 
   // Emit line markers for various builtin sections of the file.  We don't do
   // this in asm preprocessor mode, because "# 4" is not a line marker directive
@@ -1016,6 +1017,99 @@ void clang::InitializePreprocessor(
   // current language configuration.
   InitializeStandardPredefinedMacros(PP.getTargetInfo(), PP.getLangOpts(),
                                      FEOpts, Builder);
+}
+
+/// \brief Compute the key under which the builtin predefines for \p PP are
+/// cached, from all of the options they depend on.
+///
+/// \returns false if the builtin predefines should not be cached, because
+/// they depend on state that is not part of the key.
+static bool getBuiltinPredefinesKey(Preprocessor &PP,
+                                    const PreprocessorOptions &InitOpts,
+                                    const FrontendOptions &FEOpts,
+                                    std::string &Key) {
+  const LangOptions &LangOpts = PP.getLangOpts();
+  // OpenCL extensions and the auxiliary CUDA target are configured outside of
+  // the target options.
+  if (LangOpts.OpenCL || LangOpts.CUDA)
+    return false;
+
+  llvm::raw_string_ostream OS(Key);
+  auto AddString = [&](StringRef Str) { OS << Str << '\0'; };
+  const TargetOptions &TargetOpts = PP.getTargetInfo().getTargetOpts();
+  AddString(TargetOpts.Triple);
+  AddString(TargetOpts.HostTriple);
+  AddString(TargetOpts.CPU);
+  AddString(TargetOpts.FPMath);
+  AddString(TargetOpts.ABI);
+  AddString(TargetOpts.EABIVersion);
+  AddString(TargetOpts.LinkerVersion);
+  for (const std::string &Feature : TargetOpts.Features)
+    AddString(Feature);
+  AddString("");
+
+#define LANGOPT(Name, Bits, Default, Description) OS << LangOpts.Name << ',';
+#define ENUM_LANGOPT(Name, Type, Bits, Default, Description)                   \
+  OS << static_cast<unsigned>(LangOpts.get##Name()) << ',';
+#include "clang/Basic/LangOptions.def"
+  OS << LangOpts.Sanitize.Mask << ',';
+  AddString(LangOpts.ObjCRuntime.getAsString());
+
+  OS << InitOpts.UsePredefines << ',' << InitOpts.ObjCXXARCStandardLibrary
+     << ',' << FEOpts.ProgramAction;
+  OS.flush();
+  return true;
+}
+
+namespace {
+/// \brief The builtin predefines generated so far in this process, keyed by
+/// the options they depend on, so that tools and libraries that run many
+/// compilations only generate them once per configuration.
+struct BuiltinPredefinesCache {
+  std::mutex Mutex;
+  llvm::StringMap<std::string> Entries;
+};
+} // end anonymous namespace
+
+/// \brief The number of configurations after which the cache is cleared, so
+/// that a process that keeps changing options does not grow without bound.
+static const unsigned MaxCachedPredefines = 64;
+
+static llvm::ManagedStatic<BuiltinPredefinesCache> CachedPredefines;
+
+void clang::InitializePreprocessor(
+    Preprocessor &PP, const PreprocessorOptions &InitOpts,
+    const PCHContainerReader &PCHContainerRdr,
+    const FrontendOptions &FEOpts) {
+  std::string PredefineBuffer;
+  PredefineBuffer.reserve(4080);
+  llvm::raw_string_ostream Predefines(PredefineBuffer);
+  MacroBuilder Builder(Predefines);
+
+  std::string Key;
+  if (getBuiltinPredefinesKey(PP, InitOpts, FEOpts, Key)) {
+    BuiltinPredefinesCache &Cache = *CachedPredefines;
+    std::unique_lock<std::mutex> Lock(Cache.Mutex);
+    auto Cached = Cache.Entries.find(Key);
+    if (Cached != Cache.Entries.end()) {
+      Predefines << Cached->getValue();
+    } else {
+      Lock.unlock();
+      std::string Builtin;
+      llvm::raw_string_ostream BuiltinOS(Builtin);
+      MacroBuilder BuiltinBuilder(BuiltinOS);
+      InitializeBuiltinPredefines(PP, InitOpts, FEOpts, BuiltinBuilder);
+      BuiltinOS.flush();
+      Predefines << Builtin;
+
+      Lock.lock();
+      if (Cache.Entries.size() >= MaxCachedPredefines)
+        Cache.Entries.clear();
+      Cache.Entries[Key] = std::move(Builtin);
+    }
+  } else {
+    InitializeBuiltinPredefines(PP, InitOpts, FEOpts, Builder);
+  }
 
   // Add on the predefines from the driver.  Wrap in a #line directive to report
   // that they come from the command line.
@@ -625,6 +625,43 @@ struct UnknownPragmaHandler : public PragmaHandler {
 } // end anonymous namespace
 
 
+namespace {
+/// \brief Finds the characters of file locations, remembering the buffer of
+/// the file that was looked at last.
+///
+/// Almost all tokens that aren't produced by macro expansion come from the
+/// same file as the token before them, so this avoids a SourceManager lookup
+/// per token.
+class FileCharacterCache {
+  const SourceManager &SM;
+  SourceLocation Start, End;
+  const char *Data = nullptr;
+
+public:
+  explicit FileCharacterCache(const SourceManager &SM) : SM(SM) {}
+
+  /// \brief Returns the characters \p Loc points to, or null if \p Loc isn't
+  /// a file location.
+  const char *getCharacterData(SourceLocation Loc) {
+    if (!Loc.isFileID())
+      return nullptr;
+    if (!Data || Loc < Start || !(Loc < End)) {
+      FileID FID = SM.getFileID(Loc);
+      bool Invalid = false;
+      StringRef Buffer = SM.getBufferData(FID, &Invalid);
+      if (Invalid) {
+        Data = nullptr;
+        return nullptr;
+      }
+      Start = SM.getLocForStartOfFile(FID);
+      End = Start.getLocWithOffset(Buffer.size());
+      Data = Buffer.data();
+    }
+    return Data + (Loc.getRawEncoding() - Start.getRawEncoding());
+  }
+};
+} // end anonymous namespace
+
 static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
                                     PrintPPOutputPPCallbacks *Callbacks,
                                     raw_ostream &OS) {
@@ -635,12 +672,24 @@ static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
   Token PrevPrevTok, PrevTok;
   PrevPrevTok.startToken();
   PrevTok.startToken();
+
+  // Tokens spelled in a file exactly as they are printed are copied straight
+  // from its buffer. PrevTokEnd points just past PrevTok if it was.
+  FileCharacterCache FileChars(PP.getSourceManager());
+  const char *PrevTokEnd = nullptr;
   while (1) {
     if (Callbacks->hasEmittedDirectiveOnThisLine()) {
       Callbacks->startNewLineIfNeeded();
       Callbacks->MoveToLine(Tok.getLocation());
     }
 
+    // Comments and unknown tokens can contain newlines, which have to be
+    // counted, so they always take the slow path below.
+    const char *TokStart = nullptr;
+    if (!Tok.needsCleaning() && !Tok.hasUCN() && !Tok.isAnnotation() &&
+        !Tok.isOneOf(tok::comment, tok::unknown, tok::eof))
+      TokStart = FileChars.getCharacterData(Tok.getLocation());
+
     // If this token is at the start of a line, emit newlines if needed.
     if (Tok.isAtStartOfLine() && Callbacks->HandleFirstTokOnLine(Tok)) {
       // done.
@@ -648,6 +697,9 @@ static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
                // If we haven't emitted a token on this line yet, PrevTok isn't
                // useful to look at and no concatenation could happen anyway.
                (Callbacks->hasEmittedTokensOnThisLine() &&
+                // Tokens that were adjacent in the source were lexed as two
+                // tokens there and will be again.
+                (!TokStart || TokStart != PrevTokEnd) &&
                 // Don't print "-" next to "-", it would form "--".
                 Callbacks->AvoidConcat(PrevPrevTok, PrevTok, Tok))) {
       OS << ' ';
@@ -664,8 +716,11 @@ static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
                Tok.is(tok::annot_module_end)) {
       // PrintPPOutputPPCallbacks::InclusionDirective handles producing
       // appropriate output here. Ignore this token entirely.
+      PrevTokEnd = nullptr;
       PP.Lex(Tok);
       continue;
+    } else if (TokStart) {
+      OS.write(TokStart, Tok.getLength());
     } else if (IdentifierInfo *II = Tok.getIdentifierInfo()) {
       OS << II->getName();
     } else if (Tok.isLiteral() && !Tok.needsCleaning() &&
@@ -695,6 +750,7 @@ static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
 
     PrevPrevTok = PrevTok;
     PrevTok = Tok;
+    PrevTokEnd = TokStart ? TokStart + Tok.getLength() : nullptr;
     PP.Lex(Tok);
   }
 }
@@ -799,6 +855,12 @@ void clang::DoPrintPreprocessedInput(Preprocessor &PP, raw_ostream *OS,
       break;
   } while (true);
 
+  // Preprocessed output is usually several times larger than the source, so
+  // write it out in large chunks.
+  const size_t OutputBufferSize = 64 * 1024;
+  if (OS->GetBufferSize() && OS->GetBufferSize() < OutputBufferSize)
+    OS->SetBufferSize(OutputBufferSize);
+
   // Read all the preprocessed tokens, printing them out to the stream.
   PrintPreprocessedTokens(PP, Tok, Callbacks, *OS);
   *OS << '\n';
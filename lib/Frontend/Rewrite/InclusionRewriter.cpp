@@ -13,6 +13,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Rewrite/Frontend/Rewriters.h"
+#include "clang/Basic/CharInfo.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Frontend/PreprocessorOutputOptions.h"
 #include "clang/Lex/HeaderSearch.h"
@@ -42,16 +43,20 @@ class InclusionRewriter : public PPCallbacks {
   const llvm::MemoryBuffer *PredefinesBuffer; ///< The preprocessor predefines.
   bool ShowLineMarkers; ///< Show #line markers.
   bool UseLineDirectives; ///< Use of line directives or line markers.
+  bool Minimize; ///< Drop comments and skipped conditional blocks.
   /// Tracks where inclusions that change the file are found.
   std::map<unsigned, IncludedFile> FileIncludes;
   /// Tracks where inclusions that import modules are found.
   std::map<unsigned, const Module *> ModuleIncludes;
+  /// Tracks the conditional blocks the preprocessor skipped, from the
+  /// directive that starts each one to the directive that ends it.
+  std::map<unsigned, unsigned> SkippedRanges;
   /// Used transitively for building up the FileIncludes mapping over the
   /// various \c PPCallbacks callbacks.
   SourceLocation LastInclusionLocation;
 public:
   InclusionRewriter(Preprocessor &PP, raw_ostream &OS, bool ShowLineMarkers,
-                    bool UseLineDirectives);
+                    bool UseLineDirectives, bool Minimize);
   bool Process(FileID FileId, SrcMgr::CharacteristicKind FileType);
   void setPredefinesBuffer(const llvm::MemoryBuffer *Buf) {
     PredefinesBuffer = Buf;
@@ -68,6 +73,7 @@ private:
                           CharSourceRange FilenameRange, const FileEntry *File,
                           StringRef SearchPath, StringRef RelativePath,
                           const Module *Imported) override;
+  void SourceRangeSkipped(SourceRange Range) override;
   void WriteLineInfo(const char *Filename, int Line,
                      SrcMgr::CharacteristicKind FileType,
                      StringRef Extra = StringRef());
@@ -76,6 +82,14 @@ private:
                          unsigned &WriteFrom, unsigned WriteTo,
                          StringRef EOL, int &lines,
                          bool EnsureNewline);
+  void StripComments(const MemoryBuffer &FromFile, StringRef Text,
+                     StringRef LocalEOL, SmallVectorImpl<char> &Out);
+  void SkipContentUpTo(const MemoryBuffer &FromFile, unsigned &WriteFrom,
+                       unsigned WriteTo, StringRef LocalEOL, int &Line);
+  bool SkipExcludedBlock(const MemoryBuffer &FromFile,
+                         const Token &HashToken, const Token &EodToken,
+                         StringRef LocalEOL, unsigned &NextToWrite,
+                         int &Line);
   void CommentOutDirective(Lexer &DirectivesLex, const Token &StartToken,
                            const MemoryBuffer &FromFile, StringRef EOL,
                            unsigned &NextToWrite, int &Lines);
@@ -92,10 +106,10 @@ private:
 /// Initializes an InclusionRewriter with a \p PP source and \p OS destination.
 InclusionRewriter::InclusionRewriter(Preprocessor &PP, raw_ostream &OS,
                                      bool ShowLineMarkers,
-                                     bool UseLineDirectives)
+                                     bool UseLineDirectives, bool Minimize)
     : PP(PP), SM(PP.getSourceManager()), OS(OS), MainEOL("\n"),
       PredefinesBuffer(nullptr), ShowLineMarkers(ShowLineMarkers),
-      UseLineDirectives(UseLineDirectives),
+      UseLineDirectives(UseLineDirectives), Minimize(Minimize),
       LastInclusionLocation(SourceLocation()) {}
 
 /// Write appropriate line information as either #line directives or GNU line
@@ -191,6 +205,14 @@ void InclusionRewriter::InclusionDirective(SourceLocation HashLoc,
     LastInclusionLocation = HashLoc;
 }
 
+/// Records the conditional blocks that were skipped, so that their contents
+/// can be left out when minimizing the output.
+void InclusionRewriter::SourceRangeSkipped(SourceRange Range) {
+  if (Minimize)
+    SkippedRanges[Range.getBegin().getRawEncoding()] =
+        Range.getEnd().getRawEncoding();
+}
+
 /// Simple lookup for a SourceLocation (specifically one denoting the hash in
 /// an inclusion directive) in the map of inclusion information, FileChanges.
 const InclusionRewriter::IncludedFile *
@@ -260,6 +282,11 @@ void InclusionRewriter::OutputContentUpTo(const MemoryBuffer &FromFile,
 
   StringRef TextToWrite(FromFile.getBufferStart() + WriteFrom,
                         WriteTo - WriteFrom);
+  SmallString<256> Stripped;
+  if (Minimize) {
+    StripComments(FromFile, TextToWrite, LocalEOL, Stripped);
+    TextToWrite = Stripped;
+  }
 
   if (MainEOL == LocalEOL) {
     OS << TextToWrite;
@@ -284,6 +311,101 @@ void InclusionRewriter::OutputContentUpTo(const MemoryBuffer &FromFile,
   WriteFrom = WriteTo;
 }
 
+/// Appends \p Text, which is part of \p FromFile, to \p Out with every comment
+/// replaced by whitespace.  Comments that span lines become line continuations,
+/// so that both the line numbers and the extent of directives are unchanged.
+void InclusionRewriter::StripComments(const MemoryBuffer &FromFile,
+                                      StringRef Text, StringRef LocalEOL,
+                                      SmallVectorImpl<char> &Out) {
+  // Only the extent of each comment is needed, not its source location.
+  Lexer RawLex(SourceLocation(), PP.getLangOpts(), FromFile.getBufferStart(),
+               Text.begin(), FromFile.getBufferEnd());
+  RawLex.SetCommentRetentionState(true);
+
+  const char *Written = Text.begin();
+  Token RawToken;
+  while (true) {
+    RawLex.LexFromRawLexer(RawToken);
+    const char *TokenEnd = RawLex.getBufferLocation();
+    if (RawToken.is(tok::eof) || TokenEnd > Text.end())
+      break;
+    if (RawToken.isNot(tok::comment))
+      continue;
+
+    const char *TokenStart = TokenEnd - RawToken.getLength();
+    Out.append(Written, TokenStart);
+    size_t Lines = StringRef(TokenStart, RawToken.getLength()).count(LocalEOL);
+    if (!Lines)
+      Out.push_back(' ');
+    for (; Lines; --Lines) {
+      Out.push_back(' ');
+      Out.push_back('\\');
+      Out.append(LocalEOL.begin(), LocalEOL.end());
+    }
+    Written = TokenEnd;
+  }
+  Out.append(Written, Text.end());
+}
+
+/// Writes out only the line endings from \p FromFile, starting at
+/// \p WriteFrom and ending at \p WriteTo - 1.
+void InclusionRewriter::SkipContentUpTo(const MemoryBuffer &FromFile,
+                                        unsigned &WriteFrom, unsigned WriteTo,
+                                        StringRef LocalEOL, int &Line) {
+  if (WriteTo <= WriteFrom)
+    return;
+  StringRef Skipped(FromFile.getBufferStart() + WriteFrom, WriteTo - WriteFrom);
+  for (size_t Lines = Skipped.count(LocalEOL); Lines; --Lines) {
+    OS << MainEOL;
+    ++Line;
+  }
+  WriteFrom = WriteTo;
+}
+
+/// Returns the offset of the start of the line holding the directive whose
+/// name starts at \p NameOffset, or 0 if anything but whitespace precedes its
+/// hash on that line.
+static unsigned getDirectiveLineStart(StringRef Buffer, unsigned NameOffset) {
+  unsigned Pos = NameOffset;
+  while (Pos && isHorizontalWhitespace(Buffer[Pos - 1]))
+    --Pos;
+  if (!Pos || Buffer[Pos - 1] != '#')
+    return 0;
+  --Pos;
+  while (Pos && isHorizontalWhitespace(Buffer[Pos - 1]))
+    --Pos;
+  if (Pos && !isVerticalWhitespace(Buffer[Pos - 1]))
+    return 0;
+  return Pos;
+}
+
+/// If the preprocessor skipped the conditional block started by the directive
+/// from \p HashToken to \p EodToken, print the directive and replace the
+/// block up to the directive ending it by empty lines.
+bool InclusionRewriter::SkipExcludedBlock(const MemoryBuffer &FromFile,
+                                          const Token &HashToken,
+                                          const Token &EodToken,
+                                          StringRef LocalEOL,
+                                          unsigned &NextToWrite, int &Line) {
+  if (&FromFile == PredefinesBuffer || EodToken.isNot(tok::eod))
+    return false;
+  auto I = SkippedRanges.lower_bound(HashToken.getLocation().getRawEncoding());
+  if (I == SkippedRanges.end() ||
+      I->first > EodToken.getLocation().getRawEncoding())
+    return false;
+
+  unsigned EodOffset = SM.getFileOffset(EodToken.getLocation());
+  unsigned BlockEnd = getDirectiveLineStart(
+      FromFile.getBuffer(),
+      SM.getFileOffset(SourceLocation::getFromRawEncoding(I->second)));
+  if (BlockEnd <= EodOffset)
+    return false;
+
+  OutputContentUpTo(FromFile, NextToWrite, EodOffset, LocalEOL, Line, false);
+  SkipContentUpTo(FromFile, NextToWrite, BlockEnd, LocalEOL, Line);
+  return true;
+}
+
 /// Print characters from \p FromFile starting at \p NextToWrite up until the
 /// inclusion directive at \p StartToken, then print out the inclusion
 /// inclusion directive disabled by a #if directive, updating \p NextToWrite
@@ -430,17 +552,22 @@ bool InclusionRewriter::Process(FileID FileId,
   Token RawToken;
   RawLex.LexFromRawLexer(RawToken);
 
-  // TODO: Consider adding a switch that strips possibly unimportant content,
-  // such as comments, to reduce the size of repro files.
+  // The offset up to which a skipped conditional block was left out.
+  unsigned SkippedUntil = 0;
+
   while (RawToken.isNot(tok::eof)) {
-    if (RawToken.is(tok::hash) && RawToken.isAtStartOfLine()) {
+    if (RawToken.is(tok::hash) && RawToken.isAtStartOfLine() &&
+        (!SkippedUntil ||
+         SM.getFileOffset(RawToken.getLocation()) >= SkippedUntil)) {
       RawLex.setParsingPreprocessorDirective(true);
       Token HashToken = RawToken;
       RawLex.LexFromRawLexer(RawToken);
       if (RawToken.is(tok::raw_identifier))
         PP.LookUpIdentifierInfo(RawToken);
       if (RawToken.getIdentifierInfo() != nullptr) {
-        switch (RawToken.getIdentifierInfo()->getPPKeywordID()) {
+        tok::PPKeywordKind Directive =
+            RawToken.getIdentifierInfo()->getPPKeywordID();
+        switch (Directive) {
           case tok::pp_include:
           case tok::pp_include_next:
           case tok::pp_import: {
@@ -563,6 +690,19 @@ bool InclusionRewriter::Process(FileID FileId,
           default:
             break;
         }
+
+        // The contents of skipped blocks can't affect the compilation, only
+        // the line numbers after them.
+        if (Minimize &&
+            (Directive == tok::pp_if || Directive == tok::pp_ifdef ||
+             Directive == tok::pp_ifndef || Directive == tok::pp_elif ||
+             Directive == tok::pp_else)) {
+          while (RawToken.isNot(tok::eod) && RawToken.isNot(tok::eof))
+            RawLex.LexFromRawLexer(RawToken);
+          if (SkipExcludedBlock(FromFile, HashToken, RawToken, LocalEOL,
+                                NextToWrite, Line))
+            SkippedUntil = NextToWrite;
+        }
       }
       RawLex.setParsingPreprocessorDirective(false);
     }
@@ -579,7 +719,8 @@ void clang::RewriteIncludesInInput(Preprocessor &PP, raw_ostream *OS,
                                    const PreprocessorOutputOptions &Opts) {
   SourceManager &SM = PP.getSourceManager();
   InclusionRewriter *Rewrite = new InclusionRewriter(
-      PP, *OS, Opts.ShowLineMarkers, Opts.UseLineDirectives);
+      PP, *OS, Opts.ShowLineMarkers, Opts.UseLineDirectives,
+      Opts.MinimizeRewrittenIncludes);
   Rewrite->detectMainFileEOL();
 
   PP.addPPCallbacks(std::unique_ptr<PPCallbacks>(Rewrite));
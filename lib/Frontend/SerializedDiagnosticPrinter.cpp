@@ -171,6 +171,12 @@ public:
 
   void finish() override;
 
+  /// \brief Merge the records of the serialized diagnostics file \p File.
+  std::error_code mergeRecordsFromFile(const char *File);
+
+  /// \brief Write the serialized diagnostics to the output file.
+  std::error_code writeOutputFile();
+
 private:
   /// \brief Build a DiagnosticsEngine to emit diagnostics about the diagnostics
   DiagnosticsEngine *getMetaDiags();
@@ -313,6 +319,15 @@ create(StringRef OutputFile, DiagnosticOptions *Diags, bool MergeChildRecords) {
   return llvm::make_unique<SDiagsWriter>(OutputFile, Diags, MergeChildRecords);
 }
 
+std::error_code merge(ArrayRef<std::string> InputFiles, StringRef OutputFile) {
+  SDiagsWriter Writer(OutputFile, new DiagnosticOptions(),
+                      /*MergeChildRecords=*/false);
+  for (const std::string &File : InputFiles)
+    if (std::error_code EC = Writer.mergeRecordsFromFile(File.c_str()))
+      return EC;
+  return Writer.writeOutputFile();
+}
+
 } // end namespace serialized_diags
 } // end namespace clang
 
@@ -803,22 +818,30 @@ void SDiagsWriter::finish() {
       return;
 
     if (llvm::sys::fs::exists(State->OutputFile))
-      if (SDiagsMerger(*this).mergeRecordsFromFile(State->OutputFile.c_str()))
+      if (mergeRecordsFromFile(State->OutputFile.c_str()))
         getMetaDiags()->Report(diag::warn_fe_serialized_diag_merge_failure);
   }
 
+  if (std::error_code EC = writeOutputFile())
+    getMetaDiags()->Report(diag::warn_fe_serialized_diag_failure)
+        << State->OutputFile << EC.message();
+}
+
+std::error_code SDiagsWriter::mergeRecordsFromFile(const char *File) {
+  return SDiagsMerger(*this).mergeRecordsFromFile(File);
+}
+
+std::error_code SDiagsWriter::writeOutputFile() {
   std::error_code EC;
   auto OS = llvm::make_unique<llvm::raw_fd_ostream>(State->OutputFile.c_str(),
                                                     EC, llvm::sys::fs::F_None);
-  if (EC) {
-    getMetaDiags()->Report(diag::warn_fe_serialized_diag_failure)
-        << State->OutputFile << EC.message();
-    return;
-  }
+  if (EC)
+    return EC;
 
   // Write the generated bitstream to "Out".
   OS->write((char *)&State->Buffer.front(), State->Buffer.size());
   OS->flush();
+  return std::error_code();
 }
 
 std::error_code SDiagsMerger::visitStartOfDiagnostic() {
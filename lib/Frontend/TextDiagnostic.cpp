@@ -316,6 +316,22 @@ private:
 };
 } // end anonymous namespace
 
+/// \brief The source line shown by the most recent snippet, together with its
+/// byte to column map.
+struct TextDiagnostic::SnippetLine {
+  SnippetLine(const SourceManager *SM, FileID FID, unsigned LineNo,
+              unsigned TabStop, StringRef Line)
+      : SM(SM), FID(FID), LineNo(LineNo), TabStop(TabStop),
+        ColumnMap(Line, TabStop) {}
+
+  const SourceManager *SM;
+  FileID FID;
+  /// \brief The line number, or 0 if the line can't be reused.
+  unsigned LineNo;
+  unsigned TabStop;
+  const SourceColumnMap ColumnMap;
+};
+
 /// \brief When the source code line we want to print is too long for
 /// the terminal, select the "interesting" region.
 static void selectInterestingSourceRegion(std::string &SourceLine,
@@ -1119,16 +1135,28 @@ void TextDiagnostic::emitSnippetAndCaret(
   if (size_t(LineEnd - LineStart) > MaxLineLengthToPrint)
     return;
 
-  // Trim trailing null-bytes.
-  StringRef Line(LineStart, LineEnd - LineStart);
-  while (Line.size() > ColNo && Line.back() == '\0')
-    Line = Line.drop_back();
+  // Build the byte to column map, unless the previous snippet was on the same
+  // line. Headers that produce many diagnostics tend to produce them on the
+  // same line over and over again, e.g. for every instantiation of a template.
+  if (!LastSnippet || LastSnippet->SM != &SM || LastSnippet->FID != FID ||
+      LastSnippet->LineNo != LineNo ||
+      LastSnippet->TabStop != DiagOpts->TabStop) {
+    // Trim trailing null-bytes.
+    StringRef Line(LineStart, LineEnd - LineStart);
+    bool Trimmed = false;
+    while (Line.size() > ColNo && Line.back() == '\0') {
+      Line = Line.drop_back();
+      Trimmed = true;
+    }
+
+    // How much was trimmed depends on the column, so don't reuse such lines.
+    LastSnippet.reset(new SnippetLine(&SM, FID, Trimmed ? 0 : LineNo,
+                                      DiagOpts->TabStop, Line));
+  }
+  const SourceColumnMap &sourceColMap = LastSnippet->ColumnMap;
 
   // Copy the line of code into an std::string for ease of manipulation.
-  std::string SourceLine(Line.begin(), Line.end());
-
-  // Build the byte to column map.
-  const SourceColumnMap sourceColMap(SourceLine, DiagOpts->TabStop);
+  std::string SourceLine = sourceColMap.getSourceLine();
 
   // Create a line for the caret that is filled with spaces that is the same
   // number of columns as the line of source code.
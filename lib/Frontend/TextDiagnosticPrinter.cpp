@@ -18,17 +18,54 @@
 #include "clang/Frontend/TextDiagnostic.h"
 #include "clang/Lex/Lexer.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 using namespace clang;
 
+namespace {
+/// \brief Buffers everything written to an unbuffered stream, such as
+/// llvm::errs(), while it is alive.
+///
+/// A diagnostic is printed with dozens of small writes; with this, it reaches
+/// the terminal with a single write call instead.
+class BufferDiagnosticOutput {
+  raw_ostream &OS;
+  bool WasUnbuffered;
+
+public:
+  explicit BufferDiagnosticOutput(raw_ostream &OS)
+      : OS(OS), WasUnbuffered(OS.GetBufferSize() == 0) {
+    if (WasUnbuffered)
+      OS.SetBufferSize(4096);
+  }
+  ~BufferDiagnosticOutput() {
+    if (WasUnbuffered)
+      OS.SetUnbuffered();
+    else
+      OS.flush();
+  }
+};
+
+/// \brief The warnings in headers printed so far by any printer in this
+/// process.
+struct PrintedHeaderDiagnostics {
+  llvm::sys::Mutex Lock;
+  llvm::StringSet<> Keys;
+};
+} // end anonymous namespace
+
+static llvm::ManagedStatic<PrintedHeaderDiagnostics> PrintedHeaderDiags;
+
 TextDiagnosticPrinter::TextDiagnosticPrinter(raw_ostream &os,
                                              DiagnosticOptions *diags,
                                              bool _OwnsOutputStream)
   : OS(os), DiagOpts(diags),
-    OwnsOutputStream(_OwnsOutputStream) {
+    OwnsOutputStream(_OwnsOutputStream), SuppressNotes(false) {
 }
 
 TextDiagnosticPrinter::~TextDiagnosticPrinter() {
@@ -109,6 +146,34 @@ static void printDiagnosticOptions(raw_ostream &OS,
     OS << ']';
 }
 
+/// \brief Returns true if an identical warning or remark in a header was
+/// already printed by this process.
+static bool isDuplicateHeaderDiagnostic(DiagnosticsEngine::Level Level,
+                                        const Diagnostic &Info,
+                                        StringRef Message) {
+  if (Level != DiagnosticsEngine::Warning &&
+      Level != DiagnosticsEngine::Remark)
+    return false;
+  if (!Info.getLocation().isValid() || !Info.hasSourceManager())
+    return false;
+
+  const SourceManager &SM = Info.getSourceManager();
+  SourceLocation Loc = SM.getExpansionLoc(Info.getLocation());
+  if (SM.isInMainFile(Loc))
+    return false;
+  PresumedLoc PLoc = SM.getPresumedLoc(Loc);
+  if (PLoc.isInvalid())
+    return false;
+
+  SmallString<256> Key;
+  llvm::raw_svector_ostream KeyOS(Key);
+  KeyOS << unsigned(Level) << ':' << PLoc.getFilename() << ':'
+        << PLoc.getLine() << ':' << PLoc.getColumn() << ':' << Message;
+
+  llvm::sys::ScopedLock Guard(PrintedHeaderDiags->Lock);
+  return !PrintedHeaderDiags->Keys.insert(KeyOS.str()).second;
+}
+
 void TextDiagnosticPrinter::HandleDiagnostic(DiagnosticsEngine::Level Level,
                                              const Diagnostic &Info) {
   // Default implementation (Warnings/errors count).
@@ -119,6 +184,19 @@ void TextDiagnosticPrinter::HandleDiagnostic(DiagnosticsEngine::Level Level,
   SmallString<100> OutStr;
   Info.FormatDiagnostic(OutStr);
 
+  // Drop warnings from headers that were already printed for another
+  // translation unit, together with the notes attached to them.
+  if (DiagOpts->DeduplicateHeaderDiagnostics) {
+    if (Level == DiagnosticsEngine::Note) {
+      if (SuppressNotes)
+        return;
+    } else {
+      SuppressNotes = isDuplicateHeaderDiagnostic(Level, Info, OutStr);
+      if (SuppressNotes)
+        return;
+    }
+  }
+
   llvm::raw_svector_ostream DiagMessageStream(OutStr);
   printDiagnosticOptions(DiagMessageStream, Level, Info, *DiagOpts);
 
@@ -128,6 +206,8 @@ void TextDiagnosticPrinter::HandleDiagnostic(DiagnosticsEngine::Level Level,
   // file+line+column number prefix is.
   uint64_t StartOfLocationInfo = OS.tell();
 
+  BufferDiagnosticOutput Buffer(OS);
+
   if (!Prefix.empty())
     OS << Prefix << ": ";
 
@@ -142,7 +222,6 @@ void TextDiagnosticPrinter::HandleDiagnostic(DiagnosticsEngine::Level Level,
                                            OS.tell() - StartOfLocationInfo,
                                            DiagOpts->MessageLength,
                                            DiagOpts->ShowColors);
-    OS.flush();
     return;
   }
 
@@ -156,6 +235,4 @@ void TextDiagnosticPrinter::HandleDiagnostic(DiagnosticsEngine::Level Level,
                            Info.getRanges(),
                            Info.getFixItHints(),
                            &Info.getSourceManager());
-
-  OS.flush();
 }
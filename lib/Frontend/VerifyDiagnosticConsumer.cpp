@@ -18,6 +18,7 @@
 #include "clang/Frontend/TextDiagnosticBuffer.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Regex.h"
 #include "llvm/Support/raw_ostream.h"
@@ -692,25 +693,45 @@ static unsigned CheckLists(DiagnosticsEngine &Diags, SourceManager &SourceMgr,
                            const_diag_iterator d2_end,
                            bool IgnoreUnexpected) {
   std::vector<Directive *> LeftOnly;
-  DiagList Right(d2_begin, d2_end);
+
+  // Bucket the diagnostics by line, so that a directive only looks at those
+  // reported on its line. The buckets keep the order of the diagnostics and
+  // matched diagnostics are only marked, so a directive still matches the
+  // first diagnostic it can.
+  unsigned NumRight = std::distance(d2_begin, d2_end);
+  std::vector<bool> Matched(NumRight);
+  std::vector<unsigned> AllRight(NumRight);
+  llvm::DenseMap<unsigned, SmallVector<unsigned, 2>> RightByLine;
+  for (unsigned I = 0; I != NumRight; ++I) {
+    AllRight[I] = I;
+    RightByLine[SourceMgr.getPresumedLineNumber(d2_begin[I].first)]
+        .push_back(I);
+  }
 
   for (auto &Owner : Left) {
     Directive &D = *Owner;
-    unsigned LineNo1 = SourceMgr.getPresumedLineNumber(D.DiagnosticLoc);
+    ArrayRef<unsigned> Candidates = AllRight;
+    if (!D.MatchAnyLine) {
+      unsigned LineNo1 = SourceMgr.getPresumedLineNumber(D.DiagnosticLoc);
+      auto Bucket = RightByLine.find(LineNo1);
+      if (Bucket == RightByLine.end())
+        Candidates = None;
+      else
+        Candidates = Bucket->second;
+    }
 
+    // The diagnostics before the last match did not match this directive, so
+    // each search resumes after it.
+    ArrayRef<unsigned>::iterator II = Candidates.begin(), IE = Candidates.end();
     for (unsigned i = 0; i < D.Max; ++i) {
-      DiagList::iterator II, IE;
-      for (II = Right.begin(), IE = Right.end(); II != IE; ++II) {
-        if (!D.MatchAnyLine) {
-          unsigned LineNo2 = SourceMgr.getPresumedLineNumber(II->first);
-          if (LineNo1 != LineNo2)
-            continue;
-        }
+      for (; II != IE; ++II) {
+        if (Matched[*II])
+          continue;
 
-        if (!IsFromSameFile(SourceMgr, D.DiagnosticLoc, II->first))
+        if (!IsFromSameFile(SourceMgr, D.DiagnosticLoc, d2_begin[*II].first))
           continue;
 
-        const std::string &RightText = II->second;
+        const std::string &RightText = d2_begin[*II].second;
         if (D.match(RightText))
           break;
       }
@@ -720,10 +741,17 @@ static unsigned CheckLists(DiagnosticsEngine &Diags, SourceManager &SourceMgr,
         LeftOnly.push_back(&D);
       } else {
         // Found. The same cannot be found twice.
-        Right.erase(II);
+        Matched[*II] = true;
+        ++II;
       }
     }
   }
+
+  DiagList Right;
+  for (unsigned I = 0; I != NumRight; ++I)
+    if (!Matched[I])
+      Right.push_back(d2_begin[I]);
+
   // Now all that's left in Right are those that were not matched.
   unsigned num = PrintExpected(Diags, SourceMgr, LeftOnly, Label);
   if (!IgnoreUnexpected)
@@ -22,12 +22,18 @@
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/FrontendPluginRegistry.h"
 #include "clang/Frontend/Utils.h"
+#include "clang/Index/IndexingAction.h"
+#include "clang/Lex/HeaderMap.h"
+#include "clang/Lex/HeaderSearch.h"
 #include "clang/Rewrite/Frontend/FrontendActions.h"
 #include "clang/StaticAnalyzer/Frontend/FrontendActions.h"
+#include "llvm/ADT/Triple.h"
 #include "llvm/Option/OptTable.h"
 #include "llvm/Option/Option.h"
 #include "llvm/Support/DynamicLibrary.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
 using namespace clang;
 using namespace llvm::opt;
 
@@ -106,6 +112,7 @@ CreateFrontendBaseAction(CompilerInstance &CI) {
   case RunAnalysis:            Action = "RunAnalysis"; break;
 #endif
   case RunPreprocessorOnly:    return llvm::make_unique<PreprocessOnlyAction>();
+  case ScanDependencies:       return llvm::make_unique<ScanDependenciesAction>();
   }
 
 #if !defined(CLANG_ENABLE_ARCMT) || !defined(CLANG_ENABLE_STATIC_ANALYZER) \
@@ -165,9 +172,51 @@ CreateFrontendAction(CompilerInstance &CI) {
     Act = llvm::make_unique<ASTMergeAction>(std::move(Act),
                                             FEOpts.ASTMergeFiles);
 
+  // Record the symbols of the translation unit in the index store as a side
+  // effect of compiling it.
+  if (!FEOpts.IndexStorePath.empty())
+    Act = index::createIndexDataRecordingAction(
+        FEOpts.IndexStorePath, FEOpts.OutputFile, std::move(Act));
+
   return Act;
 }
 
+/// \brief Write a header map of the quoted and angled search directories of
+/// \p Clang to FrontendOptions::GenerateHeaderMapPath.
+///
+/// Files are mapped in search order, so looking a header up in the map finds
+/// the file that searching the directories would.
+static bool generateHeaderMap(CompilerInstance &Clang) {
+  Clang.createFileManager();
+  Clang.createSourceManager(Clang.getFileManager());
+  HeaderSearch HS(&Clang.getHeaderSearchOpts(), Clang.getSourceManager(),
+                  Clang.getDiagnostics(), Clang.getLangOpts(),
+                  /*Target=*/nullptr);
+  ApplyHeaderSearchOptions(HS, Clang.getHeaderSearchOpts(),
+                           Clang.getLangOpts(),
+                           llvm::Triple(Clang.getTargetOpts().Triple));
+
+  HeaderMapWriter Writer;
+  for (auto I = HS.quoted_dir_begin(), E = HS.angled_dir_end(); I != E; ++I) {
+    if (!I->isNormalDir())
+      continue;
+    if (std::error_code EC = Writer.addDirectory(I->getName()))
+      Clang.getDiagnostics().Report(diag::err_fe_error_opening)
+          << I->getName() << EC.message();
+  }
+
+  const std::string &Path = Clang.getFrontendOpts().GenerateHeaderMapPath;
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::F_None);
+  if (EC) {
+    Clang.getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+        << Path << EC.message();
+    return false;
+  }
+  Writer.write(OS);
+  return !Clang.getDiagnostics().hasErrorOccurred();
+}
+
 bool clang::ExecuteCompilerInvocation(CompilerInstance *Clang) {
   // Honor -help.
   if (Clang->getFrontendOpts().ShowHelp) {
@@ -234,6 +283,11 @@ bool clang::ExecuteCompilerInvocation(CompilerInstance *Clang) {
   // If there were errors in processing arguments, don't do anything else.
   if (Clang->getDiagnostics().hasErrorOccurred())
     return false;
+
+  // Honor -gen-header-map.
+  if (!Clang->getFrontendOpts().GenerateHeaderMapPath.empty())
+    return generateHeaderMap(*Clang);
+
   // Create and execute the frontend action.
   std::unique_ptr<FrontendAction> Act(CreateFrontendAction(*Clang));
   if (!Act)
@@ -24,62 +24,72 @@
 #ifndef __X86INTRIN_H
 #define __X86INTRIN_H
 
+/* See immintrin.h. */
+#if (!defined(_MSC_VER) && !defined(__CLANG_INTRIN_ENABLED_FEATURES_ONLY)) || \
+    __has_feature(modules)
+#define __X86INTRIN_ALL_FEATURES 1
+#else
+#define __X86INTRIN_ALL_FEATURES 0
+#endif
+
 #include <ia32intrin.h>
 
 #include <immintrin.h>
 
-#if !defined(_MSC_VER) || __has_feature(modules) || defined(__3dNOW__)
+#if __X86INTRIN_ALL_FEATURES || defined(__3dNOW__)
 #include <mm3dnow.h>
 #endif
 
-#if !defined(_MSC_VER) || __has_feature(modules) || defined(__BMI__)
+#if __X86INTRIN_ALL_FEATURES || defined(__BMI__)
 #include <bmiintrin.h>
 #endif
 
-#if !defined(_MSC_VER) || __has_feature(modules) || defined(__BMI2__)
+#if __X86INTRIN_ALL_FEATURES || defined(__BMI2__)
 #include <bmi2intrin.h>
 #endif
 
-#if !defined(_MSC_VER) || __has_feature(modules) || defined(__LZCNT__)
+#if __X86INTRIN_ALL_FEATURES || defined(__LZCNT__)
 #include <lzcntintrin.h>
 #endif
 
-#if !defined(_MSC_VER) || __has_feature(modules) || defined(__POPCNT__)
+#if __X86INTRIN_ALL_FEATURES || defined(__POPCNT__)
 #include <popcntintrin.h>
 #endif
 
-#if !defined(_MSC_VER) || __has_feature(modules) || defined(__RDSEED__)
+#if __X86INTRIN_ALL_FEATURES || defined(__RDSEED__)
 #include <rdseedintrin.h>
 #endif
 
-#if !defined(_MSC_VER) || __has_feature(modules) || defined(__PRFCHW__)
+#if __X86INTRIN_ALL_FEATURES || defined(__PRFCHW__)
 #include <prfchwintrin.h>
 #endif
 
-#if !defined(_MSC_VER) || __has_feature(modules) || defined(__SSE4A__)
+#if __X86INTRIN_ALL_FEATURES || defined(__SSE4A__)
 #include <ammintrin.h>
 #endif
 
-#if !defined(_MSC_VER) || __has_feature(modules) || defined(__FMA4__)
+#if __X86INTRIN_ALL_FEATURES || defined(__FMA4__)
 #include <fma4intrin.h>
 #endif
 
-#if !defined(_MSC_VER) || __has_feature(modules) || defined(__XOP__)
+#if __X86INTRIN_ALL_FEATURES || defined(__XOP__)
 #include <xopintrin.h>
 #endif
 
-#if !defined(_MSC_VER) || __has_feature(modules) || defined(__TBM__)
+#if __X86INTRIN_ALL_FEATURES || defined(__TBM__)
 #include <tbmintrin.h>
 #endif
 
-#if !defined(_MSC_VER) || __has_feature(modules) || defined(__F16C__)
+#if __X86INTRIN_ALL_FEATURES || defined(__F16C__)
 #include <f16cintrin.h>
 #endif
 
-#if !defined(_MSC_VER) || __has_feature(modules) || defined(__MWAITX__)
+#if __X86INTRIN_ALL_FEATURES || defined(__MWAITX__)
 #include <mwaitxintrin.h>
 #endif
 
 /* FIXME: LWP */
 
+#undef __X86INTRIN_ALL_FEATURES
+
 #endif /* __X86INTRIN_H */
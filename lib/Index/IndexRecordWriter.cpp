@@ -0,0 +1,208 @@
+//===--- IndexRecordWriter.cpp - Index store writer -----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "IndexRecordWriter.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/Basic/DiagnosticFrontend.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Index/USRGeneration.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace clang;
+using namespace clang::index;
+
+/// The first line of every record and unit file.  Bump the version when the
+/// format changes.
+static const char RecordSignature[] = "clang-index-record 1";
+static const char UnitSignature[] = "clang-index-unit 1";
+
+/// \brief Return the first 16 hex digits of the MD5 hash of \p Str.
+static std::string hashString(StringRef Str) {
+  llvm::MD5 Hash;
+  llvm::MD5::MD5Result Result;
+  Hash.update(Str);
+  Hash.final(Result);
+  SmallString<32> Hex;
+  llvm::MD5::stringifyResult(Result, Hex);
+  return Hex.substr(0, 16);
+}
+
+StringRef IndexRecordWriter::getUSR(const Decl *D) {
+  auto Known = USRs.find(D);
+  if (Known != USRs.end())
+    return Known->second;
+
+  SmallString<128> Buf;
+  if (generateUSRForDecl(D, Buf))
+    Buf.clear();
+  return USRs[D] = Buf.str();
+}
+
+unsigned IndexRecordWriter::getSymbol(FileRecord &Record, const Decl *D) {
+  auto Inserted =
+      Record.SymbolIndex.insert(std::make_pair(D, Record.Symbols.size()));
+  if (Inserted.second)
+    Record.Symbols.push_back(D);
+  return Inserted.first->second;
+}
+
+bool IndexRecordWriter::handleDeclOccurence(const Decl *D, SymbolRoleSet Roles,
+                                            ArrayRef<SymbolRelation> Relations,
+                                            FileID FID, unsigned Offset,
+                                            ASTNodeInfo ASTNode) {
+  // Only occurrences in files can be looked up again later.
+  if (FID.isInvalid() || !Ctx->getSourceManager().getFileEntryForID(FID))
+    return true;
+
+  D = D->getCanonicalDecl();
+  if (getUSR(D).empty())
+    return true;
+
+  FileRecord &Record = Files[FID];
+  Occurrence Occ;
+  Occ.Offset = Offset;
+  Occ.Symbol = getSymbol(Record, D);
+  Occ.Roles = Roles;
+  for (const SymbolRelation &Rel : Relations) {
+    const Decl *Related = Rel.RelatedSymbol->getCanonicalDecl();
+    if (!getUSR(Related).empty())
+      Occ.Relations.push_back(
+          std::make_pair(Rel.Roles, getSymbol(Record, Related)));
+  }
+  Record.Occurrences.push_back(std::move(Occ));
+  return true;
+}
+
+std::string IndexRecordWriter::printRecord(FileID FID, FileRecord &Record) {
+  const SourceManager &SM = Ctx->getSourceManager();
+  std::string Contents;
+  llvm::raw_string_ostream OS(Contents);
+  OS << RecordSignature << '\n';
+
+  for (const Decl *D : Record.Symbols) {
+    StringRef USR = getUSR(D);
+    SymbolInfo Info = getSymbolInfo(D);
+    OS << "symbol\t" << hashString(USR) << '\t'
+       << getSymbolKindString(Info.Kind) << '\t'
+       << getSymbolLanguageString(Info.Lang) << '\t' << USR << '\t';
+    printSymbolName(D, Ctx->getLangOpts(), OS);
+    OS << '\n';
+  }
+
+  // Occurrences are reported in the order the AST is traversed; sort them so
+  // that the same file always gets the same record.
+  std::stable_sort(Record.Occurrences.begin(), Record.Occurrences.end(),
+                   [](const Occurrence &LHS, const Occurrence &RHS) {
+                     return LHS.Offset < RHS.Offset;
+                   });
+  for (const Occurrence &Occ : Record.Occurrences) {
+    OS << "occ\t" << Occ.Symbol << '\t'
+       << llvm::format_hex_no_prefix(Occ.Roles, 1) << '\t'
+       << SM.getLineNumber(FID, Occ.Offset) << '\t'
+       << SM.getColumnNumber(FID, Occ.Offset);
+    for (const auto &Rel : Occ.Relations)
+      OS << '\t' << llvm::format_hex_no_prefix(Rel.first, 1) << ':'
+         << Rel.second;
+    OS << '\n';
+  }
+  return OS.str();
+}
+
+bool IndexRecordWriter::writeFile(StringRef Path, StringRef Contents,
+                                  bool Overwrite) {
+  if (!Overwrite && llvm::sys::fs::exists(Path))
+    return false;
+
+  // Write to a temporary file first, so that readers and other compilations
+  // writing the same file never see a partial one.
+  SmallString<128> TempPath(Path);
+  TempPath += "-%%%%%%%%";
+  int FD;
+  if (llvm::sys::fs::createUniqueFile(TempPath, FD, TempPath))
+    return true;
+
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << Contents;
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return true;
+    }
+  }
+
+  if (llvm::sys::fs::rename(TempPath, Path)) {
+    llvm::sys::fs::remove(TempPath);
+    return true;
+  }
+  return false;
+}
+
+void IndexRecordWriter::finish() {
+  if (!Ctx)
+    return;
+
+  const SourceManager &SM = Ctx->getSourceManager();
+  const FileEntry *MainFile = SM.getFileEntryForID(SM.getMainFileID());
+  StringRef MainPath = MainFile ? MainFile->getName() : "";
+
+  SmallString<128> RecordsDir(StorePath), UnitsDir(StorePath);
+  llvm::sys::path::append(RecordsDir, "records");
+  llvm::sys::path::append(UnitsDir, "units");
+  auto Fail = [&](StringRef Path) {
+    Ctx->getDiagnostics().Report(diag::warn_fe_index_store_write_failure)
+        << Path;
+  };
+  if (llvm::sys::fs::create_directories(RecordsDir))
+    return Fail(RecordsDir);
+  if (llvm::sys::fs::create_directories(UnitsDir))
+    return Fail(UnitsDir);
+
+  // Write the record of each file, unless an identical one exists already.
+  std::vector<std::pair<std::string, std::string>> Records;
+  for (auto &File : Files) {
+    StringRef Path = SM.getFileEntryForID(File.first)->getName();
+    std::string Contents = printRecord(File.first, File.second);
+    std::string Name = llvm::sys::path::filename(Path).str() + "-" +
+                       hashString(Contents);
+    SmallString<128> RecordPath(RecordsDir);
+    llvm::sys::path::append(RecordPath, Name);
+    if (writeFile(RecordPath, Contents, /*Overwrite=*/false))
+      return Fail(RecordPath);
+    Records.push_back(std::make_pair(Path.str(), std::move(Name)));
+  }
+  std::sort(Records.begin(), Records.end());
+
+  // The unit is identified by its output file and main file, so that
+  // rebuilding it replaces its old unit file.
+  std::string Contents;
+  llvm::raw_string_ostream OS(Contents);
+  OS << UnitSignature << '\n';
+  OS << "main\t" << MainPath << '\n';
+  OS << "output\t" << OutputFile << '\n';
+  for (const auto &Record : Records)
+    OS << "record\t" << Record.second << '\t' << Record.first << '\n';
+  OS.flush();
+
+  StringRef UnitFile = OutputFile.empty() ? MainPath : StringRef(OutputFile);
+  SmallString<128> UnitPath(UnitsDir);
+  llvm::sys::path::append(UnitPath,
+                          llvm::sys::path::filename(UnitFile).str() + "-" +
+                              hashString(OutputFile + '\0' + MainPath.str()));
+  if (writeFile(UnitPath, Contents, /*Overwrite=*/true))
+    return Fail(UnitPath);
+}
@@ -0,0 +1,103 @@
+//===--- IndexRecordWriter.h - Index store writer ---------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LIB_INDEX_INDEXRECORDWRITER_H
+#define LLVM_CLANG_LIB_INDEX_INDEXRECORDWRITER_H
+
+#include "clang/Basic/SourceLocation.h"
+#include "clang/Index/IndexDataConsumer.h"
+#include "llvm/ADT/DenseMap.h"
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace index {
+
+/// \brief Writes the symbol occurrences of a translation unit to an index
+/// store on disk.
+///
+/// The store has two directories.  "records" holds one file per source file
+/// with the symbols occurring in it, named after a hash of its contents, so
+/// that a header included by many translation units is only written once for
+/// each distinct set of occurrences.  "units" holds one file per translation
+/// unit listing the records of the files it consists of.
+///
+/// Both are text files whose lines are made of tab-separated fields.  A record
+/// lists each symbol once, as
+///
+///   symbol <USR hash> <kind> <language> <USR> <name>
+///
+/// followed by its occurrences, which refer to symbols by their position in
+/// that list:
+///
+///   occ <symbol> <roles> <line> <column> [<relation roles>:<symbol>]...
+///
+/// Roles are SymbolRoleSets written in hexadecimal.
+class IndexRecordWriter : public IndexDataConsumer {
+public:
+  IndexRecordWriter(StringRef StorePath, StringRef OutputFile)
+      : StorePath(StorePath), OutputFile(OutputFile) {}
+
+  void initialize(ASTContext &Ctx) override { this->Ctx = &Ctx; }
+
+  bool handleDeclOccurence(const Decl *D, SymbolRoleSet Roles,
+                           ArrayRef<SymbolRelation> Relations,
+                           FileID FID, unsigned Offset,
+                           ASTNodeInfo ASTNode) override;
+
+  void finish() override;
+
+private:
+  struct Occurrence {
+    unsigned Offset;
+    unsigned Symbol;
+    SymbolRoleSet Roles;
+    std::vector<std::pair<SymbolRoleSet, unsigned>> Relations;
+  };
+
+  /// \brief The symbols occurring in a single file.
+  struct FileRecord {
+    /// \brief The canonical declarations of the symbols, in the order of their
+    /// first occurrence, and their index in that list.
+    std::vector<const Decl *> Symbols;
+    llvm::DenseMap<const Decl *, unsigned> SymbolIndex;
+    std::vector<Occurrence> Occurrences;
+  };
+
+  std::string StorePath;
+  std::string OutputFile;
+  ASTContext *Ctx = nullptr;
+
+  llvm::DenseMap<FileID, FileRecord> Files;
+
+  /// \brief The USR of each canonical declaration, or an empty string if it
+  /// doesn't have one.
+  llvm::DenseMap<const Decl *, std::string> USRs;
+
+  /// \brief Return the USR of the canonical declaration \p D.
+  StringRef getUSR(const Decl *D);
+
+  /// \brief Add the canonical declaration \p D to the symbols of \p Record if
+  /// needed and return its index.
+  unsigned getSymbol(FileRecord &Record, const Decl *D);
+
+  /// \brief Format the record of \p FID.
+  std::string printRecord(FileID FID, FileRecord &Record);
+
+  /// \brief Write \p Contents to \p Path, unless \p Path exists and
+  /// \p Overwrite is false.
+  ///
+  /// \returns true on failure.
+  bool writeFile(StringRef Path, StringRef Contents, bool Overwrite);
+};
+
+} // namespace index
+} // namespace clang
+
+#endif
@@ -9,6 +9,7 @@
 
 #include "clang/Index/IndexingAction.h"
 #include "clang/Index/IndexDataConsumer.h"
+#include "IndexRecordWriter.h"
 #include "IndexingContext.h"
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Frontend/MultiplexConsumer.h"
@@ -156,6 +157,14 @@ index::createIndexingAction(std::shared_ptr<IndexDataConsumer> DataConsumer,
   return llvm::make_unique<IndexAction>(std::move(DataConsumer), Opts);
 }
 
+std::unique_ptr<FrontendAction>
+index::createIndexDataRecordingAction(
+    StringRef StorePath, StringRef OutputFile,
+    std::unique_ptr<FrontendAction> WrappedAction) {
+  return createIndexingAction(
+      std::make_shared<IndexRecordWriter>(StorePath, OutputFile),
+      IndexingOptions(), std::move(WrappedAction));
+}
 
 static bool topLevelDeclVisitor(void *context, const Decl *D) {
   IndexingContext &IndexCtx = *static_cast<IndexingContext*>(context);
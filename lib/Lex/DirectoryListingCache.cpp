@@ -0,0 +1,95 @@
+//===--- DirectoryListingCache.cpp - Directory contents cache -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the DirectoryListingCache interface.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/DirectoryListingCache.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/TimeValue.h"
+
+using namespace clang;
+
+/// Directories modified less than this many seconds before they are listed
+/// are not cached: a later change in the same timestamp tick would not
+/// change their modification time.
+static const uint64_t RacyModTimeWindow = 2;
+
+DirectoryListingCache &DirectoryListingCache::getShared() {
+  static DirectoryListingCache Shared;
+  return Shared;
+}
+
+std::shared_ptr<const DirectoryListingCache::Listing>
+DirectoryListingCache::get(StringRef Dir) {
+  SmallString<256> Path(Dir);
+  if (llvm::sys::fs::make_absolute(Path))
+    return nullptr;
+
+  llvm::sys::fs::file_status Status;
+  if (llvm::sys::fs::status(Path, Status) ||
+      !llvm::sys::fs::is_directory(Status))
+    return nullptr;
+  uint64_t ModTime = Status.getLastModificationTime().toEpochTime();
+
+  {
+    llvm::MutexGuard Guard(Lock);
+    auto Known = Entries.find(Path);
+    if (Known != Entries.end()) {
+      if (Known->second.UniqueID == Status.getUniqueID() &&
+          Known->second.ModTime == ModTime)
+        return Known->second.Names;
+      Entries.erase(Known);
+    }
+  }
+
+  uint64_t Now = llvm::sys::TimeValue::now().toEpochTime();
+  if (ModTime + RacyModTimeWindow >= Now)
+    return nullptr;
+
+  auto Names = std::make_shared<Listing>();
+  std::error_code EC;
+  for (llvm::sys::fs::directory_iterator I(Path, EC), E; I != E;
+       I.increment(EC)) {
+    if (EC)
+      return nullptr;
+    Names->insert(llvm::sys::path::filename(I->path()).lower());
+  }
+  if (EC)
+    return nullptr;
+
+  // Concurrent compilations may have listed the directory in the meantime;
+  // their listing is as good as ours.
+  llvm::MutexGuard Guard(Lock);
+  Entry &Slot = Entries[Path];
+  Slot.UniqueID = Status.getUniqueID();
+  Slot.ModTime = ModTime;
+  Slot.Names = std::move(Names);
+  return Slot.Names;
+}
+
+bool DirectoryListingCache::getListedName(StringRef Filename,
+                                          std::string &Name) {
+  if (llvm::sys::path::is_absolute(Filename))
+    return false;
+  auto First = llvm::sys::path::begin(Filename);
+  if (First == llvm::sys::path::end(Filename) || *First == "." ||
+      *First == "..")
+    return false;
+  Name = First->lower();
+  return true;
+}
+
+unsigned DirectoryListingCache::size() {
+  llvm::MutexGuard Guard(Lock);
+  return Entries.size();
+}
@@ -16,14 +16,20 @@
 #include "clang/Basic/CharInfo.h"
 #include "clang/Basic/FileManager.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/DataTypes.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/SwapByteOrder.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <cstring>
 #include <memory>
+#include <set>
 using namespace clang;
 
 /// HashHMapKey - This is the 'well known' hash function required by the file
@@ -240,3 +246,109 @@ StringRef HeaderMapImpl::lookupFilename(StringRef Filename,
     return StringRef(DestPath.begin(), DestPath.size());
   }
 }
+
+//===----------------------------------------------------------------------===//
+// Writing
+//===----------------------------------------------------------------------===//
+
+bool HeaderMapWriter::insert(StringRef Key, StringRef Path) {
+  if (Key.empty() || !LowercaseKeys.insert(Key.lower()).second)
+    return false;
+  Entries.emplace_back(Key.str(), Path.str());
+  return true;
+}
+
+std::error_code HeaderMapWriter::addDirectory(StringRef Dir) {
+  // Directories reached again through symlinks are not walked twice, which
+  // also keeps symlink cycles from recursing forever.
+  std::set<llvm::sys::fs::UniqueID> Visited;
+  llvm::sys::fs::file_status Status;
+  if (std::error_code EC = llvm::sys::fs::status(Dir, Status))
+    return EC;
+  Visited.insert(Status.getUniqueID());
+
+  std::error_code EC;
+  for (llvm::sys::fs::recursive_directory_iterator I(Dir, EC), E;
+       I != E && !EC; I.increment(EC)) {
+    StringRef Path = I->path();
+    if (I->status(Status))
+      continue;
+    if (llvm::sys::fs::is_directory(Status)) {
+      if (!Visited.insert(Status.getUniqueID()).second)
+        I.no_push();
+      continue;
+    }
+    if (!llvm::sys::fs::is_regular_file(Status))
+      continue;
+
+    // Build the key from the components below Dir.
+    StringRef Relative = Path.substr(Dir.size());
+    SmallString<128> Key;
+    for (auto C = llvm::sys::path::begin(Relative),
+              CE = llvm::sys::path::end(Relative);
+         C != CE; ++C) {
+      if (llvm::sys::path::is_separator((*C)[0]))
+        continue;
+      if (!Key.empty())
+        Key += '/';
+      Key += *C;
+    }
+    insert(Key, Path);
+  }
+  return EC;
+}
+
+void HeaderMapWriter::write(raw_ostream &OS) const {
+  // Keep the table at most half full so that probing always ends at an empty
+  // bucket.
+  uint32_t NumBuckets = llvm::NextPowerOf2(Entries.size() * 2);
+  std::vector<HMapBucket> Buckets(NumBuckets);
+
+  // Offset 0 is the empty bucket key, so the string pool starts with an
+  // unused byte.
+  std::string Strings(1, '\0');
+  llvm::StringMap<uint32_t> StringOffsets;
+  auto addString = [&](StringRef S) -> uint32_t {
+    auto Known = StringOffsets.insert(std::make_pair(S, Strings.size()));
+    if (Known.second) {
+      Strings.append(S.begin(), S.end());
+      Strings += '\0';
+    }
+    return Known.first->second;
+  };
+
+  uint32_t MaxValueLength = 0;
+  for (const auto &Entry : Entries) {
+    StringRef Key = Entry.first;
+    StringRef Path = Entry.second;
+    StringRef Suffix = llvm::sys::path::filename(Path);
+    StringRef Prefix = Path.drop_back(Suffix.size());
+    MaxValueLength = std::max<uint32_t>(MaxValueLength, Path.size());
+
+    HMapBucket B;
+    B.Key = addString(Key);
+    B.Prefix = addString(Prefix);
+    B.Suffix = addString(Suffix);
+    for (unsigned Bucket = HashHMapKey(Key);; ++Bucket) {
+      HMapBucket &Slot = Buckets[Bucket & (NumBuckets - 1)];
+      if (Slot.Key == HMAP_EmptyBucketKey) {
+        Slot = B;
+        break;
+      }
+    }
+  }
+
+  HMapHeader Header;
+  Header.Magic = HMAP_HeaderMagicNumber;
+  Header.Version = HMAP_HeaderVersion;
+  Header.Reserved = 0;
+  Header.StringsOffset = sizeof(HMapHeader) + sizeof(HMapBucket) * NumBuckets;
+  Header.NumEntries = Entries.size();
+  Header.NumBuckets = NumBuckets;
+  Header.MaxValueLength = MaxValueLength;
+
+  OS.write(reinterpret_cast<const char *>(&Header), sizeof(Header));
+  OS.write(reinterpret_cast<const char *>(Buckets.data()),
+           sizeof(HMapBucket) * NumBuckets);
+  OS << Strings;
+}
@@ -14,14 +14,18 @@
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/IdentifierTable.h"
+#include "clang/Lex/DirectoryListingCache.h"
 #include "clang/Lex/ExternalPreprocessorSource.h"
 #include "clang/Lex/HeaderMap.h"
 #include "clang/Lex/HeaderSearchOptions.h"
+#include "clang/Lex/IncludeGuardCache.h"
 #include "clang/Lex/LexDiagnostic.h"
+#include "clang/Lex/ModuleMapCache.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Capacity.h"
 #include "llvm/Support/FileSystem.h"
@@ -67,7 +71,18 @@ HeaderSearch::HeaderSearch(IntrusiveRefCntPtr<HeaderSearchOptions> HSOpts,
   ExternalSource = nullptr;
   NumIncluded = 0;
   NumMultiIncludeFileOptzn = 0;
+  NumIncludeGuardCacheOptzn = 0;
+  NumDirListingCacheOptzn = 0;
+  NumModuleMapCacheOptzn = 0;
+  SearchDirListingsValid = false;
   NumFrameworkLookups = NumSubFrameworkLookups = 0;
+
+  if (!this->HSOpts->IncludeGuardCachePath.empty())
+    GuardCache = llvm::make_unique<IncludeGuardCache>(
+        this->HSOpts->IncludeGuardCachePath);
+  if (!this->HSOpts->ModuleMapCachePath.empty())
+    MapCache = llvm::make_unique<ModuleMapCache>(
+        this->HSOpts->ModuleMapCachePath);
 }
 
 HeaderSearch::~HeaderSearch() {
@@ -93,6 +108,15 @@ void HeaderSearch::PrintStats() {
   fprintf(stderr, "  %d #include/#include_next/#import.\n", NumIncluded);
   fprintf(stderr, "    %d #includes skipped due to"
           " the multi-include optimization.\n", NumMultiIncludeFileOptzn);
+  if (GuardCache)
+    fprintf(stderr, "    %d #includes skipped due to the include guard cache"
+            " (%d entries).\n", NumIncludeGuardCacheOptzn, GuardCache->size());
+  if (HSOpts->UseDirectoryListingCache)
+    fprintf(stderr, "%d header lookups skipped due to the directory listing"
+            " cache.\n", NumDirListingCacheOptzn);
+  if (MapCache)
+    fprintf(stderr, "%d module map files not parsed due to the module map"
+            " cache (%d entries).\n", NumModuleMapCacheOptzn, MapCache->size());
 
   fprintf(stderr, "%d framework lookups.\n", NumFrameworkLookups);
   fprintf(stderr, "%d subframework lookups.\n", NumSubFrameworkLookups);
@@ -222,8 +246,8 @@ Module *HeaderSearch::lookupModule(StringRef ModuleName, bool AllowSearch) {
       continue;
 
     // Load all module maps in the immediate subdirectories of this search
-    // directory.
-    loadSubdirectoryModuleMaps(SearchDirs[Idx]);
+    // directory that can declare the module.
+    loadSubdirectoryModuleMaps(SearchDirs[Idx], ModuleName);
 
     // Look again for the module.
     Module = ModMap.findModule(ModuleName);
@@ -558,6 +582,44 @@ static const char *copyString(StringRef Str, llvm::BumpPtrAllocator &Alloc) {
   return CopyStr;
 }
 
+void HeaderSearch::buildSearchDirListings() {
+  SearchDirListings.clear();
+  ListedSearchDirs.clear();
+  ListedSearchDirs.resize(SearchDirs.size());
+  for (unsigned I = 0, E = SearchDirs.size(); I != E; ++I) {
+    if (!SearchDirs[I].isNormalDir())
+      continue;
+    SmallString<256> DirName(SearchDirs[I].getDir()->getName());
+    FileMgr.FixupRelativePath(DirName);
+    auto Listing = DirectoryListingCache::getShared().get(DirName);
+    if (!Listing)
+      continue;
+    ListedSearchDirs.set(I);
+    for (const auto &Name : *Listing)
+      SearchDirListings[Name.getKey()].push_back(I);
+  }
+  SearchDirListingsValid = true;
+}
+
+bool HeaderSearch::lookupSearchDirListings(
+    StringRef Filename, const SmallVectorImpl<unsigned> *&Dirs) {
+  // Only the real file system can be listed, and virtual files are not in
+  // any listing.
+  if (!HSOpts->UseDirectoryListingCache || FileMgr.hasVirtualFiles() ||
+      FileMgr.getVirtualFileSystem() != vfs::getRealFileSystem())
+    return false;
+
+  std::string Name;
+  if (!DirectoryListingCache::getListedName(Filename, Name))
+    return false;
+
+  if (!SearchDirListingsValid)
+    buildSearchDirListings();
+  auto Known = SearchDirListings.find(Name);
+  Dirs = Known == SearchDirListings.end() ? nullptr : &Known->second;
+  return true;
+}
+
 /// LookupFile - Given a "foo" or \<foo> reference, look up the indicated file,
 /// return null on failure.  isAngled indicates whether the file reference is
 /// for system \#include's or not (i.e. using <> instead of ""). Includers, if
@@ -710,8 +772,18 @@ const FileEntry *HeaderSearch::LookupFile(
 
   SmallString<64> MappedName;
 
+  const SmallVectorImpl<unsigned> *ListingDirs = nullptr;
+  bool UseListings = lookupSearchDirListings(Filename, ListingDirs);
+
   // Check each directory in sequence to see if it contains this file.
   for (; i != SearchDirs.size(); ++i) {
+    if (UseListings && ListedSearchDirs.test(i) &&
+        (!ListingDirs ||
+         !std::binary_search(ListingDirs->begin(), ListingDirs->end(), i))) {
+      ++NumDirListingCacheOptzn;
+      continue;
+    }
+
     bool InUserSpecifiedSystemFramework = false;
     bool HasBeenMapped = false;
     const FileEntry *FE = SearchDirs[i].LookupFile(
@@ -1071,6 +1143,15 @@ bool HeaderSearch::ShouldEnterIncludeFile(Preprocessor &PP,
       ++NumMultiIncludeFileOptzn;
       return false;
     }
+  } else if (GuardCache && !M && !FileInfo.NumIncludes) {
+    // We haven't lexed this file yet, but an earlier compilation found it to
+    // be guarded.  If the macro is already defined we don't need to read it.
+    StringRef MacroName = GuardCache->lookup(File);
+    if (!MacroName.empty() &&
+        PP.isMacroDefined(PP.getIdentifierInfo(MacroName))) {
+      ++NumIncludeGuardCacheOptzn;
+      return false;
+    }
   }
 
   // Increment the number of times this file has been included.
@@ -1079,6 +1160,26 @@ bool HeaderSearch::ShouldEnterIncludeFile(Preprocessor &PP,
   return true;
 }
 
+void HeaderSearch::SetFileControllingMacro(
+    const FileEntry *File, const IdentifierInfo *ControllingMacro) {
+  getFileInfo(File).ControllingMacro = ControllingMacro;
+  if (GuardCache)
+    GuardCache->insert(File, ControllingMacro->getName());
+}
+
+void HeaderSearch::saveIncludeGuardCache() {
+  // The cache is purely an optimization, so failing to update it is not worth
+  // a diagnostic; the next compilation will simply try again.
+  if (GuardCache)
+    GuardCache->save(HSOpts->IncludeGuardCachePath);
+}
+
+void HeaderSearch::saveModuleMapCache() {
+  // Like the include guard cache, this is purely an optimization.
+  if (MapCache)
+    MapCache->save(HSOpts->ModuleMapCachePath);
+}
+
 size_t HeaderSearch::getTotalMemory() const {
   return SearchDirs.capacity()
     + llvm::capacity_in_bytes(FileInfo)
@@ -1243,6 +1344,8 @@ HeaderSearch::loadModuleMapFileImpl(const FileEntry *File, bool IsSystem,
     LoadedModuleMaps[File] = false;
     return LMM_InvalidModuleMap;
   }
+  if (MapCache)
+    MapCache->insert(File, ModMap.getDeclaredModules(File));
 
   // Try to load a corresponding private module map.
   if (const FileEntry *PMMFile = getPrivateModuleMap(File, FileMgr)) {
@@ -1250,6 +1353,8 @@ HeaderSearch::loadModuleMapFileImpl(const FileEntry *File, bool IsSystem,
       LoadedModuleMaps[File] = false;
       return LMM_InvalidModuleMap;
     }
+    if (MapCache)
+      MapCache->insert(PMMFile, ModMap.getDeclaredModules(PMMFile));
   }
 
   // This directory has a module map.
@@ -1404,13 +1509,27 @@ void HeaderSearch::loadTopLevelSystemModules() {
   }
 }
 
-void HeaderSearch::loadSubdirectoryModuleMaps(DirectoryLookup &SearchDir) {
+bool HeaderSearch::mayDeclareModule(const DirectoryEntry *Dir,
+                                    bool IsFramework, StringRef ModuleName) {
+  if (!MapCache || ModuleName.empty() || DirectoryHasModuleMap.count(Dir))
+    return true;
+  const FileEntry *File = lookupModuleMapFile(Dir, IsFramework);
+  if (!File || LoadedModuleMaps.count(File) ||
+      MapCache->mayDeclare(File, ModuleName))
+    return true;
+  const FileEntry *PMMFile = getPrivateModuleMap(File, FileMgr);
+  return PMMFile && MapCache->mayDeclare(PMMFile, ModuleName);
+}
+
+void HeaderSearch::loadSubdirectoryModuleMaps(DirectoryLookup &SearchDir,
+                                              StringRef ModuleName) {
   assert(HSOpts->ImplicitModuleMaps &&
          "Should not be loading subdirectory module maps");
 
   if (SearchDir.haveSearchedAllModuleMaps())
     return;
 
+  bool SkippedModuleMaps = false;
   std::error_code EC;
   SmallString<128> DirNative;
   llvm::sys::path::native(SearchDir.getDir()->getName(), DirNative);
@@ -1419,12 +1538,24 @@ void HeaderSearch::loadSubdirectoryModuleMaps(DirectoryLookup &SearchDir) {
        Dir != DirEnd && !EC; Dir.increment(EC)) {
     bool IsFramework =
         llvm::sys::path::extension(Dir->getName()) == ".framework";
-    if (IsFramework == SearchDir.isFramework())
-      loadModuleMapFile(Dir->getName(), SearchDir.isSystemHeaderDirectory(),
-                        SearchDir.isFramework());
+    if (IsFramework != SearchDir.isFramework())
+      continue;
+
+    // Leave module maps that cannot declare the module we are looking for
+    // unparsed until somebody needs them.
+    const DirectoryEntry *SubDir = FileMgr.getDirectory(Dir->getName());
+    if (SubDir &&
+        !mayDeclareModule(SubDir, SearchDir.isFramework(), ModuleName)) {
+      ++NumModuleMapCacheOptzn;
+      SkippedModuleMaps = true;
+      continue;
+    }
+    loadModuleMapFile(Dir->getName(), SearchDir.isSystemHeaderDirectory(),
+                      SearchDir.isFramework());
   }
 
-  SearchDir.setSearchedAllModuleMaps(true);
+  if (!SkippedModuleMaps)
+    SearchDir.setSearchedAllModuleMaps(true);
 }
 
 std::string HeaderSearch::suggestPathToFileForDiagnostics(const FileEntry *File,
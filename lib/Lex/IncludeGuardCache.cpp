@@ -0,0 +1,113 @@
+//===--- IncludeGuardCache.cpp - Persistent include guard cache -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the IncludeGuardCache interface.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/IncludeGuardCache.h"
+#include "clang/Basic/FileManager.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+
+/// The first line of every cache file.  Bump the version when the format
+/// changes; files with a different signature are ignored.
+static const char Signature[] = "clang-include-guard-cache 1";
+
+void IncludeGuardCache::read(StringRef Path) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return;
+
+  StringRef Contents = (*Buffer)->getBuffer();
+  StringRef Line;
+  std::tie(Line, Contents) = Contents.split('\n');
+  if (Line != Signature)
+    return;
+
+  // Each line is "<device> <inode> <size> <mtime> <macro>".
+  while (!Contents.empty()) {
+    std::tie(Line, Contents) = Contents.split('\n');
+    SmallVector<StringRef, 5> Fields;
+    Line.split(Fields, ' ');
+    uint64_t Device, Inode;
+    long long Size, ModTime;
+    if (Fields.size() != 5 || Fields[0].getAsInteger(10, Device) ||
+        Fields[1].getAsInteger(10, Inode) ||
+        Fields[2].getAsInteger(10, Size) ||
+        Fields[3].getAsInteger(10, ModTime) || Fields[4].empty())
+      continue;
+
+    Entry E = {static_cast<off_t>(Size), static_cast<time_t>(ModTime),
+               Fields[4].str()};
+    Entries.insert(
+        std::make_pair(llvm::sys::fs::UniqueID(Device, Inode), std::move(E)));
+  }
+}
+
+StringRef IncludeGuardCache::lookup(const FileEntry *File) const {
+  auto I = Entries.find(File->getUniqueID());
+  if (I == Entries.end() || I->second.Size != File->getSize() ||
+      I->second.ModTime != File->getModificationTime())
+    return StringRef();
+  return I->second.Macro;
+}
+
+void IncludeGuardCache::insert(const FileEntry *File, StringRef Macro) {
+  Entry &E = Entries[File->getUniqueID()];
+  if (E.Size == File->getSize() && E.ModTime == File->getModificationTime() &&
+      E.Macro == Macro)
+    return;
+  E.Size = File->getSize();
+  E.ModTime = File->getModificationTime();
+  E.Macro = Macro;
+  Dirty = true;
+}
+
+bool IncludeGuardCache::save(StringRef Path) {
+  if (!Dirty)
+    return false;
+
+  // Pick up whatever other compilations wrote since we loaded the cache.
+  read(Path);
+
+  SmallString<128> TempPath(Path);
+  TempPath += "-%%%%%%%%";
+  int FD;
+  if (llvm::sys::fs::createUniqueFile(TempPath, FD, TempPath))
+    return true;
+
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << Signature << '\n';
+    for (const auto &I : Entries)
+      OS << I.first.getDevice() << ' ' << I.first.getFile() << ' '
+         << (long long)I.second.Size << ' ' << (long long)I.second.ModTime
+         << ' ' << I.second.Macro << '\n';
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return true;
+    }
+  }
+
+  if (llvm::sys::fs::rename(TempPath, Path)) {
+    llvm::sys::fs::remove(TempPath);
+    return true;
+  }
+  Dirty = false;
+  return false;
+}
@@ -26,6 +26,12 @@
 #include "llvm/Support/ConvertUTF.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif __ALTIVEC__
+#include <altivec.h>
+#undef bool
+#endif
 using namespace clang;
 
 //===----------------------------------------------------------------------===//
@@ -1499,9 +1505,67 @@ bool Lexer::tryConsumeIdentifierUTF8Char(const char *&CurPtr) {
   return true;
 }
 
+#ifdef __SSE2__
+/// Returns a mask with bit N set if byte N of \p Chunk lies in [Lo, Hi].
+static inline __m128i inRangeMask(__m128i Chunk, char Lo, char Hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(Chunk, _mm_set1_epi8(Lo - 1)),
+                       _mm_cmplt_epi8(Chunk, _mm_set1_epi8(Hi + 1)));
+}
+
+/// Returns the number of leading characters of the 16 bytes at \p Ptr that
+/// match [_A-Za-z0-9], or 16 if all of them do.
+static inline unsigned countIdentifierBodyChars(const char *Ptr) {
+  __m128i Chunk = _mm_loadu_si128((const __m128i *)Ptr);
+  // Bytes >= 0x80 compare as negative and are never matched, so UTF-8 is left
+  // to the slow path.
+  __m128i Matches =
+      _mm_or_si128(_mm_or_si128(inRangeMask(Chunk, 'a', 'z'),
+                                inRangeMask(Chunk, 'A', 'Z')),
+                   _mm_or_si128(inRangeMask(Chunk, '0', '9'),
+                                _mm_cmpeq_epi8(Chunk, _mm_set1_epi8('_'))));
+  unsigned Mask = ~_mm_movemask_epi8(Matches) & 0xFFFF;
+  return Mask ? llvm::countTrailingZeros(Mask) : 16;
+}
+
+/// Returns the number of leading characters of the 16 bytes at \p Ptr that
+/// are horizontal whitespace, or 16 if all of them are.
+static inline unsigned countHorizontalWhitespaceChars(const char *Ptr) {
+  __m128i Chunk = _mm_loadu_si128((const __m128i *)Ptr);
+  // ' ', and '\t', '\v', '\f' (which are consecutive).
+  __m128i Matches = _mm_or_si128(_mm_cmpeq_epi8(Chunk, _mm_set1_epi8(' ')),
+                                 inRangeMask(Chunk, '\t', '\f'));
+  // Exclude '\n', which lies between '\t' and '\v'.
+  Matches = _mm_andnot_si128(_mm_cmpeq_epi8(Chunk, _mm_set1_epi8('\n')),
+                             Matches);
+  unsigned Mask = ~_mm_movemask_epi8(Matches) & 0xFFFF;
+  return Mask ? llvm::countTrailingZeros(Mask) : 16;
+}
+
+/// Returns the offset of the first '\n', '\r' or '\0' in the 16 bytes at
+/// \p Ptr, or 16 if there is none.
+static inline unsigned findLineCommentEnd(const char *Ptr) {
+  __m128i Chunk = _mm_loadu_si128((const __m128i *)Ptr);
+  __m128i Matches =
+      _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(Chunk, _mm_set1_epi8('\n')),
+                                _mm_cmpeq_epi8(Chunk, _mm_set1_epi8('\r'))),
+                   _mm_cmpeq_epi8(Chunk, _mm_setzero_si128()));
+  unsigned Mask = _mm_movemask_epi8(Matches);
+  return Mask ? llvm::countTrailingZeros(Mask) : 16;
+}
+#endif
+
 bool Lexer::LexIdentifier(Token &Result, const char *CurPtr) {
   // Match [_A-Za-z0-9]*, we have already matched [_A-Za-z$]
   unsigned Size;
+#ifdef __SSE2__
+  // Skip over the plain ASCII part of the identifier 16 characters at a time.
+  while (CurPtr + 16 <= BufferEnd) {
+    unsigned Count = countIdentifierBodyChars(CurPtr);
+    CurPtr += Count;
+    if (Count != 16)
+      break;
+  }
+#endif
   unsigned char C = *CurPtr++;
   while (isIdentifierBody(C))
     C = *CurPtr++;
@@ -1993,6 +2057,19 @@ bool Lexer::SkipWhitespace(Token &Result, const char *CurPtr,
 
   // Skip consecutive spaces efficiently.
   while (1) {
+#ifdef __SSE2__
+    // Skip runs of indentation 16 characters at a time. Single spaces between
+    // tokens are far more common, so don't bother for those.
+    if (isHorizontalWhitespace(Char) && CurPtr + 16 <= BufferEnd &&
+        isHorizontalWhitespace(CurPtr[1])) {
+      unsigned Count;
+      do {
+        Count = countHorizontalWhitespaceChars(CurPtr);
+        CurPtr += Count;
+      } while (Count == 16 && CurPtr + 16 <= BufferEnd);
+      Char = *CurPtr;
+    }
+#endif
     // Skip horizontal whitespace very aggressively.
     while (isHorizontalWhitespace(Char))
       Char = *++CurPtr;
@@ -2060,6 +2137,16 @@ bool Lexer::SkipLineComment(Token &Result, const char *CurPtr,
   // them.  As such, optimize for this case with the inner loop.
   char C;
   do {
+#ifdef __SSE2__
+    // Comments are often long, skip 16 characters at a time until something
+    // interesting shows up.
+    while (CurPtr + 16 <= BufferEnd) {
+      unsigned Offset = findLineCommentEnd(CurPtr);
+      CurPtr += Offset;
+      if (Offset != 16)
+        break;
+    }
+#endif
     C = *CurPtr;
     // Skip over characters in the fast loop.
     while (C != 0 &&                // Potentially EOF.
@@ -2265,13 +2352,6 @@ static bool isEndOfBlockCommentWithEscapedNewLine(const char *CurPtr,
   return true;
 }
 
-#ifdef __SSE2__
-#include <emmintrin.h>
-#elif __ALTIVEC__
-#include <altivec.h>
-#undef bool
-#endif
-
 /// We have just read from input the / and * characters that started a comment.
 /// Read until we find the * and / characters that terminate the comment.
 /// Note that we don't bother decoding trigraphs or escaped newlines in block
@@ -2443,6 +2523,72 @@ bool Lexer::SkipBlockComment(Token &Result, const char *CurPtr,
   return false;
 }
 
+/// SkipToPossibleDirective - Advance over the text of a skipped conditional
+/// block without forming tokens, stopping at the first '#' (or digraph) at the
+/// start of a line.  We also stop at anything that could change how later
+/// lines are interpreted (comments, string and character literals, escaped
+/// newlines and trigraphs) and at nul characters, so that the regular lexer
+/// can deal with those and we never skip anything it would have treated
+/// differently.
+void Lexer::SkipToPossibleDirective() {
+  assert(LexingRawMode && "Skipping text outside of raw mode?");
+  const char *CurPtr = BufferPtr;
+  const char *LineTextStart = nullptr;
+  bool AtStartOfLine = IsAtStartOfLine;
+
+  while (1) {
+    switch (*CurPtr) {
+    case '\n':
+    case '\r':
+      AtStartOfLine = true;
+      ++CurPtr;
+      continue;
+    case ' ':
+    case '\t':
+    case '\f':
+    case '\v':
+      ++CurPtr;
+      continue;
+    case '#':
+    case '%':
+      if (AtStartOfLine)
+        goto Done;
+      break;
+    case '"':
+      // Back up to the start of a raw string literal; it may span lines.
+      if (LangOpts.CPlusPlus11 && CurPtr != BufferPtr && CurPtr[-1] == 'R') {
+        while (CurPtr != BufferPtr && isIdentifierBody(CurPtr[-1]))
+          --CurPtr;
+        AtStartOfLine = CurPtr == LineTextStart;
+      }
+      goto Done;
+    case '?':
+      if (LangOpts.Trigraphs)
+        goto Done;
+      break;
+    case '\'':
+    case '/':
+    case '\\':
+    case 0:
+      goto Done;
+    default:
+      break;
+    }
+    if (AtStartOfLine) {
+      LineTextStart = CurPtr;
+      AtStartOfLine = false;
+    }
+    ++CurPtr;
+  }
+
+Done:
+  if (CurPtr == BufferPtr)
+    return;
+  BufferPtr = CurPtr;
+  IsAtStartOfLine = AtStartOfLine;
+  IsAtPhysicalStartOfLine = AtStartOfLine;
+}
+
 //===----------------------------------------------------------------------===//
 // Primary Lexing Entry Points
 //===----------------------------------------------------------------------===//
@@ -930,14 +930,25 @@ bool NumericLiteralParser::GetIntegerValue(llvm::APInt &Val) {
     return Val.getZExtValue() != N;
   }
 
-  Val = 0;
+  // Otherwise, accumulate the leading digits into a uint64 for as long as
+  // the next digit cannot overflow it, which covers every literal that fits
+  // into 64 bits, and only continue with APInt arithmetic for the rest.
+  const uint64_t Limit = (UINT64_MAX - (radix - 1)) / radix;
+  uint64_t N = 0;
   const char *Ptr = DigitsBegin;
+  for (; Ptr != SuffixBegin && N <= Limit; ++Ptr)
+    if (!isDigitSeparator(*Ptr))
+      N = N * radix + llvm::hexDigitValue(*Ptr);
+
+  Val = N;
+  bool OverflowOccurred = Val.getZExtValue() != N;
+  if (Ptr == SuffixBegin)
+    return OverflowOccurred;
 
   llvm::APInt RadixVal(Val.getBitWidth(), radix);
   llvm::APInt CharVal(Val.getBitWidth(), 0);
   llvm::APInt OldVal = Val;
 
-  bool OverflowOccurred = false;
   while (Ptr < SuffixBegin) {
     if (isDigitSeparator(*Ptr)) {
       ++Ptr;
@@ -1272,6 +1283,16 @@ StringLiteralParser(ArrayRef<Token> StringToks,
   init(StringToks);
 }
 
+/// \brief Determine whether \p Str consists of ASCII characters other than
+/// the backslash only, so that it stands for itself in a narrow string
+/// literal.
+static bool isPlainASCII(StringRef Str) {
+  for (unsigned char C : Str)
+    if (C >= 0x80 || C == '\\')
+      return false;
+  return true;
+}
+
 void StringLiteralParser::init(ArrayRef<Token> StringToks){
   // The literal token may have come from an invalid source location (e.g. due
   // to a PCH error), in which case the token length will be 0.
@@ -1468,6 +1489,15 @@ void StringLiteralParser::init(ArrayRef<Token> StringToks){
           ThisTokBuf += 2;
       }
 
+      // Fast path: a narrow string piece of plain ASCII characters without
+      // escapes needs neither decoding nor validation.
+      if (CharByteWidth == 1 &&
+          isPlainASCII(StringRef(ThisTokBuf, ThisTokEnd - ThisTokBuf))) {
+        memcpy(ResultPtr, ThisTokBuf, ThisTokEnd - ThisTokBuf);
+        ResultPtr += ThisTokEnd - ThisTokBuf;
+        continue;
+      }
+
       while (ThisTokBuf != ThisTokEnd) {
         // Is this a span of non-escape characters?
         if (ThisTokBuf[0] != '\\') {
@@ -1355,6 +1355,9 @@ void ModuleMapParser::parseModuleDecl() {
     return;
   }
 
+  if (!ActiveModule)
+    Map.DeclaredModules[ModuleMapFile].push_back(Id.front().first);
+
   if (ActiveModule) {
     if (Id.size() > 1) {
       Diags.Report(Id.front().second, diag::err_mmap_nested_submodule_id)
@@ -1592,6 +1595,9 @@ void ModuleMapParser::parseExternModuleDecl() {
   std::string FileName = Tok.getString();
   consumeToken(); // filename
 
+  if (!ActiveModule)
+    Map.DeclaredModules[ModuleMapFile].push_back(Id.front().first);
+
   StringRef FileNameRef = FileName;
   SmallString<128> ModuleMapFileName;
   if (llvm::sys::path::is_relative(FileNameRef)) {
@@ -2187,6 +2193,9 @@ void ModuleMapParser::parseInferredModuleDecl(bool Framework, bool Explicit) {
     Failed = true;
   }
 
+  if (!ActiveModule)
+    Map.DeclaredModules[ModuleMapFile].push_back("*");
+
   if (ActiveModule) {
     // Inferred modules must have umbrella directories.
     if (!Failed && ActiveModule->IsAvailable &&
@@ -2437,6 +2446,14 @@ bool ModuleMapParser::parseModuleMapFile() {
   } while (true);
 }
 
+ArrayRef<std::string>
+ModuleMap::getDeclaredModules(const FileEntry *File) const {
+  auto Known = DeclaredModules.find(File);
+  if (Known == DeclaredModules.end())
+    return None;
+  return Known->second;
+}
+
 bool ModuleMap::parseModuleMapFile(const FileEntry *File, bool IsSystem,
                                    const DirectoryEntry *Dir,
                                    SourceLocation ExternModuleLoc) {
@@ -0,0 +1,123 @@
+//===--- ModuleMapCache.cpp - Persistent module map cache -----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the ModuleMapCache interface.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/ModuleMapCache.h"
+#include "clang/Basic/FileManager.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+
+/// The first line of every cache file.  Bump the version when the format
+/// changes; files with a different signature are ignored.
+static const char Signature[] = "clang-module-map-cache 1";
+
+void ModuleMapCache::read(StringRef Path) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return;
+
+  StringRef Contents = (*Buffer)->getBuffer();
+  StringRef Line;
+  std::tie(Line, Contents) = Contents.split('\n');
+  if (Line != Signature)
+    return;
+
+  // Each line is "<device> <inode> <size> <mtime>" followed by the names of
+  // the modules, each preceded by a space.
+  while (!Contents.empty()) {
+    std::tie(Line, Contents) = Contents.split('\n');
+    SmallVector<StringRef, 8> Fields;
+    Line.split(Fields, ' ');
+    uint64_t Device, Inode;
+    long long Size, ModTime;
+    if (Fields.size() < 4 || Fields[0].getAsInteger(10, Device) ||
+        Fields[1].getAsInteger(10, Inode) ||
+        Fields[2].getAsInteger(10, Size) ||
+        Fields[3].getAsInteger(10, ModTime))
+      continue;
+
+    Entry E = {static_cast<off_t>(Size), static_cast<time_t>(ModTime), {}};
+    for (StringRef Name : makeArrayRef(Fields).drop_front(4))
+      if (!Name.empty())
+        E.Modules.push_back(Name.str());
+    Entries.insert(
+        std::make_pair(llvm::sys::fs::UniqueID(Device, Inode), std::move(E)));
+  }
+}
+
+bool ModuleMapCache::mayDeclare(const FileEntry *File, StringRef Name) const {
+  auto I = Entries.find(File->getUniqueID());
+  if (I == Entries.end() || I->second.Size != File->getSize() ||
+      I->second.ModTime != File->getModificationTime())
+    return true;
+  for (const std::string &Module : I->second.Modules)
+    if (Module == Name || Module == "*")
+      return true;
+  return false;
+}
+
+void ModuleMapCache::insert(const FileEntry *File,
+                            ArrayRef<std::string> Modules) {
+  Entry &E = Entries[File->getUniqueID()];
+  if (E.Size == File->getSize() && E.ModTime == File->getModificationTime() &&
+      Modules.equals(E.Modules))
+    return;
+  E.Size = File->getSize();
+  E.ModTime = File->getModificationTime();
+  E.Modules.assign(Modules.begin(), Modules.end());
+  Dirty = true;
+}
+
+bool ModuleMapCache::save(StringRef Path) {
+  if (!Dirty)
+    return false;
+
+  // Pick up whatever other compilations wrote since we loaded the cache.
+  read(Path);
+
+  SmallString<128> TempPath(Path);
+  TempPath += "-%%%%%%%%";
+  int FD;
+  if (llvm::sys::fs::createUniqueFile(TempPath, FD, TempPath))
+    return true;
+
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << Signature << '\n';
+    for (const auto &I : Entries) {
+      OS << I.first.getDevice() << ' ' << I.first.getFile() << ' '
+         << (long long)I.second.Size << ' ' << (long long)I.second.ModTime;
+      for (const std::string &Module : I.second.Modules)
+        OS << ' ' << Module;
+      OS << '\n';
+    }
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return true;
+    }
+  }
+
+  if (llvm::sys::fs::rename(TempPath, Path)) {
+    llvm::sys::fs::remove(TempPath);
+    return true;
+  }
+  Dirty = false;
+  return false;
+}
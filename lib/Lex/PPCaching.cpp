@@ -137,8 +137,11 @@ bool Preprocessor::IsPreviousCachedToken(const Token &Tok) const {
 
 void Preprocessor::ReplacePreviousCachedToken(ArrayRef<Token> NewToks) {
   assert(CachedLexPos != 0 && "Expected to have some cached tokens");
-  CachedTokens.insert(CachedTokens.begin() + CachedLexPos - 1, NewToks.begin(),
-                      NewToks.end());
-  CachedTokens.erase(CachedTokens.begin() + CachedLexPos - 1 + NewToks.size());
+  assert(!NewToks.empty() && "Expected at least one replacement token");
+  // Overwrite the previous token in place, so that the tokens after it only
+  // have to be moved once, and only if there is more than one new token.
+  CachedTokens[CachedLexPos - 1] = NewToks.front();
+  CachedTokens.insert(CachedTokens.begin() + CachedLexPos,
+                      NewToks.begin() + 1, NewToks.end());
   CachedLexPos += NewToks.size() - 1;
 }
@@ -383,6 +383,9 @@ void Preprocessor::SkipExcludedConditionalBlock(SourceLocation IfTokenLoc,
   CurPPLexer->LexingRawMode = true;
   Token Tok;
   while (1) {
+    // Most lines in a skipped block can't contain a directive; don't bother
+    // forming tokens for them.
+    CurLexer->SkipToPossibleDirective();
     CurLexer->Lex(Tok);
 
     if (Tok.is(tok::code_completion)) {
@@ -2009,7 +2012,11 @@ void Preprocessor::HandleIncludeDirective(SourceLocation HashLoc,
   if (IncludePos.isMacroID())
     IncludePos = SourceMgr.getExpansionRange(IncludePos).second;
   FileID FID = SourceMgr.createFileID(File, IncludePos, FileCharacter);
-  assert(FID.isValid() && "Expected valid file ID");
+  if (FID.isInvalid()) {
+    // The source manager ran out of locations and has already diagnosed it.
+    TheModuleLoader.HadFatalFailure = true;
+    return;
+  }
 
   // If all is good, enter the new file!
   if (EnterSourceFile(FID, CurDir, FilenameTok.getLocation()))
@@ -15,6 +15,7 @@
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/LexDiagnostic.h"
 #include "clang/Lex/MacroInfo.h"
@@ -77,6 +78,13 @@ bool Preprocessor::EnterSourceFile(FileID FID, const DirectoryLookup *CurDir,
   if (MaxIncludeStackDepth < IncludeMacroStack.size())
     MaxIncludeStackDepth = IncludeMacroStack.size();
 
+  // Time everything done while this #include'd file is being lexed; the event
+  // ends when HandleEndOfFile pops the file.
+  if (TimeTrace *Trace = TimeTrace::getActive())
+    if (SourceMgr.getIncludeLoc(FID).isValid())
+      Trace->begin("Source", SourceMgr.getBufferName(
+                                 SourceMgr.getLocForStartOfFile(FID)));
+
   if (PTH) {
     if (PTHLexer *PL = PTH->CreateLexer(FID)) {
       EnterSourceFileWithPTH(PL, CurDir);
@@ -92,6 +100,9 @@ bool Preprocessor::EnterSourceFile(FileID FID, const DirectoryLookup *CurDir,
     SourceLocation FileStart = SourceMgr.getLocForStartOfFile(FID);
     Diag(Loc, diag::err_pp_error_opening_file)
       << std::string(SourceMgr.getBufferName(FileStart)) << "";
+    if (TimeTrace *Trace = TimeTrace::getActive())
+      if (SourceMgr.getIncludeLoc(FID).isValid())
+        Trace->end();
     return true;
   }
 
@@ -396,6 +407,10 @@ bool Preprocessor::HandleEndOfFile(Token &Result, bool isEndOfMacro) {
           SourceMgr.local_sloc_entry_size() -
           CurPPLexer->getInitialNumSLocEntries() + 1/*#include'd file*/;
       SourceMgr.setNumCreatedFIDsForFileID(CurPPLexer->getFileID(), NumFIDs);
+
+      if (TimeTrace *Trace = TimeTrace::getActive())
+        if (Trace->getNumOpenEvents())
+          Trace->end();
     }
 
     FileID ExitedFID;
@@ -524,9 +539,7 @@ bool Preprocessor::HandleEndOfTokenLexer(Token &Result) {
   assert(CurTokenLexer && !CurPPLexer &&
          "Ending a macro when currently in a #include file!");
 
-  if (!MacroExpandingLexersStack.empty() &&
-      MacroExpandingLexersStack.back().first == CurTokenLexer.get())
-    removeCachedMacroExpandedTokensOfLastLexer();
+  CurTokenLexer->releaseExpansionBuffer();
 
   // Delete or cache the now-dead macro expander.
   if (NumCachedTokenLexers == TokenLexerCacheSize)
@@ -37,6 +37,7 @@ MacroDirective *
 Preprocessor::getLocalMacroDirectiveHistory(const IdentifierInfo *II) const {
   if (!II->hadMacroDefinition())
     return nullptr;
+  loadLazyMacroHistory(II);
   auto Pos = CurSubmoduleState->Macros.find(II);
   return Pos == CurSubmoduleState->Macros.end() ? nullptr
                                                 : Pos->second.getLatest();
@@ -46,6 +47,9 @@ void Preprocessor::appendMacroDirective(IdentifierInfo *II, MacroDirective *MD){
   assert(MD && "MacroDirective should be non-zero!");
   assert(!MD->getPrevious() && "Already attached to a MacroDirective history.");
 
+  // The new directive goes on top of the history from the PCH, if any.
+  loadLazyMacroHistory(II);
+
   MacroState &StoredMD = CurSubmoduleState->Macros[II];
   auto *OldMD = StoredMD.getLatest();
   MD->setPrevious(OldMD);
@@ -80,6 +84,15 @@ void Preprocessor::setLoadedMacroDirective(IdentifierInfo *II,
     II->setHasMacroDefinition(false);
 }
 
+void Preprocessor::setLazyMacroHistory(IdentifierInfo *II, bool IsDefined) {
+  assert(II && ExternalSource && "No source to load the macro history from");
+  LazyMacroHistories.insert(II);
+  // Setup the identifier as having associated macro history.
+  II->setHasMacroDefinition(true);
+  if (!IsDefined && LeafModuleMacros.find(II) == LeafModuleMacros.end())
+    II->setHasMacroDefinition(false);
+}
+
 ModuleMacro *Preprocessor::addModuleMacro(Module *Mod, IdentifierInfo *II,
                                           MacroInfo *Macro,
                                           ArrayRef<ModuleMacro *> Overrides,
@@ -968,44 +981,23 @@ MacroArgs *Preprocessor::ReadFunctionLikeMacroArgs(Token &MacroName,
   return MacroArgs::create(MI, ArgTokens, isVarargsElided, *this);
 }
 
-/// \brief Keeps macro expanded tokens for TokenLexers.
-//
-/// Works like a stack; a TokenLexer adds the macro expanded tokens that is
-/// going to lex in the cache and when it finishes the tokens are removed
-/// from the end of the cache.
-Token *Preprocessor::cacheMacroExpandedTokens(TokenLexer *tokLexer,
-                                              ArrayRef<Token> tokens) {
-  assert(tokLexer);
-  if (tokens.empty())
-    return nullptr;
-
-  size_t newIndex = MacroExpandedTokens.size();
-  bool cacheNeedsToGrow = tokens.size() >
-                      MacroExpandedTokens.capacity()-MacroExpandedTokens.size(); 
-  MacroExpandedTokens.append(tokens.begin(), tokens.end());
-
-  if (cacheNeedsToGrow) {
-    // Go through all the TokenLexers whose 'Tokens' pointer points in the
-    // buffer and update the pointers to the (potential) new buffer array.
-    for (unsigned i = 0, e = MacroExpandingLexersStack.size(); i != e; ++i) {
-      TokenLexer *prevLexer;
-      size_t tokIndex;
-      std::tie(prevLexer, tokIndex) = MacroExpandingLexersStack[i];
-      prevLexer->Tokens = MacroExpandedTokens.data() + tokIndex;
-    }
-  }
+std::unique_ptr<TokenLexer::TokenBuffer>
+Preprocessor::takeMacroExpansionBuffer() {
+  if (MacroExpansionBuffers.empty())
+    return llvm::make_unique<TokenLexer::TokenBuffer>();
 
-  MacroExpandingLexersStack.push_back(std::make_pair(tokLexer, newIndex));
-  return MacroExpandedTokens.data() + newIndex;
+  std::unique_ptr<TokenLexer::TokenBuffer> Buffer =
+      std::move(MacroExpansionBuffers.back());
+  MacroExpansionBuffers.pop_back();
+  return Buffer;
 }
 
-void Preprocessor::removeCachedMacroExpandedTokensOfLastLexer() {
-  assert(!MacroExpandingLexersStack.empty());
-  size_t tokIndex = MacroExpandingLexersStack.back().second;
-  assert(tokIndex < MacroExpandedTokens.size());
-  // Pop the cached macro expanded tokens from the end.
-  MacroExpandedTokens.resize(tokIndex);
-  MacroExpandingLexersStack.pop_back();
+void Preprocessor::releaseMacroExpansionBuffer(
+    std::unique_ptr<TokenLexer::TokenBuffer> Buffer) {
+  assert(Buffer && "Releasing a null buffer");
+  // Keep the capacity for the next expansion.
+  Buffer->clear();
+  MacroExpansionBuffers.push_back(std::move(Buffer));
 }
 
 /// ComputeDATE_TIME - Compute the current time, enter it into the specified
@@ -64,19 +64,23 @@ PreprocessingRecord::getPreprocessedEntitiesInRange(SourceRange Range) {
                           iterator(this, Res.second));
 }
 
-static bool isPreprocessedEntityIfInFileID(PreprocessedEntity *PPE, FileID FID,
-                                           SourceManager &SM) {
+static bool isLocationInFileID(SourceLocation Loc, FileID FID,
+                               SourceManager &SM) {
   assert(FID.isValid());
-  if (!PPE)
-    return false;
-
-  SourceLocation Loc = PPE->getSourceRange().getBegin();
   if (Loc.isInvalid())
     return false;
 
   return SM.isInFileID(SM.getFileLoc(Loc), FID);
 }
 
+static bool isPreprocessedEntityIfInFileID(PreprocessedEntity *PPE, FileID FID,
+                                           SourceManager &SM) {
+  if (!PPE)
+    return false;
+
+  return isLocationInFileID(PPE->getSourceRange().getBegin(), FID, SM);
+}
+
 /// \brief Returns true if the preprocessed entity that \arg PPEI iterator
 /// points to is coming from the file \arg FID.
 ///
@@ -117,8 +121,8 @@ bool PreprocessingRecord::isEntityInFileID(iterator PPEI, FileID FID) {
     assert(0 && "Out-of bounds local preprocessed entity");
     return false;
   }
-  return isPreprocessedEntityIfInFileID(PreprocessedEntities[Pos],
-                                        FID, SourceMgr);
+  return isLocationInFileID(PreprocessedEntityRanges[Pos].getBegin(), FID,
+                            SourceMgr);
 }
 
 /// \brief Returns a pair of [Begin, End) iterators of preprocessed entities
@@ -173,25 +177,12 @@ struct PPEntityComp {
 
   explicit PPEntityComp(const SourceManager &SM) : SM(SM) { }
 
-  bool operator()(PreprocessedEntity *L, PreprocessedEntity *R) const {
-    SourceLocation LHS = getLoc(L);
-    SourceLocation RHS = getLoc(R);
-    return SM.isBeforeInTranslationUnit(LHS, RHS);
+  bool operator()(SourceRange L, SourceLocation RHS) const {
+    return SM.isBeforeInTranslationUnit((L.*getRangeLoc)(), RHS);
   }
 
-  bool operator()(PreprocessedEntity *L, SourceLocation RHS) const {
-    SourceLocation LHS = getLoc(L);
-    return SM.isBeforeInTranslationUnit(LHS, RHS);
-  }
-
-  bool operator()(SourceLocation LHS, PreprocessedEntity *R) const {
-    SourceLocation RHS = getLoc(R);
-    return SM.isBeforeInTranslationUnit(LHS, RHS);
-  }
-
-  SourceLocation getLoc(PreprocessedEntity *PPE) const {
-    SourceRange Range = PPE->getSourceRange();
-    return (Range.*getRangeLoc)();
+  bool operator()(SourceLocation LHS, SourceRange R) const {
+    return SM.isBeforeInTranslationUnit(LHS, (R.*getRangeLoc)());
   }
 };
 
@@ -202,11 +193,11 @@ unsigned PreprocessingRecord::findBeginLocalPreprocessedEntity(
   if (SourceMgr.isLoadedSourceLocation(Loc))
     return 0;
 
-  size_t Count = PreprocessedEntities.size();
+  size_t Count = PreprocessedEntityRanges.size();
   size_t Half;
-  std::vector<PreprocessedEntity *>::const_iterator
-    First = PreprocessedEntities.begin();
-  std::vector<PreprocessedEntity *>::const_iterator I;
+  std::vector<SourceRange>::const_iterator
+    First = PreprocessedEntityRanges.begin();
+  std::vector<SourceRange>::const_iterator I;
 
   // Do a binary search manually instead of using std::lower_bound because
   // The end locations of entities may be unordered (when a macro expansion
@@ -216,8 +207,7 @@ unsigned PreprocessingRecord::findBeginLocalPreprocessedEntity(
     Half = Count/2;
     I = First;
     std::advance(I, Half);
-    if (SourceMgr.isBeforeInTranslationUnit((*I)->getSourceRange().getEnd(),
-                                            Loc)){
+    if (SourceMgr.isBeforeInTranslationUnit(I->getEnd(), Loc)) {
       First = I;
       ++First;
       Count = Count - Half - 1;
@@ -225,7 +215,7 @@ unsigned PreprocessingRecord::findBeginLocalPreprocessedEntity(
       Count = Half;
   }
 
-  return First - PreprocessedEntities.begin();
+  return First - PreprocessedEntityRanges.begin();
 }
 
 unsigned PreprocessingRecord::findEndLocalPreprocessedEntity(
@@ -233,34 +223,36 @@ unsigned PreprocessingRecord::findEndLocalPreprocessedEntity(
   if (SourceMgr.isLoadedSourceLocation(Loc))
     return 0;
 
-  std::vector<PreprocessedEntity *>::const_iterator
-  I = std::upper_bound(PreprocessedEntities.begin(),
-                       PreprocessedEntities.end(),
+  std::vector<SourceRange>::const_iterator
+  I = std::upper_bound(PreprocessedEntityRanges.begin(),
+                       PreprocessedEntityRanges.end(),
                        Loc,
                        PPEntityComp<&SourceRange::getBegin>(SourceMgr));
-  return I - PreprocessedEntities.begin();
+  return I - PreprocessedEntityRanges.begin();
 }
 
 PreprocessingRecord::PPEntityID
 PreprocessingRecord::addPreprocessedEntity(PreprocessedEntity *Entity) {
   assert(Entity);
-  SourceLocation BeginLoc = Entity->getSourceRange().getBegin();
-
-  if (isa<MacroDefinitionRecord>(Entity)) {
-    assert((PreprocessedEntities.empty() ||
-            !SourceMgr.isBeforeInTranslationUnit(
-                BeginLoc,
-                PreprocessedEntities.back()->getSourceRange().getBegin())) &&
-           "a macro definition was encountered out-of-order");
-    PreprocessedEntities.push_back(Entity);
-    return getPPEntityID(PreprocessedEntities.size()-1, /*isLoaded=*/false);
-  }
+  assert((!isa<MacroDefinitionRecord>(Entity) ||
+          PreprocessedEntityRanges.empty() ||
+          !SourceMgr.isBeforeInTranslationUnit(
+              Entity->getSourceRange().getBegin(),
+              PreprocessedEntityRanges.back().getBegin())) &&
+         "a macro definition was encountered out-of-order");
+  return addLocalEntity(Entity, Entity->getSourceRange());
+}
+
+PreprocessingRecord::PPEntityID
+PreprocessingRecord::addLocalEntity(LocalEntity Entity, SourceRange Range) {
+  SourceLocation BeginLoc = Range.getBegin();
 
   // Check normal case, this entity begin location is after the previous one.
-  if (PreprocessedEntities.empty() ||
-      !SourceMgr.isBeforeInTranslationUnit(BeginLoc,
-                   PreprocessedEntities.back()->getSourceRange().getBegin())) {
+  if (PreprocessedEntityRanges.empty() ||
+      !SourceMgr.isBeforeInTranslationUnit(
+          BeginLoc, PreprocessedEntityRanges.back().getBegin())) {
     PreprocessedEntities.push_back(Entity);
+    PreprocessedEntityRanges.push_back(Range);
     return getPPEntityID(PreprocessedEntities.size()-1, /*isLoaded=*/false);
   }
 
@@ -276,32 +268,36 @@ PreprocessingRecord::addPreprocessedEntity(PreprocessedEntity *Entity) {
   //  FM(M1, M2)
   // \endcode
 
-  typedef std::vector<PreprocessedEntity *>::iterator pp_iter;
+  typedef std::vector<SourceRange>::iterator range_iter;
 
   // Usually there are few macro expansions when defining the filename, do a
   // linear search for a few entities.
+  range_iter InsertI = PreprocessedEntityRanges.begin();
   unsigned count = 0;
-  for (pp_iter RI    = PreprocessedEntities.end(),
-               Begin = PreprocessedEntities.begin();
+  bool Found = false;
+  for (range_iter RI    = PreprocessedEntityRanges.end(),
+                  Begin = PreprocessedEntityRanges.begin();
        RI != Begin && count < 4; --RI, ++count) {
-    pp_iter I = RI;
+    range_iter I = RI;
     --I;
-    if (!SourceMgr.isBeforeInTranslationUnit(BeginLoc,
-                                           (*I)->getSourceRange().getBegin())) {
-      pp_iter insertI = PreprocessedEntities.insert(RI, Entity);
-      return getPPEntityID(insertI - PreprocessedEntities.begin(),
-                           /*isLoaded=*/false);
+    if (!SourceMgr.isBeforeInTranslationUnit(BeginLoc, I->getBegin())) {
+      InsertI = RI;
+      Found = true;
+      break;
     }
   }
 
   // Linear search unsuccessful. Do a binary search.
-  pp_iter I = std::upper_bound(PreprocessedEntities.begin(),
-                               PreprocessedEntities.end(),
+  if (!Found)
+    InsertI = std::upper_bound(PreprocessedEntityRanges.begin(),
+                               PreprocessedEntityRanges.end(),
                                BeginLoc,
                                PPEntityComp<&SourceRange::getBegin>(SourceMgr));
-  pp_iter insertI = PreprocessedEntities.insert(I, Entity);
-  return getPPEntityID(insertI - PreprocessedEntities.begin(),
-                       /*isLoaded=*/false);
+
+  unsigned Index = InsertI - PreprocessedEntityRanges.begin();
+  PreprocessedEntityRanges.insert(InsertI, Range);
+  PreprocessedEntities.insert(PreprocessedEntities.begin() + Index, Entity);
+  return getPPEntityID(Index, /*isLoaded=*/false);
 }
 
 void PreprocessingRecord::SetExternalSource(
@@ -337,7 +333,10 @@ PreprocessedEntity *PreprocessingRecord::getPreprocessedEntity(PPEntityID PPID){
   unsigned Index = PPID.ID - 1;
   assert(Index < PreprocessedEntities.size() &&
          "Out-of bounds local preprocessed entity");
-  return PreprocessedEntities[Index];
+  LocalEntity &Entity = PreprocessedEntities[Index];
+  if (MacroDefinitionRecord *Def = Entity.dyn_cast<MacroDefinitionRecord *>())
+    Entity = new (*this) MacroExpansion(Def, PreprocessedEntityRanges[Index]);
+  return Entity.get<PreprocessedEntity *>();
 }
 
 /// \brief Retrieve the loaded preprocessed entity at the given index.
@@ -377,7 +376,7 @@ void PreprocessingRecord::addMacroExpansion(const Token &Id,
     addPreprocessedEntity(new (*this)
                               MacroExpansion(Id.getIdentifierInfo(), Range));
   else if (MacroDefinitionRecord *Def = findMacroDefinition(MI))
-    addPreprocessedEntity(new (*this) MacroExpansion(Def, Range));
+    addLocalEntity(Def, Range);
 }
 
 void PreprocessingRecord::Ifdef(SourceLocation Loc, const Token &MacroNameTok,
@@ -484,5 +483,6 @@ size_t PreprocessingRecord::getTotalMemory() const {
   return BumpAlloc.getTotalMemory()
     + llvm::capacity_in_bytes(MacroDefinitions)
     + llvm::capacity_in_bytes(PreprocessedEntities)
+    + llvm::capacity_in_bytes(PreprocessedEntityRanges)
     + llvm::capacity_in_bytes(LoadedPreprocessedEntities);
 }
@@ -272,8 +272,8 @@ void Preprocessor::PrintStats() {
   llvm::errs() << "\nPreprocessor Memory: " << getTotalMemory() << "B total";
 
   llvm::errs() << "\n  BumpPtr: " << BP.getTotalMemory();
-  llvm::errs() << "\n  Macro Expanded Tokens: "
-               << llvm::capacity_in_bytes(MacroExpandedTokens);
+  llvm::errs() << "\n  Macro Expansion Buffers: "
+               << getMacroExpansionBuffersMemory();
   llvm::errs() << "\n  Predefines Buffer: " << Predefines.capacity();
   // FIXME: List information for all submodules.
   llvm::errs() << "\n  Macros: "
@@ -294,6 +294,12 @@ Preprocessor::macro_begin(bool IncludeExternalMacros) const {
     ExternalSource->ReadDefinedMacros();
   }
 
+  // Loading a deferred macro history can defer others, so keep going until
+  // all of them are in place.
+  if (IncludeExternalMacros)
+    while (!LazyMacroHistories.empty())
+      loadLazyMacroHistory(*LazyMacroHistories.begin());
+
   // Make sure we cover all macros in visible modules.
   for (const ModuleMacro &Macro : ModuleMacros)
     CurSubmoduleState->Macros.insert(std::make_pair(Macro.II, MacroState()));
@@ -301,9 +307,16 @@ Preprocessor::macro_begin(bool IncludeExternalMacros) const {
   return CurSubmoduleState->Macros.begin();
 }
 
+size_t Preprocessor::getMacroExpansionBuffersMemory() const {
+  size_t Size = llvm::capacity_in_bytes(MacroExpansionBuffers);
+  for (const auto &Buffer : MacroExpansionBuffers)
+    Size += llvm::capacity_in_bytes(*Buffer);
+  return Size;
+}
+
 size_t Preprocessor::getTotalMemory() const {
   return BP.getTotalMemory()
-    + llvm::capacity_in_bytes(MacroExpandedTokens)
+    + getMacroExpansionBuffersMemory()
     + Predefines.capacity() /* Predefines buffer. */
     // FIXME: Include sizes from all submodules, and include MacroInfo sizes,
     // and ModuleMacros.
@@ -534,6 +547,9 @@ void Preprocessor::EndSourceFile() {
   // Notify the client that we reached the end of the source file.
   if (Callbacks)
     Callbacks->EndOfMainFile();
+
+  HeaderInfo.saveIncludeGuardCache();
+  HeaderInfo.saveModuleMapCache();
 }
 
 //===----------------------------------------------------------------------===//
@@ -114,10 +114,17 @@ void TokenLexer::destroy() {
     OwnsTokens = false;
   }
 
+  releaseExpansionBuffer();
+
   // TokenLexer owns its formal arguments.
   if (ActualArgs) ActualArgs->destroy(PP);
 }
 
+void TokenLexer::releaseExpansionBuffer() {
+  if (ExpansionBuffer)
+    PP.releaseMacroExpansionBuffer(std::move(ExpansionBuffer));
+}
+
 bool TokenLexer::MaybeRemoveCommaBeforeVaArgs(
     SmallVectorImpl<Token> &ResultToks, bool HasPasteOperator, MacroInfo *Macro,
     unsigned MacroArgNo, Preprocessor &PP) {
@@ -171,7 +178,10 @@ bool TokenLexer::MaybeRemoveCommaBeforeVaArgs(
 /// Expand the arguments of a function-like macro so that we can quickly
 /// return preexpanded tokens from Tokens.
 void TokenLexer::ExpandFunctionArguments() {
-  SmallVector<Token, 128> ResultToks;
+  // Expand into a pooled buffer, which we lex from directly if anything
+  // changed, so that expansions neither allocate nor get copied again.
+  std::unique_ptr<TokenBuffer> Buffer = PP.takeMacroExpansionBuffer();
+  TokenBuffer &ResultToks = *Buffer;
 
   // Loop through 'Tokens', expanding them into ResultToks.  Keep
   // track of whether we change anything.  If not, no need to keep them.  If so,
@@ -395,14 +405,16 @@ void TokenLexer::ExpandFunctionArguments() {
   // If anything changed, install this as the new Tokens list.
   if (MadeChange) {
     assert(!OwnsTokens && "This would leak if we already own the token list");
-    // This is deleted in the dtor.
+    assert(!ExpansionBuffer && "Arguments expanded twice?");
     NumTokens = ResultToks.size();
-    // The tokens will be added to Preprocessor's cache and will be removed
-    // when this TokenLexer finishes lexing them.
-    Tokens = PP.cacheMacroExpandedTokens(this, ResultToks);
+    Tokens = ResultToks.data();
 
-    // The preprocessor cache of macro expanded tokens owns these tokens,not us.
+    // The buffer goes back to the preprocessor's pool when this TokenLexer
+    // finishes lexing the tokens; we don't own them.
+    ExpansionBuffer = std::move(Buffer);
     OwnsTokens = false;
+  } else {
+    PP.releaseMacroExpansionBuffer(std::move(Buffer));
   }
 }
 
@@ -762,10 +774,16 @@ TokenLexer::getExpansionLocForMacroDefLoc(SourceLocation loc) const {
 ///
 /// \arg begin_tokens will be updated to a position past all the found
 /// consecutive tokens.
+///
+/// \arg AcrossMacros allows tokens that were produced by different macros to
+/// share the SLocEntry. Their spelling is still exact, since it is computed
+/// from the relative offset, but the SLocEntry's spelling range may then span
+/// several macro expansions.
 static void updateConsecutiveMacroArgTokens(SourceManager &SM,
                                             SourceLocation InstLoc,
                                             Token *&begin_tokens,
-                                            Token * end_tokens) {
+                                            Token * end_tokens,
+                                            bool AcrossMacros) {
   assert(begin_tokens < end_tokens);
 
   SourceLocation FirstLoc = begin_tokens->getLocation();
@@ -795,7 +813,8 @@ static void updateConsecutiveMacroArgTokens(SourceManager &SM,
     if (RelOffs < 0 || RelOffs > 50)
       break;
 
-    if (CurLoc.isMacroID() && !SM.isWrittenInSameFile(CurLoc, NextLoc))
+    if (CurLoc.isMacroID() && !AcrossMacros &&
+        !SM.isWrittenInSameFile(CurLoc, NextLoc))
       break; // Token from a different macro.
 
     CurLoc = NextLoc;
@@ -847,7 +866,9 @@ void TokenLexer::updateLocForMacroArgTokens(SourceLocation ArgIdSpellLoc,
       return;
     }
 
-    updateConsecutiveMacroArgTokens(SM, InstLoc, begin_tokens, end_tokens);
+    updateConsecutiveMacroArgTokens(
+        SM, InstLoc, begin_tokens, end_tokens,
+        PP.getPreprocessorOpts().CompactMacroArgLocations);
   }
 }
 
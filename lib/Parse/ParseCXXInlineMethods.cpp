@@ -132,6 +132,25 @@ NamedDecl *Parser::ParseCXXInlineMethodDef(AccessSpecifier AS,
     return FnD;
   }
 
+  // In lazy inline method parsing mode, store the tokens of the body of an
+  // inline function of a non-template class until the function is used, and
+  // parse it at the end of the translation unit.
+  if (getLangOpts().LazyInlineMethodParsing && FnD &&
+      D.getFunctionDefinitionKind() == FDK_Definition &&
+      !D.getDeclSpec().isFriendSpecified() &&
+      TemplateInfo.Kind == ParsedTemplateInfo::NonTemplate &&
+      Actions.TUKind == TU_Complete && !PP.isIncrementalProcessingEnabled() &&
+      Actions.canDelayFunctionBody(D) &&
+      Actions.canParseFunctionBodyOnUse(FnD)) {
+    CachedTokens Toks;
+    LexTemplateFunctionForLateParsing(Toks);
+
+    FunctionDecl *FD = FnD->getAsFunction();
+    Actions.CheckForFunctionRedefinition(FD);
+    Actions.MarkAsLateParsedTemplate(FD, FnD, Toks);
+    return FnD;
+  }
+
   // Consume the tokens and store them for later parsing.
 
   LexedMethod* LM = new LexedMethod(this, FnD);
@@ -1327,7 +1327,7 @@ void Parser::LateTemplateParserCallback(void *P, LateParsedTemplate &LPT) {
   ((Parser *)P)->ParseLateTemplatedFuncDef(LPT);
 }
 
-/// \brief Late parse a C++ function template in Microsoft mode.
+/// \brief Late parse a C++ function template.
 void Parser::ParseLateTemplatedFuncDef(LateParsedTemplate &LPT) {
   if (!LPT.D)
      return;
@@ -1368,6 +1368,17 @@ void Parser::ParseLateTemplatedFuncDef(LateParsedTemplate &LPT) {
 
   assert(!LPT.Toks.empty() && "Empty body!");
 
+  // Outside of Microsoft mode, bind the non-dependent names in the body as if
+  // it had been parsed where it was defined, so that delaying the parse only
+  // saves time.
+  SaveAndRestore<SourceLocation> SavedTemplateEnd(
+      Actions.LateParsedTemplateEnd,
+      getLangOpts().MicrosoftExt ? SourceLocation()
+                                 : LPT.Toks.back().getLocation());
+  SaveAndRestore<unsigned> SavedTemplateDepth(
+      Actions.LateParsedTemplateDepth,
+      Actions.ActiveTemplateInstantiations.size());
+
   // Append the current token at the end of the new token stream so that it
   // doesn't get lost.
   LPT.Toks.push_back(Tok);
@@ -66,6 +66,28 @@ bool Parser::isCXXDeclarationStatement() {
   }
 }
 
+bool Parser::getCachedTentativeParse(TentativeParseKind Kind,
+                                     TPResult &Result) {
+  // Whether a construct can be a declaration depends on the identifiers
+  // declared earlier in an enclosing tentative parse.
+  if (!TentativelyDeclaredIdentifiers.empty())
+    return false;
+
+  auto Known = TentativeParseResults.find(
+      std::make_pair(Tok.getLocation().getRawEncoding(), unsigned(Kind)));
+  if (Known == TentativeParseResults.end())
+    return false;
+  Result = Known->second;
+  return true;
+}
+
+void Parser::cacheTentativeParse(TentativeParseKind Kind, TPResult Result) {
+  if (!TentativelyDeclaredIdentifiers.empty())
+    return;
+  TentativeParseResults[std::make_pair(Tok.getLocation().getRawEncoding(),
+                                       unsigned(Kind))] = Result;
+}
+
 /// isCXXSimpleDeclaration - C++-specialized function that disambiguates
 /// between a simple-declaration or an expression-statement.
 /// If during the disambiguation process a parsing error is encountered,
@@ -126,9 +148,14 @@ bool Parser::isCXXSimpleDeclaration(bool AllowForRangeDecl) {
   // or an identifier which doesn't resolve as anything. We need tentative
   // parsing...
  
-  {
-    RevertingTentativeParsingAction PA(*this);
-    TPR = TryParseSimpleDeclaration(AllowForRangeDecl);
+  TentativeParseKind Kind =
+      AllowForRangeDecl ? TPK_ForRangeDeclaration : TPK_SimpleDeclaration;
+  if (!getCachedTentativeParse(Kind, TPR)) {
+    {
+      RevertingTentativeParsingAction PA(*this);
+      TPR = TryParseSimpleDeclaration(AllowForRangeDecl);
+    }
+    cacheTentativeParse(Kind, TPR);
   }
 
   // In case of an error, let the declaration parsing code handle it.
@@ -501,39 +528,52 @@ bool Parser::isCXXTypeId(TentativeCXXTypeIdContext Context, bool &isAmbiguous) {
   // Ok, we have a simple-type-specifier/typename-specifier followed by a '('.
   // We need tentative parsing...
 
-  RevertingTentativeParsingAction PA(*this);
+  // The cache records a type-id found to be ambiguous as TPResult::Ambiguous.
+  TentativeParseKind Kind = TentativeParseKind(TPK_TypeIdInParens + Context);
+  if (getCachedTentativeParse(Kind, TPR)) {
+    isAmbiguous = TPR == TPResult::Ambiguous;
+    return TPR != TPResult::False;
+  }
 
-  // type-specifier-seq
-  TryConsumeDeclarationSpecifier();
-  assert(Tok.is(tok::l_paren) && "Expected '('");
+  {
+    RevertingTentativeParsingAction PA(*this);
 
-  // declarator
-  TPR = TryParseDeclarator(true/*mayBeAbstract*/, false/*mayHaveIdentifier*/);
+    // type-specifier-seq
+    TryConsumeDeclarationSpecifier();
+    assert(Tok.is(tok::l_paren) && "Expected '('");
 
-  // In case of an error, let the declaration parsing code handle it.
-  if (TPR == TPResult::Error)
-    TPR = TPResult::True;
+    // declarator
+    TPR = TryParseDeclarator(true/*mayBeAbstract*/,
+                             false/*mayHaveIdentifier*/);
 
-  if (TPR == TPResult::Ambiguous) {
-    // We are supposed to be inside parens, so if after the abstract declarator
-    // we encounter a ')' this is a type-id, otherwise it's an expression.
-    if (Context == TypeIdInParens && Tok.is(tok::r_paren)) {
-      TPR = TPResult::True;
-      isAmbiguous = true;
-
-    // We are supposed to be inside a template argument, so if after
-    // the abstract declarator we encounter a '>', '>>' (in C++0x), or
-    // ',', this is a type-id. Otherwise, it's an expression.
-    } else if (Context == TypeIdAsTemplateArgument &&
-               (Tok.isOneOf(tok::greater, tok::comma) ||
-                (getLangOpts().CPlusPlus11 && Tok.is(tok::greatergreater)))) {
+    // In case of an error, let the declaration parsing code handle it.
+    if (TPR == TPResult::Error)
       TPR = TPResult::True;
-      isAmbiguous = true;
 
-    } else
-      TPR = TPResult::False;
+    if (TPR == TPResult::Ambiguous) {
+      // We are supposed to be inside parens, so if after the abstract
+      // declarator we encounter a ')' this is a type-id, otherwise it's an
+      // expression.
+      if (Context == TypeIdInParens && Tok.is(tok::r_paren)) {
+        TPR = TPResult::True;
+        isAmbiguous = true;
+
+      // We are supposed to be inside a template argument, so if after
+      // the abstract declarator we encounter a '>', '>>' (in C++0x), or
+      // ',', this is a type-id. Otherwise, it's an expression.
+      } else if (Context == TypeIdAsTemplateArgument &&
+                 (Tok.isOneOf(tok::greater, tok::comma) ||
+                  (getLangOpts().CPlusPlus11 &&
+                   Tok.is(tok::greatergreater)))) {
+        TPR = TPResult::True;
+        isAmbiguous = true;
+
+      } else
+        TPR = TPResult::False;
+    }
   }
 
+  cacheTentativeParse(Kind, isAmbiguous ? TPResult::Ambiguous : TPR);
   assert(TPR == TPResult::True || TPR == TPResult::False);
   return TPR == TPResult::True;
 }
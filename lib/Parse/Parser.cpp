@@ -541,6 +541,7 @@ void Parser::LateTemplateParserCleanupCallback(void *P) {
 /// action tells us to.  This returns true if the EOF was encountered.
 bool Parser::ParseTopLevelDecl(DeclGroupPtrTy &Result) {
   DestroyTemplateIdAnnotationsRAIIObj CleanupRAII(TemplateIds);
+  TentativeParseResults.clear();
 
   // Skip over the EOF token, flagging end of previous input for incremental
   // processing
@@ -574,7 +575,8 @@ bool Parser::ParseTopLevelDecl(DeclGroupPtrTy &Result) {
 
   case tok::eof:
     // Late template parsing can begin.
-    if (getLangOpts().DelayedTemplateParsing)
+    if (getLangOpts().DelayedTemplateParsing ||
+        getLangOpts().LazyInlineMethodParsing)
       Actions.SetLateTemplateParser(LateTemplateParserCallback,
                                     PP.isIncrementalProcessingEnabled() ?
                                     LateTemplateParserCleanupCallback : nullptr,
@@ -17,6 +17,7 @@
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/TokenConcatenation.h"
 #include "clang/Rewrite/Core/Rewriter.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -105,14 +106,17 @@ void html::HighlightRange(RewriteBuffer &RB, unsigned B, unsigned E,
 
 void html::EscapeText(Rewriter &R, FileID FID,
                       bool EscapeSpaces, bool ReplaceTabs) {
-
   const llvm::MemoryBuffer *Buf = R.getSourceMgr().getBuffer(FID);
-  const char* C = Buf->getBufferStart();
-  const char* FileEnd = Buf->getBufferEnd();
+  EscapeText(R.getEditBuffer(FID), Buf->getBuffer(), EscapeSpaces,
+             ReplaceTabs);
+}
 
-  assert (C <= FileEnd);
+void html::EscapeText(RewriteBuffer &RB, StringRef Buffer,
+                      bool EscapeSpaces, bool ReplaceTabs) {
+  const char* C = Buffer.begin();
+  const char* FileEnd = Buffer.end();
 
-  RewriteBuffer &RB = R.getEditBuffer(FID);
+  assert (C <= FileEnd);
 
   unsigned ColNo = 0;
   for (unsigned FilePos = 0; C != FileEnd ; ++C, ++FilePos) {
@@ -224,12 +228,14 @@ static void AddLineNumber(RewriteBuffer &RB, unsigned LineNo,
 }
 
 void html::AddLineNumbers(Rewriter& R, FileID FID) {
-
   const llvm::MemoryBuffer *Buf = R.getSourceMgr().getBuffer(FID);
-  const char* FileBeg = Buf->getBufferStart();
-  const char* FileEnd = Buf->getBufferEnd();
+  AddLineNumbers(R.getEditBuffer(FID), Buf->getBuffer());
+}
+
+void html::AddLineNumbers(RewriteBuffer &RB, StringRef Buffer) {
+  const char* FileBeg = Buffer.begin();
+  const char* FileEnd = Buffer.end();
   const char* C = FileBeg;
-  RewriteBuffer &RB = R.getEditBuffer(FID);
 
   assert (C <= FileEnd);
 
@@ -269,14 +275,14 @@ void html::AddLineNumbers(Rewriter& R, FileID FID) {
 
 void html::AddHeaderFooterInternalBuiltinCSS(Rewriter& R, FileID FID,
                                              const char *title) {
-
   const llvm::MemoryBuffer *Buf = R.getSourceMgr().getBuffer(FID);
-  const char* FileStart = Buf->getBufferStart();
-  const char* FileEnd = Buf->getBufferEnd();
-
-  SourceLocation StartLoc = R.getSourceMgr().getLocForStartOfFile(FID);
-  SourceLocation EndLoc = StartLoc.getLocWithOffset(FileEnd-FileStart);
+  AddHeaderFooterInternalBuiltinCSS(R.getEditBuffer(FID), Buf->getBuffer(),
+                                    title);
+}
 
+void html::AddHeaderFooterInternalBuiltinCSS(RewriteBuffer &RB,
+                                             StringRef Buffer,
+                                             const char *title) {
   std::string s;
   llvm::raw_string_ostream os(s);
   os << "<!doctype html>\n" // Use HTML 5 doctype
@@ -344,23 +350,27 @@ void html::AddHeaderFooterInternalBuiltinCSS(Rewriter& R, FileID FID,
       "</style>\n</head>\n<body>";
 
   // Generate header
-  R.InsertTextBefore(StartLoc, os.str());
+  RB.InsertTextBefore(0, os.str());
   // Generate footer
 
-  R.InsertTextAfter(EndLoc, "</body></html>\n");
+  RB.InsertTextAfter(Buffer.size(), "</body></html>\n");
 }
 
+/// \brief Callback that highlights the offsets [B, E) of a file with the
+/// specified start/end tags.
+typedef llvm::function_ref<void(unsigned B, unsigned E, const char *StartTag,
+                                const char *EndTag)>
+    HighlightCallback;
+
 /// SyntaxHighlight - Relex the specified FileID and annotate the HTML with
 /// information about keywords, macro expansions etc.  This uses the macro
 /// table state from the end of the file, so it won't be perfectly perfect,
 /// but it will be reasonably close.
-void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
-  RewriteBuffer &RB = R.getEditBuffer(FID);
-
+static void SyntaxHighlightImpl(FileID FID, const Preprocessor &PP,
+                                HighlightCallback Highlight) {
   const SourceManager &SM = PP.getSourceManager();
   const llvm::MemoryBuffer *FromFile = SM.getBuffer(FID);
   Lexer L(FID, FromFile, SM, PP.getLangOpts());
-  const char *BufferStart = L.getBuffer().data();
 
   // Inform the preprocessor that we want to retain comments as tokens, so we
   // can highlight them.
@@ -387,13 +397,13 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
 
       // If this is a pp-identifier, for a keyword, highlight it as such.
       if (Tok.isNot(tok::identifier))
-        HighlightRange(RB, TokOffs, TokOffs+TokLen, BufferStart,
-                       "<span class='keyword'>", "</span>");
+        Highlight(TokOffs, TokOffs+TokLen,
+                  "<span class='keyword'>", "</span>");
       break;
     }
     case tok::comment:
-      HighlightRange(RB, TokOffs, TokOffs+TokLen, BufferStart,
-                     "<span class='comment'>", "</span>");
+      Highlight(TokOffs, TokOffs+TokLen,
+                "<span class='comment'>", "</span>");
       break;
     case tok::utf8_string_literal:
       // Chop off the u part of u8 prefix
@@ -409,8 +419,8 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
       // FALL THROUGH.
     case tok::string_literal:
       // FIXME: Exclude the optional ud-suffix from the highlighted range.
-      HighlightRange(RB, TokOffs, TokOffs+TokLen, BufferStart,
-                     "<span class='string_literal'>", "</span>");
+      Highlight(TokOffs, TokOffs+TokLen,
+                "<span class='string_literal'>", "</span>");
       break;
     case tok::hash: {
       // If this is a preprocessor directive, all tokens to end of line are too.
@@ -427,8 +437,8 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
       }
 
       // Find end of line.  This is a hack.
-      HighlightRange(RB, TokOffs, TokEnd, BufferStart,
-                     "<span class='directive'>", "</span>");
+      Highlight(TokOffs, TokEnd,
+                "<span class='directive'>", "</span>");
 
       // Don't skip the next token.
       continue;
@@ -443,7 +453,8 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
 /// file, to re-expand macros and insert (into the HTML) information about the
 /// macro expansions.  This won't be perfectly perfect, but it will be
 /// reasonably close.
-void html::HighlightMacros(Rewriter &R, FileID FID, const Preprocessor& PP) {
+static void HighlightMacrosImpl(FileID FID, const Preprocessor &PP,
+                                HighlightCallback Highlight) {
   // Re-lex the raw token stream into a token buffer.
   const SourceManager &SM = PP.getSourceManager();
   std::vector<Token> TokenStream;
@@ -572,11 +583,51 @@ void html::HighlightMacros(Rewriter &R, FileID FID, const Preprocessor& PP) {
     // highlighted.
     Expansion = "<span class='expansion'>" + Expansion + "</span></span>";
 
-    HighlightRange(R, LLoc.first, LLoc.second,
-                   "<span class='macro'>", Expansion.c_str());
+    unsigned BOffset = SM.getFileOffset(LLoc.first);
+    unsigned EOffset = SM.getFileOffset(LLoc.second) +
+                       Lexer::MeasureTokenLength(LLoc.second, SM,
+                                                 PP.getLangOpts());
+    Highlight(BOffset, EOffset, "<span class='macro'>", Expansion.c_str());
   }
 
   // Restore the preprocessor's old state.
   TmpPP.setDiagnostics(*OldDiags);
   TmpPP.setPragmasEnabled(PragmasPreviouslyEnabled);
 }
+
+void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
+  RewriteBuffer &RB = R.getEditBuffer(FID);
+  const char *BufferStart = PP.getSourceManager().getBufferData(FID).data();
+  SyntaxHighlightImpl(FID, PP, [&](unsigned B, unsigned E,
+                                   const char *StartTag, const char *EndTag) {
+    HighlightRange(RB, B, E, BufferStart, StartTag, EndTag);
+  });
+}
+
+void html::HighlightMacros(Rewriter &R, FileID FID, const Preprocessor &PP) {
+  RewriteBuffer &RB = R.getEditBuffer(FID);
+  const char *BufferStart = PP.getSourceManager().getBufferData(FID).data();
+  HighlightMacrosImpl(FID, PP, [&](unsigned B, unsigned E,
+                                   const char *StartTag, const char *EndTag) {
+    HighlightRange(RB, B, E, BufferStart, StartTag, EndTag);
+  });
+}
+
+html::HighlightedRanges::HighlightedRanges(FileID FID,
+                                           const Preprocessor &PP) {
+  auto Record = [&](unsigned B, unsigned E, const char *StartTag,
+                    const char *EndTag) {
+    Range R = {B, E, StartTag, EndTag};
+    Ranges.push_back(std::move(R));
+  };
+  SyntaxHighlightImpl(FID, PP, Record);
+  HighlightMacrosImpl(FID, PP, Record);
+}
+
+void html::HighlightedRanges::apply(RewriteBuffer &RB, StringRef Buffer,
+                                    unsigned Begin, unsigned End) const {
+  for (const Range &R : Ranges)
+    if (R.B >= Begin && R.E <= End)
+      HighlightRange(RB, R.B, R.E, Buffer.data(), R.StartTag.c_str(),
+                     R.EndTag.c_str());
+}
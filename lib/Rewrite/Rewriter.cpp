@@ -114,6 +114,51 @@ void RewriteBuffer::ReplaceText(unsigned OrigOffset, unsigned OrigLength,
     AddReplaceDelta(OrigOffset, NewStr.size() - OrigLength);
 }
 
+void RewriteBuffer::ReplaceTextBatch(ArrayRef<Edit> Edits) {
+  if (Edits.empty())
+    return;
+
+  // Map the edits to the current buffer before recording any of their deltas.
+  // As the edits don't overlap, these offsets are increasing as well.
+  std::vector<unsigned> RealOffsets;
+  RealOffsets.reserve(Edits.size());
+  for (const Edit &E : Edits)
+    RealOffsets.push_back(getMappedOffset(E.OrigOffset, true));
+
+  std::string Old;
+  Old.reserve(Buffer.size());
+  for (RopePieceBTreeIterator I = begin(), E = end(); I != E;
+       I.MoveToNextPiece())
+    Old += I.piece();
+
+  std::string New;
+  New.reserve(Old.size());
+  unsigned Pos = 0;
+  // Where the text of the edits at the current offset starts in New.
+  size_t GroupStart = 0;
+  for (unsigned i = 0, e = Edits.size(); i != e; ++i) {
+    const Edit &E = Edits[i];
+    if (i != 0 && E.OrigOffset == Edits[i - 1].OrigOffset) {
+      // ReplaceText() inserts text in front of what earlier edits at the same
+      // offset put there.
+      assert(E.OrigLength == 0 && "Overlapping edits");
+      New.insert(GroupStart, E.NewStr.data(), E.NewStr.size());
+    } else {
+      assert(RealOffsets[i] >= Pos && "Edits are not sorted or overlap");
+      assert(RealOffsets[i] + E.OrigLength <= Old.size() && "Invalid edit");
+      New.append(Old, Pos, RealOffsets[i] - Pos);
+      GroupStart = New.size();
+      New.append(E.NewStr.data(), E.NewStr.size());
+      Pos = RealOffsets[i] + E.OrigLength;
+    }
+  }
+  New.append(Old, Pos, std::string::npos);
+  Buffer.assign(New.data(), New.data() + New.size());
+
+  for (const Edit &E : Edits)
+    if (E.OrigLength != E.NewStr.size())
+      AddReplaceDelta(E.OrigOffset, E.NewStr.size() - E.OrigLength);
+}
 
 //===----------------------------------------------------------------------===//
 // Rewriter class
@@ -1851,7 +1851,9 @@ clang::sema::AnalysisBasedWarnings::AnalysisBasedWarnings(Sema &s)
     NumUninitAnalysisVariables(0),
     MaxUninitAnalysisVariablesPerFunction(0),
     NumUninitAnalysisBlockVisits(0),
-    MaxUninitAnalysisBlockVisitsPerFunction(0) {
+    MaxUninitAnalysisBlockVisitsPerFunction(0),
+    NumThreadSafetyAnalysisFunctions(0),
+    NumThreadSafetySkippedFunctions(0) {
 
   using namespace diag;
   DiagnosticsEngine &D = S.getDiagnostics();
@@ -2024,9 +2026,16 @@ AnalysisBasedWarnings::IssueWarnings(sema::AnalysisBasedWarnings::Policy P,
     if (!Diags.isIgnored(diag::warn_thread_safety_verbose, D->getLocStart()))
       Reporter.setVerbose(true);
 
-    threadSafety::runThreadSafetyAnalysis(AC, Reporter,
-                                          &S.ThreadSafetyDeclCache);
+    bool Analyzed = threadSafety::runThreadSafetyAnalysis(
+        AC, Reporter, &S.ThreadSafetyDeclCache);
     Reporter.emitDiagnostics();
+
+    if (S.CollectStats) {
+      if (Analyzed)
+        ++NumThreadSafetyAnalysisFunctions;
+      else
+        ++NumThreadSafetySkippedFunctions;
+    }
   }
 
   // Check for violations of consumed properties.
@@ -2134,4 +2143,9 @@ void clang::sema::AnalysisBasedWarnings::PrintStats() const {
                << " average block visits per function.\n"
                << "  " << MaxUninitAnalysisBlockVisitsPerFunction
                << " max block visits per function.\n";
+
+  llvm::errs() << NumThreadSafetyAnalysisFunctions
+               << " functions analyzed for thread safety\n"
+               << "  " << NumThreadSafetySkippedFunctions
+               << " functions skipped without capabilities.\n";
 }
@@ -277,6 +277,12 @@ void MultiplexExternalSemaSource::ReadUsedVTables(
     Sources[i]->ReadUsedVTables(VTables);
 }
 
+void MultiplexExternalSemaSource::ReadSpecialMemberResults(
+    SmallVectorImpl<ExternalSpecialMemberResult> &Results) {
+  for (size_t i = 0; i < Sources.size(); ++i)
+    Sources[i]->ReadSpecialMemberResults(Results);
+}
+
 void MultiplexExternalSemaSource::ReadPendingInstantiations(
                                            SmallVectorImpl<std::pair<ValueDecl*,
                                                    SourceLocation> > &Pending) {
@@ -21,10 +21,13 @@
 #include "clang/AST/Expr.h"
 #include "clang/AST/ExprCXX.h"
 #include "clang/AST/StmtCXX.h"
+#include "clang/Analysis/Analyses/FormatString.h"
+#include "clang/Basic/CompileTimeBudget.h"
 #include "clang/Basic/DiagnosticOptions.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/PartialDiagnostic.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/CXXFieldCollector.h"
@@ -40,6 +43,7 @@
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallSet.h"
+#include "llvm/Support/Format.h"
 using namespace clang;
 using namespace sema;
 
@@ -90,7 +94,8 @@ Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
     IsBuildingRecoveryCallExpr(false),
     Cleanup{}, LateTemplateParser(nullptr),
     LateTemplateParserCleanup(nullptr),
-    OpaqueParser(nullptr), IdResolver(pp), StdInitializerList(nullptr),
+    OpaqueParser(nullptr), LateParsedTemplateDepth(0), IdResolver(pp),
+    StdInitializerList(nullptr),
     CXXTypeInfoDecl(nullptr), MSVCGuidDecl(nullptr),
     NSNumberDecl(nullptr), NSValueDecl(nullptr),
     NSStringDecl(nullptr), StringWithUTF8StringMethod(nullptr),
@@ -100,7 +105,9 @@ Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
     MSAsmLabelNameCounter(0),
     GlobalNewDeleteDeclared(false),
     TUKind(TUKind),
-    NumSFINAEErrors(0),
+    NumSFINAEErrors(0), NumClassInstantiations(0),
+    NumFunctionInstantiations(0), NumSuppressedFunctionInstantiations(0),
+    NumTransformedExprs(0), NumRebuiltExprs(0), NumSkippedExprs(0),
     CachedFakeTopLevelModule(nullptr),
     AccessCheckingSFINAE(false), InNonInstantiationSFINAEContext(false),
     NonInstantiationEntries(0), ArgumentPackSubstitutionIndex(-1),
@@ -112,6 +119,8 @@ Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
   TUScope = nullptr;
 
   LoadedExternalKnownNamespaces = false;
+  ExternalTypoCorrectionNamesGeneration = 0;
+  LoadedExternalTypoCorrectionNames = false;
   for (unsigned I = 0; I != NSAPI::NumNSNumberLiteralMethods; ++I)
     NSNumberLiteralMethods[I] = nullptr;
 
@@ -343,6 +352,20 @@ void Sema::addExternalSource(ExternalSemaSource *E) {
 void Sema::PrintStats() const {
   llvm::errs() << "\n*** Semantic Analysis Stats:\n";
   llvm::errs() << NumSFINAEErrors << " SFINAE diagnostics trapped.\n";
+  llvm::errs() << NumClassInstantiations
+               << " class definitions instantiated.\n";
+  llvm::errs() << NumFunctionInstantiations
+               << " function definitions instantiated.\n";
+  llvm::errs() << NumSuppressedFunctionInstantiations
+               << " function definitions left to explicit instantiations.\n";
+  llvm::errs() << NumTransformedExprs << " expressions transformed, "
+               << NumRebuiltExprs << " rebuilt, " << NumSkippedExprs
+               << " skipped as unchanged.\n";
+  if (unsigned NumInstantiations =
+          NumClassInstantiations + NumFunctionInstantiations)
+    llvm::errs() << "  " << llvm::format("%.1f", double(NumTransformedExprs) /
+                                                     NumInstantiations)
+                 << " expressions transformed per instantiated definition.\n";
 
   BumpAlloc.PrintStats();
   AnalysisWarnings.PrintStats();
@@ -572,7 +595,9 @@ static bool MethodsAndNestedClassesComplete(const CXXRecordDecl *RD,
                                   E = RD->decls_end();
        I != E && Complete; ++I) {
     if (const CXXMethodDecl *M = dyn_cast<CXXMethodDecl>(*I))
-      Complete = M->isDefined() || (M->isPure() && !isa<CXXDestructorDecl>(M));
+      // A body that was never parsed may use anything.
+      Complete = (M->isDefined() && !M->isLateTemplateParsed()) ||
+                 (M->isPure() && !isa<CXXDestructorDecl>(M));
     else if (const FunctionTemplateDecl *F = dyn_cast<FunctionTemplateDecl>(*I))
       // If the template function is marked as late template parsed at this
       // point, it has not been instantiated and therefore we have not
@@ -645,10 +670,29 @@ void Sema::emitAndClearUnusedLocalTypedefWarnings() {
   UnusedLocalTypedefNameCandidates.clear();
 }
 
+void Sema::ParsePendingLazyFunctionBodies() {
+  // Parsing a body can add more functions to the list.
+  for (unsigned I = 0; I != PendingLazyFunctionBodies.size(); ++I) {
+    FunctionDecl *FD = PendingLazyFunctionBodies[I];
+    LateParsedTemplate *LPT = LateParsedTemplateMap.lookup(FD);
+    if (!FD->isLateTemplateParsed() || !LPT || !LateTemplateParser)
+      continue;
+
+    LateTemplateParser(OpaqueParser, *LPT);
+
+    // The consumer has seen the function without its body.
+    Consumer.HandleTopLevelDecl(DeclGroupRef(FD));
+  }
+  PendingLazyFunctionBodies.clear();
+}
+
 /// ActOnEndOfTranslationUnit - This is called at the very end of the
 /// translation unit when EOF is reached and all but the top-level scope is
 /// popped.
 void Sema::ActOnEndOfTranslationUnit() {
+  TimeTraceScope TraceScope("ActOnEndOfTranslationUnit");
+  CompileTimePhaseScope PhaseScope("end of translation unit");
+
   assert(DelayedDiagnostics.getCurrentPool() == nullptr
          && "reached end of translation unit with a pool attached?");
 
@@ -685,6 +729,14 @@ void Sema::ActOnEndOfTranslationUnit() {
     }
     PerformPendingInstantiations();
 
+    // Parsing the bodies of the lazily parsed inline functions that were used
+    // can use more of them, as well as vtables and templates.
+    while (!PendingLazyFunctionBodies.empty()) {
+      ParsePendingLazyFunctionBodies();
+      DefineUsedVTables();
+      PerformPendingInstantiations();
+    }
+
     if (LateTemplateParserCleanup)
       LateTemplateParserCleanup(OpaqueParser);
 
@@ -5543,6 +5543,23 @@ bool CheckScanfHandler::HandleScanfSpecifier(
   return true;
 }
 
+/// \brief Retrieve the parsed form of the format string \p Str, parsing it
+/// on first use.
+static const analyze_format_string::ParsedFormatString &
+getParsedFormatString(Sema &S, StringRef Str,
+                      analyze_format_string::ParsedFormatString::FormatKind
+                          Kind) {
+  SmallString<128> Key;
+  Key.push_back(static_cast<char>(Kind));
+  Key += Str;
+  std::unique_ptr<analyze_format_string::ParsedFormatString> &Parsed =
+      S.ParsedFormatStrings[Key];
+  if (!Parsed)
+    Parsed = llvm::make_unique<analyze_format_string::ParsedFormatString>(
+        Str, Kind, S.getLangOpts(), S.Context.getTargetInfo());
+  return *Parsed;
+}
+
 static void CheckFormatString(Sema &S, const StringLiteral *FExpr,
                               const Expr *OrigFormatExpr,
                               ArrayRef<const Expr *> Args,
@@ -5594,29 +5611,34 @@ static void CheckFormatString(Sema &S, const StringLiteral *FExpr,
     return;
   }
 
+  // The handlers locate the specifiers relative to the start of the string
+  // they are given, so they are handed the cached copy of the format string
+  // that the parsed specifiers point into.
+  typedef analyze_format_string::ParsedFormatString ParsedFormatString;
   if (Type == Sema::FST_Printf || Type == Sema::FST_NSString ||
       Type == Sema::FST_FreeBSDKPrintf || Type == Sema::FST_OSTrace) {
+    const ParsedFormatString &Parsed = getParsedFormatString(
+        S, StringRef(Str, StrLen),
+        Type == Sema::FST_FreeBSDKPrintf ? ParsedFormatString::FreeBSDKPrintf
+                                         : ParsedFormatString::Printf);
     CheckPrintfHandler H(S, FExpr, OrigFormatExpr, firstDataArg,
                          numDataArgs, (Type == Sema::FST_NSString ||
                                        Type == Sema::FST_OSTrace),
-                         Str, HasVAListArg, Args, format_idx,
-                         inFunctionCall, CallType, CheckedVarArgs,
+                         Parsed.getString().data(), HasVAListArg, Args,
+                         format_idx, inFunctionCall, CallType, CheckedVarArgs,
                          UncoveredArg);
 
-    if (!analyze_format_string::ParsePrintfString(H, Str, Str + StrLen,
-                                                  S.getLangOpts(),
-                                                  S.Context.getTargetInfo(),
-                                            Type == Sema::FST_FreeBSDKPrintf))
+    if (!Parsed.replay(H))
       H.DoneProcessing();
   } else if (Type == Sema::FST_Scanf) {
+    const ParsedFormatString &Parsed = getParsedFormatString(
+        S, StringRef(Str, StrLen), ParsedFormatString::Scanf);
     CheckScanfHandler H(S, FExpr, OrigFormatExpr, firstDataArg, numDataArgs,
-                        Str, HasVAListArg, Args, format_idx,
-                        inFunctionCall, CallType, CheckedVarArgs,
+                        Parsed.getString().data(), HasVAListArg, Args,
+                        format_idx, inFunctionCall, CallType, CheckedVarArgs,
                         UncoveredArg);
 
-    if (!analyze_format_string::ParseScanfString(H, Str, Str + StrLen,
-                                                 S.getLangOpts(),
-                                                 S.Context.getTargetInfo()))
+    if (!Parsed.replay(H))
       H.DoneProcessing();
   } // TODO: handle other formats
 }
@@ -8262,6 +8284,10 @@ void CheckImplicitConversion(Sema &S, Expr *E, QualType T,
 
       // Builtin FP kinds are ordered by increasing FP rank.
       if (SourceBT->getKind() > TargetBT->getKind()) {
+        // -Wconversion is usually off; don't bother evaluating E then.
+        if (S.Diags.isIgnored(diag::warn_impcast_float_precision, CC))
+          return;
+
         // Don't warn about float constants that are precisely
         // representable in the target type.
         Expr::EvalResult result;
@@ -11364,6 +11364,19 @@ Decl *Sema::ActOnStartOfFunctionDef(Scope *FnBodyScope, Decl *D,
       getCurLexicalContext()->getDeclKind() != Decl::ObjCImplementation)
     Diag(FD->getLocation(), diag::warn_function_def_in_objc_container);
 
+  // In C, nothing but the function itself refers to the statements of its
+  // body, so they can be allocated in a region that is released once code
+  // has been generated for it. Templates, lambdas, blocks, captured
+  // statements and deserialized declarations could all end up in the region
+  // otherwise.
+  Context.finishBodyRegion();
+  const LangOptions &LO = getLangOpts();
+  if (Context.shouldAllocateBodiesInRegions() && !LO.CPlusPlus && !LO.ObjC1 &&
+      !LO.Blocks && !LO.OpenMP && !LO.OpenCL && !LO.CUDA &&
+      !Context.getExternalSource() &&
+      FD->getDeclContext()->isTranslationUnit() && !FD->isInlineSpecified())
+    Context.startBodyRegion(FD);
+
   return D;
 }
 
@@ -11414,6 +11427,20 @@ bool Sema::canDelayFunctionBody(const Declarator &D) {
   return true;
 }
 
+bool Sema::canParseFunctionBodyOnUse(Decl *D) {
+  FunctionDecl *FD = D->getAsFunction();
+  if (!FD || FD->getDescribedFunctionTemplate())
+    return false;
+
+  // The bodies of templates are parsed when they are instantiated, and those
+  // of the members of local classes can't be parsed outside of the function.
+  if (FD->isDependentContext() || FD->getParentFunctionOrMethod())
+    return false;
+
+  // A function with the 'used' attribute is emitted even if it isn't used.
+  return !FD->hasAttr<UsedAttr>();
+}
+
 bool Sema::canSkipFunctionBody(Decl *D) {
   // We cannot skip the body of a function (or function template) which is
   // constexpr, since we may need to evaluate its body in order to parse the
@@ -11710,6 +11737,7 @@ Decl *Sema::ActOnFinishFunctionBody(Decl *dcl, Stmt *Body,
     DiscardCleanupsInEvaluationContext();
   }
 
+  Context.finishBodyRegion();
   return dcl;
 }
 
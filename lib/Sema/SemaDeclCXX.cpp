@@ -1713,11 +1713,14 @@ bool Sema::IsDerivedFrom(SourceLocation Loc, QualType Derived, QualType Base,
 
 void Sema::BuildBasePathArray(const CXXBasePaths &Paths, 
                               CXXCastPath &BasePathArray) {
-  assert(BasePathArray.empty() && "Base path array must be empty!");
   assert(Paths.isRecordingPaths() && "Must record paths!");
-  
-  const CXXBasePath &Path = Paths.front();
-       
+  BuildBasePathArray(Paths.front(), BasePathArray);
+}
+
+void Sema::BuildBasePathArray(ArrayRef<CXXBasePathElement> Path,
+                              CXXCastPath &BasePathArray) {
+  assert(BasePathArray.empty() && "Base path array must be empty!");
+
   // We first go backward and check if we have a virtual base.
   // FIXME: It would be better if CXXBasePath had the base specifier for
   // the nearest virtual base.
@@ -1754,6 +1757,28 @@ Sema::CheckDerivedToBaseConversion(QualType Derived, QualType Base,
                                    DeclarationName Name,
                                    CXXCastPath *BasePath,
                                    bool IgnoreAccess) {
+  // Most conversions are between complete classes whose derivation is
+  // memoized, along with its first path, in the ASTContext.
+  CXXRecordDecl *DerivedRD = Derived->getAsCXXRecordDecl();
+  CXXRecordDecl *BaseRD = Base->getAsCXXRecordDecl();
+  if (DerivedRD && BaseRD && CXXDerivation::isMemoizable(DerivedRD)) {
+    const CXXDerivation *Derivation = Context.getDerivation(DerivedRD, BaseRD);
+    assert(Derivation && "Can only be used with a derived-to-base conversion");
+    if (!Derivation->isAmbiguous()) {
+      if (!IgnoreAccess) {
+        CXXBasePath Path;
+        Derivation->getPath(Path);
+        if (CheckBaseClassAccess(Loc, Base, Derived, Path,
+                                 InaccessibleBaseID) == AR_inaccessible)
+          return true;
+      }
+
+      if (BasePath)
+        BuildBasePathArray(Derivation->getPath(), *BasePath);
+      return false;
+    }
+  }
+
   // First, determine whether the path from Derived to Base is
   // ambiguous. This is slightly more expensive than checking whether
   // the Derived to Base conversion exists, because here we need to
@@ -4440,19 +4465,19 @@ void Sema::DiagnoseAbstractType(const CXXRecordDecl *RD) {
   if (Diags.isLastDiagnosticIgnored())
     return;
 
-  CXXFinalOverriderMap FinalOverriders;
-  RD->getFinalOverriders(FinalOverriders);
+  const CXXFinalOverriderMap &FinalOverriders =
+      Context.getFinalOverriders(RD);
 
   // Keep a set of seen pure methods so we won't diagnose the same method
   // more than once.
   llvm::SmallPtrSet<const CXXMethodDecl *, 8> SeenPureMethods;
   
-  for (CXXFinalOverriderMap::iterator M = FinalOverriders.begin(), 
-                                   MEnd = FinalOverriders.end();
+  for (CXXFinalOverriderMap::const_iterator M = FinalOverriders.begin(), 
+                                         MEnd = FinalOverriders.end();
        M != MEnd; 
        ++M) {
-    for (OverridingMethods::iterator SO = M->second.begin(), 
-                                  SOEnd = M->second.end();
+    for (OverridingMethods::const_iterator SO = M->second.begin(), 
+                                        SOEnd = M->second.end();
          SO != SOEnd; ++SO) {
       // C++ [class.abstract]p4:
       //   A class is abstract if it contains or inherits at least one
@@ -9092,10 +9117,12 @@ struct DeclaringSpecialMember {
   DeclaringSpecialMember(Sema &S, CXXRecordDecl *RD, Sema::CXXSpecialMember CSM)
     : S(S), D(RD, CSM), SavedContext(S, RD) {
     WasAlreadyBeingDeclared = !S.SpecialMembersBeingDeclared.insert(D).second;
-    if (WasAlreadyBeingDeclared)
+    if (WasAlreadyBeingDeclared) {
       // This almost never happens, but if it does, ensure that our cache
       // doesn't contain a stale result.
       S.SpecialMemberCache.clear();
+      S.LocalSpecialMemberResults.clear();
+    }
 
     // FIXME: Register a note to be produced if we encounter an error while
     // declaring the special member.
@@ -13547,8 +13574,8 @@ void Sema::MarkVirtualMemberExceptionSpecsNeeded(SourceLocation Loc,
 void Sema::MarkVirtualMembersReferenced(SourceLocation Loc,
                                         const CXXRecordDecl *RD) {
   // Mark all functions which will appear in RD's vtable as used.
-  CXXFinalOverriderMap FinalOverriders;
-  RD->getFinalOverriders(FinalOverriders);
+  const CXXFinalOverriderMap &FinalOverriders =
+      Context.getFinalOverriders(RD);
   for (CXXFinalOverriderMap::const_iterator I = FinalOverriders.begin(),
                                             E = FinalOverriders.end();
        I != E; ++I) {
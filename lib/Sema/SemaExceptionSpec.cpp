@@ -1179,6 +1179,7 @@ CanThrowResult Sema::canThrow(const Expr *E) {
   case Expr::ImplicitValueInitExprClass:
   case Expr::IntegerLiteralClass:
   case Expr::NoInitExprClass:
+  case Expr::DataArrayExprClass:
   case Expr::ObjCEncodeExprClass:
   case Expr::ObjCStringLiteralClass:
   case Expr::ObjCBoolLiteralExprClass:
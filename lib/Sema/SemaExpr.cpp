@@ -13117,6 +13117,12 @@ void Sema::MarkFunctionReferenced(SourceLocation Loc, FunctionDecl *Func,
 
   if (!OdrUse) return;
 
+  // The body of an inline function parsed with -flazy-inline-method-parsing
+  // is only parsed at the end of the translation unit once it is used.
+  if (Func->isLateTemplateParsed() && !Func->isUsed(/*CheckUsedAttr=*/false) &&
+      !Func->isDependentContext() && LateParsedTemplateMap.count(Func))
+    PendingLazyFunctionBodies.push_back(Func);
+
   // Keep track of used but undefined functions.
   if (!Func->isDefined()) {
     if (mightHaveNonExternalLinkage(Func))
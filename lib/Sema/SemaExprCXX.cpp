@@ -6843,6 +6843,12 @@ public:
     return Result;
   }
 
+  /// TypoExprs are instantiation-dependent, so an expression that is not
+  /// cannot contain any.
+  bool AlreadyTransformedExpr(Expr *E) {
+    return !E->isInstantiationDependent();
+  }
+
   ExprResult TransformLambdaExpr(LambdaExpr *E) { return Owned(E); }
 
   ExprResult TransformBlockExpr(BlockExpr *E) { return Owned(E); }
@@ -3392,6 +3392,80 @@ static void MaybeProduceObjCObject(Sema &S,
   }
 }
 
+/// The smallest initializer list that is represented as a DataArrayExpr.
+static const unsigned MinDataArrayInits = 64;
+
+/// \brief Determine whether the initializer list \p IList for a variable of
+/// array type \p DestType consists only of integer and character literals
+/// whose values the element type can represent exactly.
+///
+/// Initializing from such a list can never produce a diagnostic, so it is not
+/// checked element by element; instead, it is represented as a DataArrayExpr.
+///
+/// \param Values If non-null, receives the value of each element.
+static bool isDataArrayInit(Sema &S, const InitializedEntity &Entity,
+                            QualType DestType, InitListExpr *IList,
+                            SmallVectorImpl<uint64_t> *Values = nullptr) {
+  if (Entity.getKind() != InitializedEntity::EK_Variable ||
+      IList->getNumInits() < MinDataArrayInits ||
+      IList->isTypeDependent() || IList->isValueDependent() ||
+      S.Context.getCharWidth() != 8)
+    return false;
+
+  const ArrayType *AT = S.Context.getAsArrayType(DestType);
+  if (!AT || (!isa<ConstantArrayType>(AT) && !isa<IncompleteArrayType>(AT)))
+    return false;
+  if (const ConstantArrayType *CAT = dyn_cast<ConstantArrayType>(AT))
+    if (CAT->getSize().ult(IList->getNumInits()))
+      return false;
+
+  QualType EltTy = AT->getElementType();
+  if (!EltTy->isIntegerType() || EltTy->isBooleanType() ||
+      EltTy->isEnumeralType() || EltTy.isVolatileQualified())
+    return false;
+  unsigned Width = S.Context.getTypeSize(EltTy);
+  if (Width != 8 && Width != 16 && Width != 32 && Width != 64)
+    return false;
+  bool IsUnsigned = EltTy->isUnsignedIntegerType();
+
+  for (Expr *Init : IList->inits()) {
+    llvm::APSInt Value;
+    if (IntegerLiteral *IL = dyn_cast<IntegerLiteral>(Init))
+      Value = llvm::APSInt(IL->getValue(),
+                           IL->getType()->isUnsignedIntegerType());
+    else if (CharacterLiteral *CL = dyn_cast<CharacterLiteral>(Init))
+      Value = S.Context.MakeIntValue(CL->getValue(), CL->getType());
+    else
+      return false;
+
+    llvm::APSInt Converted = Value.extOrTrunc(Width);
+    Converted.setIsUnsigned(IsUnsigned);
+    if (!llvm::APSInt::isSameValue(Converted, Value))
+      return false;
+    if (Values)
+      Values->push_back(Converted.getZExtValue());
+  }
+  return true;
+}
+
+/// \brief Build the DataArrayExpr for an initializer list accepted by
+/// isDataArrayInit, computing the bound of \p T if it is incomplete.
+static DataArrayExpr *BuildDataArrayInit(Sema &S, QualType &T,
+                                         InitListExpr *IList,
+                                         ArrayRef<uint64_t> Values) {
+  const ArrayType *AT = S.Context.getAsArrayType(T);
+  QualType EltTy = AT->getElementType();
+  if (isa<IncompleteArrayType>(AT)) {
+    llvm::APInt Size(S.Context.getTypeSize(S.Context.getSizeType()),
+                     Values.size());
+    T = S.Context.getConstantArrayType(EltTy, Size, ArrayType::Normal, 0);
+  }
+  IList->setType(T);
+  return DataArrayExpr::Create(
+      S.Context, T, IList, Values,
+      S.Context.getTypeSizeInChars(EltTy).getQuantity());
+}
+
 static void TryListInitialization(Sema &S,
                                   const InitializedEntity &Entity,
                                   const InitializationKind &Kind,
@@ -3927,6 +4001,13 @@ static void TryListInitialization(Sema &S,
     }
   }
 
+  // A long list of literals for an array of integers needs no further
+  // checking; don't walk it twice.
+  if (isDataArrayInit(S, Entity, DestType, InitList)) {
+    Sequence.AddListInitializationStep(DestType);
+    return;
+  }
+
   InitListChecker CheckInitList(S, Entity, InitList,
           DestType, /*VerifyOnly=*/true, TreatUnavailableAsInvalid);
   if (CheckInitList.HadError()) {
@@ -6662,11 +6743,23 @@ InitializationSequence::Perform(Sema &S,
       bool IsTemporary = !S.Context.hasSameType(Entity.getType(), Ty);
       InitializedEntity TempEntity = InitializedEntity::InitializeTemporary(Ty);
       InitializedEntity InitEntity = IsTemporary ? TempEntity : Entity;
-      InitListChecker PerformInitList(S, InitEntity,
-          InitList, Ty, /*VerifyOnly=*/false,
-          /*TreatUnavailableAsInvalid=*/false);
-      if (PerformInitList.HadError())
-        return ExprError();
+      SmallVector<uint64_t, 64> DataArrayValues;
+      if (!IsTemporary &&
+          isDataArrayInit(S, Entity, Ty, InitList, &DataArrayValues)) {
+        CurInit = BuildDataArrayInit(S, Ty, InitList, DataArrayValues);
+      } else {
+        InitListChecker PerformInitList(S, InitEntity,
+            InitList, Ty, /*VerifyOnly=*/false,
+            /*TreatUnavailableAsInvalid=*/false);
+        if (PerformInitList.HadError())
+          return ExprError();
+
+        InitListExpr *StructuredInitList =
+            PerformInitList.getFullyStructuredList();
+        CurInit = shouldBindAsTemporary(InitEntity)
+            ? S.MaybeBindToTemporary(StructuredInitList)
+            : StructuredInitList;
+      }
 
       // Hack: We must update *ResultType if available in order to set the
       // bounds of arrays, e.g. in 'int ar[] = {1, 2, 3};'.
@@ -6680,13 +6773,6 @@ InitializationSequence::Perform(Sema &S,
             (*ResultType)->getAs<LValueReferenceType>()->isSpelledAsLValue());
         *ResultType = Ty;
       }
-
-      InitListExpr *StructuredInitList =
-          PerformInitList.getFullyStructuredList();
-      CurInit.get();
-      CurInit = shouldBindAsTemporary(InitEntity)
-          ? S.MaybeBindToTemporary(StructuredInitList)
-          : StructuredInitList;
       break;
     }
 
@@ -668,6 +668,62 @@ LLVM_DUMP_METHOD void LookupResult::dump() {
     D->dump();
 }
 
+#include "OpenCLBuiltins.inc"
+
+/// \brief Declare the overloads of the OpenCL builtin \p II, which are the
+/// \p Len entries of OpenCLBuiltinTable starting at \p Index, in the
+/// translation unit and add them to \p R.
+static void InsertOpenCLBuiltinDeclarations(Sema &S, LookupResult &R,
+                                            IdentifierInfo *II, unsigned Index,
+                                            unsigned Len) {
+  ASTContext &Context = S.Context;
+  DeclContext *Parent = Context.getTranslationUnitDecl();
+  SourceLocation Loc = R.getNameLoc();
+
+  for (unsigned I = Index; I != Index + Len; ++I) {
+    const OpenCLBuiltinStruct &Builtin = OpenCLBuiltinTable[I];
+    const unsigned *Sig = &OpenCLSignatureTable[Builtin.SigTableIndex];
+
+    QualType RetTy = getOpenCLBuiltinType(Context, OpenCLTypeTable[Sig[0]]);
+    SmallVector<QualType, 4> ArgTys;
+    for (unsigned J = 1; J != Builtin.NumTypes; ++J)
+      ArgTys.push_back(getOpenCLBuiltinType(Context, OpenCLTypeTable[Sig[J]]));
+    QualType FTy = Context.getFunctionType(RetTy, ArgTys,
+                                           FunctionProtoType::ExtProtoInfo());
+
+    FunctionDecl *New = FunctionDecl::Create(Context, Parent, Loc, Loc, II,
+                                             FTy, /*TInfo=*/nullptr,
+                                             SC_Extern, false,
+                                             /*hasWrittenPrototype=*/true);
+    New->setImplicit();
+
+    const FunctionProtoType *FP = FTy->castAs<FunctionProtoType>();
+    SmallVector<ParmVarDecl *, 4> Params;
+    for (unsigned J = 0, E = FP->getNumParams(); J != E; ++J) {
+      ParmVarDecl *Parm =
+          ParmVarDecl::Create(Context, New, SourceLocation(), SourceLocation(),
+                              nullptr, FP->getParamType(J), /*TInfo=*/nullptr,
+                              SC_None, nullptr);
+      Parm->setScopeInfo(0, J);
+      Params.push_back(Parm);
+    }
+    New->setParams(Params);
+
+    New->addAttr(OverloadableAttr::CreateImplicit(Context));
+    New->addAttr(ConstAttr::CreateImplicit(Context));
+
+    // See Sema::LazilyCreateBuiltin.
+    DeclContext *SavedContext = S.CurContext;
+    S.CurContext = Parent;
+    S.PushOnScopeChains(New, S.TUScope);
+    S.CurContext = SavedContext;
+
+    R.addDecl(New);
+  }
+
+  R.resolveKind();
+}
+
 /// \brief Lookup a builtin function, when name lookup would otherwise
 /// fail.
 static bool LookupBuiltin(Sema &S, LookupResult &R) {
@@ -690,6 +746,17 @@ static bool LookupBuiltin(Sema &S, LookupResult &R) {
         }
       }
 
+      // Declare the OpenCL builtins from the table generated from
+      // OpenCLBuiltins.td instead of relying on opencl-c.h.
+      if (S.getLangOpts().OpenCL && S.getLangOpts().DeclareOpenCLBuiltins) {
+        auto Builtin = isOpenCLBuiltin(II->getName());
+        if (Builtin.second) {
+          InsertOpenCLBuiltinDeclarations(S, R, II, Builtin.first,
+                                          Builtin.second);
+          return true;
+        }
+      }
+
       // If this is a builtin on this (or all) targets, create the decl.
       if (unsigned BuiltinID = II->getBuiltinID()) {
         // In C++ and OpenCL (spec v1.2 s6.9.f), we don't have any predefined
@@ -1644,6 +1711,18 @@ bool Sema::hasVisibleDeclarationSlow(const NamedDecl *D,
   return false;
 }
 
+bool LookupResult::isDeclaredTooLate(NamedDecl *D) const {
+  // Class members are visible in the whole class, and local declarations
+  // can't precede their scope.
+  if (!D->getDeclContext()->getRedeclContext()->isFileContext())
+    return false;
+
+  SourceLocation Loc = D->getCanonicalDecl()->getLocation();
+  return Loc.isValid() &&
+         getSema().getSourceManager().isBeforeInTranslationUnit(DeclaredBefore,
+                                                                Loc);
+}
+
 NamedDecl *LookupResult::getAcceptableDeclSlow(NamedDecl *D) const {
   if (auto *ND = dyn_cast<NamespaceDecl>(D)) {
     // Namespaces are a bit of a special case: we expect there to be a lot of
@@ -1785,6 +1864,11 @@ bool Sema::LookupName(LookupResult &R, Scope *S, bool AllowBuiltinCreation) {
         return true;
       }
   } else {
+    // In the body of a late-parsed template, only see what preceded it.
+    if (LateParsedTemplateEnd.isValid() && !R.isForRedeclaration() &&
+        ActiveTemplateInstantiations.size() == LateParsedTemplateDepth)
+      R.setDeclaredBefore(LateParsedTemplateEnd);
+
     // Perform C++ unqualified name lookup.
     if (CppLookupName(R, S))
       return true;
@@ -2810,6 +2894,36 @@ void Sema::LookupOverloadedOperatorName(OverloadedOperatorKind Op, Scope *S,
   Functions.append(Operators.begin(), Operators.end());
 }
 
+bool Sema::ReadSpecialMemberResults() {
+  SmallVector<ExternalSpecialMemberResult, 16> Results;
+  ExternalSource->ReadSpecialMemberResults(Results);
+
+  bool Added = false;
+  for (const ExternalSpecialMemberResult &E : Results) {
+    // Use the definition that lookups in this translation unit will use.
+    CXXRecordDecl *RD = E.Record ? E.Record->getDefinition() : nullptr;
+    if (!RD)
+      continue;
+
+    llvm::FoldingSetNodeID ID;
+    ID.AddPointer(RD);
+    ID.AddInteger(E.Lookup);
+
+    void *InsertPoint;
+    if (SpecialMemberCache.FindNodeOrInsertPos(ID, InsertPoint))
+      continue;
+
+    SpecialMemberOverloadResult *Result =
+        BumpAlloc.Allocate<SpecialMemberOverloadResult>();
+    Result = new (Result) SpecialMemberOverloadResult(ID, RD, E.Lookup);
+    Result->setMethod(E.Method);
+    Result->setKind(static_cast<SpecialMemberOverloadResult::Kind>(E.Kind));
+    SpecialMemberCache.InsertNode(Result, InsertPoint);
+    Added = true;
+  }
+  return Added;
+}
+
 Sema::SpecialMemberOverloadResult *Sema::LookupSpecialMember(CXXRecordDecl *RD,
                                                             CXXSpecialMember SM,
                                                             bool ConstArg,
@@ -2827,26 +2941,29 @@ Sema::SpecialMemberOverloadResult *Sema::LookupSpecialMember(CXXRecordDecl *RD,
     assert((SM != CXXDefaultConstructor && SM != CXXDestructor) &&
            "parameter-less special members can't have qualified arguments");
 
+  unsigned Lookup = getSpecialMemberLookup(SM, ConstArg, VolatileArg,
+                                           RValueThis, ConstThis, VolatileThis);
   llvm::FoldingSetNodeID ID;
   ID.AddPointer(RD);
-  ID.AddInteger(SM);
-  ID.AddInteger(ConstArg);
-  ID.AddInteger(VolatileArg);
-  ID.AddInteger(RValueThis);
-  ID.AddInteger(ConstThis);
-  ID.AddInteger(VolatileThis);
+  ID.AddInteger(Lookup);
 
   void *InsertPoint;
   SpecialMemberOverloadResult *Result =
     SpecialMemberCache.FindNodeOrInsertPos(ID, InsertPoint);
 
-  // This was already cached
+  // This was already cached, possibly by the AST file that defines the class.
   if (Result)
     return Result;
+  if (ExternalSource && ReadSpecialMemberResults()) {
+    Result = SpecialMemberCache.FindNodeOrInsertPos(ID, InsertPoint);
+    if (Result)
+      return Result;
+  }
 
   Result = BumpAlloc.Allocate<SpecialMemberOverloadResult>();
-  Result = new (Result) SpecialMemberOverloadResult(ID);
+  Result = new (Result) SpecialMemberOverloadResult(ID, RD, Lookup);
   SpecialMemberCache.InsertNode(Result, InsertPoint);
+  LocalSpecialMemberResults.push_back(Result);
 
   if (SM == CXXDestructor) {
     if (RD->needsImplicitDestructor())
@@ -4463,6 +4580,50 @@ static void AddKeywordsToConsumer(Sema &SemaRef,
   }
 }
 
+void Sema::addExternalTypoCorrectionNames(TypoCorrectionConsumer &Consumer,
+                                          StringRef Typo) {
+  IdentifierInfoLookup *External = Context.Idents.getExternalIdentifierLookup();
+  if (!External)
+    return;
+
+  // Without a generation number we can't tell when the external source
+  // learns about new identifiers, so just walk all of them each time.
+  ExternalASTSource *Source = Context.getExternalSource();
+  if (!Source) {
+    std::unique_ptr<IdentifierIterator> Iter(External->getIdentifiers());
+    for (StringRef Name = Iter->Next(); !Name.empty(); Name = Iter->Next())
+      Consumer.FoundName(Name);
+    return;
+  }
+
+  // (Re)build the index if this is the first typo we correct, or if AST files
+  // have been loaded since. Loading an AST file always bumps the generation,
+  // even if it fails, so a stale index never outlives the names it refers to.
+  if (!LoadedExternalTypoCorrectionNames ||
+      ExternalTypoCorrectionNamesGeneration != Source->getGeneration()) {
+    LoadedExternalTypoCorrectionNames = true;
+    ExternalTypoCorrectionNamesGeneration = Source->getGeneration();
+    ExternalTypoCorrectionNames.clear();
+
+    std::unique_ptr<IdentifierIterator> Iter(External->getIdentifiers());
+    for (StringRef Name = Iter->Next(); !Name.empty(); Name = Iter->Next()) {
+      if (Name.size() >= ExternalTypoCorrectionNames.size())
+        ExternalTypoCorrectionNames.resize(Name.size() + 1);
+      ExternalTypoCorrectionNames[Name.size()].push_back(Name);
+    }
+  }
+
+  // TypoCorrectionConsumer::addName rejects any name whose length differs
+  // from that of the typo by more than a third, so don't bother with those.
+  size_t MaxLengthDelta = Typo.size() / 3;
+  size_t MaxLength = std::min(Typo.size() + MaxLengthDelta + 1,
+                              ExternalTypoCorrectionNames.size());
+  for (size_t Length = Typo.size() - MaxLengthDelta; Length < MaxLength;
+       ++Length)
+    for (StringRef Name : ExternalTypoCorrectionNames[Length])
+      Consumer.FoundName(Name);
+}
+
 std::unique_ptr<TypoCorrectionConsumer> Sema::makeTypoCorrectionConsumer(
     const DeclarationNameInfo &TypoName, Sema::LookupNameKind LookupKind,
     Scope *S, CXXScopeSpec *SS,
@@ -4569,18 +4730,7 @@ std::unique_ptr<TypoCorrectionConsumer> Sema::makeTypoCorrectionConsumer(
       Consumer->FoundName(I.getKey());
 
     // Walk through identifiers in external identifier sources.
-    // FIXME: Re-add the ability to skip very unlikely potential corrections.
-    if (IdentifierInfoLookup *External
-                            = Context.Idents.getExternalIdentifierLookup()) {
-      std::unique_ptr<IdentifierIterator> Iter(External->getIdentifiers());
-      do {
-        StringRef Name = Iter->Next();
-        if (Name.empty())
-          break;
-
-        Consumer->FoundName(Name);
-      } while (true);
-    }
+    addExternalTypoCorrectionNames(*Consumer, Typo->getName());
   }
 
   AddKeywordsToConsumer(*this, *Consumer, S, CCCRef, SS && SS->isNotEmpty());
@@ -6855,6 +6855,10 @@ class BuiltinCandidateTypeSet  {
   /// \brief A flag indicating whether the nullptr type was present in the
   /// candidate set.
   bool HasNullPtrType;
+
+  /// \brief A flag indicating whether a conversion function template was
+  /// skipped, so the set may not cover every type we can convert to.
+  bool HasConversionFunctionTemplates;
   
   /// Sema - The semantic analysis instance where we are building the
   /// candidate type set.
@@ -6875,6 +6879,7 @@ public:
     : HasNonRecordTypes(false),
       HasArithmeticOrEnumeralTypes(false),
       HasNullPtrType(false),
+      HasConversionFunctionTemplates(false),
       SemaRef(SemaRef),
       Context(SemaRef.Context) { }
 
@@ -6908,6 +6913,9 @@ public:
   bool hasNonRecordTypes() { return HasNonRecordTypes; }
   bool hasArithmeticOrEnumeralTypes() { return HasArithmeticOrEnumeralTypes; }
   bool hasNullPtrType() const { return HasNullPtrType; }
+  bool hasConversionFunctionTemplates() const {
+    return HasConversionFunctionTemplates;
+  }
 };
 
 } // end anonymous namespace
@@ -7093,8 +7101,10 @@ BuiltinCandidateTypeSet::AddTypesConvertedFrom(QualType Ty,
 
       // Skip conversion function templates; they don't tell us anything
       // about which builtin types we can convert to.
-      if (isa<FunctionTemplateDecl>(D))
+      if (isa<FunctionTemplateDecl>(D)) {
+        HasConversionFunctionTemplates = true;
         continue;
+      }
 
       CXXConversionDecl *Conv = cast<CXXConversionDecl>(D);
       if (AllowExplicitConversions || !Conv->isExplicit()) {
@@ -7193,6 +7203,7 @@ class BuiltinOperatorOverloadBuilder {
   ArrayRef<Expr *> Args;
   Qualifiers VisibleTypeConversionsQuals;
   bool HasArithmeticOrEnumeralCandidateType;
+  bool AllArgsMayBeArithmeticOrEnumeral;
   SmallVectorImpl<BuiltinCandidateTypeSet> &CandidateTypes;
   OverloadCandidateSet &CandidateSet;
 
@@ -7363,12 +7374,14 @@ public:
     Sema &S, ArrayRef<Expr *> Args,
     Qualifiers VisibleTypeConversionsQuals,
     bool HasArithmeticOrEnumeralCandidateType,
+    bool AllArgsMayBeArithmeticOrEnumeral,
     SmallVectorImpl<BuiltinCandidateTypeSet> &CandidateTypes,
     OverloadCandidateSet &CandidateSet)
     : S(S), Args(Args),
       VisibleTypeConversionsQuals(VisibleTypeConversionsQuals),
       HasArithmeticOrEnumeralCandidateType(
         HasArithmeticOrEnumeralCandidateType),
+      AllArgsMayBeArithmeticOrEnumeral(AllArgsMayBeArithmeticOrEnumeral),
       CandidateTypes(CandidateTypes),
       CandidateSet(CandidateSet) {
     // Validate some of our static helper constants in debug builds.
@@ -7752,6 +7765,7 @@ public:
       return;
 
     for (unsigned Left = FirstPromotedArithmeticType;
+         AllArgsMayBeArithmeticOrEnumeral &&
          Left < LastPromotedArithmeticType; ++Left) {
       for (unsigned Right = FirstPromotedArithmeticType;
            Right < LastPromotedArithmeticType; ++Right) {
@@ -7803,7 +7817,8 @@ public:
   //   where LR is the result of the usual arithmetic conversions
   //   between types L and R.
   void addBinaryBitwiseArithmeticOverloads(OverloadedOperatorKind Op) {
-    if (!HasArithmeticOrEnumeralCandidateType)
+    if (!HasArithmeticOrEnumeralCandidateType ||
+        !AllArgsMayBeArithmeticOrEnumeral)
       return;
 
     for (unsigned Left = FirstPromotedIntegralType;
@@ -7990,7 +8005,9 @@ public:
     if (!HasArithmeticOrEnumeralCandidateType)
       return;
 
-    for (unsigned Left = 0; Left < NumArithmeticTypes; ++Left) {
+    for (unsigned Left = 0;
+         AllArgsMayBeArithmeticOrEnumeral && Left < NumArithmeticTypes;
+         ++Left) {
       for (unsigned Right = FirstPromotedArithmeticType;
            Right < LastPromotedArithmeticType; ++Right) {
         QualType ParamTypes[2];
@@ -8053,7 +8070,8 @@ public:
   //        VQ L&       operator^=(VQ L&, R);
   //        VQ L&       operator|=(VQ L&, R);
   void addAssignmentIntegralOverloads() {
-    if (!HasArithmeticOrEnumeralCandidateType)
+    if (!HasArithmeticOrEnumeralCandidateType ||
+        !AllArgsMayBeArithmeticOrEnumeral)
       return;
 
     for (unsigned Left = FirstIntegralType; Left < LastIntegralType; ++Left) {
@@ -8269,6 +8287,7 @@ void Sema::AddBuiltinOperatorCandidates(OverloadedOperatorKind Op,
 
   bool HasNonRecordCandidateType = false;
   bool HasArithmeticOrEnumeralCandidateType = false;
+  bool AllArgsMayBeArithmeticOrEnumeral = true;
   SmallVector<BuiltinCandidateTypeSet, 2> CandidateTypes;
   for (unsigned ArgIdx = 0, N = Args.size(); ArgIdx != N; ++ArgIdx) {
     CandidateTypes.emplace_back(*this);
@@ -8284,6 +8303,15 @@ void Sema::AddBuiltinOperatorCandidates(OverloadedOperatorKind Op,
     HasArithmeticOrEnumeralCandidateType =
         HasArithmeticOrEnumeralCandidateType ||
         CandidateTypes[ArgIdx].hasArithmeticOrEnumeralTypes();
+
+    // An argument of class type that has no (non-template) conversion to an
+    // arithmetic or enumeration type can't match any built-in candidate whose
+    // parameters are all arithmetic. Remember that, so we don't try to
+    // convert it once for each of the hundreds of such candidates.
+    if (Args[ArgIdx]->getType()->isRecordType() &&
+        !CandidateTypes[ArgIdx].hasArithmeticOrEnumeralTypes() &&
+        !CandidateTypes[ArgIdx].hasConversionFunctionTemplates())
+      AllArgsMayBeArithmeticOrEnumeral = false;
   }
 
   // Exit early when no non-record types have been added to the candidate set
@@ -8299,6 +8327,7 @@ void Sema::AddBuiltinOperatorCandidates(OverloadedOperatorKind Op,
   BuiltinOperatorOverloadBuilder OpBuilder(*this, Args,
                                            VisibleTypeConversionsQuals,
                                            HasArithmeticOrEnumeralCandidateType,
+                                           AllArgsMayBeArithmeticOrEnumeral,
                                            CandidateTypes, CandidateSet);
 
   // Dispatch over the operation to add in only those overloads which apply.
@@ -7187,7 +7187,7 @@ Sema::CheckMemberSpecialization(NamedDecl *Member, LookupResult &Previous) {
       if (InstantiationFunction->isDeleted()) {
         assert(InstantiationFunction->getCanonicalDecl() ==
                InstantiationFunction);
-        InstantiationFunction->setDeletedAsWritten(false);
+        InstantiationFunction->setDeletedAsWritten(false);
       }
     }
 
@@ -8413,6 +8413,15 @@ namespace {
       return T.isNull() || !T->isDependentType();
     }
 
+    /// \brief Determine whether the given expression \p E has already been
+    /// transformed.
+    ///
+    /// An expression that is not instantiation-dependent contains no
+    /// dependent types to rebuild.
+    bool AlreadyTransformedExpr(Expr *E) {
+      return !E->isInstantiationDependent();
+    }
+
     /// \brief Returns the location of the entity whose type is being
     /// rebuilt.
     SourceLocation getBaseLocation() { return Loc; }
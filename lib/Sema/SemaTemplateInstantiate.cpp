@@ -17,7 +17,9 @@
 #include "clang/AST/ASTLambda.h"
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/Expr.h"
+#include "clang/Basic/CompileTimeBudget.h"
 #include "clang/Basic/LangOptions.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Sema/DeclSpec.h"
 #include "clang/Sema/Initialization.h"
 #include "clang/Sema/Lookup.h"
@@ -201,13 +203,16 @@ bool Sema::ActiveTemplateInstantiation::isInstantiationRecord() const {
   llvm_unreachable("Invalid InstantiationKind!");
 }
 
+static void reportCompileTimeBudgetExceeded(Sema &SemaRef);
+
 Sema::InstantiatingTemplate::InstantiatingTemplate(
     Sema &SemaRef, ActiveTemplateInstantiation::InstantiationKind Kind,
     SourceLocation PointOfInstantiation, SourceRange InstantiationRange,
     Decl *Entity, NamedDecl *Template, ArrayRef<TemplateArgument> TemplateArgs,
     sema::TemplateDeductionInfo *DeductionInfo)
     : SemaRef(SemaRef), SavedInNonInstantiationSFINAEContext(
-                            SemaRef.InNonInstantiationSFINAEContext) {
+                            SemaRef.InNonInstantiationSFINAEContext),
+      Traced(false), TracedASTMemory(0) {
   // Don't allow further instantiation if a fatal error has occcured.  Any
   // diagnostics we might have raised will not be visible.
   if (SemaRef.Diags.hasFatalErrorOccurred()) {
@@ -229,7 +234,78 @@ Sema::InstantiatingTemplate::InstantiatingTemplate(
     SemaRef.ActiveTemplateInstantiations.push_back(Inst);
     if (!Inst.isInstantiationRecord())
       ++SemaRef.NonInstantiationEntries;
+    if (TimeTrace::getActive())
+      beginTimeTrace(Inst);
+    if (CompileTimeBudget::isExceeded())
+      reportCompileTimeBudgetExceeded(SemaRef);
+  }
+}
+
+/// \brief Retrieve the name of the time trace event for the given kind of
+/// instantiation.
+static StringRef
+getTimeTraceName(const Sema::ActiveTemplateInstantiation &Inst) {
+  switch (Inst.Kind) {
+  case Sema::ActiveTemplateInstantiation::TemplateInstantiation:
+    if (isa<FunctionDecl>(Inst.Entity))
+      return "InstantiateFunction";
+    if (isa<VarDecl>(Inst.Entity))
+      return "InstantiateVariable";
+    if (isa<TagDecl>(Inst.Entity))
+      return "InstantiateClass";
+    return "InstantiateTemplate";
+  case Sema::ActiveTemplateInstantiation::DefaultTemplateArgumentInstantiation:
+    return "InstantiateDefaultTemplateArgument";
+  case Sema::ActiveTemplateInstantiation::DefaultFunctionArgumentInstantiation:
+    return "InstantiateDefaultArgument";
+  case Sema::ActiveTemplateInstantiation::ExplicitTemplateArgumentSubstitution:
+    return "SubstituteExplicitTemplateArguments";
+  case Sema::ActiveTemplateInstantiation::DeducedTemplateArgumentSubstitution:
+    return "DeduceTemplateArguments";
+  case Sema::ActiveTemplateInstantiation::PriorTemplateArgumentSubstitution:
+    return "SubstitutePriorTemplateArguments";
+  case Sema::ActiveTemplateInstantiation::DefaultTemplateArgumentChecking:
+    return "CheckDefaultTemplateArgument";
+  case Sema::ActiveTemplateInstantiation::ExceptionSpecInstantiation:
+    return "InstantiateExceptionSpec";
+  }
+  llvm_unreachable("Invalid InstantiationKind!");
+}
+
+/// \brief Report the stack of active template instantiations, innermost
+/// first, once the compile-time budget is exceeded.
+static void reportCompileTimeBudgetExceeded(Sema &SemaRef) {
+  CompileTimeBudget::getActive()->reportActivity(
+      "template instantiation", [&](raw_ostream &OS) {
+        const SourceManager &SM = SemaRef.getSourceManager();
+        for (auto I = SemaRef.ActiveTemplateInstantiations.rbegin(),
+                  E = SemaRef.ActiveTemplateInstantiations.rend();
+             I != E; ++I) {
+          OS << "  " << getTimeTraceName(*I);
+          if (NamedDecl *ND = dyn_cast_or_null<NamedDecl>(I->Entity)) {
+            OS << ' ';
+            ND->getNameForDiagnostic(OS, SemaRef.getPrintingPolicy(),
+                                     /*Qualified=*/true);
+          }
+          OS << " at ";
+          I->PointOfInstantiation.print(OS, SM);
+          OS << '\n';
+        }
+      });
+}
+
+void Sema::InstantiatingTemplate::beginTimeTrace(
+    const ActiveTemplateInstantiation &Inst) {
+  std::string Detail;
+  if (NamedDecl *ND = dyn_cast_or_null<NamedDecl>(Inst.Entity)) {
+    llvm::raw_string_ostream OS(Detail);
+    ND->getNameForDiagnostic(OS, SemaRef.getPrintingPolicy(),
+                             /*Qualified=*/true);
   }
+
+  TimeTrace::getActive()->begin(getTimeTraceName(Inst), Detail);
+  Traced = true;
+  TracedASTMemory = SemaRef.Context.getASTAllocatedMemory();
 }
 
 Sema::InstantiatingTemplate::InstantiatingTemplate(
@@ -348,6 +424,16 @@ void Sema::InstantiatingTemplate::Clear() {
     SemaRef.ActiveTemplateInstantiations.pop_back();
     Invalid = true;
   }
+
+  if (Traced) {
+    // The trace may have been deactivated while we were instantiating.
+    if (TimeTrace *Trace = TimeTrace::getActive()) {
+      Trace->addArg("ast-bytes", SemaRef.Context.getASTAllocatedMemory() -
+                                     TracedASTMemory);
+      Trace->end();
+    }
+    Traced = false;
+  }
 }
 
 bool Sema::InstantiatingTemplate::CheckInstantiationDepth(
@@ -1950,6 +2036,7 @@ Sema::InstantiateClass(SourceLocation PointOfInstantiation,
   InstantiatingTemplate Inst(*this, PointOfInstantiation, Instantiation);
   if (Inst.isInvalid())
     return true;
+  ++NumClassInstantiations;
   PrettyDeclStackTraceEntry CrashInfo(*this, Instantiation, SourceLocation(),
                                       "instantiating class definition");
 
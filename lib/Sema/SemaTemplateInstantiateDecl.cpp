@@ -19,6 +19,7 @@
 #include "clang/AST/Expr.h"
 #include "clang/AST/ExprCXX.h"
 #include "clang/AST/TypeLoc.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Sema/Lookup.h"
 #include "clang/Sema/PrettyDeclStackTrace.h"
 #include "clang/Sema/Template.h"
@@ -3604,8 +3605,10 @@ void Sema::InstantiateFunctionDefinition(SourceLocation PointOfInstantiation,
   if (Function->getTemplateSpecializationKind() ==
           TSK_ExplicitInstantiationDeclaration &&
       !PatternDecl->isInlined() &&
-      !PatternDecl->getReturnType()->getContainedAutoType())
+      !PatternDecl->getReturnType()->getContainedAutoType()) {
+    ++NumSuppressedFunctionInstantiations;
     return;
+  }
 
   if (PatternDecl->isInlined()) {
     // Function, and all later redeclarations of it (from imported modules,
@@ -3621,6 +3624,7 @@ void Sema::InstantiateFunctionDefinition(SourceLocation PointOfInstantiation,
   InstantiatingTemplate Inst(*this, PointOfInstantiation, Function);
   if (Inst.isInvalid())
     return;
+  ++NumFunctionInstantiations;
   PrettyDeclStackTraceEntry CrashInfo(*this, Function, SourceLocation(),
                                       "instantiating function definition");
 
@@ -4858,6 +4862,12 @@ NamedDecl *Sema::FindInstantiatedDecl(SourceLocation Loc, NamedDecl *D,
 /// \brief Performs template instantiation for all implicit template
 /// instantiations we have seen until this point.
 void Sema::PerformPendingInstantiations(bool LocalOnly) {
+  if (PendingLocalImplicitInstantiations.empty() &&
+      (LocalOnly || PendingInstantiations.empty()))
+    return;
+
+  TimeTraceScope TraceScope(LocalOnly ? "PerformPendingLocalInstantiations"
+                                      : "PerformPendingInstantiations");
   while (!PendingLocalImplicitInstantiations.empty() ||
          (!LocalOnly && !PendingInstantiations.empty())) {
     PendingImplicitInstantiation Inst;
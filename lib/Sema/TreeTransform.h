@@ -203,6 +203,17 @@ public:
     return T.isNull();
   }
 
+  /// \brief Determine whether the given expression \p E has already been
+  /// transformed.
+  ///
+  /// By default, every expression is transformed. Subclasses that only change
+  /// instantiation-dependent constructs can return true for expressions that
+  /// are not instantiation-dependent, which \c TransformExpr() then returns
+  /// as they are instead of walking them.
+  bool AlreadyTransformedExpr(Expr *E) {
+    return false;
+  }
+
   /// \brief Determine whether the given call argument should be dropped, e.g.,
   /// because it is a default argument.
   ///
@@ -3193,16 +3204,27 @@ ExprResult TreeTransform<Derived>::TransformExpr(Expr *E) {
   if (!E)
     return E;
 
+  ++SemaRef.NumTransformedExprs;
+  if (getDerived().AlreadyTransformedExpr(E)) {
+    ++SemaRef.NumSkippedExprs;
+    return E;
+  }
+
+  ExprResult Result = E;
   switch (E->getStmtClass()) {
     case Stmt::NoStmtClass: break;
 #define STMT(Node, Parent) case Stmt::Node##Class: break;
 #define ABSTRACT_STMT(Stmt)
 #define EXPR(Node, Parent)                                              \
-    case Stmt::Node##Class: return getDerived().Transform##Node(cast<Node>(E));
+    case Stmt::Node##Class:                                             \
+      Result = getDerived().Transform##Node(cast<Node>(E));             \
+      break;
 #include "clang/AST/StmtNodes.inc"
   }
 
-  return E;
+  if (Result.isUsable() && Result.get() != E)
+    ++SemaRef.NumRebuiltExprs;
+  return Result;
 }
 
 template<typename Derived>
@@ -8848,6 +8870,14 @@ TreeTransform<Derived>::TransformInitListExpr(InitListExpr *E) {
                                       E->getRBraceLoc(), E->getType());
 }
 
+template<typename Derived>
+ExprResult
+TreeTransform<Derived>::TransformDataArrayExpr(DataArrayExpr *E) {
+  // Like any other semantic initializer list, a data array is rebuilt from
+  // the list as written.
+  return getDerived().TransformInitListExpr(E->getSyntacticForm());
+}
+
 template<typename Derived>
 ExprResult
 TreeTransform<Derived>::TransformDesignatedInitExpr(DesignatedInitExpr *E) {
@@ -70,6 +70,12 @@ TypeID MakeTypeID(ASTContext &Context, QualType T, IdxForTypeTy IdxForType) {
 
 unsigned ComputeHash(Selector Sel);
 
+/// \brief Compute the hash of the contents of an input file that is stored
+/// in AST files to validate it with -fvalidate-ast-input-files-content.
+///
+/// Never returns zero, which marks a file whose contents were not hashed.
+uint64_t ComputeInputFileHash(StringRef Contents);
+
 /// \brief Retrieve the "definitive" declaration that provides all of the
 /// visible entries for the given declaration context, if there is one.
 ///
@@ -26,6 +26,7 @@
 #include "clang/AST/TypeLocVisitor.h"
 #include "clang/Basic/DiagnosticOptions.h"
 #include "clang/Basic/FileManager.h"
+#include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/SourceManagerInternals.h"
 #include "clang/Basic/TargetInfo.h"
@@ -43,6 +44,7 @@
 #include "clang/Sema/Sema.h"
 #include "clang/Serialization/ASTDeserializationListener.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
+#include "clang/Serialization/ModuleBufferCache.h"
 #include "clang/Serialization/ModuleManager.h"
 #include "clang/Serialization/SerializationDiagnostic.h"
 #include "llvm/ADT/Hashing.h"
@@ -59,6 +61,7 @@
 #include <cstdio>
 #include <iterator>
 #include <system_error>
+#include <thread>
 
 using namespace clang;
 using namespace clang::serialization;
@@ -1788,6 +1791,62 @@ void ASTReader::markIdentifierUpToDate(IdentifierInfo *II) {
     IdentifierGeneration[II] = getGeneration();
 }
 
+bool ASTReader::peekMacroHistory(const PendingMacroInfo &PMInfo,
+                                 bool &IsDefined) {
+  ModuleFile &M = *PMInfo.M;
+  if (M.Kind == MK_ImplicitModule || M.Kind == MK_ExplicitModule)
+    return true;
+
+  BitstreamCursor &Cursor = M.MacroCursor;
+  SavedStreamPosition SavedPosition(Cursor);
+  Cursor.JumpToBit(PMInfo.MacroDirectivesOffset);
+
+  // Module macros would have to be registered with the preprocessor right
+  // away, so only defer histories that consist of directives alone.
+  llvm::BitstreamEntry Entry =
+      Cursor.advance(BitstreamCursor::AF_DontPopBlockAtEnd);
+  if (Entry.Kind != llvm::BitstreamEntry::Record)
+    return true;
+  RecordData Record;
+  if (Cursor.readRecord(Entry.ID, Record) != PP_MACRO_DIRECTIVE_HISTORY)
+    return true;
+
+  // The directives are in reverse source-order; the first one that isn't a
+  // visibility directive decides whether the macro is defined.
+  IsDefined = false;
+  unsigned Idx = 0, N = Record.size();
+  while (Idx < N) {
+    ++Idx; // Skip the location.
+    switch ((MacroDirective::Kind)Record[Idx++]) {
+    case MacroDirective::MD_Define:
+      IsDefined = true;
+      return false;
+    case MacroDirective::MD_Undefine:
+      return false;
+    case MacroDirective::MD_Visibility:
+      ++Idx;
+      break;
+    }
+  }
+  return false;
+}
+
+void ASTReader::loadMacroHistory(IdentifierInfo *II) {
+  auto Pos = LazyMacroIDs.find(II);
+  if (Pos == LazyMacroIDs.end())
+    return;
+
+  SmallVector<PendingMacroInfo, 2> Infos;
+  Infos.swap(Pos->second);
+  LazyMacroIDs.erase(Pos);
+
+  // Reading the macro definitions may pull in new identifiers.
+  Deserializing LoadingMacros(this);
+  ++NumLazyMacroHistoriesLoaded;
+  for (const PendingMacroInfo &Info : Infos)
+    resolvePendingMacro(II, Info);
+}
+
 void ASTReader::resolvePendingMacro(IdentifierInfo *II,
                                     const PendingMacroInfo &PMInfo) {
   ModuleFile &M = *PMInfo.M;
@@ -1920,6 +1979,8 @@ ASTReader::readInputFileInfo(ModuleFile &F, unsigned ID) {
   R.StoredTime = static_cast<time_t>(Record[2]);
   R.Overridden = static_cast<bool>(Record[3]);
   R.Transient = static_cast<bool>(Record[4]);
+  // Older AST files don't have a content hash.
+  R.ContentHash = Record.size() > 6 ? Record[5] | (Record[6] << 32) : 0;
   R.Filename = Blob;
   ResolveImportedPath(F, R.Filename);
   return R;
@@ -2007,11 +2068,24 @@ InputFile ASTReader::getInputFile(ModuleFile &F, unsigned ID, bool Complain) {
 
   bool IsOutOfDate = false;
 
+  // If only the modification time changed, e.g. because the sources were
+  // restored from a cache, the file is still up to date if its contents
+  // match the hash the AST file recorded.
+  auto HasSameContents = [&]() -> bool {
+    if (!FI.ContentHash ||
+        !PP.getHeaderSearchInfo().getHeaderSearchOpts()
+             .ValidateASTInputFilesContent)
+      return false;
+    auto Buffer = FileMgr.getBufferForFile(File);
+    return Buffer &&
+           ComputeInputFileHash((*Buffer)->getBuffer()) == FI.ContentHash;
+  };
+
   // For an overridden file, there is nothing to validate.
   if (!Overridden && //
       (StoredSize != File->getSize() ||
        (StoredTime && StoredTime != File->getModificationTime() &&
-        !DisableValidation)
+        !DisableValidation && !HasSameContents())
        )) {
     if (Complain) {
       // Build a list of the PCH imports that got us here (in reverse).
@@ -2161,6 +2235,11 @@ ASTReader::ASTReadResult ASTReader::ReadOptionsBlock(
   }
 }
 
+/// The number of input files an AST file needs to have before we stat them
+/// concurrently while validating it; below that, starting the threads costs
+/// more than it saves.
+static const unsigned MinInputFilesToPrefetch = 64;
+
 ASTReader::ASTReadResult
 ASTReader::ReadControlBlock(ModuleFile &F,
                             SmallVectorImpl<ImportedModule> &Loaded,
@@ -2207,11 +2286,49 @@ ASTReader::ReadControlBlock(ModuleFile &F,
              F.Kind == MK_ImplicitModule))
           N = NumInputs;
 
-        for (unsigned I = 0; I < N; ++I) {
+        // When validating once per build session, inputs that another reader
+        // in this process validated for the same file need no second look.
+        ModuleBufferCache &BufferCache = ModuleBufferCache::getProcessCache();
+        bool ShareValidation = HSOpts.ModulesValidateOncePerBuildSession &&
+                               F.File && F.Kind != MK_Preamble &&
+                               F.Kind != MK_MainFile;
+        if (ShareValidation &&
+            BufferCache.wereInputsValidated(F.File, *F.Buffer,
+                                            HSOpts.BuildSessionTimestamp, N)) {
+          ++NumInputValidationsShared;
+          N = 0;
+        }
+
+        // Validating the inputs of a large module is dominated by the
+        // latency of stat'ing each of them, so issue those stats
+        // concurrently up front.
+        FileSystemStatCache *Prefetched = nullptr;
+        if (N >= MinInputFilesToPrefetch) {
+          std::vector<std::string> Paths;
+          Paths.reserve(N);
+          for (unsigned I = 0; I < N; ++I) {
+            SmallString<128> Path(readInputFileInfo(F, I+1).Filename);
+            FileMgr.FixupRelativePath(Path);
+            Paths.push_back(Path.str().str());
+          }
+          auto Cache = llvm::make_unique<PrefetchedStatCache>(
+              Paths, *FileMgr.getVirtualFileSystem(),
+              std::thread::hardware_concurrency());
+          Prefetched = Cache.get();
+          FileMgr.addStatCache(std::move(Cache));
+        }
+
+        bool IsOutOfDate = false;
+        for (unsigned I = 0; I < N && !IsOutOfDate; ++I) {
           InputFile IF = getInputFile(F, I+1, Complain);
-          if (!IF.getFile() || IF.isOutOfDate())
-            return OutOfDate;
+          IsOutOfDate = !IF.getFile() || IF.isOutOfDate();
         }
+        FileMgr.removeStatCache(Prefetched);
+        if (IsOutOfDate)
+          return OutOfDate;
+        if (ShareValidation && N)
+          BufferCache.markInputsValidated(F.File, *F.Buffer,
+                                          HSOpts.BuildSessionTimestamp, N);
       }
 
       if (Listener)
@@ -3123,6 +3240,19 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
             ReadSourceLocation(F, Record, I).getRawEncoding());
       }
       break;
+    case SPECIAL_MEMBER_RESULTS:
+      if (Record.size() % 4 != 0) {
+        Error("Invalid SPECIAL_MEMBER_RESULTS block");
+        return Failure;
+      }
+      for (unsigned I = 0, N = Record.size(); I != N; I += 4) {
+        SpecialMemberResults.push_back(getGlobalDeclID(F, Record[I]));
+        SpecialMemberResults.push_back(Record[I + 1]);
+        SpecialMemberResults.push_back(getGlobalDeclID(F, Record[I + 2]));
+        SpecialMemberResults.push_back(Record[I + 3]);
+      }
+      break;
+
     case DELETE_EXPRS_TO_ANALYZE:
       for (unsigned I = 0, N = Record.size(); I != N;) {
         DelayedDeleteExprs.push_back(getGlobalDeclID(F, Record[I++]));
@@ -5136,6 +5266,7 @@ HeaderFileInfo ASTReader::GetHeaderFileInfo(const FileEntry *FE) {
 
 void ASTReader::ReadPragmaDiagnosticMappings(DiagnosticsEngine &Diag) {
   // FIXME: Make it work properly with modules.
+  Diag.invalidateIgnoredEverywhere();
   SmallVector<DiagnosticsEngine::DiagState *, 32> DiagStates;
   for (ModuleIterator I = ModuleMgr.begin(), E = ModuleMgr.end(); I != E; ++I) {
     ModuleFile &F = *(*I);
@@ -6508,6 +6639,8 @@ serialization::DeclID ASTReader::ReadDeclID(ModuleFile &F,
 /// source each time it is called, and is meant to be used via a
 /// LazyOffsetPtr (which is used by Decls for the body of functions, etc).
 Stmt *ASTReader::GetExternalDeclStmt(uint64_t Offset) {
+  ++NumLazyBodiesRead;
+
   // Switch case IDs are per Decl.
   ClearSwitchCaseIDs();
 
@@ -6802,6 +6935,22 @@ void ASTReader::PrintStats() {
     std::fprintf(stderr, "  %u/%u macros read (%f%%)\n",
                  NumMacrosRead, TotalNumMacros,
                  ((float)NumMacrosRead/TotalNumMacros * 100));
+  if (NumLazyMacroHistories)
+    std::fprintf(stderr, "  %u/%u deferred macro histories read (%f%%)\n",
+                 NumLazyMacroHistoriesLoaded, NumLazyMacroHistories,
+                 ((float)NumLazyMacroHistoriesLoaded/NumLazyMacroHistories
+                  * 100));
+  if (NumLazyBodies)
+    std::fprintf(stderr, "  %u/%u function bodies read (%f%%), %u never read\n",
+                 NumLazyBodiesRead, NumLazyBodies,
+                 ((float)NumLazyBodiesRead/NumLazyBodies * 100),
+                 NumLazyBodies - std::min(NumLazyBodiesRead, NumLazyBodies));
+  if (unsigned NumShared = ModuleMgr.getNumSharedBuffers())
+    std::fprintf(stderr, "  %u/%u AST files shared with other readers\n",
+                 NumShared, ModuleMgr.size());
+  if (NumInputValidationsShared)
+    std::fprintf(stderr, "  %u AST files validated by other readers\n",
+                 NumInputValidationsShared);
   if (TotalLexicalDeclContexts)
     std::fprintf(stderr, "  %u/%u lexical declcontexts read (%f%%)\n",
                  NumLexicalDeclContextsRead, TotalLexicalDeclContexts,
@@ -7183,11 +7332,27 @@ void ASTReader::ReadMethodPool(Selector Sel) {
   unsigned PriorGeneration = Generation;
   Generation = getGeneration();
   SelectorOutOfDate[Sel] = false;
-  
+
+  // Sema asks again on every lookup of the selector.  If no module file was
+  // loaded since we last searched, there is nothing new to find, so don't
+  // bother with the global index or visiting the modules.
+  if (PriorGeneration == Generation)
+    return;
+
   // Search for methods defined with this selector.
   ++NumMethodPoolLookups;
   ReadMethodPoolVisitor Visitor(*this, Sel, PriorGeneration);
-  ModuleMgr.visit(Visitor);
+
+  // If there is a global index, look there first to determine which modules
+  // have methods for this selector.
+  GlobalModuleIndex::HitSet Hits;
+  GlobalModuleIndex::HitSet *HitsPtr = nullptr;
+  if (!loadGlobalIndex()) {
+    if (GlobalIndex->lookupSelector(Sel.getAsString(), Hits))
+      HitsPtr = &Hits;
+  }
+
+  ModuleMgr.visit(Visitor, HitsPtr);
 
   if (Visitor.getInstanceMethods().empty() &&
       Visitor.getFactoryMethods().empty())
@@ -7359,6 +7524,23 @@ void ASTReader::ReadUsedVTables(SmallVectorImpl<ExternalVTableUse> &VTables) {
   VTableUses.clear();
 }
 
+void ASTReader::ReadSpecialMemberResults(
+    SmallVectorImpl<ExternalSpecialMemberResult> &Results) {
+  for (unsigned Idx = 0, N = SpecialMemberResults.size(); Idx < N;
+       /* In loop */) {
+    ExternalSpecialMemberResult R;
+    R.Record =
+        cast_or_null<CXXRecordDecl>(GetDecl(SpecialMemberResults[Idx++]));
+    R.Lookup = SpecialMemberResults[Idx++];
+    R.Method =
+        cast_or_null<CXXMethodDecl>(GetDecl(SpecialMemberResults[Idx++]));
+    R.Kind = SpecialMemberResults[Idx++];
+    Results.push_back(R);
+  }
+
+  SpecialMemberResults.clear();
+}
+
 void ASTReader::ReadPendingInstantiations(
        SmallVectorImpl<std::pair<ValueDecl *, SourceLocation> > &Pending) {
   for (unsigned Idx = 0, N = PendingInstantiations.size(); Idx < N;) {
@@ -8346,6 +8528,23 @@ void ASTReader::finishPendingActions() {
       IdentifierInfo *II = PendingMacroIDs.begin()[I].first;
       SmallVector<PendingMacroInfo, 2> GlobalIDs;
       GlobalIDs.swap(PendingMacroIDs.begin()[I].second);
+
+      // If requested, leave the history of a PCH macro in the file until the
+      // preprocessor looks at the macro.
+      bool IsDefined;
+      bool Lazy = PP.getPreprocessorOpts().LazyPCHMacros &&
+                  !PP.getLangOpts().Modules;
+      if (Lazy && GlobalIDs.size() == 1 && !LazyMacroIDs.count(II) &&
+          !peekMacroHistory(GlobalIDs[0], IsDefined)) {
+        ++NumLazyMacroHistories;
+        LazyMacroIDs[II] = std::move(GlobalIDs);
+        PP.setLazyMacroHistory(II, IsDefined);
+        continue;
+      }
+      // Histories from earlier files in the chain go first.
+      if (Lazy)
+        loadMacroHistory(II);
+
       // Initialize the macro history from chained-PCHs ahead of module imports.
       for (unsigned IDIdx = 0, NumIDs = GlobalIDs.size(); IDIdx != NumIDs;
            ++IDIdx) {
@@ -8446,14 +8645,18 @@ void ASTReader::finishPendingActions() {
     if (FunctionDecl *FD = dyn_cast<FunctionDecl>(PB->first)) {
       // FIXME: Check for =delete/=default?
       // FIXME: Complain about ODR violations here?
-      if (!getContext().getLangOpts().Modules || !FD->hasBody())
+      if (!getContext().getLangOpts().Modules || !FD->hasBody()) {
         FD->setLazyBody(PB->second);
+        ++NumLazyBodies;
+      }
       continue;
     }
 
     ObjCMethodDecl *MD = cast<ObjCMethodDecl>(PB->first);
-    if (!getContext().getLangOpts().Modules || !MD->hasBody())
+    if (!getContext().getLangOpts().Modules || !MD->hasBody()) {
       MD->setLazyBody(PB->second);
+      ++NumLazyBodies;
+    }
   }
   PendingBodies.clear();
 
@@ -8711,7 +8914,10 @@ ASTReader::ASTReader(
       ProcessingUpdateRecords(false),
       CurrSwitchCaseStmts(&SwitchCaseStmts), NumSLocEntriesRead(0),
       TotalNumSLocEntries(0), NumStatementsRead(0), TotalNumStatements(0),
-      NumMacrosRead(0), TotalNumMacros(0), NumIdentifierLookups(0),
+      NumMacrosRead(0), TotalNumMacros(0), NumLazyMacroHistories(0),
+      NumLazyMacroHistoriesLoaded(0), NumLazyBodies(0), NumLazyBodiesRead(0),
+      NumInputValidationsShared(0),
+      NumIdentifierLookups(0),
       NumIdentifierLookupHits(0), NumSelectorsRead(0),
       NumMethodPoolEntriesRead(0), NumMethodPoolLookups(0),
       NumMethodPoolHits(0), NumMethodPoolTableLookups(0),
@@ -1514,6 +1514,7 @@ void ASTDeclReader::ReadCXXDefinitionData(
   Reader.ReadUnresolvedSet(F, Data.VisibleConversions, Record, Idx);
   assert(Data.Definition && "Data.Definition should be already set!");
   Data.FirstFriend = ReadDeclID(Record, Idx);
+  Data.ODRHash = Record[Idx++];
 
   if (Data.IsLambda) {
     typedef LambdaCapture Capture;
@@ -1657,6 +1658,11 @@ void ASTDeclReader::MergeDefinitionData(
 
   if (DetectedOdrViolation)
     Reader.PendingOdrMergeFailures[DD.Definition].push_back(MergeDD.Definition);
+  else if (DD.ODRHash && DD.ODRHash == MergeDD.ODRHash &&
+           DD.Definition != MergeDD.Definition)
+    // Both definitions declare the same members, so there's no need to look
+    // for the members of the merged definition in the canonical one.
+    Reader.OdrHashMatchedDefinitions.insert(MergeDD.Definition);
 }
 
 void ASTDeclReader::ReadCXXRecordDefinition(CXXRecordDecl *D, bool Update) {
@@ -3000,7 +3006,8 @@ ASTDeclReader::FindExistingResult ASTDeclReader::findExisting(NamedDecl *D) {
   // same template specialization into the same CXXRecordDecl.
   auto MergedDCIt = Reader.MergedDeclContexts.find(D->getLexicalDeclContext());
   if (MergedDCIt != Reader.MergedDeclContexts.end() &&
-      MergedDCIt->second == D->getDeclContext())
+      MergedDCIt->second == D->getDeclContext() &&
+      !Reader.OdrHashMatchedDefinitions.count(MergedDCIt->first))
     Reader.PendingOdrMergeChecks.push_back(D);
 
   return FindExistingResult(Reader, D, /*Existing=*/nullptr,
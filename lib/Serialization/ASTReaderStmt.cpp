@@ -845,6 +845,16 @@ void ASTStmtReader::VisitNoInitExpr(NoInitExpr *E) {
   VisitExpr(E);
 }
 
+void ASTStmtReader::VisitDataArrayExpr(DataArrayExpr *E) {
+  VisitExpr(E);
+  unsigned NumInits = Record[Idx++];
+  assert(NumInits == E->getNumInits() && "Wrong number of elements");
+  ++Idx; // The element size was used to allocate the node.
+  E->setSyntacticForm(cast<InitListExpr>(Reader.ReadSubExpr()));
+  for (unsigned I = 0; I != NumInits; ++I)
+    E->setElementValue(I, Record[Idx++]);
+}
+
 void ASTStmtReader::VisitImplicitValueInitExpr(ImplicitValueInitExpr *E) {
   VisitExpr(E);
 }
@@ -3118,6 +3128,12 @@ Stmt *ASTReader::ReadStmtFromStream(ModuleFile &F) {
       S = new (Context) NoInitExpr(Empty);
       break;
 
+    case EXPR_DATA_ARRAY:
+      S = DataArrayExpr::CreateEmpty(Context,
+                                     Record[ASTStmtReader::NumExprFields],
+                                     Record[ASTStmtReader::NumExprFields + 1]);
+      break;
+
     case EXPR_VA_ARG:
       S = new (Context) VAArgExpr(Empty);
       break;
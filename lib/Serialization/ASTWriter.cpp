@@ -981,8 +981,10 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(OPTIMIZE_PRAGMA_OPTIONS);
   RECORD(MSSTRUCT_PRAGMA_OPTIONS);
   RECORD(POINTERS_TO_MEMBERS_PRAGMA_OPTIONS);
+  RECORD(METHOD_POOL_SELECTORS);
   RECORD(UNUSED_LOCAL_TYPEDEF_NAME_CANDIDATES);
   RECORD(DELETE_EXPRS_TO_ANALYZE);
+  RECORD(SPECIAL_MEMBER_RESULTS);
 
   // SourceManager Block.
   BLOCK(SOURCE_MANAGER_BLOCK);
@@ -1540,6 +1542,7 @@ namespace  {
     bool IsSystemFile;
     bool IsTransient;
     bool BufferOverridden;
+    uint64_t ContentHash;
   };
 } // end anonymous namespace
 
@@ -1557,6 +1560,8 @@ void ASTWriter::WriteInputFiles(SourceManager &SourceMgr,
   IFAbbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 32)); // Modification time
   IFAbbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 1)); // Overridden
   IFAbbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 1)); // Transient
+  IFAbbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32)); // Hash (low)
+  IFAbbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32)); // Hash (high)
   IFAbbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob)); // File name
   unsigned IFAbbrevCode = Stream.EmitAbbrev(IFAbbrev);
 
@@ -1580,6 +1585,14 @@ void ASTWriter::WriteInputFiles(SourceManager &SourceMgr,
     Entry.IsSystemFile = Cache->IsSystemFile;
     Entry.IsTransient = Cache->IsTransient;
     Entry.BufferOverridden = Cache->BufferOverridden;
+    Entry.ContentHash = 0;
+    if (HSOpts.ValidateASTInputFilesContent && !Entry.BufferOverridden) {
+      bool Invalid = false;
+      llvm::MemoryBuffer *Buffer = Cache->getBuffer(
+          SourceMgr.getDiagnostics(), SourceMgr, SourceLocation(), &Invalid);
+      if (Buffer && !Invalid)
+        Entry.ContentHash = ComputeInputFileHash(Buffer->getBuffer());
+    }
     if (Cache->IsSystemFile)
       SortedFiles.push_back(Entry);
     else
@@ -1610,7 +1623,9 @@ void ASTWriter::WriteInputFiles(SourceManager &SourceMgr,
         (uint64_t)Entry.File->getSize(),
         (uint64_t)getTimestampForOutput(Entry.File),
         Entry.BufferOverridden,
-        Entry.IsTransient};
+        Entry.IsTransient,
+        uint32_t(Entry.ContentHash),
+        uint32_t(Entry.ContentHash >> 32)};
 
     EmitRecordWithPath(IFAbbrevCode, Record, Entry.File->getName());
   }
@@ -2983,6 +2998,11 @@ void ASTWriter::WriteSelectors(Sema &SemaRef) {
     llvm::OnDiskChainedHashTableGenerator<ASTMethodPoolTrait> Generator;
     ASTMethodPoolTrait Trait(*this);
 
+    // The spellings of the selectors in the table, NUL-separated, so that the
+    // global module index can tell which module files to search for a
+    // selector without decoding this module's identifier IDs.
+    SmallString<4096> SelectorNames;
+
     // Create the on-disk hash table representation. We walk through every
     // selector we've seen and look it up in the method pool.
     SelectorOffsets.resize(NextSelectorID - FirstSelectorID);
@@ -3021,6 +3041,10 @@ void ASTWriter::WriteSelectors(Sema &SemaRef) {
         ++NumTableEntries;
       }
       Generator.insert(S, Data, Trait);
+      if (WritingModule) {
+        SelectorNames += S.getAsString();
+        SelectorNames.push_back('\0');
+      }
     }
 
     // Create the on-disk hash table in a buffer.
@@ -3050,6 +3074,17 @@ void ASTWriter::WriteSelectors(Sema &SemaRef) {
       Stream.EmitRecordWithBlob(MethodPoolAbbrev, Record, MethodPool);
     }
 
+    // Write the selector spellings for the global module index.
+    if (WritingModule) {
+      Abbrev = new BitCodeAbbrev();
+      Abbrev->Add(BitCodeAbbrevOp(METHOD_POOL_SELECTORS));
+      Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+      unsigned SelectorNamesAbbrev = Stream.EmitAbbrev(Abbrev);
+
+      RecordData::value_type Record[] = {METHOD_POOL_SELECTORS};
+      Stream.EmitRecordWithBlob(SelectorNamesAbbrev, Record, SelectorNames);
+    }
+
     // Create a blob abbreviation for the selector table offsets.
     Abbrev = new BitCodeAbbrev();
     Abbrev->Add(BitCodeAbbrevOp(SELECTOR_OFFSETS));
@@ -4253,6 +4288,18 @@ uint64_t ASTWriter::WriteASTCore(Sema &SemaRef, StringRef isysroot,
   assert(SemaRef.PendingLocalImplicitInstantiations.empty() &&
          "There are local ones at end of translation unit!");
 
+  // Build a record containing the results of special member lookups, so that
+  // they don't have to be computed again.
+  RecordData SpecialMemberResults;
+  for (const auto *R : SemaRef.LocalSpecialMemberResults) {
+    if (R->getRecord()->isInvalidDecl())
+      continue;
+    AddDeclRef(R->getRecord(), SpecialMemberResults);
+    SpecialMemberResults.push_back(R->getLookup());
+    AddDeclRef(R->getMethod(), SpecialMemberResults);
+    SpecialMemberResults.push_back(R->getKind());
+  }
+
   // Build a record containing some declaration references.
   RecordData SemaDeclRefs;
   if (SemaRef.StdNamespace || SemaRef.StdBadAlloc) {
@@ -4575,6 +4622,9 @@ uint64_t ASTWriter::WriteASTCore(Sema &SemaRef, StringRef isysroot,
   if (!DeleteExprsToAnalyze.empty())
     Stream.EmitRecord(DELETE_EXPRS_TO_ANALYZE, DeleteExprsToAnalyze);
 
+  if (!SpecialMemberResults.empty())
+    Stream.EmitRecord(SPECIAL_MEMBER_RESULTS, SpecialMemberResults);
+
   // Write the visible updates to DeclContexts.
   for (auto *DC : UpdatedDeclContexts)
     WriteDeclContextVisibleUpdate(DC);
@@ -5529,6 +5579,8 @@ void ASTRecordWriter::AddCXXDefinitionData(const CXXRecordDecl *D) {
   AddUnresolvedSet(Data.VisibleConversions.get(*Writer->Context));
   // Data.Definition is the owning decl, no need to write it. 
   AddDeclRef(D->getFirstFriend());
+  // Only definitions in modules can be merged with other definitions.
+  Record->push_back(Writer->WritingModule ? D->computeODRHash() : 0);
   
   // Add lambda-specific data.
   if (Data.IsLambda) {
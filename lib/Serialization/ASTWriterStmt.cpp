@@ -792,6 +792,16 @@ void ASTStmtWriter::VisitNoInitExpr(NoInitExpr *E) {
   Code = serialization::EXPR_NO_INIT;
 }
 
+void ASTStmtWriter::VisitDataArrayExpr(DataArrayExpr *E) {
+  VisitExpr(E);
+  Record.push_back(E->getNumInits());
+  Record.push_back(E->getElementSize());
+  Record.AddStmt(E->getSyntacticForm());
+  for (unsigned I = 0, N = E->getNumInits(); I != N; ++I)
+    Record.push_back(E->getElementValue(I));
+  Code = serialization::EXPR_DATA_ARRAY;
+}
+
 void ASTStmtWriter::VisitImplicitValueInitExpr(ImplicitValueInitExpr *E) {
   VisitExpr(E);
   Code = serialization::EXPR_IMPLICIT_VALUE_INIT;
@@ -50,7 +50,9 @@ namespace {
     /// \brief Describes a module, including its file name and dependencies.
     MODULE,
     /// \brief The index for identifiers.
-    IDENTIFIER_INDEX
+    IDENTIFIER_INDEX,
+    /// \brief The index for Objective-C selectors.
+    SELECTOR_INDEX
   };
 }
 
@@ -125,8 +127,9 @@ typedef llvm::OnDiskIterableChainedHashTable<IdentifierIndexReaderTrait>
 
 GlobalModuleIndex::GlobalModuleIndex(std::unique_ptr<llvm::MemoryBuffer> Buffer,
                                      llvm::BitstreamCursor Cursor)
-    : Buffer(std::move(Buffer)), IdentifierIndex(), NumIdentifierLookups(),
-      NumIdentifierLookupHits() {
+    : Buffer(std::move(Buffer)), IdentifierIndex(), SelectorIndex(),
+      NumIdentifierLookups(), NumIdentifierLookupHits(), NumSelectorLookups(),
+      NumSelectorLookupHits() {
   // Read the global index.
   bool InGlobalIndexBlock = false;
   bool Done = false;
@@ -224,12 +227,24 @@ GlobalModuleIndex::GlobalModuleIndex(std::unique_ptr<llvm::MemoryBuffer> Buffer,
             (const unsigned char *)Blob.data(), IdentifierIndexReaderTrait());
       }
       break;
+
+    case SELECTOR_INDEX:
+      // Wire up the selector index. Selectors are keyed by their spelling,
+      // so they share the identifier index's on-disk representation.
+      if (Record[0]) {
+        SelectorIndex = IdentifierIndexTable::Create(
+            (const unsigned char *)Blob.data() + Record[0],
+            (const unsigned char *)Blob.data() + sizeof(uint32_t),
+            (const unsigned char *)Blob.data(), IdentifierIndexReaderTrait());
+      }
+      break;
     }
   }
 }
 
 GlobalModuleIndex::~GlobalModuleIndex() {
   delete static_cast<IdentifierIndexTable *>(IdentifierIndex);
+  delete static_cast<IdentifierIndexTable *>(SelectorIndex);
 }
 
 std::pair<GlobalModuleIndex *, GlobalModuleIndex::ErrorCode>
@@ -317,6 +332,32 @@ bool GlobalModuleIndex::lookupIdentifier(StringRef Name, HitSet &Hits) {
   return true;
 }
 
+bool GlobalModuleIndex::lookupSelector(StringRef Name, HitSet &Hits) {
+  Hits.clear();
+
+  // If there's no selector index, there is nothing we can do.
+  if (!SelectorIndex)
+    return false;
+
+  // Look into the selector index.
+  ++NumSelectorLookups;
+  IdentifierIndexTable &Table
+    = *static_cast<IdentifierIndexTable *>(SelectorIndex);
+  IdentifierIndexTable::iterator Known = Table.find(Name);
+  if (Known == Table.end()) {
+    return true;
+  }
+
+  SmallVector<unsigned, 2> ModuleIDs = *Known;
+  for (unsigned I = 0, N = ModuleIDs.size(); I != N; ++I) {
+    if (ModuleFile *MF = Modules[ModuleIDs[I]].File)
+      Hits.insert(MF);
+  }
+
+  ++NumSelectorLookupHits;
+  return true;
+}
+
 bool GlobalModuleIndex::loadedModuleFile(ModuleFile *File) {
   // Look for the module in the global module index based on the module name.
   StringRef Name = File->ModuleName;
@@ -351,6 +392,11 @@ void GlobalModuleIndex::printStats() {
             NumIdentifierLookupHits, NumIdentifierLookups,
             (double)NumIdentifierLookupHits*100.0/NumIdentifierLookups);
   }
+  if (NumSelectorLookups) {
+    fprintf(stderr, "  %u / %u selector lookups succeeded (%f%%)\n",
+            NumSelectorLookupHits, NumSelectorLookups,
+            (double)NumSelectorLookupHits*100.0/NumSelectorLookups);
+  }
   std::fprintf(stderr, "\n");
 }
 
@@ -400,10 +446,23 @@ namespace {
     /// \brief A mapping from all interesting identifiers to the set of module
     /// files in which those identifiers are considered interesting.
     InterestingIdentifierMap InterestingIdentifiers;
+
+    /// \brief A mapping from the spelling of each selector to the set of
+    /// module files whose method pool has an entry for that selector.
+    InterestingIdentifierMap InterestingSelectors;
+
+    /// \brief Whether some module file has a method pool but does not
+    /// describe its selectors, in which case no selector index is written.
+    bool SelectorIndexIncomplete;
     
     /// \brief Write the block-info block for the global module index file.
     void emitBlockInfoBlock(llvm::BitstreamWriter &Stream);
 
+    /// \brief Write an on-disk hash table mapping each of the given names
+    /// to the module files that contain information about it.
+    void emitNameIndex(llvm::BitstreamWriter &Stream, unsigned Code,
+                       const InterestingIdentifierMap &Names);
+
     /// \brief Retrieve the module file information for the given file.
     ModuleFileInfo &getModuleFileInfo(const FileEntry *File) {
       llvm::MapVector<const FileEntry *, ModuleFileInfo>::iterator Known
@@ -420,13 +479,33 @@ namespace {
   public:
     explicit GlobalModuleIndexBuilder(
         FileManager &FileMgr, const PCHContainerReader &PCHContainerRdr)
-        : FileMgr(FileMgr), PCHContainerRdr(PCHContainerRdr) {}
+        : FileMgr(FileMgr), PCHContainerRdr(PCHContainerRdr),
+          SelectorIndexIncomplete(false) {}
 
     /// \brief Load the contents of the given module file into the builder.
     ///
     /// \returns true if an error occurred, false otherwise.
     bool loadModuleFile(const FileEntry *File);
 
+    /// \brief Record a module file described by an existing index, instead of
+    /// loading it again.
+    void addIndexedModuleFile(const FileEntry *File,
+                              ArrayRef<const FileEntry *> Dependencies);
+
+    /// \brief Record the names that an existing index maps to its module
+    /// files.
+    ///
+    /// \param Table The identifier or selector index of the existing index,
+    /// or null if it has none.
+    ///
+    /// \param Files The module file of each ID in the existing index.
+    ///
+    /// \param IsSelectorIndex Whether \p Table maps selectors rather than
+    /// identifiers.
+    void addIndexedNames(IdentifierIndexTable *Table,
+                         ArrayRef<const FileEntry *> Files,
+                         bool IsSelectorIndex);
+
     /// \brief Write the index to the given bitstream.
     void writeIndex(llvm::BitstreamWriter &Stream);
   };
@@ -468,6 +547,7 @@ GlobalModuleIndexBuilder::emitBlockInfoBlock(llvm::BitstreamWriter &Stream) {
   RECORD(INDEX_METADATA);
   RECORD(MODULE);
   RECORD(IDENTIFIER_INDEX);
+  RECORD(SELECTOR_INDEX);
 #undef RECORD
 #undef BLOCK
 
@@ -522,6 +602,7 @@ bool GlobalModuleIndexBuilder::loadModuleFile(const FileEntry *File) {
 
   // Search for the blocks and records we care about.
   enum { Other, ControlBlock, ASTBlock } State = Other;
+  bool HasMethodPool = false, HasMethodPoolSelectors = false;
   bool Done = false;
   while (!Done) {
     llvm::BitstreamEntry Entry = InStream.advance();
@@ -638,12 +719,62 @@ bool GlobalModuleIndexBuilder::loadModuleFile(const FileEntry *File) {
       }
     }
 
+    // Handle the selectors in the method pool.
+    if (State == ASTBlock && Code == METHOD_POOL)
+      HasMethodPool = true;
+
+    if (State == ASTBlock && Code == METHOD_POOL_SELECTORS) {
+      HasMethodPoolSelectors = true;
+      while (!Blob.empty()) {
+        std::pair<StringRef, StringRef> Split = Blob.split('\0');
+        InterestingSelectors[Split.first].push_back(ID);
+        Blob = Split.second;
+      }
+    }
+
     // We don't care about this record.
   }
 
+  // A module file written before selectors were recorded could have entries
+  // for any selector, so we cannot restrict selector lookups at all.
+  if (HasMethodPool && !HasMethodPoolSelectors)
+    SelectorIndexIncomplete = true;
+
   return false;
 }
 
+void GlobalModuleIndexBuilder::addIndexedModuleFile(
+    const FileEntry *File, ArrayRef<const FileEntry *> Dependencies) {
+  getModuleFileInfo(File);
+  for (const FileEntry *DependsOnFile : Dependencies) {
+    unsigned DependsOnID = getModuleFileInfo(DependsOnFile).ID;
+    getModuleFileInfo(File).Dependencies.push_back(DependsOnID);
+  }
+}
+
+void GlobalModuleIndexBuilder::addIndexedNames(
+    IdentifierIndexTable *Table, ArrayRef<const FileEntry *> Files,
+    bool IsSelectorIndex) {
+  if (!Table) {
+    // Without a selector index, some of the module files could have entries
+    // for any selector.
+    if (IsSelectorIndex)
+      SelectorIndexIncomplete = true;
+    return;
+  }
+
+  InterestingIdentifierMap &Names =
+      IsSelectorIndex ? InterestingSelectors : InterestingIdentifiers;
+  IdentifierIndexTable::key_iterator Key = Table->key_begin();
+  for (IdentifierIndexTable::data_iterator D = Table->data_begin(),
+                                           DEnd = Table->data_end();
+       D != DEnd; ++D, ++Key) {
+    SmallVector<unsigned, 2> &IDs = Names[*Key];
+    for (unsigned OldID : *D)
+      IDs.push_back(getModuleFileInfo(Files[OldID]).ID);
+  }
+}
+
 namespace {
 
 /// \brief Trait used to generate the identifier index as an on-disk hash
@@ -686,6 +817,44 @@ public:
 
 }
 
+void GlobalModuleIndexBuilder::emitNameIndex(
+    llvm::BitstreamWriter &Stream, unsigned Code,
+    const InterestingIdentifierMap &Names) {
+  using namespace llvm;
+
+  OnDiskChainedHashTableGenerator<IdentifierIndexWriterTrait> Generator;
+  IdentifierIndexWriterTrait Trait;
+
+  // Populate the hash table.
+  for (InterestingIdentifierMap::const_iterator I = Names.begin(),
+                                                IEnd = Names.end();
+       I != IEnd; ++I) {
+    Generator.insert(I->first(), I->second, Trait);
+  }
+
+  // Create the on-disk hash table in a buffer.
+  SmallString<4096> Table;
+  uint32_t BucketOffset;
+  {
+    using namespace llvm::support;
+    raw_svector_ostream Out(Table);
+    // Make sure that no bucket is at offset 0
+    endian::Writer<little>(Out).write<uint32_t>(0);
+    BucketOffset = Generator.Emit(Out, Trait);
+  }
+
+  // Create a blob abbreviation
+  BitCodeAbbrev *Abbrev = new BitCodeAbbrev();
+  Abbrev->Add(BitCodeAbbrevOp(Code));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+  unsigned TableAbbrev = Stream.EmitAbbrev(Abbrev);
+
+  // Write the table
+  uint64_t Record[] = {Code, BucketOffset};
+  Stream.EmitRecordWithBlob(TableAbbrev, Record, Table);
+}
+
 void GlobalModuleIndexBuilder::writeIndex(llvm::BitstreamWriter &Stream) {
   using namespace llvm;
   
@@ -727,39 +896,11 @@ void GlobalModuleIndexBuilder::writeIndex(llvm::BitstreamWriter &Stream) {
   }
 
   // Write the identifier -> module file mapping.
-  {
-    llvm::OnDiskChainedHashTableGenerator<IdentifierIndexWriterTrait> Generator;
-    IdentifierIndexWriterTrait Trait;
-
-    // Populate the hash table.
-    for (InterestingIdentifierMap::iterator I = InterestingIdentifiers.begin(),
-                                            IEnd = InterestingIdentifiers.end();
-         I != IEnd; ++I) {
-      Generator.insert(I->first(), I->second, Trait);
-    }
-    
-    // Create the on-disk hash table in a buffer.
-    SmallString<4096> IdentifierTable;
-    uint32_t BucketOffset;
-    {
-      using namespace llvm::support;
-      llvm::raw_svector_ostream Out(IdentifierTable);
-      // Make sure that no bucket is at offset 0
-      endian::Writer<little>(Out).write<uint32_t>(0);
-      BucketOffset = Generator.Emit(Out, Trait);
-    }
-
-    // Create a blob abbreviation
-    BitCodeAbbrev *Abbrev = new BitCodeAbbrev();
-    Abbrev->Add(BitCodeAbbrevOp(IDENTIFIER_INDEX));
-    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32));
-    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
-    unsigned IDTableAbbrev = Stream.EmitAbbrev(Abbrev);
+  emitNameIndex(Stream, IDENTIFIER_INDEX, InterestingIdentifiers);
 
-    // Write the identifier table
-    uint64_t Record[] = {IDENTIFIER_INDEX, BucketOffset};
-    Stream.EmitRecordWithBlob(IDTableAbbrev, Record, IdentifierTable);
-  }
+  // Write the selector -> module file mapping.
+  if (!SelectorIndexIncomplete)
+    emitNameIndex(Stream, SELECTOR_INDEX, InterestingSelectors);
 
   Stream.ExitBlock();
 }
@@ -792,7 +933,20 @@ GlobalModuleIndex::writeIndex(FileManager &FileMgr,
   // The module index builder.
   GlobalModuleIndexBuilder Builder(FileMgr, PCHContainerRdr);
 
-  // Load each of the module files.
+  // The module files described by the existing index, by file name.
+  std::unique_ptr<GlobalModuleIndex> ExistingIndex(readIndex(Path).first);
+  llvm::StringMap<unsigned> ExistingModules;
+  if (ExistingIndex && ExistingIndex->IdentifierIndex) {
+    for (unsigned I = 0, N = ExistingIndex->Modules.size(); I != N; ++I)
+      if (!ExistingIndex->Modules[I].FileName.empty())
+        ExistingModules[ExistingIndex->Modules[I].FileName] = I;
+  }
+  SmallVector<const FileEntry *, 16> ExistingFiles(
+      ExistingIndex ? ExistingIndex->Modules.size() : 0);
+  unsigned NumUnchangedFiles = 0;
+
+  // Find the module files that changed since the existing index was written.
+  SmallVector<const FileEntry *, 16> ChangedFiles;
   std::error_code EC;
   for (llvm::sys::fs::directory_iterator D(Path, EC), DEnd;
        D != DEnd && !EC;
@@ -813,10 +967,51 @@ GlobalModuleIndex::writeIndex(FileManager &FileMgr,
     if (!ModuleFile)
       continue;
 
-    // Load this module file.
+    llvm::StringMap<unsigned>::iterator Known =
+        ExistingModules.find(ModuleFile->getName());
+    if (Known != ExistingModules.end()) {
+      const ModuleInfo &Info = ExistingIndex->Modules[Known->second];
+      if (ModuleFile->getSize() == Info.Size &&
+          ModuleFile->getModificationTime() == Info.ModTime) {
+        ExistingFiles[Known->second] = ModuleFile;
+        ++NumUnchangedFiles;
+        continue;
+      }
+    }
+
+    ChangedFiles.push_back(ModuleFile);
+  }
+
+  // When module files were only added, merge them into the existing index.
+  // If any module file it describes changed or went away, the other ones
+  // may be stale as well, so load all of them again.
+  if (NumUnchangedFiles == ExistingModules.size()) {
+    for (unsigned I = 0, N = ExistingFiles.size(); I != N; ++I) {
+      if (!ExistingFiles[I])
+        continue;
+      SmallVector<const FileEntry *, 4> Dependencies;
+      for (unsigned DependsOnID : ExistingIndex->Modules[I].Dependencies)
+        Dependencies.push_back(ExistingFiles[DependsOnID]);
+      Builder.addIndexedModuleFile(ExistingFiles[I], Dependencies);
+    }
+    if (!ExistingModules.empty()) {
+      Builder.addIndexedNames(
+          static_cast<IdentifierIndexTable *>(ExistingIndex->IdentifierIndex),
+          ExistingFiles, /*IsSelectorIndex=*/false);
+      Builder.addIndexedNames(
+          static_cast<IdentifierIndexTable *>(ExistingIndex->SelectorIndex),
+          ExistingFiles, /*IsSelectorIndex=*/true);
+    }
+  } else {
+    for (const FileEntry *ModuleFile : ExistingFiles)
+      if (ModuleFile)
+        ChangedFiles.push_back(ModuleFile);
+  }
+
+  // Load each of the module files that the existing index does not describe.
+  for (const FileEntry *ModuleFile : ChangedFiles)
     if (Builder.loadModuleFile(ModuleFile))
       return EC_IOError;
-  }
 
   // The output buffer, into which the global index will be written.
   SmallVector<char, 16> OutputBuffer;
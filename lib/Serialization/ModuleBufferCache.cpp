@@ -0,0 +1,120 @@
+//===--- ModuleBufferCache.cpp - Process-wide AST file cache ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the ModuleBufferCache class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Serialization/ModuleBufferCache.h"
+#include "clang/Basic/FileManager.h"
+#include "llvm/Support/ManagedStatic.h"
+
+using namespace clang;
+using namespace serialization;
+
+namespace {
+/// \brief A view of a cached buffer that keeps it alive for as long as the
+/// reader holds on to it.
+class SharedModuleBuffer : public llvm::MemoryBuffer {
+  std::shared_ptr<llvm::MemoryBuffer> Buffer;
+
+public:
+  explicit SharedModuleBuffer(std::shared_ptr<llvm::MemoryBuffer> Buffer)
+      : Buffer(std::move(Buffer)) {
+    const llvm::MemoryBuffer &B = *this->Buffer;
+    init(B.getBufferStart(), B.getBufferEnd(),
+         /*RequiresNullTerminator=*/false);
+  }
+
+  const char *getBufferIdentifier() const override {
+    return Buffer->getBufferIdentifier();
+  }
+
+  BufferKind getBufferKind() const override { return Buffer->getBufferKind(); }
+};
+} // end anonymous namespace
+
+static llvm::ManagedStatic<ModuleBufferCache> ProcessCache;
+
+ModuleBufferCache &ModuleBufferCache::getProcessCache() {
+  return *ProcessCache;
+}
+
+const ModuleBufferCache::Entry *
+ModuleBufferCache::lookupLocked(const FileEntry *File) const {
+  auto I = Entries.find(File->getName());
+  if (I == Entries.end())
+    return nullptr;
+  const Entry &E = I->second;
+  if (E.UniqueID != File->getUniqueID() || E.Size != File->getSize() ||
+      E.ModTime != File->getModificationTime())
+    return nullptr;
+  return &E;
+}
+
+std::unique_ptr<llvm::MemoryBuffer>
+ModuleBufferCache::lookup(const FileEntry *File) const {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  if (const Entry *E = lookupLocked(File))
+    return llvm::make_unique<SharedModuleBuffer>(E->Buffer);
+  return nullptr;
+}
+
+std::unique_ptr<llvm::MemoryBuffer>
+ModuleBufferCache::insert(const FileEntry *File,
+                          std::unique_ptr<llvm::MemoryBuffer> Buffer) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  // Another reader may have read the same file in the meantime; share its
+  // buffer and validation state instead.
+  if (const Entry *E = lookupLocked(File))
+    return llvm::make_unique<SharedModuleBuffer>(E->Buffer);
+
+  Entry &E = Entries[File->getName()];
+  E = Entry();
+  E.UniqueID = File->getUniqueID();
+  E.Size = File->getSize();
+  E.ModTime = File->getModificationTime();
+  E.Buffer = std::move(Buffer);
+  return llvm::make_unique<SharedModuleBuffer>(E.Buffer);
+}
+
+bool ModuleBufferCache::wereInputsValidated(const FileEntry *File,
+                                            const llvm::MemoryBuffer &Buffer,
+                                            uint64_t Session,
+                                            unsigned NumInputs) const {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  const Entry *E = lookupLocked(File);
+  return E && E->Buffer->getBufferStart() == Buffer.getBufferStart() &&
+         E->ValidatedSession == Session && E->NumValidatedInputs >= NumInputs;
+}
+
+void ModuleBufferCache::markInputsValidated(const FileEntry *File,
+                                            const llvm::MemoryBuffer &Buffer,
+                                            uint64_t Session,
+                                            unsigned NumInputs) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Entry *E = const_cast<Entry *>(lookupLocked(File));
+  if (!E || E->Buffer->getBufferStart() != Buffer.getBufferStart())
+    return;
+  if (E->ValidatedSession != Session) {
+    E->ValidatedSession = Session;
+    E->NumValidatedInputs = 0;
+  }
+  E->NumValidatedInputs = std::max(E->NumValidatedInputs, NumInputs);
+}
+
+void ModuleBufferCache::clear() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Entries.clear();
+}
+
+unsigned ModuleBufferCache::size() const {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return Entries.size();
+}
@@ -15,6 +15,7 @@
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/ModuleMap.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
+#include "clang/Serialization/ModuleBufferCache.h"
 #include "clang/Serialization/ModuleManager.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
@@ -120,8 +121,17 @@ ModuleManager::addModule(StringRef FileName, ModuleKind Type,
       // Open the AST file.
       llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buf(
           (std::error_code()));
+      // Preambles are owned by the ASTUnit that built them, so only share
+      // module and PCH files with the other readers in this process.
+      bool Shared = Type == MK_ImplicitModule || Type == MK_ExplicitModule ||
+                    Type == MK_PCH;
+      ModuleBufferCache &BufferCache = ModuleBufferCache::getProcessCache();
       if (FileName == "-") {
         Buf = llvm::MemoryBuffer::getSTDIN();
+      } else if (std::unique_ptr<llvm::MemoryBuffer> Cached =
+                     Shared ? BufferCache.lookup(New->File) : nullptr) {
+        Buf = std::move(Cached);
+        ++NumSharedBuffers;
       } else {
         // Leave the FileEntry open so if it gets read again by another
         // ModuleManager it must be the same underlying file.
@@ -130,6 +140,8 @@ ModuleManager::addModule(StringRef FileName, ModuleKind Type,
         Buf = FileMgr.getBufferForFile(New->File,
                                        /*IsVolatile=*/false,
                                        /*ShouldClose=*/false);
+        if (Buf && Shared)
+          Buf = BufferCache.insert(New->File, std::move(*Buf));
       }
 
       if (!Buf) {
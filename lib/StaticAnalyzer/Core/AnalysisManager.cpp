@@ -8,12 +8,17 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
+#include "clang/StaticAnalyzer/Core/CrossTUDefinitionSource.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Timer.h"
 
 using namespace clang;
 using namespace ento;
 
 void AnalysisManager::anchor() { }
 
+CrossTUDefinitionSource::~CrossTUDefinitionSource() { }
+
 AnalysisManager::AnalysisManager(ASTContext &ctx, DiagnosticsEngine &diags,
                                  const LangOptions &lang,
                                  const PathDiagnosticConsumers &PDC,
@@ -21,7 +26,8 @@ AnalysisManager::AnalysisManager(ASTContext &ctx, DiagnosticsEngine &diags,
                                  ConstraintManagerCreator constraintmgr,
                                  CheckerManager *checkerMgr,
                                  AnalyzerOptions &Options,
-                                 CodeInjector *injector)
+                                 CodeInjector *injector,
+                                 CrossTUDefinitionSource *CrossTU)
   : AnaCtxMgr(Options.UnoptimizedCFG,
               /*AddImplicitDtors=*/true,
               /*AddInitializers=*/true,
@@ -35,9 +41,35 @@ AnalysisManager::AnalysisManager(ASTContext &ctx, DiagnosticsEngine &diags,
     LangOpts(lang),
     PathConsumers(PDC),
     CreateStoreMgr(storemgr), CreateConstraintMgr(constraintmgr),
-    CheckerMgr(checkerMgr),
+    CheckerMgr(checkerMgr), CrossTU(CrossTU),
     options(Options) {
   AnaCtxMgr.getCFGBuildOptions().setAllAlwaysAdd();
+
+  if (Options.PrintStats) {
+    ReportTimer.reset(new llvm::Timer("Analyzer Report Generation Time"));
+    CFGTimer.reset(new llvm::Timer("Analyzer CFG Construction Time"));
+    AnaCtxMgr.setCFGBuildTimer(CFGTimer.get());
+  }
+
+  // The baseline lists the issue hashes of the reports that are already
+  // known, one per line, as the plist output writes them.
+  // FIXME: We should emit a warning if the file can't be read, but there is
+  // no diagnostic for the analyzer configuration.
+  AnalyzerOptions::ConfigTable::const_iterator Baseline =
+      Options.Config.find("report-baseline");
+  if (Baseline != Options.Config.end()) {
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+        llvm::MemoryBuffer::getFile(Baseline->getValue());
+    if (Buffer) {
+      SmallVector<StringRef, 32> Lines;
+      Buffer.get()->getBuffer().split(Lines, '\n', -1, /*KeepEmpty=*/false);
+      for (StringRef Line : Lines) {
+        Line = Line.trim();
+        if (!Line.empty())
+          ReportBaseline.insert(Line);
+      }
+    }
+  }
 }
 
 AnalysisManager::~AnalysisManager() {
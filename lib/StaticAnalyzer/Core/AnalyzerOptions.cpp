@@ -321,6 +321,12 @@ unsigned AnalyzerOptions::getMaxNodesPerTopLevelFunction() {
   return MaxNodesPerTopLevelFunction.getValue();
 }
 
+unsigned AnalyzerOptions::getMaxFunctionMemory() {
+  if (!MaxFunctionMemory.hasValue())
+    MaxFunctionMemory = getOptionAsInteger("max-function-memory-mb", 0);
+  return MaxFunctionMemory.getValue();
+}
+
 bool AnalyzerOptions::shouldSynthesizeBodies() {
   return getBooleanOption("faux-bodies", true);
 }
@@ -344,3 +350,58 @@ bool AnalyzerOptions::shouldWidenLoops() {
     WidenLoops = getBooleanOption("widen-loops", /*Default=*/false);
   return WidenLoops.getValue();
 }
+
+bool AnalyzerOptions::shouldSummarizeLoops() {
+  if (!SummarizeLoops.hasValue())
+    SummarizeLoops = getBooleanOption("summarize-loops", /*Default=*/false);
+  return SummarizeLoops.getValue();
+}
+
+unsigned AnalyzerOptions::getShardCount() {
+  if (!ShardCount.hasValue())
+    ShardCount = getOptionAsInteger("shard-count", 1);
+  return ShardCount.getValue();
+}
+
+unsigned AnalyzerOptions::getShardIndex() {
+  if (!ShardIndex.hasValue())
+    ShardIndex = getOptionAsInteger("shard-index", 0);
+  return ShardIndex.getValue();
+}
+
+unsigned AnalyzerOptions::getHTMLReportThreads() {
+  if (!HTMLReportThreads.hasValue())
+    HTMLReportThreads = getOptionAsInteger("html-report-threads", 1);
+  return HTMLReportThreads.getValue();
+}
+
+unsigned AnalyzerOptions::getHTMLHighlightMaxLines() {
+  if (!HTMLHighlightMaxLines.hasValue())
+    HTMLHighlightMaxLines = getOptionAsInteger("html-highlight-max-lines",
+                                               20000);
+  return HTMLHighlightMaxLines.getValue();
+}
+
+bool AnalyzerOptions::shouldCacheSymbolicSimplifications() {
+  return getBooleanOption(CacheSymbolicSimplifications,
+                          "cache-symbolic-simplifications",
+                          /* Default = */ true);
+}
+
+ExplorationStrategyKind AnalyzerOptions::getExplorationStrategy() {
+  if (ExplorationStrategy == ESK_NotSet) {
+    StringRef StratStr =
+        Config.insert(std::make_pair("exploration_strategy", "dfs"))
+            .first->second;
+    ExplorationStrategy =
+        llvm::StringSwitch<ExplorationStrategyKind>(StratStr)
+            .Case("dfs", ESK_DFS)
+            .Case("bfs", ESK_BFS)
+            .Case("bfs_block_dfs_contents", ESK_BFSBlockDFSContents)
+            .Case("unexplored_first", ESK_UnexploredFirst)
+            .Default(ESK_NotSet);
+    assert(ExplorationStrategy != ESK_NotSet &&
+           "Exploration strategy is invalid.");
+  }
+  return ExplorationStrategy;
+}
@@ -16,10 +16,21 @@
 #include "clang/AST/ASTContext.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/BasicValueFactory.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/Store.h"
+#include "llvm/ADT/Statistic.h"
+#include <algorithm>
 
 using namespace clang;
 using namespace ento;
 
+#define DEBUG_TYPE "BasicValueFactory"
+
+STATISTIC(NumValueLookups,
+            "The # of integer values requested from the value factory.");
+STATISTIC(NumSmallValueHits,
+            "The # of integer values found in the small value tables.");
+STATISTIC(NumInternedValues,
+            "The # of distinct integer values interned.");
+
 void CompoundValData::Profile(llvm::FoldingSetNodeID& ID, QualType T,
                               llvm::ImmutableList<SVal> L) {
   T.Profile(ID);
@@ -69,7 +80,44 @@ BasicValueFactory::~BasicValueFactory() {
   delete (PersistentSValPairsTy*) PersistentSValPairs;
 }
 
+const llvm::APSInt **
+BasicValueFactory::getSmallValueSlot(const llvm::APSInt &X) {
+  unsigned BitWidth = X.getBitWidth();
+  if (BitWidth > 64)
+    return nullptr;
+
+  int64_t V;
+  if (X.isUnsigned()) {
+    uint64_t ZV = X.getZExtValue();
+    if (ZV >= uint64_t(SmallValueMin + NumSmallValues))
+      return nullptr;
+    V = ZV;
+  } else {
+    V = X.getSExtValue();
+    if (V < SmallValueMin || V >= SmallValueMin + NumSmallValues)
+      return nullptr;
+  }
+
+  const llvm::APSInt **&Table =
+      SmallValues[(BitWidth - 1) * 2 + X.isUnsigned()];
+  if (!Table) {
+    Table = BPAlloc.Allocate<const llvm::APSInt *>(NumSmallValues);
+    std::fill_n(Table, NumSmallValues, nullptr);
+  }
+  return &Table[V - SmallValueMin];
+}
+
 const llvm::APSInt& BasicValueFactory::getValue(const llvm::APSInt& X) {
+  ++NumValueLookups;
+
+  // Small values are found without profiling them. The table refers to the
+  // values interned in APSIntSet, so that every value has a single address.
+  const llvm::APSInt **Slot = getSmallValueSlot(X);
+  if (Slot && *Slot) {
+    ++NumSmallValueHits;
+    return **Slot;
+  }
+
   llvm::FoldingSetNodeID ID;
   void *InsertPos;
   typedef llvm::FoldingSetNodeWrapper<llvm::APSInt> FoldNodeTy;
@@ -78,11 +126,14 @@ const llvm::APSInt& BasicValueFactory::getValue(const llvm::APSInt& X) {
   FoldNodeTy* P = APSIntSet.FindNodeOrInsertPos(ID, InsertPos);
 
   if (!P) {
+    ++NumInternedValues;
     P = (FoldNodeTy*) BPAlloc.Allocate<FoldNodeTy>();
     new (P) FoldNodeTy(X);
     APSIntSet.InsertNode(P, InsertPos);
   }
 
+  if (Slot)
+    *Slot = &P->getValue();
   return *P;
 }
 
@@ -25,12 +25,14 @@
 #include "clang/Basic/SourceManager.h"
 #include "clang/StaticAnalyzer/Core/BugReporter/BugType.h"
 #include "clang/StaticAnalyzer/Core/BugReporter/PathDiagnostic.h"
+#include "clang/StaticAnalyzer/Core/IssueHash.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <memory>
 #include <queue>
@@ -45,6 +47,9 @@ STATISTIC(MaxBugClassSize,
 STATISTIC(MaxValidBugClassSize,
           "The maximum number of bug reports in the same equivalence class "
           "where at least one report is valid (not suppressed)");
+STATISTIC(NumReportsInBaseline,
+          "The # of bug reports whose path wasn't generated because they are "
+          "in the report baseline.");
 
 BugReporterVisitor::~BugReporterVisitor() {}
 
@@ -2754,6 +2759,8 @@ void BugReporter::FlushReports() {
   if (BugTypes.isEmpty())
     return;
 
+  llvm::TimeRegion Timer(D.getReportTimer());
+
   // First flush the warnings for each BugType.  This may end up creating new
   // warnings and new BugTypes.
   // FIXME: Only NSErrorChecker needs BugType's FlushReports.
@@ -3096,6 +3103,15 @@ bool GRBugReporter::generatePathDiagnostic(PathDiagnostic& PD,
     assert(R && "No original report found for sliced graph.");
     assert(R->isValid() && "Report selected by trimmed graph marked invalid.");
 
+    // Drop the report if a solver more precise than the constraint manager
+    // proves that its path cannot be taken.
+    if (!getStateManager().getConstraintManager().isFeasiblePath(
+            ErrorGraph.ErrorNode)) {
+      static const char InfeasiblePathTag = 0;
+      R->markInvalid(&InfeasiblePathTag, nullptr);
+      continue;
+    }
+
     // Start building the path diagnostic...
     PathDiagnosticBuilder PDB(*this, R, ErrorGraph.BackMap, &PC);
     const ExplodedNode *N = ErrorGraph.ErrorNode;
@@ -3376,13 +3392,42 @@ FindReportInEquivalenceClass(BugReportEquivClass& EQ,
   return exampleReport;
 }
 
+/// Returns true if the given report is in the report baseline. The issue hash
+/// is computed as in the plist output, from the location of the report
+/// rather than from the end of its path, which is not known yet.
+static bool isInReportBaseline(BugReporter &BR, BugReporterData &D,
+                               BugReport *R) {
+  if (D.getAnalyzerOptions().Config.count("report-baseline") == 0)
+    return false;
+
+  const SourceManager &SM = BR.getSourceManager();
+  PathDiagnosticLocation UniqueingLoc = R->getUniqueingLocation();
+  PathDiagnosticLocation Loc =
+      UniqueingLoc.isValid() ? UniqueingLoc : R->getLocation(SM);
+  if (!Loc.isValid())
+    return false;
+  FullSourceLoc L(SM.getExpansionLoc(Loc.asLocation()), SM);
+  const BugType &BT = R->getBugType();
+  return D.isInReportBaseline(GetIssueHash(SM, L, BT.getCheckName(),
+                                           BT.getName(), R->getDeclWithIssue(),
+                                           BR.getContext().getLangOpts()));
+}
+
 void BugReporter::FlushReport(BugReportEquivClass& EQ) {
   SmallVector<BugReport*, 10> bugReports;
   BugReport *exampleReport = FindReportInEquivalenceClass(EQ, bugReports);
-  if (exampleReport) {
-    for (PathDiagnosticConsumer *PDC : getPathDiagnosticConsumers()) {
-      FlushReport(exampleReport, *PDC, bugReports);
-    }
+  if (!exampleReport)
+    return;
+
+  // Generating the path is the expensive part of emitting a report; don't do
+  // it for the reports that are already known.
+  if (isInReportBaseline(*this, D, exampleReport)) {
+    NumReportsInBaseline++;
+    return;
+  }
+
+  for (PathDiagnosticConsumer *PDC : getPathDiagnosticConsumers()) {
+    FlushReport(exampleReport, *PDC, bugReports);
   }
 }
 
@@ -16,8 +16,11 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/CallEvent.h"
 #include "clang/AST/ParentMap.h"
 #include "clang/Analysis/ProgramPoint.h"
+#include "clang/StaticAnalyzer/Core/CrossTUDefinitionSource.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/CheckerContext.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/DynamicTypeMap.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/SubEngine.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/raw_ostream.h"
@@ -336,6 +339,33 @@ static void addParameterValuesToBindings(const StackFrameContext *CalleeCtx,
   // FIXME: Variadic arguments are not handled at all right now.
 }
 
+RuntimeDefinition AnyFunctionCall::getRuntimeDefinition() const {
+  const FunctionDecl *FD = getDecl();
+  if (!FD)
+    return RuntimeDefinition();
+
+  // Note that the AnalysisDeclContext will have the FunctionDecl with
+  // the definition (if one exists).
+  AnalysisDeclContext *AD =
+    getLocationContext()->getAnalysisDeclContext()->
+    getManager()->getContext(FD);
+  if (AD->getBody())
+    return RuntimeDefinition(AD->getDecl());
+
+  // Otherwise, another translation unit may define it.
+  SubEngine *Eng = getState()->getStateManager().getOwningEngine();
+  if (!Eng)
+    return RuntimeDefinition();
+  CrossTUDefinitionSource *CrossTU =
+    Eng->getAnalysisManager().getCrossTUDefinitionSource();
+  if (!CrossTU)
+    return RuntimeDefinition();
+  if (const FunctionDecl *Def = CrossTU->getDefinition(FD))
+    return RuntimeDefinition(Def);
+
+  return RuntimeDefinition();
+}
+
 ArrayRef<ParmVarDecl*> AnyFunctionCall::parameters() const {
   const FunctionDecl *D = getDecl();
   if (!D)
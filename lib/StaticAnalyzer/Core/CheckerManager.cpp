@@ -17,6 +17,7 @@
 #include "clang/StaticAnalyzer/Core/Checker.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/CallEvent.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/CheckerContext.h"
+#include "llvm/Support/Timer.h"
 
 using namespace clang;
 using namespace ento;
@@ -49,6 +50,28 @@ void CheckerManager::finishedCheckerRegistration() {
 #endif
 }
 
+//===----------------------------------------------------------------------===//
+// Profiling.
+//===----------------------------------------------------------------------===//
+
+void CheckerManager::ProfileScope::start() {
+  Parent = Mgr->CurrentProfileScope;
+  Mgr->CurrentProfileScope = this;
+  ChildSeconds = 0;
+  Start = llvm::TimeRecord::getCurrentTime(true).getProcessTime();
+}
+
+void CheckerManager::ProfileScope::stop() {
+  double Seconds =
+      llvm::TimeRecord::getCurrentTime(false).getProcessTime() - Start;
+  CheckerProfile &Profile = Mgr->Profiles[Checker];
+  ++Profile.NumCalls;
+  Profile.Seconds += Seconds - ChildSeconds;
+  if (Parent)
+    Parent->ChildSeconds += Seconds;
+  Mgr->CurrentProfileScope = Parent;
+}
+
 //===----------------------------------------------------------------------===//
 // Functions for running checkers for AST traversing..
 //===----------------------------------------------------------------------===//
@@ -74,16 +97,20 @@ void CheckerManager::runCheckersOnASTDecl(const Decl *D, AnalysisManager& mgr,
 
   assert(checkers);
   for (CachedDeclCheckers::iterator
-         I = checkers->begin(), E = checkers->end(); I != E; ++I)
+         I = checkers->begin(), E = checkers->end(); I != E; ++I) {
+    ProfileScope P(*this, I->Checker);
     (*I)(D, mgr, BR);
+  }
 }
 
 void CheckerManager::runCheckersOnASTBody(const Decl *D, AnalysisManager& mgr,
                                           BugReporter &BR) {
   assert(D && D->hasBody());
 
-  for (unsigned i = 0, e = BodyCheckers.size(); i != e; ++i)
+  for (unsigned i = 0, e = BodyCheckers.size(); i != e; ++i) {
+    ProfileScope P(*this, BodyCheckers[i].Checker);
     BodyCheckers[i](D, mgr, BR);
+  }
 }
 
 //===----------------------------------------------------------------------===//
@@ -120,6 +147,8 @@ static void expandGraphWithCheckers(CHECK_CTX checkCtx,
     NodeBuilder B(*PrevSet, *CurrSet, BldrCtx);
     for (ExplodedNodeSet::iterator NI = PrevSet->begin(), NE = PrevSet->end();
          NI != NE; ++NI) {
+      CheckerManager::ProfileScope P(checkCtx.Eng.getCheckerManager(),
+                                     I->Checker);
       checkCtx.runChecker(*I, B, *NI);
     }
 
@@ -373,8 +402,10 @@ void CheckerManager::runCheckersForBind(ExplodedNodeSet &Dst,
 void CheckerManager::runCheckersForEndAnalysis(ExplodedGraph &G,
                                                BugReporter &BR,
                                                ExprEngine &Eng) {
-  for (unsigned i = 0, e = EndAnalysisCheckers.size(); i != e; ++i)
+  for (unsigned i = 0, e = EndAnalysisCheckers.size(); i != e; ++i) {
+    ProfileScope P(*this, EndAnalysisCheckers[i].Checker);
     EndAnalysisCheckers[i](G, BR, Eng);
+  }
 }
 
 namespace {
@@ -429,6 +460,7 @@ void CheckerManager::runCheckersForEndFunction(NodeBuilderContext &BC,
     const ProgramPoint &L = BlockEntrance(BC.Block,
                                           Pred->getLocationContext(),
                                           checkFn.Checker);
+    ProfileScope P(*this, checkFn.Checker);
     CheckerContext C(Bldr, Eng, Pred, L);
     checkFn(C);
   }
@@ -472,8 +504,10 @@ void CheckerManager::runCheckersForBranchCondition(const Stmt *Condition,
 /// \brief Run checkers for live symbols.
 void CheckerManager::runCheckersForLiveSymbols(ProgramStateRef state,
                                                SymbolReaper &SymReaper) {
-  for (unsigned i = 0, e = LiveSymbolsCheckers.size(); i != e; ++i)
+  for (unsigned i = 0, e = LiveSymbolsCheckers.size(); i != e; ++i) {
+    ProfileScope P(*this, LiveSymbolsCheckers[i].Checker);
     LiveSymbolsCheckers[i](state, SymReaper);
+  }
 }
 
 namespace {
@@ -520,9 +554,11 @@ void CheckerManager::runCheckersForDeadSymbols(ExplodedNodeSet &Dst,
 
 /// \brief True if at least one checker wants to check region changes.
 bool CheckerManager::wantsRegionChangeUpdate(ProgramStateRef state) {
-  for (unsigned i = 0, e = RegionChangesCheckers.size(); i != e; ++i)
+  for (unsigned i = 0, e = RegionChangesCheckers.size(); i != e; ++i) {
+    ProfileScope P(*this, RegionChangesCheckers[i].WantUpdateFn.Checker);
     if (RegionChangesCheckers[i].WantUpdateFn(state))
       return true;
+  }
 
   return false;
 }
@@ -539,6 +575,7 @@ CheckerManager::runCheckersForRegionChanges(ProgramStateRef state,
     // bail out.
     if (!state)
       return nullptr;
+    ProfileScope P(*this, RegionChangesCheckers[i].CheckFn.Checker);
     state = RegionChangesCheckers[i].CheckFn(state, invalidated,
                                              ExplicitRegions, Regions, Call);
   }
@@ -561,6 +598,7 @@ CheckerManager::runCheckersForPointerEscape(ProgramStateRef State,
       //  way), bail out.
       if (!State)
         return nullptr;
+      ProfileScope P(*this, PointerEscapeCheckers[i].Checker);
       State = PointerEscapeCheckers[i](State, Escaped, Call, Kind, ETraits);
     }
   return State;
@@ -575,6 +613,7 @@ CheckerManager::runCheckersForEvalAssume(ProgramStateRef state,
     // bail out.
     if (!state)
       return nullptr;
+    ProfileScope P(*this, EvalAssumeCheckers[i].Checker);
     state = EvalAssumeCheckers[i](state, Cond, Assumption);
   }
   return state;
@@ -606,6 +645,7 @@ void CheckerManager::runCheckersForEvalCall(ExplodedNodeSet &Dst,
       { // CheckerContext generates transitions(populates checkDest) on
         // destruction, so introduce the scope to make sure it gets properly
         // populated.
+        ProfileScope P(*this, EI->Checker);
         CheckerContext C(B, Eng, Pred, L);
         evaluated = (*EI)(CE, C);
       }
@@ -633,8 +673,10 @@ void CheckerManager::runCheckersOnEndOfTranslationUnit(
                                                   const TranslationUnitDecl *TU,
                                                   AnalysisManager &mgr,
                                                   BugReporter &BR) {
-  for (unsigned i = 0, e = EndOfTranslationUnitCheckers.size(); i != e; ++i)
+  for (unsigned i = 0, e = EndOfTranslationUnitCheckers.size(); i != e; ++i) {
+    ProfileScope P(*this, EndOfTranslationUnitCheckers[i].Checker);
     EndOfTranslationUnitCheckers[i](TU, mgr, BR);
+  }
 }
 
 void CheckerManager::runCheckersForPrintState(raw_ostream &Out,
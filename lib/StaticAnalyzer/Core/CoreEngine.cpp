@@ -21,6 +21,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Casting.h"
+#include <queue>
 
 using namespace clang;
 using namespace ento;
@@ -31,6 +32,8 @@ STATISTIC(NumSteps,
             "The # of steps executed.");
 STATISTIC(NumReachedMaxSteps,
             "The # of times we reached the max number of steps.");
+STATISTIC(NumReachedMaxMemory,
+            "The # of times we reached the max memory of a function.");
 STATISTIC(NumPathsExplored,
             "The # of paths explored by the analyzer.");
 
@@ -157,10 +160,121 @@ WorkList* WorkList::makeBFSBlockDFSContents() {
   return new BFSBlockDFSContents();
 }
 
+namespace {
+  /// Continues with the nodes within a block depth-first, like DFS, but
+  /// chooses among the paths that enter a block by how many times that block
+  /// has been entered in the same stack frame: the paths into blocks that
+  /// haven't been explored yet come first. With DFS, a small node budget can
+  /// be spent going around the same loop on a few deep paths; this spreads it
+  /// over more of the function.
+  class UnexploredFirst : public WorkList {
+    typedef std::pair<unsigned, const StackFrameContext *> BlockInFrame;
+
+    /// The number of times each block has been enqueued in each frame.
+    llvm::DenseMap<BlockInFrame, unsigned> NumVisits;
+
+    /// The nodes that aren't block entrances.
+    SmallVector<WorkListUnit, 20> Stack;
+
+    /// The block entrances, by fewest visits first, then newest first.
+    struct Entrance {
+      unsigned Visits;
+      unsigned Order;
+      WorkListUnit U;
+
+      Entrance(unsigned Visits, unsigned Order, const WorkListUnit &U)
+          : Visits(Visits), Order(Order), U(U) {}
+
+      bool operator<(const Entrance &Other) const {
+        // std::priority_queue pops the greatest element.
+        if (Visits != Other.Visits)
+          return Visits > Other.Visits;
+        return Order < Other.Order;
+      }
+    };
+    std::priority_queue<Entrance> Queue;
+    unsigned NumEntrances;
+
+  public:
+    UnexploredFirst() : NumEntrances(0) {}
+
+    bool hasWork() const override {
+      return !Queue.empty() || !Stack.empty();
+    }
+
+    void enqueue(const WorkListUnit& U) override {
+      const ExplodedNode *N = U.getNode();
+      Optional<BlockEntrance> BE = N->getLocation().getAs<BlockEntrance>();
+      if (!BE) {
+        Stack.push_back(U);
+        return;
+      }
+
+      BlockInFrame Key(BE->getBlock()->getBlockID(),
+                       N->getLocationContext()->getCurrentStackFrame());
+      Queue.push(Entrance(NumVisits[Key]++, NumEntrances++, U));
+    }
+
+    WorkListUnit dequeue() override {
+      // Finish the blocks that have been entered already.
+      if (!Stack.empty()) {
+        const WorkListUnit& U = Stack.back();
+        Stack.pop_back(); // This technically "invalidates" U, but we are fine.
+        return U;
+      }
+
+      assert(!Queue.empty());
+      WorkListUnit U = Queue.top().U;
+      Queue.pop();
+      return U;
+    }
+
+    bool visitItemsInWorkList(Visitor &V) override {
+      for (SmallVectorImpl<WorkListUnit>::iterator
+           I = Stack.begin(), E = Stack.end(); I != E; ++I) {
+        if (V.visit(*I))
+          return true;
+      }
+      // std::priority_queue doesn't expose its elements; visit a copy.
+      std::priority_queue<Entrance> Copy = Queue;
+      for (; !Copy.empty(); Copy.pop()) {
+        if (V.visit(Copy.top().U))
+          return true;
+      }
+      return false;
+    }
+  };
+} // end anonymous namespace
+
+WorkList *WorkList::makeUnexploredFirst() {
+  return new UnexploredFirst();
+}
+
+static WorkList *generateWorkList(AnalyzerOptions &Opts) {
+  switch (Opts.getExplorationStrategy()) {
+  case ESK_NotSet:
+  case ESK_DFS:
+    return WorkList::makeDFS();
+  case ESK_BFS:
+    return WorkList::makeBFS();
+  case ESK_BFSBlockDFSContents:
+    return WorkList::makeBFSBlockDFSContents();
+  case ESK_UnexploredFirst:
+    return WorkList::makeUnexploredFirst();
+  }
+  llvm_unreachable("Unknown exploration strategy");
+}
+
 //===----------------------------------------------------------------------===//
 // Core analysis engine.
 //===----------------------------------------------------------------------===//
 
+CoreEngine::CoreEngine(SubEngine &subengine, FunctionSummariesTy *FS,
+                       AnalyzerOptions &Opts)
+    : SubEng(subengine), WList(generateWorkList(Opts)),
+      MaxBytes(uint64_t(Opts.getMaxFunctionMemory()) << 20),
+      BCounterFactory(G.getAllocator()), FunctionSummaries(FS) {}
+
 /// ExecuteWorkList - Run the worklist algorithm for a maximum number of steps.
 bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
                                    ProgramStateRef InitState) {
@@ -214,6 +328,11 @@ bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
   if(!UnlimitedSteps)
     G.reserve(std::min(Steps,PreReservationCap));
 
+  // Asking the allocators for their size walks their slabs, so the memory
+  // limit is only checked every so many steps.
+  const unsigned MemoryCheckInterval = 1024;
+  unsigned StepsToMemoryCheck = MemoryCheckInterval;
+
   while (WList->hasWork()) {
     if (!UnlimitedSteps) {
       if (Steps == 0) {
@@ -223,6 +342,17 @@ bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
       --Steps;
     }
 
+    if (MaxBytes && --StepsToMemoryCheck == 0) {
+      StepsToMemoryCheck = MemoryCheckInterval;
+      uint64_t Bytes =
+          G.getAllocator().getTotalMemory() +
+          SubEng.getStateManager().getAllocator().getTotalMemory();
+      if (Bytes > MaxBytes) {
+        NumReachedMaxMemory++;
+        break;
+      }
+    }
+
     NumSteps++;
 
     const WorkListUnit& WU = WList->dequeue();
@@ -26,6 +26,7 @@
 #include "clang/StaticAnalyzer/Core/CheckerManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/CallEvent.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/LoopSummary.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/LoopWidening.h"
 #include "llvm/ADT/ImmutableList.h"
 #include "llvm/ADT/Statistic.h"
@@ -44,6 +45,8 @@ using llvm::APSInt;
 
 STATISTIC(NumRemoveDeadBindings,
             "The # of times RemoveDeadBindings is called");
+STATISTIC(NumRemoveDeadBindingsNoop,
+            "The # of times RemoveDeadBindings found nothing to remove");
 STATISTIC(NumMaxBlockCountReached,
             "The # of aborted paths due to reaching the maximum block count in "
             "a top level function");
@@ -52,6 +55,24 @@ STATISTIC(NumMaxBlockCountReachedInInlined,
             "an inlined function");
 STATISTIC(NumTimesRetriedWithoutInlining,
             "The # of times we re-evaluated a call without inlining");
+STATISTIC(NumLoopsSummarized,
+            "The # of times the remaining iterations of a loop were "
+            "summarized");
+STATISTIC(NumLoopIterationsSkipped,
+            "The # of loop iterations that loop summaries stood for");
+STATISTIC(NumNodesSavedByLoopSummaries,
+            "The # of exploded nodes that loop summaries saved, estimated "
+            "from the first iteration");
+STATISTIC(NumExplodedNodes,
+            "The # of exploded nodes in the graphs of the top level functions");
+STATISTIC(NumStateBytes,
+            "The # of bytes allocated for the program states, stores and "
+            "constraints of the top level functions");
+STATISTIC(NumGraphBytes,
+            "The # of bytes allocated for exploded graphs");
+STATISTIC(MaxStateBytesPerNode,
+            "The maximum # of program state bytes per exploded node in a top "
+            "level function");
 
 typedef std::pair<const CXXBindTemporaryExpr *, const StackFrameContext *>
     CXXBindTemporaryContext;
@@ -74,7 +95,7 @@ ExprEngine::ExprEngine(AnalysisManager &mgr, bool gcEnabled,
                        InliningModes HowToInlineIn)
   : AMgr(mgr),
     AnalysisDeclContexts(mgr.getAnalysisDeclContextManager()),
-    Engine(*this, FS),
+    Engine(*this, FS, mgr.getAnalyzerOptions()),
     G(Engine.getGraph()),
     StateMgr(getContext(), mgr.getStoreManagerCreator(),
              mgr.getConstraintManagerCreator(), G.getAllocator(),
@@ -85,7 +106,8 @@ ExprEngine::ExprEngine(AnalysisManager &mgr, bool gcEnabled,
     ObjCNoRet(mgr.getASTContext()),
     ObjCGCEnabled(gcEnabled), BR(mgr, *this),
     VisitedCallees(VisitedCalleesIn),
-    HowToInline(HowToInlineIn)
+    HowToInline(HowToInlineIn), NumBlockCountExceeded(0),
+    NumInlineCountExceeded(0)
 {
   unsigned TrimInterval = mgr.options.getGraphTrimInterval();
   if (TrimInterval != 0) {
@@ -284,6 +306,18 @@ void ExprEngine::printState(raw_ostream &Out, ProgramStateRef State,
 
 void ExprEngine::processEndWorklist(bool hasWorkRemaining) {
   getCheckerManager().runCheckersForEndAnalysis(G, BR, *this);
+
+  // Everything the states of this function refer to, apart from the symbols
+  // and regions, comes out of the state manager's allocator.
+  size_t StateBytes = StateMgr.getAllocator().getTotalMemory();
+  NumExplodedNodes += G.size();
+  NumStateBytes += StateBytes;
+  NumGraphBytes += G.getAllocator().getTotalMemory();
+  if (G.size()) {
+    unsigned BytesPerNode = StateBytes / G.size();
+    if (BytesPerNode > MaxStateBytesPerNode)
+      MaxStateBytesPerNode = BytesPerNode;
+  }
 }
 
 void ExprEngine::processCFGElement(const CFGElement E, ExplodedNode *Pred,
@@ -381,6 +415,16 @@ void ExprEngine::removeDead(ExplodedNode *Pred, ExplodedNodeSet &Out,
   // A tag to track convenience transitions, which can be removed at cleanup.
   static SimpleProgramPointTag cleanupTag(TagProviderName, "Clean Node");
   if (!SymReaper.hasDeadSymbols()) {
+    // If there was nothing to clean up, there is no need for a new node
+    // either; carry on from the predecessor, as if state values were never
+    // purged. The node that ends a function is kept for the path notes.
+    if (CleanedState == Pred->getState() &&
+        K == ProgramPoint::PreStmtPurgeDeadSymbolsKind) {
+      NumRemoveDeadBindingsNoop++;
+      Out.Add(Pred);
+      return;
+    }
+
     // Generate a CleanedNode that has the environment and store cleaned
     // up. Since no symbols are dead, we can optimize and not clean out
     // the constraint manager.
@@ -919,6 +963,7 @@ void ExprEngine::Visit(const Stmt *S, ExplodedNode *Pred,
     case Stmt::ObjCAvailabilityCheckExprClass:
     case Stmt::FloatingLiteralClass:
     case Stmt::NoInitExprClass:
+    case Stmt::DataArrayExprClass:
     case Stmt::SizeOfPackExprClass:
     case Stmt::StringLiteralClass:
     case Stmt::ObjCStringLiteralClass:
@@ -1416,14 +1461,45 @@ bool ExprEngine::replayWithoutInlining(ExplodedNode *N,
 }
 
 /// Block entrance.  (Update counters).
+/// Count the nodes from the previous entrance of \p Header up to \p N.
+static unsigned countIterationNodes(const ExplodedNode *N,
+                                    const CFGBlock *Header) {
+  unsigned Count = 0;
+  for (N = N->getFirstPred(); N; N = N->getFirstPred()) {
+    ++Count;
+    if (Optional<BlockEdge> Edge = N->getLocationAs<BlockEdge>())
+      if (Edge->getDst() == Header)
+        break;
+  }
+  return Count;
+}
+
 void ExprEngine::processCFGBlockEntrance(const BlockEdge &L,
                                          NodeBuilderWithSinks &nodeBuilder,
                                          ExplodedNode *Pred) {
   PrettyStackTraceLocationContext CrashInfo(Pred->getLocationContext());
 
+  unsigned int BlockCount = nodeBuilder.getContext().blockCount();
+
+  // If this is the back edge of a counted loop, step to the state in which
+  // the loop exits.
+  if (AMgr.options.shouldSummarizeLoops()) {
+    uint64_t SkippedIterations;
+    if (ProgramStateRef SummaryState =
+            getSummarizedLoopState(Pred->getState(), Pred->getLocationContext(),
+                                   BlockCount, L, SkippedIterations)) {
+      ++NumLoopsSummarized;
+      NumLoopIterationsSkipped += SkippedIterations;
+      if (SkippedIterations)
+        NumNodesSavedByLoopSummaries +=
+            SkippedIterations * countIterationNodes(Pred, L.getDst());
+      nodeBuilder.generateNode(SummaryState, Pred);
+      return;
+    }
+  }
+
   // If this block is terminated by a loop and it has already been visited the
   // maximum number of times, widen the loop.
-  unsigned int BlockCount = nodeBuilder.getContext().blockCount();
   if (BlockCount == AMgr.options.maxBlockVisitOnPath - 1 &&
       AMgr.options.shouldWidenLoops()) {
     const Stmt *Term = nodeBuilder.getContext().getBlock()->getTerminator();
@@ -1443,6 +1519,7 @@ void ExprEngine::processCFGBlockEntrance(const BlockEdge &L,
     static SimpleProgramPointTag tag(TagProviderName, "Block count exceeded");
     const ExplodedNode *Sink =
                    nodeBuilder.generateSink(Pred->getState(), Pred, &tag);
+    ++NumBlockCountExceeded;
 
     // Check if we stopped at the top level function or not.
     // Root node should have the location context of the top most function.
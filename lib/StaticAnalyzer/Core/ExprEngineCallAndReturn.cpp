@@ -860,6 +860,7 @@ bool ExprEngine::shouldInlineCall(const CallEvent &Call, const Decl *D,
        CalleeCFG->getNumBlockIDs() >=
        Opts.getMinCFGSizeTreatFunctionsAsLarge()) {
     NumReachedInlineCountMax++;
+    ++NumInlineCountExceeded;
     return false;
   }
 
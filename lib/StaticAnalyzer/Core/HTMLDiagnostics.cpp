@@ -23,11 +23,14 @@
 #include "clang/StaticAnalyzer/Core/CheckerManager.h"
 #include "clang/StaticAnalyzer/Core/IssueHash.h"
 #include "clang/StaticAnalyzer/Core/PathDiagnosticConsumers.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
+#include <memory>
 #include <sstream>
 
 using namespace clang;
@@ -44,6 +47,18 @@ class HTMLDiagnostics : public PathDiagnosticConsumer {
   bool createdDir, noDir;
   const Preprocessor &PP;
   AnalyzerOptions &AnalyzerOpts;
+
+  /// The ranges highlighted in each file with reports, which only depend on
+  /// the file and are therefore computed once for all of its reports.
+  llvm::DenseMap<FileID, std::unique_ptr<html::HighlightedRanges>>
+      HighlightedFiles;
+
+  /// The pool that renders and writes the reports being flushed, or null if
+  /// they are written one after the other.
+  llvm::ThreadPool *Pool;
+
+  const html::HighlightedRanges &getHighlightedRanges(FileID FID);
+
 public:
   HTMLDiagnostics(AnalyzerOptions &AnalyzerOpts, const std::string& prefix, const Preprocessor &pp);
 
@@ -76,7 +91,8 @@ public:
 HTMLDiagnostics::HTMLDiagnostics(AnalyzerOptions &AnalyzerOpts,
                                  const std::string& prefix,
                                  const Preprocessor &pp)
-    : Directory(prefix), createdDir(false), noDir(false), PP(pp), AnalyzerOpts(AnalyzerOpts) {
+    : Directory(prefix), createdDir(false), noDir(false), PP(pp), AnalyzerOpts(AnalyzerOpts),
+      Pool(nullptr) {
 }
 
 void ento::createHTMLDiagnosticConsumer(AnalyzerOptions &AnalyzerOpts,
@@ -93,10 +109,95 @@ void ento::createHTMLDiagnosticConsumer(AnalyzerOptions &AnalyzerOpts,
 void HTMLDiagnostics::FlushDiagnosticsImpl(
   std::vector<const PathDiagnostic *> &Diags,
   FilesMade *filesMade) {
+  // Rendering a report only touches its own rewrite buffer, so the reports
+  // can be rendered and written in parallel once their paths are laid out.
+  std::unique_ptr<llvm::ThreadPool> ThreadPool;
+  unsigned Threads = AnalyzerOpts.getHTMLReportThreads();
+  if (Threads != 1 && Diags.size() > 1) {
+    ThreadPool = Threads ? llvm::make_unique<llvm::ThreadPool>(Threads)
+                         : llvm::make_unique<llvm::ThreadPool>();
+    Pool = ThreadPool.get();
+  }
+
   for (std::vector<const PathDiagnostic *>::iterator it = Diags.begin(),
        et = Diags.end(); it != et; ++it) {
     ReportDiag(**it, filesMade);
   }
+
+  if (Pool) {
+    Pool->wait();
+    Pool = nullptr;
+  }
+}
+
+const html::HighlightedRanges &
+HTMLDiagnostics::getHighlightedRanges(FileID FID) {
+  std::unique_ptr<html::HighlightedRanges> &Ranges = HighlightedFiles[FID];
+  if (!Ranges)
+    Ranges = llvm::make_unique<html::HighlightedRanges>(FID, PP);
+  return *Ranges;
+}
+
+/// \brief Compute the offsets of the lines of \p FID around the locations in
+/// \p Path that should be highlighted, if \p FID has more than \p MaxLines
+/// lines.
+static std::pair<unsigned, unsigned>
+getHighlightWindow(const SourceManager &SMgr, FileID FID, StringRef Buffer,
+                   const PathPieces &Path, unsigned MaxLines) {
+  // The number of lines highlighted above and below the path.
+  const unsigned WindowLines = 100;
+
+  std::pair<unsigned, unsigned> Window(0, ~0U);
+  unsigned NumLines = SMgr.getLineNumber(FID, Buffer.size());
+  if (!MaxLines || NumLines <= MaxLines)
+    return Window;
+
+  unsigned MinLine = NumLines, MaxLine = 1;
+  for (const auto &Piece : Path) {
+    FullSourceLoc Loc = Piece->getLocation().asLocation();
+    if (!Loc.isValid() ||
+        SMgr.getFileID(SMgr.getExpansionLoc(Loc)) != FID)
+      continue;
+    unsigned Line = Loc.getExpansionLineNumber();
+    MinLine = std::min(MinLine, Line);
+    MaxLine = std::max(MaxLine, Line);
+  }
+
+  if (MinLine > WindowLines + 1)
+    Window.first = SMgr.getFileOffset(
+        SMgr.translateLineCol(FID, MinLine - WindowLines, 1));
+  if (MaxLine + WindowLines < NumLines)
+    Window.second = SMgr.getFileOffset(
+        SMgr.translateLineCol(FID, MaxLine + WindowLines + 1, 1));
+  return Window;
+}
+
+/// \brief Render the HTML of a report into \p RB, which already holds the
+/// annotations of its path, and write it to \p FD.
+///
+/// This only touches \p RB, so that reports can be rendered in parallel.
+static void RenderReport(RewriteBuffer &RB, StringRef Buffer,
+                         const html::HighlightedRanges &Highlights,
+                         std::pair<unsigned, unsigned> HighlightWindow,
+                         StringRef Summary, StringRef MetaData,
+                         const std::string &Title, int FD) {
+  // Add line numbers, header, footer, etc.
+  html::EscapeText(RB, Buffer);
+  html::AddLineNumbers(RB, Buffer);
+
+  // Syntax highlight the file, and annotate its macro expansions.
+  Highlights.apply(RB, Buffer, HighlightWindow.first, HighlightWindow.second);
+
+  RB.InsertTextBefore(0, Summary);
+  RB.InsertTextBefore(0, MetaData);
+
+  // Add CSS, header, and footer.
+  html::AddHeaderFooterInternalBuiltinCSS(RB, Buffer, Title.c_str());
+
+  // Emit the HTML to disk.
+  llvm::raw_fd_ostream os(FD, true);
+  for (RewriteBuffer::iterator I = RB.begin(), E = RB.end(); I!=E; ++I)
+      os << *I;
 }
 
 void HTMLDiagnostics::ReportDiag(const PathDiagnostic& D,
@@ -129,8 +230,11 @@ void HTMLDiagnostics::ReportDiag(const PathDiagnostic& D,
     path.front()->getLocation().asLocation().getExpansionLoc().getFileID();
   assert(FID.isValid());
 
-  // Create a new rewriter to generate HTML.
-  Rewriter R(const_cast<SourceManager&>(SMgr), PP.getLangOpts());
+  // Create a new rewriter to generate HTML. It is shared with the thread that
+  // renders the report, if any.
+  auto Rewrite = std::make_shared<Rewriter>(const_cast<SourceManager &>(SMgr),
+                                            PP.getLangOpts());
+  Rewriter &R = *Rewrite;
 
   // Get the function/method name
   SmallString<128> declName("unknown");
@@ -160,18 +264,13 @@ void HTMLDiagnostics::ReportDiag(const PathDiagnostic& D,
         I != E; ++I, --n)
     HandlePiece(R, FID, **I, n, max);
 
-  // Add line numbers, header, footer, etc.
-
-  // unsigned FID = R.getSourceMgr().getMainFileID();
-  html::EscapeText(R, FID);
-  html::AddLineNumbers(R, FID);
-
-  // If we have a preprocessor, relex the file and syntax highlight.
-  // We might not have a preprocessor if we come from a deserialized AST file,
-  // for example.
-
-  html::SyntaxHighlight(R, FID, PP);
-  html::HighlightMacros(R, FID, PP);
+  // The highlighted ranges of the file are computed once for all of its
+  // reports; for very large files, only those around the path are applied.
+  RewriteBuffer &RB = R.getEditBuffer(FID);
+  StringRef Buffer = SMgr.getBufferData(FID);
+  const html::HighlightedRanges &Highlights = getHighlightedRanges(FID);
+  std::pair<unsigned, unsigned> HighlightWindow = getHighlightWindow(
+      SMgr, FID, Buffer, path, AnalyzerOpts.getHTMLHighlightMaxLines());
 
   // Get the full directory name of the analyzed file.
 
@@ -193,9 +292,9 @@ void HTMLDiagnostics::ReportDiag(const PathDiagnostic& D,
 
   // Add the name of the file as an <h1> tag.
 
+  std::string Summary;
   {
-    std::string s;
-    llvm::raw_string_ostream os(s);
+    llvm::raw_string_ostream os(Summary);
 
     os << "<!-- REPORTHEADER -->\n"
       << "<h3>Bug Summary</h3>\n<table class=\"simpletable\">\n"
@@ -220,14 +319,12 @@ void HTMLDiagnostics::ReportDiag(const PathDiagnostic& D,
 
     os << "</table>\n<!-- REPORTSUMMARYEXTRA -->\n"
           "<h3>Annotated Source Code</h3>\n";
-
-    R.InsertTextBefore(SMgr.getLocForStartOfFile(FID), os.str());
   }
 
   // Embed meta-data tags.
+  std::string MetaData;
   {
-    std::string s;
-    llvm::raw_string_ostream os(s);
+    llvm::raw_string_ostream os(MetaData);
 
     StringRef BugDesc = D.getVerboseDescription();
     if (!BugDesc.empty())
@@ -270,21 +367,6 @@ void HTMLDiagnostics::ReportDiag(const PathDiagnostic& D,
 
     // Mark the end of the tags.
     os << "\n<!-- BUGMETAEND -->\n";
-
-    // Insert the text.
-    R.InsertTextBefore(SMgr.getLocForStartOfFile(FID), os.str());
-  }
-
-  // Add CSS, header, and footer.
-
-  html::AddHeaderFooterInternalBuiltinCSS(R, FID, Entry->getName());
-
-  // Get the rewrite buffer.
-  const RewriteBuffer *Buf = R.getRewriteBufferFor(FID);
-
-  if (!Buf) {
-    llvm::errs() << "warning: no diagnostics generated for main file.\n";
-    return;
   }
 
   // Create a path for the target HTML file.
@@ -333,15 +415,24 @@ void HTMLDiagnostics::ReportDiag(const PathDiagnostic& D,
       } while (EC);
   }
 
-  llvm::raw_fd_ostream os(FD, true);
-
   if (filesMade)
     filesMade->addDiagnostic(D, getName(),
                              llvm::sys::path::filename(ResultPath));
 
-  // Emit the HTML to disk.
-  for (RewriteBuffer::iterator I = Buf->begin(), E = Buf->end(); I!=E; ++I)
-      os << *I;
+  std::string Title = Entry->getName();
+  if (!Pool) {
+    RenderReport(RB, Buffer, Highlights, HighlightWindow, Summary, MetaData,
+                 Title, FD);
+    return;
+  }
+
+  // The rewriter is kept alive, and the source manager left alone, until the
+  // report is rendered.
+  Pool->async([=, &RB, &Highlights] {
+    (void)Rewrite;
+    RenderReport(RB, Buffer, Highlights, HighlightWindow, Summary, MetaData,
+                 Title, FD);
+  });
 }
 
 void HTMLDiagnostics::HandlePiece(Rewriter& R, FileID BugFileID,
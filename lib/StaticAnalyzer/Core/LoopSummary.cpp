@@ -0,0 +1,305 @@
+//===--- LoopSummary.cpp - Summarize counted loops --------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file contains functions which are used to summarize counted loops.
+/// Once the first iteration of such a loop has been analyzed, the remaining
+/// ones are replaced by a single step to the state in which the loop exits:
+/// the counter holds its final value and everything the body writes is
+/// invalidated.
+///
+//===----------------------------------------------------------------------===//
+
+#include "clang/StaticAnalyzer/Core/PathSensitive/LoopSummary.h"
+#include "clang/AST/ExprCXX.h"
+#include "clang/AST/ExprObjC.h"
+#include "clang/AST/StmtCXX.h"
+#include "clang/AST/StmtObjC.h"
+#include "clang/Analysis/CFG.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/APSIntType.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/SValBuilder.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallVector.h"
+
+using namespace clang;
+using namespace ento;
+
+namespace {
+/// A 'for' loop that steps a counter by one towards a bound, i.e.
+/// 'for (...; Counter Op Bound; ++Counter)' or the same with '--Counter'.
+struct CountedLoop {
+  const VarDecl *Counter = nullptr;
+  const Expr *Bound = nullptr;
+  BinaryOperator::Opcode Op = BO_LT;
+  bool Increments = true;
+
+  /// The variables the body writes.
+  llvm::SmallSetVector<const VarDecl *, 8> Written;
+};
+} // end anonymous namespace
+
+/// Return the non-volatile variable \p E refers to, or null if \p E does not
+/// refer to one.
+static const VarDecl *getReferencedVar(const Expr *E) {
+  const auto *DRE = dyn_cast<DeclRefExpr>(E->IgnoreParenImpCasts());
+  if (!DRE)
+    return nullptr;
+  const auto *VD = dyn_cast<VarDecl>(DRE->getDecl());
+  if (!VD || VD->getType()->isReferenceType() ||
+      VD->getType().isVolatileQualified())
+    return nullptr;
+  return VD;
+}
+
+/// Return the variable whose storage a write to \p E changes, looking
+/// through array subscripts and members, or null if \p E may designate
+/// storage of any other variable.
+static const VarDecl *getWrittenVar(const Expr *E) {
+  E = E->IgnoreParenImpCasts();
+  if (const auto *ASE = dyn_cast<ArraySubscriptExpr>(E)) {
+    const Expr *Base = ASE->getBase()->IgnoreParenImpCasts();
+    if (!Base->getType()->isArrayType())
+      return nullptr;
+    return getWrittenVar(Base);
+  }
+  if (const auto *ME = dyn_cast<MemberExpr>(E)) {
+    if (ME->isArrow())
+      return nullptr;
+    return getWrittenVar(ME->getBase());
+  }
+  if (const auto *DRE = dyn_cast<DeclRefExpr>(E)) {
+    const auto *VD = dyn_cast<VarDecl>(DRE->getDecl());
+    if (VD && !VD->getType()->isReferenceType())
+      return VD;
+  }
+  return nullptr;
+}
+
+/// Record the variables \p S writes in \p Loop. Return false if \p S may
+/// change the counter or any storage other than those variables, or may
+/// leave the loop other than through its condition.
+///
+/// \param InBreakable Whether a 'break' in \p S leaves a statement nested in
+/// the loop rather than the loop itself.
+static bool collectWrites(const Stmt *S, CountedLoop &Loop, bool InBreakable) {
+  if (!S)
+    return true;
+
+  // Calls may write anything; the other statements leave the loop.
+  if (isa<CallExpr>(S) || isa<CXXConstructExpr>(S) || isa<CXXNewExpr>(S) ||
+      isa<CXXDeleteExpr>(S) || isa<CXXBindTemporaryExpr>(S) ||
+      isa<CXXThrowExpr>(S) || isa<ObjCMessageExpr>(S) || isa<BlockExpr>(S) ||
+      isa<LambdaExpr>(S) || isa<VAArgExpr>(S) || isa<AsmStmt>(S) ||
+      isa<GotoStmt>(S) || isa<IndirectGotoStmt>(S) || isa<ReturnStmt>(S) ||
+      isa<CXXTryStmt>(S) || isa<ObjCAtTryStmt>(S) || isa<ObjCAtThrowStmt>(S) ||
+      isa<ObjCAtSynchronizedStmt>(S) || isa<ObjCForCollectionStmt>(S) ||
+      isa<SEHTryStmt>(S) || isa<SEHLeaveStmt>(S))
+    return false;
+
+  if (isa<BreakStmt>(S))
+    return InBreakable;
+
+  if (isa<ForStmt>(S) || isa<WhileStmt>(S) || isa<DoStmt>(S) ||
+      isa<CXXForRangeStmt>(S) || isa<SwitchStmt>(S))
+    InBreakable = true;
+
+  const Expr *Target = nullptr;
+  if (const auto *UO = dyn_cast<UnaryOperator>(S)) {
+    // The address of a variable lets the loop write it behind our back.
+    if (UO->getOpcode() == UO_AddrOf)
+      return false;
+    if (UO->isIncrementDecrementOp())
+      Target = UO->getSubExpr();
+  } else if (const auto *BO = dyn_cast<BinaryOperator>(S)) {
+    if (BO->isAssignmentOp())
+      Target = BO->getLHS();
+  }
+  if (Target) {
+    const VarDecl *VD = getWrittenVar(Target);
+    if (!VD || VD == Loop.Counter)
+      return false;
+    Loop.Written.insert(VD);
+  }
+
+  for (const Stmt *Child : S->children())
+    if (!collectWrites(Child, Loop, InBreakable))
+      return false;
+  return true;
+}
+
+/// Determine whether \p FS is a counted loop, and if so, describe it in
+/// \p Loop.
+static bool matchCountedLoop(const ForStmt *FS, ASTContext &Ctx,
+                             CountedLoop &Loop) {
+  if (FS->getConditionVariable() || !FS->getCond() || !FS->getInc())
+    return false;
+
+  // The increment determines the counter.
+  const VarDecl *Counter;
+  bool Increments;
+  const Expr *Inc = FS->getInc()->IgnoreParenImpCasts();
+  if (const auto *UO = dyn_cast<UnaryOperator>(Inc)) {
+    if (!UO->isIncrementDecrementOp())
+      return false;
+    Counter = getReferencedVar(UO->getSubExpr());
+    Increments = UO->isIncrementOp();
+  } else if (const auto *CAO = dyn_cast<CompoundAssignOperator>(Inc)) {
+    llvm::APSInt Step;
+    if ((CAO->getOpcode() != BO_AddAssign &&
+         CAO->getOpcode() != BO_SubAssign) ||
+        !CAO->getRHS()->EvaluateAsInt(Step, Ctx) || Step.getExtValue() != 1)
+      return false;
+    Counter = getReferencedVar(CAO->getLHS());
+    Increments = CAO->getOpcode() == BO_AddAssign;
+  } else {
+    return false;
+  }
+  if (!Counter || !Counter->hasLocalStorage())
+    return false;
+
+  const auto *Cond = dyn_cast<BinaryOperator>(FS->getCond()->IgnoreParens());
+  if (!Cond || !Cond->isComparisonOp())
+    return false;
+
+  // Put the counter on the left-hand side.
+  BinaryOperator::Opcode Op = Cond->getOpcode();
+  const Expr *CounterE = Cond->getLHS();
+  const Expr *BoundE = Cond->getRHS();
+  if (getReferencedVar(CounterE) != Counter) {
+    std::swap(CounterE, BoundE);
+    Op = BinaryOperator::reverseComparisonOp(Op);
+    if (getReferencedVar(CounterE) != Counter)
+      return false;
+  }
+
+  // The comparison must happen in the type of the counter.
+  QualType Ty = Counter->getType();
+  if (!Ty->isIntegerType() || Ty->isBooleanType() || Ty->isEnumeralType() ||
+      !Ctx.hasSameUnqualifiedType(CounterE->getType(), Ty) ||
+      !Ctx.hasSameUnqualifiedType(BoundE->getType(), Ty))
+    return false;
+
+  // The counter must move towards the bound.
+  switch (Op) {
+  case BO_LT:
+  case BO_LE:
+    if (!Increments)
+      return false;
+    break;
+  case BO_GT:
+  case BO_GE:
+    if (Increments)
+      return false;
+    break;
+  case BO_NE:
+    break;
+  default:
+    return false;
+  }
+
+  Loop.Counter = Counter;
+  Loop.Bound = BoundE;
+  Loop.Op = Op;
+  Loop.Increments = Increments;
+  if (!collectWrites(FS->getBody(), Loop, /*InBreakable=*/false))
+    return false;
+
+  const VarDecl *BoundVar = getReferencedVar(BoundE);
+  return !BoundVar || (BoundVar != Counter && !Loop.Written.count(BoundVar));
+}
+
+/// Determine whether \p Edge comes from the increment of \p FS.
+static bool isBackEdge(const BlockEdge &Edge, const ForStmt *FS) {
+  const CFGBlock *Src = Edge.getSrc();
+  if (Src->empty())
+    return false;
+  Optional<CFGStmt> Last = Src->back().getAs<CFGStmt>();
+  return Last && Last->getStmt() == FS->getInc()->IgnoreParens();
+}
+
+namespace clang {
+namespace ento {
+
+ProgramStateRef getSummarizedLoopState(ProgramStateRef State,
+                                       const LocationContext *LCtx,
+                                       unsigned BlockCount,
+                                       const BlockEdge &Edge,
+                                       uint64_t &SkippedIterations) {
+  SkippedIterations = 0;
+
+  const Stmt *Term = Edge.getDst()->getTerminator();
+  const auto *FS = dyn_cast_or_null<ForStmt>(Term);
+  if (!FS || !isBackEdge(Edge, FS))
+    return nullptr;
+
+  ASTContext &Ctx = LCtx->getAnalysisDeclContext()->getASTContext();
+  CountedLoop Loop;
+  if (!matchCountedLoop(FS, Ctx, Loop))
+    return nullptr;
+
+  BasicValueFactory &BVF =
+      State->getStateManager().getSValBuilder().getBasicValueFactory();
+  QualType Ty = Loop.Counter->getType();
+  APSIntType IntTy = BVF.getAPSIntType(Ty);
+  Loc CounterLoc = State->getLValue(Loop.Counter, LCtx);
+
+  // Compute the value of the counter when the loop exits.
+  SVal Exit;
+  llvm::APSInt Bound;
+  if (Loop.Bound->EvaluateAsInt(Bound, Ctx)) {
+    Bound = IntTy.convert(Bound);
+    if (Loop.Op == BO_LE) {
+      if (Bound == IntTy.getMaxValue())
+        return nullptr;
+      ++Bound;
+    } else if (Loop.Op == BO_GE) {
+      if (Bound == IntTy.getMinValue())
+        return nullptr;
+      --Bound;
+    }
+
+    // The counter must not have passed the bound already, which a '!='
+    // condition would not stop.
+    SVal Current = State->getSVal(CounterLoc, Ty);
+    if (Optional<nonloc::ConcreteInt> C = Current.getAs<nonloc::ConcreteInt>()) {
+      llvm::APSInt CurrentValue = IntTy.convert(C->getValue());
+      if (Loop.Increments ? CurrentValue > Bound : CurrentValue < Bound)
+        return nullptr;
+      unsigned Width = IntTy.getBitWidth() + 1;
+      llvm::APSInt Distance =
+          Loop.Increments ? Bound.extend(Width) - CurrentValue.extend(Width)
+                          : CurrentValue.extend(Width) - Bound.extend(Width);
+      SkippedIterations = Distance.getLimitedValue();
+    }
+    Exit = nonloc::ConcreteInt(BVF.getValue(Bound));
+  } else {
+    // A symbolic bound is only summarized if the counter stops right at it,
+    // so that the condition then compares the bound with itself.
+    if (Loop.Op == BO_LE || Loop.Op == BO_GE)
+      return nullptr;
+    const VarDecl *BoundVar = getReferencedVar(Loop.Bound);
+    if (!BoundVar || !Ctx.hasSameUnqualifiedType(BoundVar->getType(), Ty))
+      return nullptr;
+    Exit = State->getSVal(State->getLValue(BoundVar, LCtx), Ty);
+    if (Exit.isUnknownOrUndef())
+      return nullptr;
+  }
+
+  // Invalidate whatever the remaining iterations may write, then let the
+  // counter reach its final value.
+  SmallVector<const MemRegion *, 8> Regions;
+  for (const VarDecl *VD : Loop.Written)
+    Regions.push_back(State->getLValue(VD, LCtx).getAsRegion());
+  if (!Regions.empty())
+    State = State->invalidateRegions(Regions, FS->getCond(), BlockCount, LCtx,
+                                     /*CausesPointerEscape=*/true);
+  return State->bindLoc(CounterLoc, Exit);
+}
+
+} // end namespace ento
+} // end namespace clang
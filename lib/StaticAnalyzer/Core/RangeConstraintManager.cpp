@@ -12,14 +12,24 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "SMTRefuter.h"
 #include "SimpleConstraintManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/APSIntType.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/ExplodedGraph.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramState.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramStateTrait.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/FoldingSet.h"
-#include "llvm/ADT/ImmutableSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/TrailingObjects.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <vector>
 
 using namespace clang;
 using namespace ento;
@@ -55,68 +65,121 @@ public:
 };
 
 
-class RangeTrait : public llvm::ImutContainerInfo<Range> {
+/// The sorted ranges of a RangeSet. Every distinct set of ranges is stored
+/// once, by RangeSetFactory.
+class RangeSetStorage final
+    : public llvm::FoldingSetNode,
+      private llvm::TrailingObjects<RangeSetStorage, Range> {
+  friend TrailingObjects;
+  friend class RangeSetFactory;
+
+  unsigned NumRanges;
+
+  RangeSetStorage(ArrayRef<Range> Ranges) : NumRanges(Ranges.size()) {
+    std::uninitialized_copy(Ranges.begin(), Ranges.end(),
+                            getTrailingObjects<Range>());
+  }
+
 public:
-  // When comparing if one Range is less than another, we should compare
-  // the actual APSInt values instead of their pointers.  This keeps the order
-  // consistent (instead of comparing by pointer values) and can potentially
-  // be used to speed up some of the operations in RangeSet.
-  static inline bool isLess(key_type_ref lhs, key_type_ref rhs) {
-    return *lhs.first < *rhs.first || (!(*rhs.first < *lhs.first) &&
-                                       *lhs.second < *rhs.second);
+  const Range *begin() const { return getTrailingObjects<Range>(); }
+  const Range *end() const { return begin() + NumRanges; }
+  unsigned size() const { return NumRanges; }
+
+  static void Profile(llvm::FoldingSetNodeID &ID, ArrayRef<Range> Ranges) {
+    ID.AddInteger(Ranges.size());
+    for (const Range &R : Ranges)
+      R.Profile(ID);
+  }
+  void Profile(llvm::FoldingSetNodeID &ID) const {
+    Profile(ID, llvm::makeArrayRef(begin(), end()));
   }
 };
 
+class RangeSetFactory {
+  llvm::BumpPtrAllocator Alloc;
+  llvm::FoldingSet<RangeSetStorage> Sets;
+
+public:
+  /// Return the storage of the given ranges, which must be sorted and must
+  /// not overlap.
+  const RangeSetStorage *get(ArrayRef<Range> Ranges) {
+    llvm::FoldingSetNodeID ID;
+    RangeSetStorage::Profile(ID, Ranges);
+    void *InsertPos;
+    if (RangeSetStorage *S = Sets.FindNodeOrInsertPos(ID, InsertPos))
+      return S;
+
+    void *Mem =
+        Alloc.Allocate(RangeSetStorage::totalSizeToAlloc<Range>(Ranges.size()),
+                       llvm::alignOf<RangeSetStorage>());
+    RangeSetStorage *S = new (Mem) RangeSetStorage(Ranges);
+    Sets.InsertNode(S, InsertPos);
+    return S;
+  }
+
+  const RangeSetStorage *getEmptySet() { return get(None); }
+};
+
 /// RangeSet contains a set of ranges. If the set is empty, then
 ///  there the value of a symbol is overly constrained and there are no
 ///  possible values for that symbol.
+///
+/// Most symbols are constrained to one or two ranges, so the ranges are kept
+/// in a sorted array rather than in a tree. The arrays are uniqued by the
+/// factory, so a RangeSet is a single pointer and sets compare by identity.
 class RangeSet {
-  typedef llvm::ImmutableSet<Range, RangeTrait> PrimRangeSet;
-  PrimRangeSet ranges; // no need to make const, since it is an
-                       // ImmutableSet - this allows default operator=
-                       // to work.
+  const RangeSetStorage *ranges;
+
+  static bool isLess(const Range &lhs, const Range &rhs) {
+    return lhs.From() < rhs.From() ||
+           (!(rhs.From() < lhs.From()) && lhs.To() < rhs.To());
+  }
+
 public:
-  typedef PrimRangeSet::Factory Factory;
-  typedef PrimRangeSet::iterator iterator;
+  typedef RangeSetFactory Factory;
+  typedef const Range *iterator;
 
-  RangeSet(PrimRangeSet RS) : ranges(RS) {}
+  RangeSet(const RangeSetStorage *RS) : ranges(RS) {}
 
   /// Create a new set with all ranges of this set and RS.
   /// Possible intersections are not checked here.
   RangeSet addRange(Factory &F, const RangeSet &RS) {
-    PrimRangeSet Ranges(RS.ranges);
-    for (const auto &range : ranges)
-      Ranges = F.add(Ranges, range);
-    return RangeSet(Ranges);
+    SmallVector<Range, 4> Ranges;
+    Ranges.reserve(ranges->size() + RS.ranges->size());
+    std::merge(begin(), end(), RS.begin(), RS.end(),
+               std::back_inserter(Ranges), isLess);
+    return F.get(Ranges);
   }
 
-  iterator begin() const { return ranges.begin(); }
-  iterator end() const { return ranges.end(); }
+  iterator begin() const { return ranges->begin(); }
+  iterator end() const { return ranges->end(); }
 
-  bool isEmpty() const { return ranges.isEmpty(); }
+  bool isEmpty() const { return ranges->size() == 0; }
+
+  /// Return the uniqued storage of the ranges, which identifies the set.
+  const RangeSetStorage *getStorage() const { return ranges; }
 
   /// Construct a new RangeSet representing '{ [from, to] }'.
   RangeSet(Factory &F, const llvm::APSInt &from, const llvm::APSInt &to)
-    : ranges(F.add(F.getEmptySet(), Range(from, to))) {}
+    : ranges(F.get(Range(from, to))) {}
 
   /// Profile - Generates a hash profile of this RangeSet for use
   ///  by FoldingSet.
-  void Profile(llvm::FoldingSetNodeID &ID) const { ranges.Profile(ID); }
+  void Profile(llvm::FoldingSetNodeID &ID) const { ID.AddPointer(ranges); }
 
   /// getConcreteValue - If a symbol is contrained to equal a specific integer
   ///  constant then this method returns that value.  Otherwise, it returns
   ///  NULL.
   const llvm::APSInt* getConcreteValue() const {
-    return ranges.isSingleton() ? ranges.begin()->getConcreteValue() : nullptr;
+    return ranges->size() == 1 ? begin()->getConcreteValue() : nullptr;
   }
 
 private:
-  void IntersectInRange(BasicValueFactory &BV, Factory &F,
+  void IntersectInRange(BasicValueFactory &BV,
                         const llvm::APSInt &Lower,
                         const llvm::APSInt &Upper,
-                        PrimRangeSet &newRanges,
-                        PrimRangeSet::iterator &i,
-                        PrimRangeSet::iterator &e) const {
+                        SmallVectorImpl<Range> &newRanges,
+                        iterator &i, iterator e) const {
     // There are six cases for each range R in the set:
     //   1. R is entirely before the intersection range.
     //   2. R is entirely after the intersection range.
@@ -135,24 +198,23 @@ private:
 
       if (i->Includes(Lower)) {
         if (i->Includes(Upper)) {
-          newRanges = F.add(newRanges, Range(BV.getValue(Lower),
-                                             BV.getValue(Upper)));
+          newRanges.push_back(Range(BV.getValue(Lower), BV.getValue(Upper)));
           break;
         } else
-          newRanges = F.add(newRanges, Range(BV.getValue(Lower), i->To()));
+          newRanges.push_back(Range(BV.getValue(Lower), i->To()));
       } else {
         if (i->Includes(Upper)) {
-          newRanges = F.add(newRanges, Range(i->From(), BV.getValue(Upper)));
+          newRanges.push_back(Range(i->From(), BV.getValue(Upper)));
           break;
         } else
-          newRanges = F.add(newRanges, *i);
+          newRanges.push_back(*i);
       }
     }
   }
 
   const llvm::APSInt &getMinValue() const {
     assert(!isEmpty());
-    return ranges.begin()->From();
+    return begin()->From();
   }
 
   bool pin(llvm::APSInt &Lower, llvm::APSInt &Upper) const {
@@ -249,20 +311,26 @@ public:
     if (!pin(Lower, Upper))
       return F.getEmptySet();
 
-    PrimRangeSet newRanges = F.getEmptySet();
+    // The ranges are produced in order, so they need no sorting.
+    SmallVector<Range, 4> newRanges;
 
-    PrimRangeSet::iterator i = begin(), e = end();
+    iterator i = begin(), e = end();
     if (Lower <= Upper)
-      IntersectInRange(BV, F, Lower, Upper, newRanges, i, e);
+      IntersectInRange(BV, Lower, Upper, newRanges, i, e);
     else {
       // The order of the next two statements is important!
       // IntersectInRange() does not reset the iteration state for i and e.
       // Therefore, the lower range most be handled first.
-      IntersectInRange(BV, F, BV.getMinValue(Upper), Upper, newRanges, i, e);
-      IntersectInRange(BV, F, Lower, BV.getMaxValue(Lower), newRanges, i, e);
+      IntersectInRange(BV, BV.getMinValue(Upper), Upper, newRanges, i, e);
+      IntersectInRange(BV, Lower, BV.getMaxValue(Lower), newRanges, i, e);
     }
 
-    return newRanges;
+    // Intersecting with a range that includes the whole set is common; don't
+    // look the set up again then.
+    if (newRanges.size() == ranges->size() &&
+        std::equal(newRanges.begin(), newRanges.end(), begin()))
+      return *this;
+    return F.get(newRanges);
   }
 
   void print(raw_ostream &os) const {
@@ -293,9 +361,19 @@ REGISTER_TRAIT_WITH_PROGRAMSTATE(ConstraintRange,
 namespace {
 class RangeConstraintManager : public SimpleConstraintManager{
   RangeSet GetRange(ProgramStateRef state, SymbolRef sym);
+
+  /// The solver that refutes bug paths, if any.
+  std::unique_ptr<SMTRefuter> Refuter;
+
+  /// The results of the refutations so far, keyed by the symbols of a path
+  /// and their ranges. Paths that end in the same error often carry the same
+  /// constraints.
+  std::map<std::vector<const void *>, bool> Refutations;
+
 public:
-  RangeConstraintManager(SubEngine *subengine, SValBuilder &SVB)
-    : SimpleConstraintManager(subengine, SVB) {}
+  RangeConstraintManager(SubEngine *subengine, SValBuilder &SVB,
+                         std::unique_ptr<SMTRefuter> Refuter = nullptr)
+    : SimpleConstraintManager(subengine, SVB), Refuter(std::move(Refuter)) {}
 
   ProgramStateRef assumeSymNE(ProgramStateRef state, SymbolRef sym,
                              const llvm::APSInt& Int,
@@ -331,6 +409,8 @@ public:
 
   const llvm::APSInt* getSymVal(ProgramStateRef St,
                                 SymbolRef sym) const override;
+  const void *getConstraintFingerprint(ProgramStateRef St) const override;
+  bool isFeasiblePath(const ExplodedNode *N) override;
   ConditionTruthVal checkNull(ProgramStateRef State, SymbolRef Sym) override;
 
   ProgramStateRef removeDeadBindings(ProgramStateRef St,
@@ -364,12 +444,89 @@ ento::CreateRangeConstraintManager(ProgramStateManager &StMgr, SubEngine *Eng) {
   return llvm::make_unique<RangeConstraintManager>(Eng, StMgr.getSValBuilder());
 }
 
+std::unique_ptr<ConstraintManager>
+ento::CreateZ3ConstraintManager(ProgramStateManager &StMgr, SubEngine *Eng) {
+  std::unique_ptr<SMTRefuter> Refuter = createZ3Refuter(StMgr.getContext());
+  if (!Refuter)
+    llvm::report_fatal_error("Clang was not compiled with Z3 support!", false);
+  return llvm::make_unique<RangeConstraintManager>(Eng, StMgr.getSValBuilder(),
+                                                   std::move(Refuter));
+}
+
 const llvm::APSInt* RangeConstraintManager::getSymVal(ProgramStateRef St,
                                                       SymbolRef sym) const {
   const ConstraintRangeTy::data_type *T = St->get<ConstraintRange>(sym);
   return T ? T->getConcreteValue() : nullptr;
 }
 
+const void *
+RangeConstraintManager::getConstraintFingerprint(ProgramStateRef St) const {
+  // The constraint maps are canonicalized, so equal maps share their root.
+  // The empty map has no root, but still needs a fingerprint.
+  static const char NoConstraints = 0;
+  if (const void *Root = St->get<ConstraintRange>().getRootWithoutRetain())
+    return Root;
+  return &NoConstraints;
+}
+
+bool RangeConstraintManager::isFeasiblePath(const ExplodedNode *N) {
+  if (!Refuter)
+    return true;
+
+  // The range of a symbol only narrows along a path, until the symbol dies
+  // and its constraint is dropped. Walking up from the error node, the first
+  // range seen for each symbol is therefore its narrowest one.
+  llvm::DenseSet<SymbolRef> Seen;
+  std::vector<std::pair<SymbolRef, RangeSet>> Constraints;
+  const void *LastFingerprint = nullptr;
+  for (; N; N = N->getFirstPred()) {
+    ProgramStateRef St = N->getState();
+    const void *Fingerprint = getConstraintFingerprint(St);
+    if (Fingerprint == LastFingerprint)
+      continue;
+    LastFingerprint = Fingerprint;
+
+    ConstraintRangeTy CR = St->get<ConstraintRange>();
+    for (ConstraintRangeTy::iterator I = CR.begin(), E = CR.end(); I != E; ++I)
+      if (Seen.insert(I.getKey()).second)
+        Constraints.push_back(std::make_pair(I.getKey(), I.getData()));
+  }
+  if (Constraints.empty())
+    return true;
+
+  // Ranges are uniqued, so a path's constraints are identified by the
+  // addresses of its symbols and ranges.
+  std::sort(Constraints.begin(), Constraints.end(),
+            [](const std::pair<SymbolRef, RangeSet> &LHS,
+               const std::pair<SymbolRef, RangeSet> &RHS) {
+              return LHS.first < RHS.first;
+            });
+  std::vector<const void *> Key;
+  Key.reserve(Constraints.size() * 2);
+  for (const auto &C : Constraints) {
+    Key.push_back(C.first);
+    Key.push_back(C.second.getStorage());
+  }
+  auto Cached = Refutations.find(Key);
+  if (Cached != Refutations.end())
+    return Cached->second;
+
+  Refuter->push();
+  SmallVector<SMTRefuter::ValueRange, 4> Values;
+  for (const auto &C : Constraints) {
+    Values.clear();
+    for (const Range &R : C.second)
+      Values.push_back(SMTRefuter::ValueRange(&R.From(), &R.To()));
+    Refuter->addRangeConstraint(C.first, Values);
+  }
+  // Keep the report if the solver gives up.
+  bool Feasible = Refuter->isSatisfiable().getValueOr(true);
+  Refuter->pop();
+
+  Refutations[std::move(Key)] = Feasible;
+  return Feasible;
+}
+
 ConditionTruthVal RangeConstraintManager::checkNull(ProgramStateRef State,
                                                     SymbolRef Sym) {
   const RangeSet *Ranges = State->get<ConstraintRange>(Sym);
@@ -241,6 +241,14 @@ RegionBindingsRef RegionBindingsRef::addBinding(BindingKey K, SVal V) const {
   const MemRegion *Base = K.getBaseRegion();
 
   const ClusterBindings *ExistingCluster = lookup(Base);
+
+  // Rebinding the value that is already bound would still copy the paths to
+  // the binding in both trees.
+  if (ExistingCluster)
+    if (const SVal *OldV = ExistingCluster->lookup(K))
+      if (*OldV == V)
+        return *this;
+
   ClusterBindings Cluster =
       (ExistingCluster ? *ExistingCluster : CBFactory->getEmptyMap());
 
@@ -270,7 +278,7 @@ const SVal *RegionBindingsRef::lookup(const MemRegion *R,
 RegionBindingsRef RegionBindingsRef::removeBinding(BindingKey K) {
   const MemRegion *Base = K.getBaseRegion();
   const ClusterBindings *Cluster = lookup(Base);
-  if (!Cluster)
+  if (!Cluster || !Cluster->lookup(K))
     return *this;
 
   ClusterBindings NewCluster = CBFactory->remove(*Cluster, K);
@@ -0,0 +1,72 @@
+//== SMTRefuter.h - Refute bug paths with an SMT solver ----------*- C++ -*--==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  Defines the interface that lets a constraint manager check the constraints
+//  of a bug path with an SMT solver.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LIB_STATICANALYZER_CORE_SMTREFUTER_H
+#define LLVM_CLANG_LIB_STATICANALYZER_CORE_SMTREFUTER_H
+
+#include "clang/StaticAnalyzer/Core/PathSensitive/SymbolManager.h"
+#include "llvm/ADT/APSInt.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
+#include <memory>
+#include <utility>
+
+namespace clang {
+class ASTContext;
+
+namespace ento {
+
+/// \brief Checks with an SMT solver whether the range constraints on a set of
+/// symbols can be satisfied together.
+///
+/// The constraints of each check are asserted in a scope of their own, so
+/// that the solver and the encodings of the symbols are reused from one
+/// check to the next.
+///
+/// Symbols and operations the solver cannot model are treated as unknown
+/// values, which can only make the constraints easier to satisfy: a check
+/// that fails proves that the path cannot be taken.
+class SMTRefuter {
+public:
+  /// \brief An inclusive range of values.
+  typedef std::pair<const llvm::APSInt *, const llvm::APSInt *> ValueRange;
+
+  virtual ~SMTRefuter();
+
+  /// \brief Open a scope for the constraints of one path.
+  virtual void push() = 0;
+
+  /// \brief Discard the constraints added since the matching push().
+  virtual void pop() = 0;
+
+  /// \brief Constrain \p Sym to lie in one of \p Ranges.
+  virtual void addRangeConstraint(SymbolRef Sym,
+                                  ArrayRef<ValueRange> Ranges) = 0;
+
+  /// \brief Check the constraints added so far.
+  ///
+  /// \returns true or false if the constraints are satisfiable or not, and
+  /// None if the solver gave up.
+  virtual Optional<bool> isSatisfiable() = 0;
+};
+
+/// \brief Create a refuter backed by the Z3 solver, or null if the analyzer
+/// was built without Z3.
+std::unique_ptr<SMTRefuter> createZ3Refuter(ASTContext &Ctx);
+
+} // end ento namespace
+
+} // end clang namespace
+
+#endif
@@ -13,11 +13,64 @@
 
 #include "clang/StaticAnalyzer/Core/PathSensitive/SValBuilder.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/APSIntType.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramState.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/SubEngine.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/TaintManager.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
 
 using namespace clang;
 using namespace ento;
 
+#define DEBUG_TYPE "SimpleSValBuilder"
+
+STATISTIC(NumSimplificationLookups,
+          "The # of symbolic binary operations looked up in the "
+          "simplification cache");
+STATISTIC(NumSimplificationHits,
+          "The # of symbolic binary operations whose simplification was "
+          "reused");
+
+namespace {
+/// \brief A binary operation on symbolic values, along with the parts of the
+/// state its simplification depends on.
+struct SimplificationKey {
+  unsigned Op;
+  SVal LHS, RHS;
+  QualType ResultTy;
+  const void *Constraints;
+  const void *Taint;
+};
+} // end anonymous namespace
+
+namespace llvm {
+template <> struct DenseMapInfo<SimplificationKey> {
+  static SimplificationKey getEmptyKey() {
+    return {~0U, UnknownVal(), UnknownVal(), QualType(), nullptr, nullptr};
+  }
+  static SimplificationKey getTombstoneKey() {
+    return {~0U - 1, UnknownVal(), UnknownVal(), QualType(), nullptr, nullptr};
+  }
+  static unsigned getHashValue(const SimplificationKey &K) {
+    FoldingSetNodeID ID;
+    ID.AddInteger(K.Op);
+    K.LHS.Profile(ID);
+    K.RHS.Profile(ID);
+    ID.AddPointer(K.ResultTy.getAsOpaquePtr());
+    ID.AddPointer(K.Constraints);
+    ID.AddPointer(K.Taint);
+    return ID.ComputeHash();
+  }
+  static bool isEqual(const SimplificationKey &LHS,
+                      const SimplificationKey &RHS) {
+    return LHS.Op == RHS.Op && LHS.LHS == RHS.LHS && LHS.RHS == RHS.RHS &&
+           LHS.ResultTy == RHS.ResultTy && LHS.Constraints == RHS.Constraints &&
+           LHS.Taint == RHS.Taint;
+  }
+};
+} // end namespace llvm
+
 namespace {
 class SimpleSValBuilder : public SValBuilder {
 protected:
@@ -46,6 +99,19 @@ public:
 
   SVal MakeSymIntVal(const SymExpr *LHS, BinaryOperator::Opcode op,
                      const llvm::APSInt &RHS, QualType resultTy);
+
+private:
+  /// \brief The results of evalBinOpNN on symbolic values, which checkers
+  /// and loops request again and again along sibling paths.
+  llvm::DenseMap<SimplificationKey, SVal> Simplifications;
+
+  /// \sa AnalyzerOptions::shouldCacheSymbolicSimplifications
+  Optional<bool> CacheSimplifications;
+
+  bool shouldCacheSimplifications();
+
+  SVal simplifyBinOpNN(ProgramStateRef state, BinaryOperator::Opcode op,
+                       NonLoc lhs, NonLoc rhs, QualType resultTy);
 };
 } // end anonymous namespace
 
@@ -301,10 +367,58 @@ SVal SimpleSValBuilder::MakeSymIntVal(const SymExpr *LHS,
   return makeNonLoc(LHS, op, *ConvertedRHS, resultTy);
 }
 
+bool SimpleSValBuilder::shouldCacheSimplifications() {
+  if (!CacheSimplifications.hasValue()) {
+    SubEngine *Eng = StateMgr.getOwningEngine();
+    CacheSimplifications =
+        Eng && Eng->getAnalysisManager()
+                   .getAnalyzerOptions()
+                   .shouldCacheSymbolicSimplifications();
+  }
+  return CacheSimplifications.getValue();
+}
+
+/// \brief Determine whether evaluating a binary operation on \p V depends
+/// only on the constraints and taint of the state.
+static bool isCacheableOperand(NonLoc V) {
+  return V.getAs<nonloc::SymbolVal>() || V.getAs<nonloc::ConcreteInt>();
+}
+
 SVal SimpleSValBuilder::evalBinOpNN(ProgramStateRef state,
                                   BinaryOperator::Opcode op,
                                   NonLoc lhs, NonLoc rhs,
                                   QualType resultTy)  {
+  // Operations on constants are cheap; operations on symbols look at the
+  // constraints, through getSymVal(), and at the taint of their operands,
+  // through makeSymExprValNN(), and at nothing else in the state.
+  if (!isCacheableOperand(lhs) || !isCacheableOperand(rhs) ||
+      (!lhs.getAs<nonloc::SymbolVal>() && !rhs.getAs<nonloc::SymbolVal>()) ||
+      !shouldCacheSimplifications())
+    return simplifyBinOpNN(state, op, lhs, rhs, resultTy);
+
+  const void *Constraints =
+      state->getConstraintManager().getConstraintFingerprint(state);
+  if (!Constraints)
+    return simplifyBinOpNN(state, op, lhs, rhs, resultTy);
+
+  ++NumSimplificationLookups;
+  SimplificationKey Key = {op, lhs, rhs, resultTy, Constraints,
+                           state->get<TaintMap>().getRootWithoutRetain()};
+  auto I = Simplifications.find(Key);
+  if (I != Simplifications.end()) {
+    ++NumSimplificationHits;
+    return I->second;
+  }
+
+  SVal Result = simplifyBinOpNN(state, op, lhs, rhs, resultTy);
+  Simplifications.insert(std::make_pair(Key, Result));
+  return Result;
+}
+
+SVal SimpleSValBuilder::simplifyBinOpNN(ProgramStateRef state,
+                                        BinaryOperator::Opcode op,
+                                        NonLoc lhs, NonLoc rhs,
+                                        QualType resultTy) {
   NonLoc InputLHS = lhs;
   NonLoc InputRHS = rhs;
 
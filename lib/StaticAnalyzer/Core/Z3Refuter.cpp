@@ -0,0 +1,296 @@
+//== Z3Refuter.cpp - Refute bug paths with the Z3 solver ---------*- C++ -*--==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines an SMTRefuter that encodes symbols as bit-vectors and
+//  checks their range constraints with the Z3 solver.
+//
+//===----------------------------------------------------------------------===//
+
+#include "SMTRefuter.h"
+#include "clang/Config/config.h"
+
+#ifdef CLANG_ANALYZER_WITH_Z3
+#include "clang/AST/ASTContext.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/SVals.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include <z3.h>
+#endif
+
+using namespace clang;
+using namespace ento;
+
+SMTRefuter::~SMTRefuter() {}
+
+#ifndef CLANG_ANALYZER_WITH_Z3
+
+std::unique_ptr<SMTRefuter> ento::createZ3Refuter(ASTContext &Ctx) {
+  return nullptr;
+}
+
+#else
+
+/// \brief How long a single check may take, in milliseconds.
+static const unsigned Z3Timeout = 15000;
+
+namespace {
+class Z3Refuter : public SMTRefuter {
+  ASTContext &Ctx;
+  Z3_context Z3Ctx;
+  Z3_solver Solver;
+
+  /// \brief The encodings of the symbols seen so far, which outlive the
+  /// scopes of the checks.
+  llvm::DenseMap<SymbolRef, Z3_ast> Encodings;
+
+  /// \brief Return the width of the bit-vectors that hold values of type
+  /// \p T, or 0 if they cannot be modeled.
+  unsigned getWidth(QualType T) const;
+  unsigned getWidth(Z3_ast E) const {
+    return Z3_get_bv_sort_size(Z3Ctx, Z3_get_sort(Z3Ctx, E));
+  }
+
+  Z3_ast mkNumeral(const llvm::APSInt &V) {
+    return Z3_mk_numeral(
+        Z3Ctx, static_cast<const llvm::APInt &>(V).toString(10, false).c_str(),
+        Z3_mk_bv_sort(Z3Ctx, V.getBitWidth()));
+  }
+  Z3_ast mkBoolToBV(Z3_ast Cond, unsigned Width) {
+    Z3_sort Sort = Z3_mk_bv_sort(Z3Ctx, Width);
+    return Z3_mk_ite(Z3Ctx, Cond, Z3_mk_int(Z3Ctx, 1, Sort),
+                     Z3_mk_int(Z3Ctx, 0, Sort));
+  }
+  Z3_ast mkBinOp(BinaryOperator::Opcode Op, Z3_ast LHS, Z3_ast RHS,
+                 bool IsSigned, unsigned ResultWidth);
+  Z3_ast mkCast(Z3_ast Operand, QualType FromTy, QualType ToTy);
+
+  /// \brief Encode \p Sym as a bit-vector, or return null if its type cannot
+  /// be modeled. Symbols the solver cannot reason about become unknown
+  /// values.
+  Z3_ast encode(SymbolRef Sym);
+  Z3_ast encodeExpr(SymbolRef Sym, unsigned Width);
+
+public:
+  explicit Z3Refuter(ASTContext &Ctx);
+  ~Z3Refuter() override;
+
+  void push() override { Z3_solver_push(Z3Ctx, Solver); }
+  void pop() override { Z3_solver_pop(Z3Ctx, Solver, 1); }
+  void addRangeConstraint(SymbolRef Sym,
+                          ArrayRef<ValueRange> Ranges) override;
+  Optional<bool> isSatisfiable() override;
+};
+} // end anonymous namespace
+
+Z3Refuter::Z3Refuter(ASTContext &Ctx) : Ctx(Ctx) {
+  Z3_config Config = Z3_mk_config();
+  Z3Ctx = Z3_mk_context(Config);
+  Z3_del_config(Config);
+
+  Solver = Z3_mk_solver(Z3Ctx);
+  Z3_solver_inc_ref(Z3Ctx, Solver);
+
+  Z3_params Params = Z3_mk_params(Z3Ctx);
+  Z3_params_inc_ref(Z3Ctx, Params);
+  Z3_params_set_uint(Z3Ctx, Params, Z3_mk_string_symbol(Z3Ctx, "timeout"),
+                     Z3Timeout);
+  Z3_solver_set_params(Z3Ctx, Solver, Params);
+  Z3_params_dec_ref(Z3Ctx, Params);
+}
+
+Z3Refuter::~Z3Refuter() {
+  Z3_solver_dec_ref(Z3Ctx, Solver);
+  Z3_del_context(Z3Ctx);
+}
+
+unsigned Z3Refuter::getWidth(QualType T) const {
+  if (Loc::isLocType(T))
+    return Ctx.getTypeSize(Ctx.VoidPtrTy);
+  if (T->isIntegralOrEnumerationType())
+    return Ctx.getIntWidth(T);
+  return 0;
+}
+
+Z3_ast Z3Refuter::mkBinOp(BinaryOperator::Opcode Op, Z3_ast LHS, Z3_ast RHS,
+                          bool IsSigned, unsigned ResultWidth) {
+  // The analyzer does not always convert the operands to a common type.
+  if (getWidth(LHS) != getWidth(RHS))
+    return nullptr;
+
+  switch (Op) {
+  case BO_LT:
+    return mkBoolToBV(IsSigned ? Z3_mk_bvslt(Z3Ctx, LHS, RHS)
+                               : Z3_mk_bvult(Z3Ctx, LHS, RHS),
+                      ResultWidth);
+  case BO_GT:
+    return mkBoolToBV(IsSigned ? Z3_mk_bvsgt(Z3Ctx, LHS, RHS)
+                               : Z3_mk_bvugt(Z3Ctx, LHS, RHS),
+                      ResultWidth);
+  case BO_LE:
+    return mkBoolToBV(IsSigned ? Z3_mk_bvsle(Z3Ctx, LHS, RHS)
+                               : Z3_mk_bvule(Z3Ctx, LHS, RHS),
+                      ResultWidth);
+  case BO_GE:
+    return mkBoolToBV(IsSigned ? Z3_mk_bvsge(Z3Ctx, LHS, RHS)
+                               : Z3_mk_bvuge(Z3Ctx, LHS, RHS),
+                      ResultWidth);
+  case BO_EQ:
+    return mkBoolToBV(Z3_mk_eq(Z3Ctx, LHS, RHS), ResultWidth);
+  case BO_NE:
+    return mkBoolToBV(Z3_mk_not(Z3Ctx, Z3_mk_eq(Z3Ctx, LHS, RHS)),
+                      ResultWidth);
+  default:
+    break;
+  }
+
+  if (getWidth(LHS) != ResultWidth)
+    return nullptr;
+
+  switch (Op) {
+  case BO_Add:
+    return Z3_mk_bvadd(Z3Ctx, LHS, RHS);
+  case BO_Sub:
+    return Z3_mk_bvsub(Z3Ctx, LHS, RHS);
+  case BO_Mul:
+    return Z3_mk_bvmul(Z3Ctx, LHS, RHS);
+  case BO_And:
+    return Z3_mk_bvand(Z3Ctx, LHS, RHS);
+  case BO_Or:
+    return Z3_mk_bvor(Z3Ctx, LHS, RHS);
+  case BO_Xor:
+    return Z3_mk_bvxor(Z3Ctx, LHS, RHS);
+  default:
+    // Division and shifts by zero or out of range amounts are undefined,
+    // so they are left unknown.
+    return nullptr;
+  }
+}
+
+Z3_ast Z3Refuter::mkCast(Z3_ast Operand, QualType FromTy, QualType ToTy) {
+  unsigned FromWidth = getWidth(Operand);
+  unsigned ToWidth = getWidth(ToTy);
+
+  if (ToTy->isBooleanType()) {
+    Z3_ast Zero = Z3_mk_int(Z3Ctx, 0, Z3_mk_bv_sort(Z3Ctx, FromWidth));
+    return mkBoolToBV(Z3_mk_not(Z3Ctx, Z3_mk_eq(Z3Ctx, Operand, Zero)),
+                      ToWidth);
+  }
+  if (ToWidth == FromWidth)
+    return Operand;
+  if (ToWidth < FromWidth)
+    return Z3_mk_extract(Z3Ctx, ToWidth - 1, 0, Operand);
+  if (FromTy->isSignedIntegerOrEnumerationType())
+    return Z3_mk_sign_ext(Z3Ctx, ToWidth - FromWidth, Operand);
+  return Z3_mk_zero_ext(Z3Ctx, ToWidth - FromWidth, Operand);
+}
+
+Z3_ast Z3Refuter::encodeExpr(SymbolRef Sym, unsigned Width) {
+  if (const SymbolData *SD = dyn_cast<SymbolData>(Sym))
+    return Z3_mk_const(Z3Ctx, Z3_mk_int_symbol(Z3Ctx, SD->getSymbolID()),
+                       Z3_mk_bv_sort(Z3Ctx, Width));
+
+  if (const SymbolCast *SC = dyn_cast<SymbolCast>(Sym)) {
+    if (Z3_ast Operand = encode(SC->getOperand()))
+      return mkCast(Operand, SC->getOperand()->getType(), SC->getType());
+    return nullptr;
+  }
+
+  if (const SymIntExpr *SIE = dyn_cast<SymIntExpr>(Sym)) {
+    if (Z3_ast LHS = encode(SIE->getLHS()))
+      return mkBinOp(SIE->getOpcode(), LHS, mkNumeral(SIE->getRHS()),
+                     SIE->getRHS().isSigned(), Width);
+    return nullptr;
+  }
+
+  if (const IntSymExpr *ISE = dyn_cast<IntSymExpr>(Sym)) {
+    if (Z3_ast RHS = encode(ISE->getRHS()))
+      return mkBinOp(ISE->getOpcode(), mkNumeral(ISE->getLHS()), RHS,
+                     ISE->getLHS().isSigned(), Width);
+    return nullptr;
+  }
+
+  if (const SymSymExpr *SSE = dyn_cast<SymSymExpr>(Sym)) {
+    Z3_ast LHS = encode(SSE->getLHS());
+    Z3_ast RHS = encode(SSE->getRHS());
+    if (LHS && RHS)
+      return mkBinOp(
+          SSE->getOpcode(), LHS, RHS,
+          SSE->getLHS()->getType()->isSignedIntegerOrEnumerationType(), Width);
+    return nullptr;
+  }
+
+  return nullptr;
+}
+
+Z3_ast Z3Refuter::encode(SymbolRef Sym) {
+  auto I = Encodings.find(Sym);
+  if (I != Encodings.end())
+    return I->second;
+
+  Z3_ast E = nullptr;
+  if (unsigned Width = getWidth(Sym->getType())) {
+    E = encodeExpr(Sym, Width);
+    if (!E || getWidth(E) != Width)
+      E = Z3_mk_fresh_const(Z3Ctx, "unknown", Z3_mk_bv_sort(Z3Ctx, Width));
+  }
+  Encodings[Sym] = E;
+  return E;
+}
+
+void Z3Refuter::addRangeConstraint(SymbolRef Sym,
+                                   ArrayRef<ValueRange> Ranges) {
+  Z3_ast E = encode(Sym);
+  if (!E || Ranges.empty())
+    return;
+
+  unsigned Width = getWidth(E);
+  SmallVector<Z3_ast, 4> Disjuncts;
+  for (const ValueRange &R : Ranges) {
+    // Leave the symbol unconstrained rather than guess at a conversion.
+    if (R.first->getBitWidth() != Width || R.second->getBitWidth() != Width)
+      return;
+
+    Z3_ast From = mkNumeral(*R.first);
+    if (R.first == R.second) {
+      Disjuncts.push_back(Z3_mk_eq(Z3Ctx, E, From));
+      continue;
+    }
+
+    Z3_ast To = mkNumeral(*R.second);
+    Z3_ast Bounds[2];
+    if (R.first->isSigned()) {
+      Bounds[0] = Z3_mk_bvsle(Z3Ctx, From, E);
+      Bounds[1] = Z3_mk_bvsle(Z3Ctx, E, To);
+    } else {
+      Bounds[0] = Z3_mk_bvule(Z3Ctx, From, E);
+      Bounds[1] = Z3_mk_bvule(Z3Ctx, E, To);
+    }
+    Disjuncts.push_back(Z3_mk_and(Z3Ctx, 2, Bounds));
+  }
+
+  Z3_solver_assert(Z3Ctx, Solver,
+                   Z3_mk_or(Z3Ctx, Disjuncts.size(), Disjuncts.data()));
+}
+
+Optional<bool> Z3Refuter::isSatisfiable() {
+  switch (Z3_solver_check(Z3Ctx, Solver)) {
+  case Z3_L_TRUE:
+    return true;
+  case Z3_L_FALSE:
+    return false;
+  default:
+    return None;
+  }
+}
+
+std::unique_ptr<SMTRefuter> ento::createZ3Refuter(ASTContext &Ctx) {
+  return llvm::make_unique<Z3Refuter>(Ctx);
+}
+
+#endif
@@ -12,6 +12,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/StaticAnalyzer/Frontend/AnalysisConsumer.h"
+#include "AnalysisResultCache.h"
+#include "CrossTUDefinitionLoader.h"
 #include "ModelInjector.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/Decl.h"
@@ -31,6 +33,7 @@
 #include "clang/StaticAnalyzer/Core/AnalyzerOptions.h"
 #include "clang/StaticAnalyzer/Core/BugReporter/BugReporter.h"
 #include "clang/StaticAnalyzer/Core/BugReporter/PathDiagnostic.h"
+#include "clang/StaticAnalyzer/Core/Checker.h"
 #include "clang/StaticAnalyzer/Core/CheckerManager.h"
 #include "clang/StaticAnalyzer/Core/PathDiagnosticConsumers.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
@@ -40,11 +43,13 @@
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <memory>
 #include <queue>
 #include <utility>
@@ -64,6 +69,9 @@ STATISTIC(NumBlocksInAnalyzedFunctions,
                       "The # of basic blocks in the analyzed functions.");
 STATISTIC(PercentReachableBlocks, "The % of reachable basic blocks.");
 STATISTIC(MaxCFGSize, "The maximum number of basic blocks in a function.");
+STATISTIC(NumFunctionsSkippedFromCache,
+                      "The # of functions not analyzed because the result "
+                      "cache has them.");
 
 //===----------------------------------------------------------------------===//
 // Special PathDiagnosticConsumers.
@@ -162,6 +170,38 @@ public:
   ArrayRef<std::string> Plugins;
   CodeInjector *Injector;
 
+  /// \brief Finds the definitions of functions from other translation units,
+  /// with cross translation unit analysis.
+  std::unique_ptr<CrossTUDefinitionSource> CrossTU;
+
+  /// \brief Remembers the functions that had nothing to report in earlier
+  /// runs, with the result-cache-dir option.
+  std::unique_ptr<AnalysisResultCache> ResultCache;
+
+  /// The number of bug report classes found by the path-sensitive analysis.
+  unsigned NumPathSensitiveReports;
+
+  /// \brief The cost of one path-sensitive analysis of a top level function,
+  /// with the profile-output option.
+  struct FunctionProfile {
+    std::string Name;
+    std::string File;
+    unsigned Line;
+    ExprEngine::InliningModes IMode;
+    unsigned NumNodes;
+    double Seconds;
+    /// Whether the analysis stopped with work left, because of max-nodes or
+    /// max-function-memory-mb.
+    bool ReachedMaxNodes;
+    unsigned NumBlockCountExceeded;
+    unsigned NumInlineCountExceeded;
+  };
+  std::vector<FunctionProfile> FunctionProfiles;
+
+  /// The file the profiles of the functions and of the checkers are written
+  /// to, or an empty string.
+  std::string ProfileOutput;
+
   /// \brief Stores the declarations from the local translation unit.
   /// Note, we pre-compute the local declarations at parse time as an
   /// optimization to make sure we do not deserialize everything from disk.
@@ -169,7 +209,8 @@ public:
   /// working with a PCH file.
   SetOfDecls LocalTUDecls;
 
-  // Set of PathDiagnosticConsumers.  Owned by AnalysisManager.
+  // Set of PathDiagnosticConsumers.  Owned by AnalysisManager once it is
+  // created.
   PathDiagnosticConsumers PathConsumers;
 
   StoreManagerCreator CreateStoreMgr;
@@ -181,26 +222,44 @@ public:
   /// Time the analyzes time of each translation unit.
   static llvm::Timer* TUTotalTimer;
 
+  /// Time the creation of the checkers and of the analysis manager.
+  static llvm::Timer* SetupTimer;
+
   /// The information about analyzed functions shared throughout the
   /// translation unit.
   FunctionSummariesTy FunctionSummaries;
 
   AnalysisConsumer(const Preprocessor &pp, const std::string &outdir,
                    AnalyzerOptionsRef opts, ArrayRef<std::string> plugins,
-                   CodeInjector *injector)
+                   CodeInjector *injector,
+                   CrossTUDefinitionSource *crossTU = nullptr,
+                   AnalysisResultCache *resultCache = nullptr)
       : RecVisitorMode(0), RecVisitorBR(nullptr), Ctx(nullptr), PP(pp),
         OutDir(outdir), Opts(std::move(opts)), Plugins(plugins),
-        Injector(injector) {
+        Injector(injector), CrossTU(crossTU), ResultCache(resultCache),
+        NumPathSensitiveReports(0),
+        ProfileOutput(Opts->Config.lookup("profile-output")) {
     DigestAnalyzerOptions();
     if (Opts->PrintStats) {
       llvm::EnableStatistics();
       TUTotalTimer = new llvm::Timer("Analyzer Total Time");
+      SetupTimer = new llvm::Timer("Analyzer Setup Time");
     }
   }
 
   ~AnalysisConsumer() override {
-    if (Opts->PrintStats)
+    // The consumers are owned by the analysis manager once it is created. If
+    // it never was, flush and destroy them here.
+    PathDiagnosticConsumer::FilesMade FilesMade;
+    for (PathDiagnosticConsumer *Consumer : PathConsumers) {
+      Consumer->FlushDiagnostics(&FilesMade);
+      delete Consumer;
+    }
+
+    if (Opts->PrintStats) {
       delete TUTotalTimer;
+      delete SetupTimer;
+    }
   }
 
   void DigestAnalyzerOptions() {
@@ -288,12 +347,29 @@ public:
 
   void Initialize(ASTContext &Context) override {
     Ctx = &Context;
+  }
+
+  /// \brief Register the checkers and create the analysis manager.
+  ///
+  /// This is deferred until the translation unit is about to be analyzed, so
+  /// that none of it is paid for when parsing fails or all checks are
+  /// disabled.
+  void createManagers() {
+    if (SetupTimer) SetupTimer->startTimer();
+
     checkerMgr = createCheckerManager(*Opts, PP.getLangOpts(), Plugins,
                                       PP.getDiagnostics());
+    if (!ProfileOutput.empty())
+      checkerMgr->enableProfiling();
 
+    // The analysis manager takes over the consumers.
     Mgr = llvm::make_unique<AnalysisManager>(
         *Ctx, PP.getDiagnostics(), PP.getLangOpts(), PathConsumers,
-        CreateStoreMgr, CreateConstraintMgr, checkerMgr.get(), *Opts, Injector);
+        CreateStoreMgr, CreateConstraintMgr, checkerMgr.get(), *Opts, Injector,
+        CrossTU.get());
+    PathConsumers.clear();
+
+    if (SetupTimer) SetupTimer->stopTimer();
   }
 
   /// \brief Store the top level decls in the set to be processed later on.
@@ -303,6 +379,10 @@ public:
 
   void HandleTranslationUnit(ASTContext &C) override;
 
+  /// \brief Write the profiles of the analyzed functions and of the checkers
+  /// to the profile-output file, as JSON.
+  void writeProfile();
+
   /// \brief Determine which inlining mode should be used when this function is
   /// analyzed. This allows to redefine the default inlining policies when
   /// analyzing a given function.
@@ -394,6 +474,7 @@ private:
 // AnalysisConsumer implementation.
 //===----------------------------------------------------------------------===//
 llvm::Timer* AnalysisConsumer::TUTotalTimer = nullptr;
+llvm::Timer* AnalysisConsumer::SetupTimer = nullptr;
 
 bool AnalysisConsumer::HandleTopLevelDecl(DeclGroupRef DG) {
   storeTopLevelDecls(DG);
@@ -469,8 +550,20 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   // inlined functions. The topological order allows the "do not reanalyze
   // previously inlined function" performance heuristic to be triggered more
   // often.
+  //
+  // With several shards, only every ShardCount'th node in that order is an
+  // entry point for this invocation; the other invocations take the rest. The
+  // order doesn't depend on the results of the analysis, so every node is the
+  // entry point of exactly one shard, which analyzes it unless it has been
+  // inlined into an earlier entry point of the same shard.
+  unsigned ShardCount = Opts->getShardCount();
+  unsigned ShardIndex = ShardCount > 1 ? Opts->getShardIndex() : 0;
+  unsigned NumEntryPoints = 0;
+
   SetOfConstDecls Visited;
   SetOfConstDecls VisitedAsTopLevel;
+  if (ResultCache)
+    ResultCache->initialize(*Ctx, CG);
   llvm::ReversePostOrderTraversal<clang::CallGraph*> RPOT(&CG);
   for (llvm::ReversePostOrderTraversal<clang::CallGraph*>::rpo_iterator
          I = RPOT.begin(), E = RPOT.end(); I != E; ++I) {
@@ -483,17 +576,42 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
     if (!D)
       continue;
 
+    // Leave the entry points of the other shards to them.
+    if (ShardCount > 1 && NumEntryPoints++ % ShardCount != ShardIndex)
+      continue;
+
     // Skip the functions which have been processed already or previously
     // inlined.
     if (shouldSkipFunction(D, Visited, VisitedAsTopLevel))
       continue;
 
+    // Skip the functions that had nothing to report the last time they were
+    // analyzed, if neither they nor anything they depend on have changed. The
+    // functions inlined into them then are considered visited as well.
+    SmallString<32> CacheKey;
+    if (ResultCache && ResultCache->getKey(N, CacheKey)) {
+      SmallVector<const Decl *, 8> Inlined;
+      if (ResultCache->lookup(CacheKey, Inlined)) {
+        for (const Decl *Callee : Inlined)
+          Visited.insert(isa<ObjCMethodDecl>(Callee)
+                             ? Callee
+                             : Callee->getCanonicalDecl());
+        VisitedAsTopLevel.insert(D);
+        NumFunctionsSkippedFromCache++;
+        continue;
+      }
+    }
+
     // Analyze the function.
     SetOfConstDecls VisitedCallees;
+    unsigned NumReportsBefore = NumPathSensitiveReports;
 
     HandleCode(D, AM_Path, getInliningModeForFunction(D, Visited),
                (Mgr->options.InliningMode == All ? nullptr : &VisitedCallees));
 
+    if (!CacheKey.empty() && NumPathSensitiveReports == NumReportsBefore)
+      ResultCache->insert(CacheKey, VisitedCallees);
+
     // Add the visited callees to the global visited set.
     for (const Decl *Callee : VisitedCallees)
       // Decls from CallGraph are already canonical. But Decls coming from
@@ -515,13 +633,21 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
   if (Opts->DisableAllChecks)
     return;
 
+  createManagers();
+
   {
     if (TUTotalTimer) TUTotalTimer->startTimer();
 
     // Introduce a scope to destroy BR before Mgr.
     BugReporter BR(*Mgr);
     TranslationUnitDecl *TU = C.getTranslationUnitDecl();
-    checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
+
+    // When the path-sensitive analysis is sharded, the first shard also runs
+    // the other checks, so that their reports aren't repeated by every shard.
+    bool RunASTChecks = !Mgr->shouldInlineCall() || Opts->getShardCount() < 2 ||
+                        Opts->getShardIndex() == 0;
+    if (RunASTChecks)
+      checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
 
     // Run the AST-only checks using the order in which functions are defined.
     // If inlining is not turned on, use the simplest function order for path
@@ -538,15 +664,17 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
     // random access.  By doing so, we automatically compensate for iterators
     // possibly being invalidated, although this is a bit slower.
     const unsigned LocalTUDeclsSize = LocalTUDecls.size();
-    for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i) {
-      TraverseDecl(LocalTUDecls[i]);
-    }
+    if (RunASTChecks)
+      for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i) {
+        TraverseDecl(LocalTUDecls[i]);
+      }
 
     if (Mgr->shouldInlineCall())
       HandleDeclsCallGraph(LocalTUDeclsSize);
 
     // After all decls handled, run checkers on the entire TranslationUnit.
-    checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
+    if (RunASTChecks)
+      checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
 
     RecVisitorBR = nullptr;
   }
@@ -559,6 +687,9 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
 
   if (TUTotalTimer) TUTotalTimer->stopTimer();
 
+  if (!ProfileOutput.empty())
+    writeProfile();
+
   // Count how many basic blocks we have not covered.
   NumBlocksInAnalyzedFunctions = FunctionSummaries.getTotalNumBasicBlocks();
   if (NumBlocksInAnalyzedFunctions > 0)
@@ -621,8 +752,9 @@ void AnalysisConsumer::HandleCode(Decl *D, AnalysisMode Mode,
     MaxCFGSize = MaxCFGSize < CFGSize ? CFGSize : MaxCFGSize;
   }
 
-  // Clear the AnalysisManager of old AnalysisDeclContexts.
-  Mgr->ClearContexts();
+  // The AnalysisDeclContexts, with their CFGs and liveness, are kept for the
+  // whole translation unit: the path-sensitive analysis and the inlining of
+  // the function into its callers all use the ones built here.
   BugReporter BR(*Mgr);
 
   if (Mode & AM_Syntax)
@@ -650,6 +782,10 @@ void AnalysisConsumer::ActionExprEngine(Decl *D, bool ObjCGCEnabled,
   if (!Mgr->getAnalysisDeclContext(D)->getAnalysis<RelaxedLiveVariables>())
     return;
 
+  double StartSeconds = 0;
+  if (!ProfileOutput.empty())
+    StartSeconds = llvm::TimeRecord::getCurrentTime(true).getProcessTime();
+
   ExprEngine Eng(*Mgr, ObjCGCEnabled, VisitedCallees, &FunctionSummaries,IMode);
 
   // Set the graph auditor.
@@ -660,8 +796,9 @@ void AnalysisConsumer::ActionExprEngine(Decl *D, bool ObjCGCEnabled,
   }
 
   // Execute the worklist algorithm.
-  Eng.ExecuteWorkList(Mgr->getAnalysisDeclContextManager().getStackFrame(D),
-                      Mgr->options.getMaxNodesPerTopLevelFunction());
+  bool WorkRemaining = Eng.ExecuteWorkList(
+      Mgr->getAnalysisDeclContextManager().getStackFrame(D),
+      Mgr->options.getMaxNodesPerTopLevelFunction());
 
   // Release the auditor (if any) so that it doesn't monitor the graph
   // created BugReporter.
@@ -672,7 +809,32 @@ void AnalysisConsumer::ActionExprEngine(Decl *D, bool ObjCGCEnabled,
     Eng.ViewGraph(Mgr->options.TrimGraph);
 
   // Display warnings.
-  Eng.getBugReporter().FlushReports();
+  BugReporter &BR = Eng.getBugReporter();
+  for (BugReporter::EQClasses_iterator I = BR.EQClasses_begin(),
+                                       E = BR.EQClasses_end();
+       I != E; ++I)
+    ++NumPathSensitiveReports;
+  BR.FlushReports();
+
+  if (!ProfileOutput.empty()) {
+    FunctionProfile Profile;
+    if (const NamedDecl *ND = dyn_cast<NamedDecl>(D))
+      Profile.Name = ND->getQualifiedNameAsString();
+    else
+      Profile.Name = "block";
+    PresumedLoc Loc =
+        Mgr->getSourceManager().getPresumedLoc(D->getLocation());
+    Profile.File = Loc.isValid() ? Loc.getFilename() : "";
+    Profile.Line = Loc.isValid() ? Loc.getLine() : 0;
+    Profile.IMode = IMode;
+    Profile.NumNodes = Eng.getGraph().size();
+    Profile.Seconds =
+        llvm::TimeRecord::getCurrentTime(false).getProcessTime() - StartSeconds;
+    Profile.ReachedMaxNodes = WorkRemaining;
+    Profile.NumBlockCountExceeded = Eng.getNumBlockCountExceeded();
+    Profile.NumInlineCountExceeded = Eng.getNumInlineCountExceeded();
+    FunctionProfiles.push_back(Profile);
+  }
 }
 
 void AnalysisConsumer::RunPathSensitiveChecks(Decl *D,
@@ -695,6 +857,71 @@ void AnalysisConsumer::RunPathSensitiveChecks(Decl *D,
   }
 }
 
+//===----------------------------------------------------------------------===//
+// Profiling.
+//===----------------------------------------------------------------------===//
+
+static void printJSONString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (unsigned char C : Str) {
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (C < 0x20)
+      OS << llvm::format("\\u%04x", C);
+    else
+      OS << C;
+  }
+  OS << '"';
+}
+
+void AnalysisConsumer::writeProfile() {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(ProfileOutput, EC, llvm::sys::fs::F_Text);
+  if (EC) {
+    llvm::errs() << "warning: could not create file: " << EC.message() << '\n';
+    return;
+  }
+
+  OS << "{\n  \"functions\": [";
+  for (unsigned I = 0, E = FunctionProfiles.size(); I != E; ++I) {
+    const FunctionProfile &P = FunctionProfiles[I];
+    OS << (I ? "," : "") << "\n    { \"name\": ";
+    printJSONString(OS, P.Name);
+    OS << ", \"file\": ";
+    printJSONString(OS, P.File);
+    OS << ", \"line\": " << P.Line << ", \"inlining\": \""
+       << (P.IMode == ExprEngine::Inline_Minimal ? "minimal" : "regular")
+       << "\", \"nodes\": " << P.NumNodes
+       << ", \"seconds\": " << llvm::format("%.6f", P.Seconds)
+       << ", \"reached_max_nodes\": "
+       << (P.ReachedMaxNodes ? "true" : "false")
+       << ", \"block_count_exceeded\": " << P.NumBlockCountExceeded
+       << ", \"inline_count_exceeded\": " << P.NumInlineCountExceeded
+       << " }";
+  }
+  OS << "\n  ],\n  \"checkers\": [";
+
+  // Several checks can share a checker object; their costs are reported
+  // together, under the name of the check that registered the checker.
+  typedef std::pair<StringRef, CheckerManager::CheckerProfile> CheckerEntry;
+  std::vector<CheckerEntry> Checkers;
+  for (const auto &Entry : checkerMgr->getCheckerProfiles())
+    Checkers.push_back(
+        std::make_pair(Entry.first->getCheckName().getName(), Entry.second));
+  std::sort(Checkers.begin(), Checkers.end(),
+            [](const CheckerEntry &A, const CheckerEntry &B) {
+              return A.first < B.first;
+            });
+  for (unsigned I = 0, E = Checkers.size(); I != E; ++I) {
+    OS << (I ? "," : "") << "\n    { \"name\": ";
+    printJSONString(OS, Checkers[I].first);
+    OS << ", \"calls\": " << Checkers[I].second.NumCalls
+       << ", \"seconds\": "
+       << llvm::format("%.6f", Checkers[I].second.Seconds) << " }";
+  }
+  OS << "\n  ]\n}\n";
+}
+
 //===----------------------------------------------------------------------===//
 // AnalysisConsumer creation.
 //===----------------------------------------------------------------------===//
@@ -706,11 +933,18 @@ ento::CreateAnalysisConsumer(CompilerInstance &CI) {
 
   AnalyzerOptionsRef analyzerOpts = CI.getAnalyzerOpts();
   bool hasModelPath = analyzerOpts->Config.count("model-path") > 0;
+  bool hasCrossTUDir = analyzerOpts->Config.count("ctu-dir") > 0;
+  // The cache can't tell when the definitions in other translation units
+  // change, so it isn't used with cross translation unit analysis.
+  bool hasResultCache =
+      analyzerOpts->Config.count("result-cache-dir") > 0 && !hasCrossTUDir;
 
   return llvm::make_unique<AnalysisConsumer>(
       CI.getPreprocessor(), CI.getFrontendOpts().OutputFile, analyzerOpts,
       CI.getFrontendOpts().Plugins,
-      hasModelPath ? new ModelInjector(CI) : nullptr);
+      hasModelPath ? new ModelInjector(CI) : nullptr,
+      hasCrossTUDir ? new CrossTUDefinitionLoader(CI) : nullptr,
+      hasResultCache ? new AnalysisResultCache(CI) : nullptr);
 }
 
 //===----------------------------------------------------------------------===//
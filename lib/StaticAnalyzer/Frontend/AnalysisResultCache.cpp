@@ -0,0 +1,274 @@
+//===-- AnalysisResultCache.cpp ---------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "AnalysisResultCache.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/Stmt.h"
+#include "clang/Analysis/CallGraph.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/Version.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Index/USRGeneration.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/StaticAnalyzer/Core/AnalyzerOptions.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace clang;
+using namespace ento;
+
+static std::string getHash(StringRef Content) {
+  llvm::MD5 Hash;
+  llvm::MD5::MD5Result MD5Res;
+  SmallString<32> Res;
+
+  Hash.update(Content);
+  Hash.final(MD5Res);
+  llvm::MD5::stringifyResult(MD5Res, Res);
+
+  return Res.str();
+}
+
+AnalysisResultCache::AnalysisResultCache(CompilerInstance &CI)
+    : Ctx(nullptr) {
+  AnalyzerOptions &Opts = *CI.getAnalyzerOpts();
+  Dir = Opts.Config["result-cache-dir"];
+
+  // The configuration is hashed before the analysis queries any option, so
+  // that only the options given on the command line are part of it.
+  std::string Config;
+  llvm::raw_string_ostream OS(Config);
+  OS << getClangFullVersion() << '\n'
+     << CI.getInvocation().getModuleHash() << '\n';
+  for (const auto &Checker : Opts.CheckersControlList)
+    OS << Checker.first << '=' << Checker.second << '\n';
+
+  std::vector<StringRef> Keys;
+  for (const auto &Entry : Opts.Config)
+    if (Entry.getKey() != "result-cache-dir")
+      Keys.push_back(Entry.getKey());
+  std::sort(Keys.begin(), Keys.end());
+  for (StringRef Key : Keys)
+    OS << Key << '=' << Opts.Config[Key] << '\n';
+
+  OS << Opts.AnalysisStoreOpt << ' ' << Opts.AnalysisConstraintsOpt << ' '
+     << Opts.AnalysisPurgeOpt << ' ' << Opts.AnalyzeSpecificFunction << ' '
+     << Opts.maxBlockVisitOnPath << ' ' << Opts.AnalyzeAll << ' '
+     << Opts.AnalyzeNestedBlocks << ' ' << Opts.eagerlyAssumeBinOpBifurcation
+     << ' ' << Opts.UnoptimizedCFG << ' ' << Opts.NoRetryExhausted << ' '
+     << Opts.InlineMaxStackDepth << ' ' << Opts.InliningMode << '\n';
+  ConfigHash = getHash(OS.str());
+}
+
+void AnalysisResultCache::initialize(ASTContext &Context, const CallGraph &CG) {
+  Ctx = &Context;
+  for (const auto &Entry : CG) {
+    const Decl *D = Entry.first;
+    SmallString<128> USR;
+    if (!D || index::generateUSRForDecl(D, USR))
+      continue;
+    USRs[D] = USR.str();
+    DeclsByUSR[USR] = D;
+  }
+  computeContextHash(CG);
+}
+
+void AnalysisResultCache::computeContextHash(const CallGraph &CG) {
+  SourceManager &SM = Ctx->getSourceManager();
+  std::string Context;
+  llvm::raw_string_ostream OS(Context);
+
+  // The included files are identified by their size and modification time,
+  // which is much cheaper than hashing their contents.
+  std::vector<std::string> Files;
+  for (SourceManager::fileinfo_iterator I = SM.fileinfo_begin(),
+                                        E = SM.fileinfo_end();
+       I != E; ++I) {
+    const FileEntry *File = I->first;
+    if (!File || File == SM.getFileEntryForID(SM.getMainFileID()))
+      continue;
+    std::string Info;
+    llvm::raw_string_ostream(Info) << File->getName() << ' '
+                                   << File->getSize() << ' '
+                                   << File->getModificationTime() << '\n';
+    Files.push_back(Info);
+  }
+  std::sort(Files.begin(), Files.end());
+  for (const std::string &Info : Files)
+    OS << Info;
+
+  // The bodies of the functions are part of the keys of the functions that
+  // use them, so leave them out of the main file; the rest of it, such as the
+  // types, the macros and the globals the functions use, affects them all.
+  FileID MainFID = SM.getMainFileID();
+  std::vector<std::pair<unsigned, unsigned>> Bodies;
+  for (const auto &Entry : CG) {
+    const Decl *D = Entry.first;
+    const Stmt *Body = D ? D->getBody() : nullptr;
+    if (!Body || Body->getLocStart().isMacroID() ||
+        Body->getLocEnd().isMacroID())
+      continue;
+    std::pair<FileID, unsigned> B = SM.getDecomposedLoc(Body->getLocStart());
+    std::pair<FileID, unsigned> E = SM.getDecomposedLoc(Body->getLocEnd());
+    if (B.first == MainFID && E.first == MainFID && B.second <= E.second)
+      Bodies.push_back(std::make_pair(B.second, E.second + 1));
+  }
+  std::sort(Bodies.begin(), Bodies.end());
+
+  StringRef MainText = SM.getBufferData(MainFID);
+  unsigned Pos = 0;
+  for (const auto &Range : Bodies) {
+    if (Range.first > Pos)
+      OS << MainText.slice(Pos, Range.first);
+    Pos = std::max(Pos, Range.second);
+  }
+  if (Pos < MainText.size())
+    OS << MainText.substr(Pos);
+
+  ContextHash = getHash(OS.str());
+}
+
+std::string AnalysisResultCache::getDeclHash(const Decl *D) {
+  auto It = DeclHashes.find(D);
+  if (It != DeclHashes.end())
+    return It->second;
+
+  std::string &Hash = DeclHashes[D];
+  auto USR = USRs.find(D);
+  if (USR == USRs.end())
+    return Hash;
+
+  // The call graph holds the canonical declarations of the functions; hash
+  // their definitions.
+  const Decl *Def = D;
+  if (const FunctionDecl *FD = dyn_cast<FunctionDecl>(D)) {
+    const FunctionDecl *Body;
+    if (FD->hasBody(Body))
+      Def = Body;
+  }
+
+  SourceManager &SM = Ctx->getSourceManager();
+  SourceLocation B = SM.getExpansionLoc(Def->getLocStart());
+  SourceLocation E = SM.getExpansionLoc(Def->getLocEnd());
+  if (B.isInvalid() || E.isInvalid() || SM.getFileID(B) != SM.getFileID(E))
+    return Hash;
+  StringRef Text = Lexer::getSourceText(CharSourceRange::getTokenRange(B, E),
+                                        SM, Ctx->getLangOpts());
+  if (Text.empty())
+    return Hash;
+
+  Hash = getHash(USR->second + '\n' + Text.str());
+  return Hash;
+}
+
+bool AnalysisResultCache::getKey(const CallGraphNode *N,
+                                 SmallVectorImpl<char> &Key) {
+  Key.clear();
+  std::string RootHash = getDeclHash(N->getDecl());
+  if (RootHash.empty())
+    return false;
+
+  // Collect the hashes of every function the function may call, directly or
+  // not, in an order that doesn't depend on the order of the calls.
+  std::vector<const CallGraphNode *> Worklist(1, N);
+  llvm::SmallPtrSet<const CallGraphNode *, 16> Seen;
+  Seen.insert(N);
+  std::vector<std::string> CalleeHashes;
+  while (!Worklist.empty()) {
+    const CallGraphNode *Caller = Worklist.back();
+    Worklist.pop_back();
+    for (const CallGraphNode *Callee : *Caller) {
+      if (!Seen.insert(Callee).second)
+        continue;
+      std::string CalleeHash = getDeclHash(Callee->getDecl());
+      if (CalleeHash.empty())
+        return false;
+      CalleeHashes.push_back(CalleeHash);
+      Worklist.push_back(Callee);
+    }
+  }
+  std::sort(CalleeHashes.begin(), CalleeHashes.end());
+
+  std::string Content = ConfigHash + ContextHash + RootHash;
+  for (const std::string &CalleeHash : CalleeHashes)
+    Content += CalleeHash;
+  std::string Hash = getHash(Content);
+  Key.append(Hash.begin(), Hash.end());
+  return true;
+}
+
+bool AnalysisResultCache::lookup(StringRef Key,
+                                 SmallVectorImpl<const Decl *> &Inlined) {
+  SmallString<128> Path(Dir);
+  llvm::sys::path::append(Path, Key);
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return false;
+
+  // An entry that names a function which is no longer in the translation unit
+  // can't be used, as the key would have changed with it.
+  SmallVector<StringRef, 8> Lines;
+  Buffer.get()->getBuffer().split(Lines, '\n', -1, /*KeepEmpty=*/false);
+  SmallVector<const Decl *, 8> Decls;
+  for (StringRef USR : Lines) {
+    auto It = DeclsByUSR.find(USR);
+    if (It == DeclsByUSR.end())
+      return false;
+    Decls.push_back(It->second);
+  }
+  Inlined.append(Decls.begin(), Decls.end());
+  return true;
+}
+
+void AnalysisResultCache::insert(StringRef Key,
+                                 const SetOfConstDecls &Inlined) {
+  std::vector<StringRef> InlinedUSRs;
+  for (const Decl *D : Inlined) {
+    auto It = USRs.find(D);
+    if (It == USRs.end())
+      It = USRs.find(D->getCanonicalDecl());
+    if (It == USRs.end())
+      return;
+    InlinedUSRs.push_back(It->second);
+  }
+  std::sort(InlinedUSRs.begin(), InlinedUSRs.end());
+
+  // Write the entry to a temporary file first, so that other runs sharing the
+  // directory never see a partial entry.
+  if (llvm::sys::fs::create_directories(Dir))
+    return;
+  SmallString<128> Model(Dir);
+  llvm::sys::path::append(Model, Key + "-%%%%%%.tmp");
+  int FD;
+  SmallString<128> TempPath;
+  if (llvm::sys::fs::createUniqueFile(Model, FD, TempPath))
+    return;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    for (StringRef USR : InlinedUSRs)
+      OS << USR << '\n';
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return;
+    }
+  }
+
+  SmallString<128> Path(Dir);
+  llvm::sys::path::append(Path, Key);
+  if (llvm::sys::fs::rename(TempPath, Path))
+    llvm::sys::fs::remove(TempPath);
+}
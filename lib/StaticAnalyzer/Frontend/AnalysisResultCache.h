@@ -0,0 +1,90 @@
+//===-- AnalysisResultCache.h -----------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief This file defines the clang::ento::AnalysisResultCache class, which
+/// remembers, across runs of the analyzer, the top level functions whose
+/// path-sensitive analysis found nothing to report.
+///
+/// The cache lives in the directory given by the result-cache-dir
+/// configuration option. Each entry is a file named after a hash of the
+/// function, of the functions it transitively calls, of the rest of the
+/// translation unit and of the analyzer configuration, so an entry is only
+/// found again when none of them has changed. The file lists the USRs of the
+/// functions that were inlined into the function, which the analysis then
+/// considers visited just as if it had analyzed the function again.
+///
+/// Functions with reports are never cached, and are always analyzed again, so
+/// that their reports are emitted by every run.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_SA_FRONTEND_ANALYSISRESULTCACHE_H
+#define LLVM_CLANG_SA_FRONTEND_ANALYSISRESULTCACHE_H
+
+#include "clang/StaticAnalyzer/Core/PathSensitive/FunctionSummary.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include <string>
+
+namespace clang {
+
+class ASTContext;
+class CallGraph;
+class CallGraphNode;
+class CompilerInstance;
+class Decl;
+
+namespace ento {
+class AnalysisResultCache {
+public:
+  AnalysisResultCache(CompilerInstance &CI);
+
+  /// \brief Prepare the cache for the analysis of the functions in the given
+  /// call graph. This must be called before any of the other methods.
+  void initialize(ASTContext &Ctx, const CallGraph &CG);
+
+  /// \brief Compute the key of the function of the given node. Returns false
+  /// if the function can't be cached.
+  bool getKey(const CallGraphNode *N, SmallVectorImpl<char> &Key);
+
+  /// \brief Look up the entry with the given key. If there is one, return true
+  /// and add the functions that were inlined into the cached function to
+  /// \p Inlined.
+  bool lookup(StringRef Key, SmallVectorImpl<const Decl *> &Inlined);
+
+  /// \brief Record that the analysis of the function with the given key found
+  /// nothing to report, and inlined the given functions.
+  void insert(StringRef Key, const SetOfConstDecls &Inlined);
+
+private:
+  /// \brief Return the hash of the USR and text of the given function, or an
+  /// empty string if it has neither.
+  std::string getDeclHash(const Decl *D);
+
+  /// \brief Hash everything the results depend on other than the analyzed
+  /// functions: the files the main file includes and the main file without
+  /// the bodies of its functions.
+  void computeContextHash(const CallGraph &CG);
+
+  std::string Dir;
+  std::string ConfigHash;
+  std::string ContextHash;
+  ASTContext *Ctx;
+
+  /// The hash of each function in the call graph, and its USR.
+  llvm::DenseMap<const Decl *, std::string> DeclHashes;
+  llvm::DenseMap<const Decl *, std::string> USRs;
+  llvm::StringMap<const Decl *> DeclsByUSR;
+};
+}
+}
+
+#endif
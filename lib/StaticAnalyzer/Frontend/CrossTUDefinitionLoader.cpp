@@ -0,0 +1,148 @@
+//===-- CrossTUDefinitionLoader.cpp -----------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CrossTUDefinitionLoader.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/ASTImporter.h"
+#include "clang/AST/Decl.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Index/USRGeneration.h"
+#include "clang/StaticAnalyzer/Core/AnalyzerOptions.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+
+using namespace clang;
+using namespace ento;
+
+CrossTUDefinitionLoader::CrossTUDefinitionLoader(CompilerInstance &CI)
+    : CI(CI), IndexLoaded(false) {
+  int Max = CI.getAnalyzerOpts()->getOptionAsInteger("ctu-max-loaded-asts", 8);
+  MaxLoadedASTs = Max > 0 ? Max : 1;
+}
+
+CrossTUDefinitionLoader::~CrossTUDefinitionLoader() {}
+
+void CrossTUDefinitionLoader::loadIndex() {
+  if (IndexLoaded)
+    return;
+  IndexLoaded = true;
+
+  AnalyzerOptionsRef Opts = CI.getAnalyzerOpts();
+  SmallString<128> IndexPath(Opts->Config["ctu-dir"]);
+  StringRef IndexName =
+      Opts->getOptionAsString("ctu-index-name", "externalFnMap.txt");
+  llvm::sys::path::append(IndexPath, IndexName);
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(IndexPath);
+  if (!Buffer)
+    return;
+
+  // Each line is a USR, a space, and the path of the AST file. USRs have no
+  // spaces, but paths may.
+  SmallVector<StringRef, 64> Lines;
+  (*Buffer)->getBuffer().split(Lines, '\n', -1, /*KeepEmpty=*/false);
+  for (StringRef Line : Lines) {
+    std::pair<StringRef, StringRef> Entry = Line.rtrim().split(' ');
+    if (!Entry.first.empty() && !Entry.second.empty())
+      Index.insert(std::make_pair(Entry.first, Entry.second.str()));
+  }
+}
+
+/// Find the definition of the function with the given USR among the
+/// declarations in DC and in the namespaces and classes inside it.
+static const FunctionDecl *findDefinition(const DeclContext *DC,
+                                          StringRef USR) {
+  for (const Decl *D : DC->decls()) {
+    if (const auto *FD = dyn_cast<FunctionDecl>(D)) {
+      const FunctionDecl *Def;
+      SmallString<128> DefUSR;
+      if (FD->hasBody(Def) && !index::generateUSRForDecl(Def, DefUSR) &&
+          DefUSR == USR)
+        return Def;
+      continue;
+    }
+    if (isa<NamespaceDecl>(D) || isa<LinkageSpecDecl>(D) ||
+        isa<CXXRecordDecl>(D))
+      if (const FunctionDecl *Def =
+              findDefinition(cast<DeclContext>(D), USR))
+        return Def;
+  }
+  return nullptr;
+}
+
+const FunctionDecl *
+CrossTUDefinitionLoader::importDefinition(StringRef USR, StringRef ASTFile) {
+  SmallString<128> Path(CI.getAnalyzerOpts()->Config["ctu-dir"]);
+  llvm::sys::path::append(Path, ASTFile);
+
+  auto I = LoadedASTs.begin(), E = LoadedASTs.end();
+  while (I != E && I->Path != Path)
+    ++I;
+
+  if (I != E) {
+    LoadedASTs.splice(LoadedASTs.begin(), LoadedASTs, I);
+  } else {
+    // A unit that can't be loaded simply doesn't provide any definitions, so
+    // don't report why.
+    IntrusiveRefCntPtr<DiagnosticsEngine> Diags(new DiagnosticsEngine(
+        CI.getDiagnostics().getDiagnosticIDs(), &CI.getDiagnosticOpts(),
+        new IgnoringDiagConsumer(), /*ShouldOwnClient=*/true));
+    std::unique_ptr<ASTUnit> Unit = ASTUnit::LoadFromASTFile(
+        Path.str(), CI.getPCHContainerReader(), Diags, CI.getFileSystemOpts());
+    if (!Unit ||
+        Unit->getASTContext().getLangOpts().CPlusPlus !=
+            CI.getASTContext().getLangOpts().CPlusPlus)
+      return nullptr;
+
+    // Make room by unloading the least recently used AST. What has been
+    // imported from it stays valid; it belongs to this ASTContext.
+    if (LoadedASTs.size() >= MaxLoadedASTs)
+      LoadedASTs.pop_back();
+
+    LoadedASTs.emplace_front();
+    LoadedAST &AST = LoadedASTs.front();
+    AST.Path = Path.str();
+    AST.Importer = llvm::make_unique<ASTImporter>(
+        CI.getASTContext(), CI.getFileManager(), Unit->getASTContext(),
+        Unit->getFileManager(), /*MinimalImport=*/false);
+    AST.Unit = std::move(Unit);
+  }
+
+  LoadedAST &AST = LoadedASTs.front();
+  const FunctionDecl *Def = findDefinition(
+      AST.Unit->getASTContext().getTranslationUnitDecl(), USR);
+  if (!Def)
+    return nullptr;
+
+  auto *ToDef = cast_or_null<FunctionDecl>(
+      AST.Importer->Import(const_cast<FunctionDecl *>(Def)));
+  if (!ToDef || !ToDef->hasBody())
+    return nullptr;
+  return ToDef;
+}
+
+const FunctionDecl *
+CrossTUDefinitionLoader::getDefinition(const FunctionDecl *FD) {
+  FD = FD->getCanonicalDecl();
+  auto Known = Definitions.find(FD);
+  if (Known != Definitions.end())
+    return Known->second;
+
+  // Only functions with external linkage can be defined elsewhere.
+  const FunctionDecl *Def = nullptr;
+  SmallString<128> USR;
+  if (FD->isExternallyVisible() && !index::generateUSRForDecl(FD, USR)) {
+    loadIndex();
+    auto It = Index.find(USR);
+    if (It != Index.end())
+      Def = importDefinition(USR, It->second);
+  }
+  return Definitions[FD] = Def;
+}
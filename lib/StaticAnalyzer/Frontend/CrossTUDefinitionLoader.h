@@ -0,0 +1,81 @@
+//===-- CrossTUDefinitionLoader.h -------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief This file defines the clang::ento::CrossTUDefinitionLoader class
+/// which implements the clang::ento::CrossTUDefinitionSource interface. This
+/// class imports the definitions of functions from the serialized ASTs of
+/// other translation units.
+///
+/// The ASTs are found through an index in the directory given by the ctu-dir
+/// configuration option. Each line of the index holds the USR of a function
+/// and the path, relative to that directory, of an AST file that defines it.
+/// ASTs are loaded on demand, and only the most recently used ones are kept
+/// loaded, so that the analysis of a translation unit that calls into many
+/// others doesn't hold all of them in memory at once.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_SA_FRONTEND_CROSSTUDEFINITIONLOADER_H
+#define LLVM_CLANG_SA_FRONTEND_CROSSTUDEFINITIONLOADER_H
+
+#include "clang/StaticAnalyzer/Core/CrossTUDefinitionSource.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include <list>
+#include <memory>
+#include <string>
+
+namespace clang {
+
+class ASTImporter;
+class ASTUnit;
+class CompilerInstance;
+
+namespace ento {
+class CrossTUDefinitionLoader : public CrossTUDefinitionSource {
+public:
+  CrossTUDefinitionLoader(CompilerInstance &CI);
+  ~CrossTUDefinitionLoader() override;
+
+  const FunctionDecl *getDefinition(const FunctionDecl *FD) override;
+
+private:
+  /// \brief Read the index of the ctu-dir directory, if it hasn't been read
+  /// yet.
+  void loadIndex();
+
+  /// \brief Import the definition of the function with the given USR from the
+  /// given AST file, loading the file if it isn't loaded already.
+  const FunctionDecl *importDefinition(StringRef USR, StringRef ASTFile);
+
+  CompilerInstance &CI;
+
+  /// The AST file that defines each function in the index, by USR.
+  llvm::StringMap<std::string> Index;
+  bool IndexLoaded;
+
+  struct LoadedAST {
+    std::string Path;
+    std::unique_ptr<ASTUnit> Unit;
+    std::unique_ptr<ASTImporter> Importer;
+  };
+
+  /// The loaded ASTs, most recently used first.
+  std::list<LoadedAST> LoadedASTs;
+  unsigned MaxLoadedASTs;
+
+  /// The result of each lookup, by canonical declaration, including the
+  /// failed ones.
+  llvm::DenseMap<const FunctionDecl *, const FunctionDecl *> Definitions;
+};
+}
+}
+
+#endif
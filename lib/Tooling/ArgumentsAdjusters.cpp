@@ -74,6 +74,24 @@ ArgumentsAdjuster getInsertArgumentAdjuster(const char *Extra,
   return getInsertArgumentAdjuster(CommandLineArguments(1, Extra), Pos);
 }
 
+ArgumentsAdjuster getIncludePCHAdjuster(StringRef Header, StringRef PCHFile) {
+  std::string HeaderStr = Header, PCHFileStr = PCHFile;
+  return [HeaderStr, PCHFileStr](const CommandLineArguments &Args,
+                                 StringRef /*unused*/) {
+    CommandLineArguments AdjustedArgs(Args);
+    for (size_t i = 1, e = AdjustedArgs.size(); i + 1 < e; ++i) {
+      StringRef Arg = AdjustedArgs[i];
+      if ((Arg == "-include" || Arg == "--include") &&
+          AdjustedArgs[i + 1] == HeaderStr) {
+        AdjustedArgs[i] = "-include-pch";
+        AdjustedArgs[i + 1] = PCHFileStr;
+        break;
+      }
+    }
+    return AdjustedArgs;
+  };
+}
+
 ArgumentsAdjuster combineAdjusters(ArgumentsAdjuster First,
                                    ArgumentsAdjuster Second) {
   return [First, Second](const CommandLineArguments &Args, StringRef File) {
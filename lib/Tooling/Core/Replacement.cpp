@@ -249,11 +249,49 @@ bool applyAllReplacements(const std::vector<Replacement> &Replaces,
   return Result;
 }
 
+/// \brief Apply \p Replaces to \p Code in a single pass, unless they overlap.
+///
+/// \returns false if the replacements can't be applied this way.
+static bool applyReplacementsInBatch(StringRef Code,
+                                     const Replacements &Replaces,
+                                     std::string &Result) {
+  std::vector<RewriteBuffer::Edit> Edits;
+  Edits.reserve(Replaces.size());
+  unsigned End = 0;
+  for (const Replacement &R : Replaces) {
+    if (R.getOffset() + R.getLength() > Code.size())
+      return false;
+    // Replacements are ordered by offset, and longer ones come first at the
+    // same offset.  Anything but an insertion after another replacement at
+    // the same offset overlaps it.
+    if (!Edits.empty() &&
+        (R.getOffset() == Edits.back().OrigOffset ? R.getLength() != 0
+                                                  : R.getOffset() < End))
+      return false;
+    Edits.push_back({R.getOffset(), R.getLength(), R.getReplacementText()});
+    End = std::max(End, R.getOffset() + R.getLength());
+  }
+
+  RewriteBuffer Buffer;
+  Buffer.Initialize(Code);
+  Buffer.ReplaceTextBatch(Edits);
+  llvm::raw_string_ostream OS(Result);
+  Buffer.write(OS);
+  OS.flush();
+  return true;
+}
+
 llvm::Expected<std::string> applyAllReplacements(StringRef Code,
                                                 const Replacements &Replaces) {
   if (Replaces.empty())
     return Code.str();
 
+  // Large sets of replacements, such as those of a rename touching every call
+  // site, would spend most of their time splitting the rewrite rope.
+  std::string BatchResult;
+  if (applyReplacementsInBatch(Code, Replaces, BatchResult))
+    return BatchResult;
+
   IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFileSystem(
       new vfs::InMemoryFileSystem);
   FileManager Files(FileSystemOptions(), InMemoryFileSystem);
@@ -357,9 +395,13 @@ public:
   MergedReplacement(const Replacement &R, bool MergeSecond, int D)
       : MergeSecond(MergeSecond), Delta(D), FilePath(R.getFilePath()),
         Offset(R.getOffset() + (MergeSecond ? 0 : Delta)), Length(R.getLength()),
-        Text(R.getReplacementText()) {
-    Delta += MergeSecond ? 0 : Text.size() - Length;
-    DeltaFirst = MergeSecond ? Text.size() - Length : 0;
+        PendingStart(0) {
+    StringRef RText = R.getReplacementText();
+    // Elements from 'Second' can change all of the text of an element from
+    // 'First', but nothing of an element from 'Second'.
+    (MergeSecond ? Pending : Text) = RText.str();
+    Delta += MergeSecond ? 0 : RText.size() - Length;
+    DeltaFirst = MergeSecond ? RText.size() - Length : 0;
   }
 
   // Merges the next element 'R' into this merged element. As we always merge
@@ -368,21 +410,25 @@ public:
   void merge(const Replacement &R) {
     if (MergeSecond) {
       unsigned REnd = R.getOffset() + Delta + R.getLength();
-      unsigned End = Offset + Text.size();
+      unsigned End = Offset + textSize();
       if (REnd > End) {
         Length += REnd - End;
         MergeSecond = false;
       }
-      StringRef TextRef = Text;
-      StringRef Head = TextRef.substr(0, R.getOffset() + Delta - Offset);
-      StringRef Tail = TextRef.substr(REnd - Offset);
-      Text = (Head + R.getReplacementText() + Tail).str();
-      Delta += R.getReplacementText().size() - R.getLength();
+      // Elements from 'Second' have strictly increasing offsets, so 'R' starts
+      // in the pending text and only that needs to be moved.
+      unsigned Head = R.getOffset() + Delta - Offset - Text.size();
+      Text.append(Pending, PendingStart, Head);
+      PendingStart =
+          std::min<size_t>(PendingStart + Head + R.getLength(), Pending.size());
+      StringRef RText = R.getReplacementText();
+      Text.append(RText.begin(), RText.end());
+      Delta += RText.size() - R.getLength();
     } else {
       unsigned End = Offset + Length;
       StringRef RText = R.getReplacementText();
       StringRef Tail = RText.substr(End - R.getOffset());
-      Text = (Text + Tail).str();
+      Pending.append(Tail.begin(), Tail.end());
       if (R.getOffset() + RText.size() > End) {
         Length = R.getOffset() + R.getLength() - Offset;
         MergeSecond = true;
@@ -397,16 +443,22 @@ public:
   // doesn't need to be merged.
   bool endsBefore(const Replacement &R) const {
     if (MergeSecond)
-      return Offset + Text.size() < R.getOffset() + Delta;
+      return Offset + textSize() < R.getOffset() + Delta;
     return Offset + Length < R.getOffset();
   }
 
   // Returns 'true' if an element from the second set should be merged next.
   bool mergeSecond() const { return MergeSecond; }
   int deltaFirst() const { return DeltaFirst; }
-  Replacement asReplacement() const { return {FilePath, Offset, Length, Text}; }
+  Replacement asReplacement() const {
+    return {FilePath, Offset, Length, Text + Pending.substr(PendingStart)};
+  }
 
 private:
+  unsigned textSize() const {
+    return Text.size() + Pending.size() - PendingStart;
+  }
+
   bool MergeSecond;
 
   // Amount of characters that elements from 'Second' need to be shifted by in
@@ -423,7 +475,13 @@ private:
   const StringRef FilePath;
   const unsigned Offset;
   unsigned Length;
+  // The replacement text is 'Text' followed by 'Pending' from 'PendingStart'
+  // on. 'Text' can no longer be changed by elements from 'Second'. Both only
+  // grow at their end, so merging n elements takes linear rather than
+  // quadratic time in the size of the text.
   std::string Text;
+  std::string Pending;
+  size_t PendingStart;
 };
 } // namespace
 
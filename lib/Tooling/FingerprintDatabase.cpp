@@ -0,0 +1,179 @@
+//===--- FingerprintDatabase.cpp - Skip unchanged compile commands --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the FingerprintDatabase class.
+//
+// The database is a text file with one line per compile command, holding the
+// key of the command and its fingerprint, followed by one line per file the
+// command read, indented by a tab.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Tooling/FingerprintDatabase.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace clang {
+namespace tooling {
+
+static std::string getHash(llvm::MD5 &Hash) {
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Str;
+  llvm::MD5::stringifyResult(Result, Str);
+  return Str.str();
+}
+
+/// \brief Add \p Str to \p Hash, terminated so that consecutive strings
+/// cannot run into each other.
+static void addString(llvm::MD5 &Hash, StringRef Str) {
+  Hash.update(Str);
+  Hash.update(StringRef("", 1));
+}
+
+bool FingerprintDatabase::load(StringRef Path, std::string &ErrorMessage) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer) {
+    if (Buffer.getError() == std::errc::no_such_file_or_directory)
+      return true;
+    ErrorMessage = "Error while opening fingerprint database: " +
+                   Buffer.getError().message();
+    return false;
+  }
+
+  SmallVector<StringRef, 64> Lines;
+  (*Buffer)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                               /*KeepEmpty=*/false);
+  Entry *Current = nullptr;
+  for (StringRef Line : Lines) {
+    if (Line.startswith("\t")) {
+      if (!Current) {
+        ErrorMessage = "Error while parsing fingerprint database: file "
+                       "without compile command";
+        return false;
+      }
+      Current->Files.push_back(Line.substr(1));
+      continue;
+    }
+    std::pair<StringRef, StringRef> KeyAndFingerprint = Line.split(' ');
+    if (KeyAndFingerprint.second.empty()) {
+      ErrorMessage = "Error while parsing fingerprint database: expected a "
+                     "key and a fingerprint";
+      return false;
+    }
+    Current = &Entries[KeyAndFingerprint.first];
+    Current->Fingerprint = KeyAndFingerprint.second;
+    Current->Files.clear();
+  }
+  return true;
+}
+
+bool FingerprintDatabase::save(StringRef Path,
+                               std::string &ErrorMessage) const {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::F_Text);
+  if (EC) {
+    ErrorMessage = "Error while writing fingerprint database: " + EC.message();
+    return false;
+  }
+  for (const auto &E : Entries) {
+    OS << E.getKey() << ' ' << E.getValue().Fingerprint << '\n';
+    for (const std::string &File : E.getValue().Files)
+      OS << '\t' << File << '\n';
+  }
+  return true;
+}
+
+std::string
+FingerprintDatabase::getKey(StringRef Directory,
+                            ArrayRef<std::string> CommandLine) const {
+  llvm::MD5 Hash;
+  addString(Hash, ToolName);
+  addString(Hash, Directory);
+  for (const std::string &Arg : CommandLine)
+    addString(Hash, Arg);
+  return getHash(Hash);
+}
+
+StringRef FingerprintDatabase::getFileHash(StringRef File,
+                                           vfs::FileSystem &FS) {
+  // A file that cannot be read hashes to the empty string, which no contents
+  // hash to, so that the fingerprint changes once it can be read again.
+  llvm::ErrorOr<vfs::Status> Status = FS.status(File);
+  if (!Status) {
+    FileHashes.erase(File);
+    return StringRef();
+  }
+
+  FileHash &Cached = FileHashes[File];
+  if (!Cached.Hash.empty() && Cached.UniqueID == Status->getUniqueID() &&
+      Cached.ModificationTime == Status->getLastModificationTime() &&
+      Cached.Size == Status->getSize())
+    return Cached.Hash;
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      FS.getBufferForFile(File);
+  if (!Buffer) {
+    FileHashes.erase(File);
+    return StringRef();
+  }
+
+  llvm::MD5 Hash;
+  Hash.update((*Buffer)->getBuffer());
+  Cached.UniqueID = Status->getUniqueID();
+  Cached.ModificationTime = Status->getLastModificationTime();
+  Cached.Size = Status->getSize();
+  Cached.Hash = getHash(Hash);
+  return Cached.Hash;
+}
+
+std::string FingerprintDatabase::getFingerprint(StringRef Key,
+                                                ArrayRef<std::string> Files,
+                                                vfs::FileSystem &FS) {
+  llvm::MD5 Hash;
+  addString(Hash, Key);
+  for (const std::string &File : Files) {
+    addString(Hash, File);
+    addString(Hash, getFileHash(File, FS));
+  }
+  return getHash(Hash);
+}
+
+bool FingerprintDatabase::isUpToDate(StringRef Directory,
+                                     ArrayRef<std::string> CommandLine,
+                                     vfs::FileSystem &FS) {
+  std::string Key = getKey(Directory, CommandLine);
+  auto It = Entries.find(Key);
+  if (It == Entries.end())
+    return false;
+  return getFingerprint(Key, It->getValue().Files, FS) ==
+         It->getValue().Fingerprint;
+}
+
+void FingerprintDatabase::recordSuccess(StringRef Directory,
+                                        ArrayRef<std::string> CommandLine,
+                                        ArrayRef<std::string> Files,
+                                        vfs::FileSystem &FS) {
+  std::string Key = getKey(Directory, CommandLine);
+  Entry &E = Entries[Key];
+  E.Files = Files.vec();
+  E.Fingerprint = getFingerprint(Key, E.Files, FS);
+}
+
+void FingerprintDatabase::recordFailure(StringRef Directory,
+                                        ArrayRef<std::string> CommandLine) {
+  Entries.erase(getKey(Directory, CommandLine));
+}
+
+} // end namespace tooling
+} // end namespace clang
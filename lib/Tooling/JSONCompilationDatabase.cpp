@@ -15,8 +15,12 @@
 #include "clang/Tooling/CompilationDatabase.h"
 #include "clang/Tooling/CompilationDatabasePluginRegistry.h"
 #include "clang/Tooling/Tooling.h"
+#include "clang/Basic/CharInfo.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 #include <system_error>
 
 namespace clang {
@@ -141,6 +145,10 @@ X("json-compilation-database", "Reads JSON formatted compilation databases");
 // and thus register the JSONCompilationDatabasePlugin.
 volatile int JSONAnchorSource = 0;
 
+/// \brief Identifies the index files written by writeIndex().
+static const char IndexMagic[] = "JSONCDB1";
+static const size_t IndexMagicSize = sizeof(IndexMagic) - 1;
+
 std::unique_ptr<JSONCompilationDatabase>
 JSONCompilationDatabase::loadFromFile(StringRef FilePath,
                                       std::string &ErrorMessage) {
@@ -152,8 +160,32 @@ JSONCompilationDatabase::loadFromFile(StringRef FilePath,
   }
   std::unique_ptr<JSONCompilationDatabase> Database(
       new JSONCompilationDatabase(std::move(*DatabaseBuffer)));
+
+  // Without the status of the database, an index can't be validated.
+  llvm::sys::fs::file_status Status;
+  if (llvm::sys::fs::status(FilePath, Status)) {
+    if (!Database->parse(ErrorMessage))
+      return nullptr;
+    return Database;
+  }
+  llvm::sys::TimeValue MTime = Status.getLastModificationTime();
+  uint64_t ModificationTime =
+      MTime.toEpochTime() * llvm::sys::TimeValue::NANOSECONDS_PER_SECOND +
+      MTime.nanoseconds();
+
+  std::string IndexPath = (FilePath + ".index").str();
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> IndexBuffer =
+      llvm::MemoryBuffer::getFile(IndexPath, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (IndexBuffer &&
+      Database->readIndex((*IndexBuffer)->getBuffer(), ModificationTime,
+                          Status.getSize()))
+    return Database;
+
   if (!Database->parse(ErrorMessage))
     return nullptr;
+  // The index is only a cache; the database works without it.
+  Database->writeIndex(IndexPath, ModificationTime, Status.getSize());
   return Database;
 }
 
@@ -176,10 +208,10 @@ JSONCompilationDatabase::getCompileCommands(StringRef FilePath) const {
 
   std::string Error;
   llvm::raw_string_ostream ES(Error);
-  StringRef Match = MatchTrie.findEquivalent(NativeFilePath, ES);
+  StringRef Match = getMatchTrie().findEquivalent(NativeFilePath, ES);
   if (Match.empty())
     return std::vector<CompileCommand>();
-  llvm::StringMap< std::vector<CompileCommandRef> >::const_iterator
+  llvm::StringMap< std::vector<unsigned> >::const_iterator
     CommandsRefI = IndexByFile.find(Match);
   if (CommandsRefI == IndexByFile.end())
     return std::vector<CompileCommand>();
@@ -192,9 +224,9 @@ std::vector<std::string>
 JSONCompilationDatabase::getAllFiles() const {
   std::vector<std::string> Result;
 
-  llvm::StringMap< std::vector<CompileCommandRef> >::const_iterator
+  llvm::StringMap< std::vector<unsigned> >::const_iterator
     CommandsRefI = IndexByFile.begin();
-  const llvm::StringMap< std::vector<CompileCommandRef> >::const_iterator
+  const llvm::StringMap< std::vector<unsigned> >::const_iterator
     CommandsRefEnd = IndexByFile.end();
   for (; CommandsRefI != CommandsRefEnd; ++CommandsRefI) {
     Result.push_back(CommandsRefI->first().str());
@@ -205,11 +237,24 @@ JSONCompilationDatabase::getAllFiles() const {
 
 std::vector<CompileCommand>
 JSONCompilationDatabase::getAllCompileCommands() const {
+  std::vector<unsigned> CommandIndices(
+      LoadedFromIndex ? CommandRanges.size() : AllCommands.size());
+  for (unsigned I = 0, E = CommandIndices.size(); I != E; ++I)
+    CommandIndices[I] = I;
   std::vector<CompileCommand> Commands;
-  getCommands(AllCommands, Commands);
+  getCommands(CommandIndices, Commands);
   return Commands;
 }
 
+const FileMatchTrie &JSONCompilationDatabase::getMatchTrie() const {
+  if (!MatchTrieBuilt) {
+    for (const auto &File : IndexByFile)
+      MatchTrie.insert(File.getKey());
+    MatchTrieBuilt = true;
+  }
+  return MatchTrie;
+}
+
 static std::vector<std::string>
 nodeToCommandLine(const std::vector<llvm::yaml::ScalarNode *> &Nodes) {
   SmallString<1024> Storage;
@@ -224,16 +269,137 @@ nodeToCommandLine(const std::vector<llvm::yaml::ScalarNode *> &Nodes) {
 }
 
 void JSONCompilationDatabase::getCommands(
-    ArrayRef<CompileCommandRef> CommandsRef,
+    ArrayRef<unsigned> CommandIndices,
     std::vector<CompileCommand> &Commands) const {
-  for (int I = 0, E = CommandsRef.size(); I != E; ++I) {
+  for (unsigned Index : CommandIndices) {
     SmallString<8> DirectoryStorage;
     SmallString<32> FilenameStorage;
+    if (!LoadedFromIndex) {
+      const CompileCommandRef &CommandRef = AllCommands[Index];
+      Commands.emplace_back(
+        std::get<0>(CommandRef)->getValue(DirectoryStorage),
+        std::get<1>(CommandRef)->getValue(FilenameStorage),
+        nodeToCommandLine(std::get<2>(CommandRef)));
+      continue;
+    }
+
+    // Parse only the JSON object of this compile command. It was valid when
+    // the index was written, as the index matches the database.
+    llvm::SourceMgr CommandSM;
+    llvm::yaml::Stream CommandStream(
+        Database->getBuffer().substr(CommandRanges[Index].first,
+                                     CommandRanges[Index].second),
+        CommandSM);
+    llvm::yaml::document_iterator I = CommandStream.begin();
+    if (I == CommandStream.end())
+      continue;
+    auto *Object = dyn_cast_or_null<llvm::yaml::MappingNode>(I->getRoot());
+    CompileCommandRef CommandRef;
+    std::string ErrorMessage;
+    if (!Object || !parseCompileCommand(Object, CommandRef, ErrorMessage))
+      continue;
     Commands.emplace_back(
-      std::get<0>(CommandsRef[I])->getValue(DirectoryStorage),
-      std::get<1>(CommandsRef[I])->getValue(FilenameStorage),
-      nodeToCommandLine(std::get<2>(CommandsRef[I])));
+      std::get<0>(CommandRef)->getValue(DirectoryStorage),
+      std::get<1>(CommandRef)->getValue(FilenameStorage),
+      nodeToCommandLine(std::get<2>(CommandRef)));
+  }
+}
+
+bool JSONCompilationDatabase::parseCompileCommand(
+    llvm::yaml::MappingNode *Object, CompileCommandRef &CommandRef,
+    std::string &ErrorMessage, const char **FirstKeyStart) {
+  llvm::yaml::ScalarNode *Directory = nullptr;
+  llvm::Optional<std::vector<llvm::yaml::ScalarNode *>> Command;
+  llvm::yaml::ScalarNode *File = nullptr;
+  for (auto& NextKeyValue : *Object) {
+    llvm::yaml::ScalarNode *KeyString =
+        dyn_cast<llvm::yaml::ScalarNode>(NextKeyValue.getKey());
+    if (!KeyString) {
+      ErrorMessage = "Expected strings as key.";
+      return false;
+    }
+    if (FirstKeyStart && !*FirstKeyStart)
+      *FirstKeyStart = KeyString->getRawValue().data();
+    SmallString<10> KeyStorage;
+    StringRef KeyValue = KeyString->getValue(KeyStorage);
+    llvm::yaml::Node *Value = NextKeyValue.getValue();
+    if (!Value) {
+      ErrorMessage = "Expected value.";
+      return false;
+    }
+    llvm::yaml::ScalarNode *ValueString =
+        dyn_cast<llvm::yaml::ScalarNode>(Value);
+    llvm::yaml::SequenceNode *SequenceString =
+        dyn_cast<llvm::yaml::SequenceNode>(Value);
+    if (KeyValue == "arguments" && !SequenceString) {
+      ErrorMessage = "Expected sequence as value.";
+      return false;
+    } else if (KeyValue != "arguments" && !ValueString) {
+      ErrorMessage = "Expected string as value.";
+      return false;
+    }
+    if (KeyValue == "directory") {
+      Directory = ValueString;
+    } else if (KeyValue == "arguments") {
+      Command = std::vector<llvm::yaml::ScalarNode *>();
+      for (auto &Argument : *SequenceString) {
+        auto Scalar = dyn_cast<llvm::yaml::ScalarNode>(&Argument);
+        if (!Scalar) {
+          ErrorMessage = "Only strings are allowed in 'arguments'.";
+          return false;
+        }
+        Command->push_back(Scalar);
+      }
+    } else if (KeyValue == "command") {
+      if (!Command)
+        Command = std::vector<llvm::yaml::ScalarNode *>(1, ValueString);
+    } else if (KeyValue == "file") {
+      File = ValueString;
+    } else {
+      ErrorMessage = ("Unknown key: \"" +
+                      KeyString->getRawValue() + "\"").str();
+      return false;
+    }
+  }
+  if (!File) {
+    ErrorMessage = "Missing key: \"file\".";
+    return false;
   }
+  if (!Command) {
+    ErrorMessage = "Missing key: \"command\" or \"arguments\".";
+    return false;
+  }
+  if (!Directory) {
+    ErrorMessage = "Missing key: \"directory\".";
+    return false;
+  }
+  CommandRef = CompileCommandRef(Directory, File, *Command);
+  return true;
+}
+
+/// \brief Returns the offset of the '{' opening the JSON object whose first
+/// key starts at \p KeyStart, or StringRef::npos if there is none.
+static size_t findObjectStart(StringRef Buffer, const char *KeyStart) {
+  size_t Pos = KeyStart - Buffer.data();
+  while (Pos > 0 && isWhitespace(Buffer[Pos - 1]))
+    --Pos;
+  if (Pos == 0 || Buffer[Pos - 1] != '{')
+    return StringRef::npos;
+  return Pos - 1;
+}
+
+/// \brief Returns the offset past the '}' closing the JSON object that
+/// precedes the separator ending at \p End.
+static size_t findObjectEnd(StringRef Buffer, size_t End) {
+  while (End > 0 && isWhitespace(Buffer[End - 1]))
+    --End;
+  if (End > 0 && Buffer[End - 1] == ',')
+    --End;
+  while (End > 0 && isWhitespace(Buffer[End - 1]))
+    --End;
+  if (End == 0 || Buffer[End - 1] != '}')
+    return StringRef::npos;
+  return End;
 }
 
 bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
@@ -252,75 +418,22 @@ bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
     ErrorMessage = "Expected array.";
     return false;
   }
+  StringRef Buffer = Database->getBuffer();
+  // The offsets of the JSON objects of the compile commands; the objects
+  // are delimited once the next one is found.
+  std::vector<size_t> CommandStarts;
   for (auto& NextObject : *Array) {
     llvm::yaml::MappingNode *Object = dyn_cast<llvm::yaml::MappingNode>(&NextObject);
     if (!Object) {
       ErrorMessage = "Expected object.";
       return false;
     }
-    llvm::yaml::ScalarNode *Directory = nullptr;
-    llvm::Optional<std::vector<llvm::yaml::ScalarNode *>> Command;
-    llvm::yaml::ScalarNode *File = nullptr;
-    for (auto& NextKeyValue : *Object) {
-      llvm::yaml::ScalarNode *KeyString =
-          dyn_cast<llvm::yaml::ScalarNode>(NextKeyValue.getKey());
-      if (!KeyString) {
-        ErrorMessage = "Expected strings as key.";
-        return false;
-      }
-      SmallString<10> KeyStorage;
-      StringRef KeyValue = KeyString->getValue(KeyStorage);
-      llvm::yaml::Node *Value = NextKeyValue.getValue();
-      if (!Value) {
-        ErrorMessage = "Expected value.";
-        return false;
-      }
-      llvm::yaml::ScalarNode *ValueString =
-          dyn_cast<llvm::yaml::ScalarNode>(Value);
-      llvm::yaml::SequenceNode *SequenceString =
-          dyn_cast<llvm::yaml::SequenceNode>(Value);
-      if (KeyValue == "arguments" && !SequenceString) {
-        ErrorMessage = "Expected sequence as value.";
-        return false;
-      } else if (KeyValue != "arguments" && !ValueString) {
-        ErrorMessage = "Expected string as value.";
-        return false;
-      }
-      if (KeyValue == "directory") {
-        Directory = ValueString;
-      } else if (KeyValue == "arguments") {
-        Command = std::vector<llvm::yaml::ScalarNode *>();
-        for (auto &Argument : *SequenceString) {
-          auto Scalar = dyn_cast<llvm::yaml::ScalarNode>(&Argument);
-          if (!Scalar) {
-            ErrorMessage = "Only strings are allowed in 'arguments'.";
-            return false;
-          }
-          Command->push_back(Scalar);
-        }
-      } else if (KeyValue == "command") {
-        if (!Command)
-          Command = std::vector<llvm::yaml::ScalarNode *>(1, ValueString);
-      } else if (KeyValue == "file") {
-        File = ValueString;
-      } else {
-        ErrorMessage = ("Unknown key: \"" +
-                        KeyString->getRawValue() + "\"").str();
-        return false;
-      }
-    }
-    if (!File) {
-      ErrorMessage = "Missing key: \"file\".";
-      return false;
-    }
-    if (!Command) {
-      ErrorMessage = "Missing key: \"command\" or \"arguments\".";
-      return false;
-    }
-    if (!Directory) {
-      ErrorMessage = "Missing key: \"directory\".";
+    CompileCommandRef Cmd;
+    const char *FirstKeyStart = nullptr;
+    if (!parseCompileCommand(Object, Cmd, ErrorMessage, &FirstKeyStart))
       return false;
-    }
+    llvm::yaml::ScalarNode *Directory = std::get<0>(Cmd);
+    llvm::yaml::ScalarNode *File = std::get<1>(Cmd);
     SmallString<8> FileStorage;
     StringRef FileName = File->getValue(FileStorage);
     SmallString<128> NativeFilePath;
@@ -333,10 +446,113 @@ bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
     } else {
       llvm::sys::path::native(FileName, NativeFilePath);
     }
-    auto Cmd = CompileCommandRef(Directory, File, *Command);
-    IndexByFile[NativeFilePath].push_back(Cmd);
+    IndexByFile[NativeFilePath].push_back(AllCommands.size());
     AllCommands.push_back(Cmd);
-    MatchTrie.insert(NativeFilePath);
+    CommandStarts.push_back(findObjectStart(Buffer, FirstKeyStart));
+  }
+
+  // Delimit the objects by the start of the next one, or by the end of the
+  // array for the last one.
+  size_t ArrayEnd = Buffer.rfind(']');
+  if (ArrayEnd == StringRef::npos)
+    return true;
+  for (size_t I = 0, E = CommandStarts.size(); I != E; ++I) {
+    size_t Start = CommandStarts[I];
+    size_t Next = I + 1 == E ? ArrayEnd : CommandStarts[I + 1];
+    size_t End =
+        Next == StringRef::npos ? Next : findObjectEnd(Buffer, Next);
+    if (Start == StringRef::npos || End == StringRef::npos || End <= Start) {
+      CommandRanges.clear();
+      break;
+    }
+    CommandRanges.push_back(std::make_pair(Start, End - Start));
+  }
+  return true;
+}
+
+bool JSONCompilationDatabase::readIndex(StringRef IndexContents,
+                                        uint64_t ModificationTime,
+                                        uint64_t Size) {
+  using namespace llvm::support;
+  const unsigned char *Data = IndexContents.bytes_begin();
+  const unsigned char *End = IndexContents.bytes_end();
+  if (IndexContents.size() < IndexMagicSize + 8 + 8 + 4 ||
+      !IndexContents.startswith(StringRef(IndexMagic, IndexMagicSize)))
+    return false;
+  Data += IndexMagicSize;
+  if (endian::readNext<uint64_t, little, unaligned>(Data) !=
+          ModificationTime ||
+      endian::readNext<uint64_t, little, unaligned>(Data) != Size)
+    return false;
+
+  uint32_t NumCommands = endian::readNext<uint32_t, little, unaligned>(Data);
+  std::vector<std::pair<uint64_t, uint64_t>> Ranges;
+  llvm::StringMap<std::vector<unsigned>> Files;
+  for (uint32_t I = 0; I != NumCommands; ++I) {
+    if (End - Data < 8 + 8 + 4)
+      return false;
+    uint64_t Offset = endian::readNext<uint64_t, little, unaligned>(Data);
+    uint64_t Length = endian::readNext<uint64_t, little, unaligned>(Data);
+    uint32_t PathLength = endian::readNext<uint32_t, little, unaligned>(Data);
+    if (Offset > Size || Length > Size - Offset ||
+        uint64_t(End - Data) < PathLength)
+      return false;
+    StringRef Path(reinterpret_cast<const char *>(Data), PathLength);
+    Data += PathLength;
+    Files[Path].push_back(I);
+    Ranges.push_back(std::make_pair(Offset, Length));
+  }
+  if (Data != End || Size != Database->getBufferSize())
+    return false;
+
+  IndexByFile = std::move(Files);
+  CommandRanges = std::move(Ranges);
+  LoadedFromIndex = true;
+  return true;
+}
+
+bool JSONCompilationDatabase::writeIndex(StringRef IndexPath,
+                                         uint64_t ModificationTime,
+                                         uint64_t Size) const {
+  if (CommandRanges.size() != AllCommands.size())
+    return false;
+
+  // Write to a temporary file and rename it, so that concurrent loads never
+  // see a partial index.
+  SmallString<128> TempPath(IndexPath);
+  TempPath += "-%%%%%%%%";
+  int FD;
+  if (llvm::sys::fs::createUniqueFile(TempPath, FD, TempPath))
+    return false;
+
+  {
+    llvm::raw_fd_ostream Out(FD, /*shouldClose=*/true);
+    llvm::support::endian::Writer<llvm::support::little> Writer(Out);
+    Out << StringRef(IndexMagic, IndexMagicSize);
+    Writer.write<uint64_t>(ModificationTime);
+    Writer.write<uint64_t>(Size);
+    Writer.write<uint32_t>(AllCommands.size());
+    std::vector<StringRef> Paths(AllCommands.size());
+    for (const auto &File : IndexByFile)
+      for (unsigned Index : File.getValue())
+        Paths[Index] = File.getKey();
+    for (size_t I = 0, E = AllCommands.size(); I != E; ++I) {
+      Writer.write<uint64_t>(CommandRanges[I].first);
+      Writer.write<uint64_t>(CommandRanges[I].second);
+      Writer.write<uint32_t>(Paths[I].size());
+      Out << Paths[I];
+    }
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return false;
+    }
+  }
+
+  if (llvm::sys::fs::rename(TempPath, IndexPath)) {
+    llvm::sys::fs::remove(TempPath);
+    return false;
   }
   return true;
 }
@@ -14,23 +14,32 @@
 
 #include "clang/Tooling/Tooling.h"
 #include "clang/AST/ASTConsumer.h"
+#include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Driver/Compilation.h"
 #include "clang/Driver/Driver.h"
 #include "clang/Driver/Tool.h"
 #include "clang/Driver/ToolChain.h"
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendActions.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Tooling/ArgumentsAdjusters.h"
 #include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/FingerprintDatabase.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Option/Option.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <utility>
 
 #define DEBUG_TYPE "clang-tooling"
@@ -321,7 +330,7 @@ ClangTool::ClangTool(const CompilationDatabase &Compilations,
       OverlayFileSystem(new vfs::OverlayFileSystem(vfs::getRealFileSystem())),
       InMemoryFileSystem(new vfs::InMemoryFileSystem),
       Files(new FileManager(FileSystemOptions(), OverlayFileSystem)),
-      DiagConsumer(nullptr) {
+      DiagConsumer(nullptr), Fingerprints(nullptr), UseSharedPCH(false) {
   OverlayFileSystem->pushOverlay(InMemoryFileSystem);
   appendArgumentsAdjuster(getClangStripOutputAdjuster());
   appendArgumentsAdjuster(getClangSyntaxOnlyAdjuster());
@@ -357,6 +366,159 @@ static void injectResourceDir(CommandLineArguments &Args, const char *Argv0,
                  CompilerInvocation::GetResourcesPath(Argv0, MainAddr));
 }
 
+namespace {
+
+/// \brief A vfs::FileSystem that records the absolute paths of the files
+/// opened through it, which are the inputs of a compile command.
+class RecordingFileSystem : public vfs::FileSystem {
+  IntrusiveRefCntPtr<vfs::FileSystem> Base;
+  llvm::StringSet<> Seen;
+
+public:
+  explicit RecordingFileSystem(IntrusiveRefCntPtr<vfs::FileSystem> Base)
+      : Base(std::move(Base)) {}
+
+  /// \brief The files opened so far, in the order they were first opened.
+  std::vector<std::string> Files;
+
+  llvm::ErrorOr<vfs::Status> status(const Twine &Path) override {
+    return Base->status(Path);
+  }
+  llvm::ErrorOr<std::unique_ptr<vfs::File>>
+  openFileForRead(const Twine &Path) override {
+    auto F = Base->openFileForRead(Path);
+    if (!F)
+      return F;
+    SmallString<256> Absolute;
+    Path.toVector(Absolute);
+    if (!llvm::sys::path::is_absolute(Absolute)) {
+      if (llvm::ErrorOr<std::string> CWD = Base->getCurrentWorkingDirectory()) {
+        SmallString<256> Relative(Absolute);
+        Absolute = *CWD;
+        llvm::sys::path::append(Absolute, Relative);
+      }
+    }
+    llvm::sys::path::remove_dots(Absolute, /*remove_dot_dot=*/false);
+    if (Seen.insert(Absolute).second)
+      Files.push_back(Absolute.str());
+    return F;
+  }
+  vfs::directory_iterator dir_begin(const Twine &Dir,
+                                    std::error_code &EC) override {
+    return Base->dir_begin(Dir, EC);
+  }
+  std::error_code setCurrentWorkingDirectory(const Twine &Path) override {
+    return Base->setCurrentWorkingDirectory(Path);
+  }
+  llvm::ErrorOr<std::string> getCurrentWorkingDirectory() const override {
+    return Base->getCurrentWorkingDirectory();
+  }
+};
+
+/// \brief A precompiled header built by ClangTool::run() for the compile
+/// commands that pull in the same header first with otherwise identical
+/// arguments.
+struct SharedPCH {
+  /// \brief The number of compile commands that can use it.
+  unsigned Uses = 0;
+  /// \brief Whether building it was attempted.
+  bool Attempted = false;
+  /// \brief The precompiled header, or empty if it could not be built.
+  std::string File;
+  /// \brief The files read while building it.
+  std::vector<std::string> Inputs;
+};
+
+/// \brief Builds a precompiled header from the first \c -include of a compile
+/// command instead of processing its main file.
+class GenerateSharedPCHActionFactory : public FrontendActionFactory {
+  std::string OutputFile;
+
+public:
+  explicit GenerateSharedPCHActionFactory(StringRef OutputFile)
+      : OutputFile(OutputFile) {}
+
+  FrontendAction *create() override { return new GeneratePCHAction; }
+
+  bool runInvocation(CompilerInvocation *Invocation, FileManager *Files,
+                     std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+                     DiagnosticConsumer *DiagConsumer) override {
+    FrontendOptions &FrontendOpts = Invocation->getFrontendOpts();
+    PreprocessorOptions &PPOpts = Invocation->getPreprocessorOpts();
+    if (FrontendOpts.Inputs.size() != 1 || PPOpts.Includes.empty())
+      return false;
+
+    // The remaining -include options are processed after the precompiled
+    // header by the compile commands that use it, so leave them out.
+    InputKind Kind = FrontendOpts.Inputs[0].getKind();
+    FrontendOpts.Inputs[0] = FrontendInputFile(PPOpts.Includes.front(), Kind);
+    PPOpts.Includes.clear();
+    FrontendOpts.OutputFile = OutputFile;
+    FrontendOpts.ProgramAction = frontend::GeneratePCH;
+    return FrontendActionFactory::runInvocation(
+        Invocation, Files, std::move(PCHContainerOps), DiagConsumer);
+  }
+};
+
+} // end anonymous namespace
+
+/// \brief Returns the header that \p CommandLine pulls in first with
+/// \c -include, or an empty string if there is none or the command already
+/// uses a precompiled header.
+static StringRef getFirstInclude(const CommandLineArguments &CommandLine) {
+  StringRef Header;
+  for (size_t I = 1, E = CommandLine.size(); I + 1 < E; ++I) {
+    StringRef Arg = CommandLine[I];
+    if (Arg == "-include-pch")
+      return StringRef();
+    if (Header.empty() && (Arg == "-include" || Arg == "--include"))
+      Header = CommandLine[I + 1];
+  }
+  return Header;
+}
+
+/// \brief Returns a key that is equal for compile commands that can share a
+/// precompiled header, i.e. that only differ in their main file.
+static std::string getSharedPCHKey(const CompileCommand &Command,
+                                   const CommandLineArguments &CommandLine) {
+  std::string Key = Command.Directory;
+  for (const std::string &Arg : CommandLine) {
+    Key += '\0';
+    if (Arg != Command.Filename)
+      Key += Arg;
+  }
+  return Key;
+}
+
+/// \brief Builds \p PCH for \p CommandLine, leaving its file empty if that
+/// fails; the compile commands then parse the header themselves.
+static void
+buildSharedPCH(SharedPCH &PCH, const CommandLineArguments &CommandLine,
+               IntrusiveRefCntPtr<vfs::FileSystem> FS,
+               std::shared_ptr<PCHContainerOperations> PCHContainerOps) {
+  PCH.Attempted = true;
+  SmallString<128> Path;
+  if (llvm::sys::fs::createTemporaryFile("clang-tool", "pch", Path))
+    return;
+
+  IntrusiveRefCntPtr<RecordingFileSystem> RecordingFS(
+      new RecordingFileSystem(std::move(FS)));
+  IntrusiveRefCntPtr<FileManager> PCHFiles(
+      new FileManager(FileSystemOptions(), RecordingFS));
+  GenerateSharedPCHActionFactory Action(Path);
+  // Errors in the header are reported by the compile commands themselves.
+  IgnoringDiagConsumer IgnoreDiagnostics;
+  ToolInvocation Invocation(CommandLine, &Action, PCHFiles.get(),
+                            std::move(PCHContainerOps));
+  Invocation.setDiagnosticConsumer(&IgnoreDiagnostics);
+  if (!Invocation.run()) {
+    llvm::sys::fs::remove(Path);
+    return;
+  }
+  PCH.File = Path.str();
+  PCH.Inputs = std::move(RecordingFS->Files);
+}
+
 int ClangTool::run(ToolAction *Action) {
   // Exists solely for the purpose of lookup of the resource path.
   // This just needs to be some symbol in the binary.
@@ -376,6 +538,22 @@ int ClangTool::run(ToolAction *Action) {
             MappedFile.first, 0,
             llvm::MemoryBuffer::getMemBuffer(MappedFile.second));
 
+  // Count the compile commands that could share each precompiled header, so
+  // that none is built for a header only one compile command includes.
+  llvm::StringMap<SharedPCH> SharedPCHs;
+  if (UseSharedPCH) {
+    for (const auto &SourcePath : SourcePaths) {
+      for (const CompileCommand &CompileCommand :
+           Compilations.getCompileCommands(getAbsolutePath(SourcePath))) {
+        std::vector<std::string> CommandLine = CompileCommand.CommandLine;
+        if (ArgsAdjuster)
+          CommandLine = ArgsAdjuster(CommandLine, CompileCommand.Filename);
+        if (!getFirstInclude(CommandLine).empty())
+          ++SharedPCHs[getSharedPCHKey(CompileCommand, CommandLine)].Uses;
+      }
+    }
+  }
+
   bool ProcessingFailed = false;
   for (const auto &SourcePath : SourcePaths) {
     std::string File(getAbsolutePath(SourcePath));
@@ -426,6 +604,18 @@ int ClangTool::run(ToolAction *Action) {
         CommandLine = ArgsAdjuster(CommandLine, CompileCommand.Filename);
       assert(!CommandLine.empty());
 
+      SharedPCH *PCH = nullptr;
+      StringRef PCHHeader;
+      if (UseSharedPCH) {
+        PCHHeader = getFirstInclude(CommandLine);
+        if (!PCHHeader.empty()) {
+          auto It =
+              SharedPCHs.find(getSharedPCHKey(CompileCommand, CommandLine));
+          if (It != SharedPCHs.end() && It->getValue().Uses > 1)
+            PCH = &It->getValue();
+        }
+      }
+
       // Add the resource dir based on the binary of this tool. argv[0] in the
       // compilation database may refer to a different compiler and we want to
       // pick up the very same standard library that compiler is using. The
@@ -436,17 +626,63 @@ int ClangTool::run(ToolAction *Action) {
       // pass in made-up names here. Make sure this works on other platforms.
       injectResourceDir(CommandLine, "clang_tool", &StaticSymbol);
 
-      // FIXME: We need a callback mechanism for the tool writer to output a
-      // customized message for each file.
-      DEBUG({ llvm::dbgs() << "Processing: " << File << ".\n"; });
-      ToolInvocation Invocation(std::move(CommandLine), Action, Files.get(),
-                                PCHContainerOps);
-      Invocation.setDiagnosticConsumer(DiagConsumer);
-
-      if (!Invocation.run()) {
-        // FIXME: Diagnostics should be used instead.
-        llvm::errs() << "Error while processing " << File << ".\n";
-        ProcessingFailed = true;
+      if (Fingerprints && Fingerprints->isUpToDate(CompileCommand.Directory,
+                                                   CommandLine,
+                                                   *OverlayFileSystem)) {
+        DEBUG({ llvm::dbgs() << "Skipping up-to-date: " << File << ".\n"; });
+      } else {
+        // Record the files this compile command reads. They only go through
+        // the file system if the file manager has not seen them before, so
+        // each compile command gets a file manager of its own.
+        IntrusiveRefCntPtr<RecordingFileSystem> RecordingFS;
+        IntrusiveRefCntPtr<FileManager> CommandFiles = Files;
+        std::vector<std::string> Arguments;
+        if (Fingerprints) {
+          RecordingFS = new RecordingFileSystem(OverlayFileSystem);
+          CommandFiles = new FileManager(FileSystemOptions(), RecordingFS);
+          Arguments = CommandLine;
+        }
+
+        // The precompiled header is built by the first compile command that
+        // uses it, so that it sees the same working directory and mapped
+        // files.
+        if (PCH && !PCH->Attempted)
+          buildSharedPCH(*PCH, CommandLine, OverlayFileSystem,
+                         PCHContainerOps);
+        if (PCH && !PCH->File.empty())
+          CommandLine = getIncludePCHAdjuster(PCHHeader, PCH->File)(
+              CommandLine, CompileCommand.Filename);
+        else
+          PCH = nullptr;
+
+        // FIXME: We need a callback mechanism for the tool writer to output a
+        // customized message for each file.
+        DEBUG({ llvm::dbgs() << "Processing: " << File << ".\n"; });
+        ToolInvocation Invocation(std::move(CommandLine), Action,
+                                  CommandFiles.get(), PCHContainerOps);
+        Invocation.setDiagnosticConsumer(DiagConsumer);
+
+        if (Invocation.run()) {
+          if (Fingerprints) {
+            // The precompiled header only lives as long as this run; record
+            // the files it was built from instead.
+            std::vector<std::string> Inputs;
+            for (std::string &Input : RecordingFS->Files)
+              if (!PCH || Input != PCH->File)
+                Inputs.push_back(std::move(Input));
+            if (PCH)
+              Inputs.insert(Inputs.end(), PCH->Inputs.begin(),
+                            PCH->Inputs.end());
+            Fingerprints->recordSuccess(CompileCommand.Directory, Arguments,
+                                        Inputs, *OverlayFileSystem);
+          }
+        } else {
+          // FIXME: Diagnostics should be used instead.
+          llvm::errs() << "Error while processing " << File << ".\n";
+          ProcessingFailed = true;
+          if (Fingerprints)
+            Fingerprints->recordFailure(CompileCommand.Directory, Arguments);
+        }
       }
       // Return to the initial directory to correctly resolve next file by
       // relative path.
@@ -455,6 +691,222 @@ int ClangTool::run(ToolAction *Action) {
                                  Twine(InitialDirectory) + "\n!");
     }
   }
+
+  for (const auto &PCH : SharedPCHs)
+    if (!PCH.getValue().File.empty())
+      llvm::sys::fs::remove(PCH.getValue().File);
+  return ProcessingFailed ? 1 : 0;
+}
+
+namespace {
+
+/// \brief A vfs::File that reports a different name than the one it was
+/// opened with.
+class RenamedFile : public vfs::File {
+  std::unique_ptr<vfs::File> Underlying;
+  std::string Name;
+
+public:
+  RenamedFile(std::unique_ptr<vfs::File> Underlying, std::string Name)
+      : Underlying(std::move(Underlying)), Name(std::move(Name)) {}
+
+  llvm::ErrorOr<vfs::Status> status() override {
+    llvm::ErrorOr<vfs::Status> S = Underlying->status();
+    if (!S)
+      return S;
+    return vfs::Status::copyWithNewName(*S, Name);
+  }
+  llvm::ErrorOr<std::string> getName() override {
+    return Underlying->getName();
+  }
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+  getBuffer(const Twine &Name, int64_t FileSize, bool RequiresNullTerminator,
+            bool IsVolatile) override {
+    return Underlying->getBuffer(Name, FileSize, RequiresNullTerminator,
+                                 IsVolatile);
+  }
+  std::error_code close() override { return Underlying->close(); }
+};
+
+/// \brief A file system that resolves relative paths against its own working
+/// directory instead of the process-wide one.
+///
+/// This allows several compile commands with different directories to be
+/// processed at the same time without calling chdir.
+class WorkingDirectoryFileSystem : public vfs::FileSystem {
+  IntrusiveRefCntPtr<vfs::FileSystem> Base;
+  std::string WorkingDirectory;
+
+  std::string resolve(const Twine &Path) const {
+    SmallString<256> Resolved;
+    Path.toVector(Resolved);
+    if (!llvm::sys::path::is_absolute(Resolved)) {
+      SmallString<256> Relative(Resolved);
+      Resolved = WorkingDirectory;
+      llvm::sys::path::append(Resolved, Relative);
+    }
+    return Resolved.str();
+  }
+
+public:
+  WorkingDirectoryFileSystem(IntrusiveRefCntPtr<vfs::FileSystem> Base,
+                             StringRef WorkingDirectory)
+      : Base(std::move(Base)), WorkingDirectory(WorkingDirectory) {}
+
+  llvm::ErrorOr<vfs::Status> status(const Twine &Path) override {
+    std::string Name = Path.str();
+    llvm::ErrorOr<vfs::Status> S = Base->status(resolve(Name));
+    if (!S)
+      return S;
+    return vfs::Status::copyWithNewName(*S, Name);
+  }
+  llvm::ErrorOr<std::unique_ptr<vfs::File>>
+  openFileForRead(const Twine &Path) override {
+    std::string Name = Path.str();
+    auto F = Base->openFileForRead(resolve(Name));
+    if (!F)
+      return F.getError();
+    return std::unique_ptr<vfs::File>(
+        new RenamedFile(std::move(*F), std::move(Name)));
+  }
+  vfs::directory_iterator dir_begin(const Twine &Dir,
+                                    std::error_code &EC) override {
+    return Base->dir_begin(resolve(Dir), EC);
+  }
+  std::error_code setCurrentWorkingDirectory(const Twine &Path) override {
+    WorkingDirectory = resolve(Path);
+    return std::error_code();
+  }
+  llvm::ErrorOr<std::string> getCurrentWorkingDirectory() const override {
+    return WorkingDirectory;
+  }
+};
+
+/// \brief A single compile command scheduled by ClangTool::runParallel.
+struct ParallelCompileJob {
+  std::string File;
+  std::string Directory;
+  std::vector<std::string> CommandLine;
+  /// \brief The buffered diagnostics of this compile command.
+  std::string Output;
+  bool Failed = false;
+};
+
+} // end anonymous namespace
+
+int ClangTool::runParallel(ToolAction *Action, unsigned Jobs) {
+  if (Jobs < 2 || DiagConsumer || Fingerprints || UseSharedPCH)
+    return run(Action);
+
+  // Exists solely for the purpose of lookup of the resource path.
+  // This just needs to be some symbol in the binary.
+  static int StaticSymbol;
+
+  llvm::SmallString<128> InitialDirectory;
+  if (std::error_code EC = llvm::sys::fs::current_path(InitialDirectory))
+    llvm::report_fatal_error("Cannot detect current path: " +
+                             Twine(EC.message()));
+
+  // Query the compilation database and run the argument adjusters up front on
+  // this thread; neither of them is required to be thread-safe.
+  //
+  // FIXME: This calls getCompileCommands for all files before running the
+  // tool on any of them, which breaks compilation databases that prepare the
+  // file system state for the file they are queried for (see run()).
+  std::vector<ParallelCompileJob> CompileJobs;
+  for (const auto &SourcePath : SourcePaths) {
+    std::string File(getAbsolutePath(SourcePath));
+    std::vector<CompileCommand> CompileCommandsForFile =
+        Compilations.getCompileCommands(File);
+    if (CompileCommandsForFile.empty()) {
+      llvm::errs() << "Skipping " << File << ". Compile command not found.\n";
+      continue;
+    }
+    for (CompileCommand &CompileCommand : CompileCommandsForFile) {
+      ParallelCompileJob Job;
+      Job.File = File;
+      SmallString<128> Directory(CompileCommand.Directory);
+      if (!llvm::sys::path::is_absolute(Directory)) {
+        Directory = InitialDirectory;
+        llvm::sys::path::append(Directory, CompileCommand.Directory);
+      }
+      Job.Directory = Directory.str();
+      Job.CommandLine = std::move(CompileCommand.CommandLine);
+      if (ArgsAdjuster)
+        Job.CommandLine =
+            ArgsAdjuster(Job.CommandLine, CompileCommand.Filename);
+      assert(!Job.CommandLine.empty());
+      injectResourceDir(Job.CommandLine, "clang_tool", &StaticSymbol);
+      CompileJobs.push_back(std::move(Job));
+    }
+  }
+
+  // Share the results of stat calls on system and project headers between
+  // all workers.
+  IntrusiveRefCntPtr<SharedStatCacheStorage> StatCacheStorage(
+      new SharedStatCacheStorage);
+  std::atomic<unsigned> NextJob(0);
+  auto Worker = [&]() {
+    IntrusiveRefCntPtr<vfs::OverlayFileSystem> WorkerFileSystem(
+        new vfs::OverlayFileSystem(new WorkingDirectoryFileSystem(
+            vfs::getRealFileSystem(), InitialDirectory)));
+    IntrusiveRefCntPtr<vfs::InMemoryFileSystem> WorkerInMemoryFileSystem(
+        new vfs::InMemoryFileSystem);
+    WorkerFileSystem->pushOverlay(WorkerInMemoryFileSystem);
+    IntrusiveRefCntPtr<FileManager> WorkerFiles(
+        new FileManager(FileSystemOptions(), WorkerFileSystem));
+    llvm::StringSet<> WorkerSeenDirectories;
+
+    for (const auto &MappedFile : MappedFileContents)
+      if (llvm::sys::path::is_absolute(MappedFile.first))
+        WorkerInMemoryFileSystem->addFile(
+            MappedFile.first, 0,
+            llvm::MemoryBuffer::getMemBuffer(MappedFile.second));
+
+    for (unsigned I = NextJob++; I < CompileJobs.size(); I = NextJob++) {
+      ParallelCompileJob &Job = CompileJobs[I];
+      if (WorkerFileSystem->setCurrentWorkingDirectory(Job.Directory))
+        llvm::report_fatal_error("Cannot chdir into \"" + Twine(Job.Directory) +
+                                 "\n!");
+      if (WorkerSeenDirectories.insert(Job.Directory).second)
+        for (const auto &MappedFile : MappedFileContents)
+          if (!llvm::sys::path::is_absolute(MappedFile.first))
+            WorkerInMemoryFileSystem->addFile(
+                MappedFile.first, 0,
+                llvm::MemoryBuffer::getMemBuffer(MappedFile.second));
+
+      llvm::raw_string_ostream OS(Job.Output);
+      IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+      TextDiagnosticPrinter DiagnosticPrinter(OS, &*DiagOpts);
+      DEBUG({ llvm::dbgs() << "Processing: " << Job.File << ".\n"; });
+      // FrontendActionFactory::runInvocation clears the stat caches of the
+      // file manager after every invocation, so install the cache every time.
+      WorkerFiles->addStatCache(
+          llvm::make_unique<SharedStatCache>(StatCacheStorage));
+      ToolInvocation Invocation(std::move(Job.CommandLine), Action,
+                                WorkerFiles.get(), PCHContainerOps);
+      Invocation.setDiagnosticConsumer(&DiagnosticPrinter);
+      if (!Invocation.run()) {
+        OS << "Error while processing " << Job.File << ".\n";
+        Job.Failed = true;
+      }
+      OS.flush();
+    }
+  };
+
+  {
+    unsigned NumWorkers = std::min<size_t>(Jobs, CompileJobs.size());
+    llvm::ThreadPool Pool(NumWorkers);
+    for (unsigned I = 0; I < NumWorkers; ++I)
+      Pool.async(Worker);
+    Pool.wait();
+  }
+
+  bool ProcessingFailed = false;
+  for (const ParallelCompileJob &Job : CompileJobs) {
+    llvm::errs() << Job.Output;
+    ProcessingFailed |= Job.Failed;
+  }
   return ProcessingFailed ? 1 : 0;
 }
 
@@ -489,6 +941,109 @@ int ClangTool::buildASTs(std::vector<std::unique_ptr<ASTUnit>> &ASTs) {
   return run(&Action);
 }
 
+SpilledASTs::SpilledASTs(
+    unsigned MaxResidentASTs,
+    std::shared_ptr<PCHContainerOperations> PCHContainerOps)
+    : MaxResidentASTs(std::max(MaxResidentASTs, 1u)),
+      PCHContainerOps(std::move(PCHContainerOps)) {}
+
+SpilledASTs::~SpilledASTs() {
+  for (Entry &E : Entries) {
+    E.AST.reset();
+    llvm::sys::fs::remove(E.ASTFileName);
+  }
+}
+
+void SpilledASTs::addASTFile(StringRef MainFileName, StringRef ASTFileName) {
+  Entry E;
+  E.MainFileName = MainFileName;
+  E.ASTFileName = ASTFileName;
+  Entries.push_back(std::move(E));
+}
+
+std::shared_ptr<ASTUnit> SpilledASTs::getAST(size_t Index) {
+  Entry &E = Entries[Index];
+  auto Resident =
+      std::find(ResidentEntries.begin(), ResidentEntries.end(), Index);
+  if (Resident != ResidentEntries.end()) {
+    std::rotate(ResidentEntries.begin(), Resident, Resident + 1);
+    return E.AST;
+  }
+
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  std::unique_ptr<ASTUnit> AST = ASTUnit::LoadFromASTFile(
+      E.ASTFileName, PCHContainerOps->getRawReader(),
+      CompilerInstance::createDiagnostics(&*DiagOpts), FileSystemOptions());
+  if (!AST)
+    return nullptr;
+
+  if (ResidentEntries.size() == MaxResidentASTs) {
+    Entries[ResidentEntries.back()].AST.reset();
+    ResidentEntries.pop_back();
+  }
+  E.AST = std::move(AST);
+  ResidentEntries.insert(ResidentEntries.begin(), Index);
+  return E.AST;
+}
+
+namespace {
+
+class ASTSpillAction : public ToolAction {
+  std::vector<std::pair<std::string, std::string>> &ASTFiles;
+  std::mutex &ASTFilesMutex;
+
+public:
+  ASTSpillAction(std::vector<std::pair<std::string, std::string>> &ASTFiles,
+                 std::mutex &ASTFilesMutex)
+      : ASTFiles(ASTFiles), ASTFilesMutex(ASTFilesMutex) {}
+
+  bool runInvocation(CompilerInvocation *Invocation, FileManager *Files,
+                     std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+                     DiagnosticConsumer *DiagConsumer) override {
+    std::string MainFileName =
+        Invocation->getFrontendOpts().Inputs[0].getFile();
+    std::unique_ptr<ASTUnit> AST = ASTUnit::LoadFromCompilerInvocation(
+        Invocation, std::move(PCHContainerOps),
+        CompilerInstance::createDiagnostics(&Invocation->getDiagnosticOpts(),
+                                            DiagConsumer,
+                                            /*ShouldOwnClient=*/false),
+        Files);
+    if (!AST)
+      return false;
+
+    SmallString<128> ASTFileName;
+    if (llvm::sys::fs::createTemporaryFile(
+            llvm::sys::path::filename(MainFileName), "ast", ASTFileName))
+      return false;
+    if (AST->Save(ASTFileName)) {
+      llvm::sys::fs::remove(ASTFileName);
+      return false;
+    }
+
+    std::lock_guard<std::mutex> Lock(ASTFilesMutex);
+    ASTFiles.push_back(std::make_pair(MainFileName, ASTFileName.str()));
+    return true;
+  }
+};
+}
+
+int ClangTool::buildSpilledASTs(SpilledASTs &ASTs, unsigned Jobs) {
+  std::vector<std::pair<std::string, std::string>> ASTFiles;
+  std::mutex ASTFilesMutex;
+  ASTSpillAction Action(ASTFiles, ASTFilesMutex);
+  int Result = runParallel(&Action, Jobs);
+
+  // The workers finish in any order.
+  std::stable_sort(ASTFiles.begin(), ASTFiles.end(),
+                   [](const std::pair<std::string, std::string> &A,
+                      const std::pair<std::string, std::string> &B) {
+                     return A.first < B.first;
+                   });
+  for (const auto &ASTFile : ASTFiles)
+    ASTs.addASTFile(ASTFile.first, ASTFile.second);
+  return Result;
+}
+
 std::unique_ptr<ASTUnit>
 buildASTFromCode(const Twine &Code, const Twine &FileName,
                  std::shared_ptr<PCHContainerOperations> PCHContainerOps) {
@@ -0,0 +1,4 @@
+int f(int x) { return x + 1; }
+
+static int twice(int x) { return 2 * x; }
+int g(int x) { return twice(x) - 1; }
@@ -0,0 +1,40 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,deadcode.DeadStores -fno-caret-diagnostics %s 2> %t.all
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,deadcode.DeadStores -analyzer-config shard-count=2,shard-index=0 -fno-caret-diagnostics %s 2> %t.0
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,deadcode.DeadStores -analyzer-config shard-count=2,shard-index=1 -fno-caret-diagnostics %s 2> %t.1
+// RUN: sort %t.all | FileCheck %s --check-prefix=ALL
+// RUN: cat %t.0 %t.1 | sort | FileCheck %s --check-prefix=SHARDS
+
+// Together, the shards report every bug exactly once.
+
+int first(int x) {
+  if (x == 0)
+    return 1 / x;
+  return 0;
+}
+
+int second(int x) {
+  if (x == 0)
+    return 2 / x;
+  return 0;
+}
+
+int third(int x) {
+  int y;
+  y = 3; // dead store, reported by the first shard only
+  if (x == 0)
+    return 3 / x;
+  return 0;
+}
+
+// ALL: analysis-shards.c:11:{{[0-9]+}}: warning: Division by zero
+// ALL-NEXT: analysis-shards.c:17:{{[0-9]+}}: warning: Division by zero
+// ALL-NEXT: analysis-shards.c:23:{{[0-9]+}}: warning: Value stored to 'y' is never read
+// ALL-NEXT: analysis-shards.c:25:{{[0-9]+}}: warning: Division by zero
+// ALL-NEXT: 4 warnings generated.
+
+// SHARDS: analysis-shards.c:11:{{[0-9]+}}: warning: Division by zero
+// SHARDS-NEXT: analysis-shards.c:17:{{[0-9]+}}: warning: Division by zero
+// SHARDS-NEXT: analysis-shards.c:23:{{[0-9]+}}: warning: Value stored to 'y' is never read
+// SHARDS-NEXT: analysis-shards.c:25:{{[0-9]+}}: warning: Division by zero
+// SHARDS-NEXT: {{[0-9]}} warning{{s?}} generated.
+// SHARDS-NEXT: {{[0-9]}} warning{{s?}} generated.
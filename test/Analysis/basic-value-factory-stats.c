@@ -0,0 +1,18 @@
+// REQUIRES: asserts
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-stats -verify %s 2>&1 | FileCheck %s
+
+// Small integer values are interned once and then found in a table.
+
+void clang_analyzer_eval(int);
+
+void small() {
+  int a = 0, b = 1, c = -1;
+  a = b + c;
+  clang_analyzer_eval(a == 0); // expected-warning{{TRUE}}
+  clang_analyzer_eval(b - 1 == a); // expected-warning{{TRUE}}
+}
+
+// CHECK: ... Statistics Collected ...
+// CHECK-DAG: {{[1-9][0-9]*}} BasicValueFactory - The # of distinct integer values interned.
+// CHECK-DAG: {{[1-9][0-9]*}} BasicValueFactory - The # of integer values found in the small value tables.
+// CHECK-DAG: {{[1-9][0-9]*}} BasicValueFactory - The # of integer values requested from the value factory.
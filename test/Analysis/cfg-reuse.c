@@ -0,0 +1,22 @@
+// REQUIRES: asserts
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-stats %s 2>&1 | FileCheck %s
+
+// Each function's CFG is built once, however many top level functions inline
+// it.
+
+static void square(int *x) {
+  *x *= *x;
+}
+
+void first(int *x) {
+  square(x);
+  ++*x;
+}
+
+void second(int *x) {
+  square(x);
+  --*x;
+}
+
+// CHECK: ... Statistics Collected ...
+// CHECK: 3 AnalysisDeclContext - The # of CFGs built
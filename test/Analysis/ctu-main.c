@@ -0,0 +1,26 @@
+// RUN: rm -rf %t && mkdir -p %t/ctudir
+// RUN: %clang_cc1 -emit-pch -o %t/ctudir/ctu-other.c.ast %S/Inputs/ctu-other.c
+// RUN: cp %S/Inputs/externalFnMap.txt %t/ctudir/
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-config ctu-dir=%t/ctudir -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-config ctu-dir=%t/ctudir,ctu-max-loaded-asts=1 -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -verify -DNO_CTU %s
+
+void clang_analyzer_eval(int);
+
+int f(int);
+int g(int);
+int h(int);
+
+void test() {
+#ifdef NO_CTU
+  clang_analyzer_eval(f(1) == 2); // expected-warning{{UNKNOWN}}
+  clang_analyzer_eval(g(2) == 3); // expected-warning{{UNKNOWN}}
+#else
+  // The definitions of f and g, and of the static helper that g calls, are
+  // imported from the other translation unit and inlined.
+  clang_analyzer_eval(f(1) == 2); // expected-warning{{TRUE}}
+  clang_analyzer_eval(g(2) == 3); // expected-warning{{TRUE}}
+#endif
+  // There is no definition of h anywhere.
+  clang_analyzer_eval(h(1) == 1); // expected-warning{{UNKNOWN}}
+}
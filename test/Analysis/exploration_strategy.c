@@ -0,0 +1,27 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-config exploration_strategy=unexplored_first -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-config exploration_strategy=bfs -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-config exploration_strategy=bfs_block_dfs_contents -verify %s
+
+void clang_analyzer_warnIfReached(void);
+
+int flag(void);
+
+// The loop can keep the analyzer busy on its first iterations; the blocks
+// after it should still be reached.
+void loopFirst(int n) {
+  for (int i = 0; i < n; ++i)
+    if (flag())
+      n += flag();
+
+  if (flag())
+    clang_analyzer_warnIfReached(); // expected-warning {{REACHABLE}}
+  else
+    clang_analyzer_warnIfReached(); // expected-warning {{REACHABLE}}
+}
+
+int divide(int x) {
+  int zero = 0;
+  if (x)
+    return x / zero; // expected-warning {{Division by zero}}
+  return 0;
+}
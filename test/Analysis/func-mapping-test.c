@@ -0,0 +1,9 @@
+// RUN: clang-func-mapping %s -- | FileCheck %s
+
+int f(int x) { return x; }
+static int g(int x) { return x; }
+int declared(int);
+
+// CHECK: c:@F@f {{.*}}func-mapping-test.c.ast
+// CHECK-NOT: @F@g
+// CHECK-NOT: declared
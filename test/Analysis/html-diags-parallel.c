@@ -0,0 +1,30 @@
+// RUN: rm -fR %t.serial %t.parallel
+// RUN: %clang_cc1 -analyze -analyzer-output=html -analyzer-checker=core -analyzer-config stable-report-filename=true -o %t.serial %s
+// RUN: %clang_cc1 -analyze -analyzer-output=html -analyzer-checker=core -analyzer-config stable-report-filename=true -analyzer-config html-report-threads=4 -o %t.parallel %s
+// RUN: ls %t.serial | FileCheck %s
+// RUN: diff -r %t.serial %t.parallel
+
+// Reports are rendered in parallel, sharing the highlighting of the file;
+// check that each report is written and identical to the serial output.
+
+// CHECK-DAG: report-{{.*}}-first-{{.*}}.html
+// CHECK-DAG: report-{{.*}}-second-{{.*}}.html
+// CHECK-DAG: report-{{.*}}-third-{{.*}}.html
+
+#define DEREF(p) *p = 0xDEADBEEF
+
+void first(int *p) {
+  if (p)
+    return;
+  DEREF(p); // "string" /* comment */
+}
+
+void second() {
+  int *p = 0;
+  *p = 1;
+}
+
+void third(int x) {
+  int y;
+  x = y / 0;
+}
@@ -0,0 +1,86 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-max-loop 4 -analyzer-config summarize-loops=true -verify %s
+
+void clang_analyzer_eval(int);
+void clang_analyzer_warnIfReached();
+void unknown(int);
+
+void constantBound() {
+  int i, sum = 0;
+  for (i = 0; i < 1000; ++i)
+    sum += 2;
+  clang_analyzer_eval(i == 1000); // expected-warning{{TRUE}}
+  clang_analyzer_eval(sum == 2000); // expected-warning{{UNKNOWN}}
+}
+
+void inclusiveBound() {
+  int i;
+  for (i = 1; i <= 100; i += 1) {
+  }
+  clang_analyzer_eval(i == 101); // expected-warning{{TRUE}}
+}
+
+void countDown() {
+  int a[10];
+  int i;
+  for (i = 9; i >= 0; --i)
+    a[i] = i;
+  clang_analyzer_eval(i == -1); // expected-warning{{TRUE}}
+  clang_analyzer_eval(a[5] == 5); // expected-warning{{UNKNOWN}}
+}
+
+void symbolicBound(int n) {
+  if (n <= 0)
+    return;
+  int i;
+  for (i = 0; i < n; i++) {
+  }
+  clang_analyzer_eval(i == n); // expected-warning{{TRUE}}
+}
+
+void reversedCondition(unsigned n) {
+  unsigned i;
+  for (i = 0; n != i; ++i) {
+  }
+  clang_analyzer_eval(i == n); // expected-warning{{TRUE}}
+}
+
+void untouched() {
+  int x = 5, i;
+  for (i = 0; i < 50; ++i) {
+    int y = x;
+    (void)y;
+  }
+  clang_analyzer_eval(x == 5); // expected-warning{{TRUE}}
+}
+
+void firstIterationIsAnalyzed() {
+  int sum = 0;
+  for (int i = 0; i < 100; ++i)
+    sum += 100 / i; // expected-warning{{Division by zero}}
+}
+
+// Loops with calls are analyzed one iteration at a time, as before.
+void callInBody() {
+  int i;
+  for (i = 0; i < 100; ++i)
+    unknown(i);
+  clang_analyzer_warnIfReached(); // no-warning
+}
+
+// So are loops that may leave early.
+void breakInBody(int *a) {
+  int i;
+  for (i = 0; i < 100; ++i)
+    if (a[i])
+      break;
+  clang_analyzer_warnIfReached(); // expected-warning{{REACHABLE}}
+}
+
+void nested() {
+  int i, j, sum = 0;
+  for (i = 0; i < 10; ++i)
+    for (j = 0; j < 10; ++j)
+      sum++;
+  clang_analyzer_eval(i == 10); // expected-warning{{TRUE}}
+  clang_analyzer_eval(j == 10); // expected-warning{{UNKNOWN}}
+}
@@ -0,0 +1,18 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config max-function-memory-mb=1,max-nodes=0 -verify %s
+
+// The exploration of a function that needs more memory than allowed stops
+// early, but keeps the reports it found on the way.
+
+int flag(void);
+
+void manyPaths(int *p) {
+  int zero = 0;
+  if (!p)
+    (void)(1 / zero); // expected-warning {{Division by zero}}
+
+  int sum = 0;
+  for (int i = 0; i < 1000; ++i)
+    if (flag())
+      sum += flag() ? i : -i;
+  (void)sum;
+}
@@ -0,0 +1,29 @@
+// RUN: rm -f %t.json
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config profile-output=%t.json -verify %s
+// RUN: FileCheck %s --input-file=%t.json
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config profile-output=%t.json,max-nodes=20 -verify %s
+// RUN: FileCheck %s --input-file=%t.json --check-prefix=MAXNODES
+
+// CHECK: "functions": [
+// CHECK-DAG: { "name": "divide", "file": "{{.*}}profile-output.c", "line": [[@LINE+1]], "inlining": "regular", "nodes": {{[1-9][0-9]*}}, "seconds": {{[0-9.]+}}, "reached_max_nodes": false, "block_count_exceeded": 0, "inline_count_exceeded": 0 }
+int divide(int x) {
+  if (x)
+    return 10 / x;
+  return 0;
+}
+
+// CHECK-DAG: { "name": "loop", {{.*}} "reached_max_nodes": false, "block_count_exceeded": {{[1-9][0-9]*}}, "inline_count_exceeded": 0 }
+// MAXNODES: { "name": "loop", {{.*}} "reached_max_nodes": true,
+int loop(void) {
+  int sum = 0;
+  for (int i = 0; i < 100; ++i)
+    sum += i / 2;
+  return sum;
+}
+
+// CHECK: "checkers": [
+// CHECK-DAG: { "name": "core.UndefinedBinaryOperatorResult", "calls": {{[1-9][0-9]*}}, "seconds": {{[0-9.]+}} }
+// CHECK-DAG: { "name": "core.DivideZero", "calls": {{[1-9][0-9]*}}, "seconds": {{[0-9.]+}} }
+// CHECK: ]
+
+// expected-no-diagnostics
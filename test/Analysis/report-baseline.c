@@ -0,0 +1,17 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyze-function=known -analyzer-output=plist -o %t.plist %s
+// RUN: grep -A1 issue_hash_content_of_line_in_context %t.plist | grep '<string>' | sed -e 's/.*<string>//' -e 's/<\/string>.*//' > %t.baseline
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config report-baseline=%t.baseline -verify %s
+
+// The reports in the baseline are dropped before their paths are generated;
+// the others are emitted as usual.
+
+int known(int x) {
+  int zero = 0;
+  return x / zero; // no-warning
+}
+
+int fresh(int *p) {
+  if (p)
+    return 0;
+  return *p; // expected-warning {{Dereference of null pointer}}
+}
@@ -0,0 +1,39 @@
+// RUN: rm -rf %t.dir && cp %s %t.c
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config result-cache-dir=%t.dir -analyzer-display-progress -verify %t.c 2>&1 | FileCheck %s --check-prefix=FIRST
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config result-cache-dir=%t.dir -analyzer-display-progress -verify %t.c 2>&1 | FileCheck %s --check-prefix=CACHED
+// RUN: sed 's/x + [1];/x + 2;/' %s > %t.c
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config result-cache-dir=%t.dir -analyzer-display-progress -verify %t.c 2>&1 | FileCheck %s --check-prefix=CHANGED
+
+// Functions that had nothing to report are only analyzed again when they, or
+// the functions they call, change. Functions with reports are always analyzed
+// again, so that every run emits their reports.
+
+static int helper(int x) {
+  return x + 1;
+}
+
+int caller(int x) {
+  return helper(x) * 2;
+}
+
+int unrelated(int x) {
+  return x - 1;
+}
+
+int divide(int x) {
+  int zero = 0;
+  return x / zero; // expected-warning {{Division by zero}}
+}
+
+// FIRST-DAG: ANALYZE (Path,{{.*}}): {{.*}} caller
+// FIRST-DAG: ANALYZE (Path,{{.*}}): {{.*}} unrelated
+// FIRST-DAG: ANALYZE (Path,{{.*}}): {{.*}} divide
+
+// CACHED-NOT: ANALYZE (Path,{{.*}} {{caller|helper|unrelated}}
+// CACHED: ANALYZE (Path,{{.*}}): {{.*}} divide
+// CACHED-NOT: ANALYZE (Path,{{.*}} {{caller|helper|unrelated}}
+
+// CHANGED-NOT: ANALYZE (Path,{{.*}} unrelated
+// CHANGED-DAG: ANALYZE (Path,{{.*}}): {{.*}} caller
+// CHANGED-DAG: ANALYZE (Path,{{.*}}): {{.*}} divide
+// CHANGED-NOT: ANALYZE (Path,{{.*}} unrelated
@@ -1,5 +1,7 @@
 // REQUIRES: asserts
 // RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-stats %s 2>&1 | FileCheck %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-stats %s 2>&1 | FileCheck %s --check-prefix=MEMORY
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-stats %s 2>&1 | FileCheck %s --check-prefix=TIMER
 
 void foo() {
   int x;
@@ -7,3 +9,10 @@ void foo() {
 // CHECK: ... Statistics Collected ...
 // CHECK:100 AnalysisConsumer - The % of reachable basic blocks.
 // CHECK:The # of times RemoveDeadBindings is called
+
+// MEMORY-DAG: {{[1-9][0-9]*}} ExprEngine - The # of exploded nodes in the graphs of the top level functions
+// MEMORY-DAG: {{[1-9][0-9]*}} ExprEngine - The # of bytes allocated for the program states, stores and constraints of the top level functions
+// MEMORY-DAG: {{[1-9][0-9]*}} ExprEngine - The # of bytes allocated for exploded graphs
+
+// TIMER-DAG: Analyzer Setup Time
+// TIMER-DAG: Analyzer Total Time
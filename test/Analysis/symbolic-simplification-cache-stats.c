@@ -0,0 +1,17 @@
+// REQUIRES: asserts
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-stats -verify %s 2>&1 | FileCheck %s
+
+// Evaluating the same symbolic expression again in a state with the same
+// constraints reuses the earlier result.
+
+void clang_analyzer_eval(int);
+
+void repeated(int x) {
+  int a = x + 1;
+  int b = x + 1;
+  clang_analyzer_eval(a == b); // expected-warning{{TRUE}}
+}
+
+// CHECK: ... Statistics Collected ...
+// CHECK-DAG: {{[1-9][0-9]*}} SimpleSValBuilder - The # of symbolic binary operations looked up in the simplification cache
+// CHECK-DAG: {{[1-9][0-9]*}} SimpleSValBuilder - The # of symbolic binary operations whose simplification was reused
@@ -0,0 +1,30 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-config cache-symbolic-simplifications=false -verify %s
+
+// The simplifications of symbolic expressions are reused only by states with
+// the same constraints.
+
+void clang_analyzer_eval(int);
+
+void constrained(int x) {
+  if (x == 3)
+    clang_analyzer_eval(x + 1 == 4); // expected-warning{{TRUE}}
+  else
+    clang_analyzer_eval(x + 1 == 4); // expected-warning{{FALSE}}
+  clang_analyzer_eval(x + 1 - 1 == x); // expected-warning{{TRUE}}
+}
+
+void repeated(int x) {
+  int a = x + 1;
+  int b = x + 1;
+  clang_analyzer_eval(a == b); // expected-warning{{TRUE}}
+  if (a == 10)
+    clang_analyzer_eval(b == 10); // expected-warning{{TRUE}}
+}
+
+void sumLoop(int n) {
+  int s = n;
+  for (int i = 0; i < 3; ++i)
+    s = s + 1;
+  clang_analyzer_eval(s == n + 3); // expected-warning{{TRUE}}
+}
@@ -0,0 +1,34 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-constraints=range -verify -DNO_REFUTATION %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-constraints=z3 -verify %s
+// REQUIRES: z3
+
+// The range constraint manager does not reason about multiplications and
+// bitwise operations, so it keeps paths that the solver refutes once a bug
+// is found on them.
+
+void oddProduct(int x) {
+  if (x * 2 == 1) {
+    int *p = 0;
+    *p = 1;
+#ifdef NO_REFUTATION
+    // expected-warning@-2 {{Dereference of null pointer}}
+#endif
+  }
+}
+
+void evenOdd(int x) {
+  if ((x & 1) == 0 && x == 5) {
+    int *p = 0;
+    *p = 1;
+#ifdef NO_REFUTATION
+    // expected-warning@-2 {{Dereference of null pointer}}
+#endif
+  }
+}
+
+void evenEven(int x) {
+  if ((x & 1) == 0 && x == 4) {
+    int *p = 0;
+    *p = 1; // expected-warning {{Dereference of null pointer}}
+  }
+}
@@ -0,0 +1,37 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -o - %s | FileCheck %s
+
+// Arrays of integer and character literals are emitted as data arrays.
+
+// CHECK: @bytes = global [6 x i8] c"\01\FF\7Fab\00"
+unsigned char bytes[6] = { 0x01, 0xff, 0x7f, 'a', 'b' };
+
+// CHECK: @truncated = global [2 x i8] c"a\C8"
+signed char truncated[2] = { 'a', 200 };
+
+// CHECK: @shorts = global [3 x i16] [i16 -1, i16 300, i16 0]
+unsigned short shorts[3] = { 0xffff, 300 };
+
+// CHECK: @ints = global [4 x i32] [i32 1, i32 2, i32 3, i32 4]
+int ints[] = { 1, 2, 3, 4 };
+
+// CHECK: @chars = global [2 x i32] [i32 -1, i32 120]
+int chars[2] = { '\xff', L'x' };
+
+// CHECK: @wide = global [2 x i64] [i64 4886718345, i64 120]
+long long wide[2] = { 0x123456789, 'x' };
+
+// CHECK: @zeros = global [100 x i32] zeroinitializer
+int zeros[100] = { 0 };
+
+// Elements that aren't literals take the general path.
+// CHECK: @mixed = global [3 x i32] [i32 1, i32 -2, i32 3]
+int mixed[3] = { 1, -2, 1 + 2 };
+
+// CHECK: @s = global %struct.S { i32 2, [4 x i8] c"\01\02\00\00" }
+struct S { int n; unsigned char data[4]; } s = { 2, { 1, 2 } };
+
+// CHECK: @local.table = private unnamed_addr constant [3 x i16] [i16 7, i16 8, i16 9]
+int local(int i) {
+  short table[3] = { 7, 8, 9 };
+  return table[i];
+}
@@ -0,0 +1,46 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -fdiscard-ast-bodies-after-codegen %s -o - | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm-only -fdiscard-ast-bodies-after-codegen -DREDEFINE -verify %s
+
+// Discarding bodies must not change the generated code.
+
+// CHECK-LABEL: define i32 @sum(
+// CHECK: add nsw i32
+int sum(int a, int b) { // expected-note {{previous definition is here}}
+  int c = a + b;
+  return c;
+}
+
+// A static function is emitted once it is used, after its definition.
+// CHECK-LABEL: define i32 @use_helper(
+// CHECK: call i32 @helper(
+static int helper(int x) { return x * 2; }
+int use_helper(int x) { return helper(x); }
+
+// Inline functions may be emitted again where they are used.
+inline int twice(int x) { return x + x; }
+// CHECK-LABEL: define i32 @use_twice(
+int use_twice(int x) { return twice(x); }
+
+// Bodies with labels or variably modified types are kept.
+// CHECK-LABEL: define i32 @with_label(
+int with_label(int x) {
+again:
+  if (x > 10)
+    return x;
+  x *= 2;
+  goto again;
+}
+
+// CHECK-LABEL: define i32 @with_vla(
+int with_vla(int n) {
+  int a[n];
+  a[0] = n;
+  return a[0];
+}
+
+// CHECK-LABEL: define internal i32 @helper(
+
+#ifdef REDEFINE
+// A discarded function remains a definition.
+int sum(int a, int b) { return a - b; } // expected-error {{redefinition of 'sum'}}
+#endif
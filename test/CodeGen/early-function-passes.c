@@ -0,0 +1,37 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -O1 -fearly-function-passes -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -O1 -fearly-function-passes -debug-info-kind=limited -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -O1 -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -O0 -fearly-function-passes -emit-llvm -o - %s | FileCheck %s --check-prefix=O0
+
+// Functions optimized as soon as they are generated end up optimized just as
+// they would be at the end of the translation unit.
+
+struct pair { int a, b; };
+
+static int sum(struct pair p) { return p.a + p.b; }
+
+// CHECK-LABEL: define i32 @twice(
+// CHECK-NOT: alloca
+// CHECK: ret i32
+// O0-LABEL: define i32 @twice(
+// O0: alloca
+int twice(int x) {
+  struct pair p = { x, x };
+  return sum(p);
+}
+
+// A function called before it is defined.
+int later(int);
+
+// CHECK-LABEL: define i32 @caller(
+// CHECK-NOT: alloca
+// CHECK: ret i32
+int caller(int x) { return later(x) + 1; }
+
+// CHECK-LABEL: define i32 @later(
+// CHECK-NOT: alloca
+// CHECK: ret i32
+int later(int x) {
+  int y = x;
+  return y * 3;
+}
@@ -0,0 +1,27 @@
+// RUN: %clang_cc1 -triple x86_64-apple-darwin -emit-llvm -o - %s | FileCheck %s
+
+// Function types that use an incomplete struct are converted to placeholders,
+// and converted again once the struct is complete.
+// Keep this test in its own file because CodeGenTypes has global state.
+
+// CHECK-DAG: %struct.HasFA = type { {}* }
+// CHECK-DAG: %struct.HasFB = type { {}* }
+// CHECK-DAG: %struct.C = type { void (i32)*, {}* }
+// CHECK-DAG: %struct.D = type { void (i32)*, void (float)* }
+
+struct A;
+struct B;
+typedef void (*FA)(struct A);
+typedef void (*FB)(struct B);
+
+struct HasFA { FA f; } ha;
+struct HasFB { FB f; } hb;
+
+struct A { int x; };
+
+// Only the types that depend on A may change here.
+struct C { FA f; FB g; } c;
+
+struct B { float y; };
+
+struct D { FA f; FB g; } d;
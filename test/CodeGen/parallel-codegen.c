@@ -0,0 +1,32 @@
+// REQUIRES: x86-registered-target
+// RUN: rm -f %t.s %t.1.s %t.2.s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -O2 -fparallel-codegen=3 -S -o %t.s %s
+// RUN: cat %t.s %t.1.s %t.2.s | FileCheck %s
+// RUN: cat %t.s %t.1.s %t.2.s | FileCheck %s --check-prefix=ONCE
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -O2 -fparallel-codegen=2 -emit-obj -o %t.o %s
+// RUN: test -s %t.o && test -s %t.1.o
+// RUN: not %clang_cc1 -triple x86_64-unknown-linux-gnu -fparallel-codegen=2 -S -o - %s 2>&1 | FileCheck %s --check-prefix=STDOUT
+
+// The module is split into partitions, which between them define every
+// function exactly once. Local functions stay local.
+
+// CHECK-DAG: {{^}}first:
+// CHECK-DAG: {{^}}second:
+// CHECK-DAG: {{^}}third:
+// CHECK-DAG: {{^}}helper:
+// CHECK-DAG: {{^}}table:
+
+// ONCE-NOT: .globl helper
+// ONCE: {{^}}helper:
+// ONCE-NOT: {{^}}helper:
+// ONCE-NOT: .globl helper
+
+// STDOUT: error: -fparallel-codegen requires an output file
+
+int table[4] = { 1, 2, 3, 4 };
+
+__attribute__((noinline)) static int helper(int x) { return table[x & 3] * x; }
+
+int first(int x) { return helper(x) + 1; }
+int second(int x) { return helper(x) - 1; }
+int third(int x) { return x * 7; }
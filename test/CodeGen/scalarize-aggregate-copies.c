@@ -0,0 +1,45 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -fscalarize-aggregate-copies -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -o - %s | FileCheck %s --check-prefix=MEMCPY
+
+struct point { int x; float y; char *name; };
+struct five { int a, b, c, d, e; };
+struct bits { int a : 3; int b; };
+struct nested { struct point p; };
+union either { int i; float f; };
+
+// CHECK-LABEL: define void @copy_point(
+// CHECK-NOT: memcpy
+// CHECK: [[X:%.*]] = load i32, i32*
+// CHECK: store i32 [[X]], i32*
+// CHECK: [[Y:%.*]] = load float, float*
+// CHECK: store float [[Y]], float*
+// CHECK: [[NAME:%.*]] = load i8*, i8**
+// CHECK: store i8* [[NAME]], i8**
+// CHECK-NOT: memcpy
+// CHECK: ret void
+// MEMCPY-LABEL: define void @copy_point(
+// MEMCPY: call void @llvm.memcpy
+void copy_point(struct point *d, struct point *s) { *d = *s; }
+
+// Too many fields, bit-fields, fields that are structs, unions and volatile
+// copies still use memcpy.
+
+// CHECK-LABEL: define void @copy_five(
+// CHECK: call void @llvm.memcpy
+void copy_five(struct five *d, struct five *s) { *d = *s; }
+
+// CHECK-LABEL: define void @copy_bits(
+// CHECK: call void @llvm.memcpy
+void copy_bits(struct bits *d, struct bits *s) { *d = *s; }
+
+// CHECK-LABEL: define void @copy_nested(
+// CHECK: call void @llvm.memcpy
+void copy_nested(struct nested *d, struct nested *s) { *d = *s; }
+
+// CHECK-LABEL: define void @copy_either(
+// CHECK: call void @llvm.memcpy
+void copy_either(union either *d, union either *s) { *d = *s; }
+
+// CHECK-LABEL: define void @copy_volatile(
+// CHECK: call void @llvm.memcpy{{.*}}, i1 true)
+void copy_volatile(volatile struct point *d, struct point *s) { *d = *s; }
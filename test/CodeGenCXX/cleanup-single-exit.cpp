@@ -0,0 +1,36 @@
+// RUN: %clang_cc1 -triple x86_64-apple-darwin -emit-llvm %s -o - | FileCheck %s
+
+struct A { A(); ~A(); };
+void f();
+
+// A cleanup that is only left for one destination branches there directly.
+// CHECK-LABEL: define void @_Z9test_gotov()
+// CHECK: call void @_ZN1AD1Ev(
+// CHECK-NEXT: br label %lbl
+// CHECK: lbl:
+// CHECK-NEXT: ret void
+void test_goto() {
+  {
+    A a;
+    goto lbl;
+  }
+lbl:
+  ;
+}
+
+// A cleanup that is left for several destinations still dispatches on the
+// cleanup destination.
+// CHECK-LABEL: define void @_Z17test_goto_or_fallb(
+// CHECK: call void @_ZN1AD1Ev(
+// CHECK-NEXT: [[DEST:%.*]] = load i32, i32* %cleanup.dest.slot
+// CHECK-NEXT: switch i32 [[DEST]], label %unreachable [
+void test_goto_or_fall(bool b) {
+  {
+    A a;
+    if (b)
+      goto lbl;
+  }
+  f();
+lbl:
+  ;
+}
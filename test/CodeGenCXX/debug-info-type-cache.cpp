@@ -0,0 +1,32 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-llvm -debug-info-kind=limited -fdebug-type-cache=%t -main-file-name first.cpp -o - %s | FileCheck %s --check-prefix=OWNER
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-llvm -debug-info-kind=limited -fdebug-type-cache=%t -main-file-name second.cpp -o - %s | FileCheck %s --check-prefix=OTHER
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-llvm -debug-info-kind=standalone -fdebug-type-cache=%t -main-file-name second.cpp -o - %s | FileCheck %s --check-prefix=OTHER
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-llvm -debug-info-kind=limited -fdebug-type-cache=%t -main-file-name first.cpp -o - %s | FileCheck %s --check-prefix=OWNER
+
+// The first unit to claim a type in the cache emits its full debug info, as
+// it does when it is compiled again. Other units only declare it.
+
+struct Shared {
+  int a;
+  int b;
+};
+Shared shared;
+
+namespace {
+struct Local {
+  int c;
+};
+}
+Local local;
+
+// OWNER-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Shared",{{.*}} elements: !{{[0-9]+}}, identifier: "_ZTS6Shared")
+// OWNER-DAG: !DIDerivedType(tag: DW_TAG_member, name: "a"
+
+// OTHER-NOT: name: "a"
+// OTHER-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Shared",{{.*}} flags: DIFlagFwdDecl, identifier: "_ZTS6Shared")
+
+// Types without an ODR name are always emitted in full.
+// OWNER-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Local",{{.*}} elements:
+// OTHER-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Local",{{.*}} elements:
+// OTHER-NOT: name: "a"
@@ -0,0 +1,60 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-llvm -o - %s -fcxx-global-init-chunk-size=2 | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-llvm -o - %s | FileCheck %s --check-prefix=NOCHUNK
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-llvm -o - %s -fcxx-global-init-chunk-size=8 | FileCheck %s --check-prefix=NOCHUNK
+
+// With a chunk size, the initializers are called from out-of-line chunks of
+// at most that many, and the chunks are called in order.
+
+int f();
+struct S { S(); };
+
+S p1 __attribute__((init_priority(200)));
+S p2 __attribute__((init_priority(200)));
+S p3 __attribute__((init_priority(200)));
+
+int a = f();
+int b = f();
+int c = f();
+int d = f();
+int e = f();
+
+// CHECK: @llvm.global_ctors = appending global [2 x { i32, void ()*, i8* }] [{ i32, void ()*, i8* } { i32 200, void ()* @_GLOBAL__I_000200, i8* null }, { i32, void ()*, i8* } { i32 65535, void ()* @_GLOBAL__sub_I_global_init_chunks.cpp, i8* null }]
+
+// CHECK-LABEL: define internal void @_GLOBAL__I_000200()
+// CHECK-NEXT: entry:
+// CHECK-NEXT: call void @__cxx_global_init_chunk()
+// CHECK-NEXT: call void @__cxx_global_init_chunk.1()
+// CHECK-NEXT: ret void
+
+// CHECK: define internal void @__cxx_global_init_chunk() [[NOINLINE:#[0-9]+]]
+// CHECK-NEXT: entry:
+// CHECK-NEXT: call void @__cxx_global_var_init()
+// CHECK-NEXT: call void @__cxx_global_var_init.1()
+// CHECK-NEXT: ret void
+
+// CHECK: define internal void @__cxx_global_init_chunk.1() [[NOINLINE]]
+// CHECK-NEXT: entry:
+// CHECK-NEXT: call void @__cxx_global_var_init.2()
+// CHECK-NEXT: ret void
+
+// CHECK-LABEL: define internal void @_GLOBAL__sub_I_global_init_chunks.cpp()
+// CHECK-NEXT: entry:
+// CHECK-NEXT: call void @__cxx_global_init_chunk.2()
+// CHECK-NEXT: call void @__cxx_global_init_chunk.3()
+// CHECK-NEXT: call void @__cxx_global_init_chunk.4()
+// CHECK-NEXT: ret void
+
+// CHECK: define internal void @__cxx_global_init_chunk.2() [[NOINLINE]]
+// CHECK-NEXT: entry:
+// CHECK-NEXT: call void @__cxx_global_var_init.3()
+// CHECK-NEXT: call void @__cxx_global_var_init.4()
+// CHECK-NEXT: ret void
+
+// CHECK: define internal void @__cxx_global_init_chunk.4() [[NOINLINE]]
+// CHECK-NEXT: entry:
+// CHECK-NEXT: call void @__cxx_global_var_init.7()
+// CHECK-NEXT: ret void
+
+// CHECK: attributes [[NOINLINE]] = { noinline
+
+// NOCHUNK-NOT: __cxx_global_init_chunk
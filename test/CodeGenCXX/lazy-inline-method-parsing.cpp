@@ -0,0 +1,31 @@
+// RUN: %clang_cc1 -std=c++11 -triple x86_64-linux-gnu -flazy-inline-method-parsing -fsyntax-only -verify %s
+// RUN: %clang_cc1 -std=c++11 -triple x86_64-linux-gnu -flazy-inline-method-parsing -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -std=c++11 -triple x86_64-linux-gnu -flazy-inline-method-parsing -emit-llvm -o - %s | FileCheck -check-prefix=UNUSED %s
+// expected-no-diagnostics
+
+// The bodies of inline member functions are only parsed if the functions are
+// used, directly, through another body or through the vtable.
+
+struct A {
+  A() {}
+  int used() { return helper(); }
+  int helper() { return 42; }
+  virtual int virt() { return 1; }
+  void viaPointer() {}
+  int unused() { return undeclared_name; }
+};
+
+int f() {
+  A a;
+  void (A::*p)() = &A::viaPointer;
+  (a.*p)();
+  return a.used();
+}
+
+// CHECK-DAG: define linkonce_odr void @_ZN1AC2Ev(
+// CHECK-DAG: define linkonce_odr i32 @_ZN1A4usedEv(
+// CHECK-DAG: define linkonce_odr i32 @_ZN1A6helperEv(
+// CHECK-DAG: define linkonce_odr i32 @_ZN1A4virtEv(
+// CHECK-DAG: define linkonce_odr void @_ZN1A10viaPointerEv(
+
+// UNUSED-NOT: _ZN1A6unusedEv
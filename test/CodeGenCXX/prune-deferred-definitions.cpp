@@ -0,0 +1,39 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -O2 -fearly-function-passes -fprune-deferred-definitions -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -O2 -fearly-function-passes -fprune-deferred-definitions -print-stats -emit-llvm -o /dev/null %s 2>&1 | FileCheck %s --check-prefix=PRUNE
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -O2 -print-stats -emit-llvm -o /dev/null %s 2>&1 | FileCheck %s --check-prefix=NOPRUNE
+
+// An inline function is only emitted if a function that refers to it still
+// does once it has been optimized.
+
+inline int unused(int x) { return x * x * x; }
+__attribute__((noinline)) inline int rare(int x) { return x * 3; }
+inline int fast(int x) { return x + 1; }
+
+// The call to unused is removed when big is folded, as is the first call to
+// rare, which is emitted anyway because of its call from other.
+inline int helper(int x) {
+  bool big = sizeof(x) > 8;
+  if (big)
+    return unused(x) + rare(x);
+  return fast(x);
+}
+
+inline int other(int x) { return rare(x) - 1; }
+
+// CHECK-LABEL: define i32 @_Z3usei(
+int use(int x) { return helper(x); }
+
+// CHECK-LABEL: define i32 @_Z4use2i(
+// CHECK: call i32 @_Z4rarei(
+int use2(int x) { return other(x); }
+
+// CHECK: define linkonce_odr i32 @_Z4rarei(
+// CHECK-NOT: @_Z6unusedi
+
+// PRUNE: *** CodeGen Stats:
+// PRUNE: 1 deferred definitions pruned.
+// PRUNE: {{[1-9][0-9]*}}/{{[1-9][0-9]*}} discardable deferred functions deleted by the optimizer
+
+// NOPRUNE: *** CodeGen Stats:
+// NOPRUNE: 0 deferred definitions pruned.
+// NOPRUNE: {{[1-9][0-9]*}}/{{[1-9][0-9]*}} discardable deferred functions deleted by the optimizer
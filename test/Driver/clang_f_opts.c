@@ -117,6 +117,16 @@
 // CHECK-PROFILE-USE-DIR: "-fprofile-instrument-use-path={{.*}}.d/some/dir{{/|\\\\}}default.profdata"
 // CHECK-PROFILE-USE-FILE: "-fprofile-instrument-use-path=/tmp/somefile.prof"
 
+// RUN: %clang -### -S -fprofile-instr-use-shard-dir=/tmp/shards %s 2>&1 | FileCheck -check-prefix=CHECK-PROFILE-SHARD-DIR %s
+// RUN: %clang -### -S -fprofile-instr-generate -fprofile-instr-use-shard-dir=/tmp/shards %s 2>&1 | FileCheck -check-prefix=CHECK-NO-MIX-GEN-SHARD %s
+// CHECK-PROFILE-SHARD-DIR: "-fprofile-instrument-use-shard-dir=/tmp/shards"
+// CHECK-NO-MIX-GEN-SHARD: '-fprofile-instr-use-shard-dir=' not allowed with '-fprofile-instr-generate'
+
+// RUN: %clang -### -S -fprofile-instr-use=/tmp/somefile.prof -fprofile-hot-cold-sections -fprofile-function-order=/tmp/order.txt %s 2>&1 | FileCheck -check-prefix=CHECK-PROFILE-LAYOUT %s
+// RUN: %clang -### -S -fprofile-instr-use=/tmp/somefile.prof -fprofile-hot-cold-sections -fno-profile-hot-cold-sections %s 2>&1 | FileCheck -check-prefix=CHECK-NO-PROFILE-LAYOUT %s
+// CHECK-PROFILE-LAYOUT: "-fprofile-hot-cold-sections" "-fprofile-function-order=/tmp/order.txt"
+// CHECK-NO-PROFILE-LAYOUT-NOT: "-fprofile-hot-cold-sections"
+
 // RUN: %clang -### -S -fvectorize %s 2>&1 | FileCheck -check-prefix=CHECK-VECTORIZE %s
 // RUN: %clang -### -S -fno-vectorize -fvectorize %s 2>&1 | FileCheck -check-prefix=CHECK-VECTORIZE %s
 // RUN: %clang -### -S -fno-vectorize %s 2>&1 | FileCheck -check-prefix=CHECK-NO-VECTORIZE %s
@@ -0,0 +1,12 @@
+// RUN: %clang -### -c -fcompile-time-budget=600 %s 2>&1 | FileCheck %s
+// CHECK: "-cc1"
+// CHECK-SAME: "-fcompile-time-budget=600"
+// CHECK-NOT: "-fcompile-time-budget-abort"
+
+// RUN: %clang -### -c -fcompile-time-budget=600 -fcompile-time-budget-abort \
+// RUN:   -fcompile-time-budget-report=%t.txt %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=REPORT %s
+// REPORT: "-cc1"
+// REPORT-SAME: "-fcompile-time-budget=600"
+// REPORT-SAME: "-fcompile-time-budget-report={{.*}}.txt"
+// REPORT-SAME: "-fcompile-time-budget-abort"
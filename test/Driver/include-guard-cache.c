@@ -0,0 +1,3 @@
+// RUN: %clang -### -finclude-guard-cache=%t.cache -c %s 2>&1 | FileCheck %s
+// CHECK: "-cc1"
+// CHECK-SAME: "-finclude-guard-cache={{.*}}.cache"
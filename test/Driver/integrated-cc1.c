@@ -0,0 +1,27 @@
+// RUN: %clang -fintegrated-cc1 -### -fsyntax-only %s 2>&1 \
+// RUN:   | FileCheck %s -check-prefix=PRINT
+// PRINT: "-cc1"
+// PRINT-NOT: argument unused
+
+// RUN: %clang -fintegrated-cc1 -fsyntax-only %s
+// RUN: not %clang -fintegrated-cc1 -fsyntax-only -DERROR %s 2>&1 \
+// RUN:   | FileCheck %s -check-prefix=ERROR
+// ERROR: error: in-process error
+
+// A crash in the in-process job still produces a reproducer.
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: not env TMPDIR=%t TEMP=%t TMP=%t RC_DEBUG_OPTIONS=1 \
+// RUN:   %clang -fintegrated-cc1 -fsyntax-only -DCRASH %s 2>&1 \
+// RUN:   | FileCheck %s -check-prefix=CRASH
+// REQUIRES: crash-recovery
+// CRASH: Preprocessed source(s) and associated run script(s) are located at:
+// CRASH-NEXT: note: diagnostic msg: {{.*}}integrated-cc1-{{.*}}.c
+
+#ifdef ERROR
+#error in-process error
+#endif
+
+#ifdef CRASH
+#pragma clang __debug parser_crash
+#endif
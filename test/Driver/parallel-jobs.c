@@ -0,0 +1,18 @@
+// RUN: %clang -### -fparallel-jobs=4 -c %s 2>&1 | FileCheck -check-prefix=CHECK-ACCEPTED %s
+// CHECK-ACCEPTED-NOT: argument unused
+// CHECK-ACCEPTED: "-cc1"
+
+// RUN: not %clang -### -fparallel-jobs=0 -c %s 2>&1 | FileCheck -check-prefix=CHECK-ZERO %s
+// CHECK-ZERO: invalid integral value '0' in '-fparallel-jobs=0'
+
+// RUN: not %clang -### -fparallel-jobs=abc -c %s 2>&1 | FileCheck -check-prefix=CHECK-INVALID %s
+// CHECK-INVALID: invalid integral value 'abc' in '-fparallel-jobs=abc'
+
+// The output of each job is buffered and printed in job order.
+// RUN: %clang -fparallel-jobs=2 -fsyntax-only %s %s 2>&1 | FileCheck -check-prefix=CHECK-RUN %s
+// CHECK-RUN: warning: parallel job
+// CHECK-RUN-NEXT: #warning
+// CHECK-RUN: warning: parallel job
+// CHECK-RUN-NEXT: #warning
+
+#warning parallel job
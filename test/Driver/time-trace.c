@@ -0,0 +1,3 @@
+// RUN: %clang -### -c -ftime-trace=%t.json %s 2>&1 | FileCheck %s
+// CHECK: "-cc1"
+// CHECK-SAME: "-ftime-trace={{.*}}.json"
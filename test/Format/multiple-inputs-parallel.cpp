@@ -0,0 +1,16 @@
+// RUN: cp %s %t-1.cpp
+// RUN: cp %s %t-2.cpp
+// RUN: cp %s %t-3.cpp
+// RUN: clang-format -style=LLVM -j 2 %t-1.cpp %t-2.cpp %t-3.cpp \
+// RUN:   | FileCheck -strict-whitespace %s
+// RUN: not clang-format -style=LLVM -dry-run -j 2 %t-1.cpp %t-2.cpp \
+// RUN:   | FileCheck -check-prefix=DRYRUN %s
+// RUN: clang-format -style=LLVM -i %t-2.cpp
+// RUN: clang-format -style=LLVM -dry-run %t-2.cpp | count 0
+
+// CHECK: {{^int\ \*i;}}
+// CHECK: {{^int\ \*i;}}
+// CHECK: {{^int\ \*i;}}
+// DRYRUN: {{.*}}-1.cpp
+// DRYRUN-NEXT: {{.*}}-2.cpp
+ int   *  i  ;
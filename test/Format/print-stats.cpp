@@ -0,0 +1,10 @@
+// RUN: clang-format -style=LLVM -print-stats %s 2>&1 >/dev/null \
+// RUN:   | FileCheck -strict-whitespace %s
+
+// CHECK: {"file": "{{.*}}print-stats.cpp", "statistics": {"line_searches": [
+// CHECK-SAME: {"line": 9, "tokens": 7, "states": {{[0-9]+}}, "greedy": false, "dry_run": false, "ns": {{[0-9]+}}}]
+// CHECK-SAME: "penalty_cache": {"hits": 0, "misses": 0}
+// CHECK-SAME: "add_token_to_state": {"calls": {{[1-9][0-9]*}}, "ns": {{[0-9]+}}}
+// CHECK-SAME: "alignment": {"calls": 1, "ns": {{[0-9]+}}}}}
+int aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa =
+    bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb + cccccccccc;
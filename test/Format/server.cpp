@@ -0,0 +1,14 @@
+// RUN: printf 'File: a.cpp\nLength: 11\n\nint   *  i;File: b.cpp\nRange: 0:1\nLength: 7\n\nint  j;' \
+// RUN:   | clang-format -style=LLVM -server | FileCheck -strict-whitespace %s
+// RUN: printf 'File: a.cpp\n\nint i;' | not clang-format -server \
+// RUN:   | FileCheck -check-prefix=ERROR %s
+
+// CHECK: Status: ok
+// CHECK-NEXT: Incomplete-Format: false
+// CHECK-NEXT: Length: 7
+// CHECK: {{^int\ \*i;Status:\ ok$}}
+// CHECK-NEXT: Incomplete-Format: false
+// CHECK-NEXT: Length: 6
+// CHECK: {{^int\ j;$}}
+// ERROR: Status: error
+// ERROR: missing or invalid Length header
@@ -0,0 +1 @@
+static int unused_in_header(int x) { return x == x; }
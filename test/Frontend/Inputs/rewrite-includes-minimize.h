@@ -0,0 +1,5 @@
+// A comment in the header.
+#ifndef REWRITE_INCLUDES_MINIMIZE_H
+#define REWRITE_INCLUDES_MINIMIZE_H
+int in_header; /* trailing */
+#endif
@@ -0,0 +1,31 @@
+// RUN: rm -f %t.jobs
+// RUN: echo '-fsyntax-only %s' >> %t.jobs
+// RUN: echo '-fsyntax-only -DERROR %s' >> %t.jobs
+// RUN: echo '' >> %t.jobs
+// RUN: echo '-emit-pch -x c-header -o %t.pch %s' >> %t.jobs
+// RUN: echo '-fsyntax-only -include-pch %t.pch %s' >> %t.jobs
+// RUN: echo '-fsyntax-only -include-pch %t.pch %s' >> %t.jobs
+// RUN: echo '#reset' >> %t.jobs
+// RUN: echo '-fsyntax-only -mllvm -stats %s' >> %t.jobs
+// RUN: %clang -cc1server < %t.jobs 2>&1 | FileCheck %s
+
+// CHECK: {{^}}exit 0
+// CHECK: error: server error
+// CHECK: {{^}}exit 1
+// CHECK-NEXT: {{^}}exit 0
+// CHECK-NEXT: {{^}}exit 0
+// CHECK-NEXT: {{^}}exit 0
+// CHECK-NEXT: {{^}}exit 0
+// CHECK-NEXT: error: -mllvm options cannot be used with -cc1server
+// CHECK-NEXT: {{^}}exit 1
+
+#ifndef HEADER
+#define HEADER
+int header_var;
+#else
+int *p = &header_var;
+#endif
+
+#ifdef ERROR
+#error server error
+#endif
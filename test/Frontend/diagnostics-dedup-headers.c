@@ -0,0 +1,26 @@
+// RUN: rm -f %t.jobs %t.nodedup.jobs
+// RUN: echo '-fsyntax-only -fdiagnostics-dedup-headers -I %S/Inputs %s' >> %t.jobs
+// RUN: echo '-fsyntax-only -fdiagnostics-dedup-headers -I %S/Inputs %s' >> %t.jobs
+// RUN: %clang -cc1server < %t.jobs 2>&1 | FileCheck %s
+// RUN: echo '-fsyntax-only -I %S/Inputs %s' >> %t.nodedup.jobs
+// RUN: echo '-fsyntax-only -I %S/Inputs %s' >> %t.nodedup.jobs
+// RUN: %clang -cc1server < %t.nodedup.jobs 2>&1 \
+// RUN:   | FileCheck %s -check-prefix=NODEDUP
+
+// Warnings in headers are printed by the first job only; warnings in the main
+// file are printed by every job.
+
+// CHECK: dedup-headers.h:1:{{[0-9]+}}: warning: self-comparison
+// CHECK: diagnostics-dedup-headers.c:[[@LINE+12]]:{{[0-9]+}}: warning: self-comparison
+// CHECK: {{^}}exit 0
+// CHECK-NOT: dedup-headers.h:1
+// CHECK: diagnostics-dedup-headers.c:[[@LINE+9]]:{{[0-9]+}}: warning: self-comparison
+// CHECK: {{^}}exit 0
+
+// NODEDUP: dedup-headers.h:1:{{[0-9]+}}: warning: self-comparison
+// NODEDUP: {{^}}exit 0
+// NODEDUP: dedup-headers.h:1:{{[0-9]+}}: warning: self-comparison
+// NODEDUP: {{^}}exit 0
+
+#include "dedup-headers.h"
+int f(int y) { return y == y; }
@@ -0,0 +1,17 @@
+// RUN: rm -rf %t.dir
+// RUN: mkdir -p %t.dir
+// RUN: echo 'int x;' > %t.dir/header-cost.h
+// RUN: %clang_cc1 -fsyntax-only -I %t.dir -header-cost-file %t.json %s
+// RUN: FileCheck %s < %t.json
+
+#include "header-cost.h"
+#include "header-cost.h"
+
+int f(void) { return x; }
+
+// CHECK: "main-file": "{{.*}}header-cost-file.c",
+// CHECK: "files": [
+// CHECK-DAG: {"name": "{{.*}}header-cost-file.c", "entries": 1, "size": {{[1-9][0-9]*}}, "self-time-us": {{[0-9]+}}, "total-time-us": {{[0-9]+}}, "self-ast-bytes": {{[0-9]+}}, "total-ast-bytes": {{[0-9]+}}}
+// CHECK-DAG: {"name": "{{.*}}header-cost.h", "entries": 2, "size": 7,
+// CHECK-DAG: {"name": "<built-in>", "entries": 1, "size": 0,
+// CHECK: ]
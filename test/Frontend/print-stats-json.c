@@ -0,0 +1,17 @@
+// RUN: %clang_cc1 -fsyntax-only -print-stats-json=%t.json %s
+// RUN: FileCheck --input-file=%t.json %s
+
+// CHECK: {"ast":{"allocated-bytes":{{[0-9]+}},"side-table-bytes":{{[0-9]+}},"types":{
+// CHECK-SAME: "Pointer":{"count":{{[1-9][0-9]*}},"bytes":{{[1-9][0-9]*}}}
+// CHECK-SAME: "folding-sets":{"ExtQualNodes":{"count":0,"bucket-bytes":{{[0-9]+}}}
+// CHECK-SAME: "PointerTypes":{"count":{{[1-9][0-9]*}},"bucket-bytes":{{[1-9][0-9]*}}}
+// CHECK-SAME: "decls":{
+// CHECK-SAME: "Function":{"count":{{[1-9][0-9]*}},"bytes":{{[1-9][0-9]*}}}
+// CHECK-SAME: "Var":{"count":{{[1-9][0-9]*}},"bytes":{{[1-9][0-9]*}}}
+// CHECK-SAME: "stmts":{
+// CHECK-SAME: "ReturnStmt":{"count":1,"bytes":{{[1-9][0-9]*}}}
+// CHECK-SAME: "source-manager":{"content-cache-bytes":{{[0-9]+}},"data-structure-bytes":{{[0-9]+}},"malloc-buffer-bytes":{{[0-9]+}},"mmap-buffer-bytes":{{[0-9]+}}}}
+
+int *p;
+
+int f(void) { return *p; }
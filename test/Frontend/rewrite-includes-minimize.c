@@ -0,0 +1,52 @@
+// RUN: %clang_cc1 -E -frewrite-includes -fminimize-rewritten-includes -I %S/Inputs %s -o %t.c
+// RUN: FileCheck -strict-whitespace %s < %t.c
+// RUN: not grep trailing %t.c
+// RUN: not grep STARTCOMPARE %t.c
+// RUN: %clang_cc1 -fsyntax-only -Werror -I %S/Inputs %t.c
+// RUN: %clang -### -E -frewrite-includes -fminimize-rewritten-includes %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=DRIVER %s
+// DRIVER: "-frewrite-includes" "-fminimize-rewritten-includes"
+// STARTCOMPARE
+#include "rewrite-includes-minimize.h"
+#include "rewrite-includes-minimize.h"
+#if 0
+this is not C code
+#include "does-not-exist.h"
+#else
+int x; /* multi-line
+comment */ int y[__LINE__ == 17 ? 1 : -1];
+#endif
+#define STR "not // a comment"
+#ifdef UNDEFINED_MACRO
+int skipped;
+#elif 1
+int kept;
+#endif
+const char *s = STR; // trailing
+// ENDCOMPARE
+
+// CHECK: {{^}} {{$}}
+// CHECK-NEXT: {{^}}#if 0 /* expanded by -frewrite-includes */{{$}}
+// CHECK-NEXT: {{^}}#include "rewrite-includes-minimize.h"{{$}}
+// CHECK-NEXT: {{^}}#endif /* expanded by -frewrite-includes */{{$}}
+// CHECK-NEXT: {{^}}# {{[0-9]+}} "{{.*}}rewrite-includes-minimize.c"{{$}}
+// CHECK-NEXT: {{^}}# 1 "{{.*}}Inputs{{[/\\]}}rewrite-includes-minimize.h" 1{{$}}
+// CHECK-NEXT: {{^}} {{$}}
+// CHECK-NEXT: {{^}}#ifndef REWRITE_INCLUDES_MINIMIZE_H{{$}}
+// CHECK-NEXT: {{^}}#define REWRITE_INCLUDES_MINIMIZE_H{{$}}
+// CHECK-NEXT: {{^}}int in_header;  {{$}}
+// CHECK-NEXT: {{^}}#endif{{$}}
+// CHECK: {{^}}#if 0{{$}}
+// CHECK-NEXT: {{^}}{{$}}
+// CHECK-NEXT: {{^}}{{$}}
+// CHECK-NEXT: {{^}}#else{{$}}
+// CHECK: {{^}}int x;  \{{$}}
+// CHECK-NEXT: {{^}} int y[__LINE__ == 17 ? 1 : -1];{{$}}
+// CHECK-NEXT: {{^}}#endif{{$}}
+// CHECK: {{^}}#define STR "not // a comment"{{$}}
+// CHECK-NEXT: {{^}}#ifdef UNDEFINED_MACRO{{$}}
+// CHECK-NEXT: {{^}}{{$}}
+// CHECK-NEXT: {{^}}#elif 1{{$}}
+// CHECK: {{^}}int kept;{{$}}
+// CHECK-NEXT: {{^}}#endif{{$}}
+// CHECK: {{^}}const char *s = STR;  {{$}}
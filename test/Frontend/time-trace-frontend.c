@@ -0,0 +1,17 @@
+// RUN: %clang_cc1 -emit-llvm -o %t.ll -ftime-trace=%t.json -I %S/Inputs %s
+// RUN: FileCheck --input-file=%t.json %s
+
+// CHECK: {"traceEvents":[
+// CHECK-DAG: "name":"Source","args":{"detail":"{{.*}}time-trace-header.h","nested":0}}
+// CHECK-DAG: "name":"ActOnEndOfTranslationUnit"
+// CHECK-DAG: "name":"ParseAST"
+// CHECK-DAG: "name":"CodeGenModule::Release"
+// CHECK-DAG: "name":"EmitBackendOutput"
+// CHECK-DAG: "name":"ExecuteCompiler"
+// CHECK-DAG: "tid":1,"ph":"X","ts":0,"dur":{{[0-9]+}},"name":"Total ParseAST","args":{"count":1}}
+// CHECK-DAG: "tid":1,"ph":"X","ts":0,"dur":{{[0-9]+}},"name":"Total Source","args":{"count":1}}
+// CHECK: ]}
+
+#include "time-trace-header.h"
+
+int use(void) { return from_header(); }
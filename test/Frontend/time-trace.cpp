@@ -0,0 +1,22 @@
+// RUN: %clang_cc1 -fsyntax-only -ftime-trace=%t.json %s
+// RUN: FileCheck --input-file=%t.json %s
+
+// CHECK: {"traceEvents":[
+// CHECK-DAG: "name":"InstantiateClass","args":{"detail":"ns::Box<int>","nested":{{[0-9]+}},"ast-bytes":{{[0-9]+}}}}
+// CHECK-DAG: "name":"InstantiateFunction","args":{"detail":"ns::Box<int>::get","nested":{{[0-9]+}},"ast-bytes":{{[0-9]+}}}}
+// CHECK-DAG: "name":"DeduceTemplateArguments","args":{"detail":"ns::twice"
+// CHECK-DAG: "name":"PerformPendingInstantiations","args":{"detail":"","nested":{{[1-9][0-9]*}}}}
+// CHECK: ]}
+
+namespace ns {
+template<typename T> struct Box {
+  T get() { return T(); }
+};
+
+template<typename T> T twice(T t) { return t + t; }
+}
+
+int use() {
+  ns::Box<int> b;
+  return b.get() + ns::twice(1);
+}
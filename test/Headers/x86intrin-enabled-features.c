@@ -0,0 +1,23 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -fsyntax-only -ffreestanding %s -verify -DALL
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -fsyntax-only -ffreestanding %s -verify -D__CLANG_INTRIN_ENABLED_FEATURES_ONLY
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -fsyntax-only -ffreestanding %s -verify -D__CLANG_INTRIN_ENABLED_FEATURES_ONLY -target-feature +avx512f -target-feature +tbm -DALL
+// expected-no-diagnostics
+
+#include <x86intrin.h>
+
+// SSE2 is enabled on x86-64, so its intrinsics are always declared.
+#ifndef __EMMINTRIN_H
+#error emmintrin.h not included
+#endif
+
+#if defined(ALL) != defined(__AVX512FINTRIN_H)
+#error avx512fintrin.h included unexpectedly
+#endif
+
+#if defined(ALL) != defined(__TBMINTRIN_H)
+#error tbmintrin.h included unexpectedly
+#endif
+
+#if defined(__IMMINTRIN_ALL_FEATURES) || defined(__X86INTRIN_ALL_FEATURES)
+#error internal macro leaked
+#endif
@@ -0,0 +1 @@
+int store_global(int);
@@ -0,0 +1,11 @@
+// RUN: c-index-test core -benchmark-indexing -repeat 2 -j 2 %s -- -target x86_64-apple-macosx10.7 | FileCheck %s
+
+void foo(void);
+void bar(void) { foo(); }
+
+// CHECK: files: 1, repetitions: 2, threads: 2
+// CHECK-NEXT: parse time: {{[0-9.]+}}s
+// CHECK-NEXT: index time: {{[0-9.]+}}s
+// CHECK-NEXT: occurrences: 6
+// CHECK-NEXT: wall time: {{[0-9.]+}}s
+// CHECK-NEXT: peak RSS: {{[0-9]+}} KB
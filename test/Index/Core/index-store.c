@@ -0,0 +1,40 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -index-store-path %t/idx -fsyntax-only -I %S/Inputs -o %t/first %s
+// RUN: %clang_cc1 -index-store-path %t/idx -fsyntax-only -I %S/Inputs -o %t/second %s
+// RUN: cat %t/idx/units/first-* | FileCheck -check-prefix=UNIT %s
+// RUN: cat %t/idx/units/second-* | FileCheck -check-prefix=UNIT2 %s
+// RUN: ls %t/idx/records | FileCheck -check-prefix=RECORDS %s
+// RUN: cat %t/idx/records/index-store.h-* | FileCheck -check-prefix=HEADER %s
+// RUN: cat %t/idx/records/index-store.c-* | FileCheck -check-prefix=MAIN %s
+
+// UNIT: clang-index-unit 1
+// UNIT-NEXT: main	{{.*}}index-store.c
+// UNIT-NEXT: output	{{.*}}first
+// UNIT-NEXT: record	index-store.h-{{[0-9a-f]+}}	{{.*}}index-store.h
+// UNIT-NEXT: record	index-store.c-{{[0-9a-f]+}}	{{.*}}index-store.c
+
+// UNIT2: output	{{.*}}second
+
+// Both units have the same occurrences, so each record is only written once.
+// RECORDS: index-store.c-
+// RECORDS-NEXT: index-store.h-
+// RECORDS-NOT: index-store
+
+// HEADER: clang-index-record 1
+// HEADER-NEXT: symbol	{{[0-9a-f]+}}	function	C	c:@F@store_global	store_global
+// HEADER-NEXT: occ	0	1	1	5
+#include "index-store.h"
+
+// MAIN: clang-index-record 1
+// MAIN-NEXT: symbol	{{[0-9a-f]+}}	function	C	c:@F@store_global	store_global
+// MAIN-NEXT: symbol	{{[0-9a-f]+}}	function	C	c:@F@caller	caller
+int store_global(int x) {
+// MAIN-NEXT: occ	0	2	[[@LINE-1]]	5
+  return x + 1;
+}
+
+void caller(void) {
+// MAIN-NEXT: occ	1	2	[[@LINE-1]]	6
+  store_global(2);
+// MAIN-NEXT: occ	0	24	[[@LINE-1]]	3	{{.*}}2000:1
+}
@@ -0,0 +1,23 @@
+// Note: the run lines follow their respective tests, since line/column
+// matter in this test.
+int fooBar;
+int foobaz;
+int other;
+#define FOO_MACRO 1
+void f(void) {
+  
+}
+
+// RUN: env CINDEXTEST_COMPLETION_PREFIX=foo c-index-test -code-completion-at=%s:8:3 %s | FileCheck -check-prefix=CHECK-PREFIX %s
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_COMPLETION_CACHING=1 CINDEXTEST_COMPLETION_PREFIX=foo c-index-test -code-completion-at=%s:8:3 %s | FileCheck -check-prefix=CHECK-PREFIX %s
+// CHECK-PREFIX-NOT: {TypedText other}
+// CHECK-PREFIX-NOT: {TypedText int}
+// CHECK-PREFIX: macro definition:{TypedText FOO_MACRO}
+// CHECK-PREFIX: VarDecl:{ResultType int}{TypedText fooBar}
+// CHECK-PREFIX: VarDecl:{ResultType int}{TypedText foobaz}
+// CHECK-PREFIX-NOT: {TypedText other}
+
+// RUN: env CINDEXTEST_COMPLETION_PREFIX=foob CINDEXTEST_COMPLETION_MAX_RESULTS=1 c-index-test -code-completion-at=%s:8:3 %s | FileCheck -check-prefix=CHECK-MAX %s
+// CHECK-MAX: VarDecl:{ResultType int}{TypedText foo{{[bB]}}a
+// CHECK-MAX-NOT: VarDecl:
+// CHECK-MAX: Completion contexts:
@@ -0,0 +1,14 @@
+#include "a.h"
+A a;
+
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_FAILONERROR=1 CINDEXTEST_REMAP_AFTER_TRIAL=1 \
+// RUN:   c-index-test -test-load-source-reparse 3 local \
+// RUN:   "-remap-file=%s,%s.remap" -I%S/Inputs %s | FileCheck %s
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_FAILONERROR=1 CINDEXTEST_REMAP_AFTER_TRIAL=1 \
+// RUN:   CINDEXTEST_PREAMBLES_IN_MEMORY=1 c-index-test -test-load-source-reparse 3 local \
+// RUN:   "-remap-file=%s,%s.remap" -I%S/Inputs %s | FileCheck %s
+
+// The remapped file only adds an include to the end of the preamble, so the
+// preamble is rebuilt on top of the previous one.
+// CHECK: preamble-reparse-incremental.c:2:3: VarDecl=a:2:3 Extent=[2:1 - 2:4]
+// CHECK: preamble-reparse-incremental.c:3:3: VarDecl=b:3:3 Extent=[3:1 - 3:4]
@@ -10,6 +10,9 @@ namespace integral {
   static_assert(1'000'000 == 0xf'4240, "");
   static_assert(0'004'000'000 == 0x10'0000, "");
   static_assert(0b0101'0100 == 0x54, "");
+  static_assert(18'446'744'073'709'551'615u == 0xffff'ffff'ffff'ffff, "");
+  static_assert(0'1'777'777'777'777'777'777'777 == 0xffff'ffff'ffff'ffff, "");
+  unsigned long long big = 18'446'744'073'709'551'616u; // expected-error {{integer literal is too large to be represented in any integer type}}
 
   int a = 123'; //'; // expected-error {{expected ';'}}
   int b = 0'xff; // expected-error {{digit separator cannot appear at end of digit sequence}} expected-error {{suffix 'xff' on integer}}
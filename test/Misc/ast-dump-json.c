@@ -0,0 +1,22 @@
+// RUN: %clang_cc1 -ast-dump-json -ast-dump-filter Test %s | FileCheck %s
+
+int TestVar = 1 + 2;
+// CHECK:      {"id":0,"kind":"VarDecl","name":"TestVar","type":"int","file":"{{.*}}ast-dump-json.c","line":3,"col":5}
+// CHECK-NEXT: {"id":1,"parent":0,"kind":"BinaryOperator","type":"int","opcode":"+","line":3,"col":15}
+// CHECK-NEXT: {"id":2,"parent":1,"kind":"IntegerLiteral","type":"int","value":"1","line":3,"col":15}
+// CHECK-NEXT: {"id":3,"parent":1,"kind":"IntegerLiteral","type":"int","value":"2","line":3,"col":19}
+
+void TestFunc(int x) {
+  x = -x;
+}
+// CHECK-NEXT: {"id":4,"kind":"FunctionDecl","name":"TestFunc","type":"void (int)","line":9,"col":6}
+// CHECK-NEXT: {"id":5,"parent":4,"kind":"ParmVarDecl","name":"x","type":"int","line":9,"col":19}
+// CHECK-NEXT: {"id":6,"parent":4,"kind":"CompoundStmt","line":9,"col":22}
+// CHECK-NEXT: {"id":7,"parent":6,"kind":"BinaryOperator","type":"int","opcode":"=","line":10,"col":3}
+// CHECK-NEXT: {"id":8,"parent":7,"kind":"DeclRefExpr","type":"int","name":"x","line":10,"col":3}
+// CHECK-NEXT: {"id":9,"parent":7,"kind":"UnaryOperator","type":"int","opcode":"-","line":10,"col":7}
+// CHECK-NEXT: {"id":10,"parent":9,"kind":"ImplicitCastExpr","type":"int","line":10,"col":8}
+// CHECK-NEXT: {"id":11,"parent":10,"kind":"DeclRefExpr","type":"int","name":"x","line":10,"col":8}
+
+void Other(void) {}
+// CHECK-NOT: "name":"Other"
@@ -0,0 +1,18 @@
+// RUN: rm -f %t.a.dia %t.b.dia %t.dia
+// RUN: not %clang -fsyntax-only -DFIRST %s --serialize-diagnostics %t.a.dia > /dev/null 2>&1
+// RUN: not %clang -fsyntax-only %s --serialize-diagnostics %t.b.dia > /dev/null 2>&1
+// RUN: c-index-test core -merge-diagnostics -o %t.dia %t.a.dia %t.b.dia
+// RUN: c-index-test -read-diagnostics %t.dia 2>&1 | FileCheck %s
+
+#ifdef FIRST
+#error first
+#else
+#error second
+#endif
+#warning both
+
+// CHECK: {{.*[/\\]}}serialized-diags-merge.c:8:2: error: first []
+// CHECK: {{.*[/\\]}}serialized-diags-merge.c:12:2: warning: both [-W#warnings]
+// CHECK: {{.*[/\\]}}serialized-diags-merge.c:10:2: error: second []
+// CHECK: {{.*[/\\]}}serialized-diags-merge.c:12:2: warning: both [-W#warnings]
+// CHECK: Number of diagnostics: 4
@@ -0,0 +1,24 @@
+// RUN: rm -rf %t
+// Create the global module index with the first module only.
+// RUN: %clang_cc1 -fmodules-cache-path=%t -fdisable-module-hash -fmodules -fimplicit-module-maps -I %S/Inputs %s -DFIRST_MODULE_ONLY
+// RUN: ls %t|grep modules.idx
+// Add the second module, which is merged into the existing index.
+// RUN: %clang_cc1 -fmodules-cache-path=%t -fdisable-module-hash -fmodules -fimplicit-module-maps -I %S/Inputs %s -verify
+// Run and use the merged index for selector lookups
+// RUN: %clang_cc1 -fmodules-cache-path=%t -fdisable-module-hash -fmodules -fimplicit-module-maps -I %S/Inputs %s -verify -print-stats 2>&1 | FileCheck %s
+
+@import MethodPoolA;
+#ifndef FIRST_MODULE_ONLY
+@import MethodPoolB;
+
+// expected-note@Inputs/MethodPoolA.h:7{{using}}
+// expected-note@Inputs/MethodPoolB.h:12{{also found}}
+
+void testMethod2(id object) {
+  // The module file indexed first must still be found after the merge.
+  [object method2:1]; // expected-warning{{multiple methods named 'method2:' found}}
+}
+#endif
+
+// CHECK: *** Global Module Index Statistics:
+// CHECK: selector lookups succeeded
@@ -0,0 +1,24 @@
+// RUN: rm -rf %t
+// Run and create the global module index
+// RUN: %clang_cc1 -fmodules-cache-path=%t -fdisable-module-hash -fmodules -fimplicit-module-maps -I %S/Inputs %s -verify
+// RUN: ls %t|grep modules.idx
+// Run and use the global module index for selector lookups
+// RUN: %clang_cc1 -fmodules-cache-path=%t -fdisable-module-hash -fmodules -fimplicit-module-maps -I %S/Inputs %s -verify -print-stats 2>&1 | FileCheck %s
+
+@import MethodPoolA;
+@import MethodPoolB;
+
+// expected-note@Inputs/MethodPoolA.h:7{{using}}
+// expected-note@Inputs/MethodPoolB.h:12{{also found}}
+
+void testMethod2(id object) {
+  // Both module files must be found through the selector index.
+  [object method2:1]; // expected-warning{{multiple methods named 'method2:' found}}
+}
+
+void testMethod4(id object) {
+  [object method4]; // expected-warning{{instance method '-method4' not found (return type defaults to 'id')}}
+}
+
+// CHECK: *** Global Module Index Statistics:
+// CHECK: selector lookups succeeded
@@ -0,0 +1,19 @@
+// RUN: rm -rf %t %t.cache
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t -fmodule-map-cache=%t.cache -I %S/Inputs/module-map-cache -fsyntax-only %s -verify
+// RUN: FileCheck --check-prefix=CACHE %s < %t.cache
+// CACHE: clang-module-map-cache 1
+// CACHE-DAG: {{^[0-9]+ [0-9]+ [0-9]+ [0-9]+}} A{{$}}
+// CACHE-DAG: {{^[0-9]+ [0-9]+ [0-9]+ [0-9]+}} B{{$}}
+
+// With the cache, looking up B no longer parses the module map declaring A.
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t -fmodule-map-cache=%t.cache -I %S/Inputs/module-map-cache -fsyntax-only %s -verify -print-stats 2>&1 | FileCheck --check-prefix=STATS %s
+// STATS: 1 module map files not parsed due to the module map cache
+
+// RUN: %clang -### -fmodule-map-cache=%t.cache -c %s 2>&1 | FileCheck --check-prefix=DRIVER %s
+// DRIVER: "-cc1"
+// DRIVER-SAME: "-fmodule-map-cache={{.*}}.cache"
+
+// expected-no-diagnostics
+@import B;
+
+int test() { return b; }
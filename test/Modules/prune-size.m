@@ -0,0 +1,35 @@
+// Test the pruning of the least recently used module files when the module
+// cache grows beyond its size limit.
+#ifdef IMPORT_DEPENDS_ON_MODULE
+@import DependsOnModule;
+#else
+@import Module;
+#endif
+
+// REQUIRES: shell
+
+// Clear out the module cache
+// RUN: rm -rf %t
+// Run Clang twice so we end up creating the timestamp file (the second time).
+// RUN: %clang_cc1 -DIMPORT_DEPENDS_ON_MODULE -fmodules-ignore-macro=DIMPORT_DEPENDS_ON_MODULE -fmodules -fimplicit-module-maps -F %S/Inputs -fmodules-cache-path=%t -fmodules-cache-max-size=1 %s -verify
+// RUN: %clang_cc1 -DIMPORT_DEPENDS_ON_MODULE -fmodules-ignore-macro=DIMPORT_DEPENDS_ON_MODULE -fmodules -fimplicit-module-maps -F %S/Inputs -fmodules-cache-path=%t -fmodules-cache-max-size=1 %s -verify
+// RUN: ls %t | grep modules.timestamp
+// RUN: grep ^.*/Module.*pcm %t/modules.access
+// RUN: grep ^.*/DependsOnModule.*pcm %t/modules.access
+
+// Without a size limit, pruning keeps the module files, which are new.
+// RUN: touch -m -a -t 201101010000 %t/modules.timestamp
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -F %S/Inputs -fmodules-cache-path=%t -fmodules -fmodules-prune-interval=172800 %s -verify
+// RUN: ls -R %t | grep ^Module.*pcm
+// RUN: ls -R %t | grep DependsOnModule.*pcm
+
+// With a size limit, pruning removes the module files beyond it. Module is
+// rebuilt by this compilation, DependsOnModule is not.
+// RUN: touch -m -a -t 201101010000 %t/modules.timestamp
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -F %S/Inputs -fmodules-cache-path=%t -fmodules -fmodules-prune-interval=172800 -fmodules-cache-max-size=1 %s -verify
+// RUN: ls -R %t | grep ^Module.*pcm
+// RUN: ls -R %t | not grep DependsOnModule.*pcm
+// RUN: grep ^.*/Module.*pcm %t/modules.access
+// RUN: not grep DependsOnModule %t/modules.access
+
+// expected-no-diagnostics
@@ -0,0 +1,15 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t -I %S/Inputs %s -verify
+
+// Typo correction caches the names from loaded AST files; make sure it
+// notices the names of modules imported after the first correction.
+
+@import diamond_top;
+
+int (*p1)(int *) = topp; // expected-error {{did you mean 'top'}}
+// expected-note@diamond_top.h:1 {{'top' declared here}}
+
+@import diamond_left;
+
+float (*p2)(float *) = lefft; // expected-error {{did you mean 'left'}}
+// expected-note@diamond_left.h:5 {{'left' declared here}}
@@ -0,0 +1,36 @@
+// RUN: %clang_cc1 -verify -fopenmp -fopenmp-inline-static-schedule -x c++ -triple x86_64-unknown-unknown -emit-llvm %s -o - | FileCheck %s
+// expected-no-diagnostics
+
+void foo(int);
+
+// CHECK-LABEL: define {{.*}}void @{{.*}}static_loop{{.*}}(
+void static_loop(int n) {
+// CHECK-NOT:   call void @__kmpc_for_static_init_4(
+// CHECK:       [[TID:%.+]] = call i32 @omp_get_thread_num()
+// CHECK:       [[NTH:%.+]] = call i32 @omp_get_num_threads()
+// CHECK:       [[LB:%.+]] = load i32, i32* [[LB_ADDR:%.+]],
+// CHECK:       [[UB:%.+]] = load i32, i32* [[UB_ADDR:%.+]],
+// CHECK:       [[DIFF:%.+]] = sub i32 [[UB]], [[LB]]
+// CHECK:       [[TRIP:%.+]] = add i32 [[DIFF]], 1
+// CHECK:       udiv i32 [[TRIP]], [[NTH]]
+// CHECK:       urem i32 [[TRIP]], [[NTH]]
+// CHECK:       store i32 {{%.+}}, i32* [[LB_ADDR]],
+// CHECK:       store i32 {{%.+}}, i32* [[UB_ADDR]],
+// CHECK-NOT:   call void @__kmpc_for_static_fini(
+// CHECK:       call void @__kmpc_barrier(
+#pragma omp for schedule(static)
+  for (int i = 0; i < n; ++i)
+    foo(i);
+// Chunked and ordered loops still call the runtime.
+// CHECK:       call void @__kmpc_for_static_init_4(
+// CHECK:       call void @__kmpc_for_static_fini(
+#pragma omp for schedule(static, 4)
+  for (int i = 0; i < n; ++i)
+    foo(i);
+// CHECK:       call void @__kmpc_dispatch_init_4(
+#pragma omp for schedule(static) ordered
+  for (int i = 0; i < n; ++i)
+#pragma omp ordered
+    foo(i);
+// CHECK:       ret void
+}
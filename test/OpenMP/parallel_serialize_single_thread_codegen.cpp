@@ -0,0 +1,45 @@
+// RUN: %clang_cc1 -verify -fopenmp -fopenmp-serialize-single-thread -x c++ -triple x86_64-unknown-unknown -emit-llvm %s -o - | FileCheck %s
+// expected-no-diagnostics
+
+void foo();
+bool cond();
+
+template <int C>
+void tmain() {
+#pragma omp parallel num_threads(C)
+  foo();
+}
+
+// CHECK-LABEL: define {{.*}}void @{{.*}}single{{.*}}()
+void single() {
+// CHECK-NOT:   call {{.*}}void @__kmpc_push_num_threads(
+// CHECK-NOT:   call {{.*}}void @__kmpc_push_proc_bind(
+// CHECK-NOT:   call {{.*}}void {{.*}} @__kmpc_fork_call(
+// CHECK:       call {{.*}}void @__kmpc_serialized_parallel(
+// CHECK:       call {{.*}}void [[OUTLINED:@.+]](i32* {{.+}}, i32* {{.+}})
+// CHECK:       call {{.*}}void @__kmpc_end_serialized_parallel(
+#pragma omp parallel num_threads(1) proc_bind(close)
+  foo();
+// The condition is still evaluated.
+// CHECK:       call {{.*}}zeroext i1 @{{.*}}cond{{.*}}()
+// CHECK-NOT:   call {{.*}}void {{.*}} @__kmpc_fork_call(
+// CHECK:       call {{.*}}void @__kmpc_serialized_parallel(
+#pragma omp parallel num_threads(2 - 1) if (cond())
+  foo();
+// CHECK-NOT:   call {{.*}}void {{.*}} @__kmpc_fork_call(
+// CHECK:       call {{.*}}void @{{.*}}tmain{{.*}}()
+  tmain<1>();
+// CHECK:       call {{.*}}void @{{.*}}tmain{{.*}}()
+  tmain<4>();
+// CHECK:       ret void
+}
+
+// CHECK:       define {{.*}}void @{{.*}}tmainILi1EEvv()
+// CHECK-NOT:   call {{.*}}void {{.*}} @__kmpc_fork_call(
+// CHECK:       call {{.*}}void @__kmpc_serialized_parallel(
+// CHECK:       ret void
+
+// CHECK:       define {{.*}}void @{{.*}}tmainILi4EEvv()
+// CHECK:       call {{.*}}void @__kmpc_push_num_threads({{.+}}, i32 4)
+// CHECK:       call {{.*}}void {{.*}} @__kmpc_fork_call(
+// CHECK:       ret void
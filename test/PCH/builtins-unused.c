@@ -0,0 +1,16 @@
+// Builtins that the PCH never names are still known when it is used.
+
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-pch -o %t %S/builtins.h
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -include-pch %t -fsyntax-only -verify %s
+
+// expected-no-diagnostics
+
+#if !__has_builtin(__builtin_ia32_pause) || !__has_builtin(__builtin_expect)
+#error missing builtin
+#endif
+
+void test() {
+  __builtin_ia32_pause();
+  if (__builtin_expect(__builtin_strlen("abc") == 3, 1))
+    printf("%d", __builtin_abs(-1));
+}
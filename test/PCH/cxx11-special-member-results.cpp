@@ -0,0 +1,21 @@
+// Test this without pch.
+// RUN: %clang_cc1 -std=c++11 -include %S/cxx11-special-member-results.h -fsyntax-only -verify %s
+
+// Test with pch.
+// RUN: %clang_cc1 -std=c++11 -x c++-header -emit-pch -o %t %S/cxx11-special-member-results.h
+// RUN: %clang_cc1 -std=c++11 -include-pch %t -fsyntax-only -verify %s
+
+// The results of the special member lookups made while building the PCH are
+// reused by its users.
+
+void use(Holder &H, NoCopy &N, Trivial &T) {
+  Holder Moved(static_cast<Holder &&>(H));
+  Holder Copy(H); // expected-error {{call to implicitly-deleted copy constructor of 'Holder'}}
+  NoCopy NCopy(N); // expected-error {{call to deleted constructor of 'NoCopy'}}
+  Trivial TCopy(T);
+  static_assert(__is_trivially_copyable(Trivial), "");
+  static_assert(!__is_trivially_copyable(Holder), "");
+}
+
+// expected-note@cxx11-special-member-results.h:* 1+ {{explicitly marked deleted here}}
+// expected-note@cxx11-special-member-results.h:* {{copy constructor of 'Holder' is implicitly deleted because field 'N' has a deleted copy constructor}}
@@ -0,0 +1,21 @@
+// Header for PCH test cxx11-special-member-results.cpp
+
+struct NoCopy {
+  NoCopy();
+  NoCopy(const NoCopy &) = delete;
+  NoCopy(NoCopy &&);
+};
+
+struct Holder {
+  NoCopy N;
+};
+
+struct Trivial {
+  int I;
+};
+
+// Look up the special members while building the PCH.
+inline void useInHeader(Holder &&H, Trivial &T) {
+  Holder Moved(static_cast<Holder &&>(H));
+  Trivial Copy(T);
+}
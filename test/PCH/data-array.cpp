@@ -0,0 +1,50 @@
+// Test this without pch.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -std=c++11 -include %s -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -std=c++11 -include %s -ast-dump -ast-dump-filter bytes %s | FileCheck %s --check-prefix=DUMP
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -std=c++11 -include %s -ast-print %s | FileCheck %s --check-prefix=PRINT
+
+// Test with pch.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -std=c++11 -emit-pch -o %t %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -std=c++11 -include-pch %t -emit-llvm -o - %s | FileCheck %s
+
+// Long initializer lists of integer literals are stored as DataArrayExprs.
+
+#ifndef HEADER
+#define HEADER
+
+#define X8(x) x, x, x, x, x, x, x, x
+#define X64(x) X8(x), X8(x), X8(x), X8(x), X8(x), X8(x), X8(x), X8(x)
+
+extern const unsigned char bytes[] = { 1, 255, 'a', X64(7) };
+constexpr short shorts[70] = { 1, 300, X64(2) };
+
+template<typename T> int get(int i) {
+  static const T table[] = { X64(3), 4 };
+  static const unsigned fixed[] = { X64(5) };
+  return table[i] + fixed[i];
+}
+
+#else
+
+static_assert(sizeof(bytes) == 67, "");
+static_assert(shorts[1] == 300 && shorts[65] == 2 && shorts[69] == 0, "");
+
+int sum(int i) {
+  unsigned short local[] = { X64(9), 10 };
+  return local[i] + shorts[i] + get<int>(i) + get<long long>(i);
+}
+
+#endif
+
+// CHECK-DAG: @bytes = constant [67 x i8] c"\01\FFa{{(\\07)+}}"
+// CHECK-DAG: @_ZL6shorts = internal constant [70 x i16] [i16 1, i16 300, i16 2, {{.*}}, i16 2, i16 0, i16 0, i16 0, i16 0]
+// CHECK-DAG: = private unnamed_addr constant [65 x i16] [i16 9, {{.*}}, i16 10]
+// CHECK-DAG: @_ZZ3getIiEiiE5table = linkonce_odr constant [65 x i32] [i32 3, {{.*}}, i32 4]
+// CHECK-DAG: @_ZZ3getIiEiiE5fixed = linkonce_odr constant [64 x i32] [i32 5, {{.*}}, i32 5]
+// CHECK-DAG: @_ZZ3getIxEiiE5table = linkonce_odr constant [65 x i64] [i64 3, {{.*}}, i64 4]
+
+// DUMP: VarDecl {{.*}} bytes 'const unsigned char [67]' cinit
+// DUMP-NEXT: DataArrayExpr {{.*}} 'const unsigned char [67]'
+
+// PRINT: bytes[67] = {1, 255, 'a', 7, 7,
+// PRINT: shorts[70] = {1, 300, 2, 2,
@@ -0,0 +1,20 @@
+// RUN: %clang_cc1 -std=c++11 -emit-pch -o %t %s
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -include-pch %t -verify %s
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -include-pch %t -print-stats %s 2>&1 | FileCheck %s
+
+// CHECK: {{[0-9]+}}/{{[0-9]+}} function bodies read ({{.*}}%), {{[0-9]+}} never read
+
+#ifndef HEADER
+#define HEADER
+
+constexpr int used() { return 1; }
+int unused1(int x) { return x * 2; }
+inline int unused2(int x) { return x + 3; }
+
+#else
+
+// expected-no-diagnostics
+
+int array[used()];
+
+#endif
@@ -0,0 +1,39 @@
+// RUN: %clang_cc1 -emit-pch -o %t %s
+// RUN: %clang_cc1 -fsyntax-only -include-pch %t -lazy-pch-macros -verify %s
+// RUN: %clang_cc1 -fsyntax-only -include-pch %t -lazy-pch-macros -print-stats %s 2>&1 | FileCheck %s
+
+// CHECK: {{[0-9]+}}/{{[0-9]+}} deferred macro histories read
+
+#ifndef HEADER
+#define HEADER
+
+#define ONE 1
+#define TWO (ONE + ONE)
+#define GONE 3
+#undef GONE
+#define REDEFINED 4
+#define HIDDEN 5
+
+#else
+
+// expected-no-diagnostics
+
+#ifndef ONE
+#error ONE should be defined
+#endif
+
+#ifdef GONE
+#error GONE should not be defined
+#endif
+
+int two[TWO == 2 ? 1 : -1];
+
+#undef REDEFINED
+#define REDEFINED 6
+int redefined[REDEFINED == 6 ? 1 : -1];
+
+#if defined(HIDDEN) && HIDDEN != 5
+#error HIDDEN has the wrong value
+#endif
+
+#endif
@@ -0,0 +1,21 @@
+// REQUIRES: shell
+// RUN: rm -f %t.pch %t.stamp
+// RUN: %clang_cc1 -emit-pch -o %t.pch %s
+// RUN: touch -t 200001010000 %t.pch
+// RUN: touch -t 200001010001 %t.stamp
+
+// Regenerating an identical PCH leaves the existing file alone.
+// RUN: %clang_cc1 -emit-pch -fpch-preserve-unchanged -o %t.pch %s
+// RUN: find %t.pch -newer %t.stamp | count 0
+
+// A PCH whose contents change is still replaced.
+// RUN: %clang_cc1 -emit-pch -fpch-preserve-unchanged -DEXTRA -o %t.pch %s
+// RUN: find %t.pch -newer %t.stamp | count 1
+// RUN: %clang_cc1 -fsyntax-only -include-pch %t.pch -DEXTRA -verify %s
+
+// expected-no-diagnostics
+
+int preserved(void);
+#ifdef EXTRA
+int extra(void);
+#endif
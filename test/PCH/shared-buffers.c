@@ -0,0 +1,31 @@
+// Check that AST readers in the same process share PCH contents and, within
+// a build session, input file validation.
+
+// RUN: %clang_cc1 -emit-pch -o %t.pch %s
+// RUN: rm -f %t.jobs
+// RUN: echo '-fsyntax-only -include-pch %t.pch -print-stats %s' >> %t.jobs
+// RUN: echo '-fsyntax-only -include-pch %t.pch -print-stats %s' >> %t.jobs
+// RUN: echo '-fsyntax-only -include-pch %t.pch -print-stats -fbuild-session-timestamp=1 -fmodules-validate-once-per-build-session %s' >> %t.jobs
+// RUN: echo '-fsyntax-only -include-pch %t.pch -print-stats -fbuild-session-timestamp=1 -fmodules-validate-once-per-build-session %s' >> %t.jobs
+// RUN: %clang -cc1server < %t.jobs 2>&1 | FileCheck %s
+
+// CHECK: *** AST File Statistics:
+// CHECK-NOT: shared with other readers
+// CHECK: {{^}}exit 0
+// CHECK: *** AST File Statistics:
+// CHECK: 1/1 AST files shared with other readers
+// CHECK-NOT: validated by other readers
+// CHECK: {{^}}exit 0
+// CHECK: *** AST File Statistics:
+// CHECK-NOT: validated by other readers
+// CHECK: {{^}}exit 0
+// CHECK: *** AST File Statistics:
+// CHECK: 1 AST files validated by other readers
+// CHECK: {{^}}exit 0
+
+#ifndef HEADER
+#define HEADER
+int header_var;
+#else
+int *p = &header_var;
+#endif
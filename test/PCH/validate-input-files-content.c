@@ -0,0 +1,26 @@
+// RUN: rm -rf %t.dir
+// RUN: mkdir -p %t.dir
+// RUN: echo 'int header_decl;' > %t.dir/header.h
+// RUN: touch -t 201001010000 %t.dir/header.h
+// RUN: %clang_cc1 -x c-header %t.dir/header.h -emit-pch -o %t.dir/plain.pch
+// RUN: %clang_cc1 -x c-header %t.dir/header.h -emit-pch -o %t.dir/hashed.pch \
+// RUN:   -fvalidate-ast-input-files-content
+
+// Only the modification time changes.
+// RUN: touch -t 201101010000 %t.dir/header.h
+// RUN: %clang_cc1 -fsyntax-only -include-pch %t.dir/hashed.pch %s \
+// RUN:   -fvalidate-ast-input-files-content
+// RUN: not %clang_cc1 -fsyntax-only -include-pch %t.dir/plain.pch %s \
+// RUN:   -fvalidate-ast-input-files-content 2>&1 | FileCheck %s
+// RUN: not %clang_cc1 -fsyntax-only -include-pch %t.dir/hashed.pch %s 2>&1 \
+// RUN:   | FileCheck %s
+
+// The contents change, but not the size.
+// RUN: echo 'int header_dec2;' > %t.dir/header.h
+// RUN: not %clang_cc1 -fsyntax-only -include-pch %t.dir/hashed.pch %s \
+// RUN:   -fvalidate-ast-input-files-content 2>&1 | FileCheck %s
+
+// CHECK: fatal error: file {{.*}}header.h has been modified since the precompiled header {{.*}} was built
+// REQUIRES: shell
+
+int use = sizeof(header_decl);
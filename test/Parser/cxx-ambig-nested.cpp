@@ -0,0 +1,23 @@
+// RUN: %clang_cc1 -fsyntax-only -std=c++11 -verify %s
+// expected-no-diagnostics
+
+// Ambiguous constructs nested in other ambiguous constructs must be
+// disambiguated the same way however often the enclosing construct is parsed.
+
+typedef int T;
+template<typename U> struct S { static const int value = 0; };
+template<int N> struct I { static const int value = N; };
+
+S<T(T())> s1;
+S<T(T(T()))> s2;
+
+static_assert(I<T(I<T(1)>::value)>::value == 1, "");
+static_assert(I<T(I<T(I<T(I<T(2)>::value)>::value)>::value)>::value == 2, "");
+static_assert(sizeof(T(I<T(I<T(3)>::value)>::value)) == sizeof(int), "");
+
+void f() {
+  T(a);
+  a = I<T(I<T(4)>::value)>::value;
+  T(b) = T(I<T(5)>::value);
+  (void)(T(I<T(6)>::value) + a + b);
+}
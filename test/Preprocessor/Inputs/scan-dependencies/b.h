@@ -0,0 +1 @@
+#define B_HEADER "c.h"
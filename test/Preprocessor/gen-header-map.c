@@ -0,0 +1,16 @@
+// RUN: rm -f %t.hmap
+// RUN: %clang_cc1 -gen-header-map %t.hmap -I %S/Inputs/include-guard-cache -I %S/Inputs/header-search-directory-cache
+// RUN: %clang_cc1 -E -I %t.hmap %s | FileCheck %s
+
+// CHECK: header-search-directory-cache{{[/\\]}}found.h
+// CHECK: int found;
+// CHECK: header-search-directory-cache{{[/\\]}}sub{{[/\\]}}nested.h
+// CHECK: int nested;
+// The first search directory containing a header wins.
+// CHECK: include-guard-cache{{[/\\]}}guarded.h
+// CHECK: int guarded;
+// CHECK-NOT: int shadowed;
+
+#include "found.h"
+#include "sub/nested.h"
+#include "guarded.h"
@@ -0,0 +1,19 @@
+// RUN: %clang_cc1 -E -print-stats -fheader-search-directory-cache -I %S/Inputs/include-guard-cache -I %S/Inputs/header-search-directory-cache %s 2>&1 | FileCheck %s
+// CHECK: int found;
+// CHECK: int nested;
+// CHECK: int guarded;
+// CHECK: 2 header lookups skipped due to the directory listing cache.
+
+// The same headers are found without the cache.
+// RUN: %clang_cc1 -E -I %S/Inputs/include-guard-cache -I %S/Inputs/header-search-directory-cache %s | FileCheck --check-prefix=NOCACHE %s
+// NOCACHE: int found;
+// NOCACHE: int nested;
+// NOCACHE: int guarded;
+
+// RUN: %clang -### -fheader-search-directory-cache -c %s 2>&1 | FileCheck --check-prefix=DRIVER %s
+// DRIVER: "-cc1"
+// DRIVER-SAME: "-fheader-search-directory-cache"
+
+#include "found.h"
+#include "sub/nested.h"
+#include "guarded.h"
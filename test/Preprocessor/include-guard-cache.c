@@ -0,0 +1,19 @@
+// RUN: rm -f %t.cache
+// RUN: %clang_cc1 -fsyntax-only -finclude-guard-cache=%t.cache -I %S/Inputs/include-guard-cache %s
+// RUN: FileCheck --check-prefix=CACHE %s < %t.cache
+// CACHE: clang-include-guard-cache 1
+// CACHE-NEXT: {{^[0-9]+ [0-9]+ [0-9]+ [0-9]+}} GUARDED_H{{$}}
+
+// With the guard macro already defined, the cache lets us skip the header.
+// RUN: %clang_cc1 -E -DGUARDED_H -finclude-guard-cache=%t.cache -I %S/Inputs/include-guard-cache %s | FileCheck --check-prefix=SKIPPED %s
+// SKIPPED-NOT: guarded.h
+
+// Without the cache, the header has to be entered to find its guard.
+// RUN: %clang_cc1 -E -DGUARDED_H -I %S/Inputs/include-guard-cache %s | FileCheck --check-prefix=ENTERED %s
+// ENTERED: guarded.h
+
+// If the guard macro isn't defined, the header is still included.
+// RUN: %clang_cc1 -E -finclude-guard-cache=%t.cache -I %S/Inputs/include-guard-cache %s | FileCheck --check-prefix=INCLUDED %s
+// INCLUDED: int guarded;
+
+#include "guarded.h"
@@ -0,0 +1,16 @@
+// RUN: %clang_cc1 -E -compact-macro-arg-locations %s | FileCheck %s
+// RUN: not %clang_cc1 -fsyntax-only -compact-macro-arg-locations %s 2>&1 \
+// RUN:   | FileCheck %s -check-prefix=DIAG
+
+#define ID(x) x
+#define TWICE(x) ID(x) ID(x)
+#define PAIR(a, b) ID(a) ID(b)
+
+// Tokens produced by different macros share one macro argument expansion but
+// keep their spelling.
+int v = TWICE(PAIR(1 +, 2));
+// CHECK: int v = 1 + 2 1 + 2;
+
+// DIAG: macro_arg_slocentry_compact.c:[[@LINE+2]]:20: error: use of undeclared identifier 'undeclared_a'
+// DIAG: macro_arg_slocentry_compact.c:[[@LINE+1]]:36: error: use of undeclared identifier 'undeclared_b'
+int w = TWICE(PAIR(undeclared_a +, undeclared_b));
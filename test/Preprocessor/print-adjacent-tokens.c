@@ -0,0 +1,23 @@
+// RUN: %clang_cc1 -E %s -o - | FileCheck -strict-whitespace %s
+
+// Tokens that are adjacent in the source stay adjacent in the output.
+A: a+++b->c<<=d
+// CHECK: A: a+++b->c<<=d
+
+// Digraphs keep their spelling.
+B: x<:1:>%:
+// CHECK: B: x<:1:>%:
+
+// Tokens with escaped newlines are printed cleaned.
+C: in\
+t x=1;
+// CHECK: C: int x=1;
+
+// Macro-expanded tokens next to file tokens still avoid forming new tokens.
+#define MINUS -
+D: MINUS-1 -MINUS
+// CHECK: D: - -1 - -
+
+// Multiple spaces in the source become one.
+E: a    +  b
+// CHECK: E: a + b
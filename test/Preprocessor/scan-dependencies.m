@@ -0,0 +1,19 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -scan-dependencies -fmodules -fimplicit-module-maps \
+// RUN:   -fmodules-cache-path=%t -I %S/Inputs/scan-dependencies %s -o - \
+// RUN:   | FileCheck %s
+// RUN: not ls %t
+
+// CHECK: include "{{.*}}scan-dependencies.m" "{{.*}}a.h"
+// CHECK-NEXT: include "{{.*}}a.h" "{{.*}}b.h"
+#include "a.h"
+
+// Macros are still expanded in directives.
+// CHECK-NEXT: include "{{.*}}scan-dependencies.m" "{{.*}}c.h"
+#include B_HEADER
+
+// CHECK-NEXT: import "{{.*}}scan-dependencies.m" Foo "{{.*}}module.modulemap"
+@import Foo;
+
+// CHECK-NEXT: import "{{.*}}scan-dependencies.m" Foo.Bar "{{.*}}module.modulemap"
+@import Foo.Bar;
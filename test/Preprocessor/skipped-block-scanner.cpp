@@ -0,0 +1,58 @@
+// RUN: %clang_cc1 -E -std=c++11 %s | FileCheck --strict-whitespace %s
+// RUN: %clang_cc1 -E -std=c++11 %s | FileCheck --check-prefix=NOBAD %s
+// RUN: %clang_cc1 -E -std=c++11 -trigraphs %s | FileCheck --strict-whitespace --check-prefix=TRIGRAPHS %s
+
+#if 0
+int x; /* comment
+#else
+bad1
+*/
+const char *s = "string \
+#else
+bad2";
+// line comment \
+#else
+bad3
+const char *r = R"delim(
+#else
+bad4
+)delim";
+const char *u = u8R"(
+#else
+bad5
+)";
+char c = '"';
+int d = 1'000;
+wchar_t *w = L"\"";
+#endif
+// CHECK: {{^}}good1{{$}}
+good1
+
+#if 0
+  %:else
+good2
+#endif
+// CHECK: {{^}}good2{{$}}
+
+#if 0
+  /* leading comment */ #else
+good3
+#endif
+// CHECK: {{^}}good3{{$}}
+
+#if 0
+FOO \
+#else
+bad6
+#elif 1
+good4
+#endif
+// CHECK: {{^}}good4{{$}}
+
+#if 0
+??=else
+good5
+#endif
+// TRIGRAPHS: {{^}}good5{{$}}
+
+// NOBAD-NOT: bad
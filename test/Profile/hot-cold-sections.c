@@ -0,0 +1,34 @@
+// Test that profiled functions are placed in hot and unlikely sections, and
+// that the symbol ordering file lists them hottest first.
+
+// RUN: llvm-profdata merge %S/Inputs/hot-cold-sections.proftext -o %t.profdata
+// RUN: %clang_cc1 %s -o - -triple x86_64-unknown-linux-gnu -disable-llvm-optzns -emit-llvm -fprofile-instrument-use-path=%t.profdata -fprofile-hot-cold-sections -fprofile-function-order=%t.order | FileCheck %s
+// RUN: FileCheck %s --check-prefix=ORDER < %t.order
+// RUN: %clang_cc1 %s -o - -triple x86_64-unknown-linux-gnu -disable-llvm-optzns -emit-llvm -fprofile-instrument-use-path=%t.profdata | FileCheck %s --check-prefix=NOSECTIONS
+// RUN: %clang_cc1 %s -o - -triple x86_64-apple-darwin -disable-llvm-optzns -emit-llvm -fprofile-instrument-use-path=%t.profdata -fprofile-hot-cold-sections | FileCheck %s --check-prefix=NOSECTIONS
+
+void foo(void);
+void never(void);
+
+// CHECK: define void @foo() #{{[0-9]+}} section ".text.hot.foo"
+void foo() { return; }
+
+// CHECK: define void @never() #{{[0-9]+}} section ".text.unlikely.never"
+void never() { return; }
+
+// CHECK: define i32 @main() #{{[0-9]+}} !prof
+int main() {
+  int i;
+  for (i = 0; i < 10000; i++) foo();
+  return 0;
+}
+
+// A profiled function with an explicit section keeps it.
+// CHECK: define void @placed() #{{[0-9]+}} section "mine"
+__attribute__((section("mine"))) void placed() { return; }
+
+// ORDER: foo
+// ORDER-NEXT: main
+// ORDER-NOT: never
+
+// NOSECTIONS-NOT: section
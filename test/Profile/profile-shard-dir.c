@@ -0,0 +1,21 @@
+// Test loading a translation unit's profile from its own shard.
+
+// The shard for c-general.c is named after the MD5 of "c-general.c".
+// RUN: rm -rf %t && mkdir %t
+// RUN: llvm-profdata merge %S/Inputs/c-general.proftext -o %t/a03882bdef135f7b7c8be40b4bf64d45.profdata
+// RUN: cd %S && %clang_cc1 -triple x86_64-apple-macosx10.9 -main-file-name c-general.c c-general.c -o - -emit-llvm -fprofile-instrument-use-shard-dir=%t | FileCheck -check-prefix=SHARD %s
+
+// A shard takes the place of the whole profile.
+// RUN: cd %S && %clang_cc1 -triple x86_64-apple-macosx10.9 -main-file-name c-general.c c-general.c -o - -emit-llvm -fprofile-instrument-use-path=%t/missing.profdata -fprofile-instrument-use-shard-dir=%t | FileCheck -check-prefix=SHARD %s
+
+// A file without a shard has no profile data.
+// RUN: %clang_cc1 -triple x86_64-apple-macosx10.9 -main-file-name profile-shard-dir.c %s -o - -emit-llvm -fprofile-instrument-use-shard-dir=%t | FileCheck -check-prefix=NOSHARD %s
+
+// SHARD: !{!"branch_weights", i32 101, i32 2}
+
+// NOSHARD-LABEL: define void @f(
+// NOSHARD-NOT: !prof
+void f(int x) {
+  if (x)
+    f(x - 1);
+}
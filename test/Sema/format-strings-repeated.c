@@ -0,0 +1,34 @@
+// RUN: %clang_cc1 -fsyntax-only -verify -Wformat-nonliteral %s
+
+// Format strings are parsed once per translation unit; check that every call
+// sharing a format string is still checked against its own arguments and
+// diagnosed at its own location.
+
+int printf(const char *restrict, ...);
+int scanf(const char *restrict, ...);
+
+#define LOG(...) printf("[%s:%d] " __VA_ARGS__)
+
+void test(const char *s, int i, long l, int *ip, long *lp) {
+  printf("%d %s\n", i, s);
+  printf("%d %s\n", l, s); // expected-warning{{format specifies type 'int' but the argument has type 'long'}}
+  printf("%d %s\n", i, i); // expected-warning{{format specifies type 'char *' but the argument has type 'int'}}
+  printf("%d %s\n", i); // expected-warning{{more '%' conversions than data arguments}}
+  printf("%d %s\n", i, s, i); // expected-warning{{data argument not used by format string}}
+
+  printf("%y %d\n", i); // expected-warning{{invalid conversion specifier 'y'}} expected-warning{{more '%' conversions than data arguments}}
+  printf("%y %d\n", i, i); // expected-warning{{invalid conversion specifier 'y'}}
+
+  printf("%1$d %d\n", i, i); // expected-warning{{cannot mix positional and non-positional arguments in format string}}
+  printf("%1$d %d\n", i); // expected-warning{{cannot mix positional and non-positional arguments in format string}}
+
+  scanf("%d %ld", ip, lp);
+  scanf("%d %ld", lp, lp); // expected-warning{{format specifies type 'int *' but the argument has type 'long *'}}
+
+  // The printf and scanf forms of the same string are parsed separately.
+  printf("%ld", l);
+  scanf("%ld", lp);
+
+  LOG("%d\n", "file", 1, i);
+  LOG("%d\n", "file", 2, l); // expected-warning{{format specifies type 'int' but the argument has type 'long'}}
+}
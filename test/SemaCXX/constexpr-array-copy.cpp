@@ -0,0 +1,57 @@
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -verify %s
+// expected-no-diagnostics
+
+// Copies of an array share their elements until one of them is modified;
+// check that modifying one copy never changes another.
+
+struct Table { int v[4]; };
+
+constexpr Table modified(Table t, int i, int x) {
+  t.v[i] = x;
+  return t;
+}
+constexpr Table base = {{1, 2, 3, 4}};
+constexpr Table changed = modified(base, 2, 30);
+static_assert(base.v[2] == 3, "");
+static_assert(changed.v[2] == 30 && changed.v[3] == 4, "");
+
+constexpr bool copies() {
+  Table a = {{1, 2}};
+  Table b = a;
+  b.v[3] = 7;
+  Table c = b;
+  c.v[0] = 5;
+  a.v[1] += 10;
+  return a.v[1] == 12 && a.v[3] == 0 && b.v[0] == 1 && b.v[1] == 2 &&
+         b.v[3] == 7 && c.v[0] == 5 && c.v[3] == 7;
+}
+static_assert(copies(), "");
+
+struct Grid { int m[2][3]; };
+
+constexpr bool nested() {
+  Grid g = {{{1, 2, 3}, {4, 5, 6}}};
+  Grid h = g;
+  h.m[1][2] = 60;
+  Grid i = h;
+  ++i.m[0][0];
+  return g.m[1][2] == 6 && h.m[1][2] == 60 && i.m[1][2] == 60 &&
+         g.m[0][0] == 1 && h.m[0][0] == 1 && i.m[0][0] == 2;
+}
+static_assert(nested(), "");
+
+struct Big { int v[1024]; };
+
+constexpr Big squares() {
+  Big b = {};
+  for (int i = 0; i != 1024; ++i)
+    b.v[i] = i * i;
+  return b;
+}
+constexpr Big big = squares();
+
+constexpr int sumByValue(Big b, int n) {
+  return n ? b.v[n] + sumByValue(b, n - 1) : 0;
+}
+static_assert(sumByValue(big, 100) == 338350, "");
+static_assert(big.v[1023] == 1023 * 1023, "");
@@ -0,0 +1,90 @@
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -verify %s -fexperimental-constexpr-interpreter
+// RUN: %clang -std=c++14 -fsyntax-only -Xclang -verify %s -fexperimental-constexpr-interpreter
+
+// The bytecode interpreter must give the same results and the same
+// diagnostics as the AST evaluator.
+
+constexpr unsigned long long fib(unsigned n) {
+  return n < 2 ? n : fib(n - 1) + fib(n - 2);
+}
+static_assert(fib(20) == 6765, "");
+
+constexpr int collatz(int n) {
+  int steps = 0;
+  while (n != 1) {
+    if (n % 2 == 0)
+      n /= 2;
+    else
+      n = 3 * n + 1;
+    ++steps;
+  }
+  return steps;
+}
+static_assert(collatz(27) == 111, "");
+
+constexpr unsigned hash(unsigned a, unsigned b) {
+  unsigned h = 2166136261u;
+  for (unsigned i = 0; i < 4; ++i) {
+    if (i == 2)
+      continue;
+    h ^= (a >> (8 * i)) & 0xff;
+    h *= 16777619u;
+  }
+  do {
+    h += b--;
+    if (h & 1)
+      break;
+  } while (b);
+  return h;
+}
+static_assert(hash(0x12345678, 3) == 0x5e32d5c9u, "");
+
+constexpr bool logic(int a, int b) {
+  return (a && !b) || (a > b ? a - b > 2 : b - a > 2);
+}
+static_assert(logic(1, 0), "");
+static_assert(!logic(1, 2), "");
+static_assert(logic(0, 5), "");
+
+enum E { Small = 1, Big = 100 };
+constexpr int scale(E e, char c, bool neg = false) {
+  int v = e * c;
+  v <<= 1;
+  return neg ? -v : v;
+}
+static_assert(scale(Big, 'a') == 19400, "");
+static_assert(scale(Small, 2, true) == -4, "");
+
+constexpr short wrap(short s) {
+  ++s;
+  return s;
+}
+static_assert(wrap(32767) == -32768, "");
+
+constexpr int divide(int a, int b) {
+  return a / b; // expected-note {{division by zero}}
+}
+static_assert(divide(7, 2) == 3, "");
+static_assert(divide(1, 0), ""); // expected-error {{not an integral constant expression}} expected-note {{in call to 'divide(1, 0)'}}
+
+constexpr int overflow(int n) {
+  int x = 1;
+  for (int i = 0; i != n; ++i)
+    x *= 2; // expected-note {{value 2147483648 is outside the range}}
+  return x;
+}
+static_assert(overflow(30) == 1 << 30, "");
+static_assert(overflow(31), ""); // expected-error {{not an integral constant expression}} expected-note {{in call to 'overflow(31)'}}
+
+constexpr int shift(int a, int b) {
+  return a << b; // expected-note {{shift count 40 >= width of type 'int'}}
+}
+static_assert(shift(1, 40), ""); // expected-error {{not an integral constant expression}} expected-note {{in call to 'shift(1, 40)'}}
+
+constexpr int noreturn(int n) {
+  if (n)
+    return n;
+} // expected-warning {{control may reach end}} expected-note {{control reached end of constexpr function}}
+static_assert(noreturn(1) == 1, "");
+static_assert(noreturn(0) == 0, ""); // expected-error {{not an integral constant expression}} expected-note {{in call to 'noreturn(0)'}}
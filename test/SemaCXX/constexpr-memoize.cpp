@@ -0,0 +1,48 @@
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -verify %s -fconstexpr-depth 16
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -verify %s -fconstexpr-depth 16 -fexperimental-constexpr-interpreter
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -print-stats %s -DSTATS 2>&1 | FileCheck %s
+
+// Reusing the result of an earlier call with the same arguments must not
+// change what is, or isn't, a constant expression.
+
+// CHECK: {{[1-9][0-9]*}}/{{[1-9][0-9]*}} memoizable constexpr calls reused
+
+constexpr int fib(int n) { return n < 2 ? n : fib(n - 1) + fib(n - 2); }
+static_assert(fib(12) == 144, "");
+static_assert(fib(12) == 144, "");
+static_assert(fib(13) == 233, "");
+
+constexpr double half(double d) { return d / 2; }
+static_assert(half(3.0) == 1.5, "");
+static_assert(half(3.0) == 1.5, "");
+static_assert(half(-0.0) == 0.0, "");
+
+constexpr unsigned length(const char *s) { return *s ? 1 + length(s + 1) : 0; }
+constexpr unsigned hash(const char *s) {
+  unsigned h = 5381;
+  for (unsigned i = 0; i != length(s); ++i)
+    h = h * 33 + s[i];
+  return h;
+}
+static_assert(hash("abc") == 193485963u, "");
+static_assert(hash("abc") == 193485963u, "");
+
+constexpr int table[] = {3, 1, 4, 1, 5};
+constexpr int sum(const int *p, int n) { return n ? *p + sum(p + 1, n - 1) : 0; }
+static_assert(sum(table, 5) == 14, "");
+static_assert(sum(table + 1, 4) == 11, "");
+
+#ifndef STATS
+// A call that was fine once can still be too deep from a deeper frame.
+constexpr int depth(int n) { return n ? depth(n - 1) + 1 : 0; } // expected-note {{exceeded maximum depth}} expected-note +{{in call to 'depth(}} expected-note {{skipping}}
+static_assert(depth(10) == 10, "");
+constexpr int nest(int k) { return k ? nest(k - 1) : depth(10); } // expected-note +{{in call to 'nest(}}
+static_assert(nest(4) == 10, "");
+static_assert(nest(8) == 10, ""); // expected-error {{constant expression}} expected-note {{in call to 'nest(8)'}}
+
+// A call that failed is evaluated, and diagnosed, every time.
+constexpr int reciprocal(int n) { return 1 / n; } // expected-note 2{{division by zero}}
+static_assert(reciprocal(0), ""); // expected-error {{constant expression}} expected-note {{in call to}}
+static_assert(reciprocal(0), ""); // expected-error {{constant expression}} expected-note {{in call to}}
+
+#endif
@@ -0,0 +1,46 @@
+// RUN: %clang_cc1 -fsyntax-only -verify -std=c++11 %s
+
+// Derived-to-base conversions between complete classes are memoized per pair
+// of classes. Check that each conversion is still checked for access in its
+// own context, diagnosed at its own location, and follows the right path.
+
+namespace access {
+  class A { };
+  class B : private A { // expected-note 2{{declared private here}}
+    void f(B *b) { A *a = b; }
+    friend void g(B *b);
+  };
+
+  void g(B *b) { A *a = b; }
+  void h(B *b) { A *a = b; } // expected-error {{cannot cast 'access::B' to its private base class 'access::A'}}
+  void i(B *b) { A *a = b; } // expected-error {{cannot cast 'access::B' to its private base class 'access::A'}}
+}
+
+namespace ambiguous {
+  struct A { };
+  struct B : A { };
+  struct C : A { };
+  struct D : B, C { };
+
+  void f(D *d) {
+    A *a1 = d; // expected-error {{ambiguous conversion from derived class 'ambiguous::D' to base class 'ambiguous::A':}}
+    A *a2 = d; // expected-error {{ambiguous conversion from derived class 'ambiguous::D' to base class 'ambiguous::A':}}
+    B *b1 = d;
+    B *b2 = d;
+  }
+}
+
+namespace path {
+  struct A { int a = 1; };
+  struct B { int b = 2; };
+  struct C : A, B { int c = 3; };
+  struct D : C { };
+
+  constexpr D d = D();
+  constexpr const B *b1 = &d;
+  constexpr const B *b2 = &d;
+  static_assert(b1->b == 2 && b2->b == 2, "");
+  static_assert(b1 == b2, "");
+  constexpr const A *a = &d;
+  static_assert(a->a == 1, "");
+}
@@ -0,0 +1,65 @@
+// RUN: %clang_cc1 -fsyntax-only -std=c++11 -verify %s
+
+// Built-in candidates with arithmetic parameters are skipped when one operand
+// is a class that can't be converted to an arithmetic or enumeration type.
+// Make sure that skipping them never changes which candidate is chosen.
+
+struct Stream {
+  explicit operator bool() const;
+  Stream &operator<<(const char *); // expected-note {{candidate function not viable}}
+};
+Stream &operator<<(Stream &, int); // expected-note {{candidate function not viable}}
+
+void test_stream(Stream &s, double d) {
+  s << "hello" << 1;
+  Stream &r = s << 1 << 2;
+  s << d; // ok, double -> int
+  s << s; // expected-error {{invalid operands to binary expression}}
+  s += 1; // expected-error {{no viable overloaded '+='}}
+}
+
+struct ToPointer {
+  operator void *() const;
+};
+
+void test_pointer(ToPointer p) {
+  (void)(p << 1); // expected-error {{invalid operands to binary expression}}
+  (void)(p == 0);
+}
+
+struct ToAny {
+  template<typename T> operator T() const;
+};
+
+void test_template(ToAny a) {
+  // expected-error@+1 {{use of overloaded operator '<<' is ambiguous}}
+  int x = a << 1; // expected-note 1+ {{built-in candidate}}
+}
+
+struct ToInt {
+  operator int() const;
+};
+
+void test_int(ToInt i, Stream &s) {
+  int x = i << 1;
+  unsigned u = 1u | i;
+  x += i;
+  s << i;
+}
+
+enum E { e };
+struct ToEnum {
+  operator E() const;
+};
+
+void test_enum(ToEnum t) {
+  int x = t >> 1;
+  bool b = t < e;
+}
+
+struct Incomplete;
+Incomplete &getIncomplete();
+
+void test_incomplete() {
+  (void)(getIncomplete() << 1); // expected-error {{invalid operands to binary expression}}
+}
@@ -0,0 +1,50 @@
+// RUN: %clang_cc1 -fsyntax-only -verify -std=c++11 -Wthread-safety %s
+// RUN: %clang_cc1 -fsyntax-only -std=c++11 -Wthread-safety -print-stats %s 2>&1 | FileCheck %s
+
+// Functions which use no capabilities are skipped by the analysis, the others
+// are still checked.
+
+// CHECK: 4 functions analyzed for thread safety
+// CHECK-NEXT: 2 functions skipped without capabilities.
+
+class __attribute__((capability("mutex"))) Mutex {
+public:
+  void Lock() __attribute__((acquire_capability()));
+  void Unlock() __attribute__((release_capability()));
+};
+
+class __attribute__((scoped_lockable)) MutexLock {
+public:
+  MutexLock(Mutex *mu) __attribute__((acquire_capability(mu)));
+  ~MutexLock() __attribute__((release_capability()));
+};
+
+Mutex mu;
+int guarded __attribute__((guarded_by(mu)));
+int plain;
+
+int noCapabilities(int x) {
+  int y = x + plain;
+  return y * 2;
+}
+
+void noCapabilitiesEither() {
+  for (int i = 0; i < 10; ++i)
+    plain += i;
+}
+
+void usesGuarded() {
+  guarded = 1; // expected-warning {{writing variable 'guarded' requires holding mutex 'mu' exclusively}}
+}
+
+void locks() {
+  mu.Lock(); // expected-note {{mutex acquired here}}
+} // expected-warning {{mutex 'mu' is still held at the end of function}}
+
+void scoped() {
+  MutexLock lock(&mu);
+  guarded = 2;
+}
+
+void required() __attribute__((requires_capability(mu)));
+void required() {}
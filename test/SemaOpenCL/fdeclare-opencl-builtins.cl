@@ -0,0 +1,18 @@
+// RUN: %clang_cc1 %s -triple spir -verify -pedantic -fsyntax-only -cl-std=CL1.2 -fdeclare-opencl-builtins
+
+// Check that the OpenCL builtins are declared on first use without including
+// opencl-c.h.
+
+typedef float float4 __attribute__((ext_vector_type(4)));
+
+kernel void test(global float4 *out, global int *iout, float4 f, int a,
+                 int b) {
+  unsigned int id = get_global_id(0);
+  out[id] = sin(f);
+  out[id] = fma(f, f, cos(f));
+  iout[id] = max(a, b);
+  iout[id] = clamp(a, 0, b);
+  unsigned dim = get_work_dim();
+
+  undeclared_builtin(a); // expected-warning{{implicit declaration of function 'undeclared_builtin' is invalid in C99}}
+}
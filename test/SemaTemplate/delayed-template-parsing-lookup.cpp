@@ -0,0 +1,37 @@
+// RUN: %clang_cc1 -fsyntax-only -fdelayed-template-parsing -verify %s
+// RUN: %clang_cc1 -fsyntax-only -fdelayed-template-parsing -fms-extensions -DMS -verify %s
+
+// Outside of Microsoft mode, the body of a late-parsed template only sees the
+// declarations that precede it, just as if it had not been delayed.
+
+int f(int);
+
+template <typename T> void g() {
+  int x = f('a');
+#ifdef MS
+  // expected-error@-2 {{cannot initialize a variable of type 'int' with an rvalue of type 'char *'}}
+#endif
+  h();
+#ifndef MS
+  // expected-error@-2 {{use of undeclared identifier 'h'}}
+#endif
+}
+
+// Dependent calls still find later declarations by argument-dependent lookup.
+template <typename T> void k(T t) {
+  adl(t);
+}
+
+// Templates that are never instantiated are never parsed.
+template <typename T> void unused() {
+  this is not parsed;
+}
+
+char *f(char);
+void h();
+
+struct S {};
+void adl(S);
+
+template void g<int>();
+template void k<S>(S);
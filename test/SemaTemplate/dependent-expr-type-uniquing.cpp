@@ -0,0 +1,31 @@
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -verify %s
+// expected-no-diagnostics
+
+// Declare enough distinct dependent types to make their folding sets grow,
+// and check that redeclarations still find the same canonical types.
+#define DECLARE(I)                                                             \
+  template <int N> void arr##I(int (&)[N + I]);                                \
+  template <int N> void arr##I(int (&)[N + I]) {}                              \
+  template <int N> void arr##I(int (&)[N + I + 100]) {}                        \
+  template <typename T> auto dt##I(T t) -> decltype(t + I);                    \
+  template <typename T> auto dt##I(T t) -> decltype(t + I) { return t + I; }  \
+  template <typename T> auto tof##I(T t) -> __typeof__(t * I);                 \
+  template <typename T> auto tof##I(T t) -> __typeof__(t * I) { return t; }
+
+#define DECLARE10(I)                                                           \
+  DECLARE(I##0) DECLARE(I##1) DECLARE(I##2) DECLARE(I##3) DECLARE(I##4)        \
+  DECLARE(I##5) DECLARE(I##6) DECLARE(I##7) DECLARE(I##8) DECLARE(I##9)
+
+DECLARE10(1) DECLARE10(2) DECLARE10(3) DECLARE10(4) DECLARE10(5)
+DECLARE10(6) DECLARE10(7) DECLARE10(8) DECLARE10(9)
+
+void test() {
+  int a[12];
+  arr10<2>(a);
+  arr99<-87>(a);
+  arr99<-187>(a);
+  long l = dt55(1L);
+  int i = tof37(1);
+  (void)l;
+  (void)i;
+}
@@ -0,0 +1,21 @@
+// RUN: %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+// CHECK: *** Semantic Analysis Stats:
+// CHECK: 1 class definitions instantiated.
+// CHECK: 2 function definitions instantiated.
+// CHECK: 1 function definitions left to explicit instantiations.
+// CHECK: {{[1-9][0-9]*}} expressions transformed, {{[1-9][0-9]*}} rebuilt, 0 skipped as unchanged.
+// CHECK-NEXT: {{[0-9.]+}} expressions transformed per instantiated definition.
+
+template<typename T> struct Box {
+  T get() { return T(); }
+};
+
+template<typename T> T twice(T t) { return t + t; }
+
+extern template int twice<int>(int);
+
+double use() {
+  Box<int> b;
+  return b.get() + twice(1) + twice(2.0);
+}
@@ -0,0 +1,20 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: cp "%s" "%t/test.cpp"
+// RUN: echo 'int header_var;' > "%t/header.h"
+// RUN: clang-check -ast-list -fingerprint-db="%t/db" "%t/test.cpp" -- 2>&1 | FileCheck -check-prefix CHECK-RUN %s
+// RUN: clang-check -ast-list -fingerprint-db="%t/db" "%t/test.cpp" -- 2>&1 | FileCheck -allow-empty -check-prefix CHECK-SKIP %s
+// A different mode does not reuse the fingerprints of -ast-list.
+// RUN: clang-check -ast-dump -ast-dump-filter main_var -fingerprint-db="%t/db" "%t/test.cpp" -- 2>&1 | FileCheck -check-prefix CHECK-DUMP %s
+// RUN: echo 'int other_var;' > "%t/header.h"
+// RUN: clang-check -ast-list -fingerprint-db="%t/db" "%t/test.cpp" -- 2>&1 | FileCheck -check-prefix CHECK-RERUN %s
+
+// CHECK-RUN: header_var
+// CHECK-RUN: main_var
+// CHECK-SKIP-NOT: main_var
+// CHECK-DUMP: VarDecl{{.*}}main_var
+// CHECK-RERUN: other_var
+// CHECK-RERUN: main_var
+
+#include "header.h"
+int main_var;
@@ -82,6 +82,10 @@ static unsigned getDefaultParsingOptions() {
     options |= CXTranslationUnit_CreatePreambleOnFirstParse;
   if (getenv("CINDEXTEST_KEEP_GOING"))
     options |= CXTranslationUnit_KeepGoing;
+  if (getenv("CINDEXTEST_PREAMBLES_IN_MEMORY"))
+    options |= CXTranslationUnit_StorePreamblesInMemory;
+  if (getenv("CINDEXTEST_SKIP_FUNCTION_BODIES_OUTSIDE_MAIN_FILE"))
+    options |= CXTranslationUnit_SkipFunctionBodiesOutsideMainFile;
 
   return options;
 }
@@ -2162,6 +2166,9 @@ int perform_code_completion(int argc, const char **argv, int timing_only) {
   CXTranslationUnit TU;
   unsigned I, Repeats = 1;
   unsigned completionOptions = clang_defaultCodeCompleteOptions();
+  const char *completionPrefix = getenv("CINDEXTEST_COMPLETION_PREFIX");
+  const char *maxResultsEnv = getenv("CINDEXTEST_COMPLETION_MAX_RESULTS");
+  unsigned maxResults = maxResultsEnv ? (unsigned)atoi(maxResultsEnv) : 0;
   
   if (getenv("CINDEXTEST_CODE_COMPLETE_PATTERNS"))
     completionOptions |= CXCodeComplete_IncludeCodePatterns;
@@ -2206,9 +2213,15 @@ int perform_code_completion(int argc, const char **argv, int timing_only) {
   }
 
   for (I = 0; I != Repeats; ++I) {
-    results = clang_codeCompleteAt(TU, filename, line, column,
-                                   unsaved_files, num_unsaved_files,
-                                   completionOptions);
+    if (completionPrefix || maxResults)
+      results = clang_codeCompleteAtWithFilter(TU, filename, line, column,
+                                               unsaved_files, num_unsaved_files,
+                                               completionOptions,
+                                               completionPrefix, maxResults);
+    else
+      results = clang_codeCompleteAt(TU, filename, line, column,
+                                     unsaved_files, num_unsaved_files,
+                                     completionOptions);
     if (!results) {
       fprintf(stderr, "Unable to perform code completion!\n");
       return 1;
@@ -11,14 +11,24 @@
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/CompilerInvocation.h"
 #include "clang/Frontend/FrontendAction.h"
+#include "clang/Frontend/SerializedDiagnosticPrinter.h"
 #include "clang/Index/IndexingAction.h"
 #include "clang/Index/IndexDataConsumer.h"
 #include "clang/Index/USRGeneration.h"
 #include "clang/Index/CodegenNameGenerator.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/PrettyStackTrace.h"
+#include <atomic>
+
+#ifdef LLVM_ON_UNIX
+#include <sys/resource.h>
+#endif
 
 using namespace clang;
 using namespace clang::index;
@@ -31,6 +41,8 @@ namespace {
 enum class ActionType {
   None,
   PrintSourceSymbols,
+  MergeDiagnostics,
+  BenchmarkIndexing,
 };
 
 namespace options {
@@ -42,9 +54,32 @@ Action(cl::desc("Action:"), cl::init(ActionType::None),
        cl::values(
           clEnumValN(ActionType::PrintSourceSymbols,
                      "print-source-symbols", "Print symbols from source"),
+          clEnumValN(ActionType::MergeDiagnostics, "merge-diagnostics",
+                     "Merge serialized diagnostics files"),
+          clEnumValN(ActionType::BenchmarkIndexing, "benchmark-indexing",
+                     "Measure how fast source files are indexed"),
           clEnumValEnd),
        cl::cat(IndexTestCoreCategory));
 
+static cl::list<std::string>
+InputFiles(cl::Positional,
+           cl::desc("<serialized diagnostics files or source files>"),
+           cl::cat(IndexTestCoreCategory));
+
+static cl::opt<std::string>
+OutputFile("o", cl::desc("Output file of -merge-diagnostics"),
+           cl::cat(IndexTestCoreCategory));
+
+static cl::opt<unsigned>
+Repeat("repeat", cl::desc("Number of times -benchmark-indexing indexes each "
+                          "file"),
+       cl::init(1), cl::cat(IndexTestCoreCategory));
+
+static cl::opt<unsigned>
+NumThreads("j", cl::desc("Number of files -benchmark-indexing indexes in "
+                         "parallel"),
+           cl::init(1), cl::cat(IndexTestCoreCategory));
+
 static cl::extrahelp MoreHelp(
   "\nAdd \"-- <compiler arguments>\" at the end to setup the compiler "
   "invocation\n"
@@ -162,6 +197,159 @@ static bool printSourceSymbols(ArrayRef<const char *> Args) {
   return false;
 }
 
+//===----------------------------------------------------------------------===//
+// Benchmark Indexing
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+/// Counts the occurrences the indexer reports without looking at them, so
+/// that the benchmark measures the indexer rather than the consumer.
+class CountingIndexDataConsumer : public IndexDataConsumer {
+public:
+  uint64_t NumOccurrences = 0;
+
+  bool handleDeclOccurence(const Decl *D, SymbolRoleSet Roles,
+                           ArrayRef<SymbolRelation> Relations,
+                           FileID FID, unsigned Offset,
+                           ASTNodeInfo ASTNode) override {
+    ++NumOccurrences;
+    return true;
+  }
+
+  bool handleMacroOccurence(const IdentifierInfo *Name,
+                            const MacroInfo *MI, SymbolRoleSet Roles,
+                            FileID FID, unsigned Offset) override {
+    ++NumOccurrences;
+    return true;
+  }
+
+  bool handleModuleOccurence(const ImportDecl *ImportD, SymbolRoleSet Roles,
+                             FileID FID, unsigned Offset) override {
+    ++NumOccurrences;
+    return true;
+  }
+};
+
+/// The result of indexing one file once.
+struct IndexingRun {
+  bool Failed = false;
+  double ParseTime = 0;
+  double IndexTime = 0;
+  uint64_t NumOccurrences = 0;
+};
+
+} // anonymous namespace
+
+/// \brief Parse the file named by \p Args, then index the parsed AST,
+/// timing the two steps separately.
+static IndexingRun indexForBenchmark(ArrayRef<const char *> Args) {
+  IndexingRun Run;
+  SmallVector<const char *, 4> ArgsWithProgName;
+  ArgsWithProgName.push_back("clang");
+  ArgsWithProgName.append(Args.begin(), Args.end());
+  IntrusiveRefCntPtr<DiagnosticsEngine>
+    Diags(CompilerInstance::createDiagnostics(new DiagnosticOptions));
+  IntrusiveRefCntPtr<CompilerInvocation>
+    CInvok(createInvocationFromCommandLine(ArgsWithProgName, Diags));
+  if (!CInvok) {
+    Run.Failed = true;
+    return Run;
+  }
+
+  auto PCHContainerOps = std::make_shared<PCHContainerOperations>();
+  TimeRecord Start = TimeRecord::getCurrentTime(/*Start=*/true);
+  std::unique_ptr<ASTUnit> Unit(ASTUnit::LoadFromCompilerInvocationAction(
+      CInvok.get(), PCHContainerOps, Diags));
+  TimeRecord Parsed = TimeRecord::getCurrentTime(/*Start=*/false);
+  if (!Unit) {
+    Run.Failed = true;
+    return Run;
+  }
+
+  auto DataConsumer = std::make_shared<CountingIndexDataConsumer>();
+  indexASTUnit(*Unit, DataConsumer, IndexingOptions());
+  TimeRecord Indexed = TimeRecord::getCurrentTime(/*Start=*/false);
+
+  Run.ParseTime = Parsed.getWallTime() - Start.getWallTime();
+  Run.IndexTime = Indexed.getWallTime() - Parsed.getWallTime();
+  Run.NumOccurrences = DataConsumer->NumOccurrences;
+  return Run;
+}
+
+/// \brief Get the peak resident set size of the process in kilobytes, or 0 if
+/// it is not known.
+static uint64_t getPeakRSSInKB() {
+#ifdef LLVM_ON_UNIX
+  struct rusage Usage;
+  if (getrusage(RUSAGE_SELF, &Usage) != 0)
+    return 0;
+#ifdef __APPLE__
+  return Usage.ru_maxrss / 1024;
+#else
+  return Usage.ru_maxrss;
+#endif
+#else
+  return 0;
+#endif
+}
+
+static bool benchmarkIndexing(ArrayRef<std::string> Files,
+                              ArrayRef<const char *> CompArgs,
+                              unsigned Repeat, unsigned NumThreads) {
+  // Each job indexes one file once. Without input files, the compiler
+  // arguments name the file to index.
+  std::vector<std::vector<const char *>> Jobs;
+  for (unsigned I = 0; I != Repeat; ++I) {
+    if (Files.empty()) {
+      Jobs.push_back(CompArgs.vec());
+      continue;
+    }
+    for (const std::string &File : Files) {
+      Jobs.push_back(CompArgs.vec());
+      Jobs.back().push_back(File.c_str());
+    }
+  }
+
+  std::vector<IndexingRun> Runs(Jobs.size());
+  TimeRecord Start = TimeRecord::getCurrentTime(/*Start=*/true);
+  {
+    std::atomic<unsigned> NextJob(0);
+    ThreadPool Pool(NumThreads);
+    for (unsigned I = 0; I != NumThreads; ++I)
+      Pool.async([&] {
+        for (unsigned Idx = NextJob++; Idx < Jobs.size(); Idx = NextJob++)
+          Runs[Idx] = indexForBenchmark(Jobs[Idx]);
+      });
+    Pool.wait();
+  }
+  TimeRecord End = TimeRecord::getCurrentTime(/*Start=*/false);
+
+  bool Failed = false;
+  IndexingRun Total;
+  for (const IndexingRun &Run : Runs) {
+    Failed |= Run.Failed;
+    Total.ParseTime += Run.ParseTime;
+    Total.IndexTime += Run.IndexTime;
+    Total.NumOccurrences += Run.NumOccurrences;
+  }
+
+  raw_ostream &OS = outs();
+  OS << "files: " << (Files.empty() ? 1 : Files.size())
+     << ", repetitions: " << Repeat << ", threads: " << NumThreads << '\n';
+  OS << "parse time: " << format("%.4f", Total.ParseTime) << "s\n";
+  OS << "index time: " << format("%.4f", Total.IndexTime) << "s\n";
+  OS << "occurrences: " << Total.NumOccurrences;
+  if (Total.IndexTime > 0)
+    OS << " (" << format("%.0f", Total.NumOccurrences / Total.IndexTime)
+       << "/s)";
+  OS << '\n';
+  OS << "wall time: "
+     << format("%.4f", End.getWallTime() - Start.getWallTime()) << "s\n";
+  OS << "peak RSS: " << getPeakRSSInKB() << " KB\n";
+  return Failed;
+}
+
 //===----------------------------------------------------------------------===//
 // Helper Utils
 //===----------------------------------------------------------------------===//
@@ -226,5 +414,31 @@ int indextest_core_main(int argc, const char **argv) {
     return printSourceSymbols(CompArgs);
   }
 
+  if (options::Action == ActionType::BenchmarkIndexing) {
+    if (options::InputFiles.empty() && CompArgs.empty()) {
+      errs() << "error: missing input files; pass '<files> -- <compiler "
+                "arguments>'\n";
+      return 1;
+    }
+    if (options::Repeat == 0 || options::NumThreads == 0) {
+      errs() << "error: '-repeat' and '-j' must be positive\n";
+      return 1;
+    }
+    return benchmarkIndexing(options::InputFiles, CompArgs, options::Repeat,
+                             options::NumThreads);
+  }
+
+  if (options::Action == ActionType::MergeDiagnostics) {
+    if (options::OutputFile.empty()) {
+      errs() << "error: missing output file; pass '-o <file>'\n";
+      return 1;
+    }
+    if (std::error_code EC = serialized_diags::merge(options::InputFiles,
+                                                     options::OutputFile)) {
+      errs() << "error: failed to merge diagnostics: " << EC.message() << '\n';
+      return 1;
+    }
+  }
+
   return 0;
 }
@@ -25,6 +25,7 @@
 #include "clang/Rewrite/Frontend/FrontendActions.h"
 #include "clang/StaticAnalyzer/Frontend/FrontendActions.h"
 #include "clang/Tooling/CommonOptionsParser.h"
+#include "clang/Tooling/FingerprintDatabase.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Option/OptTable.h"
@@ -79,6 +80,19 @@ static cl::opt<bool> FixWhatYouCan(
     "fix-what-you-can",
     cl::desc(Options->getOptionHelpText(options::OPT_fix_what_you_can)),
     cl::cat(ClangCheckCategory));
+static cl::opt<std::string> FingerprintDB(
+    "fingerprint-db",
+    cl::desc("Skip the files that were checked successfully with the same\n"
+             "options before and whose inputs did not change since, as\n"
+             "recorded in the given file, and update it afterwards."),
+    cl::value_desc("filename"), cl::cat(ClangCheckCategory));
+
+static cl::opt<bool> SharedPCH(
+    "shared-pch",
+    cl::desc("Precompile the header that files with otherwise identical\n"
+             "compile commands pull in first with -include, and use it\n"
+             "instead of parsing the header for every file."),
+    cl::cat(ClangCheckCategory));
 
 namespace {
 
@@ -171,6 +185,8 @@ int main(int argc, const char **argv) {
   Tool.appendArgumentsAdjuster(getInsertArgumentAdjuster(
       Analyze ? "--analyze" : "-fsyntax-only", ArgumentInsertPosition::BEGIN));
 
+  Tool.setUseSharedPCH(SharedPCH);
+
   ClangCheckActionFactory CheckFactory;
   std::unique_ptr<FrontendActionFactory> FrontendFactory;
 
@@ -182,5 +198,38 @@ int main(int argc, const char **argv) {
   else
     FrontendFactory = newFrontendActionFactory(&CheckFactory);
 
-  return Tool.run(FrontendFactory.get());
+  if (FingerprintDB.empty())
+    return Tool.run(FrontendFactory.get());
+
+  // The mode determines what a check produces, so runs in different modes
+  // must not skip each other's files.
+  std::string ToolName = "clang-check";
+  if (ASTDump)
+    ToolName += " -ast-dump";
+  if (ASTList)
+    ToolName += " -ast-list";
+  if (ASTPrint)
+    ToolName += " -ast-print";
+  if (!ASTDumpFilter.empty())
+    ToolName += " -ast-dump-filter=" + ASTDumpFilter;
+  if (Analyze)
+    ToolName += " -analyze";
+  if (Fixit)
+    ToolName += " -fixit";
+  if (FixWhatYouCan)
+    ToolName += " -fix-what-you-can";
+
+  FingerprintDatabase Fingerprints(ToolName);
+  std::string ErrorMessage;
+  if (!Fingerprints.load(FingerprintDB, ErrorMessage)) {
+    llvm::errs() << ErrorMessage << "\n";
+    return 1;
+  }
+  Tool.setFingerprintDatabase(&Fingerprints);
+  int Result = Tool.run(FrontendFactory.get());
+  if (!Fingerprints.save(FingerprintDB, ErrorMessage)) {
+    llvm::errs() << ErrorMessage << "\n";
+    return 1;
+  }
+  return Result;
 }
@@ -24,7 +24,14 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <thread>
 
 using namespace llvm;
 using clang::tooling::Replacements;
@@ -104,6 +111,42 @@ static cl::opt<bool> SortIncludes(
              "SortIncludes style flag"),
     cl::cat(ClangFormatCategory));
 
+static cl::opt<unsigned>
+    NumThreads("j",
+               cl::desc("The number of threads to format <file>s on; 0 uses\n"
+                        "one thread per hardware core. Output is written\n"
+                        "in the order the <file>s are given."),
+               cl::init(1), cl::cat(ClangFormatCategory));
+
+static cl::opt<bool>
+    DryRun("dry-run",
+           cl::desc("Do not write any output. Instead, list the <file>s\n"
+                    "that are not formatted and exit with 1 if there\n"
+                    "are any."),
+           cl::cat(ClangFormatCategory));
+
+static cl::opt<bool>
+    Stream("stream",
+           cl::desc("Format each <file> in chunks, writing the output of a\n"
+                    "chunk before reading the next one, to bound the memory\n"
+                    "used for huge files. Implies -j=1. Cannot be used with\n"
+                    "-offset, -length, -lines, -cursor, -dry-run or\n"
+                    "-output-replacements-xml."),
+           cl::cat(ClangFormatCategory));
+
+static cl::opt<bool>
+    Server("server",
+           cl::desc("Answer formatting requests read from stdin until it is\n"
+                    "closed, keeping styles cached between requests.\n"
+                    "See the clang-format documentation for the protocol."),
+           cl::cat(ClangFormatCategory));
+
+static cl::opt<bool> PrintStats(
+    "print-stats",
+    cl::desc("Write statistics about the formatting of each <file> to\n"
+             "stderr, as one JSON object per line."),
+    cl::cat(ClangFormatCategory));
+
 static cl::list<std::string> FileNames(cl::Positional, cl::desc("[<file> ...]"),
                                        cl::cat(ClangFormatCategory));
 
@@ -165,8 +208,11 @@ static bool fillRanges(MemoryBuffer *Code,
     return false;
   }
 
-  if (Offsets.empty())
-    Offsets.push_back(0);
+  if (Offsets.empty()) {
+    // Format the whole file; Offsets is shared by all files.
+    Ranges.push_back(tooling::Range(0, Code->getBufferSize()));
+    return false;
+  }
   if (Offsets.size() != Lengths.size() &&
       !(Offsets.size() == 1 && Lengths.empty())) {
     errs() << "error: number of -offset and -length arguments must match.\n";
@@ -198,60 +244,248 @@ static bool fillRanges(MemoryBuffer *Code,
   return false;
 }
 
-static void outputReplacementXML(StringRef Text) {
+static void outputReplacementXML(raw_ostream &OS, StringRef Text) {
   // FIXME: When we sort includes, we need to make sure the stream is correct
   // utf-8.
   size_t From = 0;
   size_t Index;
   while ((Index = Text.find_first_of("\n\r<&", From)) != StringRef::npos) {
-    outs() << Text.substr(From, Index - From);
+    OS << Text.substr(From, Index - From);
     switch (Text[Index]) {
     case '\n':
-      outs() << "&#10;";
+      OS << "&#10;";
       break;
     case '\r':
-      outs() << "&#13;";
+      OS << "&#13;";
       break;
     case '<':
-      outs() << "&lt;";
+      OS << "&lt;";
       break;
     case '&':
-      outs() << "&amp;";
+      OS << "&amp;";
       break;
     default:
       llvm_unreachable("Unexpected character encountered!");
     }
     From = Index + 1;
   }
-  outs() << Text.substr(From);
+  OS << Text.substr(From);
 }
 
-static void outputReplacementsXML(const Replacements &Replaces) {
+static void outputReplacementsXML(raw_ostream &OS,
+                                  const Replacements &Replaces) {
   for (const auto &R : Replaces) {
-    outs() << "<replacement "
+    OS << "<replacement "
            << "offset='" << R.getOffset() << "' "
            << "length='" << R.getLength() << "'>";
-    outputReplacementXML(R.getReplacementText());
-    outs() << "</replacement>\n";
+    outputReplacementXML(OS, R.getReplacementText());
+    OS << "</replacement>\n";
   }
 }
 
+namespace {
+// Caches the styles resolved by getStyle() per directory and file extension,
+// which is all getStyle() looks at, so that each .clang-format file is looked
+// for and parsed only once when formatting many files.
+class StyleCache {
+public:
+  FormatStyle get(StringRef FileName) {
+    SmallString<128> Path(FileName);
+    llvm::sys::fs::make_absolute(Path);
+    std::string Key = (llvm::sys::path::parent_path(Path) + "\n" +
+                       llvm::sys::path::extension(Path))
+                          .str();
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto I = Styles.find(Key);
+    if (I == Styles.end())
+      I = Styles.insert(std::make_pair(
+                            Key, getStyle(Style, FileName, FallbackStyle)))
+              .first;
+    return I->second;
+  }
+
+private:
+  std::mutex Mutex;
+  llvm::StringMap<FormatStyle> Styles;
+};
+} // end anonymous namespace
+
+// Formats \p Code of \p FileName in chunks, writing the result to \p OS or,
+// with -i, to a temporary file that then replaces \p FileName.
 // Returns true on error.
-static bool format(StringRef FileName) {
+static bool formatInChunks(StringRef FileName, StringRef Code,
+                           const FormatStyle &FileStyle, raw_ostream &OS,
+                           raw_ostream &ErrOS) {
+  StringRef AssumedFileName = (FileName == "-") ? AssumeFileName : FileName;
+  if (!Inplace) {
+    reformatInChunks(FileStyle, Code, OS, AssumedFileName);
+    return false;
+  }
+  if (FileName == "-") {
+    ErrOS << "error: cannot use -i when reading from stdin.\n";
+    return false;
+  }
+  int FD;
+  SmallString<128> TempPath;
+  if (std::error_code EC = sys::fs::createUniqueFile(
+          Twine(FileName) + "-%%%%%%.tmp", FD, TempPath)) {
+    ErrOS << EC.message() << "\n";
+    return true;
+  }
+  {
+    raw_fd_ostream TempOS(FD, /*shouldClose=*/true);
+    reformatInChunks(FileStyle, Code, TempOS, AssumedFileName);
+    if (TempOS.has_error()) {
+      TempOS.clear_error();
+      ErrOS << "error: could not write " << TempPath << "\n";
+      sys::fs::remove(TempPath);
+      return true;
+    }
+  }
+  if (std::error_code EC = sys::fs::rename(TempPath, FileName)) {
+    ErrOS << EC.message() << "\n";
+    sys::fs::remove(TempPath);
+    return true;
+  }
+  return false;
+}
+
+// Reads a line from stdin without its line break into \p Line.
+// Returns false at the end of the input.
+static bool readLine(std::string &Line) {
+  Line.clear();
+  int C;
+  while ((C = getchar()) != EOF && C != '\n')
+    Line += C;
+  if (!Line.empty() && Line.back() == '\r')
+    Line.pop_back();
+  return C != EOF || !Line.empty();
+}
+
+// Writes the response to a -server request.
+static void respond(bool Error, bool IncompleteFormat, StringRef Content) {
+  outs() << "Status: " << (Error ? "error" : "ok") << "\n"
+         << "Incomplete-Format: " << (IncompleteFormat ? "true" : "false")
+         << "\n"
+         << "Length: " << Content.size() << "\n\n"
+         << Content;
+  outs().flush();
+}
+
+// Formats the \p Ranges of \p Code for a -server request.
+static llvm::Expected<std::string>
+formatRequest(StringRef FileName, StringRef Code,
+              std::vector<tooling::Range> Ranges, StyleCache &Styles,
+              bool &IncompleteFormat) {
+  FormatStyle FormatStyle = Styles.get(FileName);
+  if (SortIncludes.getNumOccurrences() != 0)
+    FormatStyle.SortIncludes = SortIncludes;
+  Replacements Replaces = sortIncludes(FormatStyle, Code, Ranges, FileName);
+  auto ChangedCode = tooling::applyAllReplacements(Code, Replaces);
+  if (!ChangedCode)
+    return ChangedCode.takeError();
+  for (const auto &R : Replaces)
+    Ranges.push_back({R.getOffset(), R.getLength()});
+  Replacements FormatChanges = reformat(FormatStyle, *ChangedCode, Ranges,
+                                        FileName, &IncompleteFormat);
+  return tooling::applyAllReplacements(*ChangedCode, FormatChanges);
+}
+
+// Answers the requests read from stdin until it is closed. A request is a
+// header of "Name: Value" lines ended by an empty line, followed by the code:
+//   File: <file name, used to find the style and language>
+//   Range: <offset>:<length>  (optional, may be repeated)
+//   Length: <size of the code in bytes>
+// The response has the same form, with "Status: ok" or "Status: error",
+// "Incomplete-Format: true" or "false" and the formatted code or the error
+// message as content.
+// Returns true if the input could not be read.
+static bool serve(StyleCache &Styles) {
+  llvm::sys::ChangeStdinToBinary();
+  llvm::sys::ChangeStdoutToBinary();
+  std::string Line;
+  while (readLine(Line)) {
+    std::string FileName = AssumeFileName;
+    std::vector<tooling::Range> Ranges;
+    bool HasLength = false;
+    unsigned Length = 0;
+    std::string Error;
+    for (; !Line.empty(); readLine(Line)) {
+      std::pair<StringRef, StringRef> Header = StringRef(Line).split(':');
+      StringRef Name = Header.first.trim();
+      StringRef Value = Header.second.trim();
+      if (Name == "File") {
+        FileName = Value.str();
+      } else if (Name == "Range") {
+        unsigned Offset, RangeLength;
+        if (parseLineRange(Value, Offset, RangeLength))
+          Error = ("invalid range: " + Value).str();
+        else
+          Ranges.push_back(tooling::Range(Offset, RangeLength));
+      } else if (Name == "Length") {
+        HasLength = !Value.getAsInteger(10, Length);
+      } else {
+        Error = ("unknown header: " + Name).str();
+      }
+    }
+    if (!HasLength) {
+      // The end of the code cannot be found, so give up.
+      respond(/*Error=*/true, /*IncompleteFormat=*/false,
+              "missing or invalid Length header");
+      return true;
+    }
+    std::string Code(Length, '\0');
+    if (Length != 0 && fread(&Code[0], 1, Length, stdin) != Length) {
+      respond(/*Error=*/true, /*IncompleteFormat=*/false, "truncated code");
+      return true;
+    }
+    for (const tooling::Range &Range : Ranges)
+      if (Range.getOffset() + Range.getLength() > Length)
+        Error = "range is outside the code";
+    if (!Error.empty()) {
+      respond(/*Error=*/true, /*IncompleteFormat=*/false, Error);
+      continue;
+    }
+    if (Ranges.empty())
+      Ranges.push_back(tooling::Range(0, Length));
+    bool IncompleteFormat = false;
+    llvm::Expected<std::string> Formatted =
+        formatRequest(FileName, Code, Ranges, Styles, IncompleteFormat);
+    if (!Formatted)
+      respond(/*Error=*/true, IncompleteFormat,
+              llvm::toString(Formatted.takeError()));
+    else
+      respond(/*Error=*/false, IncompleteFormat, *Formatted);
+  }
+  return false;
+}
+
+// Formats \p FileName, writing the result to \p OS and errors to \p ErrOS.
+// Sets \p Unformatted if the file is not formatted yet.
+// Returns true on error.
+static bool formatFile(StringRef FileName, StyleCache &Styles, raw_ostream &OS,
+                       raw_ostream &ErrOS, bool &Unformatted) {
   ErrorOr<std::unique_ptr<MemoryBuffer>> CodeOrErr =
       MemoryBuffer::getFileOrSTDIN(FileName);
   if (std::error_code EC = CodeOrErr.getError()) {
-    errs() << EC.message() << "\n";
+    ErrOS << EC.message() << "\n";
     return true;
   }
   std::unique_ptr<llvm::MemoryBuffer> Code = std::move(CodeOrErr.get());
   if (Code->getBufferSize() == 0)
     return false; // Empty files are formatted correctly.
+  if (Stream) {
+    StringRef AssumedFileName = (FileName == "-") ? AssumeFileName : FileName;
+    FormatStyle FormatStyle = Styles.get(AssumedFileName);
+    if (SortIncludes.getNumOccurrences() != 0)
+      FormatStyle.SortIncludes = SortIncludes;
+    return formatInChunks(FileName, Code->getBuffer(), FormatStyle, OS, ErrOS);
+  }
   std::vector<tooling::Range> Ranges;
   if (fillRanges(Code.get(), Ranges))
     return true;
   StringRef AssumedFileName = (FileName == "-") ? AssumeFileName : FileName;
-  FormatStyle FormatStyle = getStyle(Style, AssumedFileName, FallbackStyle);
+  FormatStyle FormatStyle = Styles.get(AssumedFileName);
   if (SortIncludes.getNumOccurrences() != 0)
     FormatStyle.SortIncludes = SortIncludes;
   unsigned CursorPosition = Cursor;
@@ -259,7 +493,7 @@ static bool format(StringRef FileName) {
                                        AssumedFileName, &CursorPosition);
   auto ChangedCode = tooling::applyAllReplacements(Code->getBuffer(), Replaces);
   if (!ChangedCode) {
-    llvm::errs() << llvm::toString(ChangedCode.takeError()) << "\n";
+    ErrOS << llvm::toString(ChangedCode.takeError()) << "\n";
     return true;
   }
   for (const auto &R : Replaces)
@@ -269,17 +503,31 @@ static bool format(StringRef FileName) {
   Replacements FormatChanges = reformat(FormatStyle, *ChangedCode, Ranges,
                                         AssumedFileName, &IncompleteFormat);
   Replaces = tooling::mergeReplacements(Replaces, FormatChanges);
+  // Replacements that do not change the text, e.g. of already sorted
+  // includes, leave the file formatted.
+  for (const auto &R : Replaces) {
+    if (Code->getBuffer().substr(R.getOffset(), R.getLength()) !=
+        R.getReplacementText()) {
+      Unformatted = true;
+      break;
+    }
+  }
+  if (DryRun) {
+    if (Unformatted)
+      OS << FileName << "\n";
+    return false;
+  }
   if (OutputXML) {
-    outs() << "<?xml version='1.0'?>\n<replacements "
-              "xml:space='preserve' incomplete_format='"
-           << (IncompleteFormat ? "true" : "false") << "'>\n";
+    OS << "<?xml version='1.0'?>\n<replacements "
+          "xml:space='preserve' incomplete_format='"
+       << (IncompleteFormat ? "true" : "false") << "'>\n";
     if (Cursor.getNumOccurrences() != 0)
-      outs() << "<cursor>"
-             << tooling::shiftedCodePosition(FormatChanges, CursorPosition)
-             << "</cursor>\n";
+      OS << "<cursor>"
+         << tooling::shiftedCodePosition(FormatChanges, CursorPosition)
+         << "</cursor>\n";
 
-    outputReplacementsXML(Replaces); 
-    outs() << "</replacements>\n";
+    outputReplacementsXML(OS, Replaces);
+    OS << "</replacements>\n";
   } else {
     IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFileSystem(
         new vfs::InMemoryFileSystem);
@@ -294,21 +542,114 @@ static bool format(StringRef FileName) {
     tooling::applyAllReplacements(Replaces, Rewrite);
     if (Inplace) {
       if (FileName == "-")
-        errs() << "error: cannot use -i when reading from stdin.\n";
-      else if (Rewrite.overwriteChangedFiles())
+        ErrOS << "error: cannot use -i when reading from stdin.\n";
+      else if (Unformatted && Rewrite.overwriteChangedFiles())
         return true;
     } else {
       if (Cursor.getNumOccurrences() != 0)
-        outs() << "{ \"Cursor\": "
-               << tooling::shiftedCodePosition(FormatChanges, CursorPosition)
-               << ", \"IncompleteFormat\": "
-               << (IncompleteFormat ? "true" : "false") << " }\n";
-      Rewrite.getEditBuffer(ID).write(outs());
+        OS << "{ \"Cursor\": "
+           << tooling::shiftedCodePosition(FormatChanges, CursorPosition)
+           << ", \"IncompleteFormat\": "
+           << (IncompleteFormat ? "true" : "false") << " }\n";
+      Rewrite.getEditBuffer(ID).write(OS);
     }
   }
   return false;
 }
 
+// Writes \p Text to \p OS as a JSON string.
+static void printJSONString(raw_ostream &OS, StringRef Text) {
+  OS << '"';
+  for (char C : Text) {
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (static_cast<unsigned char>(C) < 0x20)
+      OS << "\\u00" << "0123456789abcdef"[C >> 4]
+         << "0123456789abcdef"[C & 15];
+    else
+      OS << C;
+  }
+  OS << '"';
+}
+
+// Formats \p FileName like formatFile() and, with -print-stats, writes
+// statistics about the formatting to \p ErrOS.
+static bool format(StringRef FileName, StyleCache &Styles, raw_ostream &OS,
+                   raw_ostream &ErrOS, bool &Unformatted) {
+  if (!PrintStats)
+    return formatFile(FileName, Styles, OS, ErrOS, Unformatted);
+  FormatStatistics Stats;
+  setFormatStatistics(&Stats);
+  bool Error = formatFile(FileName, Styles, OS, ErrOS, Unformatted);
+  setFormatStatistics(nullptr);
+  ErrOS << "{\"file\": ";
+  printJSONString(ErrOS, FileName);
+  ErrOS << ", \"statistics\": ";
+  printFormatStatistics(Stats, ErrOS);
+  ErrOS << "}\n";
+  return Error;
+}
+
+// Formats \p Files on \p NumThreads threads, writing the output of each file
+// in order as soon as it and all files before it are done.
+// Returns true on error.
+static bool formatFiles(ArrayRef<std::string> Files, unsigned NumThreads,
+                        bool &Unformatted) {
+  StyleCache Styles;
+  if (NumThreads == 0)
+    NumThreads = std::thread::hardware_concurrency();
+  NumThreads = std::max(1u, std::min<unsigned>(NumThreads, Files.size()));
+  if (NumThreads == 1) {
+    bool Error = false;
+    for (const std::string &File : Files)
+      Error |= format(File, Styles, outs(), errs(), Unformatted);
+    return Error;
+  }
+
+  struct Result {
+    std::string Output;
+    std::string Errors;
+    bool Error = false;
+    bool Unformatted = false;
+    bool Done = false;
+  };
+  std::vector<Result> Results(Files.size());
+  std::atomic<unsigned> NextFile(0);
+  std::mutex Mutex;
+  unsigned NextToWrite = 0;
+  bool AnyError = false;
+
+  auto FormatFiles = [&]() {
+    for (unsigned I = NextFile++; I < Files.size(); I = NextFile++) {
+      Result &R = Results[I];
+      {
+        raw_string_ostream OS(R.Output), ErrOS(R.Errors);
+        R.Error = format(Files[I], Styles, OS, ErrOS, R.Unformatted);
+      }
+      std::lock_guard<std::mutex> Lock(Mutex);
+      R.Done = true;
+      for (; NextToWrite < Results.size() && Results[NextToWrite].Done;
+           ++NextToWrite) {
+        Result &Ready = Results[NextToWrite];
+        outs() << Ready.Output;
+        errs() << Ready.Errors;
+        AnyError |= Ready.Error;
+        Unformatted |= Ready.Unformatted;
+        Ready = Result();
+        Ready.Done = true;
+      }
+    }
+  };
+
+  {
+    llvm::ThreadPool Pool(NumThreads);
+    for (unsigned I = 0; I != NumThreads; ++I)
+      Pool.async(FormatFiles);
+    Pool.wait();
+  }
+  return AnyError;
+}
+
 }  // namespace format
 }  // namespace clang
 
@@ -344,24 +685,38 @@ int main(int argc, const char **argv) {
     return 0;
   }
 
-  bool Error = false;
-  switch (FileNames.size()) {
-  case 0:
-    Error = clang::format::format("-");
-    break;
-  case 1:
-    Error = clang::format::format(FileNames[0]);
-    break;
-  default:
-    if (!Offsets.empty() || !Lengths.empty() || !LineRanges.empty()) {
-      errs() << "error: -offset, -length and -lines can only be used for "
-                "single file.\n";
+  if (FileNames.size() > 1 &&
+      (!Offsets.empty() || !Lengths.empty() || !LineRanges.empty())) {
+    errs() << "error: -offset, -length and -lines can only be used for "
+              "single file.\n";
+    return 1;
+  }
+  if (Stream && (!Offsets.empty() || !Lengths.empty() ||
+                 !LineRanges.empty() || Cursor.getNumOccurrences() != 0 ||
+                 DryRun || OutputXML)) {
+    errs() << "error: -stream cannot be used with -offset, -length, -lines, "
+              "-cursor, -dry-run or -output-replacements-xml.\n";
+    return 1;
+  }
+  if (Server) {
+    if (!FileNames.empty() || !Offsets.empty() || !Lengths.empty() ||
+        !LineRanges.empty() || Cursor.getNumOccurrences() != 0 || Inplace ||
+        DryRun || OutputXML || Stream) {
+      errs() << "error: -server cannot be used with <file>s or options that "
+                "select what to format or how to output it.\n";
       return 1;
     }
-    for (unsigned i = 0; i < FileNames.size(); ++i)
-      Error |= clang::format::format(FileNames[i]);
-    break;
+    clang::format::StyleCache Styles;
+    return clang::format::serve(Styles) ? 1 : 0;
   }
-  return Error ? 1 : 0;
+  std::vector<std::string> Files(FileNames.begin(), FileNames.end());
+  if (Files.empty())
+    Files.push_back("-");
+  bool Unformatted = false;
+  // Output is buffered per file when formatting in parallel, which would
+  // defeat -stream.
+  bool Error = clang::format::formatFiles(Files, Stream ? 1 : NumThreads,
+                                          Unformatted);
+  return Error || (DryRun && Unformatted) ? 1 : 0;
 }
 
@@ -0,0 +1,100 @@
+//===--- tools/clang-func-mapping/ClangFnMapGen.cpp - Function map tool ---===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements a clang-func-mapping tool that writes the index used
+//  by the static analyzer's cross translation unit analysis: a line for each
+//  function with external linkage that a source file defines, holding the
+//  function's USR and the name of the AST file for that source file.
+//
+//  The AST files are expected to be in the directory given to the analyzer
+//  with the ctu-dir configuration option, at the absolute path of their source
+//  file with ".ast" appended, as made by 'clang -emit-ast'.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/ASTConsumer.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Index/USRGeneration.h"
+#include "clang/Tooling/CommonOptionsParser.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+using namespace clang::tooling;
+using namespace llvm;
+
+static cl::OptionCategory ClangFnMapGenCategory("clang-func-mapping options");
+static cl::extrahelp CommonHelp(CommonOptionsParser::HelpMessage);
+
+namespace {
+
+class MapFunctionNamesConsumer : public ASTConsumer {
+public:
+  MapFunctionNamesConsumer(ASTContext &Context) : Ctx(Context) {}
+
+  void HandleTranslationUnit(ASTContext &Context) override {
+    handleDecl(Context.getTranslationUnitDecl());
+  }
+
+private:
+  void handleDecl(const Decl *D);
+
+  ASTContext &Ctx;
+};
+
+void MapFunctionNamesConsumer::handleDecl(const Decl *D) {
+  if (const auto *FD = dyn_cast<FunctionDecl>(D)) {
+    // Only the functions defined in the main file are to be looked up in its
+    // AST; the ones in headers are defined by every file that includes them.
+    const SourceManager &SM = Ctx.getSourceManager();
+    if (FD->isThisDeclarationADefinition() && FD->isExternallyVisible() &&
+        SM.isInMainFile(FD->getLocation())) {
+      SmallString<128> USR;
+      if (!index::generateUSRForDecl(FD, USR) && !USR.empty()) {
+        SmallString<128> File(
+            SM.getFileEntryForID(SM.getMainFileID())->getName());
+        llvm::sys::fs::make_absolute(File);
+        outs() << USR << ' ' << File << ".ast\n";
+      }
+    }
+    return;
+  }
+
+  if (isa<TranslationUnitDecl>(D) || isa<NamespaceDecl>(D) ||
+      isa<LinkageSpecDecl>(D) || isa<CXXRecordDecl>(D))
+    for (const Decl *Member : cast<DeclContext>(D)->decls())
+      handleDecl(Member);
+}
+
+class MapFunctionNamesAction : public ASTFrontendAction {
+protected:
+  std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
+                                                 StringRef) override {
+    return llvm::make_unique<MapFunctionNamesConsumer>(CI.getASTContext());
+  }
+};
+
+} // namespace
+
+int main(int argc, const char **argv) {
+  llvm::sys::PrintStackTraceOnErrorSignal(argv[0]);
+
+  CommonOptionsParser OptionsParser(argc, argv, ClangFnMapGenCategory);
+  ClangTool Tool(OptionsParser.getCompilations(),
+                 OptionsParser.getSourcePathList());
+  return Tool.run(newFrontendActionFactory<MapFunctionNamesAction>().get());
+}
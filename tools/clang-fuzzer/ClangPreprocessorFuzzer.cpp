@@ -0,0 +1,26 @@
+//===-- ClangPreprocessorFuzzer.cpp - Fuzz the Clang preprocessor ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief This file implements a function that runs the Clang lexer and
+///  preprocessor, but not the parser, on a single input. This function is
+///  then linked into the Fuzzer library.
+///
+//===----------------------------------------------------------------------===//
+
+#include "FuzzerFrontend.h"
+#include "clang/Frontend/FrontendActions.h"
+
+using namespace clang;
+
+extern "C" int LLVMFuzzerTestOneInput(uint8_t *data, size_t size) {
+  PreprocessOnlyAction Action;
+  fuzzer::runFrontendAction(Action, data, size);
+  return 0;
+}
@@ -0,0 +1,83 @@
+//===-- FuzzerFrontend.cpp - Persistent frontend for fuzzers --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Implements a frontend that is set up once per fuzzing process and
+///  reused for every input, so that the fuzzers spend their time in the
+///  lexer, parser and Sema rather than in setting up the compiler.
+///
+//===----------------------------------------------------------------------===//
+
+#include "FuzzerFrontend.h"
+#include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/VirtualFileSystem.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendAction.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/Option/ArgList.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+using namespace clang;
+
+namespace {
+/// \brief The compiler state that is kept across inputs.
+class PersistentFrontend {
+  CompilerInstance CI;
+
+public:
+  PersistentFrontend();
+
+  void run(FrontendAction &Action, const uint8_t *Data, size_t Size);
+};
+} // end anonymous namespace
+
+PersistentFrontend::PersistentFrontend() {
+  CI.createDiagnostics(new IgnoringDiagConsumer(), /*ShouldOwnClient=*/true);
+
+  llvm::opt::ArgStringList CC1Args;
+  CC1Args.push_back("-cc1");
+  CC1Args.push_back("./test.cc");
+  CI.setInvocation(tooling::newInvocation(&CI.getDiagnostics(), CC1Args));
+
+  // Headers the input tries to include are looked up in an empty in-memory
+  // file system, so they fail quickly and without touching the disk.
+  CI.setVirtualFileSystem(new vfs::InMemoryFileSystem());
+  CI.createFileManager();
+  CI.createSourceManager(CI.getFileManager());
+
+  CI.setTarget(TargetInfo::CreateTargetInfo(CI.getDiagnostics(),
+                                            CI.getInvocation().TargetOpts));
+  CI.getTarget().adjust(CI.getLangOpts());
+}
+
+void PersistentFrontend::run(FrontendAction &Action, const uint8_t *Data,
+                             size_t Size) {
+  // Forget the previous input: its files and the diagnostic state that
+  // refers to them.
+  CI.getSourceManager().clearIDTables();
+  CI.getDiagnostics().Reset();
+  ProcessWarningOptions(CI.getDiagnostics(), CI.getDiagnosticOpts(),
+                        /*ReportDiags=*/false);
+
+  // The source manager takes ownership of the buffer.
+  std::unique_ptr<llvm::MemoryBuffer> Input =
+      llvm::MemoryBuffer::getMemBufferCopy(
+          StringRef(reinterpret_cast<const char *>(Data), Size), "./test.cc");
+  if (Action.BeginSourceFile(CI, FrontendInputFile(Input.release(), IK_CXX))) {
+    Action.Execute();
+    Action.EndSourceFile();
+  }
+}
+
+void clang::fuzzer::runFrontendAction(FrontendAction &Action,
+                                      const uint8_t *Data, size_t Size) {
+  // Never destroyed: the fuzzer exits without unwinding.
+  static PersistentFrontend *Frontend = new PersistentFrontend();
+  Frontend->run(Action, Data, Size);
+}
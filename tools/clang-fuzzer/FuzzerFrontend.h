@@ -0,0 +1,41 @@
+//===-- FuzzerFrontend.h - Persistent frontend for fuzzers ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Declares the function the Clang fuzzers use to run a frontend
+///  action on a single input.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_CLANG_FUZZER_FUZZERFRONTEND_H
+#define LLVM_CLANG_TOOLS_CLANG_FUZZER_FUZZERFRONTEND_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace clang {
+class FrontendAction;
+
+namespace fuzzer {
+
+/// \brief Run \p Action on \p Data, as if it were the C++ source file
+/// "./test.cc".
+///
+/// The first call sets up a compiler instance with an in-memory file system,
+/// a diagnostics engine that ignores all diagnostics, the invocation and the
+/// target. Later calls reuse all of these and only create the per-file state,
+/// i.e. the preprocessor, the AST context and Sema, which the action discards
+/// again when it ends. Nothing is read from or written to disk.
+void runFrontendAction(FrontendAction &Action, const uint8_t *Data,
+                       size_t Size);
+
+} // end namespace fuzzer
+} // end namespace clang
+
+#endif
@@ -14,6 +14,10 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Option/Arg.h"
+#include "clang/Basic/CompileTimeBudget.h"
+#include "clang/Basic/FileSystemStatCache.h"
+#include "clang/Basic/TimeTrace.h"
+#include "clang/Basic/VirtualFileSystem.h"
 #include "clang/CodeGen/ObjectFilePCHContainerOperations.h"
 #include "clang/Driver/DriverDiagnostic.h"
 #include "clang/Driver/Options.h"
@@ -25,16 +29,24 @@
 #include "clang/Frontend/Utils.h"
 #include "clang/FrontendTool/Utils.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/LinkAllPasses.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/OptTable.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/StringSaver.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdio>
+#include <memory>
 using namespace clang;
 using namespace llvm::opt;
 
@@ -48,6 +60,13 @@ static void LLVMErrorHandler(void *UserData, const std::string &Message,
 
   Diags.Report(diag::err_fe_error_backend) << Message;
 
+  // If we run inside the driver's process, let it generate the crash
+  // diagnostics instead of exiting it; it also runs the interrupt handlers.
+  if (GenCrashDiag)
+    if (llvm::CrashRecoveryContext *CRC =
+            llvm::CrashRecoveryContext::GetCurrent())
+      CRC->HandleCrash();
+
   // Run the interrupt handlers to make sure any special cleanups get done, in
   // particular that we remove files registered with RemoveFileOnSignal.
   llvm::sys::RunInterruptHandlers();
@@ -64,16 +83,162 @@ void initializePollyPasses(llvm::PassRegistry &Registry);
 }
 #endif
 
-int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
-  std::unique_ptr<CompilerInstance> Clang(new CompilerInstance());
-  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+//===----------------------------------------------------------------------===//
+// Compile server
+//===----------------------------------------------------------------------===//
 
-  // Register the support for object-file-wrapped Clang modules.
-  auto PCHOps = Clang->getPCHContainerOperations();
-  PCHOps->registerWriter(llvm::make_unique<ObjectFilePCHContainerWriter>());
-  PCHOps->registerReader(llvm::make_unique<ObjectFilePCHContainerReader>());
+namespace {
+/// \brief The AST files (PCHs and modules) read by the jobs of a compile
+/// server, kept mapped between jobs.
+class ASTFileBuffers {
+public:
+  struct Entry {
+    vfs::Status Status;
+    std::shared_ptr<llvm::MemoryBuffer> Buffer;
+  };
+
+  /// \brief Returns the buffer of \p Path if the file described by \p Status
+  /// was read before, or null.
+  const Entry *lookup(StringRef Path, const vfs::Status &Status) const {
+    auto I = Entries.find(Path);
+    if (I == Entries.end() || !I->second.Status.equivalent(Status) ||
+        I->second.Status.getSize() != Status.getSize() ||
+        I->second.Status.getLastModificationTime() !=
+            Status.getLastModificationTime())
+      return nullptr;
+    return &I->second;
+  }
+
+  /// \brief Records the contents of \p Path, replacing whatever was recorded
+  /// for an older version of the file.
+  const Entry &insert(StringRef Path, Entry E) {
+    Entry &Slot = Entries[Path];
+    Slot = std::move(E);
+    return Slot;
+  }
+
+private:
+  llvm::StringMap<Entry> Entries;
+};
+
+/// \brief A view of a cached AST file that keeps it alive for as long as the
+/// AST reader holds on to it, even if a newer version replaces it.
+class SharedASTFileBuffer : public llvm::MemoryBuffer {
+  std::shared_ptr<llvm::MemoryBuffer> Buffer;
+
+public:
+  explicit SharedASTFileBuffer(std::shared_ptr<llvm::MemoryBuffer> Buffer)
+      : Buffer(std::move(Buffer)) {
+    init(this->Buffer->getBufferStart(), this->Buffer->getBufferEnd(),
+         /*RequiresNullTerminator=*/true);
+  }
+
+  BufferKind getBufferKind() const override {
+    return Buffer->getBufferKind();
+  }
+};
+
+/// \brief A file system that serves AST files out of an \c ASTFileBuffers
+/// cache and forwards every other request to the underlying file system.
+///
+/// Cached files are validated against the underlying file system every time
+/// they are opened, so AST files rebuilt by later jobs are picked up.
+class ASTFileBufferFileSystem : public vfs::FileSystem {
+  IntrusiveRefCntPtr<vfs::FileSystem> Underlying;
+  std::shared_ptr<ASTFileBuffers> Buffers;
+
+  class CachedFile : public vfs::File {
+    ASTFileBuffers::Entry E;
+
+  public:
+    explicit CachedFile(ASTFileBuffers::Entry E) : E(std::move(E)) {}
 
-  // Initialize targets first, so that --version shows registered targets.
+    llvm::ErrorOr<vfs::Status> status() override { return E.Status; }
+
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+    getBuffer(const Twine &Name, int64_t FileSize, bool RequiresNullTerminator,
+              bool IsVolatile) override {
+      return std::unique_ptr<llvm::MemoryBuffer>(
+          new SharedASTFileBuffer(E.Buffer));
+    }
+
+    std::error_code close() override { return std::error_code(); }
+  };
+
+  static bool isASTFile(StringRef Path) {
+    StringRef Ext = llvm::sys::path::extension(Path);
+    return Ext == ".pch" || Ext == ".pcm" || Ext == ".gch";
+  }
+
+public:
+  ASTFileBufferFileSystem(IntrusiveRefCntPtr<vfs::FileSystem> Underlying,
+                          std::shared_ptr<ASTFileBuffers> Buffers)
+      : Underlying(std::move(Underlying)), Buffers(std::move(Buffers)) {}
+
+  llvm::ErrorOr<vfs::Status> status(const Twine &Path) override {
+    return Underlying->status(Path);
+  }
+
+  llvm::ErrorOr<std::unique_ptr<vfs::File>>
+  openFileForRead(const Twine &Path) override {
+    llvm::ErrorOr<std::unique_ptr<vfs::File>> F =
+        Underlying->openFileForRead(Path);
+    SmallString<128> PathStorage;
+    StringRef PathStr = Path.toStringRef(PathStorage);
+    if (!F || !isASTFile(PathStr))
+      return F;
+    llvm::ErrorOr<vfs::Status> Status = (*F)->status();
+    if (!Status)
+      return F;
+
+    if (const ASTFileBuffers::Entry *E = Buffers->lookup(PathStr, *Status))
+      return std::unique_ptr<vfs::File>(new CachedFile(*E));
+
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+        (*F)->getBuffer(PathStr, Status->getSize(),
+                        /*RequiresNullTerminator=*/true,
+                        /*IsVolatile=*/false);
+    if (!Buffer)
+      return Buffer.getError();
+    ASTFileBuffers::Entry E;
+    E.Status = *Status;
+    E.Buffer = std::move(*Buffer);
+    return std::unique_ptr<vfs::File>(
+        new CachedFile(Buffers->insert(PathStr, std::move(E))));
+  }
+
+  vfs::directory_iterator dir_begin(const Twine &Dir,
+                                    std::error_code &EC) override {
+    return Underlying->dir_begin(Dir, EC);
+  }
+
+  std::error_code setCurrentWorkingDirectory(const Twine &Path) override {
+    return Underlying->setCurrentWorkingDirectory(Path);
+  }
+
+  llvm::ErrorOr<std::string> getCurrentWorkingDirectory() const override {
+    return Underlying->getCurrentWorkingDirectory();
+  }
+};
+
+/// \brief The state a compile server keeps between its jobs.
+struct CC1ServerState {
+  /// \brief The stat results of the files read by earlier jobs.
+  IntrusiveRefCntPtr<SharedStatCacheStorage> StatCache;
+
+  /// \brief The AST files read by earlier jobs.
+  std::shared_ptr<ASTFileBuffers> ASTFiles;
+
+  CC1ServerState() { reset(); }
+
+  void reset() {
+    StatCache = new SharedStatCacheStorage();
+    ASTFiles = std::make_shared<ASTFileBuffers>();
+  }
+};
+} // end anonymous namespace
+
+static void initializeTargets() {
   llvm::InitializeAllTargets();
   llvm::InitializeAllTargetMCs();
   llvm::InitializeAllAsmPrinters();
@@ -83,6 +248,24 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
   llvm::PassRegistry &Registry = *llvm::PassRegistry::getPassRegistry();
   polly::initializePollyPasses(Registry);
 #endif
+}
+
+/// \brief Runs a -cc1 job.  If \p Server is set, the job is run by a compile
+/// server and reuses the state the server keeps warm between jobs.
+static int executeCC1Job(ArrayRef<const char *> Argv, const char *Argv0,
+                         void *MainAddr, CC1ServerState *Server) {
+  std::unique_ptr<CompilerInstance> Clang(new CompilerInstance());
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+
+  // Register the support for object-file-wrapped Clang modules.
+  auto PCHOps = Clang->getPCHContainerOperations();
+  PCHOps->registerWriter(llvm::make_unique<ObjectFilePCHContainerWriter>());
+  PCHOps->registerReader(llvm::make_unique<ObjectFilePCHContainerReader>());
+
+  // Initialize targets first, so that --version shows registered targets.  A
+  // compile server has done so before running its first job.
+  if (!Server)
+    initializeTargets();
 
   // Buffer diagnostics from argument parsing so that we can output them using a
   // well formed diagnostic object.
@@ -103,17 +286,80 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
   if (!Clang->hasDiagnostics())
     return 1;
 
+  DiagsBuffer->FlushDiagnostics(Clang->getDiagnostics());
+  if (!Success)
+    return 1;
+
+  if (Server) {
+    // LLVM's command line options can only be parsed once per process.
+    if (!Clang->getFrontendOpts().LLVMArgs.empty()) {
+      llvm::errs() << "error: -mllvm options cannot be used with -cc1server\n";
+      return 1;
+    }
+    // The server lives on after the job, so its memory must be released.
+    Clang->getFrontendOpts().DisableFree = false;
+
+    IntrusiveRefCntPtr<vfs::FileSystem> VFS = createVFSFromCompilerInvocation(
+        Clang->getInvocation(), Clang->getDiagnostics());
+    if (!VFS)
+      return 1;
+    Clang->setVirtualFileSystem(
+        new ASTFileBufferFileSystem(std::move(VFS), Server->ASTFiles));
+    Clang->createFileManager();
+    // Implicit module builds overwrite module files in the middle of a job,
+    // which the stat cache would not notice.
+    if (!Clang->getLangOpts().Modules)
+      Clang->getFileManager().addStatCache(
+          llvm::make_unique<SharedStatCache>(Server->StatCache));
+  }
+
   // Set an error handler, so that any LLVM backend diagnostics go through our
   // error handler.
   llvm::install_fatal_error_handler(LLVMErrorHandler,
                                   static_cast<void*>(&Clang->getDiagnostics()));
 
-  DiagsBuffer->FlushDiagnostics(Clang->getDiagnostics());
-  if (!Success)
-    return 1;
+  // Record a time trace of the compilation, if requested.
+  const std::string &TimeTracePath = Clang->getFrontendOpts().TimeTracePath;
+  std::unique_ptr<TimeTrace> Trace;
+  if (!TimeTracePath.empty()) {
+    Trace.reset(new TimeTrace());
+    TimeTrace::setActive(Trace.get());
+  }
+
+  // Watch the time the compilation takes, if requested.
+  const FrontendOptions &FrontendOpts = Clang->getFrontendOpts();
+  std::unique_ptr<CompileTimeBudget> Budget;
+  if (FrontendOpts.CompileTimeBudget) {
+    Budget.reset(new CompileTimeBudget(
+        FrontendOpts.CompileTimeBudget,
+        FrontendOpts.CompileTimeBudgetReportPath,
+        FrontendOpts.CompileTimeBudgetAbort));
+    CompileTimeBudget::setActive(Budget.get());
+  }
 
   // Execute the frontend actions.
-  Success = ExecuteCompilerInvocation(Clang.get());
+  {
+    TimeTraceScope TraceScope("ExecuteCompiler");
+    Success = ExecuteCompilerInvocation(Clang.get());
+  }
+
+  if (Budget) {
+    Budget.reset();
+    CompileTimeBudget::setActive(nullptr);
+  }
+
+  if (Trace) {
+    TimeTrace::setActive(nullptr);
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(TimeTracePath, EC, llvm::sys::fs::F_Text);
+    if (EC) {
+      Clang->getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+          << TimeTracePath << EC.message();
+      Success = false;
+    } else {
+      Trace->write(OS);
+    }
+  }
 
   // If any timers were active but haven't been destroyed yet, print their
   // results now.  This happens in -disable-free mode.
@@ -124,6 +370,20 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
   // later errors use the default handling behavior instead.
   llvm::remove_fatal_error_handler();
 
+  // Later jobs may read the AST file this job wrote, whose old stat results
+  // may be cached.
+  if (Server) {
+    switch (Clang->getFrontendOpts().ProgramAction) {
+    case frontend::GenerateModule:
+    case frontend::GeneratePCH:
+    case frontend::GeneratePTH:
+      Server->StatCache = new SharedStatCacheStorage();
+      break;
+    default:
+      break;
+    }
+  }
+
   // When running with -disable-free, don't do any destruction or shutdown.
   if (Clang->getFrontendOpts().DisableFree) {
     BuryPointer(std::move(Clang));
@@ -132,3 +392,62 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
 
   return !Success;
 }
+
+int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
+  return executeCC1Job(Argv, Argv0, MainAddr, /*Server=*/nullptr);
+}
+
+// Reads a line from stdin without its line break into \p Line.
+// Returns false at the end of the input.
+static bool readLine(std::string &Line) {
+  Line.clear();
+  int C;
+  while ((C = getchar()) != EOF && C != '\n')
+    Line += C;
+  if (!Line.empty() && Line.back() == '\r')
+    Line.pop_back();
+  return C != EOF || !Line.empty();
+}
+
+/// \brief Runs -cc1 jobs read from stdin until it is closed.
+///
+/// Each line holds the arguments of one job as they would follow -cc1,
+/// quoted like in a response file.  After each job, a line "exit <status>"
+/// is written to stdout.  Diagnostics go to stderr as usual, so the jobs must
+/// not write their output to stdout.  Empty lines are ignored.
+///
+/// The server keeps the stat results of the files read by its jobs and the
+/// AST files they loaded between jobs.  Source files and headers must not
+/// change while it runs; a "#reset" line, answered with "exit 0", drops all
+/// of the cached state.
+int cc1server_main(ArrayRef<const char *> Argv, const char *Argv0,
+                   void *MainAddr) {
+  if (!Argv.empty()) {
+    llvm::errs() << "error: -cc1server takes no arguments\n";
+    return 1;
+  }
+
+  initializeTargets();
+  llvm::sys::ChangeStdinToBinary();
+
+  CC1ServerState Server;
+  std::string Line;
+  while (readLine(Line)) {
+    if (StringRef(Line).trim().empty())
+      continue;
+
+    int Res = 0;
+    if (StringRef(Line).trim() == "#reset") {
+      Server.reset();
+    } else {
+      llvm::BumpPtrAllocator Alloc;
+      llvm::StringSaver Saver(Alloc);
+      SmallVector<const char *, 64> JobArgs;
+      llvm::cl::TokenizeGNUCommandLine(Line, Saver, JobArgs);
+      Res = executeCC1Job(JobArgs, Argv0, MainAddr, &Server);
+    }
+    llvm::outs() << "exit " << Res << "\n";
+    llvm::outs().flush();
+  }
+  return 0;
+}
@@ -81,6 +81,8 @@ CXTranslationUnit cxtu::MakeCXTranslationUnit(CIndexer *CIdx, ASTUnit *AU) {
   D->StringPool = new cxstring::CXStringPool();
   D->Diagnostics = nullptr;
   D->OverridenCursorsPool = createOverridenCXCursorsPool();
+  D->USRCache = nullptr;
+  D->SemanticTokens = nullptr;
   D->CommentToXML = nullptr;
   return D;
 }
@@ -3205,6 +3207,10 @@ clang_parseTranslationUnit_Impl(CXIndex CIdx, const char *source_filename,
     = options & CXTranslationUnit_IncludeBriefCommentsInCodeCompletion;
   bool SkipFunctionBodies = options & CXTranslationUnit_SkipFunctionBodies;
   bool ForSerialization = options & CXTranslationUnit_ForSerialization;
+  bool StorePreamblesInMemory =
+      options & CXTranslationUnit_StorePreamblesInMemory;
+  bool SkipFunctionBodiesOutsideMainFile =
+      options & CXTranslationUnit_SkipFunctionBodiesOutsideMainFile;
 
   // Configure the diagnostics.
   IntrusiveRefCntPtr<DiagnosticsEngine>
@@ -3288,7 +3294,7 @@ clang_parseTranslationUnit_Impl(CXIndex CIdx, const char *source_filename,
       /*AllowPCHWithCompilerErrors=*/true, SkipFunctionBodies,
       /*UserFilesAreVolatile=*/true, ForSerialization,
       CXXIdx->getPCHContainerOperations()->getRawReader().getFormat(),
-      &ErrUnit));
+      StorePreamblesInMemory, SkipFunctionBodiesOutsideMainFile, &ErrUnit));
 
   // Early failures in LoadFromCommandLine may return with ErrUnit unset.
   if (!Unit && !ErrUnit)
@@ -3775,6 +3781,8 @@ void clang_disposeTranslationUnit(CXTranslationUnit CTUnit) {
     delete CTUnit->StringPool;
     delete static_cast<CXDiagnosticSetImpl *>(CTUnit->Diagnostics);
     disposeOverridenCXCursorsPool(CTUnit->OverridenCursorsPool);
+    disposeUSRCache(CTUnit->USRCache);
+    delete CTUnit->SemanticTokens;
     delete CTUnit->CommentToXML;
     delete CTUnit;
   }
@@ -3798,6 +3806,12 @@ clang_reparseTranslationUnit_Impl(CXTranslationUnit TU,
   delete static_cast<CXDiagnosticSetImpl*>(TU->Diagnostics);
   TU->Diagnostics = nullptr;
 
+  // The cached USRs are keyed by declarations of the old AST.
+  disposeUSRCache(TU->USRCache);
+  TU->USRCache = nullptr;
+  delete TU->SemanticTokens;
+  TU->SemanticTokens = nullptr;
+
   CIndexer *CXXIdx = TU->CIdx;
   if (CXXIdx->isOptEnabled(CXGlobalOpt_ThreadBackgroundPriorityForEditing))
     setThreadBackgroundPriority();
@@ -3860,6 +3874,92 @@ int clang_reparseTranslationUnit(CXTranslationUnit TU,
   return result;
 }
 
+static CXErrorCode
+clang_reparseTranslationUnitSnapshot_Impl(CXTranslationUnit TU,
+                                          ArrayRef<CXUnsavedFile> unsaved_files,
+                                          unsigned options,
+                                          CXTranslationUnit *out_TU) {
+  // Check arguments.
+  if (isNotUsableTU(TU) || !out_TU) {
+    LOG_BAD_TU(TU);
+    return CXError_InvalidArguments;
+  }
+  *out_TU = nullptr;
+
+  CIndexer *CXXIdx = TU->CIdx;
+  if (CXXIdx->isOptEnabled(CXGlobalOpt_ThreadBackgroundPriorityForEditing))
+    setThreadBackgroundPriority();
+
+  // No ConcurrencyCheck: the unit is only read, and may be queried by other
+  // threads meanwhile.
+  ASTUnit *CXXUnit = cxtu::getASTUnit(TU);
+
+  std::unique_ptr<std::vector<ASTUnit::RemappedFile>> RemappedFiles(
+      new std::vector<ASTUnit::RemappedFile>());
+
+  // Recover resources if we crash before exiting this function.
+  llvm::CrashRecoveryContextCleanupRegistrar<
+    std::vector<ASTUnit::RemappedFile> > RemappedCleanup(RemappedFiles.get());
+
+  for (auto &UF : unsaved_files) {
+    std::unique_ptr<llvm::MemoryBuffer> MB =
+        llvm::MemoryBuffer::getMemBufferCopy(getContents(UF), UF.Filename);
+    RemappedFiles->push_back(std::make_pair(UF.Filename, MB.release()));
+  }
+
+  std::unique_ptr<ASTUnit> NewUnit = CXXUnit->ReparseAsNewUnit(
+      CXXIdx->getPCHContainerOperations(), *RemappedFiles.get());
+  if (!NewUnit)
+    return CXError_Failure;
+
+  *out_TU = MakeCXTranslationUnit(CXXIdx, NewUnit.release());
+  return CXError_Success;
+}
+
+enum CXErrorCode
+clang_reparseTranslationUnitSnapshot(CXTranslationUnit TU,
+                                     unsigned num_unsaved_files,
+                                     struct CXUnsavedFile *unsaved_files,
+                                     unsigned options,
+                                     CXTranslationUnit *out_TU) {
+  LOG_FUNC_SECTION {
+    *Log << TU;
+  }
+
+  if (num_unsaved_files && !unsaved_files)
+    return CXError_InvalidArguments;
+
+  CXErrorCode result;
+  auto ReparseSnapshotImpl = [=, &result]() {
+    result = clang_reparseTranslationUnitSnapshot_Impl(
+        TU, llvm::makeArrayRef(unsaved_files, num_unsaved_files), options,
+        out_TU);
+  };
+
+  if (getenv("LIBCLANG_NOTHREADS")) {
+    ReparseSnapshotImpl();
+    return result;
+  }
+
+  llvm::CrashRecoveryContext CRC;
+
+  if (!RunSafely(CRC, ReparseSnapshotImpl)) {
+    fprintf(stderr, "libclang: crash detected during reparsing\n");
+    return CXError_Crashed;
+  }
+
+  return result;
+}
+
+void clang_setFunctionBodyFocus(CXTranslationUnit TU, unsigned start_line,
+                                unsigned end_line) {
+  if (isNotUsableTU(TU)) {
+    LOG_BAD_TU(TU);
+    return;
+  }
+
+  cxtu::getASTUnit(TU)->setFunctionBodyFocus(start_line, end_line);
+}
 
 CXString clang_getTranslationUnitSpelling(CXTranslationUnit CTUnit) {
   if (isNotUsableTU(CTUnit)) {
@@ -4080,6 +4180,112 @@ unsigned clang_visitChildrenWithBlock(CXCursor parent,
   return clang_visitChildren(parent, visitWithBlock, block);
 }
 
+namespace {
+/// \brief The storage behind the arrays of a CXFlattenedCursors.
+struct AllocatedCXFlattenedCursors : CXFlattenedCursors {
+  std::vector<CXCursor> CursorStorage;
+  std::vector<CXCursorKind> KindStorage;
+  std::vector<int> ParentStorage;
+  std::vector<CXFile> FileStorage;
+  std::vector<unsigned> BeginOffsetStorage;
+  std::vector<unsigned> EndOffsetStorage;
+  std::vector<int> USROffsetStorage;
+  std::string USRStorage;
+  std::vector<int> SpellingOffsetStorage;
+  std::string SpellingStorage;
+
+  bool IncludeUSRs;
+  bool IncludeSpellings;
+
+  /// \brief The indices of the cursors from the flattened cursor's child
+  /// down to the most recently visited cursor.
+  SmallVector<unsigned, 32> Path;
+};
+} // end anonymous namespace
+
+static enum CXChildVisitResult flattenCursor(CXCursor cursor, CXCursor parent,
+                                             CXClientData client_data) {
+  AllocatedCXFlattenedCursors *Flat =
+      static_cast<AllocatedCXFlattenedCursors *>(client_data);
+
+  // Cursors are visited in pre-order, so the parent is on the path.
+  while (!Flat->Path.empty() &&
+         !clang_equalCursors(Flat->CursorStorage[Flat->Path.back()], parent))
+    Flat->Path.pop_back();
+  Flat->ParentStorage.push_back(Flat->Path.empty() ? -1 : Flat->Path.back());
+
+  Flat->Path.push_back(Flat->CursorStorage.size());
+  Flat->CursorStorage.push_back(cursor);
+  Flat->KindStorage.push_back(clang_getCursorKind(cursor));
+
+  CXSourceRange Extent = clang_getCursorExtent(cursor);
+  CXFile File = nullptr;
+  unsigned BeginOffset = 0, EndOffset = 0;
+  clang_getFileLocation(clang_getRangeStart(Extent), &File, nullptr, nullptr,
+                        &BeginOffset);
+  clang_getFileLocation(clang_getRangeEnd(Extent), nullptr, nullptr, nullptr,
+                        &EndOffset);
+  Flat->FileStorage.push_back(File);
+  Flat->BeginOffsetStorage.push_back(BeginOffset);
+  Flat->EndOffsetStorage.push_back(EndOffset);
+
+  int USROffset = -1;
+  if (Flat->IncludeUSRs) {
+    CXString USR = clang_getCursorUSR(cursor);
+    const char *Str = clang_getCString(USR);
+    if (Str && *Str) {
+      USROffset = Flat->USRStorage.size();
+      Flat->USRStorage += Str;
+      Flat->USRStorage += '\0';
+    }
+    clang_disposeString(USR);
+  }
+  Flat->USROffsetStorage.push_back(USROffset);
+
+  int SpellingOffset = -1;
+  if (Flat->IncludeSpellings) {
+    CXString Spelling = clang_getCursorSpelling(cursor);
+    SpellingOffset = Flat->SpellingStorage.size();
+    if (const char *Str = clang_getCString(Spelling))
+      Flat->SpellingStorage += Str;
+    Flat->SpellingStorage += '\0';
+    clang_disposeString(Spelling);
+  }
+  Flat->SpellingOffsetStorage.push_back(SpellingOffset);
+
+  return CXChildVisit_Recurse;
+}
+
+CXFlattenedCursors *clang_flattenCursorChildren(CXCursor parent,
+                                                unsigned options) {
+  if (clang_Cursor_isNull(parent) || !getCursorTU(parent))
+    return nullptr;
+
+  std::unique_ptr<AllocatedCXFlattenedCursors> Flat(
+      new AllocatedCXFlattenedCursors);
+  Flat->IncludeUSRs = options & CXFlattenCursor_IncludeUSRs;
+  Flat->IncludeSpellings = options & CXFlattenCursor_IncludeSpellings;
+  clang_visitChildren(parent, flattenCursor, Flat.get());
+  Flat->Path.clear();
+
+  Flat->NumCursors = Flat->CursorStorage.size();
+  Flat->Cursors = Flat->CursorStorage.data();
+  Flat->Kinds = Flat->KindStorage.data();
+  Flat->Parents = Flat->ParentStorage.data();
+  Flat->Files = Flat->FileStorage.data();
+  Flat->BeginOffsets = Flat->BeginOffsetStorage.data();
+  Flat->EndOffsets = Flat->EndOffsetStorage.data();
+  Flat->USROffsets = Flat->USROffsetStorage.data();
+  Flat->USRs = Flat->USRStorage.c_str();
+  Flat->SpellingOffsets = Flat->SpellingOffsetStorage.data();
+  Flat->Spellings = Flat->SpellingStorage.c_str();
+  return Flat.release();
+}
+
+void clang_disposeFlattenedCursors(CXFlattenedCursors *cursors) {
+  delete static_cast<AllocatedCXFlattenedCursors *>(cursors);
+}
+
 static CXString getDeclSpelling(const Decl *D) {
   if (!D)
     return cxstring::createEmpty();
@@ -6862,6 +7068,169 @@ void clang_annotateTokens(CXTranslationUnit TU,
 
 } // end: extern "C"
 
+//===----------------------------------------------------------------------===//
+// Semantic token APIs.
+//===----------------------------------------------------------------------===//
+
+/// \brief Classify an identifier token by the cursor it was annotated with.
+static CXSemanticTokenClass getSemanticTokenClass(CXCursor C) {
+  if (C.kind == CXCursor_MacroDefinition || C.kind == CXCursor_MacroExpansion)
+    return CXSemanticToken_Macro;
+
+  if (!clang_isDeclaration(C.kind)) {
+    C = clang_getCursorReferenced(C);
+    if (clang_Cursor_isNull(C))
+      return CXSemanticToken_None;
+  }
+
+  switch (C.kind) {
+  case CXCursor_Namespace:
+  case CXCursor_NamespaceAlias:
+    return CXSemanticToken_Namespace;
+
+  case CXCursor_StructDecl:
+  case CXCursor_UnionDecl:
+  case CXCursor_ClassDecl:
+  case CXCursor_EnumDecl:
+  case CXCursor_TypedefDecl:
+  case CXCursor_TypeAliasDecl:
+  case CXCursor_TypeAliasTemplateDecl:
+  case CXCursor_ClassTemplate:
+  case CXCursor_ClassTemplatePartialSpecialization:
+  case CXCursor_ObjCInterfaceDecl:
+  case CXCursor_ObjCProtocolDecl:
+  case CXCursor_ObjCCategoryDecl:
+  case CXCursor_ObjCImplementationDecl:
+  case CXCursor_ObjCCategoryImplDecl:
+    return CXSemanticToken_Type;
+
+  case CXCursor_EnumConstantDecl:
+    return CXSemanticToken_EnumConstant;
+
+  case CXCursor_FieldDecl:
+  case CXCursor_ObjCIvarDecl:
+  case CXCursor_ObjCPropertyDecl:
+    return CXSemanticToken_Field;
+
+  case CXCursor_FunctionDecl:
+  case CXCursor_FunctionTemplate:
+    if (const Decl *D = getCursorDecl(C))
+      if (dyn_cast_or_null<CXXMethodDecl>(D->getAsFunction()))
+        return CXSemanticToken_Method;
+    return CXSemanticToken_Function;
+
+  case CXCursor_CXXMethod:
+  case CXCursor_Constructor:
+  case CXCursor_Destructor:
+  case CXCursor_ConversionFunction:
+  case CXCursor_ObjCInstanceMethodDecl:
+  case CXCursor_ObjCClassMethodDecl:
+    return CXSemanticToken_Method;
+
+  case CXCursor_ParmDecl:
+    return CXSemanticToken_Parameter;
+
+  case CXCursor_VarDecl:
+    return CXSemanticToken_Variable;
+
+  case CXCursor_TemplateTypeParameter:
+  case CXCursor_NonTypeTemplateParameter:
+  case CXCursor_TemplateTemplateParameter:
+    return CXSemanticToken_TemplateParameter;
+
+  case CXCursor_MacroDefinition:
+    return CXSemanticToken_Macro;
+
+  case CXCursor_LabelStmt:
+    return CXSemanticToken_Label;
+
+  default:
+    return CXSemanticToken_None;
+  }
+}
+
+/// \brief Tokenize, annotate and classify a whole file of the translation
+/// unit.
+static void computeSemanticTokens(CXTranslationUnit TU, FileID FID,
+                                  std::vector<CXSemanticToken> &Result) {
+  ASTUnit *CXXUnit = cxtu::getASTUnit(TU);
+  SourceManager &SM = CXXUnit->getSourceManager();
+
+  SmallVector<CXToken, 256> Tokens;
+  getTokens(CXXUnit,
+            SourceRange(SM.getLocForStartOfFile(FID), SM.getLocForEndOfFile(FID)),
+            Tokens);
+  if (Tokens.empty())
+    return;
+
+  std::vector<CXCursor> Cursors(Tokens.size());
+  clang_annotateTokens(TU, Tokens.data(), Tokens.size(), Cursors.data());
+
+  Result.reserve(Tokens.size());
+  for (unsigned I = 0, N = Tokens.size(); I != N; ++I) {
+    CXSemanticToken T;
+    T.Offset = SM.getFileOffset(
+        SourceLocation::getFromRawEncoding(Tokens[I].int_data[1]));
+    T.Length = Tokens[I].int_data[2];
+    T.Kind = clang_getTokenKind(Tokens[I]);
+    T.Class = T.Kind == CXToken_Identifier ? getSemanticTokenClass(Cursors[I])
+                                           : CXSemanticToken_None;
+    Result.push_back(T);
+  }
+}
+
+extern "C" {
+
+unsigned clang_getSemanticTokens(CXTranslationUnit TU, CXFile file,
+                                 unsigned begin_offset, unsigned end_offset,
+                                 const CXSemanticToken **tokens) {
+  LOG_FUNC_SECTION {
+    *Log << TU << ' ' << file << ' ' << begin_offset << '-' << end_offset;
+  }
+
+  if (tokens)
+    *tokens = nullptr;
+
+  if (isNotUsableTU(TU)) {
+    LOG_BAD_TU(TU);
+    return 0;
+  }
+
+  ASTUnit *CXXUnit = cxtu::getASTUnit(TU);
+  if (!CXXUnit || !file || !tokens)
+    return 0;
+
+  const FileEntry *FE = static_cast<const FileEntry *>(file);
+  if (!TU->SemanticTokens)
+    TU->SemanticTokens = new CXSemanticTokensCache();
+  auto Insertion = TU->SemanticTokens->insert(
+      std::make_pair(FE, std::vector<CXSemanticToken>()));
+  std::vector<CXSemanticToken> &FileTokens = Insertion.first->second;
+  if (Insertion.second) {
+    FileID FID = CXXUnit->getSourceManager().translateFile(FE);
+    if (FID.isValid())
+      computeSemanticTokens(TU, FID, FileTokens);
+  }
+
+  auto Begin = std::lower_bound(
+      FileTokens.begin(), FileTokens.end(), begin_offset,
+      [](const CXSemanticToken &T, unsigned Offset) {
+        return T.Offset < Offset;
+      });
+  auto End = std::lower_bound(
+      Begin, FileTokens.end(), end_offset,
+      [](const CXSemanticToken &T, unsigned Offset) {
+        return T.Offset < Offset;
+      });
+  if (Begin == End)
+    return 0;
+
+  *tokens = &*Begin;
+  return End - Begin;
+}
+
+} // end: extern "C"
+
 //===----------------------------------------------------------------------===//
 // Operations for querying linkage of a cursor.
 //===----------------------------------------------------------------------===//
@@ -520,36 +520,81 @@ static unsigned long long getContextsForContextKind(
   return contexts;
 }
 
+/// \brief Retrieve the text the user has to type to select the given result,
+/// if it can be determined without building the result's completion string.
+///
+/// \returns true if \p TypedText was set, false if the completion string is
+/// needed to determine it.
+static bool getCheapTypedText(const CodeCompletionResult &R,
+                              StringRef &TypedText) {
+  switch (R.Kind) {
+  case CodeCompletionResult::RK_Keyword:
+    TypedText = R.Keyword;
+    return true;
+
+  case CodeCompletionResult::RK_Macro:
+    TypedText = R.Macro->getName();
+    return true;
+
+  case CodeCompletionResult::RK_Pattern:
+    if (const char *Text = R.Pattern->getTypedText())
+      TypedText = Text;
+    else
+      TypedText = StringRef();
+    return true;
+
+  case CodeCompletionResult::RK_Declaration:
+    // Objective-C methods and special names (operators, constructors, ...)
+    // have typed text that differs from a plain identifier.
+    if (isa<ObjCMethodDecl>(R.Declaration) ||
+        !R.Declaration->getDeclName().isIdentifier())
+      return false;
+    TypedText = R.Declaration->getName();
+    return true;
+  }
+  llvm_unreachable("Unhandled code-completion result kind");
+}
+
 namespace {
   class CaptureCompletionResults : public CodeCompleteConsumer {
     AllocatedCXCodeCompleteResults &AllocatedResults;
     CodeCompletionTUInfo CCTUInfo;
     SmallVector<CXCompletionResult, 16> StoredResults;
     CXTranslationUnit *TU;
+
+    /// \brief Only results whose typed text starts with this prefix, ignoring
+    /// case, are kept.
+    std::string Prefix;
+
+    /// \brief The maximum number of results to keep, or 0 for no limit.
+    unsigned MaxResults;
+
+    /// \brief Whether \p TypedText passes the prefix filter.
+    bool matchesPrefix(StringRef TypedText) const {
+      return TypedText.startswith_lower(Prefix);
+    }
+
   public:
     CaptureCompletionResults(const CodeCompleteOptions &Opts,
                              AllocatedCXCodeCompleteResults &Results,
-                             CXTranslationUnit *TranslationUnit)
+                             CXTranslationUnit *TranslationUnit,
+                             StringRef Prefix = StringRef(),
+                             unsigned MaxResults = 0)
       : CodeCompleteConsumer(Opts, false), 
         AllocatedResults(Results), CCTUInfo(Results.CodeCompletionAllocator),
-        TU(TranslationUnit) { }
+        TU(TranslationUnit), Prefix(Prefix), MaxResults(MaxResults) { }
     ~CaptureCompletionResults() override { Finish(); }
 
     void ProcessCodeCompleteResults(Sema &S, 
                                     CodeCompletionContext Context,
                                     CodeCompletionResult *Results,
                                     unsigned NumResults) override {
-      StoredResults.reserve(StoredResults.size() + NumResults);
-      for (unsigned I = 0; I != NumResults; ++I) {
-        CodeCompletionString *StoredCompletion        
-          = Results[I].CreateCodeCompletionString(S, Context, getAllocator(),
-                                                  getCodeCompletionTUInfo(),
-                                                  includeBriefComments());
-        
-        CXCompletionResult R;
-        R.CursorKind = Results[I].CursorKind;
-        R.CompletionString = StoredCompletion;
-        StoredResults.push_back(R);
+      if (Prefix.empty() && !MaxResults) {
+        StoredResults.reserve(StoredResults.size() + NumResults);
+        for (unsigned I = 0; I != NumResults; ++I)
+          storeResult(S, Context, Results[I], nullptr);
+      } else {
+        filterAndStoreResults(S, Context, Results, NumResults);
       }
       
       enum CodeCompletionContext::Kind contextKind = Context.getKind();
@@ -636,6 +681,60 @@ namespace {
     CodeCompletionTUInfo &getCodeCompletionTUInfo() override { return CCTUInfo;}
 
   private:
+    /// \brief Store a result, building its completion string unless
+    /// \p Completion has already been built.
+    void storeResult(Sema &S, const CodeCompletionContext &Context,
+                     CodeCompletionResult &Result,
+                     CodeCompletionString *Completion) {
+      if (!Completion)
+        Completion = Result.CreateCodeCompletionString(
+            S, Context, getAllocator(), getCodeCompletionTUInfo(),
+            includeBriefComments());
+
+      CXCompletionResult R;
+      R.CursorKind = Result.CursorKind;
+      R.CompletionString = Completion;
+      StoredResults.push_back(R);
+    }
+
+    /// \brief Store the results that pass the prefix filter, best priority
+    /// first and at most \c MaxResults of them.
+    ///
+    /// Completion strings are only built for the results that are kept,
+    /// except when the typed text of a result cannot be determined without
+    /// one.
+    void filterAndStoreResults(Sema &S, const CodeCompletionContext &Context,
+                               CodeCompletionResult *Results,
+                               unsigned NumResults) {
+      typedef std::pair<unsigned, CodeCompletionString *> Candidate;
+      SmallVector<Candidate, 64> Candidates;
+      for (unsigned I = 0; I != NumResults; ++I) {
+        StringRef TypedText;
+        CodeCompletionString *Completion = nullptr;
+        if (!getCheapTypedText(Results[I], TypedText)) {
+          Completion = Results[I].CreateCodeCompletionString(
+              S, Context, getAllocator(), getCodeCompletionTUInfo(),
+              includeBriefComments());
+          if (const char *Text = Completion->getTypedText())
+            TypedText = Text;
+        }
+        if (matchesPrefix(TypedText))
+          Candidates.push_back(Candidate(I, Completion));
+      }
+
+      if (MaxResults && Candidates.size() > MaxResults) {
+        std::stable_sort(Candidates.begin(), Candidates.end(),
+                         [&](const Candidate &X, const Candidate &Y) {
+          return Results[X.first].Priority < Results[Y.first].Priority;
+        });
+        Candidates.resize(MaxResults);
+      }
+
+      StoredResults.reserve(StoredResults.size() + Candidates.size());
+      for (const Candidate &C : Candidates)
+        storeResult(S, Context, Results[C.first], C.second);
+    }
+
     void Finish() {
       AllocatedResults.Results = new CXCompletionResult [StoredResults.size()];
       AllocatedResults.NumResults = StoredResults.size();
@@ -650,7 +749,8 @@ static CXCodeCompleteResults *
 clang_codeCompleteAt_Impl(CXTranslationUnit TU, const char *complete_filename,
                           unsigned complete_line, unsigned complete_column,
                           ArrayRef<CXUnsavedFile> unsaved_files,
-                          unsigned options) {
+                          unsigned options, StringRef Prefix,
+                          unsigned MaxResults) {
   bool IncludeBriefComments = options & CXCodeComplete_IncludeBriefComments;
 
 #ifdef UDP_CODE_COMPLETION_LOGGER
@@ -698,7 +798,7 @@ clang_codeCompleteAt_Impl(CXTranslationUnit TU, const char *complete_filename,
   // Create a code-completion consumer to capture the results.
   CodeCompleteOptions Opts;
   Opts.IncludeBriefComments = IncludeBriefComments;
-  CaptureCompletionResults Capture(Opts, *Results, &TU);
+  CaptureCompletionResults Capture(Opts, *Results, &TU, Prefix, MaxResults);
 
   // Perform completion.
   AST->CodeComplete(complete_filename, complete_line, complete_column,
@@ -802,19 +902,36 @@ CXCodeCompleteResults *clang_codeCompleteAt(CXTranslationUnit TU,
                                             struct CXUnsavedFile *unsaved_files,
                                             unsigned num_unsaved_files,
                                             unsigned options) {
+  return clang_codeCompleteAtWithFilter(TU, complete_filename, complete_line,
+                                        complete_column, unsaved_files,
+                                        num_unsaved_files, options, nullptr,
+                                        0);
+}
+
+CXCodeCompleteResults *
+clang_codeCompleteAtWithFilter(CXTranslationUnit TU,
+                               const char *complete_filename,
+                               unsigned complete_line, unsigned complete_column,
+                               struct CXUnsavedFile *unsaved_files,
+                               unsigned num_unsaved_files, unsigned options,
+                               const char *prefix, unsigned max_results) {
   LOG_FUNC_SECTION {
     *Log << TU << ' '
          << complete_filename << ':' << complete_line << ':' << complete_column;
+    if (prefix && *prefix)
+      *Log << " prefix=" << prefix;
   }
 
   if (num_unsaved_files && !unsaved_files)
     return nullptr;
 
+  StringRef Prefix = prefix ? prefix : "";
   CXCodeCompleteResults *result;
   auto CodeCompleteAtImpl = [=, &result]() {
     result = clang_codeCompleteAt_Impl(
         TU, complete_filename, complete_line, complete_column,
-        llvm::makeArrayRef(unsaved_files, num_unsaved_files), options);
+        llvm::makeArrayRef(unsaved_files, num_unsaved_files), options, Prefix,
+        max_results);
   };
 
   if (getenv("LIBCLANG_NOTHREADS")) {
@@ -18,7 +18,10 @@
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Index/USRGeneration.h"
 #include "clang/Lex/PreprocessingRecord.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
@@ -36,60 +39,112 @@ bool cxcursor::getDeclCursorUSR(const Decl *D, SmallVectorImpl<char> &Buf) {
   return generateUSRForDecl(D, Buf);
 }
 
-extern "C" {
-
-CXString clang_getCursorUSR(CXCursor C) {
-  const CXCursorKind &K = clang_getCursorKind(C);
+namespace {
+/// \brief The USR computed for a declaration or macro definition.
+struct CachedUSR {
+  /// \brief The USR, or an empty string if the entity has none.
+  StringRef USR;
+  /// \brief The hash of \c USR, or 0 if the entity has none.
+  unsigned long long Hash;
+};
+
+/// \brief The USRs computed so far for the entities of a translation unit,
+/// keyed by canonical declaration or by macro definition record.
+struct USRCache {
+  llvm::BumpPtrAllocator Alloc;
+  llvm::DenseMap<const void *, CachedUSR> Entries;
+};
+} // end anonymous namespace
+
+void cxcursor::disposeUSRCache(void *cache) {
+  delete static_cast<USRCache *>(cache);
+}
 
+/// \brief Retrieve the USR of the entity referenced by \p C, computing and
+/// caching it in the translation unit on first use.
+///
+/// \returns null if the cursor does not reference a declaration or macro
+/// definition.
+static const CachedUSR *getCachedCursorUSR(CXCursor C) {
+  const CXCursorKind K = clang_getCursorKind(C);
+  const void *Key;
   if (clang_isDeclaration(K)) {
     const Decl *D = cxcursor::getCursorDecl(C);
     if (!D)
-      return cxstring::createEmpty();
-
-    CXTranslationUnit TU = cxcursor::getCursorTU(C);
-    if (!TU)
-      return cxstring::createEmpty();
-
-    cxstring::CXStringBuf *buf = cxstring::getCXStringBuf(TU);
-    if (!buf)
-      return cxstring::createEmpty();
-
-    bool Ignore = cxcursor::getDeclCursorUSR(D, buf->Data);
-    if (Ignore) {
-      buf->dispose();
-      return cxstring::createEmpty();
-    }
-
-    // Return the C-string, but don't make a copy since it is already in
-    // the string buffer.
-    buf->Data.push_back('\0');
-    return createCXString(buf);
+      return nullptr;
+    Key = D->getCanonicalDecl();
+  } else if (K == CXCursor_MacroDefinition) {
+    Key = cxcursor::getCursorMacroDefinition(C);
+  } else {
+    return nullptr;
   }
 
-  if (K == CXCursor_MacroDefinition) {
-    CXTranslationUnit TU = cxcursor::getCursorTU(C);
-    if (!TU)
-      return cxstring::createEmpty();
-
-    cxstring::CXStringBuf *buf = cxstring::getCXStringBuf(TU);
-    if (!buf)
-      return cxstring::createEmpty();
-
-    bool Ignore = generateUSRForMacro(cxcursor::getCursorMacroDefinition(C),
-                                      cxtu::getASTUnit(TU)->getSourceManager(),
-                                      buf->Data);
-    if (Ignore) {
-      buf->dispose();
-      return cxstring::createEmpty();
-    }
-
-    // Return the C-string, but don't make a copy since it is already in
-    // the string buffer.
-    buf->Data.push_back('\0');
-    return createCXString(buf);
-  }
+  CXTranslationUnit TU = cxcursor::getCursorTU(C);
+  if (!TU)
+    return nullptr;
+
+  if (!TU->USRCache)
+    TU->USRCache = new USRCache();
+  USRCache &Cache = *static_cast<USRCache *>(TU->USRCache);
+
+  auto Insertion = Cache.Entries.insert(std::make_pair(Key, CachedUSR()));
+  CachedUSR &Entry = Insertion.first->second;
+  if (!Insertion.second)
+    return &Entry;
+
+  SmallString<128> Buf;
+  bool Ignore;
+  if (K == CXCursor_MacroDefinition)
+    Ignore = generateUSRForMacro(cxcursor::getCursorMacroDefinition(C),
+                                 cxtu::getASTUnit(TU)->getSourceManager(), Buf);
+  else
+    Ignore = cxcursor::getDeclCursorUSR(cxcursor::getCursorDecl(C), Buf);
+
+  Entry.Hash = 0;
+  if (Ignore || Buf.empty())
+    return &Entry;
+
+  // Keep the string null-terminated so that it can be handed out directly.
+  char *Data = Cache.Alloc.Allocate<char>(Buf.size() + 1);
+  std::copy(Buf.begin(), Buf.end(), Data);
+  Data[Buf.size()] = '\0';
+  Entry.USR = StringRef(Data, Buf.size());
+  Entry.Hash = llvm::hash_value(Entry.USR);
+  // Reserve 0 for "no USR".
+  if (Entry.Hash == 0)
+    Entry.Hash = 1;
+  return &Entry;
+}
+
+extern "C" {
+
+CXString clang_getCursorUSR(CXCursor C) {
+  const CachedUSR *Entry = getCachedCursorUSR(C);
+  if (!Entry || Entry->USR.empty())
+    return cxstring::createEmpty();
+
+  // The cache is dropped when the translation unit is reparsed, so hand out
+  // a copy that lives as long as the translation unit, as before.
+  cxstring::CXStringBuf *buf =
+      cxstring::getCXStringBuf(cxcursor::getCursorTU(C));
+  if (!buf)
+    return cxstring::createEmpty();
+  buf->Data.append(Entry->USR.begin(), Entry->USR.end());
+  buf->Data.push_back('\0');
+  return createCXString(buf);
+}
+
+void clang_getCursorUSRs(const CXCursor *cursors, unsigned num_cursors,
+                         CXString *usrs) {
+  if (!cursors || !usrs)
+    return;
+  for (unsigned I = 0; I != num_cursors; ++I)
+    usrs[I] = clang_getCursorUSR(cursors[I]);
+}
 
-  return cxstring::createEmpty();
+unsigned long long clang_getCursorUSRHash(CXCursor C) {
+  const CachedUSR *Entry = getCachedCursorUSR(C);
+  return Entry ? Entry->Hash : 0;
 }
 
 CXString clang_constructUSR_ObjCIvar(const char *name, CXString classUSR) {
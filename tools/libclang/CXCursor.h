@@ -284,6 +284,10 @@ CXCursor getTypeRefCursor(CXCursor cursor);
 /// false otherwise.
 bool getDeclCursorUSR(const Decl *D, SmallVectorImpl<char> &Buf);
 
+/// \brief Dispose of the USRs cached for a translation unit by
+/// \c clang_getCursorUSR() and friends.
+void disposeUSRCache(void *cache);
+
 bool operator==(CXCursor X, CXCursor Y);
   
 inline bool operator!=(CXCursor X, CXCursor Y) {
@@ -17,21 +17,31 @@
 #include "CLog.h"
 #include "CXString.h"
 #include "clang-c/Index.h"
+#include "llvm/ADT/DenseMap.h"
+#include <vector>
 
 namespace clang {
   class ASTUnit;
   class CIndexer;
+  class FileEntry;
 namespace index {
 class CommentToXMLConverter;
 } // namespace index
 } // namespace clang
 
+/// \brief The semantic tokens computed for the files of a translation unit by
+/// \c clang_getSemanticTokens().
+typedef llvm::DenseMap<const clang::FileEntry *, std::vector<CXSemanticToken>>
+    CXSemanticTokensCache;
+
 struct CXTranslationUnitImpl {
   clang::CIndexer *CIdx;
   clang::ASTUnit *TheASTUnit;
   clang::cxstring::CXStringPool *StringPool;
   void *Diagnostics;
   void *OverridenCursorsPool;
+  void *USRCache;
+  CXSemanticTokensCache *SemanticTokens;
   clang::index::CommentToXMLConverter *CommentToXML;
 };
 
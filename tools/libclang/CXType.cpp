@@ -229,13 +229,10 @@ CXString clang_getTypeSpelling(CXType CT) {
     return cxstring::createEmpty();
 
   CXTranslationUnit TU = GetTU(CT);
-  SmallString<64> Str;
-  llvm::raw_svector_ostream OS(Str);
-  PrintingPolicy PP(cxtu::getASTUnit(TU)->getASTContext().getLangOpts());
+  ASTContext &Ctx = cxtu::getASTUnit(TU)->getASTContext();
+  PrintingPolicy PP(Ctx.getLangOpts());
 
-  T.print(OS, PP);
-
-  return cxstring::createDup(OS.str());
+  return cxstring::createDup(Ctx.getTypeAsString(T, PP));
 }
 
 CXType clang_getTypedefDeclUnderlyingType(CXCursor C) {
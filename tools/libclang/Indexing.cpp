@@ -31,7 +31,12 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/RWMutex.h"
+#include "llvm/Support/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
+#include <thread>
 #include <utility>
 
 using namespace clang;
@@ -125,24 +130,40 @@ namespace llvm {
 
 namespace {
 
+/// \brief The regions whose bodies have been parsed by any translation unit
+/// of an indexing session.
+///
+/// The set is split into shards with a lock each, so that translation units
+/// indexed in parallel rarely contend, and lookups only take a shard's read
+/// lock.
 class SessionSkipBodyData {
-  llvm::sys::Mutex Mux;
-  PPRegionSetTy ParsedRegions;
+  static const unsigned NumShards = 64;
 
-public:
-  SessionSkipBodyData() : Mux(/*recursive=*/false) {}
-  ~SessionSkipBodyData() {
-    //llvm::errs() << "RegionData: " << Skipped.size() << " - " << Skipped.getMemorySize() << "\n";
+  struct Shard {
+    llvm::sys::RWMutex Mux;
+    PPRegionSetTy ParsedRegions;
+  };
+  Shard Shards[NumShards];
+
+  Shard &getShard(const PPRegion &Region) {
+    // Use the high bits; the sets inside the shards use the low ones.
+    unsigned Hash = llvm::DenseMapInfo<PPRegion>::getHashValue(Region);
+    return Shards[(Hash >> 24) % NumShards];
   }
 
-  void copyTo(PPRegionSetTy &Set) {
-    llvm::MutexGuard MG(Mux);
-    Set = ParsedRegions;
+public:
+  bool isParsed(const PPRegion &Region) {
+    Shard &S = getShard(Region);
+    llvm::sys::ScopedReader Guard(S.Mux);
+    return S.ParsedRegions.count(Region);
   }
 
   void update(ArrayRef<PPRegion> Regions) {
-    llvm::MutexGuard MG(Mux);
-    ParsedRegions.insert(Regions.begin(), Regions.end());
+    for (const PPRegion &Region : Regions) {
+      Shard &S = getShard(Region);
+      llvm::sys::ScopedWriter Guard(S.Mux);
+      S.ParsedRegions.insert(Region);
+    }
   }
 };
 
@@ -151,7 +172,6 @@ class TUSkipBodyControl {
   PPConditionalDirectiveRecord &PPRec;
   Preprocessor &PP;
 
-  PPRegionSetTy ParsedRegions;
   SmallVector<PPRegion, 32> NewParsedRegions;
   PPRegion LastRegion;
   bool LastIsParsed;
@@ -160,9 +180,7 @@ public:
   TUSkipBodyControl(SessionSkipBodyData &sessionData,
                     PPConditionalDirectiveRecord &ppRec,
                     Preprocessor &pp)
-    : SessionData(sessionData), PPRec(ppRec), PP(pp) {
-    SessionData.copyTo(ParsedRegions);
-  }
+    : SessionData(sessionData), PPRec(ppRec), PP(pp) {}
 
   bool isParsed(SourceLocation Loc, FileID FID, const FileEntry *FE) {
     PPRegion region = getRegion(Loc, FID, FE);
@@ -174,7 +192,7 @@ public:
       return LastIsParsed;
 
     LastRegion = region;
-    LastIsParsed = ParsedRegions.count(region);
+    LastIsParsed = SessionData.isParsed(region);
     if (!LastIsParsed)
       NewParsedRegions.push_back(region);
     return LastIsParsed;
@@ -914,6 +932,102 @@ int clang_indexSourceFileFullArgv(
   return result;
 }
 
+int clang_indexCompileCommands(CXIndexAction idxAction,
+                               CXClientData client_data,
+                               IndexerCallbacks *index_callbacks,
+                               unsigned index_callbacks_size,
+                               unsigned index_options,
+                               CXCompileCommands commands,
+                               unsigned num_threads, int *results) {
+  unsigned NumCommands = clang_CompileCommands_getSize(commands);
+  LOG_FUNC_SECTION {
+    *Log << NumCommands << " compile commands";
+  }
+
+  if (!idxAction)
+    return CXError_InvalidArguments;
+  if (!NumCommands)
+    return CXError_Success;
+
+  // CIndexer computes the resource path lazily; do it before the workers
+  // start asking for it.
+  IndexSessionData *IdxSession = static_cast<IndexSessionData *>(idxAction);
+  static_cast<CIndexer *>(IdxSession->CIdx)->getClangResourcesPath();
+
+  std::atomic<unsigned> NextCommand(0);
+  std::atomic<bool> AnyFailed(false);
+  auto IndexCommands = [&] {
+    for (unsigned I = NextCommand++; I < NumCommands; I = NextCommand++) {
+      CXCompileCommand Cmd = clang_CompileCommands_getCommand(commands, I);
+
+      // Each command runs in its own directory, which we can't chdir to
+      // from several threads; let the driver resolve paths against it.
+      SmallVector<CXString, 32> Strings;
+      Strings.push_back(clang_CompileCommand_getDirectory(Cmd));
+      for (unsigned A = 0, N = clang_CompileCommand_getNumArgs(Cmd); A != N;
+           ++A)
+        Strings.push_back(clang_CompileCommand_getArg(Cmd, A));
+
+      SmallVector<const char *, 32> Args;
+      if (Strings.size() > 1) {
+        Args.push_back(clang_getCString(Strings[1]));
+        Args.push_back("-working-directory");
+        Args.push_back(clang_getCString(Strings[0]));
+        for (unsigned A = 2, N = Strings.size(); A != N; ++A)
+          Args.push_back(clang_getCString(Strings[A]));
+      }
+
+      CXErrorCode Result = CXError_Failure;
+      auto IndexCommandImpl = [&]() {
+        Result = clang_indexSourceFile_Impl(
+            idxAction, client_data, index_callbacks, index_callbacks_size,
+            index_options, /*source_filename=*/nullptr, Args.data(),
+            Args.size(), None, /*out_TU=*/nullptr, /*TU_options=*/0);
+      };
+
+      if (Args.empty()) {
+        Result = CXError_InvalidArguments;
+      } else if (getenv("LIBCLANG_NOTHREADS")) {
+        IndexCommandImpl();
+      } else {
+        llvm::CrashRecoveryContext CRC;
+        if (!RunSafely(CRC, IndexCommandImpl)) {
+          fprintf(stderr, "libclang: crash detected during indexing compile "
+                          "command %u: {\n", I);
+          fprintf(stderr, "  'command_line_args' : [");
+          for (unsigned A = 0, N = Args.size(); A != N; ++A) {
+            if (A)
+              fprintf(stderr, ", ");
+            fprintf(stderr, "'%s'", Args[A]);
+          }
+          fprintf(stderr, "],\n}\n");
+          Result = CXError_Crashed;
+        }
+      }
+
+      for (CXString &Str : Strings)
+        clang_disposeString(Str);
+
+      if (results)
+        results[I] = Result;
+      if (Result != CXError_Success)
+        AnyFailed = true;
+    }
+  };
+
+  unsigned NumWorkers = num_threads ? num_threads
+                                    : std::thread::hardware_concurrency();
+  NumWorkers = std::max(1u, std::min(NumWorkers, NumCommands));
+  {
+    llvm::ThreadPool Pool(NumWorkers);
+    for (unsigned I = 0; I != NumWorkers; ++I)
+      Pool.async(IndexCommands);
+    Pool.wait();
+  }
+
+  return AnyFailed ? CXError_Failure : CXError_Success;
+}
+
 int clang_indexTranslationUnit(CXIndexAction idxAction,
                                CXClientData client_data,
                                IndexerCallbacks *index_callbacks,
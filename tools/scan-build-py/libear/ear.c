@@ -12,8 +12,9 @@
  * uses these functions instead of those from the standard library.
  *
  * The idea here is to inject a logic before call the real methods. The logic is
- * to dump the call into a file. To call the real method this library is doing
- * the job of the dynamic linker.
+ * to send the call to the collector of intercept-build, or to dump it into a
+ * file when the collector does not listen. To call the real method this
+ * library is doing the job of the dynamic linker.
  *
  * The only input for the log writing is about the destination directory.
  * This is passed as environment variable.
@@ -29,6 +30,8 @@
 #include <unistd.h>
 #include <dlfcn.h>
 #include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 #if defined HAVE_POSIX_SPAWN || defined HAVE_POSIX_SPAWNP
 #include <spawn.h>
@@ -41,6 +44,12 @@ extern char **environ;
 #endif
 
 #define ENV_OUTPUT "INTERCEPT_BUILD_TARGET_DIR"
+/* the socket of the collector in the output directory, if it listens */
+#define COLLECTOR_SOCKET "collector.sock"
+
+#ifndef MSG_NOSIGNAL
+# define MSG_NOSIGNAL 0
+#endif
 #ifdef APPLE
 # define ENV_FLAT    "DYLD_FORCE_FLAT_NAMESPACE"
 # define ENV_PRELOAD "DYLD_INSERT_LIBRARIES"
@@ -71,6 +80,10 @@ static char const **bear_update_environment(char *const envp[], bear_env_t *env)
 static char const **bear_update_environ(char const **in, char const *key, char const *value);
 static char **bear_get_environment();
 static void bear_report_call(char const *fun, char const *const argv[]);
+static char *bear_format_record(char const *fun, char const *cwd,
+                                char const *const argv[], size_t *length);
+static int bear_send_to_collector(char const *out_dir, char const *record,
+                                  size_t length);
 static char const **bear_strings_build(char const *arg, va_list *ap);
 static char const **bear_strings_copy(char const **const in);
 static char const **bear_strings_append(char const **in, char const *e);
@@ -403,13 +416,13 @@ static int call_posix_spawnp(pid_t *restrict pid, const char *restrict file,
 }
 #endif
 
-/* this method is to write log about the process creation. */
+/* this method is to write log about the process creation.
+ *
+ * The record is sent to the collector of intercept-build when it listens,
+ * otherwise it is appended to a file named after the process in the output
+ * directory. */
 
 static void bear_report_call(char const *fun, char const *const argv[]) {
-    static int const GS = 0x1d;
-    static int const RS = 0x1e;
-    static int const US = 0x1f;
-
     if (!initialized)
         return;
 
@@ -420,32 +433,102 @@ static void bear_report_call(char const *fun, char const *const argv[]) {
         exit(EXIT_FAILURE);
     }
     char const * const out_dir = initial_env[0];
-    size_t const path_max_length = strlen(out_dir) + 32;
-    char filename[path_max_length];
-    if (-1 == snprintf(filename, path_max_length, "%s/%d.cmd", out_dir, getpid())) {
-        perror("bear: snprintf");
+    size_t length = 0;
+    char * const record = bear_format_record(fun, cwd, argv, &length);
+    if (!bear_send_to_collector(out_dir, record, length)) {
+        size_t const path_max_length = strlen(out_dir) + 32;
+        char filename[path_max_length];
+        if (-1 == snprintf(filename, path_max_length, "%s/%d.cmd", out_dir, getpid())) {
+            perror("bear: snprintf");
+            exit(EXIT_FAILURE);
+        }
+        FILE * fd = fopen(filename, "a+");
+        if (0 == fd) {
+            perror("bear: fopen");
+            exit(EXIT_FAILURE);
+        }
+        if (length != fwrite(record, 1, length, fd)) {
+            perror("bear: fwrite");
+            exit(EXIT_FAILURE);
+        }
+        if (fclose(fd)) {
+            perror("bear: fclose");
+            exit(EXIT_FAILURE);
+        }
+    }
+    free((void *)record);
+    free((void *)cwd);
+    pthread_mutex_unlock(&mutex);
+}
+
+static char *bear_format_record(char const *fun, char const *cwd,
+                                char const *const argv[], size_t *length) {
+    static int const GS = 0x1d;
+    static int const RS = 0x1e;
+    static int const US = 0x1f;
+
+    size_t const argc = bear_strings_length(argv);
+    size_t size = 64 + strlen(fun) + strlen(cwd);
+    for (size_t it = 0; it < argc; ++it) {
+        size += strlen(argv[it]) + 1;
+    }
+    char * const record = malloc(size);
+    if (0 == record) {
+        perror("bear: malloc");
         exit(EXIT_FAILURE);
     }
-    FILE * fd = fopen(filename, "a+");
-    if (0 == fd) {
-        perror("bear: fopen");
+    int const head = snprintf(record, size, "%d%c%d%c%s%c%s%c",
+                              getpid(), RS, getppid(), RS, fun, RS, cwd, RS);
+    if (head < 0) {
+        perror("bear: snprintf");
         exit(EXIT_FAILURE);
     }
-    fprintf(fd, "%d%c", getpid(), RS);
-    fprintf(fd, "%d%c", getppid(), RS);
-    fprintf(fd, "%s%c", fun, RS);
-    fprintf(fd, "%s%c", cwd, RS);
-    size_t const argc = bear_strings_length(argv);
+    size_t position = (size_t)head;
     for (size_t it = 0; it < argc; ++it) {
-        fprintf(fd, "%s%c", argv[it], US);
+        size_t const arg_length = strlen(argv[it]);
+        memcpy(record + position, argv[it], arg_length);
+        position += arg_length;
+        record[position++] = (char)US;
     }
-    fprintf(fd, "%c", GS);
-    if (fclose(fd)) {
-        perror("bear: fclose");
-        exit(EXIT_FAILURE);
+    record[position++] = (char)GS;
+    *length = position;
+    return record;
+}
+
+/* returns non zero when the whole record was sent to the collector. */
+
+static int bear_send_to_collector(char const *out_dir, char const *record,
+                                  size_t length) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    int const path_length = snprintf(address.sun_path, sizeof(address.sun_path),
+                                     "%s/%s", out_dir, COLLECTOR_SOCKET);
+    if (path_length < 0 || (size_t)path_length >= sizeof(address.sun_path))
+        return 0;
+
+    int const sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (-1 == sock)
+        return 0;
+#ifdef SO_NOSIGPIPE
+    int const on = 1;
+    setsockopt(sock, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+    if (-1 == connect(sock, (struct sockaddr const *)&address, sizeof(address))) {
+        close(sock);
+        return 0;
     }
-    free((void *)cwd);
-    pthread_mutex_unlock(&mutex);
+    while (length) {
+        ssize_t const sent = send(sock, record, length, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            close(sock);
+            return 0;
+        }
+        record += sent;
+        length -= (size_t)sent;
+    }
+    close(sock);
+    return 1;
 }
 
 /* update environment assure that chilren processes will copy the desired
@@ -114,7 +114,7 @@ def run_analyzer(args, output_dir):
         generator = (dict(cmd, **consts)
                      for cmd in json.load(handle) if not exclude(cmd['file']))
         # when verbose output requested execute sequentially
-        pool = multiprocessing.Pool(1 if args.verbose > 2 else None)
+        pool = multiprocessing.Pool(1 if args.verbose > 2 else args.jobs)
         for current in pool.imap_unordered(run, generator):
             if current is not None:
                 # display error message from the static analyzer
@@ -279,6 +279,9 @@ def validate(parser, args, from_build_command):
     if from_build_command and not args.build:
         parser.error('missing build command')
 
+    if args.jobs is not None and args.jobs < 1:
+        parser.error('the number of jobs shall be positive')
+
 
 def create_parser(from_build_command):
     """ Command line argument parser factory method. """
@@ -455,6 +458,13 @@ def create_parser(from_build_command):
                 Could be usefull when project contains 3rd party libraries.
                 The directory path shall be absolute path as file names in
                 the compilation database.""")
+    advanced.add_argument(
+        '--jobs', '-j',
+        metavar='<number>',
+        type=int,
+        help="""The number of analyzer processes to run in parallel, which is
+                also used to parse the reports. Defaults to the number of
+                processors.""")
     advanced.add_argument(
         '--force-analyze-debug-code',
         dest='force_debug',
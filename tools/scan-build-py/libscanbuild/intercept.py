@@ -10,15 +10,18 @@ This implementation is using the LD_PRELOAD or DYLD_INSERT_LIBRARIES
 mechanisms provided by the dynamic linker. The related library is implemented
 in C language and can be found under 'libear' directory.
 
-The 'libear' library is capturing all child process creation and logging the
-relevant information about it into separate files in a specified directory.
-The parameter of this process is the output directory name, where the report
-files shall be placed. This parameter is passed as an environment variable.
+The 'libear' library is capturing all child process creation and sending the
+relevant information about it to a collector, which listens on a Unix domain
+socket in a specified directory. When the collector can not be reached, the
+information is logged into separate files in that directory instead. The
+parameter of this process is the directory name, which is passed as an
+environment variable.
 
 The module also implements compiler wrappers to intercept the compiler calls.
 
 The module implements the build command execution and the post-processing of
-the output files, which will condensates into a compilation database. """
+the exec calls, which will condensates into a compilation database. The
+database is written as the exec calls are received. """
 
 import sys
 import os
@@ -27,9 +30,12 @@ import re
 import itertools
 import json
 import glob
+import socket
 import argparse
 import logging
+import threading
 import subprocess
+import contextlib
 from libear import build_libear, TemporaryDirectory
 from libscanbuild import command_entry_point
 from libscanbuild import duplicate_check, tempdir, initialize_logging
@@ -42,6 +48,8 @@ GS = chr(0x1d)
 RS = chr(0x1e)
 US = chr(0x1f)
 
+COLLECTOR_SOCKET = 'collector.sock'
+
 COMPILER_WRAPPER_CC = 'intercept-cc'
 COMPILER_WRAPPER_CXX = 'intercept-c++'
 
@@ -66,52 +74,169 @@ def intercept_build_main(bin_dir):
 def capture(args, bin_dir):
     """ The entry point of build command interception. """
 
-    def post_processing(commands):
+    def post_processing(exec_traces):
         """ To make a compilation database, it needs to filter out commands
         which are not compiler calls. Needs to find the source file name
-        from the arguments. And do shell escaping on the command.
+        from the arguments. And do shell escaping on the command. """
+
+        if 'raw_entries' in args and args.raw_entries:
+            return exec_traces
+        entries = itertools.chain.from_iterable(
+            # creates a sequence of entry generators from an exec,
+            format_entry(exec_trace) for exec_trace in exec_traces)
+        return (entry for entry in entries if os.path.exists(entry['file']))
 
-        To support incremental builds, it is desired to read elements from
+    def previous_entries():
+        """ To support incremental builds, it is desired to read elements from
         an existing compilation database from a previous run. These elements
         shall be merged with the new elements. """
 
-        # create entries from the current run
-        current = itertools.chain.from_iterable(
-            # creates a sequence of entry generators from an exec,
-            format_entry(command) for command in commands)
-        # read entries from previous run
         if 'append' in args and args.append and os.path.isfile(args.cdb):
             with open(args.cdb) as handle:
-                previous = iter(json.load(handle))
-        else:
-            previous = iter([])
-        # filter out duplicate entries from both
-        duplicate = duplicate_check(entry_hash)
-        return (entry
-                for entry in itertools.chain(previous, current)
-                if os.path.exists(entry['file']) and not duplicate(entry))
+                return [entry for entry in json.load(handle)
+                        if os.path.exists(entry['file'])]
+        return []
+
+    unique = None if 'raw_entries' in args and args.raw_entries \
+        else entry_hash
 
     with TemporaryDirectory(prefix='intercept-', dir=tempdir()) as tmp_dir:
-        # run the build command
-        environment = setup_environment(args, tmp_dir, bin_dir)
-        logging.debug('run build in environment: %s', environment)
-        exit_code = subprocess.call(args.build, env=environment)
-        logging.info('build finished with exit code: %d', exit_code)
-        # read the intercepted exec calls
-        exec_traces = itertools.chain.from_iterable(
-            parse_exec_trace(os.path.join(tmp_dir, filename))
-            for filename in sorted(glob.iglob(os.path.join(tmp_dir, '*.cmd'))))
-        # do post processing only if that was requested
-        if 'raw_entries' not in args or not args.raw_entries:
-            entries = post_processing(exec_traces)
-        else:
-            entries = exec_traces
-        # dump the compilation database
-        with open(args.cdb, 'w+') as handle:
-            json.dump(list(entries), handle, sort_keys=True, indent=4)
+        previous = previous_entries()
+        with CompilationDatabaseWriter(args.cdb, unique) as output:
+            for entry in previous:
+                output.write(entry)
+            # receive the intercepted exec calls while the build runs
+            collector = ExecTraceCollector.start(
+                tmp_dir,
+                lambda content: output.write_all(
+                    post_processing(parse_exec_content(content))))
+            try:
+                # run the build command
+                environment = setup_environment(args, tmp_dir, bin_dir)
+                logging.debug('run build in environment: %s', environment)
+                exit_code = subprocess.call(args.build, env=environment)
+                logging.info('build finished with exit code: %d', exit_code)
+            finally:
+                if collector is not None:
+                    collector.stop()
+            # read the exec calls which could not be sent to the collector
+            for filename in sorted(glob.iglob(os.path.join(tmp_dir,
+                                                           '*.cmd'))):
+                output.write_all(post_processing(parse_exec_trace(filename)))
         return exit_code
 
 
+class CompilationDatabaseWriter(object):
+    """ Writes a compilation database entry by entry, as they are received,
+    in the same format as 'json.dump' would write the whole list.
+
+    When 'unique' is given, it is used to drop duplicate entries; only the
+    hashes of the entries written so far are kept in memory. """
+
+    def __init__(self, filename, unique):
+        self.handle = open(filename, 'w+')
+        self.duplicate = duplicate_check(unique) if unique else None
+        self.count = 0
+        self.handle.write('[')
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *_):
+        self.handle.write('\n]' if self.count else ']')
+        self.handle.close()
+
+    def write(self, entry):
+        """ Write a single entry, unless it is a duplicate. """
+
+        if self.duplicate is not None and self.duplicate(entry):
+            return
+        content = json.dumps(entry, sort_keys=True, indent=4)
+        lines = ('    ' + line for line in content.splitlines())
+        self.handle.write((',' if self.count else '') + '\n' +
+                          '\n'.join(lines))
+        self.handle.flush()
+        self.count += 1
+
+    def write_all(self, entries):
+        """ Write each of the given entries. """
+
+        for entry in entries:
+            self.write(entry)
+
+
+class ExecTraceCollector(object):
+    """ Receives the exec calls from the 'libear' library and the compiler
+    wrappers over a Unix domain socket in the target directory.
+
+    Each exec call is sent over its own connection, which the collector
+    reads to the end and passes to 'handler' on its own thread. This avoids
+    creating a file for each process of the build. """
+
+    def __init__(self, target_dir, handler):
+        self.path = os.path.join(target_dir, COLLECTOR_SOCKET)
+        self.handler = handler
+        self.stopping = False
+        self.server = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        try:
+            self.server.bind(self.path)
+            self.server.listen(socket.SOMAXCONN)
+        except:
+            self.server.close()
+            raise
+        self.thread = threading.Thread(target=self.serve)
+        self.thread.daemon = True
+        self.thread.start()
+
+    @staticmethod
+    def start(target_dir, handler):
+        """ Returns a running collector, or None when this platform or the
+        target directory does not allow it. The exec calls are written to
+        files in the target directory then. """
+
+        if not hasattr(socket, 'AF_UNIX'):
+            return None
+        try:
+            return ExecTraceCollector(target_dir, handler)
+        except (IOError, OSError, socket.error):
+            logging.debug('exec trace collector not started', exc_info=1)
+            return None
+
+    def serve(self):
+        """ Accepts connections until the collector is stopped. """
+
+        while True:
+            connection, _ = self.server.accept()
+            with contextlib.closing(connection):
+                chunks = []
+                while True:
+                    chunk = connection.recv(65536)
+                    if not chunk:
+                        break
+                    chunks.append(chunk)
+            # the connection which wakes up the collector sends nothing
+            if not chunks and self.stopping:
+                return
+            try:
+                self.handler(b''.join(chunks).decode('utf-8'))
+            except Exception:
+                logging.exception('processing exec trace failed')
+
+    def stop(self):
+        """ Processes the exec calls received so far and stops.
+
+        The build has finished, so all of its connections are queued before
+        the empty one made here to wake up the collector. """
+
+        self.stopping = True
+        wakeup = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        with contextlib.closing(wakeup):
+            wakeup.connect(self.path)
+        self.thread.join()
+        self.server.close()
+        os.unlink(self.path)
+
+
 def setup_environment(args, destination, bin_dir):
     """ Sets up the environment for the build command.
 
@@ -169,13 +294,10 @@ def intercept_build_wrapper(cplusplus):
         if not target_dir:
             raise UserWarning('exec report target directory not found')
         pid = str(os.getpid())
-        target_file = os.path.join(target_dir, pid + '.cmd')
-        logging.debug('writing exec report to: %s', target_file)
-        with open(target_file, 'ab') as handler:
-            working_dir = os.getcwd()
-            command = US.join(sys.argv) + US
-            content = RS.join([pid, pid, 'wrapper', working_dir, command]) + GS
-            handler.write(content.encode('utf-8'))
+        working_dir = os.getcwd()
+        command = US.join(sys.argv) + US
+        content = RS.join([pid, pid, 'wrapper', working_dir, command]) + GS
+        report_exec(target_dir, pid, content.encode('utf-8'))
     except IOError:
         logging.exception('writing exec report failed')
     except UserWarning as warning:
@@ -188,6 +310,25 @@ def intercept_build_wrapper(cplusplus):
     return subprocess.call(compilation)
 
 
+def report_exec(target_dir, pid, content):
+    """ Send the report of an exec call to the collector, or write it to
+    a file in the target directory when the collector does not listen. """
+
+    if hasattr(socket, 'AF_UNIX'):
+        try:
+            connection = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+            with contextlib.closing(connection):
+                connection.connect(os.path.join(target_dir, COLLECTOR_SOCKET))
+                connection.sendall(content)
+            return
+        except socket.error:
+            logging.debug('exec trace collector not available')
+    target_file = os.path.join(target_dir, pid + '.cmd')
+    logging.debug('writing exec report to: %s', target_file)
+    with open(target_file, 'ab') as handler:
+        handler.write(content)
+
+
 def parse_exec_trace(filename):
     """ Parse the file generated by the 'libear' preloaded library.
 
@@ -198,15 +339,29 @@ def parse_exec_trace(filename):
     logging.debug('parse exec trace file: %s', filename)
     with open(filename, 'r') as handler:
         content = handler.read()
-        for group in filter(bool, content.split(GS)):
-            records = group.split(RS)
-            yield {
-                'pid': records[0],
-                'ppid': records[1],
-                'function': records[2],
-                'directory': records[3],
-                'command': records[4].split(US)[:-1]
-            }
+    return parse_exec_content(content)
+
+
+def parse_exec_content(content):
+    """ Parse the reports of exec calls, as written by the 'libear' preloaded
+    library or wrapper command.
+
+    An incomplete report at the end, left by a writer which failed, is
+    ignored. """
+
+    # everything after the last group separator is incomplete
+    for group in filter(bool, content.split(GS)[:-1]):
+        records = group.split(RS)
+        if len(records) != 5:
+            logging.warning('malformed exec trace: %s', group)
+            continue
+        yield {
+            'pid': records[0],
+            'ppid': records[1],
+            'function': records[2],
+            'directory': records[3],
+            'command': records[4].split(US)[:-1]
+        }
 
 
 def format_entry(exec_trace):
@@ -15,17 +15,21 @@ import sys
 import shutil
 import time
 import tempfile
-import itertools
 import plistlib
 import glob
 import json
 import logging
 import contextlib
+import multiprocessing
 from libscanbuild import duplicate_check
 from libscanbuild.clang import get_version
 
 __all__ = ['report_directory', 'document']
 
+# The number of bugs listed on one page of the cover report. Projects with
+# more bugs get additional 'index-<n>.html' pages, linked from each other.
+BUGS_PER_PAGE = 5000
+
 
 @contextlib.contextmanager
 def report_directory(hint, keep):
@@ -62,41 +66,85 @@ def report_directory(hint, keep):
 
 
 def document(args, output_dir, use_cdb):
-    """ Generates cover report and returns the number of bugs/crashes. """
+    """ Generates cover report and returns the number of bugs/crashes.
+
+    The bugs are parsed in parallel and written to the report as they come,
+    so that the memory use does not grow with the number of reports. """
 
     html_reports_available = args.output_format in {'html', 'plist-html'}
+    jobs = getattr(args, 'jobs', None)
 
     logging.debug('count crashes and bugs')
     crash_count = sum(1 for _ in read_crashes(output_dir))
     bug_counter = create_counters()
-    for bug in read_bugs(output_dir, html_reports_available):
-        bug_counter(bug)
-    result = crash_count + bug_counter.total
-
-    if html_reports_available and result:
-        logging.debug('generate index.html file')
-        # common prefix for source files to have sort filenames
-        prefix = commonprefix_from(args.cdb) if use_cdb else os.getcwd()
-        # assemble the cover from multiple fragments
-        try:
+    bugs = read_bugs(output_dir, html_reports_available, jobs)
+    pages = []
+    try:
+        if html_reports_available:
+            # common prefix for source files to have sort filenames
+            prefix = commonprefix_from(args.cdb) if use_cdb else os.getcwd()
+            pages = bug_report(output_dir, prefix, bugs, bug_counter)
+        else:
+            for bug in bugs:
+                bug_counter(bug)
+        result = crash_count + bug_counter.total
+
+        if html_reports_available and result:
+            logging.debug('generate index.html file')
+            # assemble the cover from multiple fragments
             fragments = []
-            if bug_counter.total:
-                fragments.append(bug_summary(output_dir, bug_counter))
-                fragments.append(bug_report(output_dir, prefix))
-            if crash_count:
-                fragments.append(crash_report(output_dir, prefix))
-            assemble_cover(output_dir, prefix, args, fragments)
-            # copy additinal files to the report
-            copy_resource_files(output_dir)
-            if use_cdb:
-                shutil.copy(args.cdb, output_dir)
-        finally:
-            for fragment in fragments:
-                os.remove(fragment)
+            try:
+                if bug_counter.total:
+                    fragments.append(bug_summary(output_dir, bug_counter))
+                if crash_count:
+                    fragments.append(crash_report(output_dir, prefix))
+                assemble_pages(output_dir, prefix, args, fragments, pages)
+                # copy additinal files to the report
+                copy_resource_files(output_dir)
+                if use_cdb:
+                    shutil.copy(args.cdb, output_dir)
+            finally:
+                for fragment in fragments:
+                    os.remove(fragment)
+    finally:
+        for page in pages:
+            os.remove(page)
     return result
 
 
-def assemble_cover(output_dir, prefix, args, fragments):
+def page_name(index):
+    """ The name of the cover report page with the given index. """
+
+    return 'index.html' if index == 0 else 'index-{0}.html'.format(index + 1)
+
+
+def assemble_pages(output_dir, prefix, args, fragments, pages):
+    """ Put together the cover report pages.
+
+    The first page contains the summary, the first page of bugs and the
+    crashes. The other pages list the rest of the bugs. """
+
+    if len(pages) <= 1:
+        assemble_cover(output_dir, prefix, args,
+                       fragments[:1] + pages + fragments[1:])
+        return
+
+    summary = [fragment for fragment in fragments
+               if fragment.endswith('summary.html.fragment')]
+    others = [fragment for fragment in fragments if fragment not in summary]
+    for index, page in enumerate(pages):
+        navigation = page_navigation(output_dir, index, len(pages))
+        try:
+            content = [navigation, page]
+            if index == 0:
+                content = summary + content + others
+            assemble_cover(output_dir, prefix, args, content,
+                           page_name(index))
+        finally:
+            os.remove(navigation)
+
+
+def assemble_cover(output_dir, prefix, args, fragments, name='index.html'):
     """ Put together the fragments into a final report. """
 
     import getpass
@@ -106,7 +154,7 @@ def assemble_cover(output_dir, prefix, args, fragments):
     if args.html_title is None:
         args.html_title = os.path.basename(prefix) + ' - analyzer results'
 
-    with open(os.path.join(output_dir, 'index.html'), 'w') as handle:
+    with open(os.path.join(output_dir, name), 'w') as handle:
         indent = 0
         handle.write(reindent("""
         |<!DOCTYPE html>
@@ -196,16 +244,72 @@ def bug_summary(output_dir, bug_counter):
     return name
 
 
-def bug_report(output_dir, prefix):
-    """ Creates a fragment from the analyzer reports. """
-
-    pretty = prettify_bug(prefix, output_dir)
-    bugs = (pretty(bug) for bug in read_bugs(output_dir, True))
+def page_navigation(output_dir, current, count):
+    """ Creates a fragment with links to all pages of the cover report. """
 
-    name = os.path.join(output_dir, 'bugs.html.fragment')
+    name = os.path.join(output_dir, 'navigation.html.fragment')
     with open(name, 'w') as handle:
         indent = 4
+        links = []
+        for index in range(count):
+            label = '{0}-{1}'.format(index * BUGS_PER_PAGE + 1,
+                                     (index + 1) * BUGS_PER_PAGE)
+            if index == current:
+                links.append('<b>{0}</b>'.format(label))
+            else:
+                links.append('<a href="{0}">{1}</a>'.format(page_name(index),
+                                                            label))
         handle.write(reindent("""
+        |<p>Reports: {0}</p>""", indent).format(' | '.join(links)))
+    return name
+
+
+def bug_report(output_dir, prefix, bugs, bug_counter):
+    """ Creates fragments from the analyzer reports, one for each page of the
+    cover report, and returns their names.
+
+    Every bug is counted with 'bug_counter' and written right away, so none
+    of them is kept in memory. """
+
+    pretty = prettify_bug(prefix, output_dir)
+    names = []
+    handle = None
+    indent = 4
+    try:
+        for count, bug in enumerate(bugs):
+            bug_counter(bug)
+            if count % BUGS_PER_PAGE == 0:
+                if handle is not None:
+                    bug_report_end(handle, indent)
+                    handle.close()
+                name = os.path.join(output_dir, 'bugs-{0}.html.fragment'
+                                    .format(len(names)))
+                names.append(name)
+                handle = open(name, 'w')
+                bug_report_begin(handle, indent)
+            current = pretty(bug)
+            handle.write(reindent("""
+        |    <tr class="{bug_type_class}">
+        |      <td class="DESC">{bug_category}</td>
+        |      <td class="DESC">{bug_type}</td>
+        |      <td>{bug_file}</td>
+        |      <td class="DESC">{bug_function}</td>
+        |      <td class="Q">{bug_line}</td>
+        |      <td class="Q">{bug_path_length}</td>
+        |      <td><a href="{report_file}#EndPath">View Report</a></td>
+        |    </tr>""", indent).format(**current))
+            handle.write(comment('REPORTBUG', {'id': current['report_file']}))
+    finally:
+        if handle is not None:
+            bug_report_end(handle, indent)
+            handle.close()
+    return names
+
+
+def bug_report_begin(handle, indent):
+    """ Writes the head of a table of bugs. """
+
+    handle.write(reindent("""
         |<h2>Reports</h2>
         |<table class="sortable" style="table-layout:automatic">
         |  <thead>
@@ -223,24 +327,16 @@ def bug_report(output_dir, prefix):
         |    </tr>
         |  </thead>
         |  <tbody>""", indent))
-        handle.write(comment('REPORTBUGCOL'))
-        for current in bugs:
-            handle.write(reindent("""
-        |    <tr class="{bug_type_class}">
-        |      <td class="DESC">{bug_category}</td>
-        |      <td class="DESC">{bug_type}</td>
-        |      <td>{bug_file}</td>
-        |      <td class="DESC">{bug_function}</td>
-        |      <td class="Q">{bug_line}</td>
-        |      <td class="Q">{bug_path_length}</td>
-        |      <td><a href="{report_file}#EndPath">View Report</a></td>
-        |    </tr>""", indent).format(**current))
-            handle.write(comment('REPORTBUG', {'id': current['report_file']}))
-        handle.write(reindent("""
+    handle.write(comment('REPORTBUGCOL'))
+
+
+def bug_report_end(handle, indent):
+    """ Writes the tail of a table of bugs. """
+
+    handle.write(reindent("""
         |  </tbody>
         |</table>""", indent))
-        handle.write(comment('REPORTBUGEND'))
-    return name
+    handle.write(comment('REPORTBUGEND'))
 
 
 def crash_report(output_dir, prefix):
@@ -289,25 +385,66 @@ def read_crashes(output_dir):
                                                     '*.info.txt')))
 
 
-def read_bugs(output_dir, html):
+def read_bugs(output_dir, html, jobs=1):
     """ Generate a unique sequence of bugs from given output directory.
 
     Duplicates can be in a project if the same module was compiled multiple
     times with different compiler options. These would be better to show in
-    the final report (cover) only once. """
+    the final report (cover) only once.
+
+    The report files are parsed by 'jobs' worker processes (all processors
+    when None), and the bugs are generated as soon as their file is parsed.
+    Only the hashes of the bugs seen so far are kept to drop duplicates. """
 
-    parser = parse_bug_html if html else parse_bug_plist
+    parser = parse_bugs_html if html else parse_bugs_plist
     pattern = '*.html' if html else '*.plist'
 
-    duplicate = duplicate_check(
-        lambda bug: '{bug_line}.{bug_path_length}:{bug_file}'.format(**bug))
+    duplicate = duplicate_check(bug_hash)
+
+    filenames = glob.iglob(os.path.join(output_dir, pattern))
+    if jobs == 1:
+        results = (parser(filename) for filename in filenames)
+        pool = None
+    else:
+        pool = multiprocessing.Pool(jobs)
+        results = pool.imap(parser, filenames, chunksize=64)
+
+    try:
+        for bugs in results:
+            for bug in bugs:
+                if not duplicate(bug):
+                    yield bug
+    finally:
+        if pool is not None:
+            pool.terminate()
+            pool.join()
+
+
+def bug_hash(bug):
+    """ The identity of a bug, used to drop duplicates.
+
+    It is the issue hash computed by the analyzer when the report has one,
+    which is stable against changes to unrelated lines. """
+
+    if bug.get('bug_issue_hash'):
+        return '{bug_issue_hash}:{bug_type}:{bug_file}'.format(**bug)
+    return '{bug_line}.{bug_path_length}:{bug_file}'.format(**bug)
+
+
+def parse_bugs_plist(filename):
+    """ Returns the list of bugs from a single .plist file.
+
+    Unlike 'parse_bug_plist' this can be run in a worker process. """
+
+    return list(parse_bug_plist(filename))
+
+
+def parse_bugs_html(filename):
+    """ Returns the list of bugs from a single .html file.
 
-    bugs = itertools.chain.from_iterable(
-        # parser creates a bug generator not the bug itself
-        parser(filename)
-        for filename in glob.iglob(os.path.join(output_dir, pattern)))
+    Unlike 'parse_bug_html' this can be run in a worker process. """
 
-    return (bug for bug in bugs if not duplicate(bug))
+    return list(parse_bug_html(filename))
 
 
 def parse_bug_plist(filename):
@@ -326,7 +463,9 @@ def parse_bug_plist(filename):
             'bug_category': bug['category'],
             'bug_line': int(bug['location']['line']),
             'bug_path_length': int(bug['location']['col']),
-            'bug_file': files[int(bug['location']['file'])]
+            'bug_file': files[int(bug['location']['file'])],
+            'bug_issue_hash':
+                bug.get('issue_hash_content_of_line_in_context', '')
         }
 
 
@@ -339,7 +478,9 @@ def parse_bug_html(filename):
                 re.compile(r'<!-- BUGLINE (?P<bug_line>.*) -->$'),
                 re.compile(r'<!-- BUGCATEGORY (?P<bug_category>.*) -->$'),
                 re.compile(r'<!-- BUGDESC (?P<bug_description>.*) -->$'),
-                re.compile(r'<!-- FUNCTIONNAME (?P<bug_function>.*) -->$')]
+                re.compile(r'<!-- FUNCTIONNAME (?P<bug_function>.*) -->$'),
+                re.compile(r'<!-- ISSUEHASHCONTENTOFLINEINCONTEXT '
+                           r'(?P<bug_issue_hash>.*) -->$')]
     endsign = re.compile(r'<!-- BUGMETAEND -->')
 
     bug = {
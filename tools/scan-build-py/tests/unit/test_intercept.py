@@ -96,3 +96,69 @@ class InterceptUtilTest(unittest.TestCase):
             self.assertFalse(sut.is_preload_disabled('unix'))
         finally:
             os.environ['PATH'] = saved
+
+
+class CompilationDatabaseWriterTest(unittest.TestCase):
+
+    entries = [
+        {'directory': '/tmp', 'command': 'cc -c a.c', 'file': '/tmp/a.c'},
+        {'directory': '/tmp', 'command': 'cc -c b.c', 'file': '/tmp/b.c'}]
+
+    def write(self, entries, unique):
+        import json
+        with libear.TemporaryDirectory() as tmpdir:
+            filename = os.path.join(tmpdir, 'compile_commands.json')
+            with sut.CompilationDatabaseWriter(filename, unique) as output:
+                output.write_all(entries)
+            with open(filename, 'r') as handle:
+                content = handle.read()
+            self.assertEqual(json.loads(content), json.load(open(filename)))
+            return content
+
+    def test_same_as_json_dump(self):
+        import json
+        for entries in [[], self.entries[:1], self.entries]:
+            self.assertEqual(json.dumps(entries, sort_keys=True, indent=4),
+                             self.write(entries, None))
+
+    def test_drops_duplicates(self):
+        import json
+        content = self.write(self.entries + self.entries, sut.entry_hash)
+        self.assertEqual(self.entries, json.loads(content))
+
+
+class ExecTraceCollectorTest(unittest.TestCase):
+
+    @staticmethod
+    def trace(pid, command):
+        return sut.RS.join([pid, pid, 'execve', '/tmp',
+                            sut.US.join(command) + sut.US]) + sut.GS
+
+    def test_parse_drops_incomplete(self):
+        content = self.trace('1', ['cc', '-c', 'a.c']) + '2' + sut.RS + '2'
+        result = list(sut.parse_exec_content(content))
+        self.assertEqual(1, len(result))
+        self.assertEqual(['cc', '-c', 'a.c'], result[0]['command'])
+
+    def test_receives_traces(self):
+        received = []
+        with libear.TemporaryDirectory() as tmpdir:
+            collector = sut.ExecTraceCollector.start(
+                tmpdir, lambda content: received.extend(
+                    sut.parse_exec_content(content)))
+            if collector is None:
+                self.skipTest('no Unix domain sockets')
+            for pid in ['1', '2', '3']:
+                sut.report_exec(tmpdir, pid,
+                                self.trace(pid, ['cc', pid]).encode('utf-8'))
+            collector.stop()
+            self.assertEqual([], os.listdir(tmpdir))
+        self.assertEqual(['1', '2', '3'], [trace['pid'] for trace in received])
+
+    def test_falls_back_to_files(self):
+        with libear.TemporaryDirectory() as tmpdir:
+            sut.report_exec(tmpdir, '1',
+                            self.trace('1', ['cc']).encode('utf-8'))
+            result = list(sut.parse_exec_trace(os.path.join(tmpdir,
+                                                            '1.cmd')))
+            self.assertEqual(['cc'], result[0]['command'])
@@ -111,6 +111,71 @@ class ParseFileTest(unittest.TestCase):
             self.assertEqual(result['stderr'], pp_file + '.stderr.txt')
 
 
+class ReadBugsTest(unittest.TestCase):
+
+    @staticmethod
+    def write_report(directory, name, issue_hash, line):
+        with open(os.path.join(directory, name), 'w') as handle:
+            handle.writelines([
+                "<!-- BUGTYPE Division by zero -->\n",
+                "<!-- BUGCATEGORY Logic error -->\n",
+                "<!-- BUGFILE /src/a.c -->\n",
+                "<!-- ISSUEHASHCONTENTOFLINEINCONTEXT " + issue_hash +
+                " -->\n",
+                "<!-- BUGLINE " + str(line) + " -->\n",
+                "<!-- BUGPATHLENGTH 4 -->\n",
+                "<!-- BUGMETAEND -->\n"])
+
+    def read_bugs(self, jobs):
+        with libear.TemporaryDirectory() as tmpdir:
+            self.write_report(tmpdir, 'report-1.html', 'abc', 5)
+            self.write_report(tmpdir, 'report-2.html', 'abc', 6)
+            self.write_report(tmpdir, 'report-3.html', 'def', 5)
+            return list(sut.read_bugs(tmpdir, True, jobs))
+
+    def test_duplicates_by_issue_hash(self):
+        bugs = self.read_bugs(1)
+        self.assertEqual(2, len(bugs))
+        self.assertEqual({'abc', 'def'},
+                         set(bug['bug_issue_hash'] for bug in bugs))
+
+    def test_parallel(self):
+        self.assertEqual(2, len(self.read_bugs(2)))
+
+    def test_hash_without_issue_hash(self):
+        bug = {'bug_line': 3, 'bug_path_length': 2, 'bug_file': 'a.c'}
+        self.assertEqual('3.2:a.c', sut.bug_hash(bug))
+
+
+class BugReportTest(unittest.TestCase):
+
+    def test_pages(self):
+        bug = {
+            'bug_category': 'Logic error',
+            'bug_type': 'Division by zero',
+            'bug_function': 'f',
+            'bug_line': 1,
+            'bug_path_length': 1
+        }
+        saved = sut.BUGS_PER_PAGE
+        sut.BUGS_PER_PAGE = 2
+        try:
+            with libear.TemporaryDirectory() as tmpdir:
+                bugs = (dict(bug, bug_file=os.path.join(tmpdir, 'a.c'),
+                             report_file=os.path.join(tmpdir, str(index)))
+                        for index in range(5))
+                counter = sut.create_counters()
+                pages = sut.bug_report(tmpdir, tmpdir, bugs, counter)
+                self.assertEqual(3, len(pages))
+                self.assertEqual(5, counter.total)
+                with open(pages[2], 'r') as handle:
+                    content = handle.read()
+                self.assertEqual(1, content.count('<!-- REPORTBUG '))
+                self.assertIn('<!-- REPORTBUGEND -->', content)
+        finally:
+            sut.BUGS_PER_PAGE = saved
+
+
 class ReportMethodTest(unittest.TestCase):
 
     def test_chop(self):
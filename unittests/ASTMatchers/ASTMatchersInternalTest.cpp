@@ -171,6 +171,73 @@ TEST(MatchFinder, InterceptsEndOfTranslationUnit) {
   EXPECT_TRUE(VerifyCallback.Called);
 }
 
+class CollectNames : public MatchFinder::MatchCallback {
+public:
+  void run(const MatchFinder::MatchResult &Result) override {
+    Names.push_back(Result.Nodes.getNodeAs<NamedDecl>("d")->getName());
+  }
+  std::vector<std::string> Names;
+};
+
+TEST(MatchFinder, MatchesInParallelInSourceOrder) {
+  std::unique_ptr<ASTUnit> AST(tooling::buildASTFromCode(
+      "class Base {}; typedef Base Alias;"
+      "void f() { int a; int b; }"
+      "namespace n { void g() { int c; } class D : public Alias {}; }"
+      "void h() { { int d; } int e; }"));
+  ASSERT_TRUE(AST.get());
+
+  auto Matcher =
+      namedDecl(anyOf(varDecl(hasAncestor(functionDecl())),
+                      cxxRecordDecl(isDerivedFrom("Alias"), isDefinition())))
+          .bind("d");
+  CollectNames Sequential;
+  MatchFinder SequentialFinder;
+  SequentialFinder.addMatcher(Matcher, &Sequential);
+  SequentialFinder.matchAST(AST->getASTContext());
+
+  MatchFinder::MatchFinderOptions Options;
+  Options.NumThreads = 4;
+  CollectNames Parallel;
+  MatchFinder ParallelFinder(std::move(Options));
+  ParallelFinder.addMatcher(Matcher, &Parallel);
+  ParallelFinder.matchAST(AST->getASTContext());
+
+  std::vector<std::string> Expected = {"a", "b", "c", "D", "d", "e"};
+  EXPECT_EQ(Expected, Sequential.Names);
+  EXPECT_EQ(Expected, Parallel.Names);
+}
+
+TEST(MatchFinder, MatchesNamespaceScopeDeclsWithoutTraversingStatements) {
+  std::unique_ptr<ASTUnit> AST(tooling::buildASTFromCode(
+      "namespace a { void f() { int x; } namespace b {} }"
+      "template <typename T> struct S { void g() { int y; } };"
+      "void h() { struct Local {}; int z; }"));
+  ASSERT_TRUE(AST.get());
+
+  // None of these matchers can match a node within a statement, but their
+  // inner matchers still look into the statements.
+  CollectNames Collect;
+  MatchFinder Finder;
+  Finder.addMatcher(namespaceDecl().bind("d"), &Collect);
+  Finder.addMatcher(
+      classTemplateDecl(forEachDescendant(varDecl().bind("d"))), &Collect);
+  Finder.matchAST(AST->getASTContext());
+  std::vector<std::string> Expected = {"a", "b", "y"};
+  EXPECT_EQ(Expected, Collect.Names);
+
+  // Records can be declared within functions.
+  CollectNames CollectRecords;
+  MatchFinder RecordFinder;
+  RecordFinder.addMatcher(namespaceDecl().bind("d"), &CollectRecords);
+  RecordFinder.addMatcher(
+      cxxRecordDecl(hasName("Local"), isDefinition()).bind("d"),
+      &CollectRecords);
+  RecordFinder.matchAST(AST->getASTContext());
+  std::vector<std::string> ExpectedRecords = {"a", "b", "Local"};
+  EXPECT_EQ(ExpectedRecords, CollectRecords.Names);
+}
+
 TEST(Matcher, matchOverEntireASTContext) {
   std::unique_ptr<ASTUnit> AST =
       clang::tooling::buildASTFromCode("struct { int *foo; };");
@@ -213,6 +213,34 @@ TEST(ParserTest, FullParserTest) {
             Error.toStringFull());
 }
 
+TEST(ParserTest, CachingRegistrySemaSharesMatchers) {
+  Parser::CachingRegistrySema S;
+  Diagnostics Error;
+  llvm::Optional<DynTypedMatcher> First(Parser::parseMatcherExpression(
+      "varDecl(hasAncestor(functionDecl(hasName(\"f\"))))", &S, &Error));
+  llvm::Optional<DynTypedMatcher> Second(Parser::parseMatcherExpression(
+      "varDecl(hasAncestor(functionDecl(hasName(\"f\"))))", &S, &Error));
+  llvm::Optional<DynTypedMatcher> Other(Parser::parseMatcherExpression(
+      "varDecl(hasAncestor(functionDecl(hasName(\"g\"))))", &S, &Error));
+  EXPECT_EQ("", Error.toStringFull());
+  ASSERT_TRUE(First.hasValue() && Second.hasValue() && Other.hasValue());
+  EXPECT_EQ(First->getID(), Second->getID());
+  EXPECT_NE(First->getID(), Other->getID());
+
+  Matcher<Decl> M = Second->unconditionalConvertTo<Decl>();
+  EXPECT_TRUE(matches("void f() { int x; }", M));
+  EXPECT_FALSE(matches("void g() { int x; }", M));
+
+  // Errors are not cached.
+  EXPECT_FALSE(Parser::parseMatcherExpression("hasLHS(\"A\")", &S, &Error)
+                   .hasValue());
+  Diagnostics SecondError;
+  EXPECT_FALSE(
+      Parser::parseMatcherExpression("hasLHS(\"A\")", &S, &SecondError)
+          .hasValue());
+  EXPECT_EQ(Error.toStringFull(), SecondError.toStringFull());
+}
+
 std::string ParseWithError(StringRef Code) {
   Diagnostics Error;
   VariantValue Value;
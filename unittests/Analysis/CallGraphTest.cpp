@@ -0,0 +1,92 @@
+//===- unittests/Analysis/CallGraphTest.cpp - CallGraph tests -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/ASTContext.h"
+#include "clang/Analysis/CallGraph.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace analysis {
+namespace {
+
+const char *Code = "void leaf1() {}\n"
+                   "void leaf2() {}\n"
+                   "void ping(int n);\n"
+                   "void pong(int n) { leaf1(); ping(n - 1); }\n"
+                   "void ping(int n) { if (n) pong(n); }\n"
+                   "void mid() { leaf1(); leaf2(); }\n"
+                   "void top() { mid(); ping(3); }\n";
+
+std::string getGraphDump(const CallGraph &CG) {
+  std::string Dump;
+  llvm::raw_string_ostream OS(Dump);
+  CG.print(OS);
+  return OS.str();
+}
+
+std::string getName(const CallGraphNode *N) {
+  std::string Name;
+  llvm::raw_string_ostream OS(Name);
+  N->print(OS);
+  return OS.str();
+}
+
+TEST(CallGraph, ParallelConstructionMatchesSerial) {
+  std::unique_ptr<ASTUnit> AST(tooling::buildASTFromCode(Code));
+  Decl *TU = AST->getASTContext().getTranslationUnitDecl();
+
+  CallGraph Serial;
+  Serial.addToCallGraph(TU);
+
+  for (unsigned NumThreads : {1u, 4u}) {
+    CallGraph Parallel;
+    Parallel.addToCallGraph(TU, NumThreads);
+    EXPECT_EQ(Serial.size(), Parallel.size());
+    EXPECT_EQ(getGraphDump(Serial), getGraphDump(Parallel));
+  }
+}
+
+TEST(CallGraph, SCCSchedulerHandsOutCalleesFirst) {
+  std::unique_ptr<ASTUnit> AST(tooling::buildASTFromCode(Code));
+  CallGraph CG;
+  CG.addToCallGraph(AST->getASTContext().getTranslationUnitDecl());
+
+  CallGraphSCCScheduler Scheduler(CG);
+  // ping and pong call each other, so they form a single component.
+  EXPECT_EQ(5u, Scheduler.getNumSCCs());
+
+  std::vector<std::vector<std::string>> Batches;
+  while (!Scheduler.isFinished()) {
+    SmallVector<unsigned, 8> Batch;
+    Scheduler.takeReadyBatch(Batch);
+    ASSERT_FALSE(Batch.empty());
+    Batches.emplace_back();
+    for (unsigned Index : Batch)
+      for (const CallGraphNode *N : Scheduler.getSCC(Index))
+        Batches.back().push_back(getName(N));
+    std::sort(Batches.back().begin(), Batches.back().end());
+    for (unsigned Index : Batch)
+      Scheduler.markCompleted(Index);
+  }
+
+  ASSERT_EQ(3u, Batches.size());
+  EXPECT_EQ((std::vector<std::string>{"leaf1", "leaf2"}), Batches[0]);
+  EXPECT_EQ((std::vector<std::string>{"mid", "ping", "pong"}), Batches[1]);
+  EXPECT_EQ((std::vector<std::string>{"top"}), Batches[2]);
+}
+
+} // namespace
+} // namespace analysis
+} // namespace clang
@@ -69,4 +69,30 @@ TEST(DiagnosticTest, fatalsAsErrors) {
   EXPECT_TRUE(Diags.hasUnrecoverableErrorOccurred());
 }
 
+// Check that the cache of diagnostics ignored everywhere follows changes to
+// the mappings and the flags that affect them.
+TEST(DiagnosticTest, ignoredEverywhere) {
+  DiagnosticsEngine Diags(new DiagnosticIDs(),
+                          new DiagnosticOptions,
+                          new IgnoringDiagConsumer());
+  unsigned DiagID = diag::warn_method_param_declaration;
+  EXPECT_TRUE(Diags.isIgnored(DiagID, SourceLocation()));
+
+  Diags.setEnableAllWarnings(true);
+  EXPECT_FALSE(Diags.isIgnored(DiagID, SourceLocation()));
+  Diags.setEnableAllWarnings(false);
+  EXPECT_TRUE(Diags.isIgnored(DiagID, SourceLocation()));
+
+  Diags.setSeverity(DiagID, diag::Severity::Warning, SourceLocation());
+  EXPECT_FALSE(Diags.isIgnored(DiagID, SourceLocation()));
+
+  Diags.setIgnoreAllWarnings(true);
+  EXPECT_TRUE(Diags.isIgnored(DiagID, SourceLocation()));
+  Diags.setIgnoreAllWarnings(false);
+  EXPECT_FALSE(Diags.isIgnored(DiagID, SourceLocation()));
+
+  Diags.Reset();
+  EXPECT_TRUE(Diags.isIgnored(DiagID, SourceLocation()));
+}
+
 }
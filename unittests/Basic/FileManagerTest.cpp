@@ -10,6 +10,7 @@
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/FileSystemOptions.h"
 #include "clang/Basic/FileSystemStatCache.h"
+#include "clang/Basic/VirtualFileSystem.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Config/llvm-config.h"
 #include "gtest/gtest.h"
@@ -246,6 +247,74 @@ TEST_F(FileManagerTest, addRemoveStatCache) {
   manager.removeStatCache(statCache);
 }
 
+// A SharedStatCacheStorage answers lookups of all file managers using it.
+TEST_F(FileManagerTest, sharedStatCacheIsSharedBetweenFileManagers) {
+  IntrusiveRefCntPtr<SharedStatCacheStorage> Storage(
+      new SharedStatCacheStorage);
+
+  auto statCache = llvm::make_unique<FakeStatCache>();
+  statCache->InjectDirectory("/tmp", 42);
+  statCache->InjectFile("/tmp/test", 43);
+  auto sharedCache = llvm::make_unique<SharedStatCache>(Storage);
+  sharedCache->setNextStatCache(std::move(statCache));
+  manager.addStatCache(std::move(sharedCache));
+
+  ASSERT_TRUE(manager.getFile("/tmp/test") != nullptr);
+  EXPECT_EQ(2u, Storage->size());
+
+  // The second file manager has no fake file system behind its cache, so the
+  // file can only be found through the shared storage.
+  FileManager otherManager(options);
+  otherManager.addStatCache(llvm::make_unique<SharedStatCache>(Storage));
+  const FileEntry *file = otherManager.getFile("/tmp/test");
+  ASSERT_TRUE(file != nullptr);
+  EXPECT_EQ(43u, file->getUniqueID().getFile());
+  EXPECT_EQ(2u, Storage->size());
+}
+
+// Failed lookups are only shared if requested.
+TEST_F(FileManagerTest, sharedStatCacheRecordsMissingFilesOnRequest) {
+  IntrusiveRefCntPtr<SharedStatCacheStorage> Storage(
+      new SharedStatCacheStorage(/*CacheMissingFiles=*/true));
+
+  auto statCache = llvm::make_unique<FakeStatCache>();
+  statCache->InjectDirectory("/tmp", 42);
+  auto sharedCache = llvm::make_unique<SharedStatCache>(Storage);
+  sharedCache->setNextStatCache(std::move(statCache));
+  manager.addStatCache(std::move(sharedCache));
+
+  EXPECT_EQ(nullptr, manager.getFile("/tmp/missing"));
+
+  bool KnownMissing;
+  EXPECT_EQ(nullptr, Storage->lookup("/tmp/missing", /*isFile=*/true,
+                                     KnownMissing));
+  EXPECT_TRUE(KnownMissing);
+  EXPECT_EQ(nullptr, Storage->lookup("/tmp/missing", /*isFile=*/false,
+                                     KnownMissing));
+  EXPECT_FALSE(KnownMissing);
+  EXPECT_NE(nullptr, Storage->lookup("/tmp", /*isFile=*/false, KnownMissing));
+}
+
+// A PrefetchedStatCache answers lookups of the paths it was given without
+// going to the file system again.
+TEST_F(FileManagerTest, prefetchedStatCacheAnswersPrefetchedPaths) {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> FS(new vfs::InMemoryFileSystem);
+  FS->addFile("/tmp/test", 0, llvm::MemoryBuffer::getMemBuffer("int x;"));
+
+  std::vector<std::string> Paths;
+  Paths.push_back("/tmp");
+  Paths.push_back("/tmp/test");
+  Paths.push_back("/tmp/missing");
+  manager.addStatCache(
+      llvm::make_unique<PrefetchedStatCache>(Paths, *FS, /*NumThreads=*/2));
+
+  // The manager uses the real file system, where these paths don't exist.
+  const FileEntry *file = manager.getFile("/tmp/test");
+  ASSERT_TRUE(file != nullptr);
+  EXPECT_EQ(6, file->getSize());
+  EXPECT_EQ(nullptr, manager.getFile("/tmp/missing"));
+}
+
 #endif  // !LLVM_ON_WIN32
 
 } // anonymous namespace
@@ -0,0 +1,55 @@
+//===- unittests/Basic/IdentifierTableTest.cpp -- IdentifierTable tests ---===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/IdentifierTable.h"
+#include "clang/Basic/LangOptions.h"
+#include "gtest/gtest.h"
+
+using namespace clang;
+
+namespace {
+
+TEST(IdentifierTableTest, keywordIndex) {
+  const IdentifierTable::KeywordIndex &Index =
+      IdentifierTable::KeywordIndex::get();
+  EXPECT_GE(Index.find("int"), 0);
+  EXPECT_GE(Index.find("__is_trivially_copyable"), 0);
+  EXPECT_GE(Index.find("__alignof"), 0);
+  EXPECT_GE(Index.find("bitand"), 0);
+  EXPECT_GE(Index.find("interface"), 0);
+  EXPECT_EQ(-1, Index.find(""));
+  EXPECT_EQ(-1, Index.find("in"));
+  EXPECT_EQ(-1, Index.find("integer"));
+  EXPECT_EQ("int", Index.getName(Index.find("int")));
+}
+
+TEST(IdentifierTableTest, keywordsResolveOnce) {
+  LangOptions LangOpts;
+  LangOpts.CPlusPlus = true;
+  LangOpts.CXXOperatorNames = true;
+  IdentifierTable Table(LangOpts);
+
+  IdentifierInfo &Class = Table.get("class");
+  EXPECT_EQ(tok::kw_class, Class.getTokenID());
+  EXPECT_EQ(&Class, &Table.get("class"));
+  EXPECT_EQ(&Class, &Table.getOwn("class"));
+  EXPECT_EQ(tok::ampamp, Table.get("and").getTokenID());
+
+  // Keywords of other languages are ordinary identifiers.
+  IdentifierInfo &Restrict = Table.get("restrict");
+  EXPECT_EQ(tok::identifier, Restrict.getTokenID());
+  EXPECT_EQ(&Restrict, &Table.get("restrict"));
+
+  IdentifierInfo &Foo = Table.get("foo");
+  EXPECT_EQ(tok::identifier, Foo.getTokenID());
+  EXPECT_EQ(&Foo, &Table.get("foo"));
+  EXPECT_EQ("foo", Foo.getName());
+}
+
+} // end anonymous namespace
@@ -171,6 +171,86 @@ TEST_F(SourceManagerTest, getColumnNumber) {
   EXPECT_EQ(1U, SourceMgr.getColumnNumber(MainFileID, 0, nullptr));
 }
 
+TEST_F(SourceManagerTest, getLineNumber) {
+  // Mix every kind of newline, at every alignment, with lines both shorter
+  // and longer than a vector chunk, and with embedded null characters.
+  std::string Source;
+  std::vector<unsigned> LineStarts(1, 0);
+  const char *Newlines[] = { "\n", "\r", "\r\n", "\n\r", "\n\n", "\r\r" };
+  for (unsigned I = 0; I != 200; ++I) {
+    Source.append(1 + I % 37, I % 11 ? 'a' + I % 26 : '\0');
+    const char *NL = Newlines[I % 6];
+    Source += NL;
+    // "\n\n" and "\r\r" are two newlines, the other pairs are one.
+    if (NL[1] && NL[0] == NL[1])
+      LineStarts.push_back(Source.size() - 1);
+    LineStarts.push_back(Source.size());
+  }
+  Source += "no newline at the end";
+
+  FileID MainFileID = SourceMgr.createFileID(
+      llvm::MemoryBuffer::getMemBufferCopy(Source));
+  SourceMgr.setMainFileID(MainFileID);
+
+  for (unsigned Line = 0, E = LineStarts.size(); Line != E; ++Line) {
+    unsigned LineEnd =
+        Line + 1 == E ? Source.size() + 1 : LineStarts[Line + 1];
+    for (unsigned Offset = LineStarts[Line]; Offset != LineEnd; ++Offset) {
+      bool Invalid = false;
+      EXPECT_EQ(Line + 1,
+                SourceMgr.getLineNumber(MainFileID, Offset, &Invalid))
+          << "at offset " << Offset;
+      EXPECT_FALSE(Invalid);
+    }
+  }
+}
+
+TEST_F(SourceManagerTest, getFileIDAcrossManyFiles) {
+  // Create more files than the FileID lookup caches hold, and bounce between
+  // them in patterns that hit and miss those caches.
+  const unsigned NumFiles = 8;
+  FileID FIDs[NumFiles];
+  for (unsigned I = 0; I != NumFiles; ++I)
+    FIDs[I] = SourceMgr.createFileID(
+        llvm::MemoryBuffer::getMemBuffer("int x;\nint y;\n"));
+
+  for (unsigned Stride : {1, 2, 3, 5, 7}) {
+    for (unsigned N = 0; N != 4 * NumFiles; ++N) {
+      unsigned I = (N * Stride) % NumFiles;
+      unsigned Offset = N % 14;
+      SourceLocation Loc =
+          SourceMgr.getLocForStartOfFile(FIDs[I]).getLocWithOffset(Offset);
+      EXPECT_EQ(FIDs[I], SourceMgr.getFileID(Loc));
+      EXPECT_EQ(std::make_pair(FIDs[I], Offset),
+                SourceMgr.getDecomposedLoc(Loc));
+    }
+  }
+}
+
+TEST_F(SourceManagerTest, getDecomposedLocs) {
+  const unsigned NumFiles = 3;
+  FileID FIDs[NumFiles];
+  for (unsigned I = 0; I != NumFiles; ++I)
+    FIDs[I] = SourceMgr.createFileID(
+        llvm::MemoryBuffer::getMemBuffer("int x;\nint y;\n"));
+
+  // A sorted run of locations, followed by some out of order ones.
+  std::vector<SourceLocation> Locs;
+  for (unsigned I = 0; I != NumFiles; ++I)
+    for (unsigned Offset = 0; Offset <= 14; Offset += 7)
+      Locs.push_back(
+          SourceMgr.getLocForStartOfFile(FIDs[I]).getLocWithOffset(Offset));
+  Locs.push_back(SourceMgr.getLocForStartOfFile(FIDs[1]));
+  Locs.push_back(SourceMgr.getLocForStartOfFile(FIDs[0]).getLocWithOffset(3));
+  Locs.push_back(SourceMgr.getLocForStartOfFile(FIDs[2]).getLocWithOffset(9));
+
+  SmallVector<std::pair<FileID, unsigned>, 16> Decomposed;
+  SourceMgr.getDecomposedLocs(Locs, Decomposed);
+  ASSERT_EQ(Locs.size(), Decomposed.size());
+  for (unsigned I = 0, N = Locs.size(); I != N; ++I)
+    EXPECT_EQ(SourceMgr.getDecomposedLoc(Locs[I]), Decomposed[I]);
+}
+
 #if defined(LLVM_ON_UNIX)
 
 TEST_F(SourceManagerTest, getMacroArgExpandedLocation) {
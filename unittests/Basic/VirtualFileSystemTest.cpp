@@ -829,6 +829,46 @@ TEST_F(VFSFromYAMLTest, CaseSensitive) {
   EXPECT_EQ(0, NumDiagnostics);
 }
 
+TEST_F(VFSFromYAMLTest, ManyEntriesInDirectory) {
+  IntrusiveRefCntPtr<DummyFileSystem> Lower(new DummyFileSystem());
+  Lower->addRegularFile("//root/foo/bar/a");
+  std::string Contents;
+  for (unsigned I = 0; I != 32; ++I) {
+    if (I)
+      Contents += ",\n";
+    Contents += "{ 'type': 'file', 'name': 'File" + std::to_string(I) +
+                "', 'external-contents': '//root/foo/bar/a' }";
+  }
+  // A second mapping with the same name doesn't replace the first one.
+  Contents += ",\n{ 'type': 'file', 'name': 'file0',"
+              " 'external-contents': '//root/foo/bar/b' }";
+  IntrusiveRefCntPtr<vfs::FileSystem> FS =
+      getFromYAMLString("{ 'case-sensitive': 'false',\n"
+                        "  'roots': [\n"
+                        "{\n"
+                        "  'type': 'directory',\n"
+                        "  'name': '//root/',\n"
+                        "  'contents': [ " + Contents + " ]\n"
+                        "}]}",
+                        Lower);
+  ASSERT_TRUE(FS.get() != nullptr);
+
+  for (unsigned I = 0; I != 32; ++I) {
+    std::string Name = "//root/File" + std::to_string(I);
+    ErrorOr<vfs::Status> S = FS->status(Name);
+    ASSERT_FALSE(S.getError()) << Name;
+    EXPECT_EQ("//root/foo/bar/a", S->getName());
+  }
+  ErrorOr<vfs::Status> S = FS->status("//root/FILE0");
+  ASSERT_FALSE(S.getError());
+  EXPECT_EQ("//root/foo/bar/a", S->getName());
+  EXPECT_EQ(FS->status("//root/File32").getError(),
+            llvm::errc::no_such_file_or_directory);
+  EXPECT_EQ(FS->status("//root/File0/x").getError(),
+            llvm::errc::not_a_directory);
+  EXPECT_EQ(0, NumDiagnostics);
+}
+
 TEST_F(VFSFromYAMLTest, IllegalVFSFile) {
   IntrusiveRefCntPtr<DummyFileSystem> Lower(new DummyFileSystem());
 
@@ -7919,6 +7919,23 @@ TEST_F(FormatTest, ObjCArrayLiterals) {
                "]];");
 }
 
+TEST_F(FormatTest, ReusesLineBreaksForLinesOfSameShape) {
+  FormatStyle Style = getLLVMStyleWithColumns(40);
+  verifyFormat("f(\"aaaaaaaaaaaaaaaaaaaa\",\n"
+               "  \"bbbbbbbbbbbbbbbbbbbb\");\n"
+               "f(\"cccccccccccccccccccc\",\n"
+               "  \"dddddddddddddddddddd\");",
+               Style);
+
+  // Lines of the same shape whose formatting depends on the text of their
+  // string literals.
+  Style = getLLVMStyleWithColumns(20);
+  std::string First = "f(\"aaaa bbbb cccc dddddd\");";
+  std::string Second = "f(\"aaaaaaaaaaaa bbbbbbb\");";
+  EXPECT_EQ(format(First, Style) + "\n" + format(Second, Style),
+            format(First + "\n" + Second, Style));
+}
+
 TEST_F(FormatTest, BreaksStringLiterals) {
   EXPECT_EQ("\"some text \"\n"
             "\"other\";",
@@ -10210,6 +10227,7 @@ TEST_F(FormatTest, ParsesConfiguration) {
   CHECK_PARSE("ObjCBlockIndentWidth: 1234", ObjCBlockIndentWidth, 1234u);
   CHECK_PARSE("ColumnLimit: 1234", ColumnLimit, 1234u);
   CHECK_PARSE("MaxEmptyLinesToKeep: 1234", MaxEmptyLinesToKeep, 1234u);
+  CHECK_PARSE("MaxLineFormattingStates: 1234", MaxLineFormattingStates, 1234u);
   CHECK_PARSE("PenaltyBreakBeforeFirstCallParameter: 1234",
               PenaltyBreakBeforeFirstCallParameter, 1234u);
   CHECK_PARSE("PenaltyExcessCharacter: 1234", PenaltyExcessCharacter, 1234u);
@@ -10,6 +10,7 @@
 #include "FormatTestUtils.h"
 #include "clang/Format/Format.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
 #define DEBUG_TYPE "format-test"
@@ -524,6 +525,84 @@ TEST_F(FormatTestSelective, SelectivelyRequoteJavaScript) {
              20, 0));
 }
 
+TEST_F(FormatTestSelective, FormattingSessionReformatsEditedPiece) {
+  std::string Code = "int  a;\n"
+                     "\n"
+                     "void f() {\n"
+                     "  int x;\n"
+                     "}\n"
+                     "\n"
+                     "int  b;";
+  FormattingSession Session(Style, Code);
+
+  // Insert a statement into f() and format the edited line only.
+  unsigned Offset = Code.find("int x;") + 6;
+  Session.applyEdit(Offset, 0, "\nint  y;");
+  tooling::Replacements Replaces =
+      Session.reformat(tooling::Range(Offset + 1, 7));
+  EXPECT_EQ("int  a;\n"
+            "\n"
+            "void f() {\n"
+            "  int x;\n"
+            "  int y;\n"
+            "}\n"
+            "\n"
+            "int  b;",
+            Session.getCode());
+  for (const tooling::Replacement &Replace : Replaces)
+    EXPECT_LT(Code.find("void f"), Replace.getOffset());
+
+  // Opening a block comment damages everything after it.
+  Offset = Session.getCode().find("int y;");
+  Session.applyEdit(Offset, 0, "/* ");
+  Session.reformat(tooling::Range(Offset, 0));
+  Session.applyEdit(Session.getCode().size(), 0, " */");
+  std::string Edited = Session.getCode();
+  Session.reformat(tooling::Range(0, Edited.size()));
+  EXPECT_EQ(format(Edited, 0, Edited.size()), Session.getCode());
+}
+
+TEST_F(FormatTestSelective, ReformatInChunksMatchesReformat) {
+  std::string Code = "#include \"b.h\"\n"
+                     "#include \"a.h\"\n"
+                     "\n"
+                     "int  a;\n"
+                     "\n\n\n\n"
+                     "void f() {\n"
+                     "\n"
+                     "int x;\n"
+                     "}\n"
+                     "\n"
+                     "namespace n {\n"
+                     "\n"
+                     "int  b;\n"
+                     "}\n"
+                     "\n"
+                     "int  c;";
+  std::string Expected = "#include \"a.h\"\n"
+                         "#include \"b.h\"\n"
+                         "\n"
+                         "int a;\n"
+                         "\n"
+                         "void f() {\n"
+                         "\n"
+                         "  int x;\n"
+                         "}\n"
+                         "\n"
+                         "namespace n {\n"
+                         "\n"
+                         "int b;\n"
+                         "}\n"
+                         "\n"
+                         "int c;";
+  for (unsigned ChunkSize : {1u, 8u, 32u, 1u << 20}) {
+    std::string Result;
+    llvm::raw_string_ostream OS(Result);
+    reformatInChunks(Style, Code, OS, "<stdin>", nullptr, ChunkSize);
+    EXPECT_EQ(Expected, OS.str()) << "ChunkSize: " << ChunkSize;
+  }
+}
+
 } // end namespace
 } // end namespace format
 } // end namespace clang
@@ -273,6 +273,18 @@ TEST_F(SortIncludesTest, NegativePriorities) {
                  "c_main.cc"));
 }
 
+TEST_F(SortIncludesTest, CategoryRegexsWithQuantifiersAndAlternatives) {
+  Style.IncludeCategories = {{"^\"a+b?c", 1}, {"^<x|y", 2}, {".*", 3}};
+  EXPECT_EQ("#include \"aac.h\"\n"
+            "#include \"ac.h\"\n"
+            "#include \"y.h\"\n"
+            "#include \"z.h\"\n",
+            sort("#include \"z.h\"\n"
+                 "#include \"y.h\"\n"
+                 "#include \"ac.h\"\n"
+                 "#include \"aac.h\"\n"));
+}
+
 TEST_F(SortIncludesTest, CalculatesCorrectCursorPosition) {
   std::string Code = "#include <ccc>\n"    // Start of line: 0
                      "#include <bbbbbb>\n" // Start of line: 15
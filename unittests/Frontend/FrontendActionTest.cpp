@@ -191,4 +191,50 @@ TEST(PreprocessorFrontendAction, EndSourceFile) {
   ASSERT_TRUE(TestAction.SeenEnd);
 }
 
+class PredefinesFrontendAction : public PreprocessorFrontendAction {
+public:
+  std::string Predefines;
+
+  void ExecuteAction() override {
+    Predefines = getCompilerInstance().getPreprocessor().getPredefines();
+  }
+};
+
+static std::string getPredefines(bool Optimize, bool CPlusPlus) {
+  CompilerInvocation *Invocation = new CompilerInvocation;
+  Invocation->getPreprocessorOpts().addRemappedFile(
+      "test.cc", MemoryBuffer::getMemBuffer("").release());
+  Invocation->getPreprocessorOpts().addMacroDef("FROM_COMMAND_LINE");
+  Invocation->getFrontendOpts().Inputs.push_back(
+      FrontendInputFile("test.cc", CPlusPlus ? IK_CXX : IK_C));
+  Invocation->getFrontendOpts().ProgramAction = frontend::ParseSyntaxOnly;
+  Invocation->getTargetOpts().Triple = "i386-unknown-linux-gnu";
+  Invocation->getLangOpts()->CPlusPlus = CPlusPlus;
+  Invocation->getLangOpts()->Optimize = Optimize;
+  CompilerInstance Compiler;
+  Compiler.setInvocation(Invocation);
+  Compiler.createDiagnostics();
+
+  PredefinesFrontendAction Action;
+  EXPECT_TRUE(Compiler.ExecuteAction(Action));
+  return Action.Predefines;
+}
+
+TEST(PreprocessorFrontendAction, CachedPredefines) {
+  std::string First = getPredefines(/*Optimize=*/false, /*CPlusPlus=*/true);
+  EXPECT_EQ(std::string::npos, First.find("__OPTIMIZE__"));
+  EXPECT_NE(std::string::npos, First.find("__cplusplus"));
+  EXPECT_NE(std::string::npos, First.find("FROM_COMMAND_LINE"));
+
+  // The same configuration reuses the builtin predefines.
+  EXPECT_EQ(First, getPredefines(/*Optimize=*/false, /*CPlusPlus=*/true));
+
+  // Any change to the language options produces different ones.
+  std::string Optimized = getPredefines(/*Optimize=*/true, /*CPlusPlus=*/true);
+  EXPECT_NE(std::string::npos, Optimized.find("__OPTIMIZE__"));
+  EXPECT_NE(std::string::npos, Optimized.find("FROM_COMMAND_LINE"));
+  std::string C = getPredefines(/*Optimize=*/false, /*CPlusPlus=*/false);
+  EXPECT_EQ(std::string::npos, C.find("__cplusplus"));
+}
+
 } // anonymous namespace
@@ -12,6 +12,7 @@
 #include "clang/Lex/HeaderMapTypes.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/SwapByteOrder.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 #include <cassert>
 #include <type_traits>
@@ -255,4 +256,49 @@ TEST(HeaderMapTest, lookupFilenameTruncatedPrefix) {
   ASSERT_EQ("", Map.lookupFilename("a", DestPath));
 }
 
+TEST(HeaderMapTest, writeAndLookupFilename) {
+  HeaderMapWriter Writer;
+  ASSERT_TRUE(Writer.insert("a.h", "/inc/a.h"));
+  ASSERT_TRUE(Writer.insert("sub/b.h", "/inc/sub/b.h"));
+  ASSERT_TRUE(Writer.insert("c.h", "/other/c.h"));
+  // The first mapping of a key wins, regardless of case.
+  ASSERT_FALSE(Writer.insert("A.h", "/other/a.h"));
+  ASSERT_EQ(3u, Writer.size());
+
+  std::string Contents;
+  {
+    raw_string_ostream OS(Contents);
+    Writer.write(OS);
+  }
+  auto Buffer = MemoryBuffer::getMemBuffer(Contents, "header",
+                                           /* RequresNullTerminator */ false);
+  bool NeedsSwap;
+  ASSERT_TRUE(HeaderMapImpl::checkHeader(*Buffer, NeedsSwap));
+  ASSERT_FALSE(NeedsSwap);
+  HeaderMapImpl Map(std::move(Buffer), NeedsSwap);
+
+  SmallString<24> DestPath;
+  EXPECT_EQ("/inc/a.h", Map.lookupFilename("a.h", DestPath));
+  EXPECT_EQ("/inc/a.h", Map.lookupFilename("A.H", DestPath));
+  EXPECT_EQ("/inc/sub/b.h", Map.lookupFilename("sub/b.h", DestPath));
+  EXPECT_EQ("/other/c.h", Map.lookupFilename("c.h", DestPath));
+  EXPECT_EQ("", Map.lookupFilename("d.h", DestPath));
+}
+
+TEST(HeaderMapTest, writeEmpty) {
+  std::string Contents;
+  {
+    raw_string_ostream OS(Contents);
+    HeaderMapWriter().write(OS);
+  }
+  auto Buffer = MemoryBuffer::getMemBuffer(Contents, "header",
+                                           /* RequresNullTerminator */ false);
+  bool NeedsSwap;
+  ASSERT_TRUE(HeaderMapImpl::checkHeader(*Buffer, NeedsSwap));
+  HeaderMapImpl Map(std::move(Buffer), NeedsSwap);
+
+  SmallString<24> DestPath;
+  EXPECT_EQ("", Map.lookupFilename("a.h", DestPath));
+}
+
 } // end namespace
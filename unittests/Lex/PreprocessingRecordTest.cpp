@@ -0,0 +1,145 @@
+//===- unittests/Lex/PreprocessingRecordTest.cpp - PPRecord tests ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/PreprocessingRecord.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/LangOptions.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TargetOptions.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/HeaderSearchOptions.h"
+#include "clang/Lex/ModuleLoader.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Lex/PreprocessorOptions.h"
+#include "gtest/gtest.h"
+
+using namespace clang;
+
+namespace {
+
+// The test fixture.
+class PreprocessingRecordTest : public ::testing::Test {
+protected:
+  PreprocessingRecordTest()
+    : FileMgr(FileMgrOpts),
+      DiagID(new DiagnosticIDs()),
+      Diags(DiagID, new DiagnosticOptions, new IgnoringDiagConsumer()),
+      SourceMgr(Diags, FileMgr),
+      TargetOpts(new TargetOptions)
+  {
+    TargetOpts->Triple = "x86_64-apple-darwin11.1.0";
+    Target = TargetInfo::CreateTargetInfo(Diags, TargetOpts);
+  }
+
+  FileSystemOptions FileMgrOpts;
+  FileManager FileMgr;
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID;
+  DiagnosticsEngine Diags;
+  SourceManager SourceMgr;
+  LangOptions LangOpts;
+  std::shared_ptr<TargetOptions> TargetOpts;
+  IntrusiveRefCntPtr<TargetInfo> Target;
+};
+
+class VoidModuleLoader : public ModuleLoader {
+  ModuleLoadResult loadModule(SourceLocation ImportLoc, 
+                              ModuleIdPath Path,
+                              Module::NameVisibilityKind Visibility,
+                              bool IsInclusionDirective) override {
+    return ModuleLoadResult();
+  }
+
+  void makeModuleVisible(Module *Mod,
+                         Module::NameVisibilityKind Visibility,
+                         SourceLocation ImportLoc) override { }
+
+  GlobalModuleIndex *loadGlobalModuleIndex(SourceLocation TriggerLoc) override
+    { return nullptr; }
+  bool lookupMissingImports(StringRef Name, SourceLocation TriggerLoc) override
+    { return 0; }
+};
+
+TEST_F(PreprocessingRecordTest, MacroExpansions) {
+  const char *source =
+      "#define M1 1\n"
+      "#define M2 2\n"
+      "#define FM(x, y) y x\n"
+      "a M1\n"
+      "FM(M1, M2)\n"
+      "b __LINE__\n"
+      "c\n";
+
+  std::unique_ptr<llvm::MemoryBuffer> Buf =
+      llvm::MemoryBuffer::getMemBuffer(source);
+  SourceMgr.setMainFileID(SourceMgr.createFileID(std::move(Buf)));
+
+  VoidModuleLoader ModLoader;
+  HeaderSearch HeaderInfo(new HeaderSearchOptions, SourceMgr, Diags, LangOpts, 
+                          Target.get());
+  Preprocessor PP(new PreprocessorOptions(), Diags, LangOpts, SourceMgr,
+                  HeaderInfo, ModLoader,
+                  /*IILookup =*/nullptr,
+                  /*OwnsHeaderSearch =*/false);
+  PP.Initialize(*Target);
+  PP.createPreprocessingRecord();
+  PreprocessingRecord &PPRec = *PP.getPreprocessingRecord();
+  PP.EnterMainSourceFile();
+
+  std::vector<Token> toks;
+  while (1) {
+    Token tok;
+    PP.Lex(tok);
+    if (tok.is(tok::eof))
+      break;
+    toks.push_back(tok);
+  }
+
+  // a 1 2 1 b <line> c
+  ASSERT_EQ(7U, toks.size());
+
+  // Three definitions, followed by the expansions of M1, FM, M2, M1 and
+  // __LINE__ in source order, even though M1 is expanded after M2 within FM.
+  std::vector<PreprocessedEntity *> Entities(PPRec.begin(), PPRec.end());
+  ASSERT_EQ(8U, Entities.size());
+  for (unsigned I = 0; I != 3; ++I)
+    EXPECT_TRUE(isa<MacroDefinitionRecord>(Entities[I]));
+  const char *Names[] = { "M1", "FM", "M1", "M2", "__LINE__" };
+  for (unsigned I = 0; I != 5; ++I) {
+    MacroExpansion *ME = dyn_cast<MacroExpansion>(Entities[I + 3]);
+    ASSERT_TRUE(ME != nullptr);
+    EXPECT_EQ(Names[I], ME->getName()->getName().str());
+    EXPECT_EQ(I == 4, ME->isBuiltinMacro());
+  }
+  for (unsigned I = 3; I != 7; ++I)
+    EXPECT_TRUE(SourceMgr.isBeforeInTranslationUnit(
+        Entities[I]->getSourceRange().getBegin(),
+        Entities[I + 1]->getSourceRange().getBegin()));
+
+  // Retrieving an entity again yields the same object.
+  EXPECT_EQ(Entities[4], *(PPRec.begin() + 4));
+
+  // The expansions from 'a' up to, but not including, 'b'.
+  auto Range = PPRec.getPreprocessedEntitiesInRange(
+      SourceRange(toks[0].getLocation(), toks[4].getLocation()));
+  std::vector<PreprocessedEntity *> InRange(Range.begin(), Range.end());
+  ASSERT_EQ(4U, InRange.size());
+  EXPECT_EQ(Entities[3], InRange[0]);
+  EXPECT_EQ(Entities[6], InRange[3]);
+
+  // Nothing but the expansion of __LINE__ after 'b'.
+  Range = PPRec.getPreprocessedEntitiesInRange(
+      SourceRange(toks[4].getLocation(), toks[6].getLocation()));
+  ASSERT_EQ(1, std::distance(Range.begin(), Range.end()));
+  EXPECT_EQ(Entities[7], *Range.begin());
+}
+
+} // anonymous namespace
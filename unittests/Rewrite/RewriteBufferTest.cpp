@@ -48,4 +48,47 @@ TEST(RewriteBuffer, TagRanges) {
   EXPECT_EQ(Output, Result);
 }
 
+static std::string getContents(const RewriteBuffer &Buf) {
+  std::string Result;
+  raw_string_ostream OS(Result);
+  Buf.write(OS);
+  return OS.str();
+}
+
+TEST(RewriteBuffer, ReplaceTextBatch) {
+  StringRef Input = "int f(int x) { return g(x) + g(x); }";
+  RewriteBuffer::Edit Edits[] = {
+    {4, 1, "func"},           // f -> func
+    {10, 1, "value"},         // x -> value
+    {22, 0, "ns::"},          // insert before g
+    {22, 1, "h"},             // g -> h, in front of the insertion
+    {24, 1, "value"},
+    {29, 1, "h"},
+    {31, 1, ""},              // remove x
+    {31, 0, "value"},         // and put something back
+  };
+  // ReplaceText() applies longer edits first at the same offset.
+  std::swap(Edits[2], Edits[3]);
+
+  // Apply the edits after an unrelated change, to check that the batch maps
+  // its offsets like ReplaceText() does.
+  RewriteBuffer Expected, Batch;
+  Expected.Initialize(Input);
+  Batch.Initialize(Input);
+  Expected.InsertTextBefore(0, "static ");
+  Batch.InsertTextBefore(0, "static ");
+  for (const auto &E : Edits)
+    Expected.ReplaceText(E.OrigOffset, E.OrigLength, E.NewStr);
+  Batch.ReplaceTextBatch(Edits);
+
+  EXPECT_EQ("static int func(int value) { return ns::h(value) + h(value); }",
+            getContents(Expected));
+  EXPECT_EQ(getContents(Expected), getContents(Batch));
+
+  // Later changes are mapped through the deltas of the batch.
+  Expected.InsertTextAfter(36, ";");
+  Batch.InsertTextAfter(36, ";");
+  EXPECT_EQ(getContents(Expected), getContents(Batch));
+}
+
 } // anonymous namespace
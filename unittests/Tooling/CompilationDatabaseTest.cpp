@@ -14,8 +14,11 @@
 #include "clang/Tooling/FileMatchTrie.h"
 #include "clang/Tooling/JSONCompilationDatabase.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
+#include <algorithm>
 
 namespace clang {
 namespace tooling {
@@ -172,6 +175,82 @@ TEST(JSONCompilationDatabase, ArgumentsPreferredOverCommand) {
    EXPECT_EQ(Arguments, FoundCommand.CommandLine[0]) << ErrorMessage;
 }
 
+TEST(JSONCompilationDatabase, LoadsFromIndex) {
+  SmallString<128> Dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("json-index", Dir));
+  SmallString<128> DatabasePath(Dir);
+  llvm::sys::path::append(DatabasePath, "compile_commands.json");
+  {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(DatabasePath, EC, llvm::sys::fs::F_Text);
+    ASSERT_FALSE(EC);
+    OS << "[\n"
+          "  { \"directory\": \"//net/dir\",\n"
+          "    \"command\": \"clang -c a.cc\",\n"
+          "    \"file\": \"a.cc\" },\n"
+          "  { \"directory\": \"//net/dir\",\n"
+          "    \"arguments\": [\"clang\", \"-c\", \"b.cc\"],\n"
+          "    \"file\": \"//net/dir/b.cc\" },\n"
+          "  {\"directory\":\"//net/dir\",\"command\":\"clang -DX a.cc\","
+          "\"file\":\"a.cc\"}\n"
+          "]\n";
+  }
+
+  std::string ErrorMessage;
+  std::unique_ptr<CompilationDatabase> Parsed(
+      JSONCompilationDatabase::loadFromFile(DatabasePath, ErrorMessage));
+  ASSERT_TRUE(Parsed) << ErrorMessage;
+  SmallString<128> IndexPath(DatabasePath);
+  IndexPath += ".index";
+  EXPECT_TRUE(llvm::sys::fs::exists(IndexPath));
+
+  std::unique_ptr<CompilationDatabase> Indexed(
+      JSONCompilationDatabase::loadFromFile(DatabasePath, ErrorMessage));
+  ASSERT_TRUE(Indexed) << ErrorMessage;
+  std::vector<std::string> Files = Indexed->getAllFiles();
+  std::sort(Files.begin(), Files.end());
+  ASSERT_EQ(2u, Files.size());
+  EXPECT_EQ("//net/dir/a.cc", Files[0]);
+  EXPECT_EQ("//net/dir/b.cc", Files[1]);
+
+  std::vector<CompileCommand> Commands =
+      Indexed->getCompileCommands("//net/dir/a.cc");
+  ASSERT_EQ(2u, Commands.size());
+  EXPECT_EQ("//net/dir", Commands[0].Directory);
+  EXPECT_EQ("a.cc", Commands[0].Filename);
+  EXPECT_EQ((std::vector<std::string>{"clang", "-c", "a.cc"}),
+            Commands[0].CommandLine);
+  EXPECT_EQ((std::vector<std::string>{"clang", "-DX", "a.cc"}),
+            Commands[1].CommandLine);
+
+  std::vector<CompileCommand> AllParsed = Parsed->getAllCompileCommands();
+  std::vector<CompileCommand> AllIndexed = Indexed->getAllCompileCommands();
+  ASSERT_EQ(3u, AllIndexed.size());
+  for (unsigned I = 0; I < 3; ++I) {
+    EXPECT_EQ(AllParsed[I].Directory, AllIndexed[I].Directory);
+    EXPECT_EQ(AllParsed[I].Filename, AllIndexed[I].Filename);
+    EXPECT_EQ(AllParsed[I].CommandLine, AllIndexed[I].CommandLine);
+  }
+
+  // A changed database doesn't use the stale index.
+  {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(DatabasePath, EC, llvm::sys::fs::F_Text);
+    ASSERT_FALSE(EC);
+    OS << "[{\"directory\":\"//net/dir\",\"command\":\"clang c.cc\","
+          "\"file\":\"c.cc\"}]";
+  }
+  std::unique_ptr<CompilationDatabase> Changed(
+      JSONCompilationDatabase::loadFromFile(DatabasePath, ErrorMessage));
+  ASSERT_TRUE(Changed) << ErrorMessage;
+  EXPECT_EQ(std::vector<std::string>(1, "//net/dir/c.cc"),
+            Changed->getAllFiles());
+
+  llvm::sys::fs::remove(IndexPath);
+  llvm::sys::fs::remove(DatabasePath);
+  llvm::sys::fs::remove(Dir);
+}
+
 struct FakeComparator : public PathComparator {
   ~FakeComparator() override {}
   bool equivalent(StringRef FileA, StringRef FileB) const override {
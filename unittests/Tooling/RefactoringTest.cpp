@@ -732,5 +732,16 @@ TEST_F(MergeReplacementsTest, OverlappingRanges) {
                       {{"", 0, 3, "cc"}, {"", 3, 3, "dd"}});
 }
 
+TEST_F(MergeReplacementsTest, ManyReplacementsInOneReplacement) {
+  // Every element of 'Second' is merged into the one element of 'First'.
+  std::string Code(100, 'a');
+  Replacements First = {{"", 0, 100, std::string(20000, 'b')}};
+  Replacements Second;
+  for (unsigned Offset = 0; Offset < 20000; Offset += 4)
+    Second.insert({"", Offset, 2, "c"});
+  mergeAndTestRewrite(Code, First, Second);
+  EXPECT_EQ(1u, mergeReplacements(First, Second).size());
+}
+
 } // end namespace tooling
 } // end namespace clang
@@ -14,12 +14,17 @@
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Frontend/FrontendActions.h"
+#include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/FingerprintDatabase.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 #include <algorithm>
 #include <string>
@@ -460,6 +465,180 @@ TEST(ClangToolTest, BuildASTs) {
   EXPECT_EQ(2u, ASTs.size());
 }
 
+TEST(ClangToolTest, BuildSpilledASTs) {
+  // The AST files are loaded from disk, so the sources must be on disk too.
+  SmallString<128> Dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("spilled-asts", Dir));
+  std::vector<std::string> Sources;
+  for (StringRef Name : {"b", "a", "c"}) {
+    SmallString<128> Path(Dir);
+    llvm::sys::path::append(Path, Name + ".cc");
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::F_Text);
+    ASSERT_FALSE(EC);
+    OS << "void " << Name << "() {}\n";
+    Sources.push_back(Path.str().str());
+  }
+  FixedCompilationDatabase Compilations(Dir, std::vector<std::string>());
+  ClangTool Tool(Compilations, Sources);
+
+  std::vector<std::string> ASTFileNames;
+  {
+    SpilledASTs ASTs(/*MaxResidentASTs=*/2);
+    EXPECT_EQ(0, Tool.buildSpilledASTs(ASTs, 2));
+    ASSERT_EQ(3u, ASTs.size());
+    EXPECT_TRUE(ASTs.getMainFileName(0).endswith("a.cc"));
+    EXPECT_TRUE(ASTs.getMainFileName(1).endswith("b.cc"));
+    EXPECT_TRUE(ASTs.getMainFileName(2).endswith("c.cc"));
+
+    std::shared_ptr<ASTUnit> A = ASTs.getAST(0);
+    ASSERT_TRUE(A != nullptr);
+    EXPECT_TRUE(A->getASTContext().getTranslationUnitDecl() != nullptr);
+    EXPECT_EQ(A, ASTs.getAST(0));
+    ASSERT_TRUE(ASTs.getAST(1) != nullptr);
+    ASSERT_TRUE(ASTs.getAST(2) != nullptr);
+    // The first AST was unloaded and is loaded again, while the old one is
+    // still held here.
+    std::shared_ptr<ASTUnit> ReloadedA = ASTs.getAST(0);
+    ASSERT_TRUE(ReloadedA != nullptr);
+    EXPECT_NE(A, ReloadedA);
+  }
+
+  for (const std::string &Source : Sources)
+    llvm::sys::fs::remove(Source);
+  llvm::sys::fs::remove(Dir);
+}
+
+TEST(ClangToolTest, RunParallel) {
+  FixedCompilationDatabase Compilations("/", std::vector<std::string>());
+
+  std::vector<std::string> Sources;
+  Sources.push_back("/a.cc");
+  Sources.push_back("/b.cc");
+  Sources.push_back("/c.cc");
+  ClangTool Tool(Compilations, Sources);
+
+  Tool.mapVirtualFile("/a.cc", "void a() {}");
+  Tool.mapVirtualFile("/b.cc", "void b() {}");
+  Tool.mapVirtualFile("/c.cc", "void c() {}");
+
+  std::unique_ptr<FrontendActionFactory> Action(
+      newFrontendActionFactory<SyntaxOnlyAction>());
+  EXPECT_EQ(0, Tool.runParallel(Action.get(), 2));
+  EXPECT_EQ(0, Tool.runParallel(Action.get(), 8));
+
+  ClangTool FailingTool(Compilations, Sources);
+  FailingTool.mapVirtualFile("/a.cc", "void a() {}");
+  FailingTool.mapVirtualFile("/b.cc", "int b = undeclared;");
+  FailingTool.mapVirtualFile("/c.cc", "void c() {}");
+  EXPECT_EQ(1, FailingTool.runParallel(Action.get(), 2));
+}
+
+TEST(ClangToolTest, RunParallelResolvesRelativeMappedFiles) {
+  FixedCompilationDatabase Compilations("/root", std::vector<std::string>());
+
+  std::vector<std::string> Sources;
+  Sources.push_back("/root/a.cc");
+  Sources.push_back("/root/b.cc");
+  ClangTool Tool(Compilations, Sources);
+
+  Tool.mapVirtualFile("/root/a.cc", "#include \"c.h\"\nint a = c;");
+  Tool.mapVirtualFile("/root/b.cc", "#include \"c.h\"\nint b = c;");
+  Tool.mapVirtualFile("c.h", "extern int c;");
+
+  std::unique_ptr<FrontendActionFactory> Action(
+      newFrontendActionFactory<SyntaxOnlyAction>());
+  EXPECT_EQ(0, Tool.runParallel(Action.get(), 2));
+}
+
+namespace {
+class CountingSyntaxOnlyActionFactory : public FrontendActionFactory {
+public:
+  CountingSyntaxOnlyActionFactory() : NumActions(0) {}
+  FrontendAction *create() override {
+    ++NumActions;
+    return new SyntaxOnlyAction;
+  }
+  unsigned NumActions;
+};
+} // end anonymous namespace
+
+TEST(ClangToolTest, FingerprintDatabase) {
+  FixedCompilationDatabase Compilations("/", std::vector<std::string>());
+  std::vector<std::string> Sources;
+  Sources.push_back("/a.cc");
+  Sources.push_back("/b.cc");
+  FingerprintDatabase Fingerprints("test");
+
+  auto RunTool = [&](StringRef Header, StringRef B) {
+    ClangTool Tool(Compilations, Sources);
+    Tool.mapVirtualFile("/a.cc", "#include \"/a.h\"\nint a = h;");
+    Tool.mapVirtualFile("/a.h", Header);
+    Tool.mapVirtualFile("/b.cc", B);
+    Tool.setFingerprintDatabase(&Fingerprints);
+    CountingSyntaxOnlyActionFactory Action;
+    EXPECT_EQ(B.count("undeclared") ? 1 : 0, Tool.run(&Action));
+    return Action.NumActions;
+  };
+
+  EXPECT_EQ(2u, RunTool("extern int h;", "void b() {}"));
+  EXPECT_EQ(0u, RunTool("extern int h;", "void b() {}"));
+  // A change to the header reruns only the file that includes it.
+  EXPECT_EQ(1u, RunTool("extern long h;", "void b() {}"));
+  // A failed compile command is rerun even if nothing changed.
+  EXPECT_EQ(1u, RunTool("extern long h;", "int b = undeclared;"));
+  EXPECT_EQ(1u, RunTool("extern long h;", "int b = undeclared;"));
+  EXPECT_EQ(1u, RunTool("extern long h;", "void b() {}"));
+  EXPECT_EQ(0u, RunTool("extern long h;", "void b() {}"));
+}
+
+namespace {
+class CountingPCHUsesActionFactory : public FrontendActionFactory {
+public:
+  CountingPCHUsesActionFactory() : NumPCHUses(0) {}
+  FrontendAction *create() override { return new SyntaxOnlyAction; }
+  bool runInvocation(CompilerInvocation *Invocation, FileManager *Files,
+                     std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+                     DiagnosticConsumer *DiagConsumer) override {
+    if (!Invocation->getPreprocessorOpts().ImplicitPCHInclude.empty())
+      ++NumPCHUses;
+    return FrontendActionFactory::runInvocation(
+        Invocation, Files, std::move(PCHContainerOps), DiagConsumer);
+  }
+  unsigned NumPCHUses;
+};
+} // end anonymous namespace
+
+TEST(ClangToolTest, SharedPCH) {
+  std::vector<std::string> Args;
+  Args.push_back("-include");
+  Args.push_back("/h.h");
+  FixedCompilationDatabase Compilations("/", Args);
+
+  std::vector<std::string> Sources;
+  Sources.push_back("/a.cc");
+  Sources.push_back("/b.cc");
+  ClangTool Tool(Compilations, Sources);
+  Tool.mapVirtualFile("/h.h", "template <typename T> struct S { T t; };");
+  Tool.mapVirtualFile("/a.cc", "S<int> a;");
+  Tool.mapVirtualFile("/b.cc", "S<long> b;");
+  Tool.setUseSharedPCH(true);
+
+  CountingPCHUsesActionFactory Action;
+  EXPECT_EQ(0, Tool.run(&Action));
+  EXPECT_EQ(2u, Action.NumPCHUses);
+
+  // A header included by a single compile command is not precompiled.
+  ClangTool SingleTool(Compilations, std::vector<std::string>(1, "/a.cc"));
+  SingleTool.mapVirtualFile("/h.h", "template <typename T> struct S { T t; };");
+  SingleTool.mapVirtualFile("/a.cc", "S<int> a;");
+  SingleTool.setUseSharedPCH(true);
+
+  CountingPCHUsesActionFactory SingleAction;
+  EXPECT_EQ(0, SingleTool.run(&SingleAction));
+  EXPECT_EQ(0u, SingleAction.NumPCHUses);
+}
+
 struct TestDiagnosticConsumer : public DiagnosticConsumer {
   TestDiagnosticConsumer() : NumDiagnosticsSeen(0) {}
   void HandleDiagnostic(DiagnosticsEngine::Level DiagLevel,
@@ -13,8 +13,10 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
+#include <atomic>
 #include <fstream>
 #include <set>
+#include <thread>
 #define DEBUG_TYPE "libclang-test"
 
 TEST(libclang, clang_parseTranslationUnit2_InvalidArgs) {
@@ -494,3 +496,235 @@ TEST_F(LibclangReparseTest, clang_parseTranslationUnit2FullArgv) {
   EXPECT_EQ(0U, clang_getNumDiagnostics(ClangTU));
   DisplayDiagnostics();
 }
+
+TEST_F(LibclangReparseTest, clang_indexCompileCommands) {
+  ClangTU = nullptr;
+
+  std::string Header = "Header.h";
+  WriteFile(Header, "#pragma once\ninline int get() { return 1; }\n");
+
+  const unsigned NumFiles = 8;
+  std::string Database = "[";
+  for (unsigned I = 0; I != NumFiles; ++I) {
+    std::string Name = "tu" + std::to_string(I) + ".cpp";
+    std::string Filename = Name;
+    WriteFile(Filename, "#include \"Header.h\"\nint f() { return get(); }\n");
+    if (I)
+      Database += ",";
+    Database += "{\"directory\": \"" + TestDir + "\", \"command\": \"clang++ "
+                "-fsyntax-only " + Name + "\", \"file\": \"" + Name + "\"}";
+  }
+  Database += "]";
+  std::string DatabaseFile = "compile_commands.json";
+  WriteFile(DatabaseFile, Database);
+
+  CXCompilationDatabase_Error Error;
+  CXCompilationDatabase DB =
+      clang_CompilationDatabase_fromDirectory(TestDir.c_str(), &Error);
+  ASSERT_EQ(CXCompilationDatabase_NoError, Error);
+  CXCompileCommands Commands =
+      clang_CompilationDatabase_getAllCompileCommands(DB);
+  ASSERT_EQ(NumFiles, clang_CompileCommands_getSize(Commands));
+
+  // The callbacks run on several threads at once.
+  std::atomic<unsigned> MainFiles(0);
+  IndexerCallbacks Callbacks = {};
+  Callbacks.enteredMainFile = [](CXClientData Data, CXFile,
+                                 void *) -> CXIdxClientFile {
+    ++*static_cast<std::atomic<unsigned> *>(Data);
+    return nullptr;
+  };
+
+  CXIndexAction Action = clang_IndexAction_create(Index);
+  int Results[NumFiles];
+  EXPECT_EQ(0, clang_indexCompileCommands(
+                   Action, &MainFiles, &Callbacks, sizeof(Callbacks),
+                   CXIndexOpt_SkipParsedBodiesInSession, Commands,
+                   /*num_threads=*/4, Results));
+  EXPECT_EQ(NumFiles, MainFiles.load());
+  for (int Result : Results)
+    EXPECT_EQ(CXError_Success, Result);
+
+  clang_IndexAction_dispose(Action);
+  clang_CompileCommands_dispose(Commands);
+  clang_CompilationDatabase_dispose(DB);
+  llvm::sys::fs::remove(DatabaseFile + ".index");
+}
+
+TEST_F(LibclangReparseTest, clang_flattenCursorChildren) {
+  std::string Filename = "flatten.cpp";
+  WriteFile(Filename, "namespace n { int f(int a) { return a; } }\n");
+  ClangTU = clang_parseTranslationUnit(Index, Filename.c_str(), nullptr, 0,
+                                       nullptr, 0, TUFlags);
+  ASSERT_TRUE(ClangTU);
+
+  CXCursor NS = clang_getCursor(
+      ClangTU, clang_getLocation(ClangTU, clang_getFile(ClangTU,
+                                                        Filename.c_str()),
+                                 1, 11));
+  ASSERT_EQ(CXCursor_Namespace, clang_getCursorKind(NS));
+
+  CXFlattenedCursors *Flat =
+      clang_flattenCursorChildren(NS, CXFlattenCursor_IncludeUSRs |
+                                          CXFlattenCursor_IncludeSpellings);
+  ASSERT_TRUE(Flat);
+
+  // f, a, the body, the return statement, and the reference to a.
+  ASSERT_GE(Flat->NumCursors, 5U);
+  EXPECT_EQ(CXCursor_FunctionDecl, Flat->Kinds[0]);
+  EXPECT_EQ(-1, Flat->Parents[0]);
+  EXPECT_EQ(CXCursor_ParmDecl, Flat->Kinds[1]);
+  EXPECT_EQ(0, Flat->Parents[1]);
+  EXPECT_EQ(14U, Flat->BeginOffsets[0]);
+  EXPECT_EQ(40U, Flat->EndOffsets[0]);
+  ASSERT_NE(-1, Flat->USROffsets[0]);
+  EXPECT_STREQ("c:@N@n@F@f#I#", Flat->USRs + Flat->USROffsets[0]);
+  EXPECT_STREQ("f", Flat->Spellings + Flat->SpellingOffsets[0]);
+  EXPECT_STREQ("a", Flat->Spellings + Flat->SpellingOffsets[1]);
+  for (unsigned I = 0; I != Flat->NumCursors; ++I) {
+    EXPECT_EQ(Flat->Kinds[I], clang_getCursorKind(Flat->Cursors[I]));
+    EXPECT_LT(Flat->Parents[I], int(I));
+  }
+
+  clang_disposeFlattenedCursors(Flat);
+}
+
+TEST_F(LibclangReparseTest, clang_getCursorUSRs) {
+  std::string Filename = "usrs.cpp";
+  WriteFile(Filename, "void f(); void f() {}\nint g;\n");
+  ClangTU = clang_parseTranslationUnit(Index, Filename.c_str(), nullptr, 0,
+                                       nullptr, 0, TUFlags);
+  ASSERT_TRUE(ClangTU);
+
+  CXFile File = clang_getFile(ClangTU, Filename.c_str());
+  CXCursor Cursors[] = {
+      clang_getCursor(ClangTU, clang_getLocation(ClangTU, File, 1, 6)),
+      clang_getCursor(ClangTU, clang_getLocation(ClangTU, File, 1, 16)),
+      clang_getCursor(ClangTU, clang_getLocation(ClangTU, File, 2, 5))};
+  CXString USRs[3];
+  clang_getCursorUSRs(Cursors, 3, USRs);
+  EXPECT_STREQ("c:@F@f#", clang_getCString(USRs[0]));
+  EXPECT_STREQ("c:@F@f#", clang_getCString(USRs[1]));
+  EXPECT_STREQ("c:@g", clang_getCString(USRs[2]));
+  for (CXString &USR : USRs)
+    clang_disposeString(USR);
+
+  unsigned long long Hash = clang_getCursorUSRHash(Cursors[0]);
+  EXPECT_NE(0ULL, Hash);
+  EXPECT_EQ(Hash, clang_getCursorUSRHash(Cursors[1]));
+  EXPECT_NE(Hash, clang_getCursorUSRHash(Cursors[2]));
+  EXPECT_EQ(0ULL, clang_getCursorUSRHash(clang_getNullCursor()));
+
+  // Reparsing drops the cached USRs along with the old AST.
+  ASSERT_TRUE(ReparseTU(0, nullptr));
+  File = clang_getFile(ClangTU, Filename.c_str());
+  CXCursor G = clang_getCursor(ClangTU, clang_getLocation(ClangTU, File, 2, 5));
+  CXString USR = clang_getCursorUSR(G);
+  EXPECT_STREQ("c:@g", clang_getCString(USR));
+  clang_disposeString(USR);
+}
+
+TEST_F(LibclangReparseTest, SkipFunctionBodiesOutsideMainFile) {
+  std::string HeaderName = "header.h";
+  std::string CppName = "main.cpp";
+  WriteFile(HeaderName,
+            "inline int h() { int inHeader = 0; return inHeader; }\n");
+  WriteFile(CppName, "#include \"header.h\"\n"
+                     "int f() { int a = 0; return a; }\n"
+                     "int g() { int b = 0; return b; }\n");
+  ClangTU = clang_parseTranslationUnit(
+      Index, CppName.c_str(), nullptr, 0, nullptr, 0,
+      TUFlags | CXTranslationUnit_SkipFunctionBodiesOutsideMainFile);
+  ASSERT_TRUE(ClangTU);
+
+  auto KindAt = [&](const std::string &Filename, unsigned Line,
+                    unsigned Column) {
+    CXFile File = clang_getFile(ClangTU, Filename.c_str());
+    return clang_getCursorKind(clang_getCursor(
+        ClangTU, clang_getLocation(ClangTU, File, Line, Column)));
+  };
+
+  EXPECT_NE(CXCursor_VarDecl, KindAt(HeaderName, 1, 22));
+  EXPECT_EQ(CXCursor_VarDecl, KindAt(CppName, 2, 15));
+  EXPECT_EQ(CXCursor_VarDecl, KindAt(CppName, 3, 15));
+
+  // Only the body of g overlaps the focus.
+  clang_setFunctionBodyFocus(ClangTU, 3, 3);
+  ASSERT_TRUE(ReparseTU(0, nullptr));
+  EXPECT_NE(CXCursor_VarDecl, KindAt(HeaderName, 1, 22));
+  EXPECT_NE(CXCursor_VarDecl, KindAt(CppName, 2, 15));
+  EXPECT_EQ(CXCursor_VarDecl, KindAt(CppName, 3, 15));
+}
+
+TEST_F(LibclangReparseTest, ReparseSnapshotWhileQuerying) {
+  std::string CppName = "snapshot.cpp";
+  WriteFile(CppName, "int before;\n");
+  ClangTU = clang_parseTranslationUnit(Index, CppName.c_str(), nullptr, 0,
+                                       nullptr, 0, TUFlags);
+  ASSERT_TRUE(ClangTU);
+
+  auto SpellingAt = [&](CXTranslationUnit TU) {
+    CXFile File = clang_getFile(TU, CppName.c_str());
+    CXCursor C = clang_getCursor(TU, clang_getLocation(TU, File, 1, 5));
+    CXString Spelling = clang_getCursorSpelling(C);
+    std::string Result = clang_getCString(Spelling);
+    clang_disposeString(Spelling);
+    return Result;
+  };
+
+  std::string NewContents = "int after;\n";
+  CXUnsavedFile Unsaved = {CppName.c_str(), NewContents.c_str(),
+                           static_cast<unsigned long>(NewContents.size())};
+  CXTranslationUnit Snapshot = nullptr;
+  CXErrorCode Err = CXError_Failure;
+  std::thread Reparser([&] {
+    Err = clang_reparseTranslationUnitSnapshot(
+        ClangTU, 1, &Unsaved, clang_defaultReparseOptions(ClangTU), &Snapshot);
+  });
+  // The original translation unit stays usable while the snapshot is built.
+  for (unsigned I = 0; I != 10; ++I)
+    EXPECT_EQ("before", SpellingAt(ClangTU));
+  Reparser.join();
+
+  ASSERT_EQ(CXError_Success, Err);
+  ASSERT_TRUE(Snapshot);
+  EXPECT_EQ("before", SpellingAt(ClangTU));
+  EXPECT_EQ("after", SpellingAt(Snapshot));
+  clang_disposeTranslationUnit(Snapshot);
+}
+
+TEST_F(LibclangReparseTest, clang_getSemanticTokens) {
+  std::string CppName = "highlight.cpp";
+  WriteFile(CppName, "struct S { int field; };\n"
+                     "int f(int param) { S s; return s.field + param; }\n");
+  ClangTU = clang_parseTranslationUnit(Index, CppName.c_str(), nullptr, 0,
+                                       nullptr, 0, TUFlags);
+  ASSERT_TRUE(ClangTU);
+  CXFile File = clang_getFile(ClangTU, CppName.c_str());
+
+  const CXSemanticToken *Tokens;
+  unsigned NumTokens = clang_getSemanticTokens(ClangTU, File, 0, ~0U, &Tokens);
+  ASSERT_GT(NumTokens, 0U);
+
+  auto ClassAt = [&](unsigned Offset) {
+    for (unsigned I = 0; I != NumTokens; ++I)
+      if (Tokens[I].Offset == Offset)
+        return Tokens[I].Class;
+    return CXSemanticToken_None;
+  };
+  EXPECT_EQ(CXSemanticToken_Type, ClassAt(7));       // S
+  EXPECT_EQ(CXSemanticToken_Field, ClassAt(15));     // field
+  EXPECT_EQ(CXSemanticToken_Function, ClassAt(29));  // f
+  EXPECT_EQ(CXSemanticToken_Parameter, ClassAt(35)); // param
+  EXPECT_EQ(CXSemanticToken_Type, ClassAt(44));      // S
+  EXPECT_EQ(CXSemanticToken_Variable, ClassAt(46));  // s
+  EXPECT_EQ(CXSemanticToken_Field, ClassAt(58));     // field
+  EXPECT_EQ(CXSemanticToken_Parameter, ClassAt(66)); // param
+
+  // A sub-range is served from the same cached array.
+  const CXSemanticToken *Line2;
+  unsigned NumLine2 = clang_getSemanticTokens(ClangTU, File, 25, ~0U, &Line2);
+  ASSERT_GT(NumLine2, 0U);
+  EXPECT_EQ(25U, Line2[0].Offset);
+  EXPECT_EQ(Tokens + (NumTokens - NumLine2), Line2);
+}
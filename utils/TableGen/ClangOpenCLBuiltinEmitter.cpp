@@ -0,0 +1,224 @@
+//===--- ClangOpenCLBuiltinEmitter.cpp - Generate OpenCL builtin tables ---===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This tablegen backend emits the tables Sema uses to declare the OpenCL
+// builtin functions described in OpenCLBuiltins.td when they are first used.
+//
+//===----------------------------------------------------------------------===//
+
+#include "TableGenBackends.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/TableGen/Error.h"
+#include "llvm/TableGen/Record.h"
+#include "llvm/TableGen/StringMatcher.h"
+#include "llvm/TableGen/TableGenBackend.h"
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+class OpenCLBuiltinEmitter {
+  RecordKeeper &Records;
+  raw_ostream &OS;
+
+  /// The scalar types used by the builtins and their indices in that list.
+  std::vector<Record *> ScalarTypes;
+  std::map<Record *, unsigned> ScalarTypeIndex;
+
+  /// The types used by the builtins, as the index of their scalar type and
+  /// their vector width, and their indices in that list.
+  typedef std::pair<unsigned, unsigned> TypeKey;
+  std::vector<TypeKey> Types;
+  std::map<TypeKey, unsigned> TypeIndex;
+
+  /// The signatures of all builtins, one after the other, and the offset of
+  /// each distinct signature in that list.
+  std::vector<unsigned> SignatureTable;
+  std::map<std::vector<unsigned>, unsigned> SignatureIndex;
+
+  /// The overloads of each builtin, as the offset and length of their
+  /// signature in SignatureTable.
+  std::map<std::string, std::vector<std::pair<unsigned, unsigned>>> Overloads;
+
+  unsigned getScalarType(Record *Ty);
+  unsigned getType(Record *ScalarTy, unsigned VecWidth);
+  void addSignature(StringRef Name, const std::vector<unsigned> &Signature);
+
+  /// Expand the GenTypes of the signature of \p Builtin and add each of the
+  /// resulting signatures to the overloads of its builtin.
+  void addBuiltin(Record *Builtin);
+
+public:
+  OpenCLBuiltinEmitter(RecordKeeper &Records, raw_ostream &OS)
+      : Records(Records), OS(OS) {}
+
+  void emit();
+};
+} // end anonymous namespace
+
+unsigned OpenCLBuiltinEmitter::getScalarType(Record *Ty) {
+  auto Inserted =
+      ScalarTypeIndex.insert(std::make_pair(Ty, ScalarTypes.size()));
+  if (Inserted.second)
+    ScalarTypes.push_back(Ty);
+  return Inserted.first->second;
+}
+
+unsigned OpenCLBuiltinEmitter::getType(Record *ScalarTy, unsigned VecWidth) {
+  TypeKey Key(getScalarType(ScalarTy), VecWidth);
+  auto Inserted = TypeIndex.insert(std::make_pair(Key, Types.size()));
+  if (Inserted.second)
+    Types.push_back(Key);
+  return Inserted.first->second;
+}
+
+void OpenCLBuiltinEmitter::addSignature(StringRef Name,
+                                        const std::vector<unsigned> &Sig) {
+  auto Inserted =
+      SignatureIndex.insert(std::make_pair(Sig, SignatureTable.size()));
+  if (Inserted.second)
+    SignatureTable.insert(SignatureTable.end(), Sig.begin(), Sig.end());
+  Overloads[Name].push_back(std::make_pair(Inserted.first->second,
+                                           (unsigned)Sig.size()));
+}
+
+void OpenCLBuiltinEmitter::addBuiltin(Record *Builtin) {
+  std::string Name = Builtin->getValueAsString("Name");
+  std::vector<Record *> Signature =
+      Builtin->getValueAsListOfDefs("Signature");
+  if (Signature.empty())
+    PrintFatalError(Builtin->getLoc(), "builtin '" + Name +
+                                           "' has no return type");
+
+  // Find out how many signatures the GenTypes expand to.
+  size_t NumTypes = 1;
+  std::vector<int64_t> VecWidths(1, 1);
+  bool HasGenType = false;
+  for (Record *Ty : Signature) {
+    if (!Ty->isSubClassOf("GenType"))
+      continue;
+    size_t TyNumTypes = Ty->getValueAsListOfDefs("Types").size();
+    std::vector<int64_t> TyVecWidths = Ty->getValueAsListOfInts("VecWidths");
+    if (HasGenType &&
+        (TyNumTypes != NumTypes || TyVecWidths.size() != VecWidths.size()))
+      PrintFatalError(Builtin->getLoc(),
+                      "GenTypes of builtin '" + Name + "' don't match");
+    NumTypes = TyNumTypes;
+    VecWidths = TyVecWidths;
+    HasGenType = true;
+  }
+
+  for (size_t I = 0; I != NumTypes; ++I) {
+    for (size_t W = 0; W != VecWidths.size(); ++W) {
+      std::vector<unsigned> Sig;
+      for (Record *Ty : Signature) {
+        if (Ty->isSubClassOf("GenType"))
+          Sig.push_back(
+              getType(Ty->getValueAsListOfDefs("Types")[I],
+                      Ty->getValueAsListOfInts("VecWidths")[W]));
+        else
+          Sig.push_back(getType(Ty, 1));
+      }
+      addSignature(Name, Sig);
+    }
+  }
+}
+
+void OpenCLBuiltinEmitter::emit() {
+  for (Record *Builtin : Records.getAllDerivedDefinitions("Builtin"))
+    addBuiltin(Builtin);
+
+  emitSourceFileHeader("OpenCL builtin declaration tables", OS);
+
+  OS << "namespace {\n"
+        "/// A type used by an OpenCL builtin: its scalar type, as understood "
+        "by\n"
+        "/// getOpenCLBuiltinType, and its vector width, which is 1 for "
+        "scalars.\n"
+        "struct OpenCLTypeStruct {\n"
+        "  unsigned ScalarType;\n"
+        "  unsigned VecWidth;\n"
+        "};\n\n"
+        "/// An overload of an OpenCL builtin: the offset in "
+        "OpenCLSignatureTable of\n"
+        "/// its return type, which is followed by its parameter types, and "
+        "the number\n"
+        "/// of these types.\n"
+        "struct OpenCLBuiltinStruct {\n"
+        "  unsigned SigTableIndex;\n"
+        "  unsigned NumTypes;\n"
+        "};\n"
+        "} // end anonymous namespace\n\n";
+
+  OS << "static const OpenCLTypeStruct OpenCLTypeTable[] = {\n";
+  for (const TypeKey &Ty : Types)
+    OS << "  { " << Ty.first << ", " << Ty.second << " }, // "
+       << ScalarTypes[Ty.first]->getValueAsString("Name")
+       << (Ty.second != 1 ? std::to_string(Ty.second) : "") << "\n";
+  OS << "};\n\n";
+
+  OS << "static const unsigned OpenCLSignatureTable[] = {";
+  for (size_t I = 0, E = SignatureTable.size(); I != E; ++I)
+    OS << (I % 16 ? " " : "\n  ") << SignatureTable[I] << ",";
+  OS << "\n};\n\n";
+
+  // Emit the overloads grouped by builtin, remembering where each builtin's
+  // overloads start.
+  std::vector<StringMatcher::StringPair> Matches;
+  unsigned BuiltinIndex = 0;
+  OS << "static const OpenCLBuiltinStruct OpenCLBuiltinTable[] = {\n";
+  for (const auto &Builtin : Overloads) {
+    OS << "  // " << Builtin.first << "\n";
+    for (const auto &Overload : Builtin.second)
+      OS << "  { " << Overload.first << ", " << Overload.second << " },\n";
+    Matches.emplace_back(Builtin.first,
+                         "return std::make_pair(" +
+                             std::to_string(BuiltinIndex) + "u, " +
+                             std::to_string(Builtin.second.size()) + "u);");
+    BuiltinIndex += Builtin.second.size();
+  }
+  OS << "};\n\n";
+
+  OS << "/// Return the index in OpenCLBuiltinTable of the first overload of "
+        "the\n"
+        "/// OpenCL builtin \\p Name and the number of its overloads, or a "
+        "pair of\n"
+        "/// zeros if \\p Name isn't an OpenCL builtin.\n"
+        "static std::pair<unsigned, unsigned> isOpenCLBuiltin(StringRef Name) "
+        "{\n";
+  StringMatcher("Name", Matches, OS).Emit();
+  OS << "  return std::make_pair(0u, 0u);\n"
+        "}\n\n";
+
+  OS << "/// Return the type \\p Ty of an OpenCL builtin.\n"
+        "static QualType getOpenCLBuiltinType(ASTContext &Context,\n"
+        "                                     const OpenCLTypeStruct &Ty) {\n"
+        "  QualType QT;\n"
+        "  switch (Ty.ScalarType) {\n";
+  for (size_t I = 0, E = ScalarTypes.size(); I != E; ++I)
+    OS << "  case " << I << ":\n"
+       << "    QT = Context." << ScalarTypes[I]->getValueAsString("QualType")
+       << ";\n"
+       << "    break;\n";
+  OS << "  default:\n"
+        "    llvm_unreachable(\"unknown OpenCL builtin type\");\n"
+        "  }\n"
+        "  if (Ty.VecWidth != 1)\n"
+        "    QT = Context.getExtVectorType(QT, Ty.VecWidth);\n"
+        "  return QT;\n"
+        "}\n";
+}
+
+namespace clang {
+void EmitClangOpenCLBuiltins(RecordKeeper &Records, raw_ostream &OS) {
+  OpenCLBuiltinEmitter(Records, OS).emit();
+}
+} // end namespace clang
@@ -0,0 +1,206 @@
+#!/usr/bin/env python
+#===- run-benchmarks.py - Clang frontend benchmarks ----------*- python -*--===#
+#
+#                     The LLVM Compiler Infrastructure
+#
+# This file is distributed under the University of Illinois Open Source
+# License. See LICENSE.TXT for details.
+#
+#===------------------------------------------------------------------------===#
+
+"""Time clang -cc1 on synthetic inputs that stress one frontend hot path each.
+
+Every benchmark generates its input in a scratch directory, runs the compiler
+once to warm up, and then reports the fastest of --runs timed runs.  With
+--save, the results are written as JSON; with --baseline, they are compared
+to such a file and the script fails if a benchmark got slower than
+--threshold percent.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def gen_lexer(dir):
+  # Plain tokens without macros: measures the lexer.
+  lines = []
+  for i in range(200000):
+    lines.append('int v%d = %d + 0x%x * (v%d - 1.5e3); // comment %d' %
+                 (i, i, i, i, i))
+  return write(dir, 'lexer.c', '\n'.join(lines) + '\n')
+
+
+def gen_macros(dir):
+  # Nested function-like macros expanded many times.
+  src = ['#define A(x) ((x) + 1)',
+         '#define B(x) A(A(x)) * A(x)',
+         '#define C(x, y) B(x) - B(y) + A(y)',
+         '#define D(x) C(B(x), C(x, x))']
+  for i in range(20000):
+    src.append('int m%d = D(%d);' % (i, i))
+  return write(dir, 'macros.c', '\n'.join(src) + '\n')
+
+
+def gen_overloads(dir):
+  # Calls that each have to rank a large overload set.
+  src = []
+  for i in range(64):
+    src.append('struct S%d { S%d(int); };' % (i, i))
+    src.append('void f(S%d, long);' % i)
+  src.append('void f(double, double);')
+  src.append('void g() {')
+  for i in range(20000):
+    src.append('  f(%d, %d);' % (i, i))
+  src.append('}')
+  return write(dir, 'overloads.cpp', '\n'.join(src) + '\n')
+
+
+def gen_templates(dir):
+  # Deep recursive class template instantiation.
+  src = """
+template <int N> struct Fib {
+  static const int value = Fib<N - 1>::value + Fib<N - 2>::value;
+};
+template <> struct Fib<1> { static const int value = 1; };
+template <> struct Fib<0> { static const int value = 0; };
+
+template <int N> struct Chain : Chain<N - 1> { int member[N % 7 + 1]; };
+template <> struct Chain<0> {};
+
+int x = Fib<800>::value;
+Chain<900> c;
+"""
+  return write(dir, 'templates.cpp', src)
+
+
+def gen_constexpr(dir):
+  # Long-running constant evaluation.
+  src = """
+constexpr unsigned long long collatz(unsigned long long n) {
+  unsigned long long steps = 0;
+  while (n != 1) {
+    n = n % 2 ? 3 * n + 1 : n / 2;
+    ++steps;
+  }
+  return steps;
+}
+
+constexpr unsigned long long sum(unsigned long long n) {
+  unsigned long long total = 0;
+  for (unsigned long long i = 1; i <= n; ++i)
+    total += collatz(i);
+  return total;
+}
+
+static_assert(sum(30000) != 0, "");
+"""
+  return write(dir, 'constexpr.cpp', src)
+
+
+def gen_modules(dir):
+  # Loading a module with many declarations; the warm-up run builds it.
+  decls = []
+  for i in range(20000):
+    decls.append('struct R%d { int a, b; };' % i)
+    decls.append('int fn%d(struct R%d *r);' % (i, i))
+  write(dir, 'Bench.h', '\n'.join(decls) + '\n')
+  write(dir, 'module.modulemap', 'module Bench { header "Bench.h" }\n')
+  return write(dir, 'modules.m', '@import Bench;\nint use(struct R7 *r) '
+                                 '{ return fn7(r) + fn19999(0); }\n')
+
+
+BENCHMARKS = [
+  ('lexer', gen_lexer, ['-Eonly']),
+  ('macros', gen_macros, ['-Eonly']),
+  ('overloads', gen_overloads, ['-fsyntax-only', '-std=c++11']),
+  ('templates', gen_templates,
+   ['-fsyntax-only', '-std=c++11', '-ftemplate-depth=2048']),
+  ('constexpr', gen_constexpr,
+   ['-fsyntax-only', '-std=c++14', '-fconstexpr-steps=100000000']),
+  ('modules', gen_modules,
+   ['-fsyntax-only', '-fmodules', '-fimplicit-module-maps',
+    '-fmodules-cache-path=%(dir)s/cache', '-I', '%(dir)s']),
+]
+
+
+def write(dir, name, contents):
+  path = os.path.join(dir, name)
+  with open(path, 'w') as f:
+    f.write(contents)
+  return path
+
+
+def run_benchmark(clang, dir, generate, flags, runs):
+  input = generate(dir)
+  cmd = [clang, '-cc1'] + [f % {'dir': dir} for f in flags] + [input]
+  best = None
+  for i in range(runs + 1):
+    start = time.time()
+    subprocess.check_call(cmd, stdout=open(os.devnull, 'w'))
+    elapsed = time.time() - start
+    # The first run warms up the caches and builds modules.
+    if i != 0 and (best is None or elapsed < best):
+      best = elapsed
+  return best
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__)
+  parser.add_argument('--clang', required=True, help='the clang to measure')
+  parser.add_argument('--runs', type=int, default=5,
+                      help='timed runs per benchmark (default: 5)')
+  parser.add_argument('--filter', default='',
+                      help='only run the benchmarks whose name contains this')
+  parser.add_argument('--save', help='write the results to this JSON file')
+  parser.add_argument('--baseline', help='compare to this JSON file')
+  parser.add_argument('--threshold', type=float, default=5.0,
+                      help='allowed slowdown against --baseline, in percent '
+                           '(default: 5)')
+  args = parser.parse_args()
+
+  baseline = {}
+  if args.baseline:
+    with open(args.baseline) as f:
+      baseline = json.load(f)
+
+  results = {}
+  regressions = []
+  for name, generate, flags in BENCHMARKS:
+    if args.filter not in name:
+      continue
+    dir = tempfile.mkdtemp(prefix='clang-bench-')
+    try:
+      best = run_benchmark(args.clang, dir, generate, flags, args.runs)
+    finally:
+      shutil.rmtree(dir)
+    results[name] = best
+    line = '%-12s %8.3fs' % (name, best)
+    if name in baseline:
+      change = (best - baseline[name]) / baseline[name] * 100
+      line += '  %+6.1f%%' % change
+      if change > args.threshold:
+        regressions.append(name)
+        line += '  REGRESSION'
+    print(line)
+    sys.stdout.flush()
+
+  if args.save:
+    with open(args.save, 'w') as f:
+      json.dump(results, f, indent=2, sort_keys=True)
+
+  if regressions:
+    print('error: slower than the baseline: %s' % ', '.join(regressions))
+    return 1
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -0,0 +1,80 @@
+#!/usr/bin/env python
+#===- header-cost-report.py - Sum up header costs of a build -*- python -*--===#
+#
+#                     The LLVM Compiler Infrastructure
+#
+# This file is distributed under the University of Illinois Open Source
+# License. See LICENSE.TXT for details.
+#
+#===------------------------------------------------------------------------===#
+
+"""Report the most expensive headers of a build.
+
+Compile each translation unit with -Xclang -header-cost-file -Xclang <file>
+and pass the resulting JSON files (or directories containing them) to this
+script.  It sums up the cost of each header over all translation units and
+lists the headers that cost the most in total.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import sys
+
+FIELDS = ['self-time-us', 'total-time-us', 'self-ast-bytes', 'total-ast-bytes']
+
+
+def find_files(paths):
+  for path in paths:
+    if not os.path.isdir(path):
+      yield path
+      continue
+    for root, dirs, files in os.walk(path):
+      for name in files:
+        if name.endswith('.json'):
+          yield os.path.join(root, name)
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__)
+  parser.add_argument('paths', nargs='+',
+                      help='-header-cost-file outputs, or directories of them')
+  parser.add_argument('--sort', choices=FIELDS, default='total-time-us',
+                      help='the cost to rank headers by '
+                           '(default: total-time-us)')
+  parser.add_argument('--limit', type=int, default=30,
+                      help='number of headers to list (default: 30)')
+  parser.add_argument('--include-main-files', action='store_true',
+                      help='also list the main files of the translation units')
+  args = parser.parse_args()
+
+  headers = {}
+  units = 0
+  for path in find_files(args.paths):
+    with open(path) as f:
+      data = json.load(f)
+    units += 1
+    for file in data['files']:
+      name = file['name']
+      if name == data['main-file'] and not args.include_main_files:
+        continue
+      total = headers.setdefault(name, dict.fromkeys(FIELDS + ['units'], 0))
+      total['units'] += 1
+      for field in FIELDS:
+        total[field] += file[field]
+
+  ranked = sorted(headers.items(), key=lambda h: h[1][args.sort], reverse=True)
+  print('%d translation units, %d files' % (units, len(headers)))
+  print('%10s %10s %12s %6s  %s' %
+        ('total ms', 'self ms', 'total AST KB', 'TUs', 'file'))
+  for name, total in ranked[:args.limit]:
+    print('%10.1f %10.1f %12.1f %6d  %s' %
+          (total['total-time-us'] / 1000.0, total['self-time-us'] / 1000.0,
+           total['total-ast-bytes'] / 1024.0, total['units'], name))
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())